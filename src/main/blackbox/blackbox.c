@@ -228,7 +228,10 @@ static const blackboxSimpleFieldDefinition_t blackboxSlowFields[] = {
 
     {"failsafePhase",         -1, UNSIGNED, PREDICT(0),      ENCODING(TAG2_3S32)},
     {"rxSignalReceived",      -1, UNSIGNED, PREDICT(0),      ENCODING(TAG2_3S32)},
-    {"rxFlightChannelsValid", -1, UNSIGNED, PREDICT(0),      ENCODING(TAG2_3S32)}
+    {"rxFlightChannelsValid", -1, UNSIGNED, PREDICT(0),      ENCODING(TAG2_3S32)},
+#ifdef USE_DUAL_GYRO
+    {"gyroSensorsUsed",       -1, UNSIGNED, PREDICT(0),      ENCODING(UNSIGNED_VB)}
+#endif
 };
 
 typedef enum BlackboxState {
@@ -288,6 +291,9 @@ typedef struct blackboxSlowState_s {
     uint8_t failsafePhase;
     bool rxSignalReceived;
     bool rxFlightChannelsValid;
+#ifdef USE_DUAL_GYRO
+    uint8_t gyroSensorsUsed;
+#endif
 } __attribute__((__packed__)) blackboxSlowState_t; // We pack this struct so that padding doesn't interfere with memcmp()
 
 //From mixer.c:
@@ -701,6 +707,10 @@ static void writeSlowFrame(void)
     values[2] = slowHistory.rxFlightChannelsValid ? 1 : 0;
     blackboxWriteTag2_3S32(values);
 
+#ifdef USE_DUAL_GYRO
+    blackboxWriteUnsignedVB(slowHistory.gyroSensorsUsed);
+#endif
+
     blackboxSlowFrameIterationTimer = 0;
 }
 
@@ -714,6 +724,9 @@ static void loadSlowState(blackboxSlowState_t *slow)
     slow->failsafePhase = failsafePhase();
     slow->rxSignalReceived = rxIsReceivingSignal();
     slow->rxFlightChannelsValid = rxAreFlightChannelsValid();
+#ifdef USE_DUAL_GYRO
+    slow->gyroSensorsUsed = gyroSensorsUsed();
+#endif
 }
 
 /**
@@ -977,6 +990,18 @@ static void loadMainState(timeUs_t currentTimeUs)
 
     blackboxCurrent->time = currentTimeUs;
 
+#ifdef USE_FIXED_POINT_PID
+    // truncated towards zero like the float terms
+    for (i = 0; i < XYZ_AXIS_COUNT; i++) {
+        blackboxCurrent->axisPID_P[i] = axisPIDFix_P[i] / Q16;
+    }
+    for (i = 0; i < XYZ_AXIS_COUNT; i++) {
+        blackboxCurrent->axisPID_I[i] = axisPIDFix_I[i] / Q16;
+    }
+    for (i = 0; i < XYZ_AXIS_COUNT; i++) {
+        blackboxCurrent->axisPID_D[i] = axisPIDFix_D[i] / Q16;
+    }
+#else
     for (i = 0; i < XYZ_AXIS_COUNT; i++) {
         blackboxCurrent->axisPID_P[i] = axisPID_P[i];
     }
@@ -986,6 +1011,7 @@ static void loadMainState(timeUs_t currentTimeUs)
     for (i = 0; i < XYZ_AXIS_COUNT; i++) {
         blackboxCurrent->axisPID_D[i] = axisPID_D[i];
     }
+#endif
 
     for (i = 0; i < 4; i++) {
         blackboxCurrent->rcCommand[i] = rcCommand[i];
@@ -1270,6 +1296,9 @@ static bool blackboxWriteSysinfo()
         BLACKBOX_PRINT_HEADER_LINE("deadband:%d",                         rcControlsConfig()->deadband);
         BLACKBOX_PRINT_HEADER_LINE("yaw_deadband:%d",                     rcControlsConfig()->yaw_deadband);
         BLACKBOX_PRINT_HEADER_LINE("gyro_lpf:%d",                         gyroConfig()->gyro_lpf);
+#ifdef USE_DUAL_GYRO
+        BLACKBOX_PRINT_HEADER_LINE("gyro_fusion_mode:%d",                 gyroConfig()->gyro_fusion_mode);
+#endif
         BLACKBOX_PRINT_HEADER_LINE("gyro_soft_type:%d",                   gyroConfig()->gyro_soft_lpf_type);
         BLACKBOX_PRINT_HEADER_LINE("gyro_lowpass_hz:%d",                  gyroConfig()->gyro_soft_lpf_hz);
         BLACKBOX_PRINT_HEADER_LINE("gyro_notch_hz:%d,%d",                 gyroConfig()->gyro_soft_notch_hz_1,
@@ -63,5 +63,7 @@ typedef enum {
     DEBUG_SCHEDULER,
     DEBUG_STACK,
     DEBUG_TRI,
+    DEBUG_OSD,
+    DEBUG_PIDLOOP_CYCLES,
     DEBUG_COUNT
 } debugType_e;
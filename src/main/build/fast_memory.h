@@ -0,0 +1,47 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Zero wait state memory for the PID loop: CCM on F303 and F405, DTCM and ITCM on F7.
+// The FASTRAM and FASTCODE regions of the linker scripts place the sections, fastMemoryInit()
+// sets them up at boot. Only the CPU can reach CCM, nothing that DMA reads or writes goes in here.
+//
+//   FAST_RAM_ZERO_INIT  state that starts at zero, filters and integrators
+//   FAST_RAM            initialised data, copied from flash
+//   FAST_CODE           functions, copied from flash
+//
+// The section names have no leading dot so the host linker provides __start_ and __stop_ symbols for them.
+
+#define FAST_RAM_BSS_SECTION    "fastram_bss"
+#define FAST_RAM_DATA_SECTION   "fastram_data"
+#define FAST_CODE_SECTION       "fastcode"
+
+#ifdef USE_FAST_RAM
+#define FAST_RAM_ZERO_INIT      __attribute__ ((section(FAST_RAM_BSS_SECTION), aligned(4)))
+#define FAST_RAM                __attribute__ ((section(FAST_RAM_DATA_SECTION), aligned(4)))
+#else
+#define FAST_RAM_ZERO_INIT
+#define FAST_RAM
+#endif
+
+#ifdef USE_FAST_CODE
+// Not inlined into callers in flash. The linker adds the veneers for calls in and out of the region.
+#define FAST_CODE               __attribute__ ((section(FAST_CODE_SECTION), noinline))
+#else
+#define FAST_CODE
+#endif
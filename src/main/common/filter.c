@@ -129,6 +129,74 @@ float biquadFilterApply(biquadFilter_t *filter, float input)
     return result;
 }
 
+/*
+ * Fixed point variants of the PT1 and biquad filters for the fixed point PID loop,
+ * coefficients are worked out in float at init and converted to Q30.
+ */
+fix16_t nullFilterApplyFix(void *filter, fix16_t input)
+{
+    UNUSED(filter);
+    return input;
+}
+
+void pt1FilterInitFix(pt1FilterFix_t *filter, uint8_t f_cut, float dT)
+{
+    pt1Filter_t pt1;
+    pt1FilterInit(&pt1, f_cut, dT);
+    filter->k = q30FromFloat(pt1.k);
+    filter->state = 0;
+}
+
+fix16_t pt1FilterApplyFix(pt1FilterFix_t *filter, fix16_t input)
+{
+    filter->state = fix16Add(filter->state, fix16MulQ30(fix16Add(input, -filter->state), filter->k));
+    return filter->state;
+}
+
+void biquadFilterInitLPFFix(biquadFilterFix_t *filter, float filterFreq, uint32_t refreshRate)
+{
+    biquadFilterInitFix(filter, filterFreq, refreshRate, BIQUAD_Q, FILTER_LPF);
+}
+
+void biquadFilterInitFix(biquadFilterFix_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType)
+{
+    biquadFilter_t biquad;
+    biquadFilterInit(&biquad, filterFreq, refreshRate, Q, filterType);
+    filter->b0 = q30FromFloat(biquad.b0);
+    filter->b1 = q30FromFloat(biquad.b1);
+    filter->b2 = q30FromFloat(biquad.b2);
+    filter->a1 = q30FromFloat(biquad.a1);
+    filter->a2 = q30FromFloat(biquad.a2);
+    filter->d1 = filter->d2 = 0;
+}
+
+/* Same transposed direct form II as biquadFilterApply, the delay line is kept at full product precision */
+fix16_t biquadFilterApplyFix(biquadFilterFix_t *filter, fix16_t input)
+{
+    const fix16_t result = fix16Saturate(((int64_t)filter->b0 * input + filter->d1 + (Q30 / 2)) >> 30);
+    filter->d1 = (int64_t)filter->b1 * input - (int64_t)filter->a1 * result + filter->d2;
+    filter->d2 = (int64_t)filter->b2 * input - (int64_t)filter->a2 * result;
+    return result;
+}
+
+void firFilterDenoiseInitFix(firFilterDenoiseFix_t *filter, uint8_t gyroSoftLpfHz, uint16_t targetLooptime)
+{
+    memset(filter, 0, sizeof(firFilterDenoiseFix_t));
+    filter->targetCount = constrain(lrintf((1.0f / (0.000001f * (float)targetLooptime)) / gyroSoftLpfHz), 1, MAX_FIR_DENOISE_WINDOW_SIZE);
+}
+
+/* Same moving average as firFilterDenoiseUpdate, the sum is exact in 64 bits */
+fix16_t firFilterDenoiseUpdateFix(firFilterDenoiseFix_t *filter, fix16_t input)
+{
+    filter->state[filter->index] = input;
+    filter->movingSum += filter->state[filter->index++];
+    if (filter->index == filter->targetCount)
+        filter->index = 0;
+    filter->movingSum -= filter->state[filter->index];
+
+    return filter->movingSum / filter->targetCount;
+}
+
 /*
  * FIR filter
  */
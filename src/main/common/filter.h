@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "common/maths.h"
+
 #ifdef STM32F10X
 #define MAX_FIR_DENOISE_WINDOW_SIZE 60
 #else
@@ -36,6 +38,16 @@ typedef struct biquadFilter_s {
     float d1, d2;
 } biquadFilter_t;
 
+typedef struct pt1FilterFix_s {
+    fix16_t state;
+    q30_t k;
+} pt1FilterFix_t;
+
+typedef struct biquadFilterFix_s {
+    q30_t b0, b1, b2, a1, a2;
+    int64_t d1, d2;     // Q16 signal times Q30 coefficient
+} biquadFilterFix_t;
+
 typedef struct firFilterDenoise_s{
     int filledCount;
     int targetCount;
@@ -44,6 +56,13 @@ typedef struct firFilterDenoise_s{
     float state[MAX_FIR_DENOISE_WINDOW_SIZE];
 } firFilterDenoise_t;
 
+typedef struct firFilterDenoiseFix_s {
+    int targetCount;
+    int index;
+    int64_t movingSum;
+    fix16_t state[MAX_FIR_DENOISE_WINDOW_SIZE];
+} firFilterDenoiseFix_t;
+
 typedef enum {
     FILTER_PT1 = 0,
     FILTER_BIQUAD,
@@ -67,7 +86,10 @@ typedef struct firFilter_s {
 
 typedef float (*filterApplyFnPtr)(void *filter, float input);
 
+typedef fix16_t (*filterApplyFixFnPtr)(void *filter, fix16_t input);
+
 float nullFilterApply(void *filter, float input);
+fix16_t nullFilterApplyFix(void *filter, fix16_t input);
 
 void biquadFilterInitLPF(biquadFilter_t *filter, float filterFreq, uint32_t refreshRate);
 void biquadFilterInit(biquadFilter_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
@@ -78,6 +100,14 @@ void pt1FilterInit(pt1Filter_t *filter, uint8_t f_cut, float dT);
 float pt1FilterApply(pt1Filter_t *filter, float input);
 float pt1FilterApply4(pt1Filter_t *filter, float input, uint8_t f_cut, float dT);
 
+void pt1FilterInitFix(pt1FilterFix_t *filter, uint8_t f_cut, float dT);
+fix16_t pt1FilterApplyFix(pt1FilterFix_t *filter, fix16_t input);
+void biquadFilterInitLPFFix(biquadFilterFix_t *filter, float filterFreq, uint32_t refreshRate);
+void biquadFilterInitFix(biquadFilterFix_t *filter, float filterFreq, uint32_t refreshRate, float Q, biquadFilterType_e filterType);
+fix16_t biquadFilterApplyFix(biquadFilterFix_t *filter, fix16_t input);
+void firFilterDenoiseInitFix(firFilterDenoiseFix_t *filter, uint8_t gyroSoftLpfHz, uint16_t targetLooptime);
+fix16_t firFilterDenoiseUpdateFix(firFilterDenoiseFix_t *filter, fix16_t input);
+
 void firFilterInit(firFilter_t *filter, float *buf, uint8_t bufLength, const float *coeffs);
 void firFilterInit2(firFilter_t *filter, float *buf, uint8_t bufLength, const float *coeffs, uint8_t coeffsLength);
 void firFilterUpdate(firFilter_t *filter, float input);
@@ -99,6 +99,19 @@ float acos_approx(float x)
 }
 #endif
 
+// 1/sqrt(x) from the exponent trick and one Newton step, within 0.2%
+float fastInvSqrt(float x)
+{
+    union {
+        float f;
+        int32_t i;
+    } conv = { .f = x };
+
+    conv.i = 0x5f3759df - (conv.i >> 1);
+    conv.f *= 1.5f - (0.5f * x * conv.f * conv.f);
+    return conv.f;
+}
+
 float powerf(float base, int exp) {
     float result = base;
     for (int count = 1; count < exp; count++) result *= base;
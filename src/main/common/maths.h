@@ -36,8 +36,13 @@
 #define ABS(x) ((x) > 0 ? (x) : -(x))
 
 #define Q12 (1 << 12)
+#define Q15 (1 << 15)
+#define Q16 (1 << 16)
+#define Q30 (1 << 30)
 
 typedef int32_t fix12_t;
+typedef int32_t fix16_t;    // Q16.16, rates and PID terms of the fixed point PID loop
+typedef int32_t q30_t;      // Q2.30, filter coefficients and gains below 2
 
 typedef struct stdev_s
 {
@@ -110,6 +115,8 @@ float acos_approx(float x);
 #define tan_approx(x)       tanf(x)
 #endif
 
+float fastInvSqrt(float x);
+
 void arraySubInt32(int32_t *dest, int32_t *array1, int32_t *array2, int count);
 
 int16_t qPercent(fix12_t q);
@@ -135,6 +142,49 @@ static inline float constrainf(float amt, float low, float high)
     else
         return amt;
 }
+
+// Fixed point helpers for targets without an FPU, see USE_FIXED_POINT_PID.
+// Products are taken in 64 bits, rounded, and saturated back to 32 bits.
+static inline fix16_t fix16Saturate(int64_t x)
+{
+    if (x > INT32_MAX)
+        return INT32_MAX;
+    else if (x < INT32_MIN)
+        return INT32_MIN;
+    else
+        return (fix16_t)x;
+}
+
+static inline fix16_t fix16FromFloat(float x)
+{
+    return (fix16_t)constrainf(x * Q16, (float)INT32_MIN, 2147483520.0f);
+}
+
+static inline float fix16ToFloat(fix16_t x)
+{
+    return x * (1.0f / Q16);
+}
+
+static inline q30_t q30FromFloat(float x)
+{
+    return (q30_t)constrainf(x * Q30, (float)INT32_MIN, 2147483520.0f);
+}
+
+static inline fix16_t fix16Add(fix16_t a, fix16_t b)
+{
+    return fix16Saturate((int64_t)a + b);
+}
+
+static inline fix16_t fix16Mul(fix16_t a, fix16_t b)
+{
+    return fix16Saturate(((int64_t)a * b + (Q16 / 2)) >> 16);
+}
+
+static inline fix16_t fix16MulQ30(fix16_t a, q30_t b)
+{
+    return fix16Saturate(((int64_t)a * b + (Q30 / 2)) >> 30);
+}
+
 uint16_t crc16_ccitt(uint16_t crc, unsigned char a);
 uint8_t crc8_dvb_s2(uint8_t crc, unsigned char a);
 
@@ -0,0 +1,83 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <ctype.h>
+
+#include "sorted_index.h"
+
+// compares the first length characters of a (treated as a complete string) against the zero terminated b
+static int compareNameN(const char *a, uint16_t length, const char *b)
+{
+    for (uint16_t i = 0; i < length; i++) {
+        const int ca = tolower((unsigned char)a[i]);
+        const int cb = tolower((unsigned char)b[i]);
+        if (ca != cb) {
+            return ca - cb;
+        }
+        if (cb == '\0') {
+            return 0;
+        }
+    }
+    // a is exhausted, it only matches if b is exhausted too
+    return b[length] == '\0' ? 0 : -1;
+}
+
+static int compareNames(const char *a, const char *b)
+{
+    for (;; a++, b++) {
+        const int ca = tolower((unsigned char)*a);
+        const int cb = tolower((unsigned char)*b);
+        if (ca != cb || ca == '\0') {
+            return ca - cb;
+        }
+    }
+}
+
+void sortedIndexBuild(uint16_t *index, uint16_t count, sortedIndexNameFn nameFn)
+{
+    // insertion sort, this is only done once and the tables are mostly grouped already
+    for (uint16_t i = 0; i < count; i++) {
+        const char *name = nameFn(i);
+        uint16_t j = i;
+        while (j > 0 && compareNames(nameFn(index[j - 1]), name) > 0) {
+            index[j] = index[j - 1];
+            j--;
+        }
+        index[j] = i;
+    }
+}
+
+int sortedIndexFind(const uint16_t *index, uint16_t count, sortedIndexNameFn nameFn, const char *name, uint16_t nameLength)
+{
+    int low = 0;
+    int high = count - 1;
+
+    while (low <= high) {
+        const int mid = (low + high) / 2;
+        const int result = compareNameN(name, nameLength, nameFn(index[mid]));
+        if (result == 0) {
+            return index[mid];
+        } else if (result < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,33 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Case insensitive sorted index over a table of names, used to replace linear
+// strncasecmp() scans of large const tables (e.g. the CLI value table) with a
+// binary search. The table itself stays in flash, only the index is in RAM.
+
+// Returns the name of the table entry at tableIndex.
+typedef const char *(*sortedIndexNameFn)(uint16_t tableIndex);
+
+void sortedIndexBuild(uint16_t *index, uint16_t count, sortedIndexNameFn nameFn);
+
+// Finds the entry whose name equals the first nameLength characters of name.
+// Returns the table index, or -1 if there is no such entry.
+int sortedIndexFind(const uint16_t *index, uint16_t count, sortedIndexNameFn nameFn, const char *name, uint16_t nameLength);
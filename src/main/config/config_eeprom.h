@@ -17,7 +17,7 @@
 
 #pragma once
 
-#define EEPROM_CONF_VERSION 157
+#define EEPROM_CONF_VERSION 163
 
 void initEEPROM(void);
 void writeEEPROM();
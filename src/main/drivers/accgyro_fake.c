@@ -29,32 +29,50 @@
 
 #ifdef USE_FAKE_GYRO
 
-static int16_t fakeGyroADC[XYZ_AXIS_COUNT];
+static gyroDev_t *fakeGyroDev[FAKE_GYRO_COUNT];
+static int16_t fakeGyroADC[FAKE_GYRO_COUNT][XYZ_AXIS_COUNT];
+static int16_t fakeGyroTemperature = 25;
 
 static void fakeGyroInit(gyroDev_t *gyro)
 {
     UNUSED(gyro);
 }
 
+void fakeGyroSetInstance(uint8_t instance, int16_t x, int16_t y, int16_t z)
+{
+    fakeGyroADC[instance][X] = x;
+    fakeGyroADC[instance][Y] = y;
+    fakeGyroADC[instance][Z] = z;
+}
+
 void fakeGyroSet(int16_t x, int16_t y, int16_t z)
 {
-    fakeGyroADC[X] = x;
-    fakeGyroADC[Y] = y;
-    fakeGyroADC[Z] = z;
+    for (int i = 0; i < FAKE_GYRO_COUNT; i++) {
+        fakeGyroSetInstance(i, x, y, z);
+    }
+}
+
+void fakeGyroSetTemperature(int16_t temperature)
+{
+    fakeGyroTemperature = temperature;
 }
 
 static bool fakeGyroRead(gyroDev_t *gyro)
 {
-    gyro->gyroADCRaw[X] = fakeGyroADC[X];
-    gyro->gyroADCRaw[Y] = fakeGyroADC[Y];
-    gyro->gyroADCRaw[Z] = fakeGyroADC[Z];
+    int instance = 0;
+    while (instance < FAKE_GYRO_COUNT - 1 && fakeGyroDev[instance] != gyro) {
+        instance++;
+    }
+    gyro->gyroADCRaw[X] = fakeGyroADC[instance][X];
+    gyro->gyroADCRaw[Y] = fakeGyroADC[instance][Y];
+    gyro->gyroADCRaw[Z] = fakeGyroADC[instance][Z];
     return true;
 }
 
 static bool fakeGyroReadTemperature(gyroDev_t *gyro, int16_t *temperatureData)
 {
     UNUSED(gyro);
-    UNUSED(temperatureData);
+    *temperatureData = fakeGyroTemperature;
     return true;
 }
 
@@ -66,6 +84,12 @@ static bool fakeGyroInitStatus(gyroDev_t *gyro)
 
 bool fakeGyroDetect(gyroDev_t *gyro)
 {
+    int instance = 0;
+    while (instance < FAKE_GYRO_COUNT - 1 && fakeGyroDev[instance] && fakeGyroDev[instance] != gyro) {
+        instance++;
+    }
+    fakeGyroDev[instance] = gyro;
+
     gyro->init = fakeGyroInit;
     gyro->intStatus = fakeGyroInitStatus;
     gyro->read = fakeGyroRead;
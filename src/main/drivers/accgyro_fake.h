@@ -21,6 +21,11 @@ struct accDev_s;
 bool fakeAccDetect(struct accDev_s *acc);
 void fakeAccSet(int16_t x, int16_t y, int16_t z);
 
+// Each detect gets the next instance, for boards with two gyros
+#define FAKE_GYRO_COUNT 2
+
 struct gyroDev_s;
 bool fakeGyroDetect(struct gyroDev_s *gyro);
 void fakeGyroSet(int16_t x, int16_t y, int16_t z);
+void fakeGyroSetInstance(uint8_t instance, int16_t x, int16_t y, int16_t z);
+void fakeGyroSetTemperature(int16_t temperature);
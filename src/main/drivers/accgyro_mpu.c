@@ -324,6 +324,33 @@ bool mpuGyroRead(gyroDev_t *gyro)
     return true;
 }
 
+// Whole degrees C, close enough to tell one calibration from another
+bool mpuGyroReadTemperature(gyroDev_t *gyro, int16_t *temperatureData)
+{
+    uint8_t data[2];
+
+    if (!gyro->mpuConfiguration.read(MPU_RA_TEMP_OUT_H, 2, data)) {
+        return false;
+    }
+    const int16_t temperatureRaw = (int16_t)((data[0] << 8) | data[1]);
+
+    switch (gyro->mpuDetectionResult.sensor) {
+    case MPU_60x0:
+    case MPU_60x0_SPI:
+        *temperatureData = 36 + temperatureRaw / 340;
+        break;
+    case ICM_20689_SPI:
+    case ICM_20608_SPI:
+    case ICM_20602_SPI:
+        *temperatureData = 25 + temperatureRaw / 326;
+        break;
+    default:
+        *temperatureData = 21 + temperatureRaw / 333;
+        break;
+    }
+    return true;
+}
+
 void mpuGyroInit(gyroDev_t *gyro)
 {
     mpuIntExtiInit(gyro);
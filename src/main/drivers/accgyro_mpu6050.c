@@ -106,6 +106,7 @@ bool mpu6050GyroDetect(gyroDev_t *gyro)
     }
     gyro->init = mpu6050GyroInit;
     gyro->read = mpuGyroRead;
+    gyro->temperature = mpuGyroReadTemperature;
     gyro->intStatus = mpuCheckDataReady;
 
     // 16.4 dps/lsb scalefactor
@@ -95,6 +95,7 @@ bool mpu6500GyroDetect(gyroDev_t *gyro)
 
     gyro->init = mpu6500GyroInit;
     gyro->read = mpuGyroRead;
+    gyro->temperature = mpuGyroReadTemperature;
     gyro->intStatus = mpuCheckDataReady;
 
     // 16.4 dps/lsb scalefactor
@@ -36,14 +36,17 @@
 #include "accgyro_mpu.h"
 #include "accgyro_spi_icm20689.h"
 
-#define DISABLE_ICM20689       IOHi(icmSpi20689CsPin)
-#define ENABLE_ICM20689        IOLo(icmSpi20689CsPin)
+#define DISABLE_ICM20689       spiBusTransactionEnd(&icmSpi20689Bus)
+#define ENABLE_ICM20689        spiBusTransactionBegin(&icmSpi20689Bus)
 
 static IO_t icmSpi20689CsPin = IO_NONE;
+static spiBusDevice_t icmSpi20689Bus;
 
 bool icm20689WriteRegister(uint8_t reg, uint8_t data)
 {
-    ENABLE_ICM20689;
+    if (!ENABLE_ICM20689) {
+        return false;
+    }
     spiTransferByte(ICM20689_SPI_INSTANCE, reg);
     spiTransferByte(ICM20689_SPI_INSTANCE, data);
     DISABLE_ICM20689;
@@ -53,7 +56,10 @@ bool icm20689WriteRegister(uint8_t reg, uint8_t data)
 
 bool icm20689ReadRegister(uint8_t reg, uint8_t length, uint8_t *data)
 {
-    ENABLE_ICM20689;
+    // Also called from the data ready interrupt, so don't wait on a bus held by someone else
+    if (!spiBusTransactionTryBegin(&icmSpi20689Bus)) {
+        return false;
+    }
     spiTransferByte(ICM20689_SPI_INSTANCE, reg | 0x80); // read transaction
     spiTransfer(ICM20689_SPI_INSTANCE, data, NULL, length);
     DISABLE_ICM20689;
@@ -73,7 +79,7 @@ static void icm20689SpiInit(void)
     IOInit(icmSpi20689CsPin, OWNER_MPU_CS, 0);
     IOConfigGPIO(icmSpi20689CsPin, SPI_IO_CS_CFG);
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_STANDARD);
+    spiBusDeviceInit(&icmSpi20689Bus, ICM20689_SPI_INSTANCE, icmSpi20689CsPin, SPI_CLOCK_STANDARD);
 
     hardwareInitialised = true;
 }
@@ -85,7 +91,7 @@ bool icm20689SpiDetect(void)
 
     icm20689SpiInit();
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON); //low speed
+    spiBusSetDivisor(&icmSpi20689Bus, SPI_CLOCK_INITIALIZATON); //low speed
 
     icm20689WriteRegister(MPU_RA_PWR_MGMT_1, ICM20689_BIT_RESET);
 
@@ -101,7 +107,7 @@ bool icm20689SpiDetect(void)
         }
     } while (attemptsRemaining--);
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_STANDARD);
+    spiBusSetDivisor(&icmSpi20689Bus, SPI_CLOCK_STANDARD);
 
     return true;
 
@@ -128,7 +134,7 @@ void icm20689GyroInit(gyroDev_t *gyro)
 {
     mpuGyroInit(gyro);
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON);
+    spiBusSetDivisor(&icmSpi20689Bus, SPI_CLOCK_INITIALIZATON);
 
     gyro->mpuConfiguration.write(MPU_RA_PWR_MGMT_1, ICM20689_BIT_RESET);
     delay(100);
@@ -158,7 +164,7 @@ void icm20689GyroInit(gyroDev_t *gyro)
     gyro->mpuConfiguration.write(MPU_RA_INT_ENABLE, 0x01); // RAW_RDY_EN interrupt enable
 #endif
 
-    spiSetDivisor(ICM20689_SPI_INSTANCE, SPI_CLOCK_STANDARD);
+    spiBusSetDivisor(&icmSpi20689Bus, SPI_CLOCK_STANDARD);
 }
 
 bool icm20689SpiGyroDetect(gyroDev_t *gyro)
@@ -169,6 +175,7 @@ bool icm20689SpiGyroDetect(gyroDev_t *gyro)
 
     gyro->init = icm20689GyroInit;
     gyro->read = mpuGyroRead;
+    gyro->temperature = mpuGyroReadTemperature;
     gyro->intStatus = mpuCheckDataReady;
 
     // 16.4 dps/lsb scalefactor
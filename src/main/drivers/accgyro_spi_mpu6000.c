@@ -99,14 +99,17 @@ static bool mpuSpi6000InitDone = false;
 #define MPU6000_REV_D9 0x59
 #define MPU6000_REV_D10 0x5A
 
-#define DISABLE_MPU6000       IOHi(mpuSpi6000CsPin)
-#define ENABLE_MPU6000        IOLo(mpuSpi6000CsPin)
+#define DISABLE_MPU6000       spiBusTransactionEnd(&mpuSpi6000Bus)
+#define ENABLE_MPU6000        spiBusTransactionBegin(&mpuSpi6000Bus)
 
 static IO_t mpuSpi6000CsPin = IO_NONE;
+static spiBusDevice_t mpuSpi6000Bus;
 
 bool mpu6000WriteRegister(uint8_t reg, uint8_t data)
 {
-    ENABLE_MPU6000;
+    if (!ENABLE_MPU6000) {
+        return false;
+    }
     spiTransferByte(MPU6000_SPI_INSTANCE, reg);
     spiTransferByte(MPU6000_SPI_INSTANCE, data);
     DISABLE_MPU6000;
@@ -116,7 +119,10 @@ bool mpu6000WriteRegister(uint8_t reg, uint8_t data)
 
 bool mpu6000ReadRegister(uint8_t reg, uint8_t length, uint8_t *data)
 {
-    ENABLE_MPU6000;
+    // Also called from the data ready interrupt, so don't wait on a bus held by someone else
+    if (!spiBusTransactionTryBegin(&mpuSpi6000Bus)) {
+        return false;
+    }
     spiTransferByte(MPU6000_SPI_INSTANCE, reg | 0x80); // read transaction
     spiTransfer(MPU6000_SPI_INSTANCE, data, NULL, length);
     DISABLE_MPU6000;
@@ -130,13 +136,13 @@ void mpu6000SpiGyroInit(gyroDev_t *gyro)
 
     mpu6000AccAndGyroInit(gyro);
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON);
+    spiBusSetDivisor(&mpuSpi6000Bus, SPI_CLOCK_INITIALIZATON);
 
     // Accel and Gyro DLPF Setting
     mpu6000WriteRegister(MPU6000_CONFIG, gyro->lpf);
     delayMicroseconds(1);
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_FAST);  // 18 MHz SPI clock
+    spiBusSetDivisor(&mpuSpi6000Bus, SPI_CLOCK_FAST);  // 18 MHz SPI clock
 
     mpuGyroRead(gyro);
 
@@ -161,7 +167,7 @@ bool mpu6000SpiDetect(void)
     IOInit(mpuSpi6000CsPin, OWNER_MPU_CS, 0);
     IOConfigGPIO(mpuSpi6000CsPin, SPI_IO_CS_CFG);
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON);
+    spiBusDeviceInit(&mpuSpi6000Bus, MPU6000_SPI_INSTANCE, mpuSpi6000CsPin, SPI_CLOCK_INITIALIZATON);
 
     mpu6000WriteRegister(MPU_RA_PWR_MGMT_1, BIT_H_RESET);
 
@@ -207,7 +213,7 @@ static void mpu6000AccAndGyroInit(gyroDev_t *gyro)
         return;
     }
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_INITIALIZATON);
+    spiBusSetDivisor(&mpuSpi6000Bus, SPI_CLOCK_INITIALIZATON);
 
     // Device Reset
     mpu6000WriteRegister(MPU_RA_PWR_MGMT_1, BIT_H_RESET);
@@ -248,7 +254,7 @@ static void mpu6000AccAndGyroInit(gyroDev_t *gyro)
     delayMicroseconds(15);
 #endif
 
-    spiSetDivisor(MPU6000_SPI_INSTANCE, SPI_CLOCK_FAST);
+    spiBusSetDivisor(&mpuSpi6000Bus, SPI_CLOCK_FAST);
     delayMicroseconds(1);
 
     mpuSpi6000InitDone = true;
@@ -274,6 +280,7 @@ bool mpu6000SpiGyroDetect(gyroDev_t *gyro)
 
     gyro->init = mpu6000SpiGyroInit;
     gyro->read = mpuGyroRead;
+    gyro->temperature = mpuGyroReadTemperature;
     gyro->intStatus = mpuCheckDataReady;
     // 16.4 dps/lsb scalefactor
     gyro->scale = 1.0f / 16.4f;
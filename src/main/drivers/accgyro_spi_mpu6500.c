@@ -34,14 +34,17 @@
 #include "accgyro_mpu6500.h"
 #include "accgyro_spi_mpu6500.h"
 
-#define DISABLE_MPU6500       IOHi(mpuSpi6500CsPin)
-#define ENABLE_MPU6500        IOLo(mpuSpi6500CsPin)
+#define DISABLE_MPU6500       spiBusTransactionEnd(&mpuSpi6500Bus)
+#define ENABLE_MPU6500        spiBusTransactionBegin(&mpuSpi6500Bus)
 
 static IO_t mpuSpi6500CsPin = IO_NONE;
+static spiBusDevice_t mpuSpi6500Bus;
 
 bool mpu6500WriteRegister(uint8_t reg, uint8_t data)
 {
-    ENABLE_MPU6500;
+    if (!ENABLE_MPU6500) {
+        return false;
+    }
     spiTransferByte(MPU6500_SPI_INSTANCE, reg);
     spiTransferByte(MPU6500_SPI_INSTANCE, data);
     DISABLE_MPU6500;
@@ -51,7 +54,10 @@ bool mpu6500WriteRegister(uint8_t reg, uint8_t data)
 
 bool mpu6500ReadRegister(uint8_t reg, uint8_t length, uint8_t *data)
 {
-    ENABLE_MPU6500;
+    // Also called from the data ready interrupt, so don't wait on a bus held by someone else
+    if (!spiBusTransactionTryBegin(&mpuSpi6500Bus)) {
+        return false;
+    }
     spiTransferByte(MPU6500_SPI_INSTANCE, reg | 0x80); // read transaction
     spiTransfer(MPU6500_SPI_INSTANCE, data, NULL, length);
     DISABLE_MPU6500;
@@ -71,7 +77,7 @@ static void mpu6500SpiInit(void)
     IOInit(mpuSpi6500CsPin, OWNER_MPU_CS, 0);
     IOConfigGPIO(mpuSpi6500CsPin, SPI_IO_CS_CFG);
 
-    spiSetDivisor(MPU6500_SPI_INSTANCE, SPI_CLOCK_FAST);
+    spiBusDeviceInit(&mpuSpi6500Bus, MPU6500_SPI_INSTANCE, mpuSpi6500CsPin, SPI_CLOCK_FAST);
 
     hardwareInitialised = true;
 }
@@ -111,7 +117,7 @@ void mpu6500SpiAccInit(accDev_t *acc)
 
 void mpu6500SpiGyroInit(gyroDev_t *gyro)
 {
-    spiSetDivisor(MPU6500_SPI_INSTANCE, SPI_CLOCK_SLOW);
+    spiBusSetDivisor(&mpuSpi6500Bus, SPI_CLOCK_SLOW);
     delayMicroseconds(1);
 
     mpu6500GyroInit(gyro);
@@ -120,7 +126,7 @@ void mpu6500SpiGyroInit(gyroDev_t *gyro)
     mpu6500WriteRegister(MPU_RA_USER_CTRL, MPU6500_BIT_I2C_IF_DIS);
     delay(100);
 
-    spiSetDivisor(MPU6500_SPI_INSTANCE, SPI_CLOCK_FAST);
+    spiBusSetDivisor(&mpuSpi6500Bus, SPI_CLOCK_FAST);
     delayMicroseconds(1);
 }
 
@@ -144,6 +150,7 @@ bool mpu6500SpiGyroDetect(gyroDev_t *gyro)
 
     gyro->init = mpu6500SpiGyroInit;
     gyro->read = mpuGyroRead;
+    gyro->temperature = mpuGyroReadTemperature;
     gyro->intStatus = mpuCheckDataReady;
 
     // 16.4 dps/lsb scalefactor
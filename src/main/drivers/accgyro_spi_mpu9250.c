@@ -231,6 +231,7 @@ bool mpu9250SpiGyroDetect(gyroDev_t *gyro)
 
     gyro->init = mpu9250SpiGyroInit;
     gyro->read = mpuGyroRead;
+    gyro->temperature = mpuGyroReadTemperature;
     gyro->intStatus = mpuCheckDataReady;
 
     // 16.4 dps/lsb scalefactor
@@ -17,6 +17,8 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
+#include <math.h>
 
 #include "platform.h"
 
@@ -34,7 +36,11 @@
 
 #ifdef USE_ADC
 adcOperatingConfig_t adcOperatingConfig[ADC_CHANNEL_COUNT];
-volatile uint16_t adcValues[ADC_CHANNEL_COUNT];
+volatile uint16_t adcValues[ADC_CHANNEL_COUNT * ADC_SCAN_BUFFER_DEPTH];
+
+static uint8_t adcScanLength;                           // conversions per scan, 0 until the DMA runs
+static volatile uint32_t *adcDmaRemaining;              // DMA transfers left before the buffer wraps
+static uint8_t adcLastScanRead[ADC_CHANNEL_COUNT];      // newest scan used by the previous oversampled read
 
 uint8_t adcChannelByTag(ioTag_t ioTag)
 {
@@ -45,23 +51,94 @@ uint8_t adcChannelByTag(ioTag_t ioTag)
     return 0;
 }
 
+void adcScanBufferInit(uint8_t scanLength, volatile uint32_t *dmaRemaining)
+{
+    adcScanLength = scanLength;
+    adcDmaRemaining = dmaRemaining;
+    // the first scan the DMA writes follows the last one in the buffer
+    memset(adcLastScanRead, ADC_SCAN_BUFFER_DEPTH - 1, sizeof(adcLastScanRead));
+}
+
+// Newest scan in the buffer that has converted the given DMA index
+static uint8_t adcNewestScan(uint8_t dmaIndex)
+{
+    const uint16_t bufferLength = adcScanLength * ADC_SCAN_BUFFER_DEPTH;
+    const uint32_t remaining = *adcDmaRemaining;
+    const uint16_t next = (remaining == 0 || remaining > bufferLength) ? 0 : bufferLength - remaining;
+
+    if (next > dmaIndex) {
+        return (next - 1 - dmaIndex) / adcScanLength;
+    }
+    return ADC_SCAN_BUFFER_DEPTH - 1;
+}
+
+static uint16_t adcLatestValue(uint8_t channel)
+{
+    const uint8_t dmaIndex = adcOperatingConfig[channel].dmaIndex;
+
+    if (!adcScanLength) {
+        return adcValues[dmaIndex];
+    }
+    return adcValues[adcNewestScan(dmaIndex) * adcScanLength + dmaIndex];
+}
+
 uint16_t adcGetChannel(uint8_t channel)
 {
 #ifdef DEBUG_ADC_CHANNELS
     if (adcOperatingConfig[0].enabled) {
-        debug[0] = adcValues[adcOperatingConfig[0].dmaIndex];
+        debug[0] = adcLatestValue(0);
     }
     if (adcOperatingConfig[1].enabled) {
-        debug[1] = adcValues[adcOperatingConfig[1].dmaIndex];
+        debug[1] = adcLatestValue(1);
     }
     if (adcOperatingConfig[2].enabled) {
-        debug[2] = adcValues[adcOperatingConfig[2].dmaIndex];
+        debug[2] = adcLatestValue(2);
     }
     if (adcOperatingConfig[3].enabled) {
-        debug[3] = adcValues[adcOperatingConfig[3].dmaIndex];
+        debug[3] = adcLatestValue(3);
     }
 #endif
-    return adcValues[adcOperatingConfig[channel].dmaIndex];
+    return adcLatestValue(channel);
+}
+
+// Averages every conversion of the channel made since the previous call, so a
+// caller polling once per loop gets a boxcar average aligned to its own loop.
+// Whole turns of the buffer are lost to a caller reading less often than that.
+bool adcGetOversampledChannel(uint8_t channel, adcOversample_t *result)
+{
+    if (!adcScanLength || !adcOperatingConfig[channel].enabled) {
+        return false;
+    }
+
+    const uint8_t dmaIndex = adcOperatingConfig[channel].dmaIndex;
+    const uint8_t newest = adcNewestScan(dmaIndex);
+
+    const uint8_t count = (newest - adcLastScanRead[channel]) & (ADC_SCAN_BUFFER_DEPTH - 1);
+    adcLastScanRead[channel] = newest;
+
+    if (count == 0) {
+        return false;
+    }
+
+    uint32_t sum = 0;
+    uint32_t sumSquares = 0;
+    uint8_t scan = newest;
+    for (int i = 0; i < count; i++) {
+        const uint32_t value = adcValues[scan * adcScanLength + dmaIndex];
+        sum += value;
+        sumSquares += value * value;
+        scan = (scan - 1) & (ADC_SCAN_BUFFER_DEPTH - 1);
+    }
+
+    const float average = (float)sum / count;
+    const float variance = (float)sumSquares / count - average * average;
+
+    result->average = average;
+    result->noise = variance > 0.0f ? sqrtf(variance) : 0.0f;
+    result->count = count;
+    result->readTimeUs = micros();
+
+    return true;
 }
 
 #else
@@ -70,4 +147,11 @@ uint16_t adcGetChannel(uint8_t channel)
     UNUSED(channel);
     return 0;
 }
+
+bool adcGetOversampledChannel(uint8_t channel, adcOversample_t *result)
+{
+    UNUSED(channel);
+    UNUSED(result);
+    return false;
+}
 #endif
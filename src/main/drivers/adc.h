@@ -18,6 +18,7 @@
 #pragma once
 
 #include "io_types.h"
+#include "common/time.h"
 
 typedef enum {
     ADC_BATTERY   = 0,
@@ -49,5 +50,13 @@ typedef struct adcConfig_s {
     adcChannelConfig_t external1;
 } adcConfig_t;
 
+typedef struct adcOversample_s {
+    float average;          // mean of the conversions since the previous read, raw ADC units
+    float noise;            // standard deviation of those conversions
+    uint8_t count;          // conversions averaged
+    timeUs_t readTimeUs;    // when they were read, the ADC free-runs so the newest is at most one scan older
+} adcOversample_t;
+
 void adcInit(adcConfig_t *config);
 uint16_t adcGetChannel(uint8_t channel);
+bool adcGetOversampledChannel(uint8_t channel, adcOversample_t *result);
@@ -60,6 +60,11 @@ typedef struct adcDevice_s {
 extern const adcDevice_t adcHardware[];
 extern const adcTagMap_t adcTagMap[ADC_TAG_MAP_COUNT];
 extern adcOperatingConfig_t adcOperatingConfig[ADC_CHANNEL_COUNT];
-extern volatile uint16_t adcValues[ADC_CHANNEL_COUNT];
+// The DMA keeps the last ADC_SCAN_BUFFER_DEPTH scans of the enabled channels, so a
+// channel can be averaged over every conversion since it was last read. Power of two.
+#define ADC_SCAN_BUFFER_DEPTH 32
+
+extern volatile uint16_t adcValues[ADC_CHANNEL_COUNT * ADC_SCAN_BUFFER_DEPTH];
 
 uint8_t adcChannelByTag(ioTag_t ioTag);
+void adcScanBufferInit(uint8_t scanLength, volatile uint32_t *dmaRemaining);
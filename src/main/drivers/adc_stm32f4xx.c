@@ -150,9 +150,9 @@ void adcInit(adcConfig_t *config)
     DMA_InitStructure.DMA_Channel = adc.channel;
     DMA_InitStructure.DMA_Memory0BaseAddr = (uint32_t)adcValues;
     DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
-    DMA_InitStructure.DMA_BufferSize = configuredAdcChannels;
+    DMA_InitStructure.DMA_BufferSize = configuredAdcChannels * ADC_SCAN_BUFFER_DEPTH;
     DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
-    DMA_InitStructure.DMA_MemoryInc = configuredAdcChannels > 1 ? DMA_MemoryInc_Enable : DMA_MemoryInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
     DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
     DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
     DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
@@ -161,6 +161,8 @@ void adcInit(adcConfig_t *config)
 
     DMA_Cmd(adc.DMAy_Streamx, ENABLE);
 
+    adcScanBufferInit(configuredAdcChannels, &adc.DMAy_Streamx->NDTR);
+
     ADC_CommonInitTypeDef ADC_CommonInitStructure;
 
     ADC_CommonStructInit(&ADC_CommonInitStructure);
@@ -125,21 +125,37 @@ static void bmp280_get_ut(void)
 }
 
 #ifndef USE_BARO_SPI_BMP280
+// Measurement start and data reads are queued on the bus, the frame is decoded
+// from the read callback well before the next calculate.
+static i2cJob_t bmp280_meas_job;
+static i2cJob_t bmp280_data_job;
+static uint8_t bmp280_meas_mode = BMP280_MODE;
+static uint8_t bmp280_data[BMP280_DATA_FRAME_SIZE];
+
+static void bmp280_data_read_complete(i2cJob_t *job)
+{
+    if (job->state != I2C_JOB_DONE)
+        return;
+
+    bmp280_up = (int32_t)((((uint32_t)(bmp280_data[0])) << 12) | (((uint32_t)(bmp280_data[1])) << 4) | ((uint32_t)bmp280_data[2] >> 4));
+    bmp280_ut = (int32_t)((((uint32_t)(bmp280_data[3])) << 12) | (((uint32_t)(bmp280_data[4])) << 4) | ((uint32_t)bmp280_data[5] >> 4));
+}
+
 static void bmp280_start_up(void)
 {
     // start measurement
     // set oversampling + power mode (forced), and start sampling
-    i2cWrite(BARO_I2C_INSTANCE, BMP280_I2C_ADDR, BMP280_CTRL_MEAS_REG, BMP280_MODE);
+    if (!i2cJobBusy(&bmp280_meas_job))
+        i2cWriteAsync(BARO_I2C_INSTANCE, &bmp280_meas_job, BMP280_I2C_ADDR, BMP280_CTRL_MEAS_REG, 1, &bmp280_meas_mode);
 }
 
 static void bmp280_get_up(void)
 {
-    uint8_t data[BMP280_DATA_FRAME_SIZE];
-
     // read data from sensor
-    i2cRead(BARO_I2C_INSTANCE, BMP280_I2C_ADDR, BMP280_PRESSURE_MSB_REG, BMP280_DATA_FRAME_SIZE, data);
-    bmp280_up = (int32_t)((((uint32_t)(data[0])) << 12) | (((uint32_t)(data[1])) << 4) | ((uint32_t)data[2] >> 4));
-    bmp280_ut = (int32_t)((((uint32_t)(data[3])) << 12) | (((uint32_t)(data[4])) << 4) | ((uint32_t)data[5] >> 4));
+    if (i2cJobBusy(&bmp280_data_job))
+        return;
+    bmp280_data_job.callback = bmp280_data_read_complete;
+    i2cReadAsync(BARO_I2C_INSTANCE, &bmp280_data_job, BMP280_I2C_ADDR, BMP280_PRESSURE_MSB_REG, BMP280_DATA_FRAME_SIZE, bmp280_data);
 }
 #endif
 
@@ -47,7 +47,6 @@
 static void ms5611_reset(void);
 static uint16_t ms5611_prom(int8_t coef_num);
 STATIC_UNIT_TESTED int8_t ms5611_crc(uint16_t *prom);
-static uint32_t ms5611_read_adc(void);
 static void ms5611_start_ut(void);
 static void ms5611_get_ut(void);
 static void ms5611_start_up(void);
@@ -132,31 +131,63 @@ STATIC_UNIT_TESTED int8_t ms5611_crc(uint16_t *prom)
     return -1;
 }
 
-static uint32_t ms5611_read_adc(void)
+static uint32_t ms5611_decode_adc(const uint8_t *rxbuf)
 {
-    uint8_t rxbuf[3];
-    i2cRead(BARO_I2C_INSTANCE, MS5611_ADDR, CMD_ADC_READ, 3, rxbuf); // read ADC
     return (rxbuf[0] << 16) | (rxbuf[1] << 8) | rxbuf[2];
 }
 
+// The conversion start and ADC reads are queued on the bus, the results land
+// in ms5611_ut / ms5611_up from the job callbacks well before the next calculate.
+static i2cJob_t ms5611_adc_job;
+static i2cJob_t ms5611_conv_job;
+static uint8_t ms5611_adc_buf[3];
+static uint8_t ms5611_conv_data = 1;
+
+static void ms5611_ut_read_complete(i2cJob_t *job)
+{
+    if (job->state == I2C_JOB_DONE)
+        ms5611_ut = ms5611_decode_adc(ms5611_adc_buf);
+}
+
+static void ms5611_up_read_complete(i2cJob_t *job)
+{
+    if (job->state == I2C_JOB_DONE)
+        ms5611_up = ms5611_decode_adc(ms5611_adc_buf);
+}
+
+static void ms5611_read_adc(i2cJobCallbackPtr callback)
+{
+    if (i2cJobBusy(&ms5611_adc_job))
+        return;
+    ms5611_adc_job.callback = callback;
+    i2cReadAsync(BARO_I2C_INSTANCE, &ms5611_adc_job, MS5611_ADDR, CMD_ADC_READ, 3, ms5611_adc_buf); // read ADC
+}
+
+static void ms5611_start_conversion(uint8_t command)
+{
+    if (i2cJobBusy(&ms5611_conv_job))
+        return;
+    i2cWriteAsync(BARO_I2C_INSTANCE, &ms5611_conv_job, MS5611_ADDR, command, 1, &ms5611_conv_data);
+}
+
 static void ms5611_start_ut(void)
 {
-    i2cWrite(BARO_I2C_INSTANCE, MS5611_ADDR, CMD_ADC_CONV + CMD_ADC_D2 + ms5611_osr, 1); // D2 (temperature) conversion start!
+    ms5611_start_conversion(CMD_ADC_CONV + CMD_ADC_D2 + ms5611_osr); // D2 (temperature) conversion start!
 }
 
 static void ms5611_get_ut(void)
 {
-    ms5611_ut = ms5611_read_adc();
+    ms5611_read_adc(ms5611_ut_read_complete);
 }
 
 static void ms5611_start_up(void)
 {
-    i2cWrite(BARO_I2C_INSTANCE, MS5611_ADDR, CMD_ADC_CONV + CMD_ADC_D1 + ms5611_osr, 1); // D1 (pressure) conversion start!
+    ms5611_start_conversion(CMD_ADC_CONV + CMD_ADC_D1 + ms5611_osr); // D1 (pressure) conversion start!
 }
 
 static void ms5611_get_up(void)
 {
-    ms5611_up = ms5611_read_adc();
+    ms5611_read_adc(ms5611_up_read_complete);
 }
 
 STATIC_UNIT_TESTED void ms5611_calculate(int32_t *pressure, int32_t *temperature)
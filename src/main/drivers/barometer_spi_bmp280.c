@@ -28,17 +28,20 @@
 #include "io.h"
 
 #ifdef USE_BARO_SPI_BMP280
-#define DISABLE_BMP280       IOHi(bmp280CsPin)
-#define ENABLE_BMP280        IOLo(bmp280CsPin)
+#define DISABLE_BMP280       spiBusTransactionEnd(&bmp280Bus)
+#define ENABLE_BMP280        spiBusTransactionBegin(&bmp280Bus)
 
 extern int32_t bmp280_up;
 extern int32_t bmp280_ut;
 
 static IO_t bmp280CsPin = IO_NONE;
+static spiBusDevice_t bmp280Bus;
 
 bool bmp280WriteRegister(uint8_t reg, uint8_t data)
 {
-    ENABLE_BMP280;
+    if (!ENABLE_BMP280) {
+        return false;
+    }
     spiTransferByte(BMP280_SPI_INSTANCE, reg & 0x7F);
     spiTransferByte(BMP280_SPI_INSTANCE, data);
     DISABLE_BMP280;
@@ -48,7 +51,9 @@ bool bmp280WriteRegister(uint8_t reg, uint8_t data)
 
 bool bmp280ReadRegister(uint8_t reg, uint8_t length, uint8_t *data)
 {
-    ENABLE_BMP280;
+    if (!ENABLE_BMP280) {
+        return false;
+    }
     spiTransferByte(BMP280_SPI_INSTANCE, reg | 0x80); // read transaction
     spiTransfer(BMP280_SPI_INSTANCE, data, NULL, length);
     DISABLE_BMP280;
@@ -68,9 +73,9 @@ void bmp280SpiInit(void)
     IOInit(bmp280CsPin, OWNER_BARO_CS, 0);
     IOConfigGPIO(bmp280CsPin, IOCFG_OUT_PP);
 
-    DISABLE_BMP280;
+    IOHi(bmp280CsPin);
 
-    spiSetDivisor(BMP280_SPI_INSTANCE, SPI_CLOCK_STANDARD);
+    spiBusDeviceInit(&bmp280Bus, BMP280_SPI_INSTANCE, bmp280CsPin, SPI_CLOCK_STANDARD);
 
     hardwareInitialised = true;
 }
@@ -45,10 +45,8 @@ typedef struct i2cDevice_s {
     ioTag_t sda;
     rccPeriphTag_t rcc;
     bool overClock;
-#if !defined(STM32F303xC)
     uint8_t ev_irq;
     uint8_t er_irq;
-#endif
 #if defined(STM32F7)
     uint8_t af;
 #endif
@@ -66,9 +64,45 @@ typedef struct i2cState_s {
     volatile uint8_t* read_p;
 } i2cState_t;
 
+typedef enum {
+    I2C_JOB_IDLE = 0,
+    I2C_JOB_QUEUED,         // waiting behind other jobs on the bus
+    I2C_JOB_ACTIVE,         // on the bus
+    I2C_JOB_DONE,
+    I2C_JOB_FAILED
+} i2cJobState_e;
+
+struct i2cJob_s;
+typedef void (*i2cJobCallbackPtr)(struct i2cJob_s *job);   // runs in interrupt context
+
+// A transfer queued with i2cReadAsync()/i2cWriteAsync(). The job and its data
+// are owned by the caller and must stay valid until the job has completed.
+typedef struct i2cJob_s {
+    uint8_t addr;
+    uint8_t reg;
+    uint8_t len;
+    bool reading;
+    uint8_t *data;
+    i2cJobCallbackPtr callback;     // optional
+    volatile i2cJobState_e state;
+    struct i2cJob_s *next;
+} i2cJob_t;
+
+typedef struct i2cBusStats_s {
+    uint32_t transactionCount;
+    uint32_t busyTimeUs;        // time a job was on the bus
+    uint16_t errorCount;        // NACK, bus error or arbitration lost
+    uint16_t timeoutCount;      // transfers that stalled, e.g. a slave stretching the clock too long
+} i2cBusStats_t;
+
 void i2cInit(I2CDevice device);
 bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data);
 bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t data);
 bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf);
 
 uint16_t i2cGetErrorCounter(void);
+
+bool i2cReadAsync(I2CDevice device, i2cJob_t *job, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t *buf);
+bool i2cWriteAsync(I2CDevice device, i2cJob_t *job, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data);
+bool i2cJobBusy(const i2cJob_t *job);
+const i2cBusStats_t *i2cGetBusStats(I2CDevice device);
@@ -24,6 +24,7 @@
 #include "system.h"
 
 #include "bus_i2c.h"
+#include "bus_i2c_impl.h"
 #include "nvic.h"
 #include "io_impl.h"
 #include "rcc.h"
@@ -180,6 +181,22 @@ bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t
     return true;
 }
 
+// Transfers use the blocking HAL calls, jobs have completed by the time i2cSubmit() returns.
+bool i2cSubmit(I2CDevice device, i2cJob_t *job)
+{
+    i2cQueueAppend(device, job);
+
+    const bool success = job->reading
+        ? i2cRead(device, job->addr, job->reg, job->len, job->data)
+        : i2cWriteBuffer(device, job->addr, job->reg, job->len, job->data);
+    if (!success) {
+        i2cQueueCountError(device);
+    }
+
+    i2cQueueFinish(device, success);
+    return true;
+}
+
 void i2cInit(I2CDevice device)
 {
     /*## Configure the I2C clock source. The clock is derived from the SYSCLK #*/
@@ -0,0 +1,40 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "bus_i2c.h"
+
+// A job on the bus for longer than this has stalled and the bus is reset.
+#define I2C_JOB_TIMEOUT_US      10000
+
+// Implemented by the bus driver: queues the job and starts it if the bus is idle.
+bool i2cSubmit(I2CDevice device, i2cJob_t *job);
+
+// Job queue shared by the bus drivers. i2cQueueAppend() must not be interrupted
+// by the bus interrupt handler, which calls i2cQueueFinish().
+bool i2cQueueAppend(I2CDevice device, i2cJob_t *job);
+i2cJob_t *i2cQueueFinish(I2CDevice device, bool success);
+i2cJob_t *i2cQueueHead(I2CDevice device);
+bool i2cQueueStalled(I2CDevice device);
+void i2cQueueAbort(I2CDevice device);
+// The bus interrupt handlers never reset the bus, i2cInit() and unsticking it take far too long there.
+// They fail the queue instead, and the next caller in task context resets the bus and calls i2cQueueAbort().
+void i2cQueueFail(I2CDevice device);
+bool i2cQueueResetPending(I2CDevice device);
+void i2cQueueCountError(I2CDevice device);
+void i2cQueueCountTimeout(I2CDevice device);
@@ -0,0 +1,187 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <platform.h>
+
+#include "bus_i2c.h"
+#include "bus_i2c_impl.h"
+#include "system.h"
+
+typedef struct i2cJobQueue_s {
+    i2cJob_t * volatile head;   // job on the bus, NULL while the bus is idle, changed by the bus interrupt
+    i2cJob_t *tail;
+    uint32_t headStartedAtUs;
+    volatile bool resetPending; // failed in interrupt context, the bus has not been reset since
+    i2cBusStats_t stats;
+} i2cJobQueue_t;
+
+static i2cJobQueue_t i2cJobQueue[I2CDEV_COUNT];
+
+static bool i2cValidDevice(I2CDevice device)
+{
+    return device > I2CINVALID && device < I2CDEV_COUNT;
+}
+
+bool i2cJobBusy(const i2cJob_t *job)
+{
+    return job->state == I2C_JOB_QUEUED || job->state == I2C_JOB_ACTIVE;
+}
+
+bool i2cReadAsync(I2CDevice device, i2cJob_t *job, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t *buf)
+{
+    if (!i2cValidDevice(device) || i2cJobBusy(job)) {
+        return false;
+    }
+
+    job->addr = addr_;
+    job->reg = reg_;
+    job->len = len;
+    job->reading = true;
+    job->data = buf;
+
+    return i2cSubmit(device, job);
+}
+
+bool i2cWriteAsync(I2CDevice device, i2cJob_t *job, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+{
+    if (!i2cValidDevice(device) || i2cJobBusy(job)) {
+        return false;
+    }
+
+    job->addr = addr_;
+    job->reg = reg_;
+    job->len = len_;
+    job->reading = false;
+    job->data = data;
+
+    return i2cSubmit(device, job);
+}
+
+// Returns true if the bus was idle, the caller must then start the job.
+bool i2cQueueAppend(I2CDevice device, i2cJob_t *job)
+{
+    i2cJobQueue_t *queue = &i2cJobQueue[device];
+
+    job->next = NULL;
+    if (queue->head) {
+        job->state = I2C_JOB_QUEUED;
+        queue->tail->next = job;
+        queue->tail = job;
+        return false;
+    }
+
+    job->state = I2C_JOB_ACTIVE;
+    queue->head = job;
+    queue->tail = job;
+    queue->headStartedAtUs = micros();
+    return true;
+}
+
+// Completes the job on the bus and returns the next one to start, if any.
+i2cJob_t *i2cQueueFinish(I2CDevice device, bool success)
+{
+    i2cJobQueue_t *queue = &i2cJobQueue[device];
+    i2cJob_t *job = queue->head;
+
+    if (!job) {
+        return NULL;
+    }
+
+    const uint32_t nowUs = micros();
+    queue->stats.transactionCount++;
+    queue->stats.busyTimeUs += nowUs - queue->headStartedAtUs;
+
+    queue->head = job->next;
+    if (!queue->head) {
+        queue->tail = NULL;
+    } else {
+        queue->head->state = I2C_JOB_ACTIVE;
+        queue->headStartedAtUs = nowUs;
+    }
+
+    job->state = success ? I2C_JOB_DONE : I2C_JOB_FAILED;
+    if (job->callback) {
+        job->callback(job);
+    }
+
+    return queue->head;
+}
+
+i2cJob_t *i2cQueueHead(I2CDevice device)
+{
+    return i2cJobQueue[device].head;
+}
+
+bool i2cQueueStalled(I2CDevice device)
+{
+    const i2cJobQueue_t *queue = &i2cJobQueue[device];
+    return queue->head && (micros() - queue->headStartedAtUs) > I2C_JOB_TIMEOUT_US;
+}
+
+// Fails every queued job, used once the bus has been reset.
+void i2cQueueAbort(I2CDevice device)
+{
+    i2cJobQueue_t *queue = &i2cJobQueue[device];
+    i2cJob_t *job = queue->head;
+
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->resetPending = false;
+
+    while (job) {
+        i2cJob_t *next = job->next;
+        job->state = I2C_JOB_FAILED;
+        if (job->callback) {
+            job->callback(job);
+        }
+        job = next;
+    }
+}
+
+// Fails every queued job from the interrupt handlers, the bus is reset later from task context.
+void i2cQueueFail(I2CDevice device)
+{
+    i2cQueueAbort(device);
+    i2cJobQueue[device].resetPending = true;
+}
+
+bool i2cQueueResetPending(I2CDevice device)
+{
+    return i2cJobQueue[device].resetPending;
+}
+
+void i2cQueueCountError(I2CDevice device)
+{
+    i2cJobQueue[device].stats.errorCount++;
+}
+
+void i2cQueueCountTimeout(I2CDevice device)
+{
+    i2cJobQueue[device].stats.timeoutCount++;
+}
+
+const i2cBusStats_t *i2cGetBusStats(I2CDevice device)
+{
+    if (!i2cValidDevice(device)) {
+        return NULL;
+    }
+    return &i2cJobQueue[device].stats;
+}
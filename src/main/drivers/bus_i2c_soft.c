@@ -23,6 +23,7 @@
 #include "build/build_config.h"
 
 #include "bus_i2c.h"
+#include "bus_i2c_impl.h"
 #include "io.h"
 
 // Software I2C driver, using same pins as hardware I2C, with hw i2c module disabled.
@@ -258,6 +259,22 @@ bool i2cRead(I2CDevice device, uint8_t addr, uint8_t reg, uint8_t len, uint8_t *
     return true;
 }
 
+// Bit banged transfers cannot run in the background, jobs have completed by the time i2cSubmit() returns.
+bool i2cSubmit(I2CDevice device, i2cJob_t *job)
+{
+    i2cQueueAppend(device, job);
+
+    const bool success = job->reading
+        ? i2cRead(device, job->addr, job->reg, job->len, job->data)
+        : i2cWriteBuffer(device, job->addr, job->reg, job->len, job->data);
+    if (!success) {
+        i2cQueueCountError(device);
+    }
+
+    i2cQueueFinish(device, success);
+    return true;
+}
+
 uint16_t i2cGetErrorCounter(void)
 {
     return i2cErrorCount;
@@ -25,6 +25,7 @@
 #include "system.h"
 
 #include "bus_i2c.h"
+#include "bus_i2c_impl.h"
 #include "nvic.h"
 #include "io_impl.h"
 #include "rcc.h"
@@ -125,20 +126,48 @@ void I2C3_EV_IRQHandler(void) {
 }
 #endif
 
+static bool i2cInInterrupt(void)
+{
+    return SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk;
+}
+
 static bool i2cHandleHardwareFailure(I2CDevice device)
 {
     i2cErrorCount++;
+    i2cQueueCountTimeout(device);
+    if (i2cInInterrupt()) {
+        // quiet the handlers and leave the reset to the next i2cSubmit() or wait in task context
+        I2C_ITConfig(i2cHardwareMap[device].dev, I2C_IT_EVT | I2C_IT_BUF | I2C_IT_ERR, DISABLE);
+        i2cQueueFail(device);
+        return false;
+    }
     // reinit peripheral + clock out garbage
     i2cInit(device);
+    i2cQueueAbort(device);
     return false;
 }
 
-bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+// Resets the bus from task context after a failure in the interrupt handlers, false while that is still to be done
+static bool i2cResetIfFailed(I2CDevice device)
 {
-
-    if (device == I2CINVALID)
+    if (!i2cQueueResetPending(device)) {
+        return true;
+    }
+    if (i2cInInterrupt()) {
         return false;
+    }
+    i2cInit(device);
+    i2cQueueAbort(device);
+    return true;
+}
+
+// A stop takes one SCL period once the last byte is in, allow a few at the slowest bus clock.
+#define I2C_STOP_WAIT_ISR_US    50
 
+// Loads the job into the interrupt handler state and sends the start, from task or interrupt context.
+// From the interrupt handler the wait for the previous stop is bounded in time rather than by a loop count.
+static bool i2cStartJob(I2CDevice device, i2cJob_t *job, bool fromIsr)
+{
     uint32_t timeout = I2C_DEFAULT_TIMEOUT;
 
     I2C_TypeDef *I2Cx;
@@ -147,78 +176,115 @@ bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_,
     i2cState_t *state;
     state = &(i2cState[device]);
 
-    state->addr = addr_ << 1;
-    state->reg = reg_;
-    state->writing = 1;
-    state->reading = 0;
-    state->write_p = data;
-    state->read_p = data;
-    state->bytes = len_;
+    state->addr = job->addr << 1;
+    state->reg = job->reg;
+    state->writing = !job->reading;
+    state->reading = job->reading;
+    state->write_p = job->data;
+    state->read_p = job->data;
+    state->bytes = job->len;
     state->busy = 1;
     state->error = false;
 
     if (!(I2Cx->CR2 & I2C_IT_EVT)) {                                    // if we are restarting the driver
         if (!(I2Cx->CR1 & I2C_CR1_START)) {                             // ensure sending a start
-            while (I2Cx->CR1 & I2C_CR1_STOP && --timeout > 0) {; }     // wait for any stop to finish sending
-            if (timeout == 0)
-                return i2cHandleHardwareFailure(device);
+            if (fromIsr) {
+                const uint32_t waitStartUs = micros();
+                while (I2Cx->CR1 & I2C_CR1_STOP) {                      // wait for the stop the handler just programmed
+                    if (micros() - waitStartUs > I2C_STOP_WAIT_ISR_US)
+                        return false;
+                }
+            } else {
+                while (I2Cx->CR1 & I2C_CR1_STOP && --timeout > 0) {; } // wait for any stop to finish sending
+                if (timeout == 0)
+                    return false;
+            }
             I2C_GenerateSTART(I2Cx, ENABLE);                            // send the start for the new job
         }
         I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);            // allow the interrupts to fire off again
     }
 
-    timeout = I2C_DEFAULT_TIMEOUT;
-    while (state->busy && --timeout > 0) {; }
-    if (timeout == 0)
-        return i2cHandleHardwareFailure(device);
-
-    return !(state->error);
+    return true;
 }
 
-bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t data)
+// Called from the interrupt handlers when the job on the bus has finished, starts the next one.
+static void i2cJobComplete(I2CDevice device)
 {
-    return i2cWriteBuffer(device, addr_, reg_, 1, &data);
+    i2cState_t *state;
+    state = &(i2cState[device]);
+
+    state->busy = 0;
+
+    i2cJob_t *next = i2cQueueFinish(device, !state->error);
+    if (next && !i2cStartJob(device, next, true)) {
+        i2cHandleHardwareFailure(device);
+    }
 }
 
-bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
+bool i2cSubmit(I2CDevice device, i2cJob_t *job)
 {
-    if (device == I2CINVALID)
+    if (i2cQueueStalled(device)) {
+        i2cHandleHardwareFailure(device);
+    }
+    if (!i2cResetIfFailed(device)) {
         return false;
+    }
 
-    uint32_t timeout = I2C_DEFAULT_TIMEOUT;
-
-    I2C_TypeDef *I2Cx;
-    I2Cx = i2cHardwareMap[device].dev;
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const bool startNow = i2cQueueAppend(device, job);
+    __set_PRIMASK(primask);
 
-    i2cState_t *state;
-    state = &(i2cState[device]);
+    if (startNow && !i2cStartJob(device, job, false)) {
+        return i2cHandleHardwareFailure(device);
+    }
 
-    state->addr = addr_ << 1;
-    state->reg = reg_;
-    state->writing = 0;
-    state->reading = 1;
-    state->read_p = buf;
-    state->write_p = buf;
-    state->bytes = len;
-    state->busy = 1;
-    state->error = false;
+    return true;
+}
 
-    if (!(I2Cx->CR2 & I2C_IT_EVT)) {                                    // if we are restarting the driver
-        if (!(I2Cx->CR1 & I2C_CR1_START)) {                             // ensure sending a start
-            while (I2Cx->CR1 & I2C_CR1_STOP && --timeout > 0) {; }     // wait for any stop to finish sending
-            if (timeout == 0)
-                return i2cHandleHardwareFailure(device);
-            I2C_GenerateSTART(I2Cx, ENABLE);                            // send the start for the new job
+// Waits for a job, the timeout restarts whenever the bus moves on to another job.
+static bool i2cWaitForJob(I2CDevice device, i2cJob_t *job)
+{
+    uint32_t timeout = I2C_DEFAULT_TIMEOUT;
+    const i2cJob_t *active = NULL;
+
+    while (i2cJobBusy(job)) {
+        const i2cJob_t *head = i2cQueueHead(device);
+        if (head != active) {
+            active = head;
+            timeout = I2C_DEFAULT_TIMEOUT;
+        } else if (--timeout == 0) {
+            return i2cHandleHardwareFailure(device);
         }
-        I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, ENABLE);            // allow the interrupts to fire off again
     }
+    i2cResetIfFailed(device);
 
-    timeout = I2C_DEFAULT_TIMEOUT;
-    while (state->busy && --timeout > 0) {; }
-    if (timeout == 0)
-        return i2cHandleHardwareFailure(device);
+    return job->state == I2C_JOB_DONE;
+}
+
+bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+{
+    i2cJob_t job = { .callback = NULL, .state = I2C_JOB_IDLE };
 
-    return !(state->error);
+    if (!i2cWriteAsync(device, &job, addr_, reg_, len_, data))
+        return false;
+
+    return i2cWaitForJob(device, &job);
+}
+
+bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t data)
+{
+    return i2cWriteBuffer(device, addr_, reg_, 1, &data);
+}
+
+bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len, uint8_t* buf)
+{
+    i2cJob_t job = { .callback = NULL, .state = I2C_JOB_IDLE };
+
+    if (!i2cReadAsync(device, &job, addr_, reg_, len, buf))
+        return false;
+
+    return i2cWaitForJob(device, &job);
 }
 
 static void i2c_er_handler(I2CDevice device) {
@@ -232,8 +298,10 @@ static void i2c_er_handler(I2CDevice device) {
     // Read the I2C1 status register
     volatile uint32_t SR1Register = I2Cx->SR1;
 
-    if (SR1Register & 0x0F00)                                           // an error
+    if (SR1Register & 0x0F00) {                                         // an error
         state->error = true;
+        i2cQueueCountError(device);
+    }
 
     // If AF, BERR or ARLO, abandon the current job and commence new if there are jobs
     if (SR1Register & 0x0700) {
@@ -244,7 +312,7 @@ static void i2c_er_handler(I2CDevice device) {
                 while (I2Cx->CR1 & I2C_CR1_START) {; }                         // wait for any start to finish sending
                 I2C_GenerateSTOP(I2Cx, ENABLE);                                 // send stop to finalise bus transaction
                 while (I2Cx->CR1 & I2C_CR1_STOP) {; }                          // wait for stop to finish sending
-                i2cInit(device);                                                // reset and configure the hardware
+                i2cHandleHardwareFailure(device);                               // the hardware is reset from task context
             }
             else {
                 I2C_GenerateSTOP(I2Cx, ENABLE);                                 // stop to free up the bus
@@ -253,7 +321,7 @@ static void i2c_er_handler(I2CDevice device) {
         }
     }
     I2Cx->SR1 &= ~0x0F00;                                                       // reset all the error bits to clear the interrupt
-    state->busy = 0;
+    i2cJobComplete(device);
 }
 
 void i2c_ev_handler(I2CDevice device) {
@@ -369,7 +437,7 @@ void i2c_ev_handler(I2CDevice device) {
         subaddress_sent = 0;                                            // reset this here
         if (final_stop)                                                 // If there is a final stop and no more jobs, bus is inactive, disable interrupts to prevent BTF
             I2C_ITConfig(I2Cx, I2C_IT_EVT | I2C_IT_ERR, DISABLE);       // Disable EVT and ERR interrupts while bus inactive
-        state->busy = 0;
+        i2cJobComplete(device);
     }
 }
 
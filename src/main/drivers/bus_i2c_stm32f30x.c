@@ -24,8 +24,10 @@
 #include "io.h"
 #include "io_impl.h"
 #include "rcc.h"
+#include "nvic.h"
 
 #include "bus_i2c.h"
+#include "bus_i2c_impl.h"
 
 #ifndef SOFT_I2C
 
@@ -38,8 +40,6 @@
 #define I2C_HIGHSPEED_TIMING  0x00500E30  // 1000 Khz, 72Mhz Clock, Analog Filter Delay ON, Setup 40, Hold 4.
 #define I2C_STANDARD_TIMING   0x00E0257A  // 400 Khz, 72Mhz Clock, Analog Filter Delay ON, Rise 100, Fall 10.
 
-#define I2C_SHORT_TIMEOUT   ((uint32_t)0x1000)
-#define I2C_LONG_TIMEOUT    ((uint32_t)(10 * I2C_SHORT_TIMEOUT))
 #define I2C_GPIO_AF         GPIO_AF_4
 
 #ifndef I2C1_SCL
@@ -55,25 +55,55 @@
 #define I2C2_SDA PA10
 #endif
 
-static uint32_t i2cTimeout;
+// BST owns the I2C interrupt vectors on the targets using it, the bus is polled there instead
+#ifdef USE_BST
+#define I2C_POLLED
+#endif
+
+// SCL held low by a slave for longer than this raises a TIMEOUT error, (TIMEOUTA + 1) * 2048 / 72MHz ~= 25ms
+#define I2C_SCL_LOW_TIMEOUT   0x036F
 
 static volatile uint16_t i2cErrorCount = 0;
-//static volatile uint16_t i2c2ErrorCount = 0;
 
 static i2cDevice_t i2cHardwareMap[] = {
-    { .dev = I2C1, .scl = IO_TAG(I2C1_SCL), .sda = IO_TAG(I2C1_SDA), .rcc = RCC_APB1(I2C1), .overClock = I2C1_OVERCLOCK },
-    { .dev = I2C2, .scl = IO_TAG(I2C2_SCL), .sda = IO_TAG(I2C2_SDA), .rcc = RCC_APB1(I2C2), .overClock = I2C2_OVERCLOCK }
+    { .dev = I2C1, .scl = IO_TAG(I2C1_SCL), .sda = IO_TAG(I2C1_SDA), .rcc = RCC_APB1(I2C1), .overClock = I2C1_OVERCLOCK, .ev_irq = I2C1_EV_IRQn, .er_irq = I2C1_ER_IRQn },
+    { .dev = I2C2, .scl = IO_TAG(I2C2_SCL), .sda = IO_TAG(I2C2_SDA), .rcc = RCC_APB1(I2C2), .overClock = I2C2_OVERCLOCK, .ev_irq = I2C2_EV_IRQn, .er_irq = I2C2_ER_IRQn }
 };
 
-///////////////////////////////////////////////////////////////////////////////
-// I2C TimeoutUserCallback
-///////////////////////////////////////////////////////////////////////////////
+// Progress of the job on the bus, owned by the interrupt handlers once the job has started
+typedef struct i2cTransfer_s {
+    i2cJob_t *job;
+    uint8_t index;              // data bytes transferred
+    bool regSent;
+    bool error;
+} i2cTransfer_t;
+
+static i2cTransfer_t i2cTransfer[2];
 
-uint32_t i2cTimeoutUserCallback(void)
+static void i2c_er_handler(I2CDevice device);
+static void i2c_ev_handler(I2CDevice device);
+
+#ifndef I2C_POLLED
+void I2C1_ER_IRQHandler(void)
 {
-    i2cErrorCount++;
-    return false;
+    i2c_er_handler(I2CDEV_1);
+}
+
+void I2C1_EV_IRQHandler(void)
+{
+    i2c_ev_handler(I2CDEV_1);
+}
+
+void I2C2_ER_IRQHandler(void)
+{
+    i2c_er_handler(I2CDEV_2);
+}
+
+void I2C2_EV_IRQHandler(void)
+{
+    i2c_ev_handler(I2CDEV_2);
 }
+#endif
 
 void i2cInit(I2CDevice device)
 {
@@ -110,6 +140,28 @@ void i2cInit(I2CDevice device)
 
     I2C_StretchClockCmd(I2Cx, ENABLE);
 
+    I2C_TimeoutAConfig(I2Cx, I2C_SCL_LOW_TIMEOUT);
+    I2C_ClockTimeoutCmd(I2Cx, ENABLE);
+
+    i2cTransfer[device].job = NULL;
+
+#ifndef I2C_POLLED
+    I2C_ITConfig(I2Cx, I2C_IT_TXI | I2C_IT_RXI | I2C_IT_TCI | I2C_IT_STOPI | I2C_IT_NACKI | I2C_IT_ERRI, ENABLE);
+
+    NVIC_InitTypeDef nvic;
+
+    nvic.NVIC_IRQChannel = i2c->er_irq;
+    nvic.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_I2C_ER);
+    nvic.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_I2C_ER);
+    nvic.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&nvic);
+
+    nvic.NVIC_IRQChannel = i2c->ev_irq;
+    nvic.NVIC_IRQChannelPreemptionPriority = NVIC_PRIORITY_BASE(NVIC_PRIO_I2C_EV);
+    nvic.NVIC_IRQChannelSubPriority = NVIC_PRIORITY_SUB(NVIC_PRIO_I2C_EV);
+    NVIC_Init(&nvic);
+#endif
+
     I2C_Cmd(I2Cx, ENABLE);
 }
 
@@ -118,144 +170,228 @@ uint16_t i2cGetErrorCounter(void)
     return i2cErrorCount;
 }
 
-bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t data)
+static bool i2cInInterrupt(void)
 {
-    addr_ <<= 1;
+    return SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk;
+}
 
-    I2C_TypeDef *I2Cx;
-    I2Cx = i2cHardwareMap[device].dev;
+static bool i2cHandleHardwareFailure(I2CDevice device)
+{
+    i2cErrorCount++;
+    i2cQueueCountTimeout(device);
+    if (i2cInInterrupt()) {
+        // from a job callback, leave the reset to the next i2cSubmit() or wait in task context
+        I2C_SoftwareResetCmd(i2cHardwareMap[device].dev);
+        i2cTransfer[device].job = NULL;
+        i2cQueueFail(device);
+        return false;
+    }
+    i2cInit(device);
+    i2cQueueAbort(device);
+    return false;
+}
 
-    /* Test on BUSY Flag */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_BUSY) != RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+// Resets the bus from task context after a failure in interrupt context, false while that is still to be done
+static bool i2cResetIfFailed(I2CDevice device)
+{
+    if (!i2cQueueResetPending(device)) {
+        return true;
     }
+    if (i2cInInterrupt()) {
+        return false;
+    }
+    i2cInit(device);
+    i2cQueueAbort(device);
+    return true;
+}
+
+// Sends the start for the job, the rest of the transfer is driven by the event handler.
+static void i2cStartJob(I2CDevice device, i2cJob_t *job)
+{
+    I2C_TypeDef *I2Cx = i2cHardwareMap[device].dev;
+    i2cTransfer_t *transfer = &i2cTransfer[device];
+
+    transfer->job = job;
+    transfer->index = 0;
+    transfer->regSent = (job->reg == 0xFF);     // 0xFF as register means there is none to send
+    transfer->error = false;
+
+    if (job->reading && !transfer->regSent) {
+        // send the register with a software end, the read follows on TC with a repeated start
+        I2C_TransferHandling(I2Cx, job->addr << 1, 1, I2C_SoftEnd_Mode, I2C_Generate_Start_Write);
+    } else if (job->reading) {
+        I2C_TransferHandling(I2Cx, job->addr << 1, job->len, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
+    } else {
+        I2C_TransferHandling(I2Cx, job->addr << 1, job->len + (transfer->regSent ? 0 : 1), I2C_AutoEnd_Mode, I2C_Generate_Start_Write);
+    }
+}
 
-    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
-    I2C_TransferHandling(I2Cx, addr_, 1, I2C_Reload_Mode, I2C_Generate_Start_Write);
+static void i2cJobComplete(I2CDevice device)
+{
+    i2cTransfer_t *transfer = &i2cTransfer[device];
+    const bool success = !transfer->error && transfer->index == transfer->job->len;
 
-    /* Wait until TXIS flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TXIS) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+    transfer->job = NULL;
+
+    i2cJob_t *next = i2cQueueFinish(device, success);
+    if (next) {
+        i2cStartJob(device, next);
     }
+}
 
-    /* Send Register address */
-    I2C_SendData(I2Cx, (uint8_t) reg);
+static void i2c_ev_handler(I2CDevice device)
+{
+    I2C_TypeDef *I2Cx = i2cHardwareMap[device].dev;
+    i2cTransfer_t *transfer = &i2cTransfer[device];
+    i2cJob_t *job = transfer->job;
+    const uint32_t isr = I2Cx->ISR;
 
-    /* Wait until TCR flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TCR) == RESET)
-    {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+    if (!job) {
+        return;
     }
 
-    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
-    I2C_TransferHandling(I2Cx, addr_, 1, I2C_AutoEnd_Mode, I2C_No_StartStop);
+    if (isr & I2C_ISR_NACKF) {
+        // the master sends a stop after a NACK, the job completes on STOPF
+        I2Cx->ICR = I2C_ICR_NACKCF;
+        transfer->error = true;
+        i2cQueueCountError(device);
+    }
 
-    /* Wait until TXIS flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TXIS) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
+    if (isr & I2C_ISR_TXIS) {
+        if (!transfer->regSent) {
+            I2Cx->TXDR = job->reg;
+            transfer->regSent = true;
+        } else {
+            I2Cx->TXDR = job->data[transfer->index++];
         }
     }
 
-    /* Write data to TXDR */
-    I2C_SendData(I2Cx, data);
-
-    /* Wait until STOPF flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_STOPF) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
+    if (isr & I2C_ISR_RXNE) {
+        const uint8_t data = I2Cx->RXDR;
+        if (transfer->index < job->len) {
+            job->data[transfer->index++] = data;
         }
     }
 
-    /* Clear STOPF flag */
-    I2C_ClearFlag(I2Cx, I2C_ICR_STOPCF);
+    if (isr & I2C_ISR_TC) {
+        // register sent, a repeated start for the read clears TC
+        I2C_TransferHandling(I2Cx, job->addr << 1, job->len, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
+    }
 
-    return true;
+    if (isr & I2C_ISR_STOPF) {
+        I2Cx->ICR = I2C_ICR_STOPCF;
+        i2cJobComplete(device);
+    }
 }
 
-bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf)
+static void i2c_er_handler(I2CDevice device)
 {
-    addr_ <<= 1;
+    I2C_TypeDef *I2Cx = i2cHardwareMap[device].dev;
+    i2cTransfer_t *transfer = &i2cTransfer[device];
+    const uint32_t isr = I2Cx->ISR;
 
-    I2C_TypeDef *I2Cx;
-    I2Cx = i2cHardwareMap[device].dev;
+    if (!(isr & (I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR | I2C_ISR_TIMEOUT))) {
+        return;
+    }
 
-    /* Test on BUSY Flag */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_BUSY) != RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+    if (isr & I2C_ISR_TIMEOUT) {
+        i2cErrorCount++;
+        i2cQueueCountTimeout(device);
+    } else {
+        i2cQueueCountError(device);
     }
 
-    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
-    I2C_TransferHandling(I2Cx, addr_, 1, I2C_SoftEnd_Mode, I2C_Generate_Start_Write);
+    // no stop follows a bus error or lost arbitration, reset the peripheral to release the bus and fail the job
+    I2Cx->ICR = I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF | I2C_ICR_TIMOUTCF;
+    I2C_SoftwareResetCmd(I2Cx);
 
-    /* Wait until TXIS flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TXIS) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+    if (transfer->job) {
+        transfer->error = true;
+        i2cJobComplete(device);
     }
+}
 
-    /* Send Register address */
-    I2C_SendData(I2Cx, (uint8_t) reg);
-
-    /* Wait until TC flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_TC) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
-        }
+bool i2cSubmit(I2CDevice device, i2cJob_t *job)
+{
+    if (device != I2CDEV_1 && device != I2CDEV_2) {
+        return false;
     }
 
-    /* Configure slave address, nbytes, reload, end mode and start or stop generation */
-    I2C_TransferHandling(I2Cx, addr_, len, I2C_AutoEnd_Mode, I2C_Generate_Start_Read);
-
-    /* Wait until all data are received */
-    while (len) {
-        /* Wait until RXNE flag is set */
-        i2cTimeout = I2C_LONG_TIMEOUT;
-        while (I2C_GetFlagStatus(I2Cx, I2C_ISR_RXNE) == RESET) {
-            if ((i2cTimeout--) == 0) {
-                return i2cTimeoutUserCallback();
-            }
-        }
+    if (!job->reading && job->len == 0xFF) {
+        return false;   // register and data must fit one transfer
+    }
 
-        /* Read data from RXDR */
-        *buf = I2C_ReceiveData(I2Cx);
-        /* Point to the next location where the byte read will be saved */
-        buf++;
+    if (i2cQueueStalled(device)) {
+        i2cHandleHardwareFailure(device);
+    }
+    if (!i2cResetIfFailed(device)) {
+        return false;
+    }
 
-        /* Decrement the read bytes counter */
-        len--;
+    const uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const bool startNow = i2cQueueAppend(device, job);
+    if (startNow) {
+        i2cStartJob(device, job);
     }
+    __set_PRIMASK(primask);
+
+#ifdef I2C_POLLED
+    while (i2cJobBusy(job)) {
+        i2c_er_handler(device);
+        i2c_ev_handler(device);
+        if (i2cQueueStalled(device)) {
+            return i2cHandleHardwareFailure(device);
+        }
+    }
+#endif
+
+    return true;
+}
 
-    /* Wait until STOPF flag is set */
-    i2cTimeout = I2C_LONG_TIMEOUT;
-    while (I2C_GetFlagStatus(I2Cx, I2C_ISR_STOPF) == RESET) {
-        if ((i2cTimeout--) == 0) {
-            return i2cTimeoutUserCallback();
+// Waits for a job, the timeout restarts whenever the bus moves on to another job.
+static bool i2cWaitForJob(I2CDevice device, i2cJob_t *job)
+{
+    const i2cJob_t *active = NULL;
+    uint32_t timeout = I2C_LONG_TIMEOUT;
+
+    while (i2cJobBusy(job)) {
+        const i2cJob_t *head = i2cQueueHead(device);
+        if (head != active) {
+            active = head;
+            timeout = I2C_LONG_TIMEOUT;
+        } else if (--timeout == 0) {
+            return i2cHandleHardwareFailure(device);
         }
     }
+    i2cResetIfFailed(device);
 
-    /* Clear STOPF flag */
-    I2C_ClearFlag(I2Cx, I2C_ICR_STOPCF);
+    return job->state == I2C_JOB_DONE;
+}
 
-    /* If all operations OK */
-    return true;
+bool i2cWriteBuffer(I2CDevice device, uint8_t addr_, uint8_t reg_, uint8_t len_, uint8_t *data)
+{
+    i2cJob_t job = { .callback = NULL, .state = I2C_JOB_IDLE };
+
+    if (!i2cWriteAsync(device, &job, addr_, reg_, len_, data))
+        return false;
+
+    return i2cWaitForJob(device, &job);
+}
+
+bool i2cWrite(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t data)
+{
+    return i2cWriteBuffer(device, addr_, reg, 1, &data);
+}
+
+bool i2cRead(I2CDevice device, uint8_t addr_, uint8_t reg, uint8_t len, uint8_t* buf)
+{
+    i2cJob_t job = { .callback = NULL, .state = I2C_JOB_IDLE };
+
+    if (!i2cReadAsync(device, &job, addr_, reg, len, buf))
+        return false;
+
+    return i2cWaitForJob(device, &job);
 }
 
 #endif
@@ -299,55 +299,54 @@ void spiSetDivisor(SPI_TypeDef *instance, uint16_t divisor)
 {
 #define BR_CLEAR_MASK 0xFFC7
 
-    uint16_t tempRegister;
-
-    SPI_Cmd(instance, DISABLE);
-
-    tempRegister = instance->CR1;
+    uint16_t prescaler;
 
     switch (divisor) {
     case 2:
-        tempRegister &= BR_CLEAR_MASK;
-        tempRegister |= SPI_BaudRatePrescaler_2;
+        prescaler = SPI_BaudRatePrescaler_2;
         break;
 
     case 4:
-        tempRegister &= BR_CLEAR_MASK;
-        tempRegister |= SPI_BaudRatePrescaler_4;
+        prescaler = SPI_BaudRatePrescaler_4;
         break;
 
     case 8:
-        tempRegister &= BR_CLEAR_MASK;
-        tempRegister |= SPI_BaudRatePrescaler_8;
+        prescaler = SPI_BaudRatePrescaler_8;
         break;
 
     case 16:
-        tempRegister &= BR_CLEAR_MASK;
-        tempRegister |= SPI_BaudRatePrescaler_16;
+        prescaler = SPI_BaudRatePrescaler_16;
         break;
 
     case 32:
-        tempRegister &= BR_CLEAR_MASK;
-        tempRegister |= SPI_BaudRatePrescaler_32;
+        prescaler = SPI_BaudRatePrescaler_32;
         break;
 
     case 64:
-        tempRegister &= BR_CLEAR_MASK;
-        tempRegister |= SPI_BaudRatePrescaler_64;
+        prescaler = SPI_BaudRatePrescaler_64;
         break;
 
     case 128:
-        tempRegister &= BR_CLEAR_MASK;
-        tempRegister |= SPI_BaudRatePrescaler_128;
+        prescaler = SPI_BaudRatePrescaler_128;
         break;
 
     case 256:
-        tempRegister &= BR_CLEAR_MASK;
-        tempRegister |= SPI_BaudRatePrescaler_256;
+        prescaler = SPI_BaudRatePrescaler_256;
         break;
+
+    default:
+        return;
     }
 
-    instance->CR1 = tempRegister;
+    // Devices on a shared bus set their divisor for every transaction, only touch
+    // the peripheral when the clock actually changes.
+    if ((instance->CR1 & ~BR_CLEAR_MASK) == prescaler) {
+        return;
+    }
+
+    SPI_Cmd(instance, DISABLE);
+
+    instance->CR1 = (instance->CR1 & BR_CLEAR_MASK) | prescaler;
 
     SPI_Cmd(instance, ENABLE);
 }
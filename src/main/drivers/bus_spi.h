@@ -96,6 +96,46 @@ uint16_t spiGetErrorCounter(SPI_TypeDef *instance);
 void spiResetErrorCounter(SPI_TypeDef *instance);
 SPIDevice spiDeviceByInstance(SPI_TypeDef *instance);
 
+/*
+  Devices sharing a bus each keep their own chip select and clock divisor.
+  A transaction applies the divisor (only when it differs from the current one),
+  waits for a DMA transfer still holding the bus and accounts the bus time.
+  A holder that has not released the bus within SPI_BUS_LOCK_TIMEOUT_US (a lost
+  DMA completion) is stopped through its abort hook, has its chip select raised
+  and the bus taken over. A holder without an abort hook may still be clocking
+  the bus, so the new transaction fails instead.
+*/
+#define SPI_BUS_LOCK_TIMEOUT_US 5000    // several times the longest DMA transfer, a full MAX7456 update
+typedef void (*spiBusAbortFnPtr)(void);   // stops a transfer of the device that never completed
+
+typedef struct spiBusDevice_s {
+    SPI_TypeDef *instance;
+    IO_t csPin;
+    uint16_t divisor;
+    spiBusAbortFnPtr abort;     // NULL for devices without DMA transfers
+} spiBusDevice_t;
+
+typedef struct spiBusStats_s {
+    uint32_t transactionCount;
+    uint32_t busyTimeUs;        // time a chip select was held
+    uint32_t waitTimeUs;        // time spent waiting for another transaction to release the bus
+    uint32_t maxWaitUs;
+    uint32_t rejectCount;       // transactions not started because the bus was held
+    uint32_t timeoutCount;      // holders that never released the bus, aborted and taken over or left holding it
+    uint32_t sinceUs;           // time the statistics were started
+} spiBusStats_t;
+
+void spiBusDeviceInit(spiBusDevice_t *device, SPI_TypeDef *instance, IO_t csPin, uint16_t divisor);
+void spiBusSetDivisor(spiBusDevice_t *device, uint16_t divisor);
+void spiBusSetAbort(spiBusDevice_t *device, spiBusAbortFnPtr abort);
+bool spiBusTransactionBegin(const spiBusDevice_t *device);
+bool spiBusTransactionTryBegin(const spiBusDevice_t *device);
+void spiBusTransactionEnd(const spiBusDevice_t *device);
+bool spiBusIsLocked(SPI_TypeDef *instance);
+uint8_t spiBusDeviceCount(SPI_TypeDef *instance);
+const spiBusStats_t *spiBusGetStats(SPIDevice device);
+void spiBusResetStats(SPIDevice device);
+
 #if defined(USE_HAL_DRIVER)
 SPI_HandleTypeDef* spiHandleByInstance(SPI_TypeDef *instance);
 DMA_HandleTypeDef* spiSetDMATransmit(DMA_Stream_TypeDef *Stream, uint32_t Channel, SPI_TypeDef *Instance, uint8_t *pData, uint16_t Size);
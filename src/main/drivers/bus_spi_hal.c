@@ -294,44 +294,57 @@ bool spiTransfer(SPI_TypeDef *instance, uint8_t *out, const uint8_t *in, int len
 void spiSetDivisor(SPI_TypeDef *instance, uint16_t divisor)
 {
     SPIDevice device = spiDeviceByInstance(instance);
-    if (HAL_SPI_DeInit(&spiHardwareMap[device].hspi) == HAL_OK)
-    {
-    }
+    uint32_t prescaler;
 
     switch (divisor) {
     case 2:
-        spiHardwareMap[device].hspi.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_2;
+        prescaler = SPI_BAUDRATEPRESCALER_2;
         break;
 
     case 4:
-        spiHardwareMap[device].hspi.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_4;
+        prescaler = SPI_BAUDRATEPRESCALER_4;
         break;
 
     case 8:
-        spiHardwareMap[device].hspi.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_8;
+        prescaler = SPI_BAUDRATEPRESCALER_8;
         break;
 
     case 16:
-        spiHardwareMap[device].hspi.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_16;
+        prescaler = SPI_BAUDRATEPRESCALER_16;
         break;
 
     case 32:
-        spiHardwareMap[device].hspi.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_32;
+        prescaler = SPI_BAUDRATEPRESCALER_32;
         break;
 
     case 64:
-        spiHardwareMap[device].hspi.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_64;
+        prescaler = SPI_BAUDRATEPRESCALER_64;
         break;
 
     case 128:
-        spiHardwareMap[device].hspi.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_128;
+        prescaler = SPI_BAUDRATEPRESCALER_128;
         break;
 
     case 256:
-        spiHardwareMap[device].hspi.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_256;
+        prescaler = SPI_BAUDRATEPRESCALER_256;
         break;
+
+    default:
+        return;
+    }
+
+    // Reinitialising the peripheral is expensive and devices on a shared bus
+    // set their divisor for every transaction, skip it when nothing changes.
+    if (spiHardwareMap[device].hspi.Init.BaudRatePrescaler == prescaler && spiHardwareMap[device].hspi.State == HAL_SPI_STATE_READY) {
+        return;
     }
 
+    if (HAL_SPI_DeInit(&spiHardwareMap[device].hspi) == HAL_OK)
+    {
+    }
+
+    spiHardwareMap[device].hspi.Init.BaudRatePrescaler = prescaler;
+
     if (HAL_SPI_Init(&spiHardwareMap[device].hspi) == HAL_OK)
     {
     }
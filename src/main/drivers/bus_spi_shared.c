@@ -0,0 +1,182 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <platform.h>
+
+#include "bus_spi.h"
+#include "io.h"
+#include "system.h"
+
+#define SPI_BUS_COUNT (SPIDEV_4 + 1)
+
+typedef struct spiBusState_s {
+    volatile bool locked;       // set from transaction begin until end, which may run from a DMA ISR
+    const spiBusDevice_t *holder;
+    uint8_t deviceCount;
+    uint32_t lockedAtUs;
+    spiBusStats_t stats;
+} spiBusState_t;
+
+static spiBusState_t spiBusState[SPI_BUS_COUNT];
+
+static spiBusState_t *spiBusStateByInstance(SPI_TypeDef *instance)
+{
+    const SPIDevice device = spiDeviceByInstance(instance);
+    if (device == SPIINVALID) {
+        return NULL;
+    }
+    return &spiBusState[device];
+}
+
+void spiBusDeviceInit(spiBusDevice_t *device, SPI_TypeDef *instance, IO_t csPin, uint16_t divisor)
+{
+    spiBusState_t *bus = spiBusStateByInstance(instance);
+    if (bus && device->instance != instance) {
+        bus->deviceCount++;
+    }
+
+    device->instance = instance;
+    device->csPin = csPin;
+    device->divisor = divisor;
+    device->abort = NULL;
+}
+
+// Takes effect at the start of the next transaction.
+void spiBusSetDivisor(spiBusDevice_t *device, uint16_t divisor)
+{
+    device->divisor = divisor;
+}
+
+void spiBusSetAbort(spiBusDevice_t *device, spiBusAbortFnPtr abort)
+{
+    device->abort = abort;
+}
+
+static void spiBusAcquire(spiBusState_t *bus, const spiBusDevice_t *device)
+{
+    bus->locked = true;
+    bus->holder = device;
+
+    spiSetDivisor(device->instance, device->divisor);
+    IOLo(device->csPin);
+    bus->lockedAtUs = micros();
+}
+
+// Returns false if the bus is still held by a transfer that could not be stopped.
+bool spiBusTransactionBegin(const spiBusDevice_t *device)
+{
+    spiBusState_t *bus = spiBusStateByInstance(device->instance);
+    if (!bus) {
+        return false;
+    }
+
+    if (bus->locked) {
+        // Another device has a DMA transfer in flight, it releases the bus from its ISR
+        const uint32_t waitStartUs = micros();
+        uint32_t waitUs = 0;
+        while (bus->locked && waitUs < SPI_BUS_LOCK_TIMEOUT_US) {
+            waitUs = micros() - waitStartUs;
+        }
+        bus->stats.waitTimeUs += waitUs;
+        if (waitUs > bus->stats.maxWaitUs) {
+            bus->stats.maxWaitUs = waitUs;
+        }
+
+        if (bus->locked) {
+            // the completion never came, the holder's DMA must be stopped before the bus can change hands
+            bus->stats.timeoutCount++;
+            if (!bus->holder->abort) {
+                return false;
+            }
+            bus->holder->abort();
+            IOHi(bus->holder->csPin);
+        }
+    }
+
+    spiBusAcquire(bus, device);
+
+    return true;
+}
+
+// For callers that must not wait, such as a gyro read from the data ready interrupt which may
+// have preempted another transaction on the same bus. Returns false if the bus is held.
+bool spiBusTransactionTryBegin(const spiBusDevice_t *device)
+{
+    spiBusState_t *bus = spiBusStateByInstance(device->instance);
+    if (!bus) {
+        return false;
+    }
+
+    if (bus->locked) {
+        bus->stats.rejectCount++;
+        return false;
+    }
+
+    spiBusAcquire(bus, device);
+
+    return true;
+}
+
+void spiBusTransactionEnd(const spiBusDevice_t *device)
+{
+    spiBusState_t *bus = spiBusStateByInstance(device->instance);
+    if (!bus) {
+        return;
+    }
+
+    IOHi(device->csPin);
+    if (bus->holder != device) {
+        // a late completion from a transaction that was taken over, the bus is someone else's now
+        return;
+    }
+    bus->stats.busyTimeUs += micros() - bus->lockedAtUs;
+    bus->stats.transactionCount++;
+    bus->locked = false;
+}
+
+bool spiBusIsLocked(SPI_TypeDef *instance)
+{
+    const spiBusState_t *bus = spiBusStateByInstance(instance);
+    return bus && bus->locked;
+}
+
+uint8_t spiBusDeviceCount(SPI_TypeDef *instance)
+{
+    const spiBusState_t *bus = spiBusStateByInstance(instance);
+    return bus ? bus->deviceCount : 0;
+}
+
+const spiBusStats_t *spiBusGetStats(SPIDevice device)
+{
+    if (device == SPIINVALID || device >= SPI_BUS_COUNT) {
+        return NULL;
+    }
+    return &spiBusState[device].stats;
+}
+
+void spiBusResetStats(SPIDevice device)
+{
+    if (device == SPIINVALID || device >= SPI_BUS_COUNT) {
+        return;
+    }
+    memset(&spiBusState[device].stats, 0, sizeof(spiBusStats_t));
+    spiBusState[device].stats.sinceUs = micros();
+}
@@ -51,8 +51,8 @@
 #define JEDEC_ID_WINBOND_W25Q128       0xEF4018
 #define JEDEC_ID_MACRONIX_MX25L25635E  0xC22019
 
-#define DISABLE_M25P16       IOHi(m25p16CsPin); __NOP()
-#define ENABLE_M25P16        __NOP(); IOLo(m25p16CsPin)
+#define DISABLE_M25P16       spiBusTransactionEnd(&m25p16Bus); __NOP()
+#define ENABLE_M25P16        (__NOP(), spiBusTransactionBegin(&m25p16Bus))
 
 // The timeout we expect between being able to issue page program instructions
 #define DEFAULT_TIMEOUT_MILLIS       6
@@ -64,6 +64,7 @@
 static flashGeometry_t geometry = {.pageSize = M25P16_PAGESIZE};
 
 static IO_t m25p16CsPin = IO_NONE;
+static spiBusDevice_t m25p16Bus;
 
 /*
  * Whether we've performed an action that could have made the device busy for writes.
@@ -72,12 +73,17 @@ static IO_t m25p16CsPin = IO_NONE;
  */
 static bool couldBeBusy = false;
 
+// Whether the page program begun by m25p16_pageProgramBegin() got hold of the bus
+static bool pageProgramSelected = false;
+
 /**
  * Send the given command byte to the device.
  */
 static void m25p16_performOneByteCommand(uint8_t command)
 {
-    ENABLE_M25P16;
+    if (!ENABLE_M25P16) {
+        return;
+    }
 
     spiTransferByte(M25P16_SPI_INSTANCE, command);
 
@@ -101,7 +107,10 @@ static uint8_t m25p16_readStatus()
     uint8_t command[2] = { M25P16_INSTRUCTION_READ_STATUS_REG, 0 };
     uint8_t in[2];
 
-    ENABLE_M25P16;
+    if (!ENABLE_M25P16) {
+        // Report the chip as busy, the caller polls again
+        return M25P16_STATUS_FLAG_WRITE_IN_PROGRESS;
+    }
 
     spiTransfer(M25P16_SPI_INSTANCE, in, command, sizeof(command));
 
@@ -148,12 +157,12 @@ static bool m25p16_readIdentification()
      */
     in[1] = 0;
 
-    ENABLE_M25P16;
-
-    spiTransfer(M25P16_SPI_INSTANCE, in, out, sizeof(out));
+    if (ENABLE_M25P16) {
+        spiTransfer(M25P16_SPI_INSTANCE, in, out, sizeof(out));
 
-    // Clearing the CS bit terminates the command early so we don't have to read the chip UID:
-    DISABLE_M25P16;
+        // Clearing the CS bit terminates the command early so we don't have to read the chip UID:
+        DISABLE_M25P16;
+    }
 
     // Manufacturer, memory type, and capacity
     chipID = (in[1] << 16) | (in[2] << 8) | (in[3]);
@@ -226,12 +235,10 @@ bool m25p16_init(flashConfig_t *flashConfig)
     IOInit(m25p16CsPin, OWNER_FLASH_CS, 0);
     IOConfigGPIO(m25p16CsPin, SPI_IO_CS_CFG);
 
-    DISABLE_M25P16;
+    IOHi(m25p16CsPin);
 
-#ifndef M25P16_SPI_SHARED
     //Maximum speed for standard READ command is 20mHz, other commands tolerate 25mHz
-    spiSetDivisor(M25P16_SPI_INSTANCE, SPI_CLOCK_FAST);
-#endif
+    spiBusDeviceInit(&m25p16Bus, M25P16_SPI_INSTANCE, m25p16CsPin, SPI_CLOCK_FAST);
 
     return m25p16_readIdentification();
 }
@@ -247,7 +254,9 @@ void m25p16_eraseSector(uint32_t address)
 
     m25p16_writeEnable();
 
-    ENABLE_M25P16;
+    if (!ENABLE_M25P16) {
+        return;
+    }
 
     spiTransfer(M25P16_SPI_INSTANCE, NULL, out, sizeof(out));
 
@@ -271,19 +280,27 @@ void m25p16_pageProgramBegin(uint32_t address)
 
     m25p16_writeEnable();
 
-    ENABLE_M25P16;
+    pageProgramSelected = ENABLE_M25P16;
+    if (!pageProgramSelected) {
+        return;
+    }
 
     spiTransfer(M25P16_SPI_INSTANCE, NULL, command, sizeof(command));
 }
 
 void m25p16_pageProgramContinue(const uint8_t *data, int length)
 {
-    spiTransfer(M25P16_SPI_INSTANCE, NULL, data, length);
+    if (pageProgramSelected) {
+        spiTransfer(M25P16_SPI_INSTANCE, NULL, data, length);
+    }
 }
 
 void m25p16_pageProgramFinish()
 {
-    DISABLE_M25P16;
+    if (pageProgramSelected) {
+        DISABLE_M25P16;
+        pageProgramSelected = false;
+    }
 }
 
 /**
@@ -326,7 +343,9 @@ int m25p16_readBytes(uint32_t address, uint8_t *buffer, int length)
         return 0;
     }
 
-    ENABLE_M25P16;
+    if (!ENABLE_M25P16) {
+        return 0;
+    }
 
     spiTransfer(M25P16_SPI_INSTANCE, NULL, command, sizeof(command));
     spiTransfer(M25P16_SPI_INSTANCE, buffer, NULL, length);
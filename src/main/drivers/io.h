@@ -80,13 +80,13 @@
 
 #elif defined(UNIT_TEST)
 
-# define IOCFG_OUT_PP         0
-# define IOCFG_OUT_OD         0
-# define IOCFG_AF_PP          0
-# define IOCFG_AF_OD          0
-# define IOCFG_IPD            0
-# define IOCFG_IPU            0
-# define IOCFG_IN_FLOATING    0
+# define IOCFG_OUT_PP         1
+# define IOCFG_OUT_OD         2
+# define IOCFG_AF_PP          3
+# define IOCFG_AF_OD          4
+# define IOCFG_IPD            5
+# define IOCFG_IPU            6
+# define IOCFG_IN_FLOATING    7
 
 #else
 # warning "Unknown TARGET"
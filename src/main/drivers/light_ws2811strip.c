@@ -36,8 +36,6 @@
 
 #include "common/color.h"
 #include "common/colorconversion.h"
-#include "dma.h"
-#include "io.h"
 #include "light_ws2811strip.h"
 
 #if defined(STM32F1) || defined(STM32F3)
@@ -47,11 +45,54 @@ uint32_t ledStripDMABuffer[WS2811_DMA_BUFFER_SIZE];
 #endif
 volatile uint8_t ws2811LedDataTransferInProgress = 0;
 
+#if WS2811_LED_STRIP_LENGTH > 32
+# error "Dirty LED tracking holds one bit per LED"
+#endif
+
 static hsvColor_t ledColorBuffer[WS2811_LED_STRIP_LENGTH];
+// colors the DMA buffer currently holds, only LEDs that differ from these are converted again
+static hsvColor_t ledSentColorBuffer[WS2811_LED_STRIP_LENGTH];
+// LEDs written since the last update
+static uint32_t ledDirtyMask;
+
+/*
+ * Compare values for every bit of a color byte, MSB first. The F1 parts are short of flash
+ * and look up each nibble instead of the whole byte.
+ */
+#if defined(STM32F1)
+#define WS2811_LUT_BITS     4
+#else
+#define WS2811_LUT_BITS     8
+#endif
+
+#define WS2811_BIT_COMPARE(value, bit) ((((value) >> (bit)) & 1) ? BIT_COMPARE_1 : BIT_COMPARE_0)
+#if WS2811_LUT_BITS == 8
+#define WS2811_LUT_ENTRY(v) { WS2811_BIT_COMPARE(v, 7), WS2811_BIT_COMPARE(v, 6), WS2811_BIT_COMPARE(v, 5), WS2811_BIT_COMPARE(v, 4), \
+                              WS2811_BIT_COMPARE(v, 3), WS2811_BIT_COMPARE(v, 2), WS2811_BIT_COMPARE(v, 1), WS2811_BIT_COMPARE(v, 0) }
+#else
+#define WS2811_LUT_ENTRY(v) { WS2811_BIT_COMPARE(v, 3), WS2811_BIT_COMPARE(v, 2), WS2811_BIT_COMPARE(v, 1), WS2811_BIT_COMPARE(v, 0) }
+#endif
+#define WS2811_LUT_ENTRY4(v)  WS2811_LUT_ENTRY(v), WS2811_LUT_ENTRY((v) + 1), WS2811_LUT_ENTRY((v) + 2), WS2811_LUT_ENTRY((v) + 3)
+#define WS2811_LUT_ENTRY16(v) WS2811_LUT_ENTRY4(v), WS2811_LUT_ENTRY4((v) + 4), WS2811_LUT_ENTRY4((v) + 8), WS2811_LUT_ENTRY4((v) + 12)
+#define WS2811_LUT_ENTRY64(v) WS2811_LUT_ENTRY16(v), WS2811_LUT_ENTRY16((v) + 16), WS2811_LUT_ENTRY16((v) + 32), WS2811_LUT_ENTRY16((v) + 48)
+
+static const uint8_t ws2811BitCompareLut[1 << WS2811_LUT_BITS][WS2811_LUT_BITS] = {
+#if WS2811_LUT_BITS == 8
+    WS2811_LUT_ENTRY64(0), WS2811_LUT_ENTRY64(64), WS2811_LUT_ENTRY64(128), WS2811_LUT_ENTRY64(192)
+#else
+    WS2811_LUT_ENTRY16(0)
+#endif
+};
+
+static void setLedDirty(uint16_t index)
+{
+    ledDirtyMask |= 1U << index;
+}
 
 void setLedHsv(uint16_t index, const hsvColor_t *color)
 {
     ledColorBuffer[index] = *color;
+    setLedDirty(index);
 }
 
 void getLedHsv(uint16_t index, hsvColor_t *color)
@@ -62,11 +103,13 @@ void getLedHsv(uint16_t index, hsvColor_t *color)
 void setLedValue(uint16_t index, const uint8_t value)
 {
     ledColorBuffer[index].v = value;
+    setLedDirty(index);
 }
 
 void scaleLedValue(uint16_t index, const uint8_t scalePercent)
 {
     ledColorBuffer[index].v = ((uint16_t)ledColorBuffer[index].v * scalePercent / 100);
+    setLedDirty(index);
 }
 
 void setStripColor(const hsvColor_t *color)
@@ -85,90 +128,92 @@ void setStripColors(const hsvColor_t *colors)
     }
 }
 
-void ws2811LedStripInit(ioTag_t ioTag)
+static void updateLEDDMABufferByte(uint16_t offset, uint8_t value)
 {
-    memset(&ledStripDMABuffer, 0, WS2811_DMA_BUFFER_SIZE);
-    ws2811LedStripHardwareInit(ioTag);
-
-    const hsvColor_t hsv_white = {  0, 255, 255};
-    setStripColor(&hsv_white);
-    ws2811UpdateStrip();
+    for (int shift = 8 - WS2811_LUT_BITS; shift >= 0; shift -= WS2811_LUT_BITS) {
+        const uint8_t *compareValues = ws2811BitCompareLut[(value >> shift) & ((1 << WS2811_LUT_BITS) - 1)];
+        for (int bit = 0; bit < WS2811_LUT_BITS; bit++) {
+            ledStripDMABuffer[offset++] = compareValues[bit];
+        }
+    }
 }
 
-bool isWS2811LedStripReady(void)
+// writes the 24 compare values of one LED, data is sent in GRB order
+STATIC_UNIT_TESTED void updateLEDDMABuffer(uint16_t ledIndex, const rgbColor24bpp_t *color)
 {
-    return !ws2811LedDataTransferInProgress;
+    const uint16_t offset = ledIndex * WS2811_BITS_PER_LED;
+
+    updateLEDDMABufferByte(offset, color->rgb.g);
+    updateLEDDMABufferByte(offset + 8, color->rgb.r);
+    updateLEDDMABufferByte(offset + 16, color->rgb.b);
 }
 
-STATIC_UNIT_TESTED uint16_t dmaBufferOffset;
-static int16_t ledIndex;
+static void updateLed(uint16_t ledIndex)
+{
+    ledSentColorBuffer[ledIndex] = ledColorBuffer[ledIndex];
+    updateLEDDMABuffer(ledIndex, hsvToRgb24(&ledColorBuffer[ledIndex]));
+}
 
-#define USE_FAST_DMA_BUFFER_IMPL
-#ifdef USE_FAST_DMA_BUFFER_IMPL
+static void ws2811StartTransfer(void)
+{
+    ws2811LedDataTransferInProgress = 1;
+    ws2811LedStripDMAEnable();
+}
 
-STATIC_UNIT_TESTED void fastUpdateLEDDMABuffer(rgbColor24bpp_t *color)
+void ws2811LedStripInit(ioTag_t ioTag)
 {
-    uint32_t grb = (color->rgb.g << 16) | (color->rgb.r << 8) | (color->rgb.b);
+    memset(&ledStripDMABuffer, 0, sizeof(ledStripDMABuffer));
+    ws2811LedStripHardwareInit(ioTag);
+
+    const hsvColor_t hsv_white = {  0, 255, 255};
+    setStripColor(&hsv_white);
 
-    for (int8_t index = 23; index >= 0; index--) {
-        ledStripDMABuffer[dmaBufferOffset++] = (grb & (1 << index)) ? BIT_COMPARE_1 : BIT_COMPARE_0;
+    // the whole buffer has to hold valid compare values before the first transfer
+    for (uint16_t ledIndex = 0; ledIndex < WS2811_LED_STRIP_LENGTH; ledIndex++) {
+        updateLed(ledIndex);
     }
+    ledDirtyMask = 0;
+
+    ws2811StartTransfer();
 }
-#else
-STATIC_UNIT_TESTED void updateLEDDMABuffer(uint8_t componentValue)
-{
-    uint8_t bitIndex;
 
-    for (bitIndex = 0; bitIndex < 8; bitIndex++)
-    {
-        if ((componentValue << bitIndex) & 0x80 )    // data sent MSB first, j = 0 is MSB j = 7 is LSB
-        {
-            ledStripDMABuffer[dmaBufferOffset] = BIT_COMPARE_1;
-        }
-        else
-        {
-            ledStripDMABuffer[dmaBufferOffset] = BIT_COMPARE_0;   // compare value for logical 0
-        }
-        dmaBufferOffset++;
-    }
+bool isWS2811LedStripReady(void)
+{
+    return !ws2811LedDataTransferInProgress;
 }
-#endif
 
 /*
  * This method is non-blocking unless an existing LED update is in progress.
  * it does not wait until all the LEDs have been updated, that happens in the background.
+ *
+ * Only LEDs that were written and now differ from what was last sent are converted, the
+ * transfer is skipped when none did.
  */
 void ws2811UpdateStrip(void)
 {
-    static rgbColor24bpp_t *rgb24;
-
     // don't wait - risk of infinite block, just get an update next time round
     if (ws2811LedDataTransferInProgress) {
         return;
     }
 
-    dmaBufferOffset = 0;                // reset buffer memory index
-    ledIndex = 0;                       // reset led index
-
-    // fill transmit buffer with correct compare values to achieve
-    // correct pulse widths according to color values
-    while (ledIndex < WS2811_LED_STRIP_LENGTH)
-    {
-        rgb24 = hsvToRgb24(&ledColorBuffer[ledIndex]);
+    bool changed = false;
 
-#ifdef USE_FAST_DMA_BUFFER_IMPL
-        fastUpdateLEDDMABuffer(rgb24);
-#else
-        updateLEDDMABuffer(rgb24->rgb.g);
-        updateLEDDMABuffer(rgb24->rgb.r);
-        updateLEDDMABuffer(rgb24->rgb.b);
-#endif
+    for (uint16_t ledIndex = 0; ledDirtyMask; ledIndex++, ledDirtyMask >>= 1) {
+        if (!(ledDirtyMask & 1)) {
+            continue;
+        }
 
-        ledIndex++;
+        const hsvColor_t *color = &ledColorBuffer[ledIndex];
+        const hsvColor_t *sentColor = &ledSentColorBuffer[ledIndex];
+        if (color->h != sentColor->h || color->s != sentColor->s || color->v != sentColor->v) {
+            updateLed(ledIndex);
+            changed = true;
+        }
     }
 
-    ws2811LedDataTransferInProgress = 1;
-    ws2811LedStripDMAEnable();
+    if (changed) {
+        ws2811StartTransfer();
+    }
 }
 
 #endif
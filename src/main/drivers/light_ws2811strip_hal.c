@@ -64,6 +64,12 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
     if (timerHardware->dmaStream == NULL) {
         return;
     }
+
+    // another driver may already own the channel, leave the strip dark rather than take over its interrupt
+    if (dmaGetOwner(timerHardware->dmaIrqHandler) != OWNER_FREE) {
+        return;
+    }
+
     TimHandle.Instance = timer;
 
     TimHandle.Init.Prescaler = 1;
@@ -61,6 +61,11 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
         return;
     }
 
+    // another driver may already own the channel, leave the strip dark rather than take over its interrupt
+    if (dmaGetOwner(timerHardware->dmaIrqHandler) != OWNER_FREE) {
+        return;
+    }
+
     ws2811IO = IOGetByTag(ioTag);
     IOInit(ws2811IO, OWNER_LED_STRIP, 0);
     IOConfigGPIO(ws2811IO, IO_CONFIG(GPIO_Speed_50MHz, GPIO_Mode_AF_PP));
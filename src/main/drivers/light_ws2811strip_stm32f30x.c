@@ -62,6 +62,11 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
         return;
     }
 
+    // a soft serial port may already run on the channel, leave the strip dark rather than take over its interrupt
+    if (dmaGetOwner(timerHardware->dmaIrqHandler) != OWNER_FREE) {
+        return;
+    }
+
     ws2811IO = IOGetByTag(ioTag);
     IOInit(ws2811IO, OWNER_LED_STRIP, 0);
     IOConfigGPIOAF(ws2811IO, IO_CONFIG(GPIO_Mode_AF, GPIO_Speed_50MHz, GPIO_OType_PP, GPIO_PuPd_UP), timerHardware->alternateFunction);
@@ -64,6 +64,11 @@ void ws2811LedStripHardwareInit(ioTag_t ioTag)
         return;
     }
 
+    // another driver may already own the channel, leave the strip dark rather than take over its interrupt
+    if (dmaGetOwner(timerHardware->dmaIrqHandler) != OWNER_FREE) {
+        return;
+    }
+
     RCC_ClockCmd(timerRCC(timer), ENABLE);
 
     ws2811IO = IOGetByTag(ioTag);
@@ -108,6 +108,7 @@
 // DMM special bits
 #define CLEAR_DISPLAY 0x04
 #define CLEAR_DISPLAY_VERT 0x06
+#define AUTO_INCREMENT 0x01
 
 // Special address for terminating incremental write
 #define END_STRING 0xff
@@ -150,19 +151,13 @@
 
 #define CHARS_PER_LINE      30 // XXX Should be related to VIDEO_BUFFER_CHARS_*?
 
-// On shared SPI buss we want to change clock for OSD chip and restore for other devices.
-
-#ifdef MAX7456_SPI_CLK
-    #define ENABLE_MAX7456        {spiSetDivisor(MAX7456_SPI_INSTANCE, MAX7456_SPI_CLK);IOLo(max7456CsPin);}
-#else
-    #define ENABLE_MAX7456        IOLo(max7456CsPin)
+#ifndef MAX7456_SPI_CLK
+#define MAX7456_SPI_CLK           SPI_CLOCK_STANDARD
 #endif
 
-#ifdef MAX7456_RESTORE_CLK
-    #define DISABLE_MAX7456       {IOHi(max7456CsPin);spiSetDivisor(MAX7456_SPI_INSTANCE, MAX7456_RESTORE_CLK);}
-#else
-    #define DISABLE_MAX7456       IOHi(max7456CsPin)
-#endif
+// The OSD chip keeps its own clock on a shared bus, see spiBusTransactionBegin().
+#define ENABLE_MAX7456            spiBusTransactionBegin(&max7456Bus)
+#define DISABLE_MAX7456           spiBusTransactionEnd(&max7456Bus)
 
 uint16_t maxScreenSize = VIDEO_BUFFER_CHARS_PAL;
 
@@ -173,6 +168,11 @@ uint16_t maxScreenSize = VIDEO_BUFFER_CHARS_PAL;
 static uint8_t screenBuffer[VIDEO_BUFFER_CHARS_PAL+40]; // For faster writes we use memcpy so we need some space to don't overwrite buffer
 static uint8_t shadowBuffer[VIDEO_BUFFER_CHARS_PAL];
 
+// One bit per row, set when screenBuffer may differ from shadowBuffer in that row.
+// Rows that are not dirty are skipped entirely by max7456DrawScreen().
+static uint16_t dirtyRows = 0;
+#define ALL_ROWS_DIRTY ((1 << VIDEO_LINES_PAL) - 1)
+
 //Max chars to update in one idle
 
 #define MAX_CHARS2UPDATE    100
@@ -180,8 +180,18 @@ static uint8_t shadowBuffer[VIDEO_BUFFER_CHARS_PAL];
 volatile bool dmaTransactionInProgress = false;
 #endif
 
+// Bytes needed to send a single char, and a run of chars in auto increment mode.
+#define SINGLE_CHAR_BYTES   6
+#define RUN_BYTES(length)   (8 + 2 * (length))
+
 static uint8_t spiBuff[MAX_CHARS2UPDATE*6];
 
+#ifdef MAX7456_DMA_CHANNEL_TX
+// A DMA transfer holds the bus until it completes, so when other devices (the gyro) share
+// the bus keep each transfer to about one full row of changes.
+#define SHARED_BUS_DMA_BYTES    RUN_BYTES(CHARS_PER_LINE)
+#endif
+
 static uint8_t  videoSignalCfg;
 static uint8_t  videoSignalReg  = OSD_ENABLE; // OSD_ENABLE required to trigger first ReInit
 
@@ -191,6 +201,7 @@ static uint8_t  vosRegValue; // VOS (Vertical offset register) value
 static bool  max7456Lock        = false;
 static bool fontIsLoading       = false;
 static IO_t max7456CsPin        = IO_NONE;
+static spiBusDevice_t max7456Bus;
 
 
 static uint8_t max7456Send(uint8_t add, uint8_t data)
@@ -199,6 +210,13 @@ static uint8_t max7456Send(uint8_t add, uint8_t data)
     return spiTransferByte(MAX7456_SPI_INSTANCE, data);
 }
 
+// For when buffered changes were lost, forget what the chip shows and send everything again
+static void max7456ForceRedraw(void)
+{
+    memset(shadowBuffer, 0, maxScreenSize);
+    dirtyRows = ALL_ROWS_DIRTY;
+}
+
 #ifdef MAX7456_DMA_CHANNEL_TX
 static void max7456SendDma(void* tx_buffer, void* rx_buffer, uint16_t buffer_size)
 {
@@ -263,7 +281,11 @@ static void max7456SendDma(void* tx_buffer, void* rx_buffer, uint16_t buffer_siz
 
     // Enable SPI TX/RX request
 
-    ENABLE_MAX7456;
+    if (!ENABLE_MAX7456) {
+        // The rows buffered for this transfer never reach the chip
+        max7456ForceRedraw();
+        return;
+    }
     dmaTransactionInProgress = true;
 
     SPI_I2S_DMACmd(MAX7456_SPI_INSTANCE,
@@ -313,6 +335,33 @@ void max7456_dma_irq_handler(dmaChannelDescriptor_t* descriptor)
     }
 }
 
+// Called by the shared bus when the transfer complete interrupt never came, the bus is
+// handed to another device (and our chip select raised) on return.
+static void max7456AbortDma(void)
+{
+    DMA_Cmd(MAX7456_DMA_CHANNEL_TX, DISABLE);
+#ifdef MAX7456_DMA_CHANNEL_RX
+    DMA_Cmd(MAX7456_DMA_CHANNEL_RX, DISABLE);
+#endif
+    SPI_I2S_DMACmd(MAX7456_SPI_INSTANCE,
+#ifdef MAX7456_DMA_CHANNEL_RX
+            SPI_I2S_DMAReq_Rx |
+#endif
+            SPI_I2S_DMAReq_Tx, DISABLE);
+
+    while (SPI_I2S_GetFlagStatus(MAX7456_SPI_INSTANCE, SPI_I2S_FLAG_BSY) == SET) {};
+
+    // Leave auto increment mode in case the transfer stopped inside a run
+    spiTransferByte(MAX7456_SPI_INSTANCE, 0xFF);
+
+    while (SPI_I2S_GetFlagStatus(MAX7456_SPI_INSTANCE, SPI_I2S_FLAG_RXNE) == SET) {
+        MAX7456_SPI_INSTANCE->DR;
+    }
+
+    max7456ForceRedraw();
+    dmaTransactionInProgress = false;
+}
+
 #endif
 
 uint8_t max7456GetRowsCount(void)
@@ -327,7 +376,10 @@ void max7456ReInit(void)
     uint16_t x;
     static bool firstInit = true;
 
-    ENABLE_MAX7456;
+    // Retried on the next draw, the register check below still fails
+    if (!ENABLE_MAX7456) {
+        return;
+    }
 
     switch(videoSignalCfg) {
         case VIDEO_SYSTEM_PAL:
@@ -377,6 +429,7 @@ void max7456ReInit(void)
     // Clear shadow to force redraw all screen in non-dma mode.
 
     memset(shadowBuffer, 0, maxScreenSize);
+    dirtyRows = ALL_ROWS_DIRTY;
     if (firstInit)
     {
         max7456RefreshAll();
@@ -395,11 +448,15 @@ void max7456Init(const vcdProfile_t *pVcdProfile)
     IOInit(max7456CsPin, OWNER_OSD_CS, 0);
     IOConfigGPIO(max7456CsPin, SPI_IO_CS_CFG);
 
-    spiSetDivisor(MAX7456_SPI_INSTANCE, SPI_CLOCK_STANDARD);
+    spiBusDeviceInit(&max7456Bus, MAX7456_SPI_INSTANCE, max7456CsPin, MAX7456_SPI_CLK);
+#ifdef MAX7456_DMA_CHANNEL_TX
+    spiBusSetAbort(&max7456Bus, max7456AbortDma);
+#endif
     // force soft reset on Max7456
-    ENABLE_MAX7456;
-    max7456Send(MAX7456ADD_VM0, MAX7456_RESET);
-    DISABLE_MAX7456;
+    if (ENABLE_MAX7456) {
+        max7456Send(MAX7456ADD_VM0, MAX7456_RESET);
+        DISABLE_MAX7456;
+    }
 
     // Setup values to write to registers
     videoSignalCfg = pVcdProfile->video_system;
@@ -413,13 +470,19 @@ void max7456Init(const vcdProfile_t *pVcdProfile)
     // Real init will be made later when driver detect idle.
 }
 
-//just fill with spaces with some tricks
+//just fill with spaces, only touching rows that are not blank already
 void max7456ClearScreen(void)
 {
-    uint16_t x;
-    uint32_t *p = (uint32_t*)&screenBuffer[0];
-    for (x = 0; x < VIDEO_BUFFER_CHARS_PAL/4; x++)
-        p[x] = 0x20202020;
+    for (int y = 0; y < VIDEO_LINES_PAL; y++) {
+        uint8_t *row = &screenBuffer[y * CHARS_PER_LINE];
+        for (int x = 0; x < CHARS_PER_LINE; x++) {
+            if (row[x] != ' ') {
+                memset(row, ' ', CHARS_PER_LINE);
+                dirtyRows |= 1 << y;
+                break;
+            }
+        }
+    }
 }
 
 uint8_t* max7456GetScreenBuffer(void) {
@@ -428,7 +491,11 @@ uint8_t* max7456GetScreenBuffer(void) {
 
 void max7456WriteChar(uint8_t x, uint8_t y, uint8_t c)
 {
-    screenBuffer[y*CHARS_PER_LINE+x] = c;
+    uint8_t *p = &screenBuffer[y*CHARS_PER_LINE+x];
+    if (*p != c) {
+        *p = c;
+        dirtyRows |= 1 << y;
+    }
 }
 
 void max7456Write(uint8_t x, uint8_t y, const char *buff)
@@ -436,7 +503,7 @@ void max7456Write(uint8_t x, uint8_t y, const char *buff)
     uint8_t i = 0;
     for (i = 0; *(buff+i); i++)
         if (x+i < CHARS_PER_LINE) // Do not write over screen
-            screenBuffer[y*CHARS_PER_LINE+x+i] = *(buff+i);
+            max7456WriteChar(x + i, y, *(buff+i));
 }
 
 #ifdef MAX7456_DMA_CHANNEL_TX
@@ -448,6 +515,64 @@ bool max7456DmaInProgres(void)
 
 #include "build/debug.h"
 
+// Queues the changed chars of one row into spiBuff. Consecutive changes are sent as one run in
+// auto increment mode (2 bytes per char plus setup) rather than 6 bytes per char. Char 0xff
+// terminates auto increment mode so it always goes out as a single char.
+// Returns false if buff_size bytes were queued before the whole row was.
+static bool max7456BufferRow(uint8_t row, int *buff_len, int buff_size)
+{
+    const uint16_t rowStart = row * CHARS_PER_LINE;
+    uint8_t x = 0;
+
+    while (x < CHARS_PER_LINE) {
+        uint16_t pos = rowStart + x;
+        if (screenBuffer[pos] == shadowBuffer[pos]) {
+            x++;
+            continue;
+        }
+
+        uint8_t length = 0;
+        while (x + length < CHARS_PER_LINE && screenBuffer[pos + length] != shadowBuffer[pos + length] && screenBuffer[pos + length] != END_STRING) {
+            length++;
+        }
+
+        if (length < 2) {
+            if (*buff_len + SINGLE_CHAR_BYTES > buff_size) {
+                return false;
+            }
+            spiBuff[(*buff_len)++] = MAX7456ADD_DMAH;
+            spiBuff[(*buff_len)++] = pos >> 8;
+            spiBuff[(*buff_len)++] = MAX7456ADD_DMAL;
+            spiBuff[(*buff_len)++] = pos & 0xff;
+            spiBuff[(*buff_len)++] = MAX7456ADD_DMDI;
+            spiBuff[(*buff_len)++] = screenBuffer[pos];
+            shadowBuffer[pos] = screenBuffer[pos];
+            x++;
+            continue;
+        }
+
+        if (*buff_len + RUN_BYTES(length) > buff_size) {
+            return false;
+        }
+        spiBuff[(*buff_len)++] = MAX7456ADD_DMAH;
+        spiBuff[(*buff_len)++] = pos >> 8;
+        spiBuff[(*buff_len)++] = MAX7456ADD_DMAL;
+        spiBuff[(*buff_len)++] = pos & 0xff;
+        spiBuff[(*buff_len)++] = MAX7456ADD_DMM;
+        spiBuff[(*buff_len)++] = AUTO_INCREMENT;
+        for (uint8_t i = 0; i < length; i++, pos++) {
+            spiBuff[(*buff_len)++] = MAX7456ADD_DMDI;
+            spiBuff[(*buff_len)++] = screenBuffer[pos];
+            shadowBuffer[pos] = screenBuffer[pos];
+        }
+        spiBuff[(*buff_len)++] = MAX7456ADD_DMDI;
+        spiBuff[(*buff_len)++] = END_STRING;
+        x += length;
+    }
+
+    return true;
+}
+
 void max7456DrawScreen(void)
 {
     uint8_t stallCheck;
@@ -455,7 +580,7 @@ void max7456DrawScreen(void)
     static uint32_t lastSigCheckMs = 0;
     uint32_t nowMs;
     static uint32_t videoDetectTimeMs = 0;
-    static uint16_t pos = 0;
+    static uint8_t row = 0;
     int k = 0, buff_len=0;
 
     if (!max7456Lock && !fontIsLoading) {
@@ -463,7 +588,10 @@ void max7456DrawScreen(void)
         // (Re)Initialize MAX7456 at startup or stall is detected.
 
         max7456Lock = true;
-        ENABLE_MAX7456;
+        if (!ENABLE_MAX7456) {
+            max7456Lock = false;
+            return;
+        }
         stallCheck = max7456Send(MAX7456ADD_VM0|MAX7456ADD_READ, 0x00);
         DISABLE_MAX7456;
 
@@ -477,9 +605,12 @@ void max7456DrawScreen(void)
 
             // Adjust output format based on the current input format.
 
-            ENABLE_MAX7456;
-            videoSense = max7456Send(MAX7456ADD_STAT, 0x00);
-            DISABLE_MAX7456;
+            if (ENABLE_MAX7456) {
+                videoSense = max7456Send(MAX7456ADD_STAT, 0x00);
+                DISABLE_MAX7456;
+            } else {
+                videoSense = STAT_LOS;
+            }
 
 #ifdef DEBUG_MAX7456_SIGNAL
             debug[0] = videoSignalReg & VIDEO_MODE_MASK;
@@ -511,33 +642,43 @@ void max7456DrawScreen(void)
 
         //------------   end of (re)init-------------------------------------
 
-        for (k=0; k< MAX_CHARS2UPDATE; k++) {
-            if (screenBuffer[pos] != shadowBuffer[pos]) {
-                spiBuff[buff_len++] = MAX7456ADD_DMAH;
-                spiBuff[buff_len++] = pos >> 8;
-                spiBuff[buff_len++] = MAX7456ADD_DMAL;
-                spiBuff[buff_len++] = pos & 0xff;
-                spiBuff[buff_len++] = MAX7456ADD_DMDI;
-                spiBuff[buff_len++] = screenBuffer[pos];
-                shadowBuffer[pos] = screenBuffer[pos];
-                k++;
+#ifdef MAX7456_DMA_CHANNEL_TX
+        const int buff_size = spiBusDeviceCount(MAX7456_SPI_INSTANCE) > 1 ? SHARED_BUS_DMA_BYTES : (int)sizeof(spiBuff);
+#else
+        const int buff_size = sizeof(spiBuff);
+#endif
+        const uint8_t rows = maxScreenSize / CHARS_PER_LINE;
+        for (k = 0; k < rows && dirtyRows; k++) {
+            if (++row >= rows) {
+                row = 0;
             }
-
-            if (++pos >= maxScreenSize) {
-                pos = 0;
-                break;
+            if (dirtyRows & (1 << row)) {
+                if (max7456BufferRow(row, &buff_len, buff_size)) {
+                    dirtyRows &= ~(1 << row);
+                } else {
+                    // spiBuff is full, step back so the next call carries on with this row
+                    row = (row == 0 ? rows : row) - 1;
+                    break;
+                }
             }
         }
 
+        // DEBUG_OSD 2 - bytes sent, 3 - rows still dirty
+        DEBUG_SET(DEBUG_OSD, 2, buff_len);
+        DEBUG_SET(DEBUG_OSD, 3, __builtin_popcount(dirtyRows));
+
         if (buff_len) {
             #ifdef MAX7456_DMA_CHANNEL_TX
             if (buff_len > 0)
                 max7456SendDma(spiBuff, NULL, buff_len);
             #else
-            ENABLE_MAX7456;
-            for (k=0; k < buff_len; k++)
-                spiTransferByte(MAX7456_SPI_INSTANCE, spiBuff[k]);
-            DISABLE_MAX7456;
+            if (ENABLE_MAX7456) {
+                for (k=0; k < buff_len; k++)
+                    spiTransferByte(MAX7456_SPI_INSTANCE, spiBuff[k]);
+                DISABLE_MAX7456;
+            } else {
+                max7456ForceRedraw();
+            }
             #endif // MAX7456_DMA_CHANNEL_TX
         }
         max7456Lock = false;
@@ -554,7 +695,10 @@ void max7456RefreshAll(void)
 #endif
         uint16_t xx;
         max7456Lock = true;
-        ENABLE_MAX7456;
+        if (!ENABLE_MAX7456) {
+            max7456Lock = false;
+            return;
+        }
         max7456Send(MAX7456ADD_DMAH, 0);
         max7456Send(MAX7456ADD_DMAL, 0);
         max7456Send(MAX7456ADD_DMM, 1);
@@ -568,6 +712,7 @@ void max7456RefreshAll(void)
         max7456Send(MAX7456ADD_DMDI, 0xFF);
         max7456Send(MAX7456ADD_DMM, 0);
         DISABLE_MAX7456;
+        dirtyRows = 0;
         max7456Lock = false;
     }
 }
@@ -582,7 +727,10 @@ void max7456WriteNvm(uint8_t char_address, const uint8_t *font_data)
     while (max7456Lock);
     max7456Lock = true;
 
-    ENABLE_MAX7456;
+    if (!ENABLE_MAX7456) {
+        max7456Lock = false;
+        return;
+    }
     // disable display
     fontIsLoading = true;
     max7456Send(MAX7456ADD_VM0, 0);
@@ -24,6 +24,7 @@
 
 #include "io.h"
 #include "timer.h"
+#include "system.h"
 #include "pwm_output.h"
 
 #define MULTISHOT_5US_PW    (MULTISHOT_TIMER_MHZ * 5)
@@ -35,6 +36,8 @@ static pwmCompleteWriteFuncPtr pwmCompleteWritePtr = NULL;
 
 #ifdef USE_SERVOS
 static pwmOutputPort_t servos[MAX_SUPPORTED_SERVOS];
+static servoTiming_t servoTimings[MAX_SUPPORTED_SERVOS];
+static servoPulseTracker_t servoPulses[MAX_SUPPORTED_SERVOS];
 #endif
 
 bool pwmMotorsEnabled = false;
@@ -319,10 +322,65 @@ uint32_t getDshotHz(motorPwmProtocolTypes_e pwmProtocolType)
 void pwmWriteServo(uint8_t index, uint16_t value)
 {
     if (index < MAX_SUPPORTED_SERVOS && servos[index].ccr) {
-        *servos[index].ccr = value;
+        *servos[index].ccr = servoTimingPulseTicks(&servoTimings[index], value);
+        servoPulseTrackerWrite(&servoPulses[index], value, micros());
     }
 }
 
+// Every servo on the timer restarts with the overflow, so each one's running pulse has to be over
+static bool servoTimerCanTrigger(uint8_t firstIndex, uint16_t counter)
+{
+    const TIM_TypeDef *tim = servos[firstIndex].tim;
+
+    for (int index = firstIndex; index < MAX_SUPPORTED_SERVOS; index++) {
+        if (servos[index].enabled && servos[index].tim == tim
+            && !servoPulseTrackerCanTrigger(&servoPulses[index], &servoTimings[index], counter)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Called right after the servos are written, starts synced servo pulses with the new values
+void pwmCompleteServoUpdate(void)
+{
+    for (int index = 0; index < MAX_SUPPORTED_SERVOS; index++) {
+        if (servos[index].forceOverflow && servoTimerCanTrigger(index, servos[index].tim->CNT)) {
+            timerForceOverflow(servos[index].tim);
+        }
+    }
+}
+
+bool pwmGetServoPulse(uint8_t index, servoPulse_t *pulse)
+{
+    if (index >= MAX_SUPPORTED_SERVOS || !servos[index].enabled) {
+        return false;
+    }
+
+    servoPulseTrackerUpdate(&servoPulses[index], &servoTimings[index], servos[index].tim->CNT, micros(), pulse);
+    return true;
+}
+
+static bool isTimerUsedByMotors(const TIM_TypeDef *tim)
+{
+    for (int i = 0; i < MAX_SUPPORTED_MOTORS; i++) {
+        if (motors[i].enabled && motors[i].tim == tim) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool isTimerUsedByServos(const TIM_TypeDef *tim, uint8_t servoCount)
+{
+    for (int i = 0; i < servoCount; i++) {
+        if (servos[i].tim == tim) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void servoInit(const servoConfig_t *servoConfig)
 {
     for (uint8_t servoIndex = 0; servoIndex < MAX_SUPPORTED_SERVOS; servoIndex++) {
@@ -348,7 +406,17 @@ void servoInit(const servoConfig_t *servoConfig)
             break;
         }
 
-        pwmOutConfig(&servos[servoIndex], timer, PWM_TIMER_MHZ, 1000000 / servoConfig->servoPwmRate, servoConfig->servoCenterPulse);
+        servoTiming_t *timing = &servoTimings[servoIndex];
+        servoTimingInit(timing, servoConfig->servoPulseMode, servoConfig->servoPwmRate);
+        // Forcing an update restarts every channel of the timer, so motor timers stay free running.
+        // Servos sharing a timer are started together by the first of them.
+        if (timing->synced && isTimerUsedByMotors(timer->tim)) {
+            servoTimingSetFreeRunning(timing);
+        }
+
+        servoPulseTrackerInit(&servoPulses[servoIndex]);
+        pwmOutConfig(&servos[servoIndex], timer, timing->timerMhz, timing->timerPeriodTicks, servoTimingPulseTicks(timing, servoConfig->servoCenterPulse));
+        servos[servoIndex].forceOverflow = timing->synced && !isTimerUsedByServos(timer->tim, servoIndex);
         servos[servoIndex].enabled = true;
     }
 }
@@ -20,6 +20,7 @@
 #include "io/motors.h"
 #include "io/servos.h"
 #include "drivers/timer.h"
+#include "drivers/servo_timing.h"
 
 typedef enum {
     PWM_TYPE_STANDARD = 0,
@@ -126,6 +127,8 @@ void pwmShutdownPulsesForAllMotors(uint8_t motorCount);
 void pwmCompleteMotorUpdate(uint8_t motorCount);
 
 void pwmWriteServo(uint8_t index, uint16_t value);
+void pwmCompleteServoUpdate(void);
+bool pwmGetServoPulse(uint8_t index, servoPulse_t *pulse);
 
 pwmOutputPort_t *pwmGetMotors(void);
 bool pwmIsSynced(void);
@@ -569,8 +569,11 @@ void sdcard_init(bool useDMA)
     // Max frequency is initially 400kHz
     spiSetDivisor(SDCARD_SPI_INSTANCE, SDCARD_SPI_INITIALIZATION_CLOCK_DIVIDER);
 
-    // SDCard wants 1ms minimum delay after power is applied to it
-    delay(1000);
+    // SDCard wants 1ms minimum delay after power is applied to it, that was at boot
+    const uint32_t sincePowerUpMs = millis();
+    if (sincePowerUpMs < SDCARD_POWER_UP_DELAY_MS) {
+        delay(SDCARD_POWER_UP_DELAY_MS - sincePowerUpMs);
+    }
 
     // Transmit at least 74 dummy clock cycles with CS high so the SD card can start up
     SET_CS_HIGH;
@@ -20,6 +20,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Time from power up, sdcard_init() waits for whatever of it is left
+#define SDCARD_POWER_UP_DELAY_MS 1000
+
 typedef struct sdcardConfig_s {
     uint8_t useDma;
 } sdcardConfig_t;
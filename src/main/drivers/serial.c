@@ -17,9 +17,12 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
+#include "common/maths.h"
+
 #include "serial.h"
 
 void serialPrint(serialPort_t *instance, const char *str)
@@ -56,6 +59,26 @@ void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
     }
 }
 
+uint32_t serialTxBufferWrite(serialPort_t *instance, const uint8_t *data, uint32_t count)
+{
+    count = MIN(count, serialTxBytesFree(instance));
+
+    // at most two runs, up to the end of the buffer and from its start
+    uint32_t copied = 0;
+    while (copied < count) {
+        const uint32_t run = MIN(count - copied, instance->txBufferSize - instance->txBufferHead);
+        memcpy((uint8_t *)&instance->txBuffer[instance->txBufferHead], data + copied, run);
+        if (instance->txBufferHead + run >= instance->txBufferSize) {
+            instance->txBufferHead = 0;
+        } else {
+            instance->txBufferHead += run;
+        }
+        copied += run;
+    }
+
+    return copied;
+}
+
 uint32_t serialRxBytesWaiting(const serialPort_t *instance)
 {
     return instance->vTable->serialTotalRxWaiting(instance);
@@ -71,6 +94,19 @@ uint8_t serialRead(serialPort_t *instance)
     return instance->vTable->serialRead(instance);
 }
 
+uint32_t serialReadBuf(serialPort_t *instance, uint8_t *data, uint32_t maxCount)
+{
+    if (instance->vTable->readBuf) {
+        return instance->vTable->readBuf(instance, data, maxCount);
+    }
+
+    uint32_t count = MIN(serialRxBytesWaiting(instance), maxCount);
+    for (uint32_t i = 0; i < count; i++) {
+        data[i] = serialRead(instance);
+    }
+    return count;
+}
+
 void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate)
 {
     instance->vTable->serialSetBaudRate(instance, baudRate);
@@ -816,6 +816,7 @@ const struct serialPortVTable escSerialVTable[] = {
         .isSerialTransmitBufferEmpty = isEscSerialTransmitBufferEmpty,
         .setMode = escSerialSetMode,
         .writeBuf = NULL,
+        .readBuf = NULL,
         .beginWrite = NULL,
         .endWrite = NULL
     }
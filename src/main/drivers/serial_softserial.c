@@ -43,16 +43,13 @@
 
 #include "serial.h"
 #include "serial_softserial.h"
+#ifdef USE_SOFTSERIAL_DMA
+#include "serial_softserial_dma.h"
+#endif
 
 #define RX_TOTAL_BITS 10
 #define TX_TOTAL_BITS 10
 
-#if defined(USE_SOFTSERIAL1) && defined(USE_SOFTSERIAL2)
-#define MAX_SOFTSERIAL_PORTS 2
-#else
-#define MAX_SOFTSERIAL_PORTS 1
-#endif
-
 typedef enum {
     TIMER_MODE_SINGLE,
     TIMER_MODE_DUAL,
@@ -91,6 +88,11 @@ typedef struct softSerial_s {
     uint16_t         transmissionErrors;
     uint16_t         receiveErrors;
 
+    uint32_t         interrupts;
+    uint32_t         rxBytes;
+    uint32_t         txBytes;
+    uint32_t         openedAtMs;
+
     uint8_t          softSerialPortIndex;
     timerMode_e      timerMode;
 
@@ -243,6 +245,16 @@ serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallb
     IO_t rxIO = IOGetByTag(tagRx);
     IO_t txIO = IOGetByTag(tagTx);
 
+#ifdef USE_SOFTSERIAL_DMA
+    // bytes are decoded when the port is polled, a receive callback needs them from the interrupt
+    if (!rxCallback) {
+        serialPort_t *port = openSoftSerialDma(portIndex, timerRx, timerTx, rxIO, txIO, baud, mode, options);
+        if (port) {
+            return port;
+        }
+    }
+#endif
+
     if (options & SERIAL_BIDIR) {
         // If RX and TX pins are both assigned, we CAN use either with a timer.
         // However, for consistency with hardware UARTs, we only use TX pin,
@@ -297,6 +309,10 @@ serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallb
 
     softSerial->transmissionErrors = 0;
     softSerial->receiveErrors = 0;
+    softSerial->interrupts = 0;
+    softSerial->rxBytes = 0;
+    softSerial->txBytes = 0;
+    softSerial->openedAtMs = millis();
 
     softSerial->rxActive = false;
     softSerial->isTransmittingData = false;
@@ -369,6 +385,7 @@ void processTxState(softSerial_t *softSerial)
         softSerial->internalTxBuffer = (1 << (TX_TOTAL_BITS - 1)) | (byteToSend << 1);
         softSerial->bitsLeftToTransmit = TX_TOTAL_BITS;
         softSerial->isTransmittingData = true;
+        softSerial->txBytes++;
 
         if (softSerial->rxActive && (softSerial->port.options & SERIAL_BIDIR)) {
             // Half-duplex: Deactivate receiver, activate transmitter
@@ -435,6 +452,7 @@ void extractAndStoreRxByte(softSerial_t *softSerial)
     }
 
     uint8_t rxByte = (softSerial->internalRxBuffer >> 1) & 0xFF;
+    softSerial->rxBytes++;
 
     if (softSerial->port.rxCallback) {
         softSerial->port.rxCallback(rxByte);
@@ -473,6 +491,8 @@ void onSerialTimerOverflow(timerOvrHandlerRec_t *cbRec, captureCompare_t capture
     UNUSED(capture);
     softSerial_t *self = container_of(cbRec, softSerial_t, overCb);
 
+    self->interrupts++;
+
     if (self->port.mode & MODE_TX)
         processTxState(self);
 
@@ -487,6 +507,8 @@ void onSerialRxPinChange(timerCCHandlerRec_t *cbRec, captureCompare_t capture)
     softSerial_t *self = container_of(cbRec, softSerial_t, edgeCb);
     bool inverted = self->port.options & SERIAL_INVERTED;
 
+    self->interrupts++;
+
     if ((self->port.mode & MODE_RX) == 0) {
         return;
     }
@@ -610,6 +632,32 @@ bool isSoftSerialTransmitBufferEmpty(const serialPort_t *instance)
     return instance->txBufferHead == instance->txBufferTail;
 }
 
+bool softSerialGetStats(softSerialPortIndex_e portIndex, softSerialStats_t *stats)
+{
+#ifdef USE_SOFTSERIAL_DMA
+    if (softSerialDmaGetStats(portIndex, stats)) {
+        return true;
+    }
+#endif
+
+    const softSerial_t *softSerial = &softSerialPorts[portIndex];
+
+    if (!softSerial->port.vTable) {
+        return false;
+    }
+
+    stats->dma = false;
+    stats->baudRate = softSerial->port.baudRate;
+    stats->openedAtMs = softSerial->openedAtMs;
+    stats->interrupts = softSerial->interrupts;
+    stats->rxBytes = softSerial->rxBytes;
+    stats->txBytes = softSerial->txBytes;
+    stats->rxErrors = softSerial->receiveErrors;
+    stats->txErrors = softSerial->transmissionErrors;
+
+    return true;
+}
+
 static const struct serialPortVTable softSerialVTable = {
     .serialWrite = softSerialWriteByte,
     .serialTotalRxWaiting = softSerialRxBytesWaiting,
@@ -619,6 +667,7 @@ static const struct serialPortVTable softSerialVTable = {
     .isSerialTransmitBufferEmpty = isSoftSerialTransmitBufferEmpty,
     .setMode = softSerialSetMode,
     .writeBuf = NULL,
+    .readBuf = NULL,
     .beginWrite = NULL,
     .endWrite = NULL
 };
@@ -19,11 +19,28 @@
 
 #define SOFTSERIAL_BUFFER_SIZE 256
 
+#if defined(USE_SOFTSERIAL1) && defined(USE_SOFTSERIAL2)
+#define MAX_SOFTSERIAL_PORTS 2
+#else
+#define MAX_SOFTSERIAL_PORTS 1
+#endif
+
 typedef enum {
     SOFTSERIAL1 = 0,
     SOFTSERIAL2
 } softSerialPortIndex_e;
 
+typedef struct softSerialStats_s {
+    bool dma;                   // running on the capture/DMA driver rather than per bit interrupts
+    uint32_t baudRate;
+    uint32_t openedAtMs;
+    uint32_t interrupts;        // timer and DMA interrupts since the port was opened
+    uint32_t rxBytes;
+    uint32_t txBytes;
+    uint16_t rxErrors;          // framing errors and lost captures
+    uint16_t txErrors;
+} softSerialStats_t;
+
 serialPort_t *openSoftSerial(softSerialPortIndex_e portIndex, serialReceiveCallbackPtr rxCallback, uint32_t baud, portMode_t mode, portOptions_t options);
 
 // serialPort API
@@ -34,3 +51,5 @@ uint8_t softSerialReadByte(serialPort_t *instance);
 void softSerialSetBaudRate(serialPort_t *s, uint32_t baudRate);
 bool isSoftSerialTransmitBufferEmpty(const serialPort_t *s);
 
+bool softSerialGetStats(softSerialPortIndex_e portIndex, softSerialStats_t *stats);
+
@@ -0,0 +1,464 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Software serial without per bit interrupts.
+ *
+ * RX: the timer channel captures both edges and DMA copies the capture register into a circular
+ * buffer. Bytes are rebuilt from the edge timestamps when the port is polled.
+ * TX: each byte is expanded into one GPIO BSRR word per bit and a timer compare DMA request writes
+ * them out at the bit rate, with one interrupt per SOFTSERIAL_DMA_TX_BYTES bytes.
+ *
+ * This part is MCU independent, see serial_softserial_dma_stm32f30x.c for the timer and DMA setup.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef USE_SOFTSERIAL_DMA
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/system.h"
+
+#include "serial_softserial_dma.h"
+
+#define SOFTSERIAL_DMA_START_BIT    (1 << 0)
+#define SOFTSERIAL_DMA_STOP_BIT     (1 << (SOFTSERIAL_DMA_FRAME_BITS - 1))
+
+static const struct serialPortVTable softSerialDmaVTable; // Forward
+
+static softSerialDma_t softSerialDmaPorts[MAX_SOFTSERIAL_PORTS];
+
+/*
+ * Edge decoder
+ */
+
+void softSerialDmaDecoderInit(softSerialDmaDecoder_t *decoder, uint32_t timerHz, uint32_t baudRate)
+{
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->bitTicksQ8 = (uint32_t)(((uint64_t)timerHz << 8) / baudRate);
+    decoder->level = true;
+}
+
+void softSerialDmaDecoderReset(softSerialDmaDecoder_t *decoder, bool level)
+{
+    decoder->inFrame = false;
+    decoder->level = level;
+}
+
+static void softSerialDmaFillBits(softSerialDmaDecoder_t *decoder, uint8_t toBit)
+{
+    for (; decoder->bitIndex < toBit; decoder->bitIndex++) {
+        if (decoder->level) {
+            decoder->frame |= 1 << decoder->bitIndex;
+        }
+    }
+}
+
+static bool softSerialDmaCompleteFrame(softSerialDmaDecoder_t *decoder, uint8_t *out)
+{
+    softSerialDmaFillBits(decoder, SOFTSERIAL_DMA_FRAME_BITS);
+    decoder->inFrame = false;
+
+    if ((decoder->frame & SOFTSERIAL_DMA_START_BIT) || !(decoder->frame & SOFTSERIAL_DMA_STOP_BIT)) {
+        decoder->framingErrors++;
+        return false;
+    }
+
+    *out = (decoder->frame >> 1) & 0xFF;
+    return true;
+}
+
+bool softSerialDmaDecodeEdge(softSerialDmaDecoder_t *decoder, uint16_t capture, uint8_t *out)
+{
+    bool complete = false;
+
+    if (decoder->inFrame) {
+        // edges sit on bit boundaries, round to the nearest one so some jitter and baud rate error is tolerated
+        const uint32_t elapsedQ8 = (uint32_t)(uint16_t)(capture - decoder->frameStart) << 8;
+        const uint32_t bit = (elapsedQ8 + decoder->bitTicksQ8 / 2) / decoder->bitTicksQ8;
+
+        softSerialDmaFillBits(decoder, MIN(bit, SOFTSERIAL_DMA_FRAME_BITS));
+        if (bit >= SOFTSERIAL_DMA_FRAME_BITS) {
+            complete = softSerialDmaCompleteFrame(decoder, out);
+        }
+    }
+
+    decoder->level = !decoder->level;
+
+    if (!decoder->inFrame && !decoder->level) {
+        // falling edge from idle, this is the start bit
+        decoder->inFrame = true;
+        decoder->frameStart = capture;
+        decoder->frame = 0;
+        decoder->bitIndex = 0;
+    }
+
+    return complete;
+}
+
+bool softSerialDmaDecodeIdle(softSerialDmaDecoder_t *decoder, uint16_t now, uint8_t *out)
+{
+    if (!decoder->inFrame) {
+        return false;
+    }
+
+    // no edge until the middle of the stop bit, the rest of the frame has the current level
+    const uint32_t elapsedQ8 = (uint32_t)(uint16_t)(now - decoder->frameStart) << 8;
+    if (elapsedQ8 < (2 * SOFTSERIAL_DMA_FRAME_BITS - 1) * decoder->bitTicksQ8 / 2) {
+        return false;
+    }
+
+    return softSerialDmaCompleteFrame(decoder, out);
+}
+
+/*
+ * TX waveform
+ */
+
+uint16_t softSerialDmaBuildFrames(uint32_t *waveform, const uint8_t *data, uint8_t count, uint32_t highWord, uint32_t lowWord)
+{
+    uint16_t words = 0;
+
+    for (int i = 0; i < count; i++) {
+        // start bit in bit 0, data LSB first, stop bit
+        uint16_t frame = SOFTSERIAL_DMA_STOP_BIT | (data[i] << 1);
+
+        for (int bit = 0; bit < SOFTSERIAL_DMA_FRAME_BITS; bit++) {
+            waveform[words++] = (frame & 1) ? highWord : lowWord;
+            frame >>= 1;
+        }
+    }
+
+    return words;
+}
+
+static bool softSerialDmaTxBufferEmpty(const softSerialDma_t *softSerial)
+{
+    return softSerial->port.txBufferHead == softSerial->port.txBufferTail;
+}
+
+static uint16_t softSerialDmaFillWaveform(softSerialDma_t *softSerial)
+{
+    uint8_t data[SOFTSERIAL_DMA_TX_BYTES];
+    uint8_t count = 0;
+
+    while (count < SOFTSERIAL_DMA_TX_BYTES && !softSerialDmaTxBufferEmpty(softSerial)) {
+        data[count++] = softSerial->port.txBuffer[softSerial->port.txBufferTail];
+        softSerial->port.txBufferTail = (softSerial->port.txBufferTail + 1) % softSerial->port.txBufferSize;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    softSerial->stats.txBytes += count;
+
+    uint16_t words = softSerialDmaBuildFrames(softSerial->txWaveform, data, count, softSerial->txHighWord, softSerial->txLowWord);
+    if (softSerialDmaTxBufferEmpty(softSerial)) {
+        // the transfer completes as the last word is written, this holds the stop bit for its full length
+        softSerial->txWaveform[words++] = softSerial->txHighWord;
+    }
+
+    return words;
+}
+
+/*
+ * RX and TX engine
+ */
+
+static void softSerialDmaStartRx(softSerialDma_t *softSerial)
+{
+    softSerialDmaDecoderInit(&softSerial->decoder, softSerial->rxTimerHz, softSerial->port.baudRate);
+    softSerial->rxHalfTransfers = 0;
+    softSerial->rxReadPosition = 0;
+
+    softSerialDmaHardwareStartRx(softSerial);
+    softSerial->rxActive = true;
+}
+
+static void softSerialDmaStoreRxByte(softSerialDma_t *softSerial, uint8_t rxByte)
+{
+    softSerial->port.rxBuffer[softSerial->port.rxBufferHead] = rxByte;
+    softSerial->port.rxBufferHead = (softSerial->port.rxBufferHead + 1) % softSerial->port.rxBufferSize;
+    softSerial->stats.rxBytes++;
+}
+
+static void softSerialDmaProcessRx(softSerialDma_t *softSerial)
+{
+    uint8_t rxByte;
+
+    if (!softSerial->rxActive) {
+        return;
+    }
+
+    // sample the timer first so every edge before it is among the captures read below
+    const uint16_t now = softSerialDmaHardwareRxNow(softSerial);
+
+    // the half transfer count may be one behind the DMA if its interrupt is pending
+    const uint32_t halfBase = softSerial->rxHalfTransfers * (SOFTSERIAL_DMA_RX_EDGES / 2);
+    const uint32_t written = halfBase + ((softSerialDmaHardwareRxIndex(softSerial) - halfBase) % SOFTSERIAL_DMA_RX_EDGES);
+
+    if (written - softSerial->rxReadPosition > SOFTSERIAL_DMA_RX_EDGES) {
+        // unread captures were overwritten, carry on from the line level after the newest edge
+        softSerial->stats.rxErrors++;
+        softSerial->rxReadPosition = written;
+        softSerialDmaDecoderReset(&softSerial->decoder, (written & 1) == 0);
+    }
+
+    while (softSerial->rxReadPosition != written) {
+        const uint16_t capture = softSerial->rxCaptures[softSerial->rxReadPosition % SOFTSERIAL_DMA_RX_EDGES];
+        softSerial->rxReadPosition++;
+
+        if (softSerialDmaDecodeEdge(&softSerial->decoder, capture, &rxByte)) {
+            softSerialDmaStoreRxByte(softSerial, rxByte);
+        }
+    }
+
+    if (softSerialDmaDecodeIdle(&softSerial->decoder, now, &rxByte)) {
+        softSerialDmaStoreRxByte(softSerial, rxByte);
+    }
+
+    softSerial->stats.rxErrors += softSerial->decoder.framingErrors;
+    softSerial->decoder.framingErrors = 0;
+}
+
+static void softSerialDmaStartTx(softSerialDma_t *softSerial)
+{
+    if (softSerial->port.options & SERIAL_BIDIR) {
+        // decode what arrived before the pin turns around
+        softSerialDmaProcessRx(softSerial);
+        softSerial->rxActive = false;
+        softSerialDmaHardwareStopRx(softSerial);
+    }
+
+    const uint16_t words = softSerialDmaFillWaveform(softSerial);
+    if (words) {
+        softSerial->txActive = true;
+        softSerialDmaHardwareStartTx(softSerial, words, true);
+    }
+}
+
+void softSerialDmaRxHalfTransfer(softSerialDma_t *softSerial)
+{
+    softSerial->stats.interrupts++;
+    softSerial->rxHalfTransfers++;
+}
+
+void softSerialDmaTxTransferComplete(softSerialDma_t *softSerial)
+{
+    softSerial->stats.interrupts++;
+
+    const uint16_t words = softSerialDmaFillWaveform(softSerial);
+    if (words) {
+        softSerialDmaHardwareStartTx(softSerial, words, false);
+        return;
+    }
+
+    softSerialDmaHardwareStopTx(softSerial);
+    softSerial->txActive = false;
+
+    if (softSerial->port.options & SERIAL_BIDIR) {
+        softSerialDmaStartRx(softSerial);
+    }
+}
+
+serialPort_t *openSoftSerialDma(softSerialPortIndex_e portIndex, const struct timerHardware_s *timerRx, const struct timerHardware_s *timerTx, IO_t rxIO, IO_t txIO, uint32_t baud, portMode_t mode, portOptions_t options)
+{
+    softSerialDma_t *softSerial = &softSerialDmaPorts[portIndex];
+
+    memset(softSerial, 0, sizeof(*softSerial));
+
+    if (options & SERIAL_BIDIR) {
+        softSerial->timerHardware = timerTx;
+        softSerial->txTimerHardware = timerTx;
+        softSerial->rxIO = txIO;
+        softSerial->txIO = txIO;
+    } else {
+        softSerial->timerHardware = (mode & MODE_RX) ? timerRx : NULL;
+        softSerial->txTimerHardware = (mode & MODE_TX) ? timerTx : NULL;
+        softSerial->rxIO = (mode & MODE_RX) ? rxIO : IO_NONE;
+        softSerial->txIO = (mode & MODE_TX) ? txIO : IO_NONE;
+    }
+
+    softSerial->port.baudRate = baud;
+    softSerial->port.mode = mode;
+    softSerial->port.options = options;
+
+    softSerial->port.rxBufferSize = SOFTSERIAL_BUFFER_SIZE;
+    softSerial->port.rxBuffer = softSerial->rxBuffer;
+    softSerial->port.txBufferSize = SOFTSERIAL_BUFFER_SIZE;
+    softSerial->port.txBuffer = softSerial->txBuffer;
+
+    // claims pins and DMA channels only if all of them are available
+    if (!softSerialDmaHardwareInit(softSerial, portIndex)) {
+        return NULL;
+    }
+
+    softSerial->port.vTable = &softSerialDmaVTable;
+
+    softSerial->stats.dma = true;
+    softSerial->stats.openedAtMs = millis();
+
+    if ((mode & MODE_RX) || (options & SERIAL_BIDIR)) {
+        softSerialDmaStartRx(softSerial);
+    }
+
+    return &softSerial->port;
+}
+
+bool softSerialDmaGetStats(softSerialPortIndex_e portIndex, softSerialStats_t *stats)
+{
+    const softSerialDma_t *softSerial = &softSerialDmaPorts[portIndex];
+
+    if (!softSerial->port.vTable) {
+        return false;
+    }
+
+    *stats = softSerial->stats;
+    stats->baudRate = softSerial->port.baudRate;
+
+    return true;
+}
+
+/*
+ * Standard serial driver API
+ */
+
+static void softSerialDmaWriteByte(serialPort_t *instance, uint8_t ch)
+{
+    softSerialDma_t *softSerial = (softSerialDma_t *)instance;
+
+    if ((instance->mode & MODE_TX) == 0) {
+        return;
+    }
+
+    instance->txBuffer[instance->txBufferHead] = ch;
+    instance->txBufferHead = (instance->txBufferHead + 1) % instance->txBufferSize;
+
+    // a transfer in progress picks the byte up when it completes
+    if (!softSerial->txActive && !softSerial->txHeld) {
+        softSerialDmaStartTx(softSerial);
+    }
+}
+
+static uint32_t softSerialDmaRxBytesWaiting(const serialPort_t *instance)
+{
+    if ((instance->mode & MODE_RX) == 0) {
+        return 0;
+    }
+
+    softSerialDmaProcessRx((softSerialDma_t *)instance);
+
+    return (instance->rxBufferHead - instance->rxBufferTail) & (instance->rxBufferSize - 1);
+}
+
+static uint32_t softSerialDmaTxBytesFree(const serialPort_t *instance)
+{
+    if ((instance->mode & MODE_TX) == 0) {
+        return 0;
+    }
+
+    const uint32_t bytesUsed = (instance->txBufferHead - instance->txBufferTail) & (instance->txBufferSize - 1);
+
+    return (instance->txBufferSize - 1) - bytesUsed;
+}
+
+static uint8_t softSerialDmaReadByte(serialPort_t *instance)
+{
+    // callers check the bytes waiting first, which decodes the captures
+    if (instance->rxBufferHead == instance->rxBufferTail && softSerialDmaRxBytesWaiting(instance) == 0) {
+        return 0;
+    }
+
+    const uint8_t ch = instance->rxBuffer[instance->rxBufferTail];
+    instance->rxBufferTail = (instance->rxBufferTail + 1) % instance->rxBufferSize;
+    return ch;
+}
+
+static void softSerialDmaSetBaudRate(serialPort_t *instance, uint32_t baudRate)
+{
+    softSerialDma_t *softSerial = (softSerialDma_t *)instance;
+
+    instance->baudRate = baudRate;
+
+    softSerialDmaHardwareSetBaudRate(softSerial);
+    if (softSerial->rxActive) {
+        softSerialDmaStartRx(softSerial);
+    }
+}
+
+static bool softSerialDmaTransmitBufferEmpty(const serialPort_t *instance)
+{
+    return instance->txBufferHead == instance->txBufferTail;
+}
+
+static void softSerialDmaSetMode(serialPort_t *instance, portMode_t mode)
+{
+    instance->mode = mode;
+}
+
+static void softSerialDmaBeginWrite(serialPort_t *instance)
+{
+    ((softSerialDma_t *)instance)->txHeld = true;
+}
+
+static void softSerialDmaEndWrite(serialPort_t *instance)
+{
+    softSerialDma_t *softSerial = (softSerialDma_t *)instance;
+
+    softSerial->txHeld = false;
+    if (!softSerial->txActive && !softSerialDmaTxBufferEmpty(softSerial)) {
+        softSerialDmaStartTx(softSerial);
+    }
+}
+
+static void softSerialDmaWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    const uint8_t *p = data;
+
+    // queue everything first so the bytes go out back to back in as few transfers as possible
+    softSerialDmaBeginWrite(instance);
+    for (; count > 0; count--, p++) {
+        while (!softSerialDmaTxBytesFree(instance)) {
+            softSerialDmaEndWrite(instance);
+        }
+        softSerialDmaWriteByte(instance, *p);
+    }
+    softSerialDmaEndWrite(instance);
+}
+
+static const struct serialPortVTable softSerialDmaVTable = {
+    .serialWrite = softSerialDmaWriteByte,
+    .serialTotalRxWaiting = softSerialDmaRxBytesWaiting,
+    .serialTotalTxFree = softSerialDmaTxBytesFree,
+    .serialRead = softSerialDmaReadByte,
+    .serialSetBaudRate = softSerialDmaSetBaudRate,
+    .isSerialTransmitBufferEmpty = softSerialDmaTransmitBufferEmpty,
+    .setMode = softSerialDmaSetMode,
+    .writeBuf = softSerialDmaWriteBuf,
+    .readBuf = NULL,
+    .beginWrite = softSerialDmaBeginWrite,
+    .endWrite = softSerialDmaEndWrite
+};
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "drivers/io_types.h"
+#include "drivers/serial.h"
+#include "drivers/serial_softserial.h"
+
+struct timerHardware_s;
+
+#define SOFTSERIAL_DMA_RX_EDGES     256     // captures of both edges, a byte has up to 10 so this lasts 4ms at 57600 before it must be polled
+#define SOFTSERIAL_DMA_TX_BYTES     8       // bytes per TX transfer, one interrupt each
+#define SOFTSERIAL_DMA_FRAME_BITS   10
+#define SOFTSERIAL_DMA_TX_WORDS     (SOFTSERIAL_DMA_TX_BYTES * SOFTSERIAL_DMA_FRAME_BITS + 1)
+
+// Turns input capture timestamps of both edges into bytes. The line is idle high, edges alternate.
+typedef struct softSerialDmaDecoder_s {
+    uint32_t bitTicksQ8;        // capture timer ticks per bit, 24.8 fixed point
+    uint16_t frameStart;        // capture of the start bit edge
+    uint16_t frame;             // start bit in bit 0, stop bit in bit 9
+    uint8_t bitIndex;           // bits of the frame known so far
+    bool inFrame;
+    bool level;                 // line level after the last edge, true is idle
+    uint16_t framingErrors;
+} softSerialDmaDecoder_t;
+
+void softSerialDmaDecoderInit(softSerialDmaDecoder_t *decoder, uint32_t timerHz, uint32_t baudRate);
+void softSerialDmaDecoderReset(softSerialDmaDecoder_t *decoder, bool level);
+// true when a byte was completed and written to out, an edge may complete the previous frame
+bool softSerialDmaDecodeEdge(softSerialDmaDecoder_t *decoder, uint16_t capture, uint8_t *out);
+bool softSerialDmaDecodeIdle(softSerialDmaDecoder_t *decoder, uint16_t now, uint8_t *out);
+
+uint16_t softSerialDmaBuildFrames(uint32_t *waveform, const uint8_t *data, uint8_t count, uint32_t highWord, uint32_t lowWord);
+
+typedef struct softSerialDma_s {
+    serialPort_t port;
+
+    IO_t rxIO;
+    IO_t txIO;
+    const struct timerHardware_s *timerHardware;    // RX, or the only pin for half-duplex
+    const struct timerHardware_s *txTimerHardware;
+
+    uint32_t rxTimerHz;                         // capture timer clock, set by the hardware layer
+    volatile uint16_t rxCaptures[SOFTSERIAL_DMA_RX_EDGES];
+    volatile uint32_t rxHalfTransfers;          // counted by the capture DMA interrupt
+    uint32_t rxReadPosition;                    // in captures since RX was started
+    softSerialDmaDecoder_t decoder;
+    bool rxActive;
+
+    uint32_t txWaveform[SOFTSERIAL_DMA_TX_WORDS];   // GPIO BSRR words, one per bit
+    uint32_t txHighWord;
+    uint32_t txLowWord;
+    volatile bool txActive;
+    bool txHeld;                                // between beginWrite and endWrite
+
+    volatile uint8_t rxBuffer[SOFTSERIAL_BUFFER_SIZE];
+    volatile uint8_t txBuffer[SOFTSERIAL_BUFFER_SIZE];
+
+    softSerialStats_t stats;
+} softSerialDma_t;
+
+serialPort_t *openSoftSerialDma(softSerialPortIndex_e portIndex, const struct timerHardware_s *timerRx, const struct timerHardware_s *timerTx, IO_t rxIO, IO_t txIO, uint32_t baud, portMode_t mode, portOptions_t options);
+bool softSerialDmaGetStats(softSerialPortIndex_e portIndex, softSerialStats_t *stats);
+
+// called by the DMA interrupts of the hardware layer
+void softSerialDmaRxHalfTransfer(softSerialDma_t *softSerial);
+void softSerialDmaTxTransferComplete(softSerialDma_t *softSerial);
+
+// hardware layer, one per MCU family
+bool softSerialDmaHardwareInit(softSerialDma_t *softSerial, softSerialPortIndex_e portIndex);
+void softSerialDmaHardwareSetBaudRate(softSerialDma_t *softSerial);
+void softSerialDmaHardwareStartRx(softSerialDma_t *softSerial);
+void softSerialDmaHardwareStopRx(softSerialDma_t *softSerial);
+uint16_t softSerialDmaHardwareRxIndex(const softSerialDma_t *softSerial);    // next capture slot the DMA writes
+uint16_t softSerialDmaHardwareRxNow(const softSerialDma_t *softSerial);      // capture timer counter
+void softSerialDmaHardwareStartTx(softSerialDma_t *softSerial, uint16_t words, bool first);
+void softSerialDmaHardwareStopTx(softSerialDma_t *softSerial);
@@ -0,0 +1,289 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#ifdef USE_SOFTSERIAL_DMA
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "dma.h"
+#include "io.h"
+#include "io_impl.h"
+#include "nvic.h"
+#include "rcc.h"
+#include "system.h"
+#include "timer.h"
+
+#include "serial_softserial_dma.h"
+
+#define SOFTSERIAL_DMA_RX_TICKS_PER_BIT 16
+
+static uint32_t softSerialDmaTimerClock(const timerHardware_t *timerHardware)
+{
+    return SystemCoreClock / timerClockDivisor(timerHardware->tim);
+}
+
+static void softSerialDmaConfigureTimebase(TIM_TypeDef *tim, uint16_t prescaler, uint16_t period)
+{
+    TIM_TimeBaseInitTypeDef TIM_TimeBaseStructure;
+
+    TIM_Cmd(tim, DISABLE);
+
+    TIM_TimeBaseStructInit(&TIM_TimeBaseStructure);
+    TIM_TimeBaseStructure.TIM_Period = period;
+    TIM_TimeBaseStructure.TIM_Prescaler = prescaler;
+    TIM_TimeBaseStructure.TIM_ClockDivision = 0;
+    TIM_TimeBaseStructure.TIM_CounterMode = TIM_CounterMode_Up;
+    TIM_TimeBaseInit(tim, &TIM_TimeBaseStructure);
+}
+
+static void softSerialDmaIrqHandler(dmaChannelDescriptor_t *descriptor)
+{
+    softSerialDma_t *softSerial = (softSerialDma_t *)descriptor->userParam;
+
+    // a half-duplex port shares the channel between directions
+    if (softSerial->txActive && softSerial->txTimerHardware->dmaChannel == descriptor->channel) {
+        if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+            DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+            softSerialDmaTxTransferComplete(softSerial);
+        }
+        return;
+    }
+
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_HTIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_HTIF);
+        softSerialDmaRxHalfTransfer(softSerial);
+    }
+    if (DMA_GET_FLAG_STATUS(descriptor, DMA_IT_TCIF)) {
+        DMA_CLEAR_FLAG(descriptor, DMA_IT_TCIF);
+        softSerialDmaRxHalfTransfer(softSerial);
+    }
+}
+
+static bool softSerialDmaChannelFree(const timerHardware_t *timerHardware)
+{
+    return timerHardware->dmaChannel && dmaGetOwner(timerHardware->dmaIrqHandler) == OWNER_FREE;
+}
+
+static void softSerialDmaClaimChannel(softSerialDma_t *softSerial, const timerHardware_t *timerHardware, resourceOwner_e owner, uint8_t resourceIndex)
+{
+    dmaInit(timerHardware->dmaIrqHandler, owner, resourceIndex);
+    dmaSetHandler(timerHardware->dmaIrqHandler, softSerialDmaIrqHandler, NVIC_PRIO_SOFTSERIAL_DMA, (uint32_t)softSerial);
+    RCC_ClockCmd(timerRCC(timerHardware->tim), ENABLE);
+}
+
+bool softSerialDmaHardwareInit(softSerialDma_t *softSerial, softSerialPortIndex_e portIndex)
+{
+    const timerHardware_t *rxTimer = softSerial->timerHardware;
+    const timerHardware_t *txTimer = softSerial->txTimerHardware;
+    const uint8_t resourceIndex = RESOURCE_INDEX(portIndex) + RESOURCE_SOFT_OFFSET;
+    const bool bidir = softSerial->port.options & SERIAL_BIDIR;
+
+    if ((softSerial->port.mode & MODE_RX) && !(rxTimer && softSerial->rxIO)) {
+        return false;
+    }
+    if ((softSerial->port.mode & MODE_TX) && !(txTimer && softSerial->txIO)) {
+        return false;
+    }
+    if ((rxTimer && !softSerialDmaChannelFree(rxTimer)) || (txTimer && !softSerialDmaChannelFree(txTimer))) {
+        return false;
+    }
+    // full duplex runs capture and bit clock at the same time, each needs its own time base and channel
+    if (rxTimer && txTimer && !bidir && (rxTimer->tim == txTimer->tim || rxTimer->dmaChannel == txTimer->dmaChannel)) {
+        return false;
+    }
+
+    if (rxTimer) {
+        IOInit(softSerial->rxIO, bidir ? OWNER_SERIAL_TX : OWNER_SERIAL_RX, resourceIndex);
+        softSerialDmaClaimChannel(softSerial, rxTimer, bidir ? OWNER_SERIAL_TX : OWNER_SERIAL_RX, resourceIndex);
+    }
+
+    if (txTimer && !bidir) {
+        IOInit(softSerial->txIO, OWNER_SERIAL_TX, resourceIndex);
+        softSerialDmaClaimChannel(softSerial, txTimer, OWNER_SERIAL_TX, resourceIndex);
+    }
+
+    if (txTimer) {
+        const uint32_t pinMask = IO_Pin(softSerial->txIO);
+
+        // BSRR sets the pin with the low half word and resets it with the high one
+        if (softSerial->port.options & SERIAL_INVERTED) {
+            softSerial->txHighWord = pinMask << 16;
+            softSerial->txLowWord = pinMask;
+        } else {
+            softSerial->txHighWord = pinMask;
+            softSerial->txLowWord = pinMask << 16;
+        }
+
+        if (!bidir) {
+            IO_GPIO(softSerial->txIO)->BSRR = softSerial->txHighWord;
+            IOConfigGPIO(softSerial->txIO, IOCFG_OUT_PP);
+        }
+    }
+
+    softSerialDmaHardwareSetBaudRate(softSerial);
+
+    return true;
+}
+
+void softSerialDmaHardwareSetBaudRate(softSerialDma_t *softSerial)
+{
+    if (!softSerial->timerHardware) {
+        return;
+    }
+
+    const uint32_t clock = softSerialDmaTimerClock(softSerial->timerHardware);
+    const uint32_t divider = MAX(clock / (softSerial->port.baudRate * SOFTSERIAL_DMA_RX_TICKS_PER_BIT), 1);
+
+    softSerial->rxTimerHz = clock / divider;
+}
+
+void softSerialDmaHardwareStartRx(softSerialDma_t *softSerial)
+{
+    const timerHardware_t *timerHardware = softSerial->timerHardware;
+    TIM_TypeDef *tim = timerHardware->tim;
+    DMA_Channel_TypeDef *dmaChannel = timerHardware->dmaChannel;
+    TIM_ICInitTypeDef TIM_ICInitStructure;
+    DMA_InitTypeDef DMA_InitStructure;
+
+    IOConfigGPIOAF(softSerial->rxIO, (softSerial->port.options & SERIAL_INVERTED) ? IOCFG_AF_PP_PD : IOCFG_AF_PP_UP, timerHardware->alternateFunction);
+
+    // free running, wraps after 4096 bits
+    softSerialDmaConfigureTimebase(tim, softSerialDmaTimerClock(timerHardware) / softSerial->rxTimerHz - 1, 0xFFFF);
+
+    TIM_ICStructInit(&TIM_ICInitStructure);
+    TIM_ICInitStructure.TIM_Channel = timerHardware->channel;
+    TIM_ICInitStructure.TIM_ICPolarity = TIM_ICPolarity_BothEdge;
+    TIM_ICInitStructure.TIM_ICSelection = TIM_ICSelection_DirectTI;
+    TIM_ICInitStructure.TIM_ICPrescaler = TIM_ICPSC_DIV1;
+    TIM_ICInitStructure.TIM_ICFilter = 0x0;
+    TIM_ICInit(tim, &TIM_ICInitStructure);
+
+    DMA_Cmd(dmaChannel, DISABLE);
+    DMA_DeInit(dmaChannel);
+
+    DMA_StructInit(&DMA_InitStructure);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)timerCCR(tim, timerHardware->channel);
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)softSerial->rxCaptures;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = SOFTSERIAL_DMA_RX_EDGES;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(dmaChannel, &DMA_InitStructure);
+
+    DMA_ITConfig(dmaChannel, DMA_IT_HT | DMA_IT_TC, ENABLE);
+    DMA_Cmd(dmaChannel, ENABLE);
+
+    TIM_DMACmd(tim, timerDmaSource(timerHardware->channel), ENABLE);
+    TIM_Cmd(tim, ENABLE);
+}
+
+void softSerialDmaHardwareStopRx(softSerialDma_t *softSerial)
+{
+    const timerHardware_t *timerHardware = softSerial->timerHardware;
+
+    TIM_DMACmd(timerHardware->tim, timerDmaSource(timerHardware->channel), DISABLE);
+    TIM_CCxCmd(timerHardware->tim, timerHardware->channel, TIM_CCx_Disable);
+    DMA_Cmd(timerHardware->dmaChannel, DISABLE);
+}
+
+uint16_t softSerialDmaHardwareRxIndex(const softSerialDma_t *softSerial)
+{
+    return SOFTSERIAL_DMA_RX_EDGES - DMA_GetCurrDataCounter(softSerial->timerHardware->dmaChannel);
+}
+
+uint16_t softSerialDmaHardwareRxNow(const softSerialDma_t *softSerial)
+{
+    return softSerial->timerHardware->tim->CNT;
+}
+
+void softSerialDmaHardwareStartTx(softSerialDma_t *softSerial, uint16_t words, bool first)
+{
+    const timerHardware_t *timerHardware = softSerial->txTimerHardware;
+    TIM_TypeDef *tim = timerHardware->tim;
+    DMA_Channel_TypeDef *dmaChannel = timerHardware->dmaChannel;
+
+    DMA_Cmd(dmaChannel, DISABLE);
+
+    if (first) {
+        TIM_OCInitTypeDef TIM_OCInitStructure;
+        DMA_InitTypeDef DMA_InitStructure;
+
+        uint32_t period = softSerialDmaTimerClock(timerHardware) / softSerial->port.baudRate;
+        const uint16_t prescaler = period / 0x10000;
+        period /= prescaler + 1;
+
+        if (softSerial->port.options & SERIAL_BIDIR) {
+            IO_GPIO(softSerial->txIO)->BSRR = softSerial->txHighWord;
+            IOConfigGPIO(softSerial->txIO, IOCFG_OUT_PP);
+        }
+
+        softSerialDmaConfigureTimebase(tim, prescaler, period - 1);
+
+        // the compare only paces the DMA, the pin is written through BSRR
+        TIM_OCStructInit(&TIM_OCInitStructure);
+        TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_Timing;
+        TIM_OCInitStructure.TIM_Pulse = period / 2;
+        timerOCInit(tim, timerHardware->channel, &TIM_OCInitStructure);
+
+        DMA_DeInit(dmaChannel);
+
+        DMA_StructInit(&DMA_InitStructure);
+        DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&IO_GPIO(softSerial->txIO)->BSRR;
+        DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)softSerial->txWaveform;
+        DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralDST;
+        DMA_InitStructure.DMA_BufferSize = words;
+        DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+        DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+        DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Word;
+        DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Word;
+        DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+        DMA_InitStructure.DMA_Priority = DMA_Priority_High;
+        DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+        DMA_Init(dmaChannel, &DMA_InitStructure);
+
+        DMA_ITConfig(dmaChannel, DMA_IT_TC, ENABLE);
+
+        TIM_SetCounter(tim, 0);
+        TIM_DMACmd(tim, timerDmaSource(timerHardware->channel), ENABLE);
+        TIM_Cmd(tim, ENABLE);
+    }
+
+    DMA_SetCurrDataCounter(dmaChannel, words);
+    DMA_Cmd(dmaChannel, ENABLE);
+}
+
+void softSerialDmaHardwareStopTx(softSerialDma_t *softSerial)
+{
+    const timerHardware_t *timerHardware = softSerial->txTimerHardware;
+
+    TIM_DMACmd(timerHardware->tim, timerDmaSource(timerHardware->channel), DISABLE);
+    DMA_Cmd(timerHardware->dmaChannel, DISABLE);
+    TIM_Cmd(timerHardware->tim, DISABLE);
+}
+
+#endif
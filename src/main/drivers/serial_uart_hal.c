@@ -23,11 +23,13 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "platform.h"
 
 #include "build/build_config.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 #include "io.h"
 #include "nvic.h"
@@ -359,6 +361,47 @@ uint8_t uartRead(serialPort_t *instance)
     return ch;
 }
 
+uint32_t uartReadBuf(serialPort_t *instance, uint8_t *data, uint32_t maxCount)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    uint32_t count = MIN(uartTotalRxBytesWaiting(instance), maxCount);
+    uint32_t copied = 0;
+
+    // copy out in at most two runs, up to the end of the buffer and from its start
+    while (copied < count) {
+        uint32_t run;
+        if (s->rxDMAStream) {
+            const uint32_t pos = s->port.rxBufferSize - s->rxDMAPos;
+            run = MIN(count - copied, s->rxDMAPos);
+            memcpy(data + copied, (const uint8_t *)&s->port.rxBuffer[pos], run);
+            s->rxDMAPos -= run;
+            if (s->rxDMAPos == 0)
+                s->rxDMAPos = s->port.rxBufferSize;
+        } else {
+            run = MIN(count - copied, s->port.rxBufferSize - s->port.rxBufferTail);
+            memcpy(data + copied, (const uint8_t *)&s->port.rxBuffer[s->port.rxBufferTail], run);
+            if (s->port.rxBufferTail + run >= s->port.rxBufferSize) {
+                s->port.rxBufferTail = 0;
+            } else {
+                s->port.rxBufferTail += run;
+            }
+        }
+        copied += run;
+    }
+
+    return count;
+}
+
+static void uartStartTx(uartPort_t *s)
+{
+    if (s->txDMAStream) {
+        if (!(s->txDMAStream->CR & 1))
+            uartStartTxDMA(s);
+    } else {
+        __HAL_UART_ENABLE_IT(&s->Handle, UART_IT_TXE);
+    }
+}
+
 void uartWrite(serialPort_t *instance, uint8_t ch)
 {
     uartPort_t *s = (uartPort_t *)instance;
@@ -369,11 +412,20 @@ void uartWrite(serialPort_t *instance, uint8_t ch)
         s->port.txBufferHead++;
     }
 
-    if (s->txDMAStream) {
-        if (!(s->txDMAStream->CR & 1))
-            uartStartTxDMA(s);
-    } else {
-        __HAL_UART_ENABLE_IT(&s->Handle, UART_IT_TXE);
+    uartStartTx(s);
+}
+
+void uartWriteBuf(serialPort_t *instance, const void *data, int count)
+{
+    uartPort_t *s = (uartPort_t *)instance;
+    const uint8_t *src = data;
+
+    // queue what fits and start the transmitter, then wait for it to free space for the rest
+    while (count > 0) {
+        const uint32_t copied = serialTxBufferWrite(instance, src, count);
+        src += copied;
+        count -= copied;
+        uartStartTx(s);
     }
 }
 
@@ -386,7 +438,8 @@ const struct serialPortVTable uartVTable[] = {
         .serialSetBaudRate = uartSetBaudRate,
         .isSerialTransmitBufferEmpty = isUartTransmitBufferEmpty,
         .setMode = uartSetMode,
-        .writeBuf = NULL,
+        .writeBuf = uartWriteBuf,
+        .readBuf = uartReadBuf,
         .beginWrite = NULL,
         .endWrite = NULL,
     }
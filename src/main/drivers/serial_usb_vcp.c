@@ -174,6 +174,7 @@ static const struct serialPortVTable usbVTable[] = {
         .isSerialTransmitBufferEmpty = isUsbVcpTransmitBufferEmpty,
         .setMode = usbVcpSetMode,
         .writeBuf = usbVcpWriteBuf,
+        .readBuf = NULL,
         .beginWrite = usbVcpBeginWrite,
         .endWrite = usbVcpEndWrite
     }
@@ -0,0 +1,129 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "drivers/servo_timing.h"
+
+void servoTimingInit(servoTiming_t *timing, servoPulseMode_e mode, uint16_t rateHz)
+{
+    const bool narrow = (mode == SERVO_PULSE_NARROW);
+
+    rateHz = constrain(rateHz, SERVO_PWM_RATE_MIN, narrow ? SERVO_PWM_RATE_MAX_NARROW : SERVO_PWM_RATE_MAX_STANDARD);
+
+    timing->synced = narrow;
+    timing->timerMhz = narrow ? SERVO_TIMER_MHZ_NARROW : SERVO_TIMER_MHZ_STANDARD;
+    timing->periodTicks = (uint32_t)timing->timerMhz * 1000000 / rateHz;
+
+    if (narrow) {
+        // At 1kHz the widest pulse would fill the whole period, leave the servo a gap to find the next rising edge
+        timing->guardTicks = SERVO_PULSE_GUARD_US * timing->timerMhz;
+        timing->maxPulseTicks = timing->periodTicks - timing->guardTicks;
+        // Only runs out when the loop is slower than the servo rate
+        timing->timerPeriodTicks = MIN((uint32_t)timing->periodTicks + timing->periodTicks / 4, 0xFFFF);
+        // Never faster than servo_pwm_rate, an early loop leaves the pulse to the next one or the timer
+        timing->triggerTicks = timing->periodTicks;
+    } else {
+        timing->guardTicks = 0;
+        timing->maxPulseTicks = 0xFFFF;
+        servoTimingSetFreeRunning(timing);
+    }
+}
+
+void servoTimingSetFreeRunning(servoTiming_t *timing)
+{
+    timing->synced = false;
+    timing->timerPeriodTicks = timing->periodTicks;
+    timing->triggerTicks = timing->periodTicks;
+}
+
+uint16_t servoTimingPulseTicks(const servoTiming_t *timing, uint16_t value)
+{
+    return MIN(value, timing->maxPulseTicks);
+}
+
+void servoPulseTrackerInit(servoPulseTracker_t *tracker)
+{
+    memset(tracker, 0, sizeof(*tracker));
+}
+
+void servoPulseTrackerWrite(servoPulseTracker_t *tracker, uint16_t value, uint32_t nowUs)
+{
+    tracker->value[1] = tracker->value[0];
+    tracker->writeTimeUs[1] = tracker->writeTimeUs[0];
+    tracker->value[0] = value;
+    tracker->writeTimeUs[0] = nowUs;
+}
+
+bool servoPulseTrackerCanTrigger(const servoPulseTracker_t *tracker, const servoTiming_t *timing, uint16_t counter)
+{
+    if (!timing->synced) {
+        return false;
+    }
+
+    // Called right after a write, so the pulse that may still be running carries the value before it
+    const uint16_t activePulseTicks = servoTimingPulseTicks(timing, tracker->value[1]);
+
+    return counter >= timing->triggerTicks && counter >= activePulseTicks + timing->guardTicks;
+}
+
+void servoPulseTrackerUpdate(servoPulseTracker_t *tracker, const servoTiming_t *timing, uint16_t counter, uint32_t nowUs, servoPulse_t *pulse)
+{
+    const uint32_t startUs = nowUs - counter / timing->timerMhz;
+    const uint32_t periodUs = timing->periodTicks / timing->timerMhz;
+
+    // Pulses are most of a period apart, the start of the same pulse only moves by the counter resolution
+    if (!tracker->latched || cmp32(startUs, tracker->lastPulseStartUs) > (int32_t)(periodUs / 2)) {
+        tracker->lastPulseStartUs = startUs;
+
+        // The timer latches the compare value at the start of a pulse
+        uint16_t value = tracker->latched;
+        uint32_t writeTimeUs = 0;
+        if (cmp32(startUs, tracker->writeTimeUs[0]) >= 0) {
+            value = tracker->value[0];
+            writeTimeUs = tracker->writeTimeUs[0];
+        } else if (cmp32(startUs, tracker->writeTimeUs[1]) >= 0) {
+            value = tracker->value[1];
+            writeTimeUs = tracker->writeTimeUs[1];
+        }
+
+        if (value != tracker->latched) {
+            // Free running pulses since the write carried it already
+            const uint32_t timerPeriodUs = timing->timerPeriodTicks / timing->timerMhz;
+            tracker->previous = tracker->latched;
+            tracker->latched = value;
+            tracker->latchedStartUs = startUs - ((startUs - writeTimeUs) / timerPeriodUs) * timerPeriodUs;
+        }
+    }
+
+    const uint32_t pulseEndUs = tracker->latchedStartUs + servoTimingPulseTicks(timing, tracker->latched) / timing->timerMhz;
+    if (cmp32(nowUs, pulseEndUs) >= 0) {
+        pulse->value = tracker->latched;
+        pulse->previousValue = tracker->previous;
+        pulse->ageUs = nowUs - pulseEndUs;
+    } else {
+        // Still measuring the newest pulse, it has acted on the previous one for longer than we know
+        pulse->value = tracker->previous;
+        pulse->previousValue = tracker->previous;
+        pulse->ageUs = UINT32_MAX;
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Servo values keep their 1000-2000 range in every mode, the timer runs at one tick per servo unit.
+typedef enum {
+    SERVO_PULSE_STANDARD = 0,   // 1500us center, free running at servo_pwm_rate
+    SERVO_PULSE_NARROW,         // 760us center for digital servos, started right after the mixer
+} servoPulseMode_e;
+
+#define SERVO_TIMER_MHZ_STANDARD    1
+#define SERVO_TIMER_MHZ_NARROW      2
+
+#define SERVO_PWM_RATE_MIN          50
+#define SERVO_PWM_RATE_MAX_STANDARD 498
+#define SERVO_PWM_RATE_MAX_NARROW   1000
+
+#define SERVO_PULSE_GUARD_US        20      // shortest low time between two narrow pulses
+
+typedef struct servoTiming_s {
+    bool synced;                // pulses are started by pwmCompleteServoUpdate()
+    uint8_t timerMhz;
+    uint16_t periodTicks;       // refresh period at servo_pwm_rate
+    uint16_t timerPeriodTicks;  // free running period, longer than periodTicks when synced so the loop starts the pulses
+    uint16_t triggerTicks;      // earliest counter value a synced pulse may start at
+    uint16_t maxPulseTicks;
+    uint16_t guardTicks;
+} servoTiming_t;
+
+// Time line of one servo output, built from the values written and the timer counter
+typedef struct servoPulseTracker_s {
+    uint16_t value[2];          // last two values written, newest first
+    uint32_t writeTimeUs[2];
+    uint16_t latched;           // value of the newest pulse
+    uint16_t previous;          // value of the pulse before it
+    uint32_t latchedStartUs;    // first pulse carrying latched
+    uint32_t lastPulseStartUs;
+} servoPulseTracker_t;
+
+// What the servo is acting on. A servo takes a new command at the end of the pulse carrying it.
+typedef struct servoPulse_s {
+    uint16_t value;
+    uint16_t previousValue;
+    uint32_t ageUs;             // since the servo switched from previousValue to value
+} servoPulse_t;
+
+void servoTimingInit(servoTiming_t *timing, servoPulseMode_e mode, uint16_t rateHz);
+void servoTimingSetFreeRunning(servoTiming_t *timing);     // for a timer that can not be restarted by the loop
+uint16_t servoTimingPulseTicks(const servoTiming_t *timing, uint16_t value);
+
+void servoPulseTrackerInit(servoPulseTracker_t *tracker);
+void servoPulseTrackerWrite(servoPulseTracker_t *tracker, uint16_t value, uint32_t nowUs);
+// counter is the servo timer count, i.e. the ticks since the newest pulse started
+bool servoPulseTrackerCanTrigger(const servoPulseTracker_t *tracker, const servoTiming_t *timing, uint16_t counter);
+void servoPulseTrackerUpdate(servoPulseTracker_t *tracker, const servoTiming_t *timing, uint16_t counter, uint32_t nowUs, servoPulse_t *pulse);
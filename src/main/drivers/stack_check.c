@@ -17,20 +17,17 @@
 
 #include <stdbool.h>
 #include <stdint.h>
-#include <string.h>
 
 #include "platform.h"
 
 #include "build/debug.h"
 
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/stack_check.h"
 
-#define STACK_FILL_CHAR 0xa5
-
-extern char _estack; // end of stack, declared in .LD file
-extern char _Min_Stack_Size; // declared in .LD file
+#include "scheduler/scheduler.h"
 
 /*
  * The ARM processor uses a full descending stack. This means the stack pointer holds the address
@@ -47,53 +44,197 @@ extern char _Min_Stack_Size; // declared in .LD file
  * F3 Boards
  * RAM is origin 0x20000000 length 40K that is:
  * 0x20000000 to 0x2000a000
+ * the stack is in CCM, 0x10000000 to 0x10002000, above FAST_RAM
  *
  * F4 Boards
  * RAM is origin 0x20000000 length 128K that is:
  * 0x20000000 to 0x20020000
+ * the stack is in CCM on the F405
  *
+ * The linker only keeps _Min_Stack_Size for the stack, it can grow below that down to the static data
+ * of its region. stackInit() paints that part as well and the checks scan all of it.
  */
 
+#ifdef UNIT_TEST
+// The test provides the stack
+extern uint32_t *unitTestStackTop;
+extern uint32_t unitTestStackSize;
+extern uint32_t *unitTestStackPointer;
+#define STACK_TOP           unitTestStackTop
+#define STACK_SIZE          unitTestStackSize
+#define STACK_POINTER()     unitTestStackPointer
+#define STACK_BOTTOM        (STACK_TOP - STACK_SIZE / sizeof(uint32_t))
+#else
+// declared in .LD file
+extern char _estack;                // end of stack
+extern char _heap_stack_begin;      // the startup code paints from here up
+extern char _ebss, _efastram_bss, _efastcode;
+static uint32_t *stackBottom = (uint32_t *)&_heap_stack_begin;
+#define STACK_TOP           ((uint32_t *)&_estack)
+#define STACK_BOTTOM        stackBottom
+#define STACK_SIZE          ((uint32_t)(STACK_TOP - STACK_BOTTOM) * sizeof(uint32_t))
+#define STACK_POINTER()     ((uint32_t *)__get_MSP())
+#endif
+
+void stackPaint(uint32_t *bottom, const uint32_t *top)
+{
+    while (bottom < top) {
+        *bottom++ = STACK_FILL_WORD;
+    }
+}
+
+const uint32_t *stackLowestUsed(const uint32_t *bottom, const uint32_t *top)
+{
+    while (bottom < top && *bottom == STACK_FILL_WORD) {
+        bottom++;
+    }
+    return bottom;
+}
+
+void stackInit(void)
+{
+#ifndef UNIT_TEST
+    // Whichever of these ends highest below the stack is in its region: .bss on the F1, the fast sections on the
+    // F3, F405 and F7. Those in other regions are above it, or on the F7 ITCM below the TCM ones.
+    const char * const staticEnds[] = { &_ebss, &_efastram_bss, &_efastcode };
+    const char *bottom = NULL;
+    for (unsigned i = 0; i < ARRAYLEN(staticEnds); i++) {
+        if (staticEnds[i] <= &_heap_stack_begin && (!bottom || staticEnds[i] > bottom)) {
+            bottom = staticEnds[i];
+        }
+    }
+    if (!bottom) {
+        return;
+    }
+    stackBottom = (uint32_t *)(((uintptr_t)bottom + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1));
+    stackPaint(stackBottom, (uint32_t *)&_heap_stack_begin);
+#endif
+}
+
 #ifdef STACK_CHECK
 
 static uint32_t usedStackSize;
 
+#ifdef STACK_CHECK_TASKS
+static bool sampleArmed;
+static bool sampleRunning;
+static uint8_t sampleCursor;        // tasks are sampled in turn, from this id up
+static const uint32_t *sampleTop;
+#endif
+
+static uint32_t stackDepth(const uint32_t *lowest)
+{
+    return (uint32_t)(STACK_TOP - lowest) * sizeof(uint32_t);
+}
+
 void taskStackCheck(timeUs_t currentTimeUs)
 {
     UNUSED(currentTimeUs);
 
-    char * const stackHighMem = &_estack;
-    const uint32_t stackSize = (uint32_t)&_Min_Stack_Size;
-    char * const stackLowMem = stackHighMem - stackSize;
-    const char * const stackCurrent = (char *)&stackLowMem;
+    // Painted at boot, the task samples paint again only above what was used before
+    const uint32_t * const stackCurrent = STACK_POINTER();
+    const uint32_t * const lowest = stackLowestUsed(STACK_BOTTOM, stackCurrent);
 
-    char *p;
-    for (p = stackLowMem; p < stackCurrent; ++p) {
-        if (*p != STACK_FILL_CHAR) {
-            break;
-        }
-    }
+    usedStackSize = MAX(usedStackSize, stackDepth(lowest));
 
-    usedStackSize = (uint32_t)stackHighMem - (uint32_t)p;
+#ifdef STACK_CHECK_TASKS
+    if (sampleArmed) {
+        // No task at or above the cursor ran since the last time, start from the first again
+        sampleCursor = 0;
+    }
+    sampleArmed = true;
+#endif
 
-    DEBUG_SET(DEBUG_STACK, 0, (uint32_t)stackHighMem & 0xffff);
-    DEBUG_SET(DEBUG_STACK, 1, (uint32_t)stackLowMem & 0xffff);
-    DEBUG_SET(DEBUG_STACK, 2, (uint32_t)stackCurrent & 0xffff);
-    DEBUG_SET(DEBUG_STACK, 3, (uint32_t)p & 0xffff);
+    DEBUG_SET(DEBUG_STACK, 0, (uintptr_t)STACK_TOP & 0xffff);
+    DEBUG_SET(DEBUG_STACK, 1, (uintptr_t)STACK_BOTTOM & 0xffff);
+    DEBUG_SET(DEBUG_STACK, 2, (uintptr_t)stackCurrent & 0xffff);
+    DEBUG_SET(DEBUG_STACK, 3, (uintptr_t)lowest & 0xffff);
 }
 
 uint32_t stackUsedSize(void)
 {
     return usedStackSize;
 }
+
+#ifdef STACK_CHECK_TASKS
+bool stackSampleBegin(uint8_t taskId)
+{
+    if (!sampleArmed || taskId < sampleCursor) {
+        return false;
+    }
+    sampleArmed = false;
+    sampleCursor = (taskId + 1) % TASK_COUNT;
+
+    uint32_t * const stackCurrent = STACK_POINTER();
+    uint32_t * const paintTop = stackCurrent - STACK_SAMPLE_GUARD / sizeof(uint32_t);
+    uint32_t * const floor = (uint32_t *)stackLowestUsed(STACK_BOTTOM, paintTop);
+    sampleTop = stackCurrent;
+    usedStackSize = MAX(usedStackSize, stackDepth(floor));
+
+    // Below the floor it is still as painted at boot
+    stackPaint(floor, paintTop);
+    sampleRunning = true;
+
+    return true;
+}
+
+uint32_t stackSampleEnd(void)
+{
+    if (!sampleRunning) {
+        return 0;
+    }
+    sampleRunning = false;
+
+    const uint32_t used = stackDepth(stackLowestUsed(STACK_BOTTOM, sampleTop));
+    usedStackSize = MAX(usedStackSize, used);
+
+    return used;
+}
+#endif
 #endif
 
 uint32_t stackTotalSize(void)
 {
-    return (uint32_t)&_Min_Stack_Size;
+    return STACK_SIZE;
 }
 
 uint32_t stackHighMem(void)
 {
-    return (uint32_t)&_estack;
+    return (uint32_t)(uintptr_t)STACK_TOP;
 }
+
+#ifndef UNIT_TEST
+// declared in .LD file
+extern char _sdata, _edata, _sbss, _ebss;
+extern char _sfastram_data, _efastram_data, _sfastram_bss, _efastram_bss, _sfastcode, _efastcode;
+extern char _sram, _eram, _heap_stack_begin;
+
+static bool inRam(const char *p)
+{
+    return p >= &_sram && p < &_eram;
+}
+
+void getRamUsage(ramUsage_t *usage)
+{
+    usage->dataSize = &_edata - &_sdata;
+    usage->bssSize = &_ebss - &_sbss;
+    usage->fastRamSize = (&_efastram_data - &_sfastram_data) + (&_efastram_bss - &_sfastram_bss) + (&_efastcode - &_sfastcode);
+    usage->stackSize = stackTotalSize();
+#ifdef STACK_CHECK
+    usage->stackUsed = stackUsedSize();
+#else
+    usage->stackUsed = 0;
+#endif
+
+    // Where there is no CCM or TCM the fast sections follow .bss, and the stack is at the end of RAM
+    const char *used = &_ebss;
+    if (inRam(&_efastram_bss) && &_efastram_bss > used) {
+        used = &_efastram_bss;
+    }
+    if (inRam(&_efastcode) && &_efastcode > used) {
+        used = &_efastcode;
+    }
+    const char *limit = inRam(&_heap_stack_begin) ? &_heap_stack_begin : &_eram;
+    usage->freeSize = limit > used ? limit - used : 0;
+}
+#endif
@@ -17,9 +17,37 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 #include "common/time.h"
 
+#define STACK_FILL_WORD         0xa5a5a5a5  // the startup code paints the heap and stack with it
+#define STACK_SAMPLE_GUARD      64          // bytes below the scheduler left alone when painting for a task sample
+
+typedef struct ramUsage_s {
+    uint32_t dataSize;
+    uint32_t bssSize;
+    uint32_t fastRamSize;       // FAST_RAM and FAST_CODE sections, in CCM or TCM where there is some
+    uint32_t stackSize;         // down to the static data below it, _Min_Stack_Size is only the least of it
+    uint32_t stackUsed;         // high-water mark since boot, 0 without STACK_CHECK
+    uint32_t freeSize;          // RAM left between the static data and the stack, or the end of RAM
+} ramUsage_t;
+
+// Paints [bottom, top) with STACK_FILL_WORD
+void stackPaint(uint32_t *bottom, const uint32_t *top);
+// First word from bottom upwards that is not STACK_FILL_WORD, top when there is none
+const uint32_t *stackLowestUsed(const uint32_t *bottom, const uint32_t *top);
+
+// Paints the stack below what the startup code painted, once the fast sections are in place
+void stackInit(void);
 void taskStackCheck(timeUs_t currentTimeUs);
 uint32_t stackUsedSize(void);
 uint32_t stackTotalSize(void);
 uint32_t stackHighMem(void);
+void getRamUsage(ramUsage_t *usage);
+
+// Scheduler. Every run of taskStackCheck() arms a sample of the next task in turn: the free stack
+// is painted before the task runs and scanned after it. Returns false when this task is not sampled.
+bool stackSampleBegin(uint8_t taskId);
+// Peak stack use in bytes while the sampled task ran, interrupts that hit meanwhile included
+uint32_t stackSampleEnd(void);
@@ -17,6 +17,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -35,6 +36,18 @@ static volatile uint32_t sysTickUptime = 0;
 // cached value of RCC->CSR
 uint32_t cachedRccCsrValue;
 
+#ifndef DWT
+// The CMSIS core header of the F1 library has no DWT definitions, the counter is the same on every Cortex-M3/M4/M7
+typedef struct {
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} dwtCycleCounter_t;
+
+#define DWT_BASE                0xE0001000UL
+#define DWT                     ((dwtCycleCounter_t *)DWT_BASE)
+#define DWT_CTRL_CYCCNTENA_Msk  (1UL << 0)
+#endif
+
 void cycleCounterInit(void)
 {
 #if defined(USE_HAL_DRIVER)
@@ -44,6 +57,20 @@ void cycleCounterInit(void)
     RCC_GetClocksFreq(&clocks);
     usTicks = clocks.SYSCLK_Frequency / 1000000;
 #endif
+
+    // DWT cycle counter, for the PIDLOOP_CYCLES debug mode
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+#ifdef STM32F7
+    *(volatile uint32_t *)(DWT_BASE + 0xFB0) = 0xC5ACCE55;     // DWT lock access register, locked after reset on the M7
+#endif
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+// Core clock cycles, wraps every minute or so, only differences are of use
+uint32_t getCycleCounter(void)
+{
+    return DWT->CYCCNT;
 }
 
 // SysTick
@@ -207,3 +234,24 @@ void failureMode(failureMode_e mode)
     systemResetToBootloader();
 #endif
 }
+
+#if defined(USE_FAST_RAM) || defined(USE_FAST_CODE)
+// Set up by the linker scripts, see FASTRAM and FASTCODE
+extern uint8_t _sfastram_data, _efastram_data, _sifastram_data;
+extern uint8_t _sfastram_bss, _efastram_bss;
+extern uint8_t _sfastcode, _efastcode, _sifastcode;
+#endif
+
+void fastMemoryInit(void)
+{
+#if defined(USE_FAST_RAM) || defined(USE_FAST_CODE)
+    // The startup code only knows about .data and .bss in RAM
+    memcpy(&_sfastram_data, &_sifastram_data, &_efastram_data - &_sfastram_data);
+    memset(&_sfastram_bss, 0, &_efastram_bss - &_sfastram_bss);
+    memcpy(&_sfastcode, &_sifastcode, &_efastcode - &_sfastcode);
+
+    // Nothing may run from the copied code before it is visible to instruction fetch
+    __DSB();
+    __ISB();
+#endif
+}
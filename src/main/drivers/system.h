@@ -43,6 +43,9 @@ void systemReset(void);
 void systemResetToBootloader(void);
 bool isMPUSoftReset(void);
 void cycleCounterInit(void);
+uint32_t getCycleCounter(void);
+// copies FAST_RAM and FAST_CODE into place, before anything uses them
+void fastMemoryInit(void);
 void checkForBootLoaderRequest(void);
 
 void enableGPIOPowerUsageAndNoiseReductions(void);
@@ -94,10 +94,10 @@ static void TRANSPONDER_DMA_IRQHandler(dmaChannelDescriptor_t* descriptor)
     }
 }
 
-void transponderIrHardwareInit(ioTag_t ioTag)
+bool transponderIrHardwareInit(ioTag_t ioTag)
 {
     if (!ioTag) {
-        return;
+        return false;
     }
 
     TIM_TimeBaseInitTypeDef  TIM_TimeBaseStructure;
@@ -109,14 +109,19 @@ void transponderIrHardwareInit(ioTag_t ioTag)
 
 #if defined(STM32F3)
     if (timerHardware->dmaChannel == NULL) {
-        return;
+        return false;
     }
 #elif defined(STM32F4)
     if (timerHardware->dmaStream == NULL) {
-        return;
+        return false;
     }
 #endif
 
+    // a soft serial port may already run on the channel, don't take over its interrupt
+    if (dmaGetOwner(timerHardware->dmaIrqHandler) != OWNER_FREE) {
+        return false;
+    }
+
     transponderIO = IOGetByTag(ioTag);
     IOInit(transponderIO, OWNER_TRANSPONDER, 0);
     IOConfigGPIOAF(transponderIO, IO_CONFIG(GPIO_Mode_AF, GPIO_Speed_50MHz, GPIO_OType_PP, GPIO_PuPd_DOWN), timerHardware->alternateFunction);
@@ -206,6 +211,8 @@ void transponderIrHardwareInit(ioTag_t ioTag)
 #elif defined(STM32F4)
     DMA_ITConfig(stream, DMA_IT_TC, ENABLE);
 #endif
+
+    return true;
 }
 
 bool transponderIrInit(void)
@@ -225,9 +232,7 @@ bool transponderIrInit(void)
     }
 
 
-    transponderIrHardwareInit(ioTag);
-
-    return true;
+    return transponderIrHardwareInit(ioTag);
 }
 
 bool isTransponderIrReady(void)
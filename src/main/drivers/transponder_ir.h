@@ -22,7 +22,7 @@
 bool transponderIrInit();
 void transponderIrDisable(void);
 
-void transponderIrHardwareInit(ioTag_t ioTag);
+bool transponderIrHardwareInit(ioTag_t ioTag);
 void transponderIrDMAEnable(void);
 
 void transponderIrWaitForTransmitComplete(void);
@@ -59,6 +59,14 @@ vtxDevType_e vtxCommonGetDeviceType(void)
     return vtxDevice->vTable->getDeviceType();
 }
 
+bool vtxCommonIsBusy(void)
+{
+    if (!vtxDevice || !vtxDevice->vTable->isBusy)
+        return false;
+
+    return vtxDevice->vTable->isBusy();
+}
+
 // band and chan are 1 origin
 void vtxCommonSetBandChan(uint8_t band, uint8_t chan)
 {
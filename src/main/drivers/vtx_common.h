@@ -55,6 +55,7 @@ typedef struct vtxVTable_s {
     void (*process)(uint32_t currentTimeUs);
     vtxDevType_e (*getDeviceType)(void);
     bool (*isReady)(void);
+    bool (*isBusy)(void);       // commands queued or waiting for a response
 
     void (*setBandChan)(uint8_t band, uint8_t chan);
     void (*setPowerByIndex)(uint8_t level);
@@ -76,6 +77,7 @@ void vtxCommonRegisterDevice(vtxDevice_t *pDevice);
 // VTable functions
 void vtxCommonProcess(uint32_t currentTimeUs);
 uint8_t vtxCommonGetDeviceType(void);
+bool vtxCommonIsBusy(void);
 void vtxCommonSetBandChan(uint8_t band, uint8_t chan);
 void vtxCommonSetPowerByIndex(uint8_t level);
 void vtxCommonSetPitmode(uint8_t onoff);
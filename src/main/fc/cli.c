@@ -41,6 +41,7 @@ uint8_t cliMode = 0;
 #include "common/color.h"
 #include "common/maths.h"
 #include "common/printf.h"
+#include "common/sorted_index.h"
 #include "common/typeconversion.h"
 
 #include "config/config_eeprom.h"
@@ -51,6 +52,7 @@ uint8_t cliMode = 0;
 #include "drivers/accgyro.h"
 #include "drivers/buf_writer.h"
 #include "drivers/bus_i2c.h"
+#include "drivers/bus_spi.h"
 #include "drivers/compass.h"
 #include "drivers/dma.h"
 #include "drivers/flash.h"
@@ -61,6 +63,8 @@ uint8_t cliMode = 0;
 #include "drivers/sensor.h"
 #include "drivers/serial.h"
 #include "drivers/serial_escserial.h"
+#include "drivers/serial_softserial.h"
+#include "drivers/servo_timing.h"
 #include "drivers/stack_check.h"
 #include "drivers/system.h"
 #include "drivers/timer.h"
@@ -105,11 +109,18 @@ uint8_t cliMode = 0;
 #include "sensors/sensors.h"
 
 #include "telemetry/frsky.h"
+#include "telemetry/mavlink_highrate.h"
 #include "telemetry/telemetry.h"
 
 static serialPort_t *cliPort;
 static bufWriter_t *cliWriter;
-static uint8_t cliWriteBuffer[sizeof(*cliWriter) + 128];
+#ifdef MINIMAL_CLI
+#define CLI_OUT_BUFFER_SIZE 128
+#else
+// output is only flushed when this fills up or a command completes, bigger chunks make a dump over VCP much faster
+#define CLI_OUT_BUFFER_SIZE 255
+#endif
+static uint8_t cliWriteBuffer[sizeof(*cliWriter) + CLI_OUT_BUFFER_SIZE];
 
 static char cliBuffer[48];
 static uint32_t bufferIndex = 0;
@@ -172,6 +183,12 @@ static const char * const lookupTableAccHardware[] = {
     "FAKE"
 };
 
+// sync this with imuEstimator_e
+static const char * const lookupTableImuEstimator[] = {
+    "MAHONY",
+    "QUATERNION"
+};
+
 #ifdef BARO
 // sync this with baroSensor_e
 static const char * const lookupTableBaroHardware[] = {
@@ -181,6 +198,12 @@ static const char * const lookupTableBaroHardware[] = {
     "MS5611",
     "BMP280"
 };
+
+// sync this with altEstimator_e
+static const char * const lookupTableAltEstimator[] = {
+    "CF",
+    "3STATE"
+};
 #endif
 
 #ifdef MAG
@@ -318,7 +341,9 @@ static const char * const lookupTableDebug[DEBUG_COUNT] = {
     "ESC_SENSOR",
     "SCHEDULER",
     "STACK",
-    "TRI"
+    "TRI",
+    "OSD",
+    "PIDLOOP_CYCLES"
 };
 
 #ifdef OSD
@@ -360,6 +385,17 @@ static const char * const lookupServoFeedback[] = {
     "VIRTUAL", "RSSI", "CURRENT", "EXT1"
 };
 
+// sync this with servoPulseMode_e
+static const char * const lookupTableServoPulseMode[] = {
+    "STANDARD", "NARROW"
+};
+
+#ifdef USE_DUAL_GYRO
+static const char * const lookupTableGyroFusion[] = {
+    "AVERAGE", "MEDIAN"
+};
+#endif
+
 typedef struct lookupTableEntry_s {
     const char * const *values;
     const uint8_t valueCount;
@@ -389,8 +425,10 @@ typedef enum {
 #endif
     TABLE_GYRO_LPF,
     TABLE_ACC_HARDWARE,
+    TABLE_IMU_ESTIMATOR,
 #ifdef BARO
     TABLE_BARO_HARDWARE,
+    TABLE_ALT_ESTIMATOR,
 #endif
 #ifdef MAG
     TABLE_MAG_HARDWARE,
@@ -406,6 +444,10 @@ typedef enum {
     TABLE_OSD,
 #endif
     TABLE_SERVO_FEEDBACK,
+    TABLE_SERVO_PULSE_MODE,
+#ifdef USE_DUAL_GYRO
+    TABLE_GYRO_FUSION,
+#endif
 } lookupTableIndex_e;
 
 static const lookupTableEntry_t lookupTables[] = {
@@ -432,8 +474,10 @@ static const lookupTableEntry_t lookupTables[] = {
 #endif
     { lookupTableGyroLpf, sizeof(lookupTableGyroLpf) / sizeof(char *) },
     { lookupTableAccHardware, sizeof(lookupTableAccHardware) / sizeof(char *) },
+    { lookupTableImuEstimator, sizeof(lookupTableImuEstimator) / sizeof(char *) },
 #ifdef BARO
     { lookupTableBaroHardware, sizeof(lookupTableBaroHardware) / sizeof(char *) },
+    { lookupTableAltEstimator, sizeof(lookupTableAltEstimator) / sizeof(char *) },
 #endif
 #ifdef MAG
     { lookupTableMagHardware, sizeof(lookupTableMagHardware) / sizeof(char *) },
@@ -449,6 +493,10 @@ static const lookupTableEntry_t lookupTables[] = {
     { lookupTableOsdType, sizeof(lookupTableOsdType) / sizeof(char *) },
 #endif
     { lookupServoFeedback, sizeof(lookupServoFeedback) / sizeof(char *) },
+    { lookupTableServoPulseMode, sizeof(lookupTableServoPulseMode) / sizeof(char *) },
+#ifdef USE_DUAL_GYRO
+    { lookupTableGyroFusion, sizeof(lookupTableGyroFusion) / sizeof(char *) },
+#endif
 };
 
 #define VALUE_TYPE_OFFSET 0
@@ -599,6 +647,9 @@ const clivalue_t valueTable[] = {
 #if defined(TELEMETRY_IBUS)
     { "ibus_report_cell_voltage",   VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, &ibusTelemetryConfig()->report_cell_voltage, .config.lookup = { TABLE_OFF_ON } },
 #endif
+#if defined(TELEMETRY_MAVLINK)
+    { "mavlink_highrate_hz",        VAR_UINT16 | MASTER_VALUE,  &telemetryConfig()->mavlink_highrate_hz, .config.minmax = { 0,  MAVLINK_HIGHRATE_MAX_HZ } },
+#endif
 #endif
 
     { "bat_capacity",               VAR_UINT16 | MASTER_VALUE,  &batteryConfig()->batteryCapacity, .config.minmax = { 0,  20000 } },
@@ -637,8 +688,14 @@ const clivalue_t valueTable[] = {
     { "gyro_notch2_hz",             VAR_UINT16 | MASTER_VALUE,  &gyroConfig()->gyro_soft_notch_hz_2, .config.minmax = { 0,  16000 } },
     { "gyro_notch2_cut",            VAR_UINT16 | MASTER_VALUE,  &gyroConfig()->gyro_soft_notch_cutoff_2, .config.minmax = { 1, 16000 } },
     { "moron_threshold",            VAR_UINT8  | MASTER_VALUE,  &gyroConfig()->gyroMovementCalibrationThreshold, .config.minmax = { 0,  200 } },
+#ifdef USE_DUAL_GYRO
+    { "gyro_fusion_mode",           VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &gyroConfig()->gyro_fusion_mode, .config.lookup = { TABLE_GYRO_FUSION } },
+    { "gyro_2_weight",              VAR_UINT8  | MASTER_VALUE,  &gyroConfig()->gyro_2_weight, .config.minmax = { 0,  100 } },
+    { "align_gyro_2",               VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &gyroConfig()->gyro_2_align, .config.lookup = { TABLE_ALIGNMENT } },
+#endif
     { "imu_dcm_kp",                 VAR_UINT16 | MASTER_VALUE,  &imuConfig()->dcm_kp, .config.minmax = { 0,  32000 } },
     { "imu_dcm_ki",                 VAR_UINT16 | MASTER_VALUE,  &imuConfig()->dcm_ki, .config.minmax = { 0,  32000 } },
+    { "imu_estimator",              VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &imuConfig()->estimator, .config.lookup = { TABLE_IMU_ESTIMATOR } },
 
     { "alt_hold_deadband",          VAR_UINT8  | MASTER_VALUE, &rcControlsConfig()->alt_hold_deadband, .config.minmax = { 1,  250 } },
     { "alt_hold_fast_change",       VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, &rcControlsConfig()->alt_hold_fast_change, .config.lookup = { TABLE_OFF_ON } },
@@ -660,7 +717,8 @@ const clivalue_t valueTable[] = {
     { "servo_center_pulse",         VAR_UINT16 | MASTER_VALUE,  &servoConfig()->servoCenterPulse, .config.minmax = { PWM_RANGE_ZERO,  PWM_RANGE_MAX } },
     { "servo_lowpass_hz",           VAR_UINT16 | MASTER_VALUE, &servoMixerConfig()->servo_lowpass_freq, .config.minmax = { 10,  400} },
     { "servo_lowpass",              VAR_INT8   | MASTER_VALUE | MODE_LOOKUP, &servoMixerConfig()->servo_lowpass_enable, .config.lookup = { TABLE_OFF_ON } },
-    { "servo_pwm_rate",             VAR_UINT16 | MASTER_VALUE,  &servoConfig()->servoPwmRate, .config.minmax = { 50,  498 } },
+    { "servo_pwm_rate",             VAR_UINT16 | MASTER_VALUE,  &servoConfig()->servoPwmRate, .config.minmax = { SERVO_PWM_RATE_MIN,  SERVO_PWM_RATE_MAX_NARROW } },
+    { "servo_pulse_mode",           VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, &servoConfig()->servoPulseMode, .config.lookup = { TABLE_SERVO_PULSE_MODE } },
     { "gimbal_mode",                VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP, &gimbalConfig()->mode, .config.lookup = { TABLE_GIMBAL_MODE } },
     { "channel_forwarding_start",    VAR_UINT8  | MASTER_VALUE, &channelForwardingConfig()->startChannel, .config.minmax = { AUX1, MAX_SUPPORTED_RC_CHANNEL_COUNT } },
     { "tri_tail_motor_thrustfactor",VAR_INT16  | MASTER_VALUE, &triMixerConfig()->tri_tail_motor_thrustfactor, .config.minmax = { TAIL_THRUST_FACTOR_MIN, TAIL_THRUST_FACTOR_MAX } },
@@ -708,6 +766,8 @@ const clivalue_t valueTable[] = {
     { "baro_cf_vel",                VAR_FLOAT  | MASTER_VALUE, &barometerConfig()->baro_cf_vel, .config.minmax = { 0 , 1 } },
     { "baro_cf_alt",                VAR_FLOAT  | MASTER_VALUE, &barometerConfig()->baro_cf_alt, .config.minmax = { 0 , 1 } },
     { "baro_hardware",              VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &barometerConfig()->baro_hardware, .config.lookup = { TABLE_BARO_HARDWARE } },
+    { "baro_estimator",             VAR_UINT8  | MASTER_VALUE | MODE_LOOKUP,  &barometerConfig()->baro_estimator, .config.lookup = { TABLE_ALT_ESTIMATOR } },
+    { "baro_est_tau",               VAR_UINT8  | MASTER_VALUE, &barometerConfig()->baro_est_tau, .config.minmax = { 10,  100 } },
 #endif
 
 #ifdef MAG
@@ -832,12 +892,40 @@ const clivalue_t valueTable[] = {
 
 #define VALUE_COUNT (sizeof(valueTable) / sizeof(clivalue_t))
 
+#ifndef MINIMAL_CLI
+// valueTable sorted by name, built on cliEnter() and used by 'set' instead of a linear scan
+static uint16_t valueIndex[VALUE_COUNT];
+static bool valueIndexBuilt = false;
+
+static const char *valueNameForTableIndex(uint16_t tableIndex)
+{
+    return valueTable[tableIndex].name;
+}
+#endif
+
+static const clivalue_t *findValue(const char *name, uint8_t nameLength)
+{
+#ifndef MINIMAL_CLI
+    const int tableIndex = sortedIndexFind(valueIndex, VALUE_COUNT, valueNameForTableIndex, name, nameLength);
+    return tableIndex < 0 ? NULL : &valueTable[tableIndex];
+#else
+    for (uint32_t i = 0; i < VALUE_COUNT; i++) {
+        // ensure exact match when setting to prevent setting variables with shorter names
+        if (strncasecmp(name, valueTable[i].name, strlen(valueTable[i].name)) == 0 && nameLength == strlen(valueTable[i].name)) {
+            return &valueTable[i];
+        }
+    }
+    return NULL;
+#endif
+}
+
+// Output is buffered in cliWriter and flushed once per processed command (or whenever the buffer fills),
+// so dump and diff go out in full size writes rather than one write per line fragment.
 static void cliPrint(const char *str)
 {
     while (*str) {
         bufWriterAppend(cliWriter, *str++);
     }
-    bufWriterFlush(cliWriter);
 }
 
 #ifdef MINIMAL_CLI
@@ -863,7 +951,6 @@ static bool cliDumpPrintf(uint8_t dumpMask, bool equalsDefault, const char *form
         va_start(va, format);
         tfp_format(cliWriter, cliPutp, format, va);
         va_end(va);
-        bufWriterFlush(cliWriter);
         return true;
     } else {
         return false;
@@ -884,7 +971,6 @@ static bool cliDefaultPrintf(uint8_t dumpMask, bool equalsDefault, const char *f
         va_start(va, format);
         tfp_format(cliWriter, cliPutp, format, va);
         va_end(va);
-        bufWriterFlush(cliWriter);
         return true;
     } else {
         return false;
@@ -897,7 +983,6 @@ static void cliPrintf(const char *format, ...)
     va_start(va, format);
     tfp_format(cliWriter, cliPutp, format, va);
     va_end(va);
-    bufWriterFlush(cliWriter);
 }
 
 static void printValuePointer(const clivalue_t *var, void *valuePointer, uint32_t full)
@@ -1032,11 +1117,12 @@ static void dumpValues(uint16_t valueSection, uint8_t dumpMask, const master_t *
         }
 
         const char *format = "set %s = ";
-        if (cliDefaultPrintf(dumpMask, valueEqualsDefault(value, defaultConfig), format, valueTable[i].name)) {
+        const bool equalsDefault = valueEqualsDefault(value, defaultConfig);
+        if (cliDefaultPrintf(dumpMask, equalsDefault, format, valueTable[i].name)) {
             cliPrintVarDefault(value, 0, defaultConfig);
             cliPrint("\r\n");
         }
-        if (cliDumpPrintf(dumpMask, valueEqualsDefault(value, defaultConfig), format, valueTable[i].name)) {
+        if (cliDumpPrintf(dumpMask, equalsDefault, format, valueTable[i].name)) {
             cliPrintVar(value, 0);
             cliPrint("\r\n");
         }
@@ -3147,61 +3233,57 @@ static void cliSet(char *cmdline)
             eqptr++;
         }
 
-        for (uint32_t i = 0; i < VALUE_COUNT; i++) {
-            val = &valueTable[i];
-            // ensure exact match when setting to prevent setting variables with shorter names
-            if (strncasecmp(cmdline, valueTable[i].name, strlen(valueTable[i].name)) == 0 && variableNameLength == strlen(valueTable[i].name)) {
-
-                bool changeValue = false;
-                int_float_value_t tmp = { 0 };
-                switch (valueTable[i].type & VALUE_MODE_MASK) {
-                    case MODE_DIRECT: {
-                            int32_t value = 0;
-                            float valuef = 0;
+        val = findValue(cmdline, variableNameLength);
+        if (val) {
+            bool changeValue = false;
+            int_float_value_t tmp = { 0 };
+            switch (val->type & VALUE_MODE_MASK) {
+                case MODE_DIRECT: {
+                        int32_t value = 0;
+                        float valuef = 0;
 
-                            value = atoi(eqptr);
-                            valuef = fastA2F(eqptr);
+                        value = atoi(eqptr);
+                        valuef = fastA2F(eqptr);
 
-                            if (valuef >= valueTable[i].config.minmax.min && valuef <= valueTable[i].config.minmax.max) { // note: compare float value
+                        if (valuef >= val->config.minmax.min && valuef <= val->config.minmax.max) { // note: compare float value
 
-                                if ((valueTable[i].type & VALUE_TYPE_MASK) == VAR_FLOAT)
-                                    tmp.float_value = valuef;
-                                else
-                                    tmp.int_value = value;
+                            if ((val->type & VALUE_TYPE_MASK) == VAR_FLOAT)
+                                tmp.float_value = valuef;
+                            else
+                                tmp.int_value = value;
 
-                                changeValue = true;
-                            }
+                            changeValue = true;
                         }
-                        break;
-                    case MODE_LOOKUP: {
-                            const lookupTableEntry_t *tableEntry = &lookupTables[valueTable[i].config.lookup.tableIndex];
-                            bool matched = false;
-                            for (uint32_t tableValueIndex = 0; tableValueIndex < tableEntry->valueCount && !matched; tableValueIndex++) {
-                                matched = strcasecmp(tableEntry->values[tableValueIndex], eqptr) == 0;
-
-                                if (matched) {
-                                    tmp.int_value = tableValueIndex;
-                                    changeValue = true;
-                                }
+                    }
+                    break;
+                case MODE_LOOKUP: {
+                        const lookupTableEntry_t *tableEntry = &lookupTables[val->config.lookup.tableIndex];
+                        bool matched = false;
+                        for (uint32_t tableValueIndex = 0; tableValueIndex < tableEntry->valueCount && !matched; tableValueIndex++) {
+                            matched = strcasecmp(tableEntry->values[tableValueIndex], eqptr) == 0;
+
+                            if (matched) {
+                                tmp.int_value = tableValueIndex;
+                                changeValue = true;
                             }
                         }
-                        break;
-                }
-
-                if (changeValue) {
-                    cliSetVar(val, tmp);
+                    }
+                    break;
+            }
 
-                    cliPrintf("%s set to ", valueTable[i].name);
-                    cliPrintVar(val, 0);
-                } else {
-                    cliPrint("Invalid value\r\n");
-                    cliPrintVarRange(val);
-                }
+            if (changeValue) {
+                cliSetVar(val, tmp);
 
-                return;
+                cliPrintf("%s set to ", val->name);
+                cliPrintVar(val, 0);
+            } else {
+                cliPrint("Invalid value\r\n");
+                cliPrintVarRange(val);
             }
+
+        } else {
+            cliPrint("Invalid name\r\n");
         }
-        cliPrint("Invalid name\r\n");
     } else {
         // no equals, check for matching variables.
         cliGet(cmdline);
@@ -3251,8 +3333,38 @@ static void cliStatus(char *cmdline)
 #endif
     cliPrintf("Stack size: %d, Stack address: 0x%x\r\n", stackTotalSize(), stackHighMem());
 
+    ramUsage_t ramUsage;
+    getRamUsage(&ramUsage);
+    cliPrintf("RAM data: %d, bss: %d, fast: %d, free: %d\r\n", ramUsage.dataSize, ramUsage.bssSize, ramUsage.fastRamSize, ramUsage.freeSize);
+
     cliPrintf("I2C Errors: %d, config size: %d\r\n", i2cErrorCounter, sizeof(master_t));
 
+#ifdef USE_I2C
+    for (I2CDevice device = I2CDEV_1; device < I2CDEV_COUNT; device++) {
+        const i2cBusStats_t *stats = i2cGetBusStats(device);
+        if (!stats->transactionCount) {
+            continue;
+        }
+        const uint32_t nowUs = micros();
+        const int busyLoad = nowUs == 0 ? 0 : (int)(((uint64_t)stats->busyTimeUs * 1000) / nowUs);
+        cliPrintf("I2C%d: transactions: %u, busy: %d.%1d%%, errors: %d, timeouts: %d\r\n", device + 1,
+                stats->transactionCount, busyLoad/10, busyLoad%10, stats->errorCount, stats->timeoutCount);
+    }
+#endif
+
+#if defined(USE_SOFTSERIAL1) || defined(USE_SOFTSERIAL2)
+    for (softSerialPortIndex_e portIndex = SOFTSERIAL1; portIndex < MAX_SOFTSERIAL_PORTS; portIndex++) {
+        softSerialStats_t stats;
+        if (!softSerialGetStats(portIndex, &stats)) {
+            continue;
+        }
+        const uint32_t openMs = millis() - stats.openedAtMs;
+        const int interruptRate = openMs == 0 ? 0 : (int)(((uint64_t)stats.interrupts * 1000) / openMs);
+        cliPrintf("SOFTSERIAL%d: %s, %u baud, interrupts: %d/s, rx: %u, tx: %u, rx errors: %d, tx errors: %d\r\n", portIndex + 1,
+                stats.dma ? "DMA" : "per bit", stats.baudRate, interruptRate, stats.rxBytes, stats.txBytes, stats.rxErrors, stats.txErrors);
+    }
+#endif
+
     const int gyroRate = getTaskDeltaTime(TASK_GYROPID) == 0 ? 0 : (int)(1000000.0f / ((float)getTaskDeltaTime(TASK_GYROPID)));
     const int rxRate = getTaskDeltaTime(TASK_RX) == 0 ? 0 : (int)(1000000.0f / ((float)getTaskDeltaTime(TASK_RX)));
     const int systemRate = getTaskDeltaTime(TASK_SYSTEM) == 0 ? 0 : (int)(1000000.0f / ((float)getTaskDeltaTime(TASK_SYSTEM)));
@@ -3270,7 +3382,11 @@ static void cliTasks(char *cmdline)
 
 #ifndef MINIMAL_CLI
     if (masterConfig.task_statistics) {
+#ifdef STACK_CHECK_TASKS
+        cliPrintf("Task list           rate/hz  max/us  avg/us maxload avgload     total/ms  stack\r\n");
+#else
         cliPrintf("Task list           rate/hz  max/us  avg/us maxload avgload     total/ms\r\n");
+#endif
     } else {
         cliPrintf("Task list\r\n");
     }
@@ -3301,9 +3417,14 @@ static void cliTasks(char *cmdline)
                 averageLoadSum += averageLoad;
             }
             if (masterConfig.task_statistics) {
-                cliPrintf("%6d %7d %7d %4d.%1d%% %4d.%1d%% %9d\r\n",
+                cliPrintf("%6d %7d %7d %4d.%1d%% %4d.%1d%% %9d",
                         taskFrequency, taskInfo.maxExecutionTime, taskInfo.averageExecutionTime,
                         maxLoad/10, maxLoad%10, averageLoad/10, averageLoad%10, taskInfo.totalExecutionTime / 1000);
+#ifdef STACK_CHECK_TASKS
+                // peak stack while the task ran, 0 until it has been sampled
+                cliPrintf(" %6d", taskInfo.maxStackUsed);
+#endif
+                cliPrint("\r\n");
             } else {
                 cliPrintf("%6d\r\n", taskFrequency);
             }
@@ -3317,6 +3438,52 @@ static void cliTasks(char *cmdline)
         getCheckFuncInfo(&checkFuncInfo);
         cliPrintf("RX Check Function %17d %7d %25d\r\n", checkFuncInfo.maxExecutionTime, checkFuncInfo.averageExecutionTime, checkFuncInfo.totalExecutionTime / 1000);
         cliPrintf("Total (excluding SERIAL) %23d.%1d%% %4d.%1d%%\r\n", maxLoadSum/10, maxLoadSum%10, averageLoadSum/10, averageLoadSum%10);
+#ifdef USE_SPI
+        bool spiHeaderPrinted = false;
+        for (SPIDevice device = SPIDEV_1; device <= SPIDEV_4; device++) {
+            const spiBusStats_t *stats = spiBusGetStats(device);
+            if (!stats->transactionCount) {
+                continue;
+            }
+            if (!spiHeaderPrinted) {
+                cliPrintf("SPI bus   transactions    busy  wait/ms maxwait/us rejected timeouts\r\n");
+                spiHeaderPrinted = true;
+            }
+            const uint32_t elapsedUs = micros() - stats->sinceUs;
+            const int busyLoad = elapsedUs == 0 ? 0 : (int)(((uint64_t)stats->busyTimeUs * 1000) / elapsedUs);
+            cliPrintf("SPI%d %17u %4d.%1d%% %8u %10u %8u %8u\r\n", device + 1, stats->transactionCount,
+                    busyLoad/10, busyLoad%10, stats->waitTimeUs / 1000, stats->maxWaitUs, stats->rejectCount, stats->timeoutCount);
+        }
+#endif
+    }
+}
+#endif
+
+#ifdef USE_TAIL_IDENTIFICATION
+#define TAIL_ID_APPLY_CONFIDENCE    80
+
+static void cliTailId(char *cmdline)
+{
+    tailIdEstimate_t estimate;
+    if (!triGetTailIdEstimate(&estimate)) {
+        cliPrint("Tricopter mixer not in use\r\n");
+        return;
+    }
+
+    const int servoLag = lrintf(estimate.servoLagMs * 10);
+    const int motorSpool = lrintf(estimate.motorSpoolMs * 10);
+    cliPrintf("Servo rate: %d deg/s (%d%%), configured %d\r\n", lrintf(estimate.servoRateDps), estimate.servoRateConfidence, triMixerConfig()->tri_tail_servo_speed);
+    cliPrintf("Servo lag: %d.%1d ms (%d%%)\r\n", servoLag / 10, servoLag % 10, estimate.servoLagConfidence);
+    cliPrintf("Motor spool: %d.%1d ms (%d%%)\r\n", motorSpool / 10, motorSpool % 10, estimate.motorSpoolConfidence);
+    cliPrintf("Yaw torque gain: %d deg/s^2 (%d%%)\r\n", lrintf(estimate.yawTorqueGain), estimate.yawTorqueConfidence);
+
+    if (strcasecmp(cmdline, "apply") == 0) {
+        if (estimate.servoRateConfidence < TAIL_ID_APPLY_CONFIDENCE) {
+            cliPrintf("Servo rate confidence below %d%%, fly some more\r\n", TAIL_ID_APPLY_CONFIDENCE);
+            return;
+        }
+        triMixerConfig()->tri_tail_servo_speed = constrain(lrintf(estimate.servoRateDps), 0, 1000);
+        cliPrintf("set tri_tail_servo_speed = %d\r\n", triMixerConfig()->tri_tail_servo_speed);
     }
 }
 #endif
@@ -3827,6 +3994,9 @@ const clicmd_t cmdTable[] = {
         "\treverse <servo> <source> r|n", cliServoMix),
 #endif
     CLI_COMMAND_DEF("status", "show status", NULL, cliStatus),
+#ifdef USE_TAIL_IDENTIFICATION
+    CLI_COMMAND_DEF("tailid", "show identified tail parameters", "[apply]", cliTailId),
+#endif
 #ifndef SKIP_TASK_STATISTICS
     CLI_COMMAND_DEF("tasks", "show task stats", NULL, cliTasks),
 #endif
@@ -3936,6 +4106,8 @@ void cliProcess(void)
                         break;
             }
                 }
+                // commands may write directly to the port (passthrough) or never return, so send the echo first
+                bufWriterFlush(cliWriter);
                 if(cmd < cmdTable + CMD_COUNT)
                     cmd->func(options);
                 else
@@ -3963,6 +4135,8 @@ void cliProcess(void)
             cliWrite(c);
         }
     }
+
+    bufWriterFlush(cliWriter);
 }
 
 void cliEnter(serialPort_t *serialPort)
@@ -3972,6 +4146,13 @@ void cliEnter(serialPort_t *serialPort)
     setPrintfSerialPort(cliPort);
     cliWriter = bufWriterInit(cliWriteBuffer, sizeof(cliWriteBuffer), (bufWrite_t)serialWriteBufShim, serialPort);
 
+#ifndef MINIMAL_CLI
+    if (!valueIndexBuilt) {
+        sortedIndexBuild(valueIndex, VALUE_COUNT, valueNameForTableIndex);
+        valueIndexBuilt = true;
+    }
+#endif
+
     schedulerSetCalulateTaskStatistics(masterConfig.task_statistics);
 
 #ifndef MINIMAL_CLI
@@ -3980,6 +4161,7 @@ void cliEnter(serialPort_t *serialPort)
     cliPrint("\r\nCLI\r\n");
 #endif
     cliPrompt();
+    bufWriterFlush(cliWriter);
 
     ENABLE_ARMING_FLAG(PREVENT_ARMING);
 }
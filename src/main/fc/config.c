@@ -58,6 +58,7 @@
 
 #include "sensors/sensors.h"
 #include "sensors/gyro.h"
+#include "sensors/gyro_fusion.h"
 #include "sensors/compass.h"
 #include "sensors/acceleration.h"
 #include "sensors/barometer.h"
@@ -126,6 +127,12 @@ static void resetAccelerometerTrims(flightDynamicsTrims_t *accelerometerTrims)
     accelerometerTrims->values.yaw = 0;
 }
 
+static void resetGyroBiasCache(gyroBiasCache_t *gyroBiasCache)
+{
+    memset(gyroBiasCache->bias, 0, sizeof(gyroBiasCache->bias));
+    gyroBiasCache->temperature = GYRO_BIAS_TEMPERATURE_NONE;
+}
+
 static void resetControlRateConfig(controlRateConfig_t *controlRateConfig)
 {
     controlRateConfig->rcRate8 = 100;
@@ -224,6 +231,8 @@ void resetBarometerConfig(barometerConfig_t *barometerConfig)
     barometerConfig->baro_noise_lpf = 0.6f;
     barometerConfig->baro_cf_vel = 0.985f;
     barometerConfig->baro_cf_alt = 0.965f;
+    barometerConfig->baro_estimator = ALT_ESTIMATOR_CF;
+    barometerConfig->baro_est_tau = 20;
 }
 #endif
 
@@ -252,6 +261,7 @@ void resetServoConfig(servoConfig_t *servoConfig)
 {
     servoConfig->servoCenterPulse = 1500;
     servoConfig->servoPwmRate = 300;
+    servoConfig->servoPulseMode = SERVO_PULSE_STANDARD;
 
     int servoIndex = 0;
     for (int i = 0; i < USABLE_TIMER_CHANNEL_COUNT && servoIndex < MAX_SUPPORTED_SERVOS; i++) {
@@ -433,6 +443,7 @@ void resetTelemetryConfig(telemetryConfig_t *telemetryConfig)
 #ifdef TELEMETRY_IBUS
     telemetryConfig->report_cell_voltage = false;
 #endif
+    telemetryConfig->mavlink_highrate_hz = 0;
 }
 #endif
 
@@ -828,6 +839,10 @@ void createDefaultConfig(master_t *config)
     config->gyroConfig.gyro_soft_notch_cutoff_1 = 300;
     config->gyroConfig.gyro_soft_notch_hz_2 = 200;
     config->gyroConfig.gyro_soft_notch_cutoff_2 = 100;
+    config->gyroConfig.gyro_fusion_mode = GYRO_FUSION_AVERAGE;
+    config->gyroConfig.gyro_2_weight = 50;
+    config->gyroConfig.gyro_2_align = ALIGN_DEFAULT;
+    resetGyroBiasCache(&config->gyroConfig.gyro_bias_cache);
 
     config->debug_mode = DEBUG_MODE;
     config->task_statistics = true;
@@ -959,6 +974,7 @@ void createDefaultConfig(master_t *config)
     config->imuConfig.accDeadband.xy = 40;
     config->imuConfig.accDeadband.z = 40;
     config->imuConfig.acc_unarmedcal = 1;
+    config->imuConfig.estimator = IMU_ESTIMATOR_MAHONY;
 
 #ifdef BARO
     resetBarometerConfig(&config->barometerConfig);
@@ -1104,6 +1120,7 @@ void activateConfig(void)
     useFailsafeConfig(&masterConfig.failsafeConfig);
     setAccelerationTrims(&accelerometerConfig()->accZero);
     setAccelerationFilter(accelerometerConfig()->acc_lpf_hz);
+    setGyroBiasCache(&gyroConfig()->gyro_bias_cache);
 
     mixerUseConfigs(
         &masterConfig.flight3DConfig,
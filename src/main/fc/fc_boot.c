@@ -0,0 +1,166 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <platform.h>
+
+#include "common/maths.h"
+#include "common/time.h"
+
+#include "drivers/system.h"
+
+#include "fc/fc_boot.h"
+
+static timeUs_t phaseTime[BOOT_PHASE_COUNT];
+static uint16_t phasesReached;
+
+static const bootItem_t *deferredItems;
+static uint8_t deferredCount;
+static uint8_t deferredCursor;
+static uint16_t deferredFinished;
+static bootItemState_e deferredState[BOOT_ITEM_COUNT_MAX];
+static timeUs_t deferredTime[BOOT_ITEM_COUNT_MAX];     // started while running, finished after
+
+void bootPhaseMark(bootPhase_e phase)
+{
+    if (phase == BOOT_PHASE_START) {
+        phasesReached = 0;
+    }
+    phaseTime[phase] = micros();
+    phasesReached |= 1 << phase;
+}
+
+bool bootPhaseReached(bootPhase_e phase)
+{
+    return phasesReached & (1 << phase);
+}
+
+timeUs_t bootPhaseTime(bootPhase_e phase)
+{
+    return phaseTime[phase];
+}
+
+void bootDeferredInit(const bootItem_t *items, uint8_t count)
+{
+    deferredItems = items;
+    deferredCount = MIN(count, BOOT_ITEM_COUNT_MAX);
+    deferredCursor = 0;
+    deferredFinished = 0;
+    for (int i = 0; i < BOOT_ITEM_COUNT_MAX; i++) {
+        deferredState[i] = BOOT_ITEM_WAITING;
+        deferredTime[i] = 0;
+    }
+}
+
+static bool itemRunnable(uint8_t index, bool armed)
+{
+    const bootItem_t *item = &deferredItems[index];
+
+    switch (deferredState[index]) {
+    case BOOT_ITEM_RUNNING:
+        return true;
+    case BOOT_ITEM_WAITING:
+        if (armed && item->heldWhileArmed) {
+            return false;
+        }
+        return (item->dependsOn & deferredFinished) == item->dependsOn;
+    default:
+        return false;
+    }
+}
+
+static void itemFinish(uint8_t index, bootItemState_e state, timeUs_t currentTimeUs)
+{
+    deferredState[index] = state;
+    deferredTime[index] = currentTimeUs;
+    deferredFinished |= BOOT_ITEM(index);
+}
+
+// Runs one item per call, taking turns between those started so one that polls its device does not
+// hold up the rest. Returns true once all of them have finished.
+bool bootDeferredUpdate(timeUs_t currentTimeUs, bool armed)
+{
+    const uint16_t allItems = BOOT_ITEM(deferredCount) - 1;
+
+    if (!bootPhaseReached(BOOT_PHASE_READY)) {
+        return false;
+    }
+    if (deferredFinished == allItems) {
+        return true;
+    }
+
+    for (int i = 0; i < deferredCount; i++) {
+        if (deferredState[i] == BOOT_ITEM_RUNNING && deferredItems[i].timeoutMs
+                && cmpTimeUs(currentTimeUs, deferredTime[i]) >= (timeDelta_t)deferredItems[i].timeoutMs * 1000) {
+            itemFinish(i, BOOT_ITEM_TIMED_OUT, currentTimeUs);
+        }
+    }
+
+    for (int n = 0; n < deferredCount; n++) {
+        const uint8_t index = (deferredCursor + n) % deferredCount;
+        if (!itemRunnable(index, armed)) {
+            continue;
+        }
+
+        if (deferredState[index] == BOOT_ITEM_WAITING) {
+            deferredState[index] = BOOT_ITEM_RUNNING;
+            deferredTime[index] = currentTimeUs;
+        }
+
+        switch (deferredItems[index].init(currentTimeUs)) {
+        case BOOT_INIT_DONE:
+            itemFinish(index, BOOT_ITEM_DONE, currentTimeUs);
+            break;
+        case BOOT_INIT_FAILED:
+            itemFinish(index, BOOT_ITEM_FAILED, currentTimeUs);
+            break;
+        case BOOT_INIT_PENDING:
+            break;
+        }
+        deferredCursor = index + 1;
+        break;
+    }
+
+    if (deferredFinished == allItems) {
+        phaseTime[BOOT_PHASE_DEFERRED_DONE] = currentTimeUs;
+        phasesReached |= 1 << BOOT_PHASE_DEFERRED_DONE;
+        return true;
+    }
+    return false;
+}
+
+uint8_t bootDeferredCount(void)
+{
+    return deferredCount;
+}
+
+const bootItem_t *bootDeferredItem(uint8_t index)
+{
+    return &deferredItems[index];
+}
+
+bootItemState_e bootDeferredState(uint8_t index)
+{
+    return deferredState[index];
+}
+
+timeUs_t bootDeferredTime(uint8_t index)
+{
+    return deferredTime[index];
+}
@@ -0,0 +1,73 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/time.h"
+
+// init() only brings up what is needed to fly: config, outputs, gyro and RX, and the VTX, which
+// has to be on its channel before arming. Everything else is a deferred item, started from
+// TASK_DEFERRED_INIT once the scheduler runs.
+
+typedef enum {
+    BOOT_PHASE_START = 0,       // init() entered
+    BOOT_PHASE_CONFIG,          // config loaded
+    BOOT_PHASE_OUTPUTS,         // motor and servo outputs
+    BOOT_PHASE_GYRO,            // gyro and acc detected
+    BOOT_PHASE_RX,              // RX and failsafe
+    BOOT_PHASE_READY,           // scheduler starts, deferred items may run from here on
+    BOOT_PHASE_DEFERRED_DONE,   // last deferred item finished
+    BOOT_PHASE_COUNT
+} bootPhase_e;
+
+typedef enum {
+    BOOT_INIT_DONE = 0,
+    BOOT_INIT_PENDING,          // call again on a later run of the task
+    BOOT_INIT_FAILED
+} bootInitResult_e;
+
+typedef enum {
+    BOOT_ITEM_WAITING = 0,
+    BOOT_ITEM_RUNNING,
+    BOOT_ITEM_DONE,
+    BOOT_ITEM_FAILED,
+    BOOT_ITEM_TIMED_OUT
+} bootItemState_e;
+
+#define BOOT_ITEM_COUNT_MAX 16
+#define BOOT_ITEM(index) (1 << (index))
+
+typedef bootInitResult_e bootInitFn(timeUs_t currentTimeUs);
+
+typedef struct bootItem_s {
+    const char *name;
+    bootInitFn *init;
+    uint16_t dependsOn;         // BOOT_ITEM() mask of the items that have to finish first, whatever their result
+    uint16_t timeoutMs;         // from the first call, 0 for none. Only checked between calls, so it bounds an item that polls (BOOT_INIT_PENDING), not one that blocks
+    bool heldWhileArmed;        // stalls the loop for too long to start in flight, e.g. after a brown-out
+} bootItem_t;
+
+void bootPhaseMark(bootPhase_e phase);
+bool bootPhaseReached(bootPhase_e phase);
+timeUs_t bootPhaseTime(bootPhase_e phase);
+
+void bootDeferredInit(const bootItem_t *items, uint8_t count);
+bool bootDeferredUpdate(timeUs_t currentTimeUs, bool armed);
+uint8_t bootDeferredCount(void);
+const bootItem_t *bootDeferredItem(uint8_t index);
+bootItemState_e bootDeferredState(uint8_t index);
+timeUs_t bootDeferredTime(uint8_t index);
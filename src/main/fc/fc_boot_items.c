@@ -0,0 +1,204 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#include "blackbox/blackbox.h"
+
+#include "common/axis.h"
+#include "common/utils.h"
+
+#include "drivers/display.h"
+#include "drivers/flash_m25p16.h"
+#include "drivers/light_led.h"
+#include "drivers/sdcard.h"
+#include "drivers/sound_beeper.h"
+#include "drivers/system.h"
+
+#include "fc/config.h"
+#include "fc/fc_boot_items.h"
+
+#include "io/asyncfatfs/asyncfatfs.h"
+#include "io/beeper.h"
+#include "io/displayport_max7456.h"
+#include "io/displayport_msp.h"
+#include "io/flashfs.h"
+#include "io/osd.h"
+
+#include "scheduler/scheduler.h"
+
+#include "sensors/sensors.h"
+#include "sensors/acceleration.h"
+#include "sensors/barometer.h"
+#include "sensors/compass.h"
+#include "sensors/gyro.h"
+#include "sensors/sonar.h"
+#include "sensors/initialisation.h"
+
+#include "config/config_master.h"
+#include "config/feature.h"
+
+#define STARTUP_FLASH_STEP_US   25000
+#define STARTUP_FLASH_STEPS     20
+
+// The LEDs and beeper flash ten times to show the board is up, one step per call instead of blocking
+static bootInitResult_e deferredStartupFlash(timeUs_t currentTimeUs)
+{
+    static uint8_t step;
+    static timeUs_t nextStepUs;
+
+    if (step > 0 && cmpTimeUs(currentTimeUs, nextStepUs) < 0) {
+        return BOOT_INIT_PENDING;
+    }
+    if (step == STARTUP_FLASH_STEPS) {
+        LED0_OFF;
+        LED1_OFF;
+        return BOOT_INIT_DONE;
+    }
+
+    if (step % 2 == 0) {
+        LED1_TOGGLE;
+        LED0_TOGGLE;
+        if (!(getBeeperOffMask() & (1 << (BEEPER_SYSTEM_INIT - 1)))) BEEP_ON;
+    } else {
+        BEEP_OFF;
+    }
+    step++;
+    nextStepUs = currentTimeUs + STARTUP_FLASH_STEP_US;
+    return BOOT_INIT_PENDING;
+}
+
+static bootInitResult_e deferredCompass(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+#ifdef MAG
+    if (compassConfig()->mag_hardware != MAG_NONE) {
+        if (!sensorsAutodetectCompass(compassConfig())) {
+            return BOOT_INIT_FAILED;
+        }
+        setTaskEnabled(TASK_COMPASS, true);
+    }
+#endif
+    return BOOT_INIT_DONE;
+}
+
+static bootInitResult_e deferredBaro(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+#ifdef BARO
+    if (barometerConfig()->baro_hardware != BARO_NONE) {
+        if (!sensorsAutodetectBaro(barometerConfig())) {
+            return BOOT_INIT_FAILED;
+        }
+        baroSetCalibrationCycles(CALIBRATING_BARO_CYCLES);
+        setTaskEnabled(TASK_BARO, true);
+        setTaskEnabled(TASK_ALTITUDE, true);
+    }
+#endif
+    return BOOT_INIT_DONE;
+}
+
+static bootInitResult_e deferredFlash(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+#ifdef USE_FLASHFS
+    if (blackboxConfig()->device == BLACKBOX_SPIFLASH) {
+#if defined(USE_FLASH_M25P16)
+        if (!m25p16_init(flashConfig())) {
+            return BOOT_INIT_FAILED;
+        }
+#endif
+        flashfsInit();
+    }
+#endif
+    return BOOT_INIT_DONE;
+}
+
+// The card keeps initialising from afatfs_poll() in the main loop, done once the filesystem is up
+static bootInitResult_e deferredSdcard(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+#ifdef USE_SDCARD
+    static bool started;
+
+    if (!feature(FEATURE_SDCARD) || blackboxConfig()->device != BLACKBOX_SDCARD) {
+        return BOOT_INIT_DONE;
+    }
+    if (!started) {
+        if (millis() < SDCARD_POWER_UP_DELAY_MS) {
+            return BOOT_INIT_PENDING;
+        }
+        sdcardInsertionDetectInit();
+        sdcard_init(sdcardConfig()->useDma);
+        afatfs_init();
+        started = true;
+    }
+    switch (afatfs_getFilesystemState()) {
+    case AFATFS_FILESYSTEM_STATE_READY:
+        return BOOT_INIT_DONE;
+    case AFATFS_FILESYSTEM_STATE_FATAL:
+        return BOOT_INIT_FAILED;
+    default:
+        return BOOT_INIT_PENDING;
+    }
+#else
+    return BOOT_INIT_DONE;
+#endif
+}
+
+static bootInitResult_e deferredBlackbox(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+#ifdef BLACKBOX
+    initBlackbox();
+#endif
+    return BOOT_INIT_DONE;
+}
+
+static bootInitResult_e deferredOsd(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+#ifdef OSD
+    if (feature(FEATURE_OSD)) {
+#ifdef USE_MAX7456
+        // if there is a max7456 chip for the OSD then use it, otherwise use MSP
+        displayPort_t *osdDisplayPort = max7456DisplayPortInit(vcdProfile(), displayPortProfileMax7456());
+#else
+        displayPort_t *osdDisplayPort = displayPortMspInit(displayPortProfileMax7456());
+#endif
+        osdInit(osdDisplayPort);
+        setTaskEnabled(TASK_OSD, true);
+    }
+#endif
+    return BOOT_INIT_DONE;
+}
+
+// Everything that talks to a device on the buses is held while armed, it would stall the PID loop.
+// Only the startup flash and the SD card are polled, the others finish (or block) within their one call.
+const bootItem_t deferredItems[DEFERRED_COUNT] = {
+    [DEFERRED_STARTUP_FLASH] = { "STARTUP",  deferredStartupFlash, 0, 1000, false },
+    [DEFERRED_COMPASS]       = { "COMPASS",  deferredCompass,      0, 0,    true },
+    [DEFERRED_BARO]          = { "BARO",     deferredBaro,         0, 0,    true },
+    [DEFERRED_FLASH]         = { "FLASH",    deferredFlash,        0, 0,    true },
+    [DEFERRED_SDCARD]        = { "SDCARD",   deferredSdcard,       0, 5000, false },
+    [DEFERRED_BLACKBOX]      = { "BLACKBOX", deferredBlackbox,     BOOT_ITEM(DEFERRED_FLASH) | BOOT_ITEM(DEFERRED_SDCARD), 0, false },
+    [DEFERRED_OSD]           = { "OSD",      deferredOsd,          0, 0,    true },
+};
+
@@ -0,0 +1,35 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "fc/fc_boot.h"
+
+// Deferred items, in the order they first get a turn
+typedef enum {
+    DEFERRED_STARTUP_FLASH = 0,
+    DEFERRED_COMPASS,
+    DEFERRED_BARO,
+    DEFERRED_FLASH,
+    DEFERRED_SDCARD,
+    DEFERRED_BLACKBOX,
+    DEFERRED_OSD,
+    DEFERRED_COUNT
+} deferredItem_e;
+
+
+extern const bootItem_t deferredItems[DEFERRED_COUNT];
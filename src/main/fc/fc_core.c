@@ -32,6 +32,7 @@
 #include "drivers/light_led.h"
 #include "drivers/system.h"
 #include "drivers/gyro_sync.h"
+#include "drivers/pwm_output.h"
 
 #include "sensors/sensors.h"
 #include "sensors/boardalignment.h"
@@ -64,6 +65,7 @@
 #include "flight/pid.h"
 #include "flight/failsafe.h"
 #include "flight/altitudehold.h"
+#include "flight/imu.h"
 
 #include "config/config_profile.h"
 #include "config/config_master.h"
@@ -458,19 +460,41 @@ void processRx(timeUs_t currentTimeUs)
 #endif
 }
 
+// DEBUG_PIDLOOP times the sections of the PID loop in microseconds, DEBUG_PIDLOOP_CYCLES in core clock cycles
+static uint32_t pidLoopSectionStart(void)
+{
+    if (debugMode == DEBUG_PIDLOOP) {
+        return micros();
+    } else if (debugMode == DEBUG_PIDLOOP_CYCLES) {
+        return getCycleCounter();
+    }
+    return 0;
+}
+
+static void pidLoopSectionEnd(uint8_t index, uint32_t startTime)
+{
+    if (debugMode == DEBUG_PIDLOOP) {
+        debug[index] = micros() - startTime;
+    } else if (debugMode == DEBUG_PIDLOOP_CYCLES) {
+        debug[index] = MIN(getCycleCounter() - startTime, INT16_MAX);
+    }
+}
+
 static void subTaskPidController(void)
 {
-    uint32_t startTime;
-    if (debugMode == DEBUG_PIDLOOP) {startTime = micros();}
+    const uint32_t startTime = pidLoopSectionStart();
     // PID - note this is function pointer set by setPIDController()
+#ifdef USE_FIXED_POINT_PID
+    pidControllerFixed(&currentProfile->pidProfile, &accelerometerConfig()->accelerometerTrims);
+#else
     pidController(&currentProfile->pidProfile, &accelerometerConfig()->accelerometerTrims);
-    DEBUG_SET(DEBUG_PIDLOOP, 1, micros() - startTime);
+#endif
+    pidLoopSectionEnd(1, startTime);
 }
 
 static void subTaskMainSubprocesses(timeUs_t currentTimeUs)
 {
-    uint32_t startTime;
-    if (debugMode == DEBUG_PIDLOOP) {startTime = micros();}
+    const uint32_t startTime = pidLoopSectionStart();
 
     // Read out gyro temperature if used for telemmetry
     if (feature(FEATURE_TELEMETRY) && gyro.dev.temperature) {
@@ -536,7 +560,7 @@ static void subTaskMainSubprocesses(timeUs_t currentTimeUs)
 #ifdef TRANSPONDER
     transponderUpdate(currentTimeUs);
 #endif
-    DEBUG_SET(DEBUG_PIDLOOP, 2, micros() - startTime);
+    pidLoopSectionEnd(2, startTime);
 }
 
 static void subTaskMotorUpdate(void)
@@ -549,8 +573,8 @@ static void subTaskMotorUpdate(void)
         debug[2] = currentDeltaTime;
         debug[3] = currentDeltaTime - targetPidLooptime;
         previousMotorUpdateTime = startTime;
-    } else if (debugMode == DEBUG_PIDLOOP) {
-        startTime = micros();
+    } else {
+        startTime = pidLoopSectionStart();
     }
 
     mixTable(&currentProfile->pidProfile);
@@ -561,13 +585,15 @@ static void subTaskMotorUpdate(void)
         servoTable();
         filterServos();
         writeServos();
+        // Synced servo pulses start now, with the output that was just mixed
+        pwmCompleteServoUpdate();
     }
 #endif
 
     if (motorControlEnable) {
         writeMotors();
     }
-    DEBUG_SET(DEBUG_PIDLOOP, 3, micros() - startTime);
+    pidLoopSectionEnd(3, startTime);
 }
 
 uint8_t setPidUpdateCountDown(void)
@@ -595,20 +621,23 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
         runTaskMainSubprocesses = false;
     }
 
-    // DEBUG_PIDLOOP, timings for:
+    // DEBUG_PIDLOOP and DEBUG_PIDLOOP_CYCLES, timings for:
     // 0 - gyroUpdate()
     // 1 - pidController()
     // 2 - subTaskMainSubprocesses()
     // 3 - subTaskMotorUpdate()
-    uint32_t startTime;
-    if (debugMode == DEBUG_PIDLOOP) {startTime = micros();}
+    const uint32_t startTime = pidLoopSectionStart();
     gyroUpdate();
-    DEBUG_SET(DEBUG_PIDLOOP, 0, micros() - startTime);
+    imuIntegrateGyro();
+    pidLoopSectionEnd(0, startTime);
 
     if (pidUpdateCountdown) {
         pidUpdateCountdown--;
     } else {
         pidUpdateCountdown = setPidUpdateCountDown();
+        if (feature(FEATURE_FAILSAFE)) {
+            failsafeCheckRxDeadline(currentTimeUs);
+        }
         subTaskPidController();
         subTaskMotorUpdate();
         runTaskMainSubprocesses = true;
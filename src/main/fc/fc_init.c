@@ -54,6 +54,7 @@
 #include "drivers/flash_m25p16.h"
 #include "drivers/sonar_hcsr04.h"
 #include "drivers/sdcard.h"
+#include "drivers/stack_check.h"
 #include "drivers/usb_io.h"
 #include "drivers/transponder_ir.h"
 #include "drivers/exti.h"
@@ -64,6 +65,8 @@
 #endif
 
 #include "fc/config.h"
+#include "fc/fc_boot.h"
+#include "fc/fc_boot_items.h"
 #include "fc/fc_init.h"
 #include "fc/fc_msp.h"
 #include "fc/fc_tasks.h"
@@ -159,6 +162,9 @@ void processLoopback(void)
 
 void init(void)
 {
+    fastMemoryInit();
+    stackInit();
+
 #ifdef USE_HAL_DRIVER
     HAL_Init();
 #endif
@@ -167,6 +173,9 @@ void init(void)
 
     systemInit();
 
+    // micros() only counts once systemInit() has set up the SysTick
+    bootPhaseMark(BOOT_PHASE_START);
+
     // initialize IO (needed for all IO operations)
     IOInitGlobal();
 
@@ -184,6 +193,7 @@ void init(void)
     readEEPROM();
 
     systemState |= SYSTEM_STATE_CONFIG_LOADED;
+    bootPhaseMark(BOOT_PHASE_CONFIG);
 
     //i2cSetOverclock(masterConfig.i2c_overclock);
 
@@ -307,6 +317,7 @@ void init(void)
 #endif
 
     systemState |= SYSTEM_STATE_MOTORS_READY;
+    bootPhaseMark(BOOT_PHASE_OUTPUTS);
 
 #ifdef BEEPER
     beeperInit(beeperConfig());
@@ -407,45 +418,23 @@ void init(void)
     }
 #endif
 
-#ifdef OSD
-    if (feature(FEATURE_OSD)) {
-#ifdef USE_MAX7456
-        // if there is a max7456 chip for the OSD then use it, otherwise use MSP
-        displayPort_t *osdDisplayPort = max7456DisplayPortInit(vcdProfile(), displayPortProfileMax7456());
-#else
-        displayPort_t *osdDisplayPort = displayPortMspInit(displayPortProfileMax7456());
-#endif
-        osdInit(osdDisplayPort);
-    }
-#endif
-
 #ifdef SONAR
     const sonarConfig_t *sonarConfig = sonarConfig();
 #else
     const void *sonarConfig = NULL;
 #endif
-    if (!sensorsAutodetect(gyroConfig(), accelerometerConfig(), compassConfig(), barometerConfig(), sonarConfig)) {
+    if (!sensorsAutodetect(gyroConfig(), accelerometerConfig(), sonarConfig)) {
         // if gyro was not detected due to whatever reason, we give up now.
         failureMode(FAILURE_MISSING_ACC);
     }
 
     systemState |= SYSTEM_STATE_SENSORS_READY;
+    bootPhaseMark(BOOT_PHASE_GYRO);
 
     LED1_ON;
     LED0_OFF;
     LED2_OFF;
 
-    for (int i = 0; i < 10; i++) {
-        LED1_TOGGLE;
-        LED0_TOGGLE;
-        delay(25);
-        if (!(getBeeperOffMask() & (1 << (BEEPER_SYSTEM_INIT - 1)))) BEEP_ON;
-        delay(25);
-        BEEP_OFF;
-    }
-    LED0_OFF;
-    LED1_OFF;
-
     // gyro.targetLooptime set in sensorsAutodetect(), so we are ready to call pidSetTargetLooptime()
     pidSetTargetLooptime(gyro.targetLooptime * pidConfig()->pid_process_denom); // Initialize pid looptime
     pidInitFilters(&currentProfile->pidProfile);
@@ -472,6 +461,7 @@ void init(void)
     failsafeInit(rxConfig(), flight3DConfig()->deadband3d_throttle);
 
     rxInit(rxConfig(), modeActivationProfile()->modeActivationConditions);
+    bootPhaseMark(BOOT_PHASE_RX);
 
 #ifdef GPS
     if (feature(FEATURE_GPS)) {
@@ -518,34 +508,10 @@ void init(void)
     }
 #endif
 
-#ifdef USE_FLASHFS
-    if (blackboxConfig()->device == BLACKBOX_SPIFLASH) {
-#if defined(USE_FLASH_M25P16)
-        m25p16_init(flashConfig());
-#endif
-        flashfsInit();
-    }
-#endif
-
-#ifdef USE_SDCARD
-    if (feature(FEATURE_SDCARD) && blackboxConfig()->device == BLACKBOX_SDCARD) {
-        sdcardInsertionDetectInit();
-        sdcard_init(sdcardConfig()->useDma);
-        afatfs_init();
-    }
-#endif
-
-#ifdef BLACKBOX
-    initBlackbox();
-#endif
-
     if (mixerConfig()->mixerMode == MIXER_GIMBAL) {
         accSetCalibrationCycles(CALIBRATING_ACC_CYCLES);
     }
     gyroSetCalibrationCycles();
-#ifdef BARO
-    baroSetCalibrationCycles(CALIBRATING_BARO_CYCLES);
-#endif
 
 #ifdef VTX_CONTROL
 
@@ -599,6 +565,8 @@ void init(void)
     latchActiveFeatures();
     motorControlEnable = true;
 
+    bootDeferredInit(deferredItems, DEFERRED_COUNT);
     fcTasksInit();
     systemState |= SYSTEM_STATE_READY;
+    bootPhaseMark(BOOT_PHASE_READY);
 }
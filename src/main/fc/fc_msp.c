@@ -34,6 +34,7 @@
 #include "common/maths.h"
 #include "common/streambuf.h"
 
+#include "drivers/stack_check.h"
 #include "drivers/system.h"
 #include "drivers/accgyro.h"
 #include "drivers/compass.h"
@@ -50,6 +51,7 @@
 #include "drivers/vtx_common.h"
 
 #include "fc/config.h"
+#include "fc/fc_boot.h"
 #include "fc/fc_core.h"
 #include "fc/fc_msp.h"
 #include "fc/fc_rc.h"
@@ -67,6 +69,7 @@
 #include "io/transponder_ir.h"
 #include "io/asyncfatfs/asyncfatfs.h"
 #include "io/serial_4way.h"
+#include "io/vtx_transaction.h"
 
 #include "msp/msp.h"
 #include "msp/msp_protocol.h"
@@ -87,6 +90,7 @@
 #include "sensors/gyro.h"
 
 #include "telemetry/telemetry.h"
+#include "telemetry/telemetry_scheduler.h"
 
 #include "flight/mixer.h"
 #include "flight/servos.h"
@@ -922,6 +926,27 @@ static bool mspFcProcessOutCommand(uint8_t cmdMSP, sbuf_t *dst, mspPostProcessFn
         sbufWriteU32(dst, U_ID_2);
         break;
 
+#ifdef TELEMETRY
+    case MSP_TELEMETRY_STATS:
+        for (int i = 0; i < TELEMETRY_SCHEDULER_COUNT; i++) {
+            const telemetryScheduler_t *scheduler = telemetrySchedulerGet(i);
+            if (!scheduler) {
+                continue;
+            }
+            sbufWriteU16(dst, scheduler->function);
+            sbufWriteU32(dst, scheduler->bytesPerSecond);
+            sbufWriteU16(dst, scheduler->rateScale);
+            sbufWriteU8(dst, scheduler->frameCount);
+            for (int j = 0; j < scheduler->frameCount; j++) {
+                sbufWriteU8(dst, scheduler->frames[j].id);
+                sbufWriteU8(dst, scheduler->frames[j].size);
+                sbufWriteU16(dst, scheduler->frames[j].rateHz);
+                sbufWriteU16(dst, scheduler->state[j].achievedRate);
+            }
+        }
+        break;
+#endif
+
     case MSP_FEATURE:
         sbufWriteU32(dst, featureMask());
         break;
@@ -1230,6 +1255,88 @@ static bool mspFcProcessOutCommand(uint8_t cmdMSP, sbuf_t *dst, mspPostProcessFn
 #endif
         break;
 
+#if defined(VTX_CONTROL)
+    case MSP_VTX_STATS:
+        {
+            const vtxTransactionStats_t *stats = vtxTransactionGetStats();
+            if (stats) {
+                sbufWriteU16(dst, stats->completed);
+                sbufWriteU16(dst, stats->retries);
+                sbufWriteU16(dst, stats->failed);
+                sbufWriteU16(dst, stats->outOfOrder);
+                sbufWriteU32(dst, stats->lastLatencyUs);
+                sbufWriteU32(dst, stats->averageLatencyUs);
+                sbufWriteU32(dst, stats->maxLatencyUs);
+            }
+        }
+        break;
+#endif
+
+#ifdef USE_TAIL_IDENTIFICATION
+    case MSP_TAIL_ID:
+        {
+            tailIdEstimate_t estimate;
+            if (triGetTailIdEstimate(&estimate)) {
+                sbufWriteU16(dst, lrintf(estimate.servoRateDps));
+                sbufWriteU16(dst, lrintf(estimate.servoLagMs * 10));
+                sbufWriteU16(dst, lrintf(estimate.motorSpoolMs * 10));
+                sbufWriteU32(dst, lrintf(estimate.yawTorqueGain));
+                sbufWriteU8(dst, estimate.servoRateConfidence);
+                sbufWriteU8(dst, estimate.servoLagConfidence);
+                sbufWriteU8(dst, estimate.motorSpoolConfidence);
+                sbufWriteU8(dst, estimate.yawTorqueConfidence);
+            }
+        }
+        break;
+#endif
+
+    case MSP_RAM_USAGE:
+        {
+            ramUsage_t usage;
+            getRamUsage(&usage);
+            sbufWriteU32(dst, usage.dataSize);
+            sbufWriteU32(dst, usage.bssSize);
+            sbufWriteU32(dst, usage.fastRamSize);
+            sbufWriteU32(dst, usage.stackSize);
+            sbufWriteU32(dst, usage.stackUsed);
+            sbufWriteU32(dst, usage.freeSize);
+#ifdef STACK_CHECK_TASKS
+            // tasks sampled so far
+            for (cfTaskId_e taskId = 0; taskId < TASK_COUNT; taskId++) {
+                if (cfTasks[taskId].maxStackUsed) {
+                    sbufWriteU8(dst, taskId);
+                    sbufWriteU16(dst, cfTasks[taskId].maxStackUsed);
+                }
+            }
+#endif
+        }
+        break;
+
+    case MSP_BOOT_TIMES:
+        sbufWriteU8(dst, BOOT_PHASE_COUNT);
+        for (bootPhase_e phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+            // zero for a phase not reached yet
+            sbufWriteU32(dst, bootPhaseReached(phase) ? bootPhaseTime(phase) : 0);
+        }
+        sbufWriteU8(dst, bootDeferredCount());
+        for (int i = 0; i < bootDeferredCount(); i++) {
+            sbufWriteU8(dst, bootDeferredState(i));
+            sbufWriteU32(dst, bootDeferredTime(i));
+        }
+        break;
+
+    case MSP_FAILSAFE_LATENCY:
+        {
+            const failsafeLatency_t *latency = failsafeGetLatency();
+            sbufWriteU16(dst, latency->detections);
+            sbufWriteU32(dst, latency->deadlineUs);
+            sbufWriteU32(dst, latency->lastUs);
+            // zero until the first detection
+            sbufWriteU32(dst, latency->detections ? latency->minUs : 0);
+            sbufWriteU32(dst, latency->maxUs);
+        }
+        break;
+
     default:
         return false;
     }
@@ -47,6 +47,28 @@
 static float setpointRate[3], rcDeflection[3], rcDeflectionAbs[3];
 static float throttlePIDAttenuation;
 
+#ifdef USE_FIXED_POINT_PID
+// Converted once per RC update, so the fixed point PID loop has no float inputs
+static fix16_t setpointRateFix[3], rcDeflectionFix[3], rcDeflectionAbsFix[3];
+static fix16_t throttlePIDAttenuationFix = Q16;
+
+fix16_t getSetpointRateFix(int axis) {
+    return setpointRateFix[axis];
+}
+
+fix16_t getRcDeflectionFix(int axis) {
+    return rcDeflectionFix[axis];
+}
+
+fix16_t getRcDeflectionAbsFix(int axis) {
+    return rcDeflectionAbsFix[axis];
+}
+
+fix16_t getThrottlePIDAttenuationFix(void) {
+    return throttlePIDAttenuationFix;
+}
+#endif
+
 float getSetpointRate(int axis) {
     return setpointRate[axis];
 }
@@ -111,6 +133,10 @@ static void calculateSetpointRate(int axis)
     rcDeflection[axis] = rcCommandf;
     const float rcCommandfAbs = ABS(rcCommandf);
     rcDeflectionAbs[axis] = rcCommandfAbs;
+#ifdef USE_FIXED_POINT_PID
+    rcDeflectionFix[axis] = rcCommand[axis] * Q16 / 500;
+    rcDeflectionAbsFix[axis] = ABS(rcDeflectionFix[axis]);
+#endif
 
     if (rcExpo) {
         const float expof = rcExpo / 100.0f;
@@ -244,6 +270,11 @@ void processRcCommand(void)
         if (rxConfig()->fpvCamAngleDegrees && IS_RC_MODE_ACTIVE(BOXFPVANGLEMIX) && !FLIGHT_MODE(HEADFREE_MODE))
             scaleRcCommandToFpvCamAngle();
 
+#ifdef USE_FIXED_POINT_PID
+        for (int axis = 0; axis <= FD_YAW; axis++)
+            setpointRateFix[axis] = fix16FromFloat(setpointRate[axis]);
+#endif
+
         isRXDataNew = false;
     }
 }
@@ -263,6 +294,9 @@ void updateRcCommands(void)
         }
         throttlePIDAttenuation = prop / 100.0f;
     }
+#ifdef USE_FIXED_POINT_PID
+    throttlePIDAttenuationFix = prop * Q16 / 100;
+#endif
 
     for (int axis = 0; axis < 3; axis++) {
         // non coupled PID reduction scaler used in PID controller 1 and PID controller 2.
@@ -317,6 +351,9 @@ void updateRcCommands(void)
 void resetYawAxis(void) {
     rcCommand[YAW] = 0;
     setpointRate[YAW] = 0;
+#ifdef USE_FIXED_POINT_PID
+    setpointRateFix[YAW] = 0;
+#endif
 }
 
 bool isRcAxisWithinDeadband(int32_t axis, uint8_t minDeadband)
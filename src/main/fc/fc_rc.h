@@ -16,11 +16,19 @@
  */
 #pragma once
 
+#include "common/maths.h"
+
 void processRcCommand(void);
 float getSetpointRate(int axis);
 float getRcDeflection(int axis);
 float getRcDeflectionAbs(int axis);
 float getThrottlePIDAttenuation(void);
+#ifdef USE_FIXED_POINT_PID
+fix16_t getSetpointRateFix(int axis);
+fix16_t getRcDeflectionFix(int axis);
+fix16_t getRcDeflectionAbsFix(int axis);
+fix16_t getThrottlePIDAttenuationFix(void);
+#endif
 void updateRcCommands(void);
 void resetYawAxis(void);
 void generateThrottleCurve(void);
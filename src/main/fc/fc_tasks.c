@@ -25,6 +25,7 @@
 
 #include "common/axis.h"
 #include "common/color.h"
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "drivers/sensor.h"
@@ -35,6 +36,7 @@
 #include "drivers/vtx_common.h"
 
 #include "fc/config.h"
+#include "fc/fc_boot.h"
 #include "fc/fc_msp.h"
 #include "fc/fc_tasks.h"
 #include "fc/fc_core.h"
@@ -45,6 +47,7 @@
 
 #include "flight/pid.h"
 #include "flight/altitudehold.h"
+#include "flight/mixer_tricopter.h"
 
 #include "io/beeper.h"
 #include "io/dashboard.h"
@@ -108,6 +111,12 @@ static void taskHandleSerial(timeUs_t currentTimeUs)
     }
 #endif
     mspSerialProcess(ARMING_FLAG(ARMED) ? MSP_SKIP_NON_MSP_DATA : MSP_EVALUATE_NON_MSP_DATA, mspFcProcessCommand);
+
+    // a new gyro bias is kept until it is safe to write the flash
+    if (!ARMING_FLAG(ARMED) && gyroBiasCacheSavePending()) {
+        gyroBiasCacheSaved();
+        saveConfigAndNotify();
+    }
 }
 
 static void taskUpdateBattery(timeUs_t currentTimeUs)
@@ -207,15 +216,39 @@ static void taskTelemetry(timeUs_t currentTimeUs)
 #endif
 
 #ifdef VTX_CONTROL
+#define TASK_VTXCTRL_IDLE_HZ    5
+#define TASK_VTXCTRL_BUSY_HZ    200     // a byte takes 2ms at 4800 baud
+
 // Everything that listens to VTX devices
 void taskVtxControl(uint32_t currentTime)
 {
-    if (ARMING_FLAG(ARMED))
+    if (ARMING_FLAG(ARMED)) {
+        rescheduleTask(TASK_SELF, TASK_PERIOD_HZ(TASK_VTXCTRL_IDLE_HZ));
         return;
+    }
 
 #ifdef VTX_COMMON
     vtxCommonProcess(currentTime);
+
+    // follow responses as they arrive while commands are in flight
+    rescheduleTask(TASK_SELF, TASK_PERIOD_HZ(vtxCommonIsBusy() ? TASK_VTXCTRL_BUSY_HZ : TASK_VTXCTRL_IDLE_HZ));
+#endif
+}
 #endif
+
+static void taskDeferredInit(timeUs_t currentTimeUs)
+{
+    if (bootDeferredUpdate(currentTimeUs, ARMING_FLAG(ARMED))) {
+        setTaskEnabled(TASK_SELF, false);
+    }
+}
+
+#ifdef USE_TAIL_IDENTIFICATION
+static void taskTailIdentification(timeUs_t currentTimeUs)
+{
+    UNUSED(currentTimeUs);
+
+    triTailIdProcess();
 }
 #endif
 
@@ -235,6 +268,7 @@ void fcTasksInit(void)
     rescheduleTask(TASK_SERIAL, TASK_PERIOD_HZ(serialConfig()->serial_update_rate_hz));
     setTaskEnabled(TASK_BATTERY, feature(FEATURE_VBAT) || feature(FEATURE_CURRENT_METER));
     setTaskEnabled(TASK_RX, true);
+    setTaskEnabled(TASK_DEFERRED_INIT, true);
 
     setTaskEnabled(TASK_DISPATCH, dispatchIsEnabled());
 
@@ -245,20 +279,17 @@ void fcTasksInit(void)
     setTaskEnabled(TASK_GPS, feature(FEATURE_GPS));
 #endif
 #ifdef MAG
-    setTaskEnabled(TASK_COMPASS, sensors(SENSOR_MAG));
+    // compass, baro and OSD are enabled by their deferred init once they are up
 #if defined(USE_SPI) && defined(USE_MAG_AK8963)
     // fixme temporary solution for AK6983 via slave I2C on MPU9250
     rescheduleTask(TASK_COMPASS, TASK_PERIOD_HZ(40));
 #endif
 #endif
-#ifdef BARO
-    setTaskEnabled(TASK_BARO, sensors(SENSOR_BARO));
-#endif
 #ifdef SONAR
     setTaskEnabled(TASK_SONAR, sensors(SENSOR_SONAR));
 #endif
 #if defined(BARO) || defined(SONAR)
-    setTaskEnabled(TASK_ALTITUDE, sensors(SENSOR_BARO) || sensors(SENSOR_SONAR));
+    setTaskEnabled(TASK_ALTITUDE, sensors(SENSOR_SONAR));
 #endif
 #ifdef USE_DASHBOARD
     setTaskEnabled(TASK_DASHBOARD, feature(FEATURE_DASHBOARD));
@@ -273,6 +304,12 @@ void fcTasksInit(void)
             // Reschedule telemetry to 500hz, 2ms for CRSF
             rescheduleTask(TASK_TELEMETRY, TASK_PERIOD_HZ(500));
         }
+#ifdef TELEMETRY_MAVLINK
+        if (telemetryConfig()->mavlink_highrate_hz && findSerialPortConfig(FUNCTION_TELEMETRY_MAVLINK)) {
+            // Run telemetry at twice the MAVLink high rate stream so each message goes out within half a period of its slot
+            rescheduleTask(TASK_TELEMETRY, TASK_PERIOD_HZ(MAX(telemetryConfig()->mavlink_highrate_hz * 2, 500)));
+        }
+#endif
     }
 #endif
 #ifdef LED_STRIP
@@ -281,9 +318,6 @@ void fcTasksInit(void)
 #ifdef TRANSPONDER
     setTaskEnabled(TASK_TRANSPONDER, feature(FEATURE_TRANSPONDER));
 #endif
-#ifdef OSD
-    setTaskEnabled(TASK_OSD, feature(FEATURE_OSD));
-#endif
 #ifdef USE_BST
     setTaskEnabled(TASK_BST_MASTER_PROCESS, true);
 #endif
@@ -305,6 +339,9 @@ void fcTasksInit(void)
     setTaskEnabled(TASK_VTXCTRL, true);
 #endif
 #endif
+#ifdef USE_TAIL_IDENTIFICATION
+    setTaskEnabled(TASK_TAIL_ID, triMixerInUse());
+#endif
 }
 
 cfTask_t cfTasks[TASK_COUNT] = {
@@ -366,6 +403,13 @@ cfTask_t cfTasks[TASK_COUNT] = {
         .staticPriority = TASK_PRIORITY_MEDIUM,
     },
 
+    [TASK_DEFERRED_INIT] = {
+        .taskName = "DEFERRED_INIT",
+        .taskFunc = taskDeferredInit,
+        .desiredPeriod = TASK_PERIOD_HZ(100),       // 100 Hz, disabled once all deferred items are up
+        .staticPriority = TASK_PRIORITY_LOW,
+    },
+
 #ifdef BEEPER
     [TASK_BEEPER] = {
         .taskName = "BEEPER",
@@ -503,8 +547,17 @@ cfTask_t cfTasks[TASK_COUNT] = {
     [TASK_VTXCTRL] = {
         .taskName = "VTXCTRL",
         .taskFunc = taskVtxControl,
-        .desiredPeriod = TASK_PERIOD_HZ(5),          // 5Hz @200msec
+        .desiredPeriod = TASK_PERIOD_HZ(TASK_VTXCTRL_IDLE_HZ),   // faster while commands are in flight
         .staticPriority = TASK_PRIORITY_IDLE,
     },
 #endif
+
+#ifdef USE_TAIL_IDENTIFICATION
+    [TASK_TAIL_ID] = {
+        .taskName = "TAIL_ID",
+        .taskFunc = taskTailIdentification,
+        .desiredPeriod = TASK_PERIOD_HZ(100),       // 100 Hz, the mixer queues 32ms of samples
+        .staticPriority = TASK_PRIORITY_LOW,
+    },
+#endif
 };
@@ -27,7 +27,9 @@
 
 #include "common/maths.h"
 #include "common/axis.h"
+#include "common/utils.h"
 
+#include "sensors/sensors.h"
 #include "sensors/barometer.h"
 #include "sensors/sonar.h"
 
@@ -35,9 +37,13 @@
 
 #include "fc/rc_controls.h"
 #include "io/motors.h"
+#include "io/gps.h"
+#include "io/gps_ubx.h"
 
 #include "flight/pid.h"
 #include "flight/imu.h"
+#include "flight/altitudehold.h"
+#include "flight/vertical_estimator.h"
 
 #include "fc/runtime_config.h"
 
@@ -55,6 +61,13 @@ static pidProfile_t *pidProfile;
 static rcControlsConfig_t *rcControlsConfig;
 static motorConfig_t *motorConfig;
 
+// GPS only takes out the slow baro drift, far slower than the estimator itself
+#define ALT_ESTIMATOR_GPS_TIME_CONSTANT_SCALE 10.0f
+#define ALT_ESTIMATOR_GPS_MIN_SATS 6
+
+static verticalEstimatorGains_t baroEstimatorGains;
+static float gpsTimeConstant;
+
 void configureAltitudeHold(
         pidProfile_t *initialPidProfile,
         barometerConfig_t *intialBarometerConfig,
@@ -66,6 +79,10 @@ void configureAltitudeHold(
     barometerConfig = intialBarometerConfig;
     rcControlsConfig = initialRcControlsConfig;
     motorConfig = initialMotorConfig;
+
+    const float timeConstant = barometerConfig->baro_est_tau / 10.0f;
+    verticalEstimatorGainsInit(&baroEstimatorGains, timeConstant);
+    gpsTimeConstant = timeConstant * ALT_ESTIMATOR_GPS_TIME_CONSTANT_SCALE;
 }
 
 #if defined(BARO) || defined(SONAR)
@@ -73,6 +90,10 @@ void configureAltitudeHold(
 static int16_t initialThrottleHold;
 static int32_t EstAlt;                // in cm
 
+static verticalEstimator_t verticalEstimator;
+static bool verticalEstimatorActive;
+static bool haveGpsOffset;
+
 // 40hz update rate (20hz LPF on acc)
 #define BARO_UPDATE_FREQUENCY_40HZ (1000 * 25)
 
@@ -204,6 +225,49 @@ int32_t calculateAltHoldThrottleAdjustment(int32_t vel_tmp, float accZ_tmp, floa
     return result;
 }
 
+static bool useVerticalEstimator(void)
+{
+    return barometerConfig->baro_estimator == ALT_ESTIMATOR_3STATE;
+}
+
+void altitudeEstimatorPredict(float accZ, float dt)
+{
+    if (verticalEstimatorActive) {
+        verticalEstimatorPredict(&verticalEstimator, accZ, dt);
+    }
+}
+
+#ifdef GPS
+static void correctEstimatedAltitudeFromGps(timeUs_t currentTimeUs, bool useGps)
+{
+    static uint8_t lastGpsUpdate;
+    static timeUs_t lastCorrectionUs;
+    static float gpsOffset;
+
+    if (GPS_update == lastGpsUpdate) {
+        return;
+    }
+    lastGpsUpdate = GPS_update;
+
+    if (!useGps || !sensors(SENSOR_GPS) || !STATE(GPS_FIX) || GPS_numSat < ALT_ESTIMATOR_GPS_MIN_SATS) {
+        haveGpsOffset = false;
+        return;
+    }
+
+    const ubxNavPvt_t *navPvt = gpsGetNavPvt();
+    const float gpsAlt = navPvt ? navPvt->hMSL / 10.0f : GPS_altitude * 100.0f;   // cm
+
+    // GPS is referenced to the estimate when it first becomes usable, from then on it tracks the baro drift
+    if (!haveGpsOffset) {
+        gpsOffset = gpsAlt - verticalEstimator.position;
+        haveGpsOffset = true;
+    } else {
+        verticalEstimatorCorrectReference(&verticalEstimator, gpsAlt - gpsOffset, gpsTimeConstant, (currentTimeUs - lastCorrectionUs) * 1e-6f);
+    }
+    lastCorrectionUs = currentTimeUs;
+}
+#endif
+
 void calculateEstimatedAltitude(timeUs_t currentTimeUs)
 {
     static timeUs_t previousTimeUs;
@@ -217,6 +281,7 @@ void calculateEstimatedAltitude(timeUs_t currentTimeUs)
     static float vel = 0.0f;
     static float accAlt = 0.0f;
     static int32_t lastBaroAlt;
+    bool sonarInRange = false;
 
 #ifdef SONAR
     int32_t sonarAlt = SONAR_OUT_OF_RANGE;
@@ -245,6 +310,7 @@ void calculateEstimatedAltitude(timeUs_t currentTimeUs)
 #ifdef SONAR
     sonarAlt = sonarRead();
     sonarAlt = sonarCalculateAltitude(sonarAlt, getCosTiltAngle());
+    sonarInRange = sonarAlt > 0;
 
     if (sonarAlt > 0 && sonarAlt < sonarCfAltCm) {
         // just use the SONAR
@@ -268,48 +334,85 @@ void calculateEstimatedAltitude(timeUs_t currentTimeUs)
     } else {
         accZ_tmp = 0;
     }
-    vel_acc = accZ_tmp * accVelScale * (float)accTimeSum;
 
-    // Integrator - Altitude in cm
-    accAlt += (vel_acc * 0.5f) * dt + vel * dt;                                                                 // integrate velocity to get distance (x= a/2 * t^2)
-    accAlt = accAlt * barometerConfig->baro_cf_alt + (float)baro.BaroAlt * (1.0f - barometerConfig->baro_cf_alt);    // complementary filter for altitude estimation (baro & acc)
-    vel += vel_acc;
+    if (useVerticalEstimator()) {
+        // the accelerometer has already been integrated at its own rate, only the corrections are left
+        imuResetAccelerationSum();
+
+#ifdef BARO
+        if (!isBaroCalibrationComplete()) {
+            verticalEstimatorActive = false;
+            return;
+        }
+#endif
+
+        if (!verticalEstimatorActive) {
+            verticalEstimatorReset(&verticalEstimator, baro.BaroAlt);
+            verticalEstimatorActive = true;
+            haveGpsOffset = false;
+        }
+
+        verticalEstimatorCorrect(&verticalEstimator, &baroEstimatorGains, baro.BaroAlt, dTime * 1e-6f);
+#ifdef GPS
+        correctEstimatedAltitudeFromGps(currentTimeUs, !sonarInRange);
+#else
+        UNUSED(sonarInRange);
+#endif
+
+        EstAlt = lrintf(verticalEstimator.position);
+        vel_tmp = lrintf(verticalEstimator.velocity);
+
+#ifdef DEBUG_ALT_HOLD
+        debug[1] = lrintf(verticalEstimator.accBias);
+        debug[2] = vel_tmp;
+        debug[3] = EstAlt;
+#endif
+    } else {
+        verticalEstimatorActive = false;
+
+        vel_acc = accZ_tmp * accVelScale * (float)accTimeSum;
+
+        // Integrator - Altitude in cm
+        accAlt += (vel_acc * 0.5f) * dt + vel * dt;                                                                 // integrate velocity to get distance (x= a/2 * t^2)
+        accAlt = accAlt * barometerConfig->baro_cf_alt + (float)baro.BaroAlt * (1.0f - barometerConfig->baro_cf_alt);    // complementary filter for altitude estimation (baro & acc)
+        vel += vel_acc;
 
 #ifdef DEBUG_ALT_HOLD
-    debug[1] = accSum[2] / accSumCount; // acceleration
-    debug[2] = vel;                     // velocity
-    debug[3] = accAlt;                  // height
+        debug[1] = accSum[2] / accSumCount; // acceleration
+        debug[2] = vel;                     // velocity
+        debug[3] = accAlt;                  // height
 #endif
 
-    imuResetAccelerationSum();
+        imuResetAccelerationSum();
 
 #ifdef BARO
-    if (!isBaroCalibrationComplete()) {
-        return;
-    }
+        if (!isBaroCalibrationComplete()) {
+            return;
+        }
 #endif
 
 #ifdef SONAR
-    if (sonarAlt > 0 && sonarAlt < sonarCfAltCm) {
-        // the sonar has the best range
-        EstAlt = baro.BaroAlt;
-    } else {
-        EstAlt = accAlt;
-    }
+        if (sonarAlt > 0 && sonarAlt < sonarCfAltCm) {
+            // the sonar has the best range
+            EstAlt = baro.BaroAlt;
+        } else {
+            EstAlt = accAlt;
+        }
 #else
-    EstAlt = accAlt;
+        EstAlt = accAlt;
 #endif
 
-    baroVel = (baro.BaroAlt - lastBaroAlt) * 1000000.0f / dTime;
-    lastBaroAlt = baro.BaroAlt;
+        baroVel = (baro.BaroAlt - lastBaroAlt) * 1000000.0f / dTime;
+        lastBaroAlt = baro.BaroAlt;
 
-    baroVel = constrain(baroVel, -1500, 1500);  // constrain baro velocity +/- 1500cm/s
-    baroVel = applyDeadband(baroVel, 10);       // to reduce noise near zero
+        baroVel = constrain(baroVel, -1500, 1500);  // constrain baro velocity +/- 1500cm/s
+        baroVel = applyDeadband(baroVel, 10);       // to reduce noise near zero
 
-    // apply Complimentary Filter to keep the calculated velocity based on baro velocity (i.e. near real velocity).
-    // By using CF it's possible to correct the drift of integrated accZ (velocity) without loosing the phase, i.e without delay
-    vel = vel * barometerConfig->baro_cf_vel + baroVel * (1.0f - barometerConfig->baro_cf_vel);
-    vel_tmp = lrintf(vel);
+        // apply Complimentary Filter to keep the calculated velocity based on baro velocity (i.e. near real velocity).
+        // By using CF it's possible to correct the drift of integrated accZ (velocity) without loosing the phase, i.e without delay
+        vel = vel * barometerConfig->baro_cf_vel + baroVel * (1.0f - barometerConfig->baro_cf_vel);
+        vel_tmp = lrintf(vel);
+    }
 
     // set vario
     vario = applyDeadband(vel_tmp, 5);
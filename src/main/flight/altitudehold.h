@@ -21,6 +21,7 @@ extern int32_t AltHold;
 extern int32_t vario;
 
 void calculateEstimatedAltitude(timeUs_t currentTimeUs);
+void altitudeEstimatorPredict(float accZ, float dt);
 
 struct pidProfile_s;
 struct barometerConfig_s;
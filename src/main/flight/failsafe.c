@@ -23,6 +23,8 @@
 #include "build/debug.h"
 
 #include "common/axis.h"
+#include "common/maths.h"
+#include "common/time.h"
 
 #include "drivers/system.h"
 
@@ -56,11 +58,15 @@ static rxConfig_t *rxConfig;
 
 static uint16_t deadband3dThrottle;           // default throttle deadband from MIDRC
 
+static failsafeLatency_t failsafeLatency;
+
 static void failsafeReset(void)
 {
     failsafeState.rxDataFailurePeriod = PERIOD_RXDATA_FAILURE + failsafeConfig->failsafe_delay * MILLIS_PER_TENTH_SECOND;
     failsafeState.validRxDataReceivedAt = 0;
     failsafeState.validRxDataFailedAt = 0;
+    failsafeState.validRxFrameAt = 0;
+    failsafeLatency.deadlineUs = failsafeState.rxDataFailurePeriod * 1000;
     failsafeState.throttleLowPeriod = 0;
     failsafeState.landingShouldBeFinishedAt = 0;
     failsafeState.receivingRxDataPeriod = 0;
@@ -86,6 +92,11 @@ void failsafeInit(rxConfig_t *intialRxConfig, uint16_t deadband3d_throttle)
     failsafeState.events = 0;
     failsafeState.monitoring = false;
 
+    failsafeLatency.detections = 0;
+    failsafeLatency.lastUs = 0;
+    failsafeLatency.minUs = UINT32_MAX;
+    failsafeLatency.maxUs = 0;
+
     return;
 }
 
@@ -140,11 +151,13 @@ bool failsafeIsReceivingRxData(void)
 void failsafeOnRxSuspend(uint32_t usSuspendPeriod)
 {
     failsafeState.validRxDataReceivedAt += (usSuspendPeriod / 1000);    // / 1000 to convert micros to millis
+    failsafeState.validRxFrameAt += usSuspendPeriod;
 }
 
 void failsafeOnRxResume(void)
 {
     failsafeState.validRxDataReceivedAt = millis();                     // prevent RX link down trigger, restart rx link up
+    failsafeState.validRxFrameAt = micros();
     failsafeState.rxLinkState = FAILSAFE_RXLINK_UP;                     // do so while rx link is up
 }
 
@@ -164,6 +177,47 @@ void failsafeOnValidDataFailed(void)
     }
 }
 
+void failsafeOnValidRxFrame(timeUs_t frameTimeUs)
+{
+    failsafeState.validRxFrameAt = frameTimeUs;
+}
+
+/*
+ * Called every PID loop. The RX task only notices a missing frame when it next runs, this
+ * declares the link down as soon as the last valid frame is older than the failure period.
+ */
+void failsafeCheckRxDeadline(timeUs_t currentTimeUs)
+{
+    if (!failsafeIsMonitoring()) {
+        return;
+    }
+
+    const uint32_t deadlineUs = failsafeState.rxDataFailurePeriod * 1000;
+    const timeDelta_t sinceValidFrameUs = cmpTimeUs(currentTimeUs, failsafeState.validRxFrameAt);
+    if (sinceValidFrameUs <= (timeDelta_t)deadlineUs) {
+        return;
+    }
+
+    // held channel values keep arriving at failsafeOnValidDataReceived(), keep it from recovering the link on them
+    failsafeState.validRxDataFailedAt = millis();
+
+    if (failsafeState.rxLinkState == FAILSAFE_RXLINK_UP) {
+        failsafeState.rxLinkState = FAILSAFE_RXLINK_DOWN;
+
+        failsafeLatency.detections++;
+        failsafeLatency.lastUs = sinceValidFrameUs;
+        failsafeLatency.minUs = MIN(failsafeLatency.minUs, failsafeLatency.lastUs);
+        failsafeLatency.maxUs = MAX(failsafeLatency.maxUs, failsafeLatency.lastUs);
+
+        failsafeUpdateState();
+    }
+}
+
+const failsafeLatency_t *failsafeGetLatency(void)
+{
+    return &failsafeLatency;
+}
+
 void failsafeUpdateState(void)
 {
     if (!failsafeIsMonitoring()) {
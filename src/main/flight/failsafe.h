@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "common/time.h"
+
 #define FAILSAFE_POWER_ON_DELAY_US (1000 * 1000 * 5)
 #define MILLIS_PER_TENTH_SECOND      100
 #define MILLIS_PER_SECOND           1000
@@ -62,6 +64,7 @@ typedef struct failsafeState_s {
     uint32_t rxDataFailurePeriod;
     uint32_t validRxDataReceivedAt;
     uint32_t validRxDataFailedAt;
+    uint32_t validRxFrameAt;                // micros, arrival of the last frame carrying valid data
     uint32_t throttleLowPeriod;             // throttle stick must have been below 'min_check' for this period
     uint32_t landingShouldBeFinishedAt;
     uint32_t receivingRxDataPeriod;         // period for the required period of valid rxData
@@ -70,6 +73,14 @@ typedef struct failsafeState_s {
     failsafeRxLinkState_e rxLinkState;
 } failsafeState_t;
 
+typedef struct failsafeLatency_s {
+    uint16_t detections;                    // rx link losses caught by the deadline check
+    uint32_t deadlineUs;                    // allowed time since the last valid frame
+    uint32_t lastUs;                        // time from the last valid frame to the link being declared down
+    uint32_t minUs;
+    uint32_t maxUs;
+} failsafeLatency_t;
+
 struct rxConfig_s;
 void failsafeInit(struct rxConfig_s *intialRxConfig, uint16_t deadband3d_throttle);
 void useFailsafeConfig(failsafeConfig_t *failsafeConfigToUse);
@@ -87,6 +98,10 @@ void failsafeOnRxResume(void);
 void failsafeOnValidDataReceived(void);
 void failsafeOnValidDataFailed(void);
 
+void failsafeOnValidRxFrame(timeUs_t frameTimeUs);
+void failsafeCheckRxDeadline(timeUs_t currentTimeUs);
+const failsafeLatency_t *failsafeGetLatency(void);
+
 
 
 
@@ -42,6 +42,8 @@
 #include "flight/mixer.h"
 #include "flight/pid.h"
 #include "flight/imu.h"
+#include "flight/imu_quaternion.h"
+#include "flight/altitudehold.h"
 
 #include "io/gps.h"
 
@@ -72,6 +74,8 @@ static pidProfile_t *pidProfile;
 STATIC_UNIT_TESTED float q0 = 1.0f, q1 = 0.0f, q2 = 0.0f, q3 = 0.0f;    // quaternion of sensor frame relative to earth frame
 static float rMat[3][3];
 
+static imuQuaternionEstimator_t quaternionEstimator;
+
 attitudeEulerAngles_t attitude = { { 0, 0, 0 } };     // absolute angle inclination in multiple of 0.1 degree    180 deg = 1800
 
 STATIC_UNIT_TESTED void imuComputeRotationMatrix(void)
@@ -111,6 +115,15 @@ void imuConfigure(
     imuRuntimeConfig.acc_unarmedcal = imuConfig->acc_unarmedcal;
     imuRuntimeConfig.small_angle = imuConfig->small_angle;
 
+    if (imuConfig->estimator == IMU_ESTIMATOR_QUATERNION && imuRuntimeConfig.estimator != IMU_ESTIMATOR_QUATERNION) {
+        // carry on from the attitude the other estimator had reached
+        quaternionEstimator.q[0] = q0;
+        quaternionEstimator.q[1] = q1;
+        quaternionEstimator.q[2] = q2;
+        quaternionEstimator.q[3] = q3;
+    }
+    imuRuntimeConfig.estimator = imuConfig->estimator;
+
     pidProfile = initialPidProfile;
     fc_acc = calculateAccZLowPassFilterRCTimeConstant(5.0f); // Set to fix value
     throttleAngleScale = calculateThrottleAngleScale(throttle_correction_angle);
@@ -121,6 +134,7 @@ void imuInit(void)
     smallAngleCosZ = cos_approx(degreesToRadians(imuRuntimeConfig.small_angle));
     accVelScale = 9.80665f / acc.dev.acc_1G / 10000.0f;
 
+    imuQuaternionReset(&quaternionEstimator);
     imuComputeRotationMatrix();
 }
 
@@ -196,6 +210,11 @@ void imuCalculateAcceleration(uint32_t deltaT)
     // sum up Values for later integration to get velocity and distance
     accTimeSum += deltaT;
     accSumCount++;
+
+#if defined(BARO) || defined(SONAR)
+    // the vertical estimator is propagated at the accelerometer rate, in cm/s/s
+    altitudeEstimatorPredict(accz_smooth * accVelScale * 1e6f, dT);
+#endif
 }
 
 static float invSqrt(float x)
@@ -394,11 +413,27 @@ static void imuCalculateEstimatedAttitude(timeUs_t currentTimeUs)
     }
 #endif
 
-    imuMahonyAHRSupdate(deltaT * 1e-6f,
-                        DEGREES_TO_RADIANS(gyro.gyroADCf[X]), DEGREES_TO_RADIANS(gyro.gyroADCf[Y]), DEGREES_TO_RADIANS(gyro.gyroADCf[Z]),
-                        useAcc, acc.accSmooth[X], acc.accSmooth[Y], acc.accSmooth[Z],
-                        useMag, mag.magADC[X], mag.magADC[Y], mag.magADC[Z],
-                        useYaw, rawYawError);
+    if (imuRuntimeConfig.estimator == IMU_ESTIMATOR_QUATERNION) {
+        // the gyro was integrated in imuIntegrateGyro(), only the correction is left
+        imuQuaternionCorrect(&quaternionEstimator, deltaT * 1e-6f,
+                             imuRuntimeConfig.dcm_kp * imuGetPGainScaleFactor(), imuRuntimeConfig.dcm_ki,
+                             useAcc, acc.accSmooth[X], acc.accSmooth[Y], acc.accSmooth[Z],
+                             useMag, mag.magADC[X], mag.magADC[Y], mag.magADC[Z],
+                             useYaw, rawYawError);
+
+        // matrix and angles only for the consumers at this rate, not per gyro sample
+        q0 = quaternionEstimator.q[0];
+        q1 = quaternionEstimator.q[1];
+        q2 = quaternionEstimator.q[2];
+        q3 = quaternionEstimator.q[3];
+        imuComputeRotationMatrix();
+    } else {
+        imuMahonyAHRSupdate(deltaT * 1e-6f,
+                            DEGREES_TO_RADIANS(gyro.gyroADCf[X]), DEGREES_TO_RADIANS(gyro.gyroADCf[Y]), DEGREES_TO_RADIANS(gyro.gyroADCf[Z]),
+                            useAcc, acc.accSmooth[X], acc.accSmooth[Y], acc.accSmooth[Z],
+                            useMag, mag.magADC[X], mag.magADC[Y], mag.magADC[Z],
+                            useYaw, rawYawError);
+    }
 
     imuUpdateEulerAngles();
 
@@ -416,6 +451,36 @@ void imuUpdateAttitude(timeUs_t currentTimeUs)
     }
 }
 
+// Called for every gyro sample, the quaternion estimator integrates here rather than in the attitude task
+void imuIntegrateGyro(void)
+{
+    if (imuRuntimeConfig.estimator != IMU_ESTIMATOR_QUATERNION) {
+        return;
+    }
+
+    imuQuaternionIntegrate(&quaternionEstimator,
+                           DEGREES_TO_RADIANS(gyro.gyroADCf[X]), DEGREES_TO_RADIANS(gyro.gyroADCf[Y]), DEGREES_TO_RADIANS(gyro.gyroADCf[Z]),
+                           gyro.targetLooptime * 1e-6f);
+}
+
+// sensor frame relative to earth frame, w x y z
+void imuGetQuaternion(float quaternion[4])
+{
+    if (imuRuntimeConfig.estimator == IMU_ESTIMATOR_QUATERNION) {
+        // up to date with the last gyro sample
+        quaternion[0] = quaternionEstimator.q[0];
+        quaternion[1] = quaternionEstimator.q[1];
+        quaternion[2] = quaternionEstimator.q[2];
+        quaternion[3] = quaternionEstimator.q[3];
+        return;
+    }
+
+    quaternion[0] = q0;
+    quaternion[1] = q1;
+    quaternion[2] = q2;
+    quaternion[3] = q3;
+}
+
 float getCosTiltAngle(void)
 {
     return rMat[2][2];
@@ -57,12 +57,18 @@ typedef struct throttleCorrectionConfig_s {
     uint8_t throttle_correction_value;      // the correction that will be applied at throttle_correction_angle.
 } throttleCorrectionConfig_t;
 
+typedef enum {
+    IMU_ESTIMATOR_MAHONY = 0,               // gyro integrated once per attitude task
+    IMU_ESTIMATOR_QUATERNION = 1            // gyro integrated on every sample, see imu_quaternion.c
+} imuEstimator_e;
+
 typedef struct imuConfig_s {
     uint16_t dcm_kp;                        // DCM filter proportional gain ( x 10000)
     uint16_t dcm_ki;                        // DCM filter integral gain ( x 10000)
     uint8_t small_angle;
     uint8_t acc_unarmedcal;                 // turn automatic acc compensation on/off
     accDeadband_t accDeadband;
+    uint8_t estimator;                      // attitude estimator, see imuEstimator_e
 } imuConfig_t;
 
 typedef struct imuRuntimeConfig_s {
@@ -71,6 +77,7 @@ typedef struct imuRuntimeConfig_s {
     uint8_t acc_unarmedcal;
     uint8_t small_angle;
     accDeadband_t accDeadband;
+    uint8_t estimator;
 } imuRuntimeConfig_t;
 
 typedef enum {
@@ -97,8 +104,10 @@ void imuConfigure(
 );
 
 float getCosTiltAngle(void);
+void imuGetQuaternion(float quaternion[4]);
 void calculateEstimatedAltitude(timeUs_t currentTimeUs);
 void imuUpdateAttitude(timeUs_t currentTimeUs);
+void imuIntegrateGyro(void);
 float calculateThrottleAngleScale(uint16_t throttle_correction_angle);
 int16_t calculateThrottleAngleCorrection(uint8_t throttle_correction_value);
 float calculateAccZLowPassFilterRCTimeConstant(float accz_lpf_hz);
@@ -0,0 +1,154 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "common/maths.h"
+
+#include "flight/imu_quaternion.h"
+
+/*
+ * Same feedback as the Mahony filter in imu.c, but the gyro is integrated on every sample instead
+ * of once per attitude task, and the accelerometer and magnetometer error is applied as a single
+ * rotation when the attitude task runs. No rotation matrix or Euler angles are kept, the few
+ * matrix elements the correction needs come straight from the quaternion.
+ */
+
+// stop integrating the error above 20 deg/s, as imu.c does
+#define IMU_QUATERNION_SPIN_RATE_LIMIT_SQ   sq(20.0f * RAD)
+
+// the quaternion never drifts far from unit length between steps, so 1/sqrt(n) is taken to first order around 1
+static void imuQuaternionNormalise(float q[4])
+{
+    const float recipNorm = 1.5f - 0.5f * (sq(q[0]) + sq(q[1]) + sq(q[2]) + sq(q[3]));
+
+    q[0] *= recipNorm;
+    q[1] *= recipNorm;
+    q[2] *= recipNorm;
+    q[3] *= recipNorm;
+}
+
+// q = q * (1, x, y, z), for half angles
+static void imuQuaternionRotate(float q[4], float x, float y, float z)
+{
+    const float qa = q[0];
+    const float qb = q[1];
+    const float qc = q[2];
+    const float qd = q[3];
+
+    q[0] += (-qb * x - qc * y - qd * z);
+    q[1] += (qa * x + qc * z - qd * y);
+    q[2] += (qa * y - qb * z + qd * x);
+    q[3] += (qa * z + qb * y - qc * x);
+
+    imuQuaternionNormalise(q);
+}
+
+void imuQuaternionReset(imuQuaternionEstimator_t *estimator)
+{
+    estimator->q[0] = 1.0f;
+    estimator->q[1] = 0.0f;
+    estimator->q[2] = 0.0f;
+    estimator->q[3] = 0.0f;
+    estimator->integralFB[0] = 0.0f;
+    estimator->integralFB[1] = 0.0f;
+    estimator->integralFB[2] = 0.0f;
+    estimator->spinRateSq = 0.0f;
+}
+
+// rates in rad/s
+void imuQuaternionIntegrate(imuQuaternionEstimator_t *estimator, float gx, float gy, float gz, float dt)
+{
+    estimator->spinRateSq = sq(gx) + sq(gy) + sq(gz);
+
+    const float halfDt = 0.5f * dt;
+    imuQuaternionRotate(estimator->q,
+                        (gx + estimator->integralFB[0]) * halfDt,
+                        (gy + estimator->integralFB[1]) * halfDt,
+                        (gz + estimator->integralFB[2]) * halfDt);
+}
+
+void imuQuaternionCorrect(imuQuaternionEstimator_t *estimator, float dt, float kp, float ki,
+                          bool useAcc, float ax, float ay, float az,
+                          bool useMag, float mx, float my, float mz,
+                          bool useYaw, float yawError)
+{
+    const float *q = estimator->q;
+    float ex = 0, ey = 0, ez = 0;
+    float recipNorm;
+
+    // earth Z axis in the sensor frame, the bottom row of the rotation matrix
+    const float r20 = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+    const float r21 = 2.0f * (q[2] * q[3] + q[0] * q[1]);
+    const float r22 = 1.0f - 2.0f * (sq(q[1]) + sq(q[2]));
+
+    if (useYaw) {
+        while (yawError >  M_PIf) yawError -= (2.0f * M_PIf);
+        while (yawError < -M_PIf) yawError += (2.0f * M_PIf);
+
+        ez += sin_approx(yawError / 2.0f);
+    }
+
+    recipNorm = sq(mx) + sq(my) + sq(mz);
+    if (useMag && recipNorm > 0.01f) {
+        recipNorm = fastInvSqrt(recipNorm);
+        mx *= recipNorm;
+        my *= recipNorm;
+        mz *= recipNorm;
+
+        // measured field in the earth frame, its Z component ignored so it only corrects heading
+        const float hx = (1.0f - 2.0f * (sq(q[2]) + sq(q[3]))) * mx + 2.0f * (q[1] * q[2] - q[0] * q[3]) * my + 2.0f * (q[1] * q[3] + q[0] * q[2]) * mz;
+        const float hy = 2.0f * (q[1] * q[2] + q[0] * q[3]) * mx + (1.0f - 2.0f * (sq(q[1]) + sq(q[3]))) * my + 2.0f * (q[2] * q[3] - q[0] * q[1]) * mz;
+        const float bxSq = hx * hx + hy * hy;
+        const float bx = bxSq > 0.0f ? bxSq * fastInvSqrt(bxSq) : 0.0f;
+
+        const float ez_ef = -(hy * bx);
+        ex += r20 * ez_ef;
+        ey += r21 * ez_ef;
+        ez += r22 * ez_ef;
+    }
+
+    recipNorm = sq(ax) + sq(ay) + sq(az);
+    if (useAcc && recipNorm > 0.01f) {
+        recipNorm = fastInvSqrt(recipNorm);
+        ax *= recipNorm;
+        ay *= recipNorm;
+        az *= recipNorm;
+
+        ex += (ay * r22 - az * r21);
+        ey += (az * r20 - ax * r22);
+        ez += (ax * r21 - ay * r20);
+    }
+
+    if (ki > 0.0f) {
+        if (estimator->spinRateSq < IMU_QUATERNION_SPIN_RATE_LIMIT_SQ) {
+            estimator->integralFB[0] += ki * ex * dt;
+            estimator->integralFB[1] += ki * ey * dt;
+            estimator->integralFB[2] += ki * ez * dt;
+        }
+    } else {
+        estimator->integralFB[0] = 0.0f;
+        estimator->integralFB[1] = 0.0f;
+        estimator->integralFB[2] = 0.0f;
+    }
+
+    // proportional feedback over the interval since the last correction
+    const float halfKpDt = 0.5f * kp * dt;
+    imuQuaternionRotate(estimator->q, ex * halfKpDt, ey * halfKpDt, ez * halfKpDt);
+}
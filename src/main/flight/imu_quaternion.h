@@ -0,0 +1,32 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Attitude kept only as a quaternion, integrated at gyro rate and corrected at the attitude task rate
+typedef struct imuQuaternionEstimator_s {
+    float q[4];                     // w x y z, sensor frame relative to earth frame
+    float integralFB[3];            // rad/s, integral feedback added to every gyro sample
+    float spinRateSq;               // (rad/s)^2 of the last gyro sample, stops integral feedback when spinning
+} imuQuaternionEstimator_t;
+
+void imuQuaternionReset(imuQuaternionEstimator_t *estimator);
+void imuQuaternionIntegrate(imuQuaternionEstimator_t *estimator, float gx, float gy, float gz, float dt);
+void imuQuaternionCorrect(imuQuaternionEstimator_t *estimator, float dt, float kp, float ki,
+                          bool useAcc, float ax, float ay, float az,
+                          bool useMag, float mx, float my, float mz,
+                          bool useYaw, float yawError);
@@ -90,6 +90,23 @@ static const motorMixer_t mixerTricopter[] = {
     { 1.0f,  1.0f, -0.666667f,  0.0f },     // LEFT
 };
 
+#ifdef USE_TRI_MIXER_FAST_PATH
+// mixerTricopter with the 3D gain halving of mixerConfigureOutput() applied
+static const motorMixer_t mixerTricopter3D[] = {
+    { 1.0f,  0.0f * 0.5f,  1.333333f * 0.5f,  0.0f * 0.5f },    // REAR
+    { 1.0f, -1.0f * 0.5f, -0.666667f * 0.5f,  0.0f * 0.5f },    // RIGHT
+    { 1.0f,  1.0f * 0.5f, -0.666667f * 0.5f,  0.0f * 0.5f },    // LEFT
+};
+
+typedef enum {
+    TRI_FAST_PATH_OFF = 0,
+    TRI_FAST_PATH_NORMAL,
+    TRI_FAST_PATH_3D,
+} triFastPath_e;
+
+static triFastPath_e triFastPath = TRI_FAST_PATH_OFF;
+#endif
+
 static const motorMixer_t mixerQuadP[] = {
     { 1.0f,  0.0f,  1.0f, -1.0f },          // REAR
     { 1.0f, -1.0f,  0.0f,  1.0f },          // RIGHT
@@ -292,6 +309,16 @@ bool mixerIsOutputSaturated(int axis, float errorRate)
     return false;
 }
 
+#ifdef USE_FIXED_POINT_PID
+bool mixerIsOutputSaturatedFix(int axis, fix16_t errorRate)
+{
+    if (axis == FD_YAW && triMixerInUse()) {
+        return triIsServoSaturatedFix(errorRate);
+    }
+    return motorMixRange >= 1.0f;
+}
+#endif
+
 bool isMotorProtocolDshot(void) {
 #ifdef USE_DSHOT
     switch(motorConfig->motorPwmProtocol) {
@@ -396,6 +423,15 @@ void mixerConfigureOutput(void)
         }
     }
 
+#ifdef USE_TRI_MIXER_FAST_PATH
+    // custom tricopter mixes keep using the generic path, their rules are only known at runtime
+    if (currentMixerMode == MIXER_TRI) {
+        triFastPath = feature(FEATURE_3D) ? TRI_FAST_PATH_3D : TRI_FAST_PATH_NORMAL;
+    } else {
+        triFastPath = TRI_FAST_PATH_OFF;
+    }
+#endif
+
     mixerResetDisarmedMotors();
 }
 
@@ -470,77 +506,22 @@ void stopPwmAllMotors(void)
     delayMicroseconds(1500);
 }
 
-void mixTable(pidProfile_t *pidProfile)
+// Motor stage of mixTable(). Always inlined, so a caller passing a constant rule table, motor count and
+// tricopter flag gets a straight-line mixer built from the very same expressions as the generic loop.
+__attribute__( ( always_inline ) ) static inline void mixMotors(const motorMixer_t *rules, const int count, const bool tricopter,
+    float throttle, const uint16_t motorOutputMin, const uint16_t motorOutputMax, const bool mixerInversion,
+    const bool airmodeIsActive, const float vbatCompensationFactor)
 {
-    // Scale roll/pitch/yaw uniformly to fit within throttle range
-    // Initial mixer concept by bdoiron74 reused and optimized for Air Mode
-    float throttle, currentThrottleInputRange = 0;
-    uint16_t motorOutputMin, motorOutputMax;
-    static uint16_t throttlePrevious = 0;   // Store the last throttle direction for deadband transitions
-    bool mixerInversion = false;
-    const bool airmodeIsActive = isAirmodeActive();
-
-    // Find min and max throttle based on condition.
-    if (feature(FEATURE_3D)) {
-        if (!ARMING_FLAG(ARMED)) throttlePrevious = rxConfig->midrc; // When disarmed set to mid_rc. It always results in positive direction after arming.
-
-        if ((rcCommand[THROTTLE] <= (rxConfig->midrc - flight3DConfig->deadband3d_throttle))) { // Out of band handling
-            motorOutputMax = deadbandMotor3dLow;
-            motorOutputMin = motorOutputLow;
-            throttlePrevious = rcCommand[THROTTLE];
-            throttle = rcCommand[THROTTLE] - rxConfig->mincheck;
-            currentThrottleInputRange = rcCommandThrottleRange3dLow;
-            if(isMotorProtocolDshot()) mixerInversion = true;
-        } else if (rcCommand[THROTTLE] >= (rxConfig->midrc + flight3DConfig->deadband3d_throttle)) { // Positive handling
-            motorOutputMax = motorOutputHigh;
-            motorOutputMin = deadbandMotor3dHigh;
-            throttlePrevious = rcCommand[THROTTLE];
-            throttle = rcCommand[THROTTLE] - rxConfig->midrc - flight3DConfig->deadband3d_throttle;
-            currentThrottleInputRange = rcCommandThrottleRange3dHigh;
-        } else if ((throttlePrevious <= (rxConfig->midrc - flight3DConfig->deadband3d_throttle)))  { // Deadband handling from negative to positive
-            motorOutputMax = deadbandMotor3dLow;
-            motorOutputMin = motorOutputLow;
-            throttle = rxConfig->midrc - flight3DConfig->deadband3d_throttle;
-            currentThrottleInputRange = rcCommandThrottleRange3dLow;
-            if(isMotorProtocolDshot()) mixerInversion = true;
-        } else {  // Deadband handling from positive to negative
-            motorOutputMax = motorOutputHigh;
-            motorOutputMin = deadbandMotor3dHigh;
-            throttle = 0;
-            currentThrottleInputRange = rcCommandThrottleRange3dHigh;
-        }
-    } else {
-        throttle = rcCommand[THROTTLE] - rxConfig->mincheck;
-        currentThrottleInputRange = rcCommandThrottleRange;
-        motorOutputMin = motorOutputLow;
-        motorOutputMax = motorOutputHigh;
-    }
-
-    throttle = constrainf(throttle / currentThrottleInputRange, 0.0f, 1.0f);
     const float motorOutputRange = motorOutputMax - motorOutputMin;
 
-    // Calculate and Limit the PIDsum
-    scaledAxisPIDf[FD_ROLL] =
-        constrainf((axisPID_P[FD_ROLL] + axisPID_I[FD_ROLL] + axisPID_D[FD_ROLL]) / PID_MIXER_SCALING,
-        -pidProfile->pidSumLimit, pidProfile->pidSumLimit);
-    scaledAxisPIDf[FD_PITCH] =
-        constrainf((axisPID_P[FD_PITCH] + axisPID_I[FD_PITCH] + axisPID_D[FD_PITCH]) / PID_MIXER_SCALING,
-        -pidProfile->pidSumLimit, pidProfile->pidSumLimit);
-    scaledAxisPIDf[FD_YAW] =
-        constrainf((axisPID_P[FD_YAW] + axisPID_I[FD_YAW] + axisPID_D[FD_YAW]) / PID_MIXER_SCALING,
-        -pidProfile->pidSumLimit, pidProfile->pidSumLimitYaw);
-
-    // Calculate voltage compensation
-    const float vbatCompensationFactor = (batteryConfig && pidProfile->vbatPidCompensation)  ? calculateVbatPidCompensation() : 1.0f;
-
     // Find roll/pitch/yaw desired output
     float motorMix[MAX_SUPPORTED_MOTORS];
     float motorMixMax = 0, motorMixMin = 0;
-    for (int i = 0; i < motorCount; i++) {
+    for (int i = 0; i < count; i++) {
         motorMix[i] =
-            scaledAxisPIDf[PITCH] * currentMixer[i].pitch +
-            scaledAxisPIDf[ROLL]  * currentMixer[i].roll +
-            scaledAxisPIDf[YAW]   * currentMixer[i].yaw * (-mixerConfig->yaw_motor_direction);
+            scaledAxisPIDf[PITCH] * rules[i].pitch +
+            scaledAxisPIDf[ROLL]  * rules[i].roll +
+            scaledAxisPIDf[YAW]   * rules[i].yaw * (-mixerConfig->yaw_motor_direction);
 
         if (vbatCompensationFactor > 1.0f) {
             motorMix[i] *= vbatCompensationFactor;  // Add voltage compensation
@@ -556,7 +537,7 @@ void mixTable(pidProfile_t *pidProfile)
     motorMixRange = motorMixMax - motorMixMin;
 
     if (motorMixRange > 1.0f) {
-        for (int i = 0; i < motorCount; i++) {
+        for (int i = 0; i < count; i++) {
             motorMix[i] /= motorMixRange;
         }
         // Get the maximum correction by setting offset to center when airmode enabled
@@ -570,19 +551,24 @@ void mixTable(pidProfile_t *pidProfile)
         }
     }
 
+    // These do not change between motors
+    const bool failsafeActive = failsafeIsActive();
+    const bool motorStop = feature(FEATURE_MOTOR_STOP) && ARMING_FLAG(ARMED) && !feature(FEATURE_3D) && !airmodeIsActive
+        && rcData[THROTTLE] < rxConfig->mincheck;
+
     // Now add in the desired throttle, but keep in a range that doesn't clip adjusted
     // roll/pitch/yaw. This could move throttle down, but also up for those low throttle flips.
-    uint32_t i = 0;
-    for (i = 0; i < motorCount; i++) {
-        motor[i] = motorOutputMin + lrintf(motorOutputRange * (motorMix[i] + (throttle * currentMixer[i].throttle)));
-        const int16_t correction = triGetMotorCorrection(i);
+    for (int i = 0; i < count; i++) {
+        motor[i] = motorOutputMin + lrintf(motorOutputRange * (motorMix[i] + (throttle * rules[i].throttle)));
+        // triGetMotorCorrection() is zero for all but the tail motor
+        const int16_t correction = (!tricopter || i == TRI_TAIL_MOTOR_INDEX) ? triGetMotorCorrection(i) : 0;
         motor[i] += correction;
         // Dshot works exactly opposite in lower 3D section.
         if (mixerInversion) {
             motor[i] = motorOutputMin + (motorOutputMax - motor[i]);
         }
 
-        if (failsafeIsActive()) {
+        if (failsafeActive) {
             if (isMotorProtocolDshot())
                 motor[i] = (motor[i] < motorOutputMin) ? disarmMotorOutput : motor[i]; // Prevent getting into special reserved range
 
@@ -596,21 +582,97 @@ void mixTable(pidProfile_t *pidProfile)
         }
 
         // Motor stop handling
-        if (feature(FEATURE_MOTOR_STOP) && ARMING_FLAG(ARMED) && !feature(FEATURE_3D) && !isAirmodeActive()) {
-            if (((rcData[THROTTLE]) < rxConfig->mincheck)) {
-                motor[i] = disarmMotorOutput;
-            }
+        if (motorStop) {
+            motor[i] = disarmMotorOutput;
         }
     }
 
     // Disarmed mode
     if (!ARMING_FLAG(ARMED)) {
-        for (i = 0; i < motorCount; i++) {
+        for (int i = 0; i < count; i++) {
             motor[i] = motor_disarmed[i];
         }
     }
 }
 
+void mixTable(pidProfile_t *pidProfile)
+{
+    // Scale roll/pitch/yaw uniformly to fit within throttle range
+    // Initial mixer concept by bdoiron74 reused and optimized for Air Mode
+    float throttle, currentThrottleInputRange = 0;
+    uint16_t motorOutputMin, motorOutputMax;
+    static uint16_t throttlePrevious = 0;   // Store the last throttle direction for deadband transitions
+    bool mixerInversion = false;
+    const bool airmodeIsActive = isAirmodeActive();
+
+    // Find min and max throttle based on condition.
+    if (feature(FEATURE_3D)) {
+        if (!ARMING_FLAG(ARMED)) throttlePrevious = rxConfig->midrc; // When disarmed set to mid_rc. It always results in positive direction after arming.
+
+        if ((rcCommand[THROTTLE] <= (rxConfig->midrc - flight3DConfig->deadband3d_throttle))) { // Out of band handling
+            motorOutputMax = deadbandMotor3dLow;
+            motorOutputMin = motorOutputLow;
+            throttlePrevious = rcCommand[THROTTLE];
+            throttle = rcCommand[THROTTLE] - rxConfig->mincheck;
+            currentThrottleInputRange = rcCommandThrottleRange3dLow;
+            if(isMotorProtocolDshot()) mixerInversion = true;
+        } else if (rcCommand[THROTTLE] >= (rxConfig->midrc + flight3DConfig->deadband3d_throttle)) { // Positive handling
+            motorOutputMax = motorOutputHigh;
+            motorOutputMin = deadbandMotor3dHigh;
+            throttlePrevious = rcCommand[THROTTLE];
+            throttle = rcCommand[THROTTLE] - rxConfig->midrc - flight3DConfig->deadband3d_throttle;
+            currentThrottleInputRange = rcCommandThrottleRange3dHigh;
+        } else if ((throttlePrevious <= (rxConfig->midrc - flight3DConfig->deadband3d_throttle)))  { // Deadband handling from negative to positive
+            motorOutputMax = deadbandMotor3dLow;
+            motorOutputMin = motorOutputLow;
+            throttle = rxConfig->midrc - flight3DConfig->deadband3d_throttle;
+            currentThrottleInputRange = rcCommandThrottleRange3dLow;
+            if(isMotorProtocolDshot()) mixerInversion = true;
+        } else {  // Deadband handling from positive to negative
+            motorOutputMax = motorOutputHigh;
+            motorOutputMin = deadbandMotor3dHigh;
+            throttle = 0;
+            currentThrottleInputRange = rcCommandThrottleRange3dHigh;
+        }
+    } else {
+        throttle = rcCommand[THROTTLE] - rxConfig->mincheck;
+        currentThrottleInputRange = rcCommandThrottleRange;
+        motorOutputMin = motorOutputLow;
+        motorOutputMax = motorOutputHigh;
+    }
+
+    throttle = constrainf(throttle / currentThrottleInputRange, 0.0f, 1.0f);
+
+    // Calculate and Limit the PIDsum
+    scaledAxisPIDf[FD_ROLL] =
+        constrainf(PID_SUM(FD_ROLL) / PID_MIXER_SCALING,
+        -pidProfile->pidSumLimit, pidProfile->pidSumLimit);
+    scaledAxisPIDf[FD_PITCH] =
+        constrainf(PID_SUM(FD_PITCH) / PID_MIXER_SCALING,
+        -pidProfile->pidSumLimit, pidProfile->pidSumLimit);
+    scaledAxisPIDf[FD_YAW] =
+        constrainf(PID_SUM(FD_YAW) / PID_MIXER_SCALING,
+        -pidProfile->pidSumLimit, pidProfile->pidSumLimitYaw);
+
+    // Calculate voltage compensation
+    const float vbatCompensationFactor = (batteryConfig && pidProfile->vbatPidCompensation)  ? calculateVbatPidCompensation() : 1.0f;
+
+#ifdef USE_TRI_MIXER_FAST_PATH
+    switch (triFastPath) {
+    case TRI_FAST_PATH_NORMAL:
+        mixMotors(mixerTricopter, TRI_MOTOR_COUNT, true, throttle, motorOutputMin, motorOutputMax, mixerInversion, airmodeIsActive, vbatCompensationFactor);
+        return;
+    case TRI_FAST_PATH_3D:
+        mixMotors(mixerTricopter3D, TRI_MOTOR_COUNT, true, throttle, motorOutputMin, motorOutputMax, mixerInversion, airmodeIsActive, vbatCompensationFactor);
+        return;
+    default:
+        break;
+    }
+#endif
+
+    mixMotors(currentMixer, motorCount, false, throttle, motorOutputMin, motorOutputMax, mixerInversion, airmodeIsActive, vbatCompensationFactor);
+}
+
 uint16_t convertExternalToMotor(uint16_t externalValue)
 {
     uint16_t motorValue = externalValue;
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "common/maths.h"
+
 #define MAX_SUPPORTED_MOTORS 12
 
 #define QUAD_MOTOR_COUNT 4
@@ -120,6 +122,9 @@ struct rxConfig_s;
 uint8_t getMotorCount();
 float getMotorMixRange();
 bool mixerIsOutputSaturated(int axis, float errorRate);
+#ifdef USE_FIXED_POINT_PID
+bool mixerIsOutputSaturatedFix(int axis, fix16_t errorRate);
+#endif
 
 void mixerUseConfigs(
         flight3DConfig_t *flight3DConfigToUse,
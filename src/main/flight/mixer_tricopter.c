@@ -38,6 +38,7 @@
 #include "drivers/accgyro.h"
 #include "drivers/system.h"
 #include "drivers/adc.h"
+#include "drivers/pwm_output.h"
 
 #include "rx/rx.h"
 
@@ -59,8 +60,6 @@
 #include "fc/runtime_config.h"
 #include "fc/rc_controls.h"
 
-static const uint8_t TRI_TAIL_MOTOR_INDEX = 0;
-
 // Use the first once at the top of every function that will use one of the other
 #define InitDelayMeasurement_ms() const uint32_t now_ms = millis()
 #define IsDelayElapsed_ms(timestamp_ms, delay_ms) ((uint32_t) (now_ms - timestamp_ms) >= delay_ms)
@@ -78,24 +77,46 @@ static tailTune_t tailTune = { .mode = TT_MODE_NONE };
 STATIC_UNIT_TESTED tailServo_t tailServo = { .angle = TRI_TAIL_SERVO_ANGLE_MID, .ADCChannel = ADC_RSSI };
 STATIC_UNIT_TESTED tailMotor_t tailMotor = { .virtualFeedBack = 1000.0f };
 //! Yaw output gain per servo angle. Index 0 is angle TRI_CURVE_FIRST_INDEX_ANGLE.
-static float yawOutputGainCurve[TRI_YAW_FORCE_CURVE_SIZE];
+static FAST_RAM_ZERO_INIT float yawOutputGainCurve[TRI_YAW_FORCE_CURVE_SIZE];
 //! Tail motor correction per servo angle. Index 0 is angle TRI_CURVE_FIRST_INDEX_ANGLE.
-static float motorPitchCorrectionCurve[TRI_YAW_FORCE_CURVE_SIZE];
+static FAST_RAM_ZERO_INIT float motorPitchCorrectionCurve[TRI_YAW_FORCE_CURVE_SIZE];
+#ifdef USE_FIXED_POINT_PID
+//! Fixed point copies of the curves above, for the per loop lookups on targets without an FPU.
+static FAST_RAM_ZERO_INIT fix16_t yawOutputGainCurveFix[TRI_YAW_FORCE_CURVE_SIZE];
+static FAST_RAM_ZERO_INIT fix16_t motorPitchCorrectionCurveFix[TRI_YAW_FORCE_CURVE_SIZE];
+//! Tail motor correction per servo angle without the yaw boost gain.
+static FAST_RAM_ZERO_INIT fix16_t pitchCorrectionCurveFix[TRI_YAW_FORCE_CURVE_SIZE];
+static q30_t thrustCoefficientFix; //!< 2 / outputRange, see motorToThrust()
+static fix16_t pitchCorrectionGainFix;
+static fix16_t angleAtLinearMinFix;
+static fix16_t angleAtLinearMaxFix;
+#endif
 //! Configured output throttle range (max - min)
 static triMixerConfig_t *gpTriMixerConfig;
 static uint32_t preventArmingFlags = 0;
+#ifdef USE_TAIL_IDENTIFICATION
+static tailId_t tailId;
+#endif
 
 static void initYawForceCurve(void);
 STATIC_UNIT_TESTED uint16_t getServoValueAtAngle(servoParam_t *servoConf, float angle);
-static float getPitchCorrectionAtTailAngle(float angle, float thrustFactor);
+STATIC_UNIT_TESTED float getPitchCorrectionAtTailAngle(float angle, float thrustFactor);
+#if !defined(USE_FIXED_POINT_PID) || defined(UNIT_TEST)
 STATIC_UNIT_TESTED float getAngleForYawOutput(float yawOutput);
+#endif
+#ifdef USE_FIXED_POINT_PID
+STATIC_UNIT_TESTED float getAngleForYawOutputFix(float yawOutput);
+STATIC_UNIT_TESTED fix16_t getPitchCorrectionAtTailAngleFix(fix16_t angle);
+#endif
 STATIC_UNIT_TESTED float getServoAngle(servoParam_t *servoConf, uint16_t servoValue);
 STATIC_UNIT_TESTED float binarySearchOutput(float yawOutput, float motorWoPitchCorr);
 STATIC_UNIT_TESTED uint16_t getLinearServoValue(servoParam_t *servoConf, float scaledPIDOutput, float pidSumLimit);
 static uint16_t getNormalServoValue(servoParam_t *servoConf, float constrainedPIDOutput, float pidSumLimit);
 static float virtualServoStep(float currentAngle, int16_t servoSpeed, float dT, servoParam_t *servoConf,
         uint16_t servoValue);
-static float feedbackServoStep(triMixerConfig_t *mixerConf, uint16_t tailServoADC);
+STATIC_UNIT_TESTED float virtualServoStepPhased(float currentAngle, int16_t servoSpeed, float dT, servoParam_t *servoConf,
+        const servoPulse_t *pulse);
+static float feedbackServoStep(triMixerConfig_t *mixerConf, float tailServoADC);
 STATIC_UNIT_TESTED void tailTuneModeThrustTorque(thrustTorque_t *pTT, const bool isThrottleHigh);
 static void tailTuneModeServoSetup(struct servoSetup_t *pSS, servoParam_t *pServoConf, int16_t *pServoVal);
 static void triTailTuneStep(servoParam_t *pServoConf, int16_t *pServoVal);
@@ -106,6 +127,9 @@ static void tailMotorStep(int16_t setpoint, float dT);
 static int8_t triGetServoDirection(void);
 static void preventArming(triArmingPreventFlag_e flag, _Bool enable);
 static void checkArmingPrevent(void);
+#ifdef USE_TAIL_IDENTIFICATION
+static void tailIdSample(void);
+#endif
 #if USE_AUX_CHANNEL_TUNING
 static int16_t scaleAUXChannel(u8 channel, int16_t scale);
 #endif
@@ -137,6 +161,9 @@ void triInitFilters()
     const float dT = getdT();
     pt1FilterInit(&tailMotor.feedbackFilter, TRI_MOTOR_FEEDBACK_LPF_CUTOFF_HZ, dT);
     pt1FilterInit(&tailServo.feedbackFilter, TRI_SERVO_FEEDBACK_LPF_CUTOFF_HZ, dT);
+#ifdef USE_TAIL_IDENTIFICATION
+    tailIdInit(&tailId, lrintf(dT * 1000000.0f), gpTriMixerConfig->tri_servo_feedback != TRI_SERVO_FB_VIRTUAL);
+#endif
 }
 
 static float motorToThrust(float motor)
@@ -185,6 +212,20 @@ static void initYawForceCurve(void)
 
     tailServo.angleAtLinearMin = minLinearAngle;
     tailServo.angleAtLinearMax = maxLinearAngle;
+
+#ifdef USE_FIXED_POINT_PID
+    angle = TRI_CURVE_FIRST_INDEX_ANGLE;
+    for (int32_t i = 0; i < TRI_YAW_FORCE_CURVE_SIZE; i++) {
+        yawOutputGainCurveFix[i] = fix16FromFloat(yawOutputGainCurve[i]);
+        motorPitchCorrectionCurveFix[i] = fix16FromFloat(motorPitchCorrectionCurve[i]);
+        pitchCorrectionCurveFix[i] = fix16FromFloat(getPitchCorrectionAtTailAngle(DEGREES_TO_RADIANS(angle), tailServo.thrustFactor));
+        angle++;
+    }
+    thrustCoefficientFix = q30FromFloat(2.0f / MAX(tailMotor.outputRange, 1));
+    pitchCorrectionGainFix = fix16FromFloat(tailMotor.pitchCorrectionGain);
+    angleAtLinearMinFix = fix16FromFloat(tailServo.angleAtLinearMin);
+    angleAtLinearMaxFix = fix16FromFloat(tailServo.angleAtLinearMax);
+#endif
 }
 
 float triGetCurrentServoAngle(void)
@@ -196,7 +237,11 @@ STATIC_UNIT_TESTED uint16_t getLinearServoValue(servoParam_t *servoConf, float s
 {
     // maxYawOutput is the maximum output we can get at zero motor output with the pitch correction
     const float yawOutput = tailServo.maxYawOutput * scaledPIDOutput / pidSumLimit;
+#ifdef USE_FIXED_POINT_PID
+    const float correctedAngle = getAngleForYawOutputFix(yawOutput);
+#else
     const float correctedAngle = getAngleForYawOutput(yawOutput);
+#endif
     const uint16_t linearServoValue = getServoValueAtAngle(servoConf, correctedAngle);
 
     DEBUG_SET(DEBUG_TRI, DEBUG_TRI_SERVO_OUTPUT_ANGLE_OR_TAIL_TUNE_STATE, correctedAngle * 10);
@@ -235,9 +280,29 @@ void triServoMixer(float scaledYawPid, float pidSumLimit)
     // Check for tail motor decelaration and determine expected produced yaw error
     predictGyroOnDeceleration();
 
+#ifdef USE_TAIL_IDENTIFICATION
+    tailIdSample();
+#endif
+
     checkArmingPrevent();
 }
 
+#ifdef USE_TAIL_IDENTIFICATION
+void triTailIdProcess(void)
+{
+    tailIdProcess(&tailId);
+}
+
+_Bool triGetTailIdEstimate(tailIdEstimate_t *estimate)
+{
+    if (!triMixerInUse()) {
+        return false;
+    }
+    tailIdGetEstimate(&tailId, estimate);
+    return true;
+}
+#endif
+
 int16_t triGetMotorCorrection(uint8_t motorIndex)
 {
     uint16_t correction = 0;
@@ -249,6 +314,16 @@ int16_t triGetMotorCorrection(uint8_t motorIndex)
         // Take motor speed up lag into account by shifting the phase of the curve
         // Not taking into account the motor braking lag (yet)
         const float servoAngle = triGetCurrentServoAngle();
+#ifdef USE_FIXED_POINT_PID
+        fix16_t correctionFix = getPitchCorrectionAtTailAngleFix(fix16FromFloat(servoAngle));
+
+        // Multiply the correction to get more authority (yaw boost)
+        if (isAirmodeActive() && tailServo.feedbackHealthy)
+        {
+            correctionFix = fix16Mul(correctionFix, pitchCorrectionGainFix);
+        }
+        correction = MAX(correctionFix, 0) >> 16;
+#else
         correction = getPitchCorrectionAtTailAngle(DEGREES_TO_RADIANS(servoAngle), tailServo.thrustFactor);
 
         // Multiply the correction to get more authority (yaw boost)
@@ -256,6 +331,7 @@ int16_t triGetMotorCorrection(uint8_t motorIndex)
         {
             correction *= tailMotor.pitchCorrectionGain;
         }
+#endif
         tailMotor.lastCorrection = correction;
         DEBUG_SET(DEBUG_TRI, DEBUG_TRI_MOTOR_CORRECTION, 1000 + correction);
     }
@@ -286,6 +362,13 @@ _Bool triIsServoSaturated(float rateError)
     }
 }
 
+#ifdef USE_FIXED_POINT_PID
+_Bool triIsServoSaturatedFix(fix16_t rateError)
+{
+    return ABS(rateError) > (fix16_t)(TRI_SERVO_SATURED_GYRO_ERROR * Q16);
+}
+#endif
+
 STATIC_UNIT_TESTED uint16_t getServoValueAtAngle(servoParam_t *servoConf, float angle)
 {
     const float servoMid = servoConf->middle;
@@ -328,7 +411,7 @@ STATIC_UNIT_TESTED uint16_t getServoValueAtAngle(servoParam_t *servoConf, float
     return servoValue;
 }
 
-static float getPitchCorrectionAtTailAngle(float angle, float thrustFactor)
+STATIC_UNIT_TESTED float getPitchCorrectionAtTailAngle(float angle, float thrustFactor)
 {
     const float pitchCorrection = 1.0f / (sin_approx(angle) - cos_approx(angle) / thrustFactor);
     const float motorCorrection = (tailMotor.outputRange * pitchCorrection) - tailMotor.outputRange;
@@ -358,6 +441,7 @@ STATIC_UNIT_TESTED float binarySearchOutput(float yawOutput, float motorWoPitchC
     return angle;
 }
 
+#if !defined(USE_FIXED_POINT_PID) || defined(UNIT_TEST)
 STATIC_UNIT_TESTED float getAngleForYawOutput(float yawOutput)
 {
     float angle;
@@ -383,6 +467,82 @@ STATIC_UNIT_TESTED float getAngleForYawOutput(float yawOutput)
 
     return angle;
 }
+#endif
+
+#ifdef USE_FIXED_POINT_PID
+static fix16_t motorToThrustFix(fix16_t motor)
+{
+    return fix16Add(motor, fix16Mul(motor, fix16MulQ30(motor, thrustCoefficientFix)));
+}
+
+// Yaw output at a curve index in Q32, out of the fix16 range at full thrust
+static int64_t yawOutputAtIndexFix(int32_t index, fix16_t motorWoPitchCorr)
+{
+    return (int64_t)motorToThrustFix(fix16Add(motorWoPitchCorr, motorPitchCorrectionCurveFix[index])) * yawOutputGainCurveFix[index];
+}
+
+// num / den in Q16 for 0 <= num <= den, both scaled down first so a 32 bit division does
+static fix16_t interpolationFractionFix(int64_t num, int64_t den)
+{
+    if (den <= 0) {
+        return 0;
+    }
+    if (num < 0) {
+        num = 0;
+    } else if (num > den) {
+        num = den;
+    }
+    const int shift = MAX(0, 49 - __builtin_clzll(den));
+    return ((int32_t)(num >> shift) << 16) / (int32_t)(den >> shift);
+}
+
+STATIC_UNIT_TESTED float getAngleForYawOutputFix(float yawOutput)
+{
+    const int64_t output = (int64_t)fix16FromFloat(yawOutput) * Q16;
+    fix16_t angle;
+
+    fix16_t motorWoPitchCorr = fix16FromFloat(tailMotor.virtualFeedBack) - (tailMotor.minOutput + tailMotor.lastCorrection) * Q16;
+    motorWoPitchCorr = MAX(tailMotor.linearMinOutput * Q16, motorWoPitchCorr);
+    if (output < yawOutputAtIndexFix(0, motorWoPitchCorr)) {
+        // No force that low
+        angle = angleAtLinearMinFix;
+    } else if (output > yawOutputAtIndexFix(TRI_YAW_FORCE_CURVE_SIZE - 1, motorWoPitchCorr)) {
+        // No force that high
+        angle = angleAtLinearMaxFix;
+    } else {
+        // Binary search: output at lower <= output, output at higher > output
+        int32_t lower = 0;
+        int32_t higher = TRI_YAW_FORCE_CURVE_SIZE - 1;
+        while (higher > lower + 1) {
+            const int32_t mid = (lower + higher) / 2;
+            if (yawOutputAtIndexFix(mid, motorWoPitchCorr) > output) {
+                higher = mid;
+            } else {
+                lower = mid;
+            }
+        }
+
+        // Interpolating
+        const int64_t outputLow = yawOutputAtIndexFix(lower, motorWoPitchCorr);
+        const int64_t outputHigh = yawOutputAtIndexFix(higher, motorWoPitchCorr);
+        angle = (TRI_CURVE_FIRST_INDEX_ANGLE + lower) * Q16 + interpolationFractionFix(output - outputLow, outputHigh - outputLow);
+        angle = constrain(angle, angleAtLinearMinFix, angleAtLinearMaxFix);
+    }
+
+    return fix16ToFloat(angle);
+}
+
+// Interpolates the correction curve in one degree steps with a Q15 fraction, instead of sin/cos every loop
+STATIC_UNIT_TESTED fix16_t getPitchCorrectionAtTailAngleFix(fix16_t angle)
+{
+    const int32_t position = constrain(angle - TRI_CURVE_FIRST_INDEX_ANGLE * Q16, 0, (TRI_YAW_FORCE_CURVE_SIZE - 1) * Q16 - 1);
+    const int32_t index = position >> 16;
+    const int32_t fraction = (position & (Q16 - 1)) >> 1;
+    const fix16_t low = pitchCorrectionCurveFix[index];
+
+    return low + (fix16_t)(((int64_t)(pitchCorrectionCurveFix[index + 1] - low) * fraction) >> 15);
+}
+#endif
 
 STATIC_UNIT_TESTED float getServoAngle(servoParam_t *servoConf, uint16_t servoValue)
 {
@@ -414,10 +574,25 @@ static float virtualServoStep(float currentAngle, int16_t servoSpeed, float dT,
     return currentAngle;
 }
 
-static float feedbackServoStep(triMixerConfig_t *mixerConf, uint16_t tailServoADC)
+// The servo moves towards a new command only once the pulse carrying it has ended. Over the last dT it was
+// moving towards the previous command until then, which is up to a whole refresh period at low servo rates.
+STATIC_UNIT_TESTED float virtualServoStepPhased(float currentAngle, int16_t servoSpeed, float dT, servoParam_t *servoConf,
+        const servoPulse_t *pulse)
+{
+    const float age = pulse->ageUs * 1e-6f;
+
+    if (age >= dT || !pulse->previousValue) {
+        return virtualServoStep(currentAngle, servoSpeed, dT, servoConf, pulse->value);
+    }
+
+    currentAngle = virtualServoStep(currentAngle, servoSpeed, dT - age, servoConf, pulse->previousValue);
+    return virtualServoStep(currentAngle, servoSpeed, age, servoConf, pulse->value);
+}
+
+static float feedbackServoStep(triMixerConfig_t *mixerConf, float tailServoADC)
 {
     // Feedback servo
-    const int32_t ADCFeedback = tailServoADC;
+    const float ADCFeedback = tailServoADC;
     const int16_t midValue = mixerConf->tri_servo_mid_adc;
     const int16_t endValue = ADCFeedback < midValue ? mixerConf->tri_servo_min_adc : mixerConf->tri_servo_max_adc;
     const float tailServoMaxAngle = tailServo.pConf->angleAtMax;
@@ -748,12 +923,29 @@ static void tailTuneModeServoSetup(struct servoSetup_t *pSS, servoParam_t *pServ
 static void updateServoAngle(float dT)
 {
     if (gpTriMixerConfig->tri_servo_feedback == TRI_SERVO_FB_VIRTUAL) {
-        tailServo.angle = virtualServoStep(tailServo.angle, tailServo.speed, dT, tailServo.pConf, *tailServo.pOutput);
+        // Follow what the servo was actually sent and when, rather than the last output of the mixer
+        servoPulse_t pulse;
+        if (pwmGetServoPulse(TRI_TAIL_SERVO_OUTPUT_INDEX, &pulse) && pulse.value) {
+            tailServo.angle = virtualServoStepPhased(tailServo.angle, tailServo.speed, dT, tailServo.pConf, &pulse);
+        } else {
+            tailServo.angle = virtualServoStep(tailServo.angle, tailServo.speed, dT, tailServo.pConf, *tailServo.pOutput);
+        }
     } else {
-        // Read new servo feedback signal sample and run it through filter
-        const uint16_t ADCRaw = pt1FilterApply(&tailServo.feedbackFilter, adcGetChannel(tailServo.ADCChannel));
-        tailServo.angle = feedbackServoStep(gpTriMixerConfig, ADCRaw);
-        tailServo.ADCRaw = ADCRaw;
+        // Average the feedback conversions made since the previous loop and run it through filter.
+        // Fall back to the latest conversion when none has completed since then.
+        adcOversample_t feedback;
+        float feedbackADC;
+        if (adcGetOversampledChannel(tailServo.ADCChannel, &feedback)) {
+            feedbackADC = feedback.average;
+            tailServo.angleNoise = ABS(feedbackServoStep(gpTriMixerConfig, feedback.average + feedback.noise)
+                    - feedbackServoStep(gpTriMixerConfig, feedback.average));
+            tailServo.angleReadTimeUs = feedback.readTimeUs;
+        } else {
+            feedbackADC = adcGetChannel(tailServo.ADCChannel);
+        }
+        const float ADCFiltered = pt1FilterApply(&tailServo.feedbackFilter, feedbackADC);
+        tailServo.angle = feedbackServoStep(gpTriMixerConfig, ADCFiltered);
+        tailServo.ADCRaw = lrintf(ADCFiltered);
     }
 
     if ((tailServo.angle < (TRI_TAIL_SERVO_INVALID_ANGLE_MIN)) ||
@@ -839,6 +1031,27 @@ static void tailMotorStep(int16_t setpoint, float dT)
     DEBUG_SET(DEBUG_TRI, DEBUG_TRI_TAIL_MOTOR, tailMotor.virtualFeedBack);
 }
 
+#ifdef USE_TAIL_IDENTIFICATION
+static void tailIdSample(void)
+{
+    // Only learn from flight, tail tune moves the tail on its own
+    if (!ARMING_FLAG(ARMED) || tailTune.mode != TT_MODE_NONE || tailMotor.outputRange == 0) {
+        tailIdBreak(&tailId);
+        return;
+    }
+
+    // The angle was measured before this loop's output, which the servo gets next
+    const tailIdSample_t sample = {
+        .servoCommand = getServoAngle(tailServo.pConf, *tailServo.pOutput) - TRI_TAIL_SERVO_ANGLE_MID,
+        .servoAngle = tailServo.angle - TRI_TAIL_SERVO_ANGLE_MID,
+        .motor = (float)(motor[TRI_TAIL_MOTOR_INDEX] - tailMotor.minOutput) / tailMotor.outputRange,
+        .yawRate = gyro.gyroADCf[FD_YAW],
+        .restart = false,
+    };
+    tailIdPush(&tailId, &sample);
+}
+#endif
+
 static int8_t triGetServoDirection(void)
 {
     const int8_t direction = (int8_t) servoDirection(SERVO_RUDDER, INPUT_STABILIZED_YAW);
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "servos.h"
+#include "flight/tail_identification.h"
 
 #define TAIL_THRUST_FACTOR_MIN  (10)
 #define TAIL_THRUST_FACTOR_MAX  (400)
@@ -27,6 +28,10 @@
 
 #define TRI_MOTOR_ACC_CORRECTION_MAX  (200)
 
+#define TRI_MOTOR_COUNT         (3)
+#define TRI_TAIL_MOTOR_INDEX    (0)     // only motor that gets a correction from triGetMotorCorrection()
+#define TRI_TAIL_SERVO_OUTPUT_INDEX (0) // servo output written by writeServos() for MIXER_TRI
+
 /** @brief Servo feedback sources. */
 typedef enum {
     TRI_SERVO_FB_VIRTUAL = 0,  // Virtual servo, no physical feedback signal from servo
@@ -95,6 +100,24 @@ _Bool triMixerInUse(void);
  *  @return true if is, otherwise false.
  */
 _Bool triIsServoSaturated(float rateError);
+#ifdef USE_FIXED_POINT_PID
+_Bool triIsServoSaturatedFix(fix16_t rateError);
+#endif
+
+/** @brief Run the tail identification over the samples pushed by the mixer.
+ *
+ *  @note Called from a low priority task.
+ *
+ *  @return Void.
+ */
+void triTailIdProcess(void);
+
+/** @brief Get the identified tail servo and motor parameters.
+ *
+ *  @param estimate Filled with the estimates and their confidence.
+ *  @return true if the tricopter mixer runs the identification, otherwise false.
+ */
+_Bool triGetTailIdEstimate(tailIdEstimate_t *estimate);
 
 typedef struct triMixerConfig_s{
     uint8_t tri_unarmed_servo;              // send tail servo correction pulses even when unarmed
@@ -120,7 +143,7 @@ typedef struct triMixerConfig_s{
 #define TRI_YAW_FORCE_CURVE_SIZE                (80 + 1)
 #define TRI_CURVE_FIRST_INDEX_ANGLE             (TRI_TAIL_SERVO_ANGLE_MID - TRI_TAIL_SERVO_MAX_ANGLE)
 #define TRI_SERVO_SATURATION_DPS_ERROR_LIMIT    (100.0f)
-#define TRI_SERVO_FEEDBACK_LPF_CUTOFF_HZ        (70)
+#define TRI_SERVO_FEEDBACK_LPF_CUTOFF_HZ        (150)
 #define TRI_MOTOR_FEEDBACK_LPF_CUTOFF_HZ        (5)
 #define TRI_TAIL_TUNE_MIN_DEADBAND              (12)
 #define TRI_SERVO_SATURED_GYRO_ERROR            (75.0f)
@@ -196,6 +219,8 @@ typedef struct tailServo_s {
     float angleAtLinearMin;
     float angleAtLinearMax;
     float angle; //!< Current measured angle
+    float angleNoise; //!< Standard deviation of the feedback behind the angle, in degrees
+    timeUs_t angleReadTimeUs; //!< When the feedback behind the angle was read from the ADC buffer
     uint16_t ADCRaw;
 } tailServo_t;
 
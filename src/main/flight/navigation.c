@@ -43,6 +43,7 @@
 #include "io/beeper.h"
 #include "io/serial.h"
 #include "io/gps.h"
+#include "io/gps_ubx.h"
 
 #include "flight/pid.h"
 #include "flight/navigation.h"
@@ -484,7 +485,12 @@ static void GPS_calc_velocity(void)
     // y_GPS_speed positive = Up
     // x_GPS_speed positive = Right
 
-    if (init) {
+    const ubxNavPvt_t *navPvt = gpsGetNavPvt();
+    if (navPvt) {
+        // the receiver's own velocity solution, no need to differentiate positions
+        actual_speed[GPS_X] = navPvt->velE / 10;    // mm/s to cm/s
+        actual_speed[GPS_Y] = navPvt->velN / 10;
+    } else if (init) {
         float tmp = 1.0f / dTnav;
         actual_speed[GPS_X] = (float)(GPS_coord[LON] - last_coord[LON]) * GPS_scaleLonDown * tmp;
         actual_speed[GPS_Y] = (float)(GPS_coord[LAT] - last_coord[LAT]) * tmp;
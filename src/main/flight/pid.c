@@ -48,10 +48,18 @@ static bool pidStabilisationEnabled;
 
 float axisPID_P[3], axisPID_I[3], axisPID_D[3];
 
-static float expectedGyroError[3] = {0.0f};
+static FAST_RAM_ZERO_INIT float expectedGyroError[3];
 
 static float dT;
 
+#ifdef USE_FIXED_POINT_PID
+fix16_t axisPIDFix_P[3], axisPIDFix_I[3], axisPIDFix_D[3];
+
+static FAST_RAM_ZERO_INIT fix16_t expectedGyroErrorFix[3];
+// I term accumulators, Q16 error times Q30 gain
+static FAST_RAM_ZERO_INIT int64_t itermFix[3];
+#endif
+
 void pidSetTargetLooptime(uint32_t pidLooptime)
 {
     targetPidLooptime = pidLooptime;
@@ -62,6 +70,10 @@ void pidResetErrorGyroState(void)
 {
     for (int axis = 0; axis < 3; axis++) {
         axisPID_I[axis] = 0.0f;
+#ifdef USE_FIXED_POINT_PID
+        itermFix[axis] = 0;
+        axisPIDFix_I[axis] = 0;
+#endif
     }
 }
 
@@ -83,25 +95,104 @@ float getdT()
 
 const angle_index_t rcAliasToAngleIndexMap[] = { AI_ROLL, AI_PITCH };
 
+// The float controller is left out of fixed point builds, the unit tests keep it to compare against
+#if !defined(USE_FIXED_POINT_PID) || defined(UNIT_TEST)
+#define USE_FLOAT_PID
+#endif
+
+#ifdef USE_FLOAT_PID
 static filterApplyFnPtr dtermNotchFilterApplyFn;
-static void *dtermFilterNotch[3];
+static FAST_RAM_ZERO_INIT void *dtermFilterNotch[3];
 static filterApplyFnPtr dtermLpfApplyFn;
-static void *dtermFilterLpf[3];
+static FAST_RAM_ZERO_INIT void *dtermFilterLpf[3];
 static filterApplyFnPtr ptermYawFilterApplyFn;
 static void *ptermYawFilter;
+#endif
 
-void pidInitFilters(const pidProfile_t *pidProfile)
+#ifdef USE_FIXED_POINT_PID
+static filterApplyFixFnPtr dtermNotchFilterApplyFixFn;
+static FAST_RAM_ZERO_INIT void *dtermFilterNotchFix[3];
+static filterApplyFixFnPtr dtermLpfApplyFixFn;
+static FAST_RAM_ZERO_INIT void *dtermFilterLpfFix[3];
+static filterApplyFixFnPtr ptermYawFilterApplyFixFn;
+static void *ptermYawFilterFix;
+
+static void pidInitFiltersFix(const pidProfile_t *pidProfile, uint32_t pidFrequencyNyquist)
 {
-    static biquadFilter_t biquadFilterNotch[3];
-    static pt1Filter_t pt1Filter[3];
-    static biquadFilter_t biquadFilter[3];
-    static firFilterDenoise_t denoisingFilter[3];
-    static pt1Filter_t pt1FilterYaw;
+    static FAST_RAM_ZERO_INIT biquadFilterFix_t biquadFilterNotch[3];
+    static FAST_RAM_ZERO_INIT pt1FilterFix_t pt1Filter[3];
+    static FAST_RAM_ZERO_INIT biquadFilterFix_t biquadFilter[3];
+    static firFilterDenoiseFix_t denoisingFilter[3];
+    static FAST_RAM_ZERO_INIT pt1FilterFix_t pt1FilterYaw;
+
+    if (pidProfile->dterm_notch_hz == 0 || pidProfile->dterm_notch_hz > pidFrequencyNyquist) {
+        dtermNotchFilterApplyFixFn = nullFilterApplyFix;
+    } else {
+        dtermNotchFilterApplyFixFn = (filterApplyFixFnPtr)biquadFilterApplyFix;
+        const float notchQ = filterGetNotchQ(pidProfile->dterm_notch_hz, pidProfile->dterm_notch_cutoff);
+        for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+            dtermFilterNotchFix[axis] = &biquadFilterNotch[axis];
+            biquadFilterInitFix(dtermFilterNotchFix[axis], pidProfile->dterm_notch_hz, targetPidLooptime, notchQ, FILTER_NOTCH);
+        }
+    }
 
+    if (pidProfile->dterm_lpf_hz == 0 || pidProfile->dterm_lpf_hz > pidFrequencyNyquist) {
+        dtermLpfApplyFixFn = nullFilterApplyFix;
+    } else {
+        switch (pidProfile->dterm_filter_type) {
+        default:
+            dtermLpfApplyFixFn = nullFilterApplyFix;
+            break;
+        case FILTER_PT1:
+            dtermLpfApplyFixFn = (filterApplyFixFnPtr)pt1FilterApplyFix;
+            for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+                dtermFilterLpfFix[axis] = &pt1Filter[axis];
+                pt1FilterInitFix(dtermFilterLpfFix[axis], pidProfile->dterm_lpf_hz, dT);
+            }
+            break;
+        case FILTER_BIQUAD:
+            dtermLpfApplyFixFn = (filterApplyFixFnPtr)biquadFilterApplyFix;
+            for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+                dtermFilterLpfFix[axis] = &biquadFilter[axis];
+                biquadFilterInitLPFFix(dtermFilterLpfFix[axis], pidProfile->dterm_lpf_hz, targetPidLooptime);
+            }
+            break;
+        case FILTER_FIR:
+            dtermLpfApplyFixFn = (filterApplyFixFnPtr)firFilterDenoiseUpdateFix;
+            for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+                dtermFilterLpfFix[axis] = &denoisingFilter[axis];
+                firFilterDenoiseInitFix(dtermFilterLpfFix[axis], pidProfile->dterm_lpf_hz, targetPidLooptime);
+            }
+            break;
+        }
+    }
+
+    if (pidProfile->yaw_lpf_hz == 0 || pidProfile->yaw_lpf_hz > pidFrequencyNyquist) {
+        ptermYawFilterApplyFixFn = nullFilterApplyFix;
+    } else {
+        ptermYawFilterApplyFixFn = (filterApplyFixFnPtr)pt1FilterApplyFix;
+        ptermYawFilterFix = &pt1FilterYaw;
+        pt1FilterInitFix(ptermYawFilterFix, pidProfile->yaw_lpf_hz, dT);
+    }
+}
+#endif
+
+void pidInitFilters(const pidProfile_t *pidProfile)
+{
     uint32_t pidFrequencyNyquist = (1.0f / dT) / 2; // No rounding needed
 
     BUILD_BUG_ON(FD_YAW != 2); // only setting up Dterm filters on roll and pitch axes, so ensure yaw axis is 2
 
+#ifdef USE_FIXED_POINT_PID
+    pidInitFiltersFix(pidProfile, pidFrequencyNyquist);
+#endif
+#ifdef USE_FLOAT_PID
+    static FAST_RAM_ZERO_INIT biquadFilter_t biquadFilterNotch[3];
+    static FAST_RAM_ZERO_INIT pt1Filter_t pt1Filter[3];
+    static FAST_RAM_ZERO_INIT biquadFilter_t biquadFilter[3];
+    static firFilterDenoise_t denoisingFilter[3];
+    static FAST_RAM_ZERO_INIT pt1Filter_t pt1FilterYaw;
+
     if (pidProfile->dterm_notch_hz == 0 || pidProfile->dterm_notch_hz > pidFrequencyNyquist) {
         dtermNotchFilterApplyFn = nullFilterApply;
     } else {
@@ -151,19 +242,33 @@ void pidInitFilters(const pidProfile_t *pidProfile)
         ptermYawFilter = &pt1FilterYaw;
         pt1FilterInit(ptermYawFilter, pidProfile->yaw_lpf_hz, dT);
     }
+#endif
 }
 
-static float Kp[3], Ki[3], Kd[3], maxVelocity[3];
+static FAST_RAM_ZERO_INIT float Kp[3], Ki[3], Kd[3], maxVelocity[3];
 static float relaxFactor;
 static float dtermSetpointWeight;
 static float levelGain, horizonGain, horizonTransition, ITermWindupPoint, ITermWindupPointInv;
 static bool tricopterServoMixerInUse = false;
 
+#ifdef USE_FIXED_POINT_PID
+// Ki and Kd are folded with dT so the loop has no division
+static FAST_RAM_ZERO_INIT fix16_t KpFix[3], KdPerDtFix[3], maxVelocityFix[3];
+static FAST_RAM_ZERO_INIT q30_t KiDtFix[3];
+static fix16_t relaxFactorFix, dtermSetpointWeightFix;
+static fix16_t levelGainFix, horizonGainFix, horizonTransitionFix;
+#endif
+
 void pidInitConfig(const pidProfile_t *pidProfile) {
     for(int axis = FD_ROLL; axis <= FD_YAW; axis++) {
         Kp[axis] = PTERM_SCALE * pidProfile->P8[axis];
         Ki[axis] = ITERM_SCALE * pidProfile->I8[axis];
         Kd[axis] = DTERM_SCALE * pidProfile->D8[axis];
+#ifdef USE_FIXED_POINT_PID
+        KpFix[axis] = fix16FromFloat(Kp[axis]);
+        KiDtFix[axis] = q30FromFloat(Ki[axis] * dT);
+        KdPerDtFix[axis] = fix16FromFloat(Kd[axis] / dT);
+#endif
     }
     dtermSetpointWeight = pidProfile->dtermSetpointWeight / 127.0f;
     relaxFactor = 1.0f / (pidProfile->setpointRelaxRatio / 100.0f);
@@ -174,10 +279,21 @@ void pidInitConfig(const pidProfile_t *pidProfile) {
     maxVelocity[FD_YAW] = pidProfile->yawRateAccelLimit * 1000 * dT;
     ITermWindupPoint = (float)pidProfile->itermWindupPointPercent / 100.0f;
     ITermWindupPointInv = 1.0f / (1.0f - ITermWindupPoint);
+#ifdef USE_FIXED_POINT_PID
+    for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+        maxVelocityFix[axis] = fix16FromFloat(maxVelocity[axis]);
+    }
+    relaxFactorFix = fix16FromFloat(relaxFactor);
+    dtermSetpointWeightFix = fix16FromFloat(dtermSetpointWeight);
+    levelGainFix = fix16FromFloat(levelGain);
+    horizonGainFix = fix16FromFloat(horizonGain);
+    horizonTransitionFix = fix16FromFloat(horizonTransition);
+#endif
 
     tricopterServoMixerInUse = triMixerInUse();
 }
 
+#ifdef USE_FLOAT_PID
 static float calcHorizonLevelStrength(void) {
     float horizonLevelStrength = 0.0f;
     if (horizonTransition > 0.0f) {
@@ -221,9 +337,9 @@ static float accelerationLimit(int axis, float currentPidSetpoint) {
 
 // Betaflight pid controller, which will be maintained in the future with additional features specialised for current (mini) multirotor usage.
 // Based on 2DOF reference design (matlab)
-void pidController(const pidProfile_t *pidProfile, const rollAndPitchTrims_t *angleTrim)
+FAST_CODE void pidController(const pidProfile_t *pidProfile, const rollAndPitchTrims_t *angleTrim)
 {
-    static float previousRateError[3];
+    static FAST_RAM_ZERO_INIT float previousRateError[3];
     const float tpaFactor = getThrottlePIDAttenuation();
     const float motorMixRange = getMotorMixRange();
 
@@ -302,7 +418,119 @@ void pidController(const pidProfile_t *pidProfile, const rollAndPitchTrims_t *an
         }
     }
 }
+
+#endif
+
+#ifdef USE_FIXED_POINT_PID
+static fix16_t calcHorizonLevelStrengthFix(void) {
+    const fix16_t mostDeflectedPos = MAX(getRcDeflectionAbsFix(FD_ROLL), getRcDeflectionAbsFix(FD_PITCH));
+    // Progressively turn off the horizon self level strength as the stick is banged over
+    return constrain(fix16Add(Q16, -fix16Mul(mostDeflectedPos, horizonTransitionFix)), 0, Q16);
+}
+
+static fix16_t pidLevelFix(int axis, const pidProfile_t *pidProfile, const rollAndPitchTrims_t *angleTrim, fix16_t currentPidSetpoint) {
+    // calculate error angle and limit the angle to the max inclination
+    fix16_t errorAngle = pidProfile->levelSensitivity * getRcDeflectionFix(axis);
+#ifdef GPS
+    errorAngle += GPS_angle[axis] * Q16;
+#endif
+    errorAngle = constrain(errorAngle, -pidProfile->levelAngleLimit * Q16, pidProfile->levelAngleLimit * Q16);
+    errorAngle -= (attitude.raw[axis] - angleTrim->raw[axis]) * Q16 / 10;
+    if (FLIGHT_MODE(ANGLE_MODE)) {
+        currentPidSetpoint = fix16Mul(errorAngle, levelGainFix);
+    } else {
+        currentPidSetpoint = fix16Add(currentPidSetpoint, fix16Mul(fix16Mul(errorAngle, horizonGainFix), calcHorizonLevelStrengthFix()));
+    }
+    return currentPidSetpoint;
+}
+
+static fix16_t accelerationLimitFix(int axis, fix16_t currentPidSetpoint) {
+    static fix16_t previousSetpoint[3];
+    const fix16_t currentVelocity = fix16Add(currentPidSetpoint, -previousSetpoint[axis]);
+
+    if (ABS(currentVelocity) > maxVelocityFix[axis])
+        currentPidSetpoint = (currentVelocity > 0) ? previousSetpoint[axis] + maxVelocityFix[axis] : previousSetpoint[axis] - maxVelocityFix[axis];
+
+    previousSetpoint[axis] = currentPidSetpoint;
+    return currentPidSetpoint;
+}
+
+// Same controller as pidController() in Q16.16, for targets without an FPU. The setpoints and
+// TPA come converted from fc_rc.c, the terms go to axisPIDFix_P/I/D for the mixer and blackbox.
+FAST_CODE void pidControllerFixed(const pidProfile_t *pidProfile, const rollAndPitchTrims_t *angleTrim)
+{
+    static FAST_RAM_ZERO_INIT fix16_t previousRateError[3];
+    const fix16_t tpaFactor = getThrottlePIDAttenuationFix();
+    const float motorMixRange = getMotorMixRange();
+
+    // Dynamic ki component to gradually scale back integration when above windup point, once per loop
+    const fix16_t dynKi = fix16FromFloat(MIN((1.0f - motorMixRange) * ITermWindupPointInv, 1.0f) * itermAccelerator);
+
+    for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
+        fix16_t setpoint = getSetpointRateFix(axis);
+
+        if (maxVelocityFix[axis])
+            setpoint = accelerationLimitFix(axis, setpoint);
+
+        if ((FLIGHT_MODE(ANGLE_MODE) || FLIGHT_MODE(HORIZON_MODE)) && axis != YAW) {
+            setpoint = pidLevelFix(axis, pidProfile, angleTrim, setpoint);
+        }
+
+        const fix16_t gyroRate = gyro.gyroADCFix[axis];
+        const fix16_t errorRate = fix16Add(setpoint, -gyroRate);
+
+        // -----calculate P component
+        fix16_t PTerm = fix16Mul(KpFix[axis], fix16Add(errorRate, expectedGyroErrorFix[axis]));
+        if (axis == FD_YAW) {
+            if (!tricopterServoMixerInUse) {
+                PTerm = fix16Mul(PTerm, tpaFactor);
+            }
+            PTerm = ptermYawFilterApplyFixFn(ptermYawFilterFix, PTerm);
+        } else {
+            PTerm = fix16Mul(PTerm, tpaFactor);
+        }
+        axisPIDFix_P[axis] = PTerm;
+
+        // -----calculate I component
+        const int64_t ITermNew = itermFix[axis] + (int64_t)fix16Mul(errorRate, dynKi) * KiDtFix[axis];
+        const bool outputSaturated = mixerIsOutputSaturatedFix(axis, errorRate);
+        if (outputSaturated == false || ABS(ITermNew) < ABS(itermFix[axis])) {
+            itermFix[axis] = ITermNew;
+        }
+        axisPIDFix_I[axis] = fix16Saturate((itermFix[axis] + (Q30 / 2)) >> 30);
+
+        // -----calculate D component
+        if ((axis != FD_YAW) || triMixerInUse()) {
+            fix16_t dynC = dtermSetpointWeightFix;
+            if (pidProfile->setpointRelaxRatio < 100) {
+                dynC = fix16Mul(dynC, MIN(fix16Mul(getRcDeflectionAbsFix(axis), relaxFactorFix), Q16));
+            }
+            const fix16_t rD = fix16Add(fix16Mul(dynC, setpoint), -gyroRate);    // cr - y
+            const fix16_t delta = fix16Add(rD, -previousRateError[axis]);
+            previousRateError[axis] = rD;
+
+            fix16_t DTerm = fix16Mul(fix16Mul(KdPerDtFix[axis], delta), tpaFactor);
+            DEBUG_SET(DEBUG_DTERM_FILTER, axis, DTerm >> 16);
+
+            DTerm = dtermNotchFilterApplyFixFn(dtermFilterNotchFix[axis], DTerm);
+            axisPIDFix_D[axis] = dtermLpfApplyFixFn(dtermFilterLpfFix[axis], DTerm);
+        }
+
+        // Disable PID control at zero throttle
+        if (!pidStabilisationEnabled) {
+            itermFix[axis] = 0;
+            axisPIDFix_P[axis] = 0;
+            axisPIDFix_I[axis] = 0;
+            axisPIDFix_D[axis] = 0;
+        }
+    }
+}
+#endif
+
 void pidSetExpectedGyroError(flight_dynamics_index_t axis, float error)
 {
     expectedGyroError[axis] = error;
+#ifdef USE_FIXED_POINT_PID
+    expectedGyroErrorFix[axis] = fix16FromFloat(error);
+#endif
 }
@@ -20,6 +20,7 @@
 #include <stdbool.h>
 
 #include "common/axis.h"
+#include "common/maths.h"
 
 #define MAX_PID_PROCESS_DENOM       16
 #define PID_CONTROLLER_BETAFLIGHT   1
@@ -92,8 +93,16 @@ typedef struct pidConfig_s {
 
 union rollAndPitchTrims_u;
 void pidController(const pidProfile_t *pidProfile, const union rollAndPitchTrims_u *angleTrim);
+void pidControllerFixed(const pidProfile_t *pidProfile, const union rollAndPitchTrims_u *angleTrim);
 
 extern float axisPID_P[3], axisPID_I[3], axisPID_D[3];
+#ifdef USE_FIXED_POINT_PID
+// Written by pidControllerFixed() in place of the float terms
+extern fix16_t axisPIDFix_P[3], axisPIDFix_I[3], axisPIDFix_D[3];
+#define PID_SUM(axis) fix16ToFloat(fix16Add(fix16Add(axisPIDFix_P[axis], axisPIDFix_I[axis]), axisPIDFix_D[axis]))
+#else
+#define PID_SUM(axis) (axisPID_P[axis] + axisPID_I[axis] + axisPID_D[axis])
+#endif
 bool airmodeWasActivated;
 extern uint32_t targetPidLooptime;
 
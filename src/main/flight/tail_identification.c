@@ -0,0 +1,269 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "flight/tail_identification.h"
+
+#define TAIL_ID_INITIAL_COVARIANCE      1000.0f
+#define TAIL_ID_RESIDUAL_SMOOTHING      0.01f
+#define TAIL_ID_CONFIDENCE_GAIN         5.0f    // 20% relative standard deviation is no confidence at all
+#define TAIL_ID_SPOOL_INITIAL_S         0.032f  // TRI_MOTOR_FEEDBACK_LPF_CUTOFF_HZ
+#define TAIL_ID_SPOOL_MIN_S             0.005f
+#define TAIL_ID_SPOOL_MAX_S             0.300f
+#define TAIL_ID_SPOOL_ADAPTATION        0.05f   // of the spool error taken per sample
+#define TAIL_ID_SPOOL_STEP_MAX          0.01f   // relative
+
+void tailIdRlsInit(tailIdRls_t *rls, uint8_t count, float lambda, float initialCovariance)
+{
+    memset(rls, 0, sizeof(*rls));
+    rls->count = count;
+    rls->lambda = lambda;
+    rls->maxTrace = initialCovariance * count;
+    for (int i = 0; i < count; i++) {
+        rls->P[i][i] = initialCovariance;
+    }
+}
+
+float tailIdRlsUpdate(tailIdRls_t *rls, const float *phi, float y)
+{
+    const int n = rls->count;
+    float Pphi[TAIL_ID_RLS_MAX_PARAMS];
+    float denominator = rls->lambda;
+    float prediction = 0.0f;
+
+    for (int i = 0; i < n; i++) {
+        Pphi[i] = 0.0f;
+        for (int j = 0; j < n; j++) {
+            Pphi[i] += rls->P[i][j] * phi[j];
+        }
+        denominator += phi[i] * Pphi[i];
+        prediction += rls->theta[i] * phi[i];
+    }
+
+    const float error = y - prediction;
+    for (int i = 0; i < n; i++) {
+        rls->theta[i] += Pphi[i] / denominator * error;
+    }
+
+    // Only forget while the covariance is bounded, otherwise it winds up when the input holds still
+    float trace = 0.0f;
+    for (int i = 0; i < n; i++) {
+        trace += rls->P[i][i];
+    }
+    const float forget = trace < rls->maxTrace ? 1.0f / rls->lambda : 1.0f;
+    for (int i = 0; i < n; i++) {
+        for (int j = i; j < n; j++) {
+            rls->P[i][j] = (rls->P[i][j] - Pphi[i] * Pphi[j] / denominator) * forget;
+            rls->P[j][i] = rls->P[i][j];
+        }
+    }
+
+    rls->residualVariance += TAIL_ID_RESIDUAL_SMOOTHING * (error * error - rls->residualVariance);
+    rls->updates++;
+
+    return error;
+}
+
+float tailIdRlsStd(const tailIdRls_t *rls, uint8_t i)
+{
+    return sqrtf(MAX(rls->P[i][i], 0.0f) * rls->residualVariance);
+}
+
+void tailIdInit(tailId_t *id, uint32_t loopTimeUs, bool servoFeedback)
+{
+    memset(id, 0, sizeof(*id));
+
+    loopTimeUs = MAX(loopTimeUs, 1);
+    id->decimation = constrain((TAIL_ID_SAMPLE_PERIOD_US + loopTimeUs / 2) / loopTimeUs, 1, UINT8_MAX);
+    id->samplePeriodS = id->decimation * loopTimeUs * 1e-6f;
+    id->servoFeedback = servoFeedback;
+    id->gap = true;
+    id->motorSpoolS = TAIL_ID_SPOOL_INITIAL_S;
+
+    tailIdRlsInit(&id->servoRate, 1, TAIL_ID_FORGETTING_FACTOR, TAIL_ID_INITIAL_COVARIANCE);
+    tailIdRlsInit(&id->servoLag, 2, TAIL_ID_FORGETTING_FACTOR, TAIL_ID_INITIAL_COVARIANCE);
+    tailIdRlsInit(&id->yaw, 3, TAIL_ID_FORGETTING_FACTOR, TAIL_ID_INITIAL_COVARIANCE);
+}
+
+void tailIdPush(tailId_t *id, const tailIdSample_t *sample)
+{
+    // Average down to the sample rate, the gyro difference is too noisy at the loop rate
+    if (id->accumulated == 0) {
+        id->accumulator = *sample;
+    } else {
+        id->accumulator.servoCommand += sample->servoCommand;
+        id->accumulator.servoAngle += sample->servoAngle;
+        id->accumulator.motor += sample->motor;
+        id->accumulator.yawRate += sample->yawRate;
+    }
+    if (++id->accumulated < id->decimation) {
+        return;
+    }
+
+    const float scale = 1.0f / id->accumulated;
+    id->accumulated = 0;
+
+    const uint8_t next = (id->queueHead + 1) % TAIL_ID_QUEUE_SIZE;
+    if (next == id->queueTail) {
+        // The task fell behind, start over from the next sample
+        id->droppedSamples++;
+        id->gap = true;
+        return;
+    }
+
+    tailIdSample_t *entry = &id->queue[id->queueHead];
+    entry->servoCommand = id->accumulator.servoCommand * scale;
+    entry->servoAngle = id->accumulator.servoAngle * scale;
+    entry->motor = id->accumulator.motor * scale;
+    entry->yawRate = id->accumulator.yawRate * scale;
+    entry->restart = id->gap;
+    id->gap = false;
+    id->queueHead = next;
+}
+
+void tailIdBreak(tailId_t *id)
+{
+    id->accumulated = 0;
+    id->gap = true;
+}
+
+void tailIdProcess(tailId_t *id)
+{
+    while (id->queueTail != id->queueHead) {
+        tailIdUpdate(id, &id->queue[id->queueTail]);
+        id->queueTail = (id->queueTail + 1) % TAIL_ID_QUEUE_SIZE;
+    }
+}
+
+static void servoUpdate(tailId_t *id, const tailIdSample_t *sample)
+{
+    const float T = id->samplePeriodS;
+    const float error = id->previous.servoCommand - id->previous.servoAngle;
+    const float step = sample->servoAngle - id->previous.servoAngle;
+
+    if (fabsf(error) > TAIL_ID_SERVO_SLEW_ERROR_DEG) {
+        // Moving towards the set-point at its rate
+        if (step * error > 0.0f) {
+            const float one = 1.0f;
+            tailIdRlsUpdate(&id->servoRate, &one, fabsf(step) / T);
+        }
+    } else if (fabsf(error) < TAIL_ID_SERVO_LINEAR_ERROR_DEG) {
+        const float phi[2] = { error, 1.0f };
+        tailIdRlsUpdate(&id->servoLag, phi, step);
+    }
+}
+
+// Recursive prediction error: the motor model runs with the current spool estimate and its
+// sensitivity to it is a regressor. Its parameter over the gain is how far the estimate is off.
+static void yawUpdate(tailId_t *id, const tailIdSample_t *sample)
+{
+    const float T = id->samplePeriodS;
+    const float tau = id->motorSpoolS;
+    const float decay = expf(-T / tau);
+
+    const float previousModel = id->motorModel;
+    const float previousSensitivity = id->motorSensitivity;
+    const float error = sample->motor - previousModel;
+    id->motorModel = previousModel + (1.0f - decay) * error;
+    id->motorSensitivity = decay * previousSensitivity - decay * T / sq(tau) * error;
+
+    if (sample->motor < TAIL_ID_MOTOR_MIN || id->previous.motor < TAIL_ID_MOTOR_MIN) {
+        return;
+    }
+
+    // The gyro difference is the yaw acceleration half way between the two samples
+    const float yawAccel = (sample->yawRate - id->previous.yawRate) / T * TAIL_ID_YAW_ACCEL_SCALE;
+    const float tilt = sin_approx((sample->servoAngle + id->previous.servoAngle) * 0.5f * RAD);
+    const float phi[3] = {
+        tilt * (id->motorModel + previousModel) * 0.5f,
+        tilt * (id->motorSensitivity + previousSensitivity) * 0.5f,
+        1.0f
+    };
+    tailIdRlsUpdate(&id->yaw, phi, yawAccel);
+
+    // Move the spool estimate once the gain is known, and take the step out of the parameter
+    const float gain = id->yaw.theta[0];
+    if (id->yaw.updates > TAIL_ID_MIN_UPDATES / 2 && fabsf(gain) > 0.0f) {
+        const float step = constrainf(TAIL_ID_SPOOL_ADAPTATION * id->yaw.theta[1] / gain, -TAIL_ID_SPOOL_STEP_MAX * tau, TAIL_ID_SPOOL_STEP_MAX * tau);
+        const float spool = constrainf(tau + step, TAIL_ID_SPOOL_MIN_S, TAIL_ID_SPOOL_MAX_S);
+        id->yaw.theta[1] -= gain * (spool - tau);
+        id->motorSpoolS = spool;
+    }
+}
+
+void tailIdUpdate(tailId_t *id, const tailIdSample_t *sample)
+{
+    if (sample->restart || !id->havePrevious) {
+        id->previous = *sample;
+        id->havePrevious = true;
+        id->motorModel = sample->motor;
+        id->motorSensitivity = 0.0f;
+        return;
+    }
+
+    if (id->servoFeedback) {
+        servoUpdate(id, sample);
+    }
+    yawUpdate(id, sample);
+
+    id->previous = *sample;
+}
+
+static uint8_t confidence(const tailIdRls_t *rls, float relativeStd)
+{
+    if (rls->updates < TAIL_ID_MIN_UPDATES || !(relativeStd < 1.0f / TAIL_ID_CONFIDENCE_GAIN)) {
+        return 0;
+    }
+    return lrintf(100.0f * (1.0f - relativeStd * TAIL_ID_CONFIDENCE_GAIN));
+}
+
+void tailIdGetEstimate(const tailId_t *id, tailIdEstimate_t *estimate)
+{
+    const float T = id->samplePeriodS;
+
+    memset(estimate, 0, sizeof(*estimate));
+
+    if (id->servoFeedback) {
+        const float rate = id->servoRate.theta[0];
+        if (rate > 0.0f) {
+            estimate->servoRateDps = rate;
+            estimate->servoRateConfidence = confidence(&id->servoRate, tailIdRlsStd(&id->servoRate, 0) / rate);
+        }
+
+        const float b = id->servoLag.theta[0];
+        if (b > 0.0f && b < 1.0f) {
+            estimate->servoLagMs = -T / logf(1.0f - b) * 1000.0f;
+            estimate->servoLagConfidence = confidence(&id->servoLag, tailIdRlsStd(&id->servoLag, 0) / b);
+        }
+    }
+
+    const float gain = id->yaw.theta[0];
+    if (gain != 0.0f) {
+        const float gainRelativeStd = tailIdRlsStd(&id->yaw, 0) / fabsf(gain);
+        estimate->motorSpoolMs = id->motorSpoolS * 1000.0f;
+        estimate->motorSpoolConfidence = confidence(&id->yaw, tailIdRlsStd(&id->yaw, 1) / fabsf(gain * id->motorSpoolS));
+        estimate->yawTorqueGain = fabsf(gain) / TAIL_ID_YAW_ACCEL_SCALE;
+        estimate->yawTorqueConfidence = confidence(&id->yaw, gainRelativeStd);
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// In-flight identification of the tail plant by recursive least squares. The PID loop pushes
+// decimated samples, a low priority task runs the estimators.
+//
+// Servo, from the feedback ADC only. Far from the set-point the servo slews at its rate,
+// close to it it follows as a first order lag:
+//   angle[k] - angle[k-1] = b * (command[k-1] - angle[k-1]) + offset,   lag = -T / ln(1 - b)
+// Motor and yaw. The tail motor spools as a first order lag, its thrust across the frame gives yaw:
+//   motorModel[k] = motorModel[k-1] + (1 - exp(-T / spool)) * (motor[k] - motorModel[k-1])
+//   yawAccel = gain * sin(deflection) * motorModel + bias
+// The spool is not linear in the model, it is moved along the sensitivity of motorModel to it.
+
+#define TAIL_ID_SAMPLE_PERIOD_US        2000    // PID loop samples are averaged down to this
+#define TAIL_ID_QUEUE_SIZE              16      // 32ms of samples, the task runs at 100Hz
+#define TAIL_ID_FORGETTING_FACTOR       0.998f  // memory of about 1s at the sample rate
+#define TAIL_ID_SERVO_LINEAR_ERROR_DEG  4.0f    // closer to the set-point the servo is in its linear range
+#define TAIL_ID_SERVO_SLEW_ERROR_DEG    15.0f   // further away it runs at its rate
+#define TAIL_ID_MOTOR_MIN               0.1f    // fraction of the motor range the yaw model needs
+#define TAIL_ID_YAW_ACCEL_SCALE         0.001f  // yaw acceleration is estimated in 1000 degrees/second^2
+#define TAIL_ID_MIN_UPDATES             500     // before any confidence is reported
+
+#define TAIL_ID_RLS_MAX_PARAMS          3
+
+typedef struct tailIdRls_s {
+    uint8_t count;
+    float lambda;
+    float theta[TAIL_ID_RLS_MAX_PARAMS];
+    float P[TAIL_ID_RLS_MAX_PARAMS][TAIL_ID_RLS_MAX_PARAMS];
+    float maxTrace;             // covariance stops growing here while the input does not excite the model
+    float residualVariance;     // of the a priori prediction error
+    uint32_t updates;
+} tailIdRls_t;
+
+void tailIdRlsInit(tailIdRls_t *rls, uint8_t count, float lambda, float initialCovariance);
+// returns the a priori prediction error
+float tailIdRlsUpdate(tailIdRls_t *rls, const float *phi, float y);
+// standard deviation of parameter i
+float tailIdRlsStd(const tailIdRls_t *rls, uint8_t i);
+
+typedef struct tailIdSample_s {
+    float servoCommand;         // angle the servo was sent to, degrees from the middle
+    float servoAngle;           // angle from feedback, degrees from the middle
+    float motor;                // tail motor command as a fraction of the output range
+    float yawRate;              // degrees/second
+    bool restart;               // first sample after a gap, nothing to difference against
+} tailIdSample_t;
+
+typedef struct tailIdEstimate_s {
+    float servoRateDps;
+    float servoLagMs;
+    float motorSpoolMs;
+    float yawTorqueGain;        // degrees/second^2 at full motor output and 90 degrees of tilt
+    // 0 - 100 each
+    uint8_t servoRateConfidence;
+    uint8_t servoLagConfidence;
+    uint8_t motorSpoolConfidence;
+    uint8_t yawTorqueConfidence;
+} tailIdEstimate_t;
+
+typedef struct tailId_s {
+    float samplePeriodS;
+    uint8_t decimation;
+    bool servoFeedback;         // without it the servo angle is the virtual servo, nothing to learn
+
+    // PID loop side
+    tailIdSample_t accumulator;
+    uint8_t accumulated;
+    bool gap;
+    tailIdSample_t queue[TAIL_ID_QUEUE_SIZE];
+    uint8_t queueHead;
+    uint8_t queueTail;
+    uint16_t droppedSamples;
+
+    // task side
+    tailIdSample_t previous;
+    bool havePrevious;
+    float motorModel;           // tail motor speed with the current spool estimate, fraction of the range
+    float motorSensitivity;     // d motorModel / d motorSpoolS
+    float motorSpoolS;
+
+    tailIdRls_t servoRate;
+    tailIdRls_t servoLag;
+    tailIdRls_t yaw;
+} tailId_t;
+
+void tailIdInit(tailId_t *id, uint32_t loopTimeUs, bool servoFeedback);
+// PID loop, every iteration while the identification should run
+void tailIdPush(tailId_t *id, const tailIdSample_t *sample);
+// PID loop, when the samples stop being continuous, e.g. disarmed or in tail tune
+void tailIdBreak(tailId_t *id);
+// task, runs the estimators over the queued samples
+void tailIdProcess(tailId_t *id);
+void tailIdUpdate(tailId_t *id, const tailIdSample_t *sample);
+void tailIdGetEstimate(const tailId_t *id, tailIdEstimate_t *estimate);
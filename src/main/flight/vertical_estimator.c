@@ -0,0 +1,86 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+
+#include "flight/vertical_estimator.h"
+
+/*
+ * Third order complementary filter, i.e. the steady state Kalman filter for a position, velocity
+ * and accelerometer bias model. The accelerometer drives the prediction at its own rate, position
+ * measurements (baro, sonar, GPS) correct it whenever they arrive.
+ *
+ * Gains are chosen to put all three poles at -1/timeConstant, the longer the time constant the more
+ * the estimate trusts the accelerometer over the position sensor.
+ *
+ * A second absolute reference such as GPS does not correct the states directly, two position sensors
+ * with their own integrators would fight over any offset between them. It slowly walks the offset
+ * of the position sensor instead, taking out baro drift without adding GPS noise to the velocity.
+ */
+
+// keeps a long gap between measurements from kicking the states, 5Hz GPS still gets its full weight
+#define VERTICAL_ESTIMATOR_MAX_CORRECTION_DT 0.25f
+// with the interval capped above this keeps the position gain of a single correction below one
+#define VERTICAL_ESTIMATOR_MIN_TIME_CONSTANT 1.0f
+
+void verticalEstimatorReset(verticalEstimator_t *estimator, float position)
+{
+    estimator->position = position;
+    estimator->velocity = 0.0f;
+    estimator->accBias = 0.0f;
+    estimator->referenceOffset = 0.0f;
+}
+
+void verticalEstimatorGainsInit(verticalEstimatorGains_t *gains, float timeConstant)
+{
+    const float inverse = 1.0f / MAX(timeConstant, VERTICAL_ESTIMATOR_MIN_TIME_CONSTANT);
+
+    gains->position = 3.0f * inverse;
+    gains->velocity = 3.0f * inverse * inverse;
+    gains->accBias = inverse * inverse * inverse;
+}
+
+void verticalEstimatorPredict(verticalEstimator_t *estimator, float accZ, float dt)
+{
+    const float acc = accZ - estimator->accBias;
+
+    estimator->position += (estimator->velocity + acc * 0.5f * dt) * dt;
+    estimator->velocity += acc * dt;
+}
+
+void verticalEstimatorCorrect(verticalEstimator_t *estimator, const verticalEstimatorGains_t *gains, float measuredPosition, float dt)
+{
+    const float error = measuredPosition - estimator->referenceOffset - estimator->position;
+
+    dt = MIN(dt, VERTICAL_ESTIMATOR_MAX_CORRECTION_DT);
+
+    estimator->position += gains->position * error * dt;
+    estimator->velocity += gains->velocity * error * dt;
+    estimator->accBias -= gains->accBias * error * dt;
+}
+
+void verticalEstimatorCorrectReference(verticalEstimator_t *estimator, float referencePosition, float timeConstant, float dt)
+{
+    dt = MIN(dt, VERTICAL_ESTIMATOR_MAX_CORRECTION_DT);
+
+    estimator->referenceOffset += (estimator->position - referencePosition) * dt / MAX(timeConstant, VERTICAL_ESTIMATOR_MIN_TIME_CONSTANT);
+}
@@ -0,0 +1,39 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+// Fixed-gain vertical position, velocity and accelerometer bias estimator, all in cm based units.
+typedef struct verticalEstimator_s {
+    float position;                 // cm
+    float velocity;                 // cm/s
+    float accBias;                  // cm/s/s, subtracted from the earth frame Z acceleration
+    float referenceOffset;          // cm, drift of the position sensor as seen by a slower absolute reference
+} verticalEstimator_t;
+
+// Correction gains per second of measurement interval
+typedef struct verticalEstimatorGains_s {
+    float position;
+    float velocity;
+    float accBias;
+} verticalEstimatorGains_t;
+
+void verticalEstimatorReset(verticalEstimator_t *estimator, float position);
+void verticalEstimatorGainsInit(verticalEstimatorGains_t *gains, float timeConstant);
+void verticalEstimatorPredict(verticalEstimator_t *estimator, float accZ, float dt);
+void verticalEstimatorCorrect(verticalEstimator_t *estimator, const verticalEstimatorGains_t *gains, float measuredPosition, float dt);
+void verticalEstimatorCorrectReference(verticalEstimator_t *estimator, float referencePosition, float timeConstant, float dt);
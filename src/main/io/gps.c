@@ -41,6 +41,7 @@
 #include "io/serial.h"
 #include "io/dashboard.h"
 #include "io/gps.h"
+#include "io/gps_ubx.h"
 
 #include "flight/gps_conversion.h"
 #include "flight/pid.h"
@@ -61,9 +62,14 @@
 #define LOG_UBLOX_SVINFO 'I'
 #define LOG_UBLOX_POSLLH 'P'
 #define LOG_UBLOX_VELNED 'V'
+#define LOG_UBLOX_PVT    'T'
+#define LOG_UBLOX_DOP    'D'
 
 #define GPS_SV_MAXSATS   16
 
+// bytes drained from the serial port per pass, UBX frames that fit are dispatched straight from here
+#define GPS_RX_CHUNK_SIZE 64
+
 char gpsPacketLog[GPS_PACKET_LOG_ENTRY_COUNT];
 static char *gpsPacketLogChar = gpsPacketLog;
 // **********************
@@ -141,6 +147,8 @@ static const uint8_t ubloxInit[] = {
     //0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x30, 0x01, 0x3C, 0xA3,           // set SVINFO MSG rate (every cycle - high bandwidth)
     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x30, 0x05, 0x40, 0xA7,           // set SVINFO MSG rate (evey 5 cycles - low bandwidth)
     0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x12, 0x01, 0x1E, 0x67,           // set VELNED MSG rate
+    0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x07, 0x01, 0x13, 0x51,           // set PVT MSG rate (u-blox 7 and later, NAKed by older receivers)
+    0xB5, 0x62, 0x06, 0x01, 0x03, 0x00, 0x01, 0x04, 0x01, 0x10, 0x4B,           // set DOP MSG rate
 
     0xB5, 0x62, 0x06, 0x08, 0x06, 0x00, 0xC8, 0x00, 0x01, 0x00, 0x01, 0x00, 0xDE, 0x6A,             // set rate to 5Hz (measurement period: 200ms, navigation rate: 1 cycle)
 };
@@ -191,8 +199,10 @@ static void shiftPacketLog(void)
 }
 
 static void gpsNewData(uint16_t c);
+static void gpsNewDataBuf(const uint8_t *data, uint32_t count);
 static bool gpsNewFrameNMEA(char c);
 static bool gpsNewFrameUBLOX(uint8_t data);
+static void gpsInitUbloxFramer(void);
 
 static void gpsSetState(gpsState_e state)
 {
@@ -214,6 +224,7 @@ void gpsInit(serialConfig_t *initialSerialConfig, gpsConfig_t *initialGpsConfig)
     memset(gpsPacketLog, 0x00, sizeof(gpsPacketLog));
 
     gpsConfig = initialGpsConfig;
+    gpsInitUbloxFramer();
 
     // init gpsData structure. if we're not actually enabled, don't bother doing anything else
     gpsSetState(GPS_UNKNOWN);
@@ -340,6 +351,8 @@ void gpsInitUblox(void)
             break;
         case GPS_CHANGE_BAUD:
             serialSetBaudRate(gpsPort, baudRates[gpsInitData[gpsData.baudrateIndex].baudrateIndex]);
+            // drop partial frames from the old rate, the receiver about to be configured may not send NAV-PVT either
+            gpsInitUbloxFramer();
             gpsSetState(GPS_CONFIGURE);
             break;
         case GPS_CONFIGURE:
@@ -408,8 +421,11 @@ void gpsUpdate(timeUs_t currentTimeUs)
 {
     // read out available GPS bytes
     if (gpsPort) {
-        while (serialRxBytesWaiting(gpsPort))
-            gpsNewData(serialRead(gpsPort));
+        uint8_t chunk[GPS_RX_CHUNK_SIZE];
+        uint32_t count;
+        while ((count = serialReadBuf(gpsPort, chunk, sizeof(chunk)))) {
+            gpsNewDataBuf(chunk, count);
+        }
     }
 
     switch (gpsData.state) {
@@ -450,12 +466,8 @@ void gpsUpdate(timeUs_t currentTimeUs)
     }
 }
 
-static void gpsNewData(uint16_t c)
+static void gpsNewNavData(void)
 {
-    if (!gpsNewFrame(c)) {
-        return;
-    }
-
     // new data received and parsed, we're in business
     gpsData.lastLastMessage = gpsData.lastMessage;
     gpsData.lastMessage = millis();
@@ -473,6 +485,13 @@ static void gpsNewData(uint16_t c)
     onGpsNewData();
 }
 
+static void gpsNewData(uint16_t c)
+{
+    if (gpsNewFrame(c)) {
+        gpsNewNavData();
+    }
+}
+
 bool gpsNewFrame(uint8_t c)
 {
     switch (gpsConfig->provider) {
@@ -837,7 +856,9 @@ enum {
     MSG_ACK_ACK = 0x01,
     MSG_POSLLH = 0x2,
     MSG_STATUS = 0x3,
+    MSG_DOP = 0x4,
     MSG_SOL = 0x6,
+    MSG_PVT = 0x7,
     MSG_VELNED = 0x12,
     MSG_SVINFO = 0x30,
     MSG_CFG_PRT = 0x00,
@@ -859,19 +880,17 @@ enum {
     NAV_STATUS_FIX_VALID = 1
 } ubx_nav_status_bits;
 
-// Packet checksum accumulators
-static uint8_t _ck_a;
-static uint8_t _ck_b;
-
-// State machine state
-static bool _skip_packet;
-static uint8_t _step;
+static ubxFramer_t ubxFramer;
 static uint8_t _msg_id;
-static uint16_t _payload_length;
-static uint16_t _payload_counter;
 
 static bool next_fix;
-static uint8_t _class;
+
+// set by the frame handler when a frame completed a navigation solution
+static bool _new_nav_data;
+
+// once the receiver sends NAV-PVT the separate position, status and velocity messages are ignored
+static bool _nav_pvt_received;
+static ubxNavPvt_t _nav_pvt;
 
 // do we have new position information?
 static bool _new_position;
@@ -922,6 +941,10 @@ static bool UBLOX_parse_gps(void)
 
     *gpsPacketLogChar = LOG_IGNORED;
 
+    if (_nav_pvt_received && _msg_id != MSG_SVINFO) {
+        return false;
+    }
+
     switch (_msg_id) {
     case MSG_POSLLH:
         *gpsPacketLogChar = LOG_UBLOX_POSLLH;
@@ -948,7 +971,6 @@ static bool UBLOX_parse_gps(void)
         if (!next_fix)
             DISABLE_STATE(GPS_FIX);
         GPS_numSat = _buffer.solution.satellites;
-        GPS_hdop = _buffer.solution.position_DOP;
         break;
     case MSG_VELNED:
         *gpsPacketLogChar = LOG_UBLOX_VELNED;
@@ -983,90 +1005,123 @@ static bool UBLOX_parse_gps(void)
     return false;
 }
 
-static bool gpsNewFrameUBLOX(uint8_t data)
+static bool UBLOX_parse_pvt(const ubxFrame_t *frame)
 {
-    bool parsed = false;
+    if (!ubxDecodeNavPvt(frame, &_nav_pvt)) {
+        *gpsPacketLogChar = LOG_IGNORED;
+        return false;
+    }
 
-    switch (_step) {
-        case 0: // Sync char 1 (0xB5)
-            if (PREAMBLE1 == data) {
-                _skip_packet = false;
-                _step++;
-            }
-            break;
-        case 1: // Sync char 2 (0x62)
-            if (PREAMBLE2 != data) {
-                _step = 0;
-                break;
-            }
-            _step++;
-            break;
-        case 2: // Class
-            _step++;
-            _class = data;
-            _ck_b = _ck_a = data;   // reset the checksum accumulators
-            break;
-        case 3: // Id
-            _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
-            _msg_id = data;
-            break;
-        case 4: // Payload length (part 1)
-            _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
-            _payload_length = data; // payload length low byte
-            break;
-        case 5: // Payload length (part 2)
-            _step++;
-            _ck_b += (_ck_a += data);       // checksum byte
-            _payload_length += (uint16_t)(data << 8);
-            if (_payload_length > UBLOX_PAYLOAD_SIZE) {
-                _skip_packet = true;
-            }
-            _payload_counter = 0;   // prepare to receive payload
-            if (_payload_length == 0) {
-                _step = 7;
-            }
-            break;
-        case 6:
-            _ck_b += (_ck_a += data);       // checksum byte
-            if (_payload_counter < UBLOX_PAYLOAD_SIZE) {
-                _buffer.bytes[_payload_counter] = data;
-            }
-            if (++_payload_counter >= _payload_length) {
-                _step++;
-            }
-            break;
-        case 7:
-            _step++;
-            if (_ck_a != data) {
-                _skip_packet = true;          // bad checksum
-                gpsData.errors++;
-            }
-            break;
-        case 8:
-            _step = 0;
+    *gpsPacketLogChar = LOG_UBLOX_PVT;
+    _nav_pvt_received = true;
+
+    // a single message carries the whole solution, no need to pair position and velocity
+    GPS_coord[LON] = _nav_pvt.lon;
+    GPS_coord[LAT] = _nav_pvt.lat;
+    GPS_altitude = _nav_pvt.hMSL / 1000;   // alt in m
+    GPS_numSat = _nav_pvt.numSV;
+    GPS_speed = _nav_pvt.gSpeed / 10;      // cm/s
+    GPS_ground_course = (uint16_t) (_nav_pvt.headMot / 10000);   // Heading of motion deg * 100000 rescaled to deg * 10
+
+    next_fix = (_nav_pvt.flags & UBX_NAV_PVT_FLAGS_FIX_OK) && (_nav_pvt.fixType == FIX_3D);
+    if (next_fix) {
+        ENABLE_STATE(GPS_FIX);
+    } else {
+        DISABLE_STATE(GPS_FIX);
+    }
 
-            shiftPacketLog();
+    return true;
+}
 
-            if (_ck_b != data) {
-                *gpsPacketLogChar = LOG_ERROR;
-                gpsData.errors++;
-                break;              // bad checksum
-            }
+static void gpsHandleUbloxFrame(const ubxFrame_t *frame)
+{
+    shiftPacketLog();
 
-            GPS_packetCount++;
+    if (frame->status == UBX_FRAME_CHECKSUM_ERROR) {
+        *gpsPacketLogChar = LOG_ERROR;
+        gpsData.errors++;
+        return;
+    }
 
-            if (_skip_packet) {
-                *gpsPacketLogChar = LOG_SKIPPED;
-                break;
-            }
+    GPS_packetCount++;
 
-            if (UBLOX_parse_gps()) {
-                parsed = true;
-            }
+    if (frame->status == UBX_FRAME_SKIPPED) {
+        *gpsPacketLogChar = LOG_SKIPPED;
+        return;
+    }
+
+    if (frame->msgClass != CLASS_NAV) {
+        *gpsPacketLogChar = LOG_IGNORED;
+        return;
+    }
+
+    if (frame->msgId == MSG_DOP) {
+        // sent alongside both NAV-PVT and the older messages, PVT and SOL only carry the position DOP
+        ubxNavDop_t dop;
+        if (ubxDecodeNavDop(frame, &dop)) {
+            *gpsPacketLogChar = LOG_UBLOX_DOP;
+            GPS_hdop = dop.hDOP;
+        } else {
+            *gpsPacketLogChar = LOG_IGNORED;
+        }
+        return;
+    }
+
+    if (frame->msgId == MSG_PVT) {
+        if (UBLOX_parse_pvt(frame)) {
+            _new_nav_data = true;
+        }
+        return;
+    }
+
+    // the older messages are read through the aligned receive buffer
+    if (frame->payload != _buffer.bytes) {
+        memcpy(_buffer.bytes, frame->payload, MIN(frame->length, UBLOX_PAYLOAD_SIZE));
+    }
+    _msg_id = frame->msgId;
+
+    if (UBLOX_parse_gps()) {
+        _new_nav_data = true;
+    }
+}
+
+static void gpsInitUbloxFramer(void)
+{
+    ubxFramerInit(&ubxFramer, _buffer.bytes, UBLOX_PAYLOAD_SIZE, gpsHandleUbloxFrame);
+    _new_position = _new_speed = false;
+    _nav_pvt_received = false;
+}
+
+const ubxNavPvt_t *gpsGetNavPvt(void)
+{
+    return _nav_pvt_received ? &_nav_pvt : NULL;
+}
+
+static bool gpsNewFrameUBLOXBuf(const uint8_t *data, uint32_t count)
+{
+    _new_nav_data = false;
+    ubxFramerFeed(&ubxFramer, data, count);
+    return _new_nav_data;
+}
+
+static bool gpsNewFrameUBLOX(uint8_t data)
+{
+    return gpsNewFrameUBLOXBuf(&data, 1);
+}
+
+static void gpsNewDataBuf(const uint8_t *data, uint32_t count)
+{
+    if (gpsConfig->provider != GPS_UBLOX) {
+        while (count--) {
+            gpsNewData(*data++);
+        }
+        return;
+    }
+
+    // a chunk is too short to hold more than one navigation solution
+    if (gpsNewFrameUBLOXBuf(data, count)) {
+        gpsNewNavData();
     }
-    return parsed;
 }
 
 static void gpsHandlePassthrough(uint8_t data)
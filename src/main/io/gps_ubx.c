@@ -0,0 +1,229 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#ifdef GPS
+
+#include "common/maths.h"
+#include "common/streambuf.h"
+
+#include "io/gps_ubx.h"
+
+/*
+ * UBX framing over receive chunks.
+ *
+ * The framer is fed whatever the serial port had waiting. When a whole frame lies within the chunk
+ * the checksum is run over it in place and the handler gets a pointer into the chunk, nothing is copied.
+ * Frames split between chunks are assembled in the framer buffer and handed over from there.
+ */
+
+typedef enum {
+    UBX_STEP_SYNC1 = 0,
+    UBX_STEP_SYNC2,
+    UBX_STEP_CLASS,
+    UBX_STEP_ID,
+    UBX_STEP_LENGTH1,
+    UBX_STEP_LENGTH2,
+    UBX_STEP_PAYLOAD,
+    UBX_STEP_CK_A,
+    UBX_STEP_CK_B
+} ubxFramerStep_e;
+
+static void ubxChecksum(ubxFramer_t *framer, const uint8_t *data, uint32_t count)
+{
+    uint8_t ckA = framer->ckA;
+    uint8_t ckB = framer->ckB;
+
+    while (count--) {
+        ckA += *data++;
+        ckB += ckA;
+    }
+
+    framer->ckA = ckA;
+    framer->ckB = ckB;
+}
+
+static void ubxDispatch(ubxFramer_t *framer, const uint8_t *payload, bool checksumOk)
+{
+    ubxFrame_t frame = {
+        .msgClass = framer->msgClass,
+        .msgId = framer->msgId,
+        .length = framer->length,
+        .payload = NULL
+    };
+
+    if (!checksumOk) {
+        frame.status = UBX_FRAME_CHECKSUM_ERROR;
+    } else if (!payload) {
+        frame.status = UBX_FRAME_SKIPPED;
+    } else {
+        frame.status = UBX_FRAME_OK;
+        frame.payload = payload;
+    }
+
+    framer->step = UBX_STEP_SYNC1;
+    framer->handler(&frame);
+}
+
+void ubxFramerInit(ubxFramer_t *framer, uint8_t *buffer, uint16_t bufferSize, ubxFrameHandlerFnPtr handler)
+{
+    memset(framer, 0, sizeof(*framer));
+    framer->handler = handler;
+    framer->buffer = buffer;
+    framer->bufferSize = bufferSize;
+}
+
+void ubxFramerFeed(ubxFramer_t *framer, const uint8_t *data, uint32_t count)
+{
+    const uint8_t *end = data + count;
+
+    while (data < end) {
+        switch (framer->step) {
+        case UBX_STEP_SYNC1: {
+            const uint8_t *sync = memchr(data, UBX_PREAMBLE1, end - data);
+            if (!sync) {
+                return;
+            }
+            data = sync + 1;
+            framer->step = UBX_STEP_SYNC2;
+            break;
+        }
+        case UBX_STEP_SYNC2:
+            if (*data == UBX_PREAMBLE2) {
+                framer->step = UBX_STEP_CLASS;
+            } else if (*data != UBX_PREAMBLE1) {
+                framer->step = UBX_STEP_SYNC1;
+            }
+            data++;
+            break;
+        case UBX_STEP_CLASS:
+            framer->msgClass = *data;
+            framer->ckA = framer->ckB = 0;
+            ubxChecksum(framer, data++, 1);
+            framer->step = UBX_STEP_ID;
+            break;
+        case UBX_STEP_ID:
+            framer->msgId = *data;
+            ubxChecksum(framer, data++, 1);
+            framer->step = UBX_STEP_LENGTH1;
+            break;
+        case UBX_STEP_LENGTH1:
+            framer->length = *data;
+            ubxChecksum(framer, data++, 1);
+            framer->step = UBX_STEP_LENGTH2;
+            break;
+        case UBX_STEP_LENGTH2:
+            framer->length |= *data << 8;
+            ubxChecksum(framer, data++, 1);
+            framer->received = 0;
+
+            if ((uint32_t)(end - data) >= framer->length + 2u) {
+                // the whole frame is in this chunk, check and dispatch it in place
+                const uint8_t *payload = data;
+                ubxChecksum(framer, payload, framer->length);
+                data += framer->length;
+                const bool checksumOk = data[0] == framer->ckA && data[1] == framer->ckB;
+                data += 2;
+                ubxDispatch(framer, payload, checksumOk);
+            } else {
+                framer->step = framer->length ? UBX_STEP_PAYLOAD : UBX_STEP_CK_A;
+            }
+            break;
+        case UBX_STEP_PAYLOAD: {
+            uint32_t run = MIN((uint32_t)(end - data), (uint32_t)(framer->length - framer->received));
+            ubxChecksum(framer, data, run);
+            if (framer->length <= framer->bufferSize) {
+                memcpy(framer->buffer + framer->received, data, run);
+            }
+            framer->received += run;
+            data += run;
+            if (framer->received == framer->length) {
+                framer->step = UBX_STEP_CK_A;
+            }
+            break;
+        }
+        case UBX_STEP_CK_A:
+            framer->checksumError = *data++ != framer->ckA;
+            framer->step = UBX_STEP_CK_B;
+            break;
+        case UBX_STEP_CK_B: {
+            const bool checksumOk = !framer->checksumError && *data++ == framer->ckB;
+            ubxDispatch(framer, framer->length <= framer->bufferSize ? framer->buffer : NULL, checksumOk);
+            break;
+        }
+        }
+    }
+}
+
+bool ubxDecodeNavPvt(const ubxFrame_t *frame, ubxNavPvt_t *pvt)
+{
+    if (frame->status != UBX_FRAME_OK || frame->msgClass != UBX_CLASS_NAV || frame->msgId != UBX_MSG_NAV_PVT
+        || frame->length < UBX_NAV_PVT_MIN_LENGTH) {
+        return false;
+    }
+
+    sbuf_t buf = { .ptr = (uint8_t *)frame->payload, .end = (uint8_t *)frame->payload + frame->length };
+
+    pvt->iTOW = sbufReadU32(&buf);
+    sbufAdvance(&buf, 16);          // UTC date and time, validity, time accuracy and nanoseconds
+    pvt->fixType = sbufReadU8(&buf);
+    pvt->flags = sbufReadU8(&buf);
+    sbufAdvance(&buf, 1);
+    pvt->numSV = sbufReadU8(&buf);
+    pvt->lon = sbufReadU32(&buf);
+    pvt->lat = sbufReadU32(&buf);
+    pvt->height = sbufReadU32(&buf);
+    pvt->hMSL = sbufReadU32(&buf);
+    pvt->hAcc = sbufReadU32(&buf);
+    pvt->vAcc = sbufReadU32(&buf);
+    pvt->velN = sbufReadU32(&buf);
+    pvt->velE = sbufReadU32(&buf);
+    pvt->velD = sbufReadU32(&buf);
+    pvt->gSpeed = sbufReadU32(&buf);
+    pvt->headMot = sbufReadU32(&buf);
+    pvt->sAcc = sbufReadU32(&buf);
+    sbufAdvance(&buf, 4);           // heading accuracy
+    pvt->pDOP = sbufReadU16(&buf);
+
+    return true;
+}
+
+bool ubxDecodeNavDop(const ubxFrame_t *frame, ubxNavDop_t *dop)
+{
+    if (frame->status != UBX_FRAME_OK || frame->msgClass != UBX_CLASS_NAV || frame->msgId != UBX_MSG_NAV_DOP
+        || frame->length < UBX_NAV_DOP_LENGTH) {
+        return false;
+    }
+
+    sbuf_t buf = { .ptr = (uint8_t *)frame->payload, .end = (uint8_t *)frame->payload + frame->length };
+
+    dop->iTOW = sbufReadU32(&buf);
+    sbufAdvance(&buf, 2);           // geometric DOP
+    dop->pDOP = sbufReadU16(&buf);
+    sbufAdvance(&buf, 2);           // time DOP
+    dop->vDOP = sbufReadU16(&buf);
+    dop->hDOP = sbufReadU16(&buf);
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define UBX_PREAMBLE1           0xB5
+#define UBX_PREAMBLE2           0x62
+
+#define UBX_CLASS_NAV           0x01
+#define UBX_MSG_NAV_DOP         0x04
+#define UBX_MSG_NAV_PVT         0x07
+
+// u-blox 7 sends 84 bytes of NAV-PVT, u-blox 8 and later append the vehicle heading and magnetic declination
+#define UBX_NAV_PVT_MIN_LENGTH  84
+
+#define UBX_NAV_DOP_LENGTH      18
+
+#define UBX_NAV_PVT_FLAGS_FIX_OK (1 << 0)
+
+typedef enum {
+    UBX_FRAME_OK = 0,
+    UBX_FRAME_SKIPPED,              // checksum good, payload too long for the buffer so it was not kept
+    UBX_FRAME_CHECKSUM_ERROR
+} ubxFrameStatus_e;
+
+typedef struct ubxFrame_s {
+    ubxFrameStatus_e status;
+    uint8_t msgClass;
+    uint8_t msgId;
+    uint16_t length;
+    const uint8_t *payload;         // either the caller's receive chunk or the framer buffer, valid during the handler only
+} ubxFrame_t;
+
+typedef void (*ubxFrameHandlerFnPtr)(const ubxFrame_t *frame);
+
+typedef struct ubxFramer_s {
+    ubxFrameHandlerFnPtr handler;
+    uint8_t *buffer;                // assembles frames that are split over several receive chunks
+    uint16_t bufferSize;
+
+    uint8_t step;
+    uint8_t ckA;
+    uint8_t ckB;
+    bool checksumError;
+    uint8_t msgClass;
+    uint8_t msgId;
+    uint16_t length;
+    uint16_t received;
+} ubxFramer_t;
+
+// NAV-PVT decoded to native types, units as sent by the receiver
+typedef struct ubxNavPvt_s {
+    uint32_t iTOW;                  // ms GPS time of week
+    uint8_t fixType;
+    uint8_t flags;
+    uint8_t numSV;
+    int32_t lon;                    // deg * 1e7
+    int32_t lat;                    // deg * 1e7
+    int32_t height;                 // mm above ellipsoid
+    int32_t hMSL;                   // mm above mean sea level
+    uint32_t hAcc;                  // mm
+    uint32_t vAcc;                  // mm
+    int32_t velN;                   // mm/s
+    int32_t velE;                   // mm/s
+    int32_t velD;                   // mm/s
+    int32_t gSpeed;                 // mm/s
+    int32_t headMot;                // deg * 1e5
+    uint32_t sAcc;                  // mm/s
+    uint16_t pDOP;                  // 0.01
+} ubxNavPvt_t;
+
+// NAV-DOP, the only message carrying the horizontal dilution of precision
+typedef struct ubxNavDop_s {
+    uint32_t iTOW;                  // ms GPS time of week
+    uint16_t pDOP;                  // 0.01
+    uint16_t vDOP;                  // 0.01
+    uint16_t hDOP;                  // 0.01
+} ubxNavDop_t;
+
+void ubxFramerInit(ubxFramer_t *framer, uint8_t *buffer, uint16_t bufferSize, ubxFrameHandlerFnPtr handler);
+void ubxFramerFeed(ubxFramer_t *framer, const uint8_t *data, uint32_t count);
+bool ubxDecodeNavPvt(const ubxFrame_t *frame, ubxNavPvt_t *pvt);
+bool ubxDecodeNavDop(const ubxFrame_t *frame, ubxNavDop_t *dop);
@@ -36,9 +36,6 @@
 #include "drivers/serial.h"
 #include "drivers/sensor.h"
 #include "drivers/accgyro.h"
-#include "drivers/gpio.h"
-#include "drivers/timer.h"
-#include "drivers/rx_pwm.h"
 
 #include "common/printf.h"
 #include "common/axis.h"
@@ -172,6 +169,7 @@ static int scaledThrottle;
 static int scaledAux;
 
 static void updateLedRingCounts(void);
+static void updateLayersInUse(void);
 
 STATIC_UNIT_TESTED void updateDimensions(void)
 {
@@ -238,6 +236,7 @@ void reevaluateLedConfig(void)
 {
     updateLedCount();
     updateDimensions();
+    updateLayersInUse();
     updateLedRingCounts();
 }
 
@@ -880,10 +879,13 @@ typedef enum {
     timAnimation,
 #endif
     timRing,
+    timFixed,           // fixed layers, without a layer of their own they would only follow the timed ones
     timTimerCount
 } timId_e;
 
 static timeUs_t timerVal[timTimerCount];
+// layers that have at least one LED to draw on, the others neither run nor trigger an update
+static uint32_t timInUse;
 
 // function to apply layer.
 // function must replan self using timer pointer
@@ -908,6 +910,53 @@ static applyLayerFn_timed* layerTable[] = {
     [timRing] = &applyLedThrustRingLayer
 };
 
+static void updateLayersInUse(void)
+{
+    uint32_t inUse = (1 << timFixed);
+
+#ifdef USE_LED_ANIMATION
+    inUse |= (1 << timAnimation);
+#endif
+    if (ledCounts.ring) {
+        inUse |= (1 << timRing);
+    }
+    if (ledCounts.larson) {
+        inUse |= (1 << timLarson);
+    }
+
+    for (int ledIndex = 0; ledIndex < ledCounts.count; ledIndex++) {
+        const ledConfig_t *ledConfig = &currentLedStripConfig->ledConfigs[ledIndex];
+
+        switch (ledGetFunction(ledConfig)) {
+            case LED_FUNCTION_BATTERY:
+                inUse |= (1 << timBattery);
+                break;
+            case LED_FUNCTION_RSSI:
+                inUse |= (1 << timRssi);
+                break;
+#ifdef GPS
+            case LED_FUNCTION_GPS:
+                inUse |= (1 << timGps);
+                break;
+#endif
+            default:
+                break;
+        }
+
+        if (ledGetOverlayBit(ledConfig, LED_OVERLAY_BLINK) || ledGetOverlayBit(ledConfig, LED_OVERLAY_LANDING_FLASH)) {
+            inUse |= (1 << timBlink);
+        }
+        if (ledGetOverlayBit(ledConfig, LED_OVERLAY_WARNING)) {
+            inUse |= (1 << timWarning);
+        }
+        if (ledGetOverlayBit(ledConfig, LED_OVERLAY_INDICATOR)) {
+            inUse |= (1 << timIndicator);
+        }
+    }
+
+    timInUse = inUse;
+}
+
 void ledStripUpdate(timeUs_t currentTimeUs)
 {
     if (!(ledStripInitialised && isWS2811LedStripReady())) {
@@ -928,6 +977,9 @@ void ledStripUpdate(timeUs_t currentTimeUs)
     // test all led timers, setting corresponding bits
     uint32_t timActive = 0;
     for (timId_e timId = 0; timId < timTimerCount; timId++) {
+        if (!(timInUse & (1 << timId))) {
+            continue;
+        }
         // sanitize timer value, so that it can be safely incremented. Handles inital timerVal value.
         const timeDelta_t delta = cmpTimeUs(now, timerVal[timId]);
         // max delay is limited to 5s
@@ -948,12 +1000,19 @@ void ledStripUpdate(timeUs_t currentTimeUs)
     scaledAux = scaleRange(rcData[currentLedStripConfig->ledstrip_aux_channel], PWM_RANGE_MIN, PWM_RANGE_MAX, 0, HSV_HUE_MAX + 1);
 
     applyLedFixedLayers();
+    if (timActive & (1 << timFixed)) {
+        timerVal[timFixed] += HZ_TO_US(10);
+    }
 
     for (timId_e timId = 0; timId < ARRAYLEN(layerTable); timId++) {
+        if (!(timInUse & (1 << timId))) {
+            continue;
+        }
         uint32_t *timer = &timerVal[timId];
         bool updateNow = timActive & (1 << timId);
         (*layerTable[timId])(updateNow, timer);
     }
+    // only LEDs whose composed color changed are converted and sent
     ws2811UpdateStrip();
 }
 
@@ -145,11 +145,288 @@ static int32_t osdGetAltitude(int32_t alt)
     }
 }
 
-static void osdDrawSingleElement(uint8_t item)
+// Per element render cache. An element is only formatted and written again when the value it
+// shows, its configured position or its blink state changed, or when a changed element that
+// was drawn over the same cells had to be erased. Elements are drawn in a fixed order, so where
+// elements overlap the later one still wins, as with a full redraw.
+
+#define OSD_ELEMENT_HIDDEN INT32_MIN
+#define OSD_MAX_ROWS 16
+#define OSD_MAX_COLS 30
+#define AH_COLUMNS 9
+
+typedef struct osdElementCache_s {
+    int32_t value;      // value the element was last rendered from, OSD_ELEMENT_HIDDEN if not shown
+    uint16_t itemPos;   // item_pos it was rendered with
+    uint8_t x;          // extent of the chars written
+    uint8_t y;
+    uint8_t length;
+    bool valid;
+} osdElementCache_t;
+
+static osdElementCache_t elementCache[OSD_ITEM_COUNT];
+static int8_t ahDrawnRows[AH_COLUMNS];      // row of the bar char in each AH column, -1 if none
+static uint32_t dirtyCells[OSD_MAX_ROWS];   // cells cleared or overwritten this frame, one bit per column
+static bool elementsInvalid = true;
+
+static const uint8_t osdElementDrawOrder[] = {
+    OSD_ARTIFICIAL_HORIZON,
+    OSD_HORIZON_SIDEBARS,
+    OSD_CROSSHAIRS,
+    OSD_MAIN_BATT_VOLTAGE,
+    OSD_RSSI_VALUE,
+    OSD_FLYTIME,
+    OSD_ONTIME,
+    OSD_FLYMODE,
+    OSD_THROTTLE_POS,
+    OSD_VTX_CHANNEL,
+    OSD_CURRENT_DRAW,
+    OSD_MAH_DRAWN,
+    OSD_CRAFT_NAME,
+    OSD_ALTITUDE,
+    OSD_ROLL_PIDS,
+    OSD_PITCH_PIDS,
+    OSD_YAW_PIDS,
+    OSD_POWER,
+    OSD_PIDRATE_PROFILE,
+    OSD_MAIN_BATT_WARNING,
+#ifdef GPS
+    OSD_GPS_SATS,
+    OSD_GPS_SPEED,
+#endif
+};
+
+static void osdInvalidateElements(void)
 {
-    if (!VISIBLE(osdProfile()->item_pos[item]) || BLINK(item))
-        return;
+    elementsInvalid = true;
+}
+
+static uint8_t osdCenterRow(void)
+{
+    return displayScreenSize(osdDisplayPort) == VIDEO_BUFFER_CHARS_PAL ? 7 : 6;
+}
+
+static bool osdSpanOp(uint8_t x, uint8_t y, uint8_t length, bool mark)
+{
+    if (y >= OSD_MAX_ROWS || x >= OSD_MAX_COLS || length == 0) {
+        return false;
+    }
+    if (length > OSD_MAX_COLS) {
+        length = OSD_MAX_COLS;
+    }
+    const uint32_t bits = ((1u << length) - 1) << x;
+    if (mark) {
+        dirtyCells[y] |= bits;
+        return true;
+    }
+    return (dirtyCells[y] & bits) != 0;
+}
+
+// Marks the cells the element currently occupies as dirty, or tests whether any of them is.
+static bool osdElementCellsOp(uint8_t item, bool mark)
+{
+    const osdElementCache_t *cache = &elementCache[item];
+    bool dirty = false;
+
+    switch (item) {
+    case OSD_ARTIFICIAL_HORIZON:
+        for (int x = 0; x < AH_COLUMNS; x++) {
+            if (ahDrawnRows[x] >= 0) {
+                dirty |= osdSpanOp(cache->x + x, ahDrawnRows[x], 1, mark);
+            }
+        }
+        break;
+
+    case OSD_HORIZON_SIDEBARS:
+        if (cache->length) {
+            for (int y = cache->y - AH_SIDEBAR_HEIGHT_POS; y <= cache->y + AH_SIDEBAR_HEIGHT_POS; y++) {
+                dirty |= osdSpanOp(cache->x - AH_SIDEBAR_WIDTH_POS, y, 1, mark);
+                dirty |= osdSpanOp(cache->x + AH_SIDEBAR_WIDTH_POS, y, 1, mark);
+            }
+            dirty |= osdSpanOp(cache->x - AH_SIDEBAR_WIDTH_POS + 1, cache->y, 1, mark);
+            dirty |= osdSpanOp(cache->x + AH_SIDEBAR_WIDTH_POS - 1, cache->y, 1, mark);
+        }
+        break;
+
+    default:
+        dirty = osdSpanOp(cache->x, cache->y, cache->length, mark);
+        break;
+    }
+
+    return dirty;
+}
+
+static bool osdElementEnabled(uint8_t item)
+{
+    switch (item) {
+    case OSD_ARTIFICIAL_HORIZON:
+    case OSD_HORIZON_SIDEBARS:
+    case OSD_CROSSHAIRS:
+#ifdef CMS
+        return sensors(SENSOR_ACC) || displayIsGrabbed(osdDisplayPort);
+#else
+        return sensors(SENSOR_ACC);
+#endif
+
+#ifdef GPS
+    case OSD_GPS_SATS:
+    case OSD_GPS_SPEED:
+#ifdef CMS
+        return sensors(SENSOR_GPS) || displayIsGrabbed(osdDisplayPort);
+#else
+        return sensors(SENSOR_GPS);
+#endif
+#endif
+
+    default:
+        return true;
+    }
+}
+
+static uint16_t osdGetRssi(void)
+{
+    uint16_t osdRssi = rssi * 100 / 1024; // change range
+    if (osdRssi >= 100)
+        osdRssi = 99;
+    return osdRssi;
+}
+
+static const char *osdGetFlightModeString(void)
+{
+    const char *p = "ACRO";
+
+    if (isAirmodeActive())
+        p = "AIR";
+
+    if (FLIGHT_MODE(FAILSAFE_MODE))
+        p = "!FS";
+    else if (FLIGHT_MODE(ANGLE_MODE))
+        p = "STAB";
+    else if (FLIGHT_MODE(HORIZON_MODE))
+        p = "HOR";
+
+    return p;
+}
+
+static uint8_t osdGetThrottlePercent(void)
+{
+    return (constrain(rcData[THROTTLE], PWM_RANGE_MIN, PWM_RANGE_MAX) - PWM_RANGE_MIN) * 100 / (PWM_RANGE_MAX - PWM_RANGE_MIN);
+}
+
+static int32_t osdGetPidsValue(uint8_t pidIndex)
+{
+    const pidProfile_t *pidProfile = &currentProfile->pidProfile;
+    return pidProfile->P8[pidIndex] | (pidProfile->I8[pidIndex] << 8) | (pidProfile->D8[pidIndex] << 16);
+}
+
+// Returns a compact representation of everything the element's rendering depends on,
+// cheap enough to evaluate for every element on every OSD tick.
+static int32_t osdGetElementValue(uint8_t item)
+{
+    if (!VISIBLE(osdProfile()->item_pos[item]) || BLINK(item) || !osdElementEnabled(item))
+        return OSD_ELEMENT_HIDDEN;
+
+    switch (item) {
+    case OSD_RSSI_VALUE:
+        return osdGetRssi();
+
+    case OSD_MAIN_BATT_VOLTAGE:
+        return getVbat();
+
+    case OSD_CURRENT_DRAW:
+        return amperage;
+
+    case OSD_MAH_DRAWN:
+        return mAhDrawn;
+
+#ifdef GPS
+    case OSD_GPS_SATS:
+        return GPS_numSat;
+
+    case OSD_GPS_SPEED:
+        return GPS_speed * 36 / 1000;
+#endif // GPS
+
+    case OSD_ALTITUDE:
+    {
+        // displayed with 0.1 resolution, the sign is shown separately (so -0.0 differs from 0.0)
+        const int32_t alt = osdGetAltitude(baro.BaroAlt);
+        return (alt / 10) * 2 + (alt < 0) + (osdProfile()->units << 30);
+    }
+
+    case OSD_ONTIME:
+        return micros() / 1000000;
+
+    case OSD_FLYTIME:
+        return flyTime;
+
+    case OSD_FLYMODE:
+        return (int32_t)(intptr_t)osdGetFlightModeString();
+
+    case OSD_CRAFT_NAME:
+    {
+        uint32_t hash = 5381;
+        for (const char *c = masterConfig.name; *c; c++) {
+            hash = hash * 33 + *c;
+        }
+        return hash & 0x7FFFFFFF;
+    }
 
+    case OSD_THROTTLE_POS:
+        return osdGetThrottlePercent();
+
+#ifdef USE_RTC6705
+    case OSD_VTX_CHANNEL:
+        return current_vtx_channel % CHANNELS_PER_BAND;
+#endif // VTX
+
+    case OSD_CROSSHAIRS:
+        return osdCenterRow();
+
+    case OSD_HORIZON_SIDEBARS:
+        // part of the artificial horizon, only shown along with it
+        if (!VISIBLE(osdProfile()->item_pos[OSD_ARTIFICIAL_HORIZON]) || BLINK(OSD_ARTIFICIAL_HORIZON))
+            return OSD_ELEMENT_HIDDEN;
+        return osdCenterRow();
+
+    case OSD_ARTIFICIAL_HORIZON:
+    {
+        const int rollAngle = constrain(attitude.values.roll, -AH_MAX_ROLL, AH_MAX_ROLL);
+        const int pitchAngle = constrain(attitude.values.pitch, -AH_MAX_PITCH, AH_MAX_PITCH);
+        return ((pitchAngle / 8) & 0xFF) | ((rollAngle & 0xFFFF) << 8) | (osdCenterRow() << 24);
+    }
+
+    case OSD_ROLL_PIDS:
+        return osdGetPidsValue(PIDROLL);
+
+    case OSD_PITCH_PIDS:
+        return osdGetPidsValue(PIDPITCH);
+
+    case OSD_YAW_PIDS:
+        return osdGetPidsValue(PIDYAW);
+
+    case OSD_POWER:
+        return amperage * getVbat() / 1000;
+
+    case OSD_PIDRATE_PROFILE:
+    {
+        const uint8_t profileIndex = masterConfig.current_profile_index;
+        return profileIndex | (masterConfig.profile[profileIndex].activeRateProfile << 8);
+    }
+
+    case OSD_MAIN_BATT_WARNING:
+        if (getVbat() > (batteryWarningVoltage - 1))
+            return OSD_ELEMENT_HIDDEN;
+        return 1;
+
+    default:
+        return OSD_ELEMENT_HIDDEN;
+    }
+}
+
+static void osdDrawSingleElement(uint8_t item)
+{
+    osdElementCache_t *cache = &elementCache[item];
     uint8_t elemPosX = OSD_X(osdProfile()->item_pos[item]);
     uint8_t elemPosY = OSD_Y(osdProfile()->item_pos[item]);
     char buff[32];
@@ -157,12 +434,8 @@ static void osdDrawSingleElement(uint8_t item)
     switch(item) {
         case OSD_RSSI_VALUE:
         {
-            uint16_t osdRssi = rssi * 100 / 1024; // change range
-            if (osdRssi >= 100)
-                osdRssi = 99;
-
             buff[0] = SYM_RSSI;
-            sprintf(buff + 1, "%d", osdRssi);
+            sprintf(buff + 1, "%d", osdGetRssi());
             break;
         }
 
@@ -226,20 +499,8 @@ static void osdDrawSingleElement(uint8_t item)
 
         case OSD_FLYMODE:
         {
-            char *p = "ACRO";
-
-            if (isAirmodeActive())
-                p = "AIR";
-
-            if (FLIGHT_MODE(FAILSAFE_MODE))
-                p = "!FS";
-            else if (FLIGHT_MODE(ANGLE_MODE))
-                p = "STAB";
-            else if (FLIGHT_MODE(HORIZON_MODE))
-                p = "HOR";
-
-            displayWrite(osdDisplayPort, elemPosX, elemPosY, p);
-            return;
+            strcpy(buff, osdGetFlightModeString());
+            break;
         }
 
         case OSD_CRAFT_NAME:
@@ -252,6 +513,7 @@ static void osdDrawSingleElement(uint8_t item)
                     if (masterConfig.name[i] == 0)
                         break;
                 }
+                buff[MAX_NAME_LENGTH] = 0;
             }
 
             break;
@@ -261,7 +523,7 @@ static void osdDrawSingleElement(uint8_t item)
         {
             buff[0] = SYM_THR;
             buff[1] = SYM_THR1;
-            sprintf(buff + 2, "%d", (constrain(rcData[THROTTLE], PWM_RANGE_MIN, PWM_RANGE_MAX) - PWM_RANGE_MIN) * 100 / (PWM_RANGE_MAX - PWM_RANGE_MIN));
+            sprintf(buff + 2, "%d", osdGetThrottlePercent());
             break;
         }
 
@@ -275,10 +537,7 @@ static void osdDrawSingleElement(uint8_t item)
 
         case OSD_CROSSHAIRS:
             elemPosX = 14 - 1; // Offset for 1 char to the left
-            elemPosY = 6;
-            if (displayScreenSize(osdDisplayPort) == VIDEO_BUFFER_CHARS_PAL) {
-                ++elemPosY;
-            }
+            elemPosY = osdCenterRow();
             buff[0] = SYM_AH_CENTER_LINE;
             buff[1] = SYM_AH_CENTER;
             buff[2] = SYM_AH_CENTER_LINE_RIGHT;
@@ -288,15 +547,11 @@ static void osdDrawSingleElement(uint8_t item)
         case OSD_ARTIFICIAL_HORIZON:
         {
             elemPosX = 14;
-            elemPosY = 6 - 4; // Top center of the AH area
+            elemPosY = osdCenterRow() - 4; // Top center of the AH area
 
             int rollAngle = attitude.values.roll;
             int pitchAngle = attitude.values.pitch;
 
-            if (displayScreenSize(osdDisplayPort) == VIDEO_BUFFER_CHARS_PAL) {
-                ++elemPosY;
-            }
-
             if (pitchAngle > AH_MAX_PITCH)
                 pitchAngle = AH_MAX_PITCH;
             if (pitchAngle < -AH_MAX_PITCH)
@@ -309,28 +564,26 @@ static void osdDrawSingleElement(uint8_t item)
             // Convert pitchAngle to y compensation value
             pitchAngle = (pitchAngle / 8) - 41; // 41 = 4 * 9 + 5
 
+            cache->x = elemPosX - 4;
             for (int8_t x = -4; x <= 4; x++) {
                 int y = (-rollAngle * x) / 64;
                 y -= pitchAngle;
                 // y += 41; // == 4 * 9 + 5
                 if (y >= 0 && y <= 81) {
                     displayWriteChar(osdDisplayPort, elemPosX + x, elemPosY + (y / 9), (SYM_AH_BAR9_0 + (y % 9)));
+                    ahDrawnRows[x + 4] = elemPosY + (y / 9);
+                } else {
+                    ahDrawnRows[x + 4] = -1;
                 }
             }
 
-            osdDrawSingleElement(OSD_HORIZON_SIDEBARS);
-
             return;
         }
 
         case OSD_HORIZON_SIDEBARS:
         {
             elemPosX = 14;
-            elemPosY = 6;
-
-            if (displayScreenSize(osdDisplayPort) == VIDEO_BUFFER_CHARS_PAL) {
-                ++elemPosY;
-            }
+            elemPosY = osdCenterRow();
 
             // Draw AH sides
             int8_t hudwidth = AH_SIDEBAR_WIDTH_POS;
@@ -344,6 +597,9 @@ static void osdDrawSingleElement(uint8_t item)
             displayWriteChar(osdDisplayPort, elemPosX - hudwidth + 1, elemPosY, SYM_AH_LEFT);
             displayWriteChar(osdDisplayPort, elemPosX + hudwidth - 1, elemPosY, SYM_AH_RIGHT);
 
+            cache->x = elemPosX;
+            cache->y = elemPosY;
+            cache->length = 1;
             return;
         }
 
@@ -384,9 +640,6 @@ static void osdDrawSingleElement(uint8_t item)
 
         case OSD_MAIN_BATT_WARNING:
         {
-            if (getVbat() > (batteryWarningVoltage - 1))
-              return;
-
             sprintf(buff, "LOW VOLTAGE");
             break;
         }
@@ -396,62 +649,83 @@ static void osdDrawSingleElement(uint8_t item)
     }
 
     displayWrite(osdDisplayPort, elemPosX, elemPosY, buff);
+    cache->x = elemPosX;
+    cache->y = elemPosY;
+    cache->length = strlen(buff);
 }
 
-void osdDrawElements(void)
+static void osdClearDirtyCells(void)
 {
-    displayClearScreen(osdDisplayPort);
+    for (uint8_t y = 0; y < OSD_MAX_ROWS; y++) {
+        if (!dirtyCells[y]) {
+            continue;
+        }
+        for (uint8_t x = 0; x < OSD_MAX_COLS; x++) {
+            if (dirtyCells[y] & (1u << x)) {
+                displayWriteChar(osdDisplayPort, x, y, ' ');
+            }
+        }
+    }
+}
 
+void osdDrawElements(void)
+{
     /* Hide OSD when OSDSW mode is active */
-    if (IS_RC_MODE_ACTIVE(BOXOSD))
+    if (IS_RC_MODE_ACTIVE(BOXOSD)) {
+      displayClearScreen(osdDisplayPort);
+      osdInvalidateElements();
       return;
+    }
 
-#if 0
-    if (currentElement)
-        osdDrawElementPositioningHelp();
-#else
-    if (false)
-        ;
-#endif
-#ifdef CMS
-    else if (sensors(SENSOR_ACC) || displayIsGrabbed(osdDisplayPort))
-#else
-    else if (sensors(SENSOR_ACC))
-#endif
-    {
-        osdDrawSingleElement(OSD_ARTIFICIAL_HORIZON);
-        osdDrawSingleElement(OSD_CROSSHAIRS);
+    if (elementsInvalid) {
+        displayClearScreen(osdDisplayPort);
+        memset(elementCache, 0, sizeof(elementCache));
+        memset(ahDrawnRows, -1, sizeof(ahDrawnRows));
+        elementsInvalid = false;
     }
 
-    osdDrawSingleElement(OSD_MAIN_BATT_VOLTAGE);
-    osdDrawSingleElement(OSD_RSSI_VALUE);
-    osdDrawSingleElement(OSD_FLYTIME);
-    osdDrawSingleElement(OSD_ONTIME);
-    osdDrawSingleElement(OSD_FLYMODE);
-    osdDrawSingleElement(OSD_THROTTLE_POS);
-    osdDrawSingleElement(OSD_VTX_CHANNEL);
-    osdDrawSingleElement(OSD_CURRENT_DRAW);
-    osdDrawSingleElement(OSD_MAH_DRAWN);
-    osdDrawSingleElement(OSD_CRAFT_NAME);
-    osdDrawSingleElement(OSD_ALTITUDE);
-    osdDrawSingleElement(OSD_ROLL_PIDS);
-    osdDrawSingleElement(OSD_PITCH_PIDS);
-    osdDrawSingleElement(OSD_YAW_PIDS);
-    osdDrawSingleElement(OSD_POWER);
-    osdDrawSingleElement(OSD_PIDRATE_PROFILE);
-    osdDrawSingleElement(OSD_MAIN_BATT_WARNING);
+    memset(dirtyCells, 0, sizeof(dirtyCells));
+
+    // find the elements that changed and erase what they drew last time
+    uint32_t changed = 0;
+    int32_t values[ARRAYLEN(osdElementDrawOrder)];
+    for (unsigned i = 0; i < ARRAYLEN(osdElementDrawOrder); i++) {
+        const uint8_t item = osdElementDrawOrder[i];
+        const osdElementCache_t *cache = &elementCache[item];
+        values[i] = osdGetElementValue(item);
+        if (!cache->valid || cache->value != values[i] || cache->itemPos != osdProfile()->item_pos[item]) {
+            changed |= 1 << i;
+            osdElementCellsOp(item, true);
+        }
+    }
 
-#ifdef GPS
-#ifdef CMS
-    if (sensors(SENSOR_GPS) || displayIsGrabbed(osdDisplayPort))
-#else
-    if (sensors(SENSOR_GPS))
-#endif
-    {
-        osdDrawSingleElement(OSD_GPS_SATS);
-        osdDrawSingleElement(OSD_GPS_SPEED);
+    if (!changed) {
+        return;
+    }
+
+    osdClearDirtyCells();
+
+    // redraw the changed elements, and the unchanged ones that lost cells to the erase or to an element drawn over them
+    for (unsigned i = 0; i < ARRAYLEN(osdElementDrawOrder); i++) {
+        const uint8_t item = osdElementDrawOrder[i];
+        osdElementCache_t *cache = &elementCache[item];
+
+        if (!(changed & (1 << i)) && !osdElementCellsOp(item, false)) {
+            continue;
+        }
+
+        cache->length = 0;
+        if (item == OSD_ARTIFICIAL_HORIZON) {
+            memset(ahDrawnRows, -1, sizeof(ahDrawnRows));
+        }
+        if (values[i] != OSD_ELEMENT_HIDDEN) {
+            osdDrawSingleElement(item);
+            osdElementCellsOp(item, true);
+        }
+        cache->value = values[i];
+        cache->itemPos = osdProfile()->item_pos[item];
+        cache->valid = true;
     }
-#endif // GPS
 }
 
 void osdResetConfig(osd_profile_t *osdProfile)
@@ -518,6 +792,7 @@ void osdInit(displayPort_t *osdDisplayPortToUse)
 #endif
 
     displayResync(osdDisplayPort);
+    osdInvalidateElements();
 
     refreshTimeout = 4 * REFRESH_1S;
 }
@@ -616,6 +891,7 @@ static void osdShowStats(void)
     char buff[10];
 
     displayClearScreen(osdDisplayPort);
+    osdInvalidateElements();
     displayWrite(osdDisplayPort, 2, top++, "  --- STATS ---");
 
     if (STATE(GPS_FIX)) {
@@ -657,6 +933,7 @@ static void osdShowStats(void)
 static void osdArmMotors(void)
 {
     displayClearScreen(osdDisplayPort);
+    osdInvalidateElements();
     displayWrite(osdDisplayPort, 12, 7, "ARMED");
     refreshTimeout = REFRESH_1S / 2;
     osdResetStats();
@@ -665,6 +942,9 @@ static void osdArmMotors(void)
 static void osdRefresh(timeUs_t currentTimeUs)
 {
     static uint8_t lastSec = 0;
+#ifdef CMS
+    static bool wasGrabbed = false;
+#endif
     uint8_t sec;
 
     // detect arm/disarm
@@ -690,8 +970,10 @@ static void osdRefresh(timeUs_t currentTimeUs)
         if (IS_HI(THROTTLE) || IS_HI(PITCH)) // hide statistics
             refreshTimeout = 1;
         refreshTimeout--;
-        if (!refreshTimeout)
+        if (!refreshTimeout) {
             displayClearScreen(osdDisplayPort);
+            osdInvalidateElements();
+        }
         return;
     }
 
@@ -699,11 +981,17 @@ static void osdRefresh(timeUs_t currentTimeUs)
 
 #ifdef CMS
     if (!displayIsGrabbed(osdDisplayPort)) {
+        if (wasGrabbed) {
+            // the menu drew over everything
+            osdInvalidateElements();
+            wasGrabbed = false;
+        }
         osdUpdateAlarms();
         osdDrawElements();
         displayHeartbeat(osdDisplayPort); // heartbeat to stop Minim OSD going back into native mode
-#ifdef OSD_CALLS_CMS
     } else {
+        wasGrabbed = true;
+#ifdef OSD_CALLS_CMS
         cmsUpdate(currentTimeUs);
 #endif
     }
@@ -729,10 +1017,17 @@ void osdUpdate(timeUs_t currentTimeUs)
 #else
 #define DRAW_FREQ_DENOM 10 // MWOSD @ 115200 baud
 #endif
+    // DEBUG_OSD, timings for:
+    // 0 - osdRefresh()
+    // 1 - displayDrawScreen()
+    uint32_t startTime = 0;
+    if (debugMode == DEBUG_OSD) {startTime = micros();}
     if (counter++ % DRAW_FREQ_DENOM == 0) {
         osdRefresh(currentTimeUs);
+        DEBUG_SET(DEBUG_OSD, 0, micros() - startTime);
     } else { // rest of time redraw screen 10 chars per idle so it doesn't lock the main idle
         displayDrawScreen(osdDisplayPort);
+        DEBUG_SET(DEBUG_OSD, 1, micros() - startTime);
     }
 
 #ifdef CMS
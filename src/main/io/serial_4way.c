@@ -24,6 +24,8 @@
 
 #ifdef  USE_SERIAL_4WAY_BLHELI_INTERFACE
 
+#include "common/maths.h"
+
 #include "drivers/buf_writer.h"
 #include "drivers/io.h"
 #include "drivers/serial.h"
@@ -73,7 +75,7 @@
 #define SERIAL_4WAY_VER_SUB_1 (uint8_t) 4
 #define SERIAL_4WAY_VER_SUB_2 (uint8_t) 04
 
-#define SERIAL_4WAY_PROTOCOL_VER 106
+#define SERIAL_4WAY_PROTOCOL_VER 107
 // *** end
 
 #if (SERIAL_4WAY_VER_MAIN > 24)
@@ -254,6 +256,12 @@ void esc4wayRelease(void)
 // PARAM: uint8_t Mode
 // RETURN: ACK or ACK_I_INVALID_CHANNEL
 
+// Verify Device Memory of connected Device against a CRC16 (XMODEM, as the frames) of the expected content
+// The interface reads the range back from the Device, only the CRC travels over the host link
+#define cmd_DeviceVerifyCrc 0x41    // 'A' since 107
+// PARAM: uint8_t LEN_Hi + LEN_Lo + CRC_Hi + CRC_Lo
+// RETURN: PARAM: uint8_t CRC_Hi + CRC_Lo of the Device content + ACK or ACK_I_VERIFY_ERROR
+
 // responses
 #define ACK_OK                  0x00
 // #define ACK_I_UNKNOWN_ERROR       0x01
@@ -363,6 +371,50 @@ static uint8_t Connect(uint8_32_u *pDeviceInfo)
     return 0;
 }
 
+static uint8_t DeviceReadFlash(ioMem_t *pMem)
+{
+    switch (CurrentInterfaceMode)
+    {
+        #ifdef USE_SERIAL_4WAY_BLHELI_BOOTLOADER
+        case imSIL_BLB:
+        case imATM_BLB:
+            return BL_ReadFlash(CurrentInterfaceMode, pMem);
+        #endif
+        #ifdef USE_SERIAL_4WAY_SK_BOOTLOADER
+        case imSK:
+            return Stk_ReadFlash(pMem);
+        #endif
+        default:
+            return 0;
+    }
+}
+
+// Reads LEN bytes back in blocks of 256, the largest the bootloaders transfer at once
+static uint8_t DeviceVerifyCrc(ioMem_t *pMem, uint16_t len, uint16_t *crc)
+{
+    uint16_t address = (pMem->D_FLASH_ADDR_H << 8) | pMem->D_FLASH_ADDR_L;
+
+    *crc = 0;
+    while (len > 0) {
+        const uint16_t blockLen = MIN(len, 256);
+        ioMem_t block;
+        block.D_NUM_BYTES = (uint8_t)blockLen; // 256 wraps to 0
+        block.D_FLASH_ADDR_H = address >> 8;
+        block.D_FLASH_ADDR_L = address & 0xFF;
+        block.D_PTR_I = pMem->D_PTR_I;
+
+        if (!DeviceReadFlash(&block)) {
+            return 0;
+        }
+        for (uint16_t i = 0; i < blockLen; i++) {
+            *crc = _crc_xmodem_update(*crc, block.D_PTR_I[i]);
+        }
+        address += blockLen;
+        len -= blockLen;
+    }
+    return 1;
+}
+
 static serialPort_t *port;
 
 static uint8_t ReadByte(void)
@@ -672,6 +724,29 @@ void esc4wayProcess(serialPort_t *mspPort)
                     break;
                 }
 
+                case cmd_DeviceVerifyCrc:
+                {
+                    const uint16_t len = (ParamBuf[0] << 8) | ParamBuf[1];
+                    const uint16_t expectedCrc = (ParamBuf[2] << 8) | ParamBuf[3];
+                    uint16_t crc;
+
+                    if ((I_PARAM_LEN != 4) || (len == 0)) {
+                        ACK_OUT = ACK_I_INVALID_PARAM;
+                        break;
+                    }
+                    if (!DeviceVerifyCrc(&ioMem, len, &crc)) {
+                        ACK_OUT = ACK_D_GENERAL_ERROR;
+                        break;
+                    }
+                    if (crc != expectedCrc) {
+                        ACK_OUT = ACK_I_VERIFY_ERROR;
+                    }
+                    O_PARAM_LEN = 2;
+                    Dummy.bytes[0] = crc >> 8;
+                    Dummy.bytes[1] = crc & 0xFF;
+                    break;
+                }
+
                 case cmd_DeviceReadEEprom:
                 {
                     ioMem.D_NUM_BYTES = ParamBuf[0];
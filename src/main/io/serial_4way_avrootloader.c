@@ -26,6 +26,8 @@
 
 #ifdef  USE_SERIAL_4WAY_BLHELI_INTERFACE
 
+#include "common/time.h"
+
 #include "drivers/io.h"
 #include "drivers/system.h"
 #include "drivers/serial.h"
@@ -68,6 +70,7 @@
 
 
 #define START_BIT_TIMEOUT_MS 2
+#define START_BIT_TIMEOUT_US (START_BIT_TIMEOUT_MS * 1000)
 
 #define BIT_TIME (52)       // 52uS
 #define BIT_TIME_HALVE      (BIT_TIME >> 1) // 26uS
@@ -75,15 +78,18 @@
 #define START_BIT_TIME      (BIT_TIME_3_4)
 //#define STOP_BIT_TIME     ((BIT_TIME * 9) + BIT_TIME_HALVE)
 
-static uint8_t suart_getc_(uint8_t *bt)
+// the bootloader does not answer CMD_SET_BUFFER, keep the margin of the three start bit timeouts it was given before
+#define NO_ANSWER_TIMEOUT_US (START_BIT_TIMEOUT_US * 3)
+
+static uint8_t suart_getc_(uint8_t *bt, uint32_t timeoutUs)
 {
     uint32_t btime;
     uint32_t start_time;
 
-    uint32_t wait_time = millis() + START_BIT_TIMEOUT_MS;
+    const uint32_t wait_time = micros() + timeoutUs;
     while (ESC_IS_HI) {
         // check for startbit begin
-        if (millis() >= wait_time) {
+        if (cmpTimeUs(micros(), wait_time) >= 0) {
             return 0;
         }
     }
@@ -92,7 +98,7 @@ static uint8_t suart_getc_(uint8_t *bt)
     btime = start_time + START_BIT_TIME;
     uint16_t bitmask = 0;
     uint8_t bit = 0;
-    while (micros() < btime);
+    while (cmpTimeUs(micros(), btime) < 0);
     while(1) {
         if (ESC_IS_HI)
         {
@@ -101,7 +107,7 @@ static uint8_t suart_getc_(uint8_t *bt)
         btime = btime + BIT_TIME;
         bit++;
         if (bit == 10) break;
-        while (micros() < btime);
+        while (cmpTimeUs(micros(), btime) < 0);
     }
     // check start bit and stop bit
     if ((bitmask & 1) || (!(bitmask & (1 << 9)))) {
@@ -126,7 +132,7 @@ static void suart_putc_(uint8_t *tx_b)
         btime = btime + BIT_TIME;
         bitmask = (bitmask >> 1);
         if (bitmask == 0) break; // stopbit shifted out - but don't wait
-        while (micros() < btime);
+        while (cmpTimeUs(micros(), btime) < 0);
     }
 }
 
@@ -155,7 +161,7 @@ static uint8_t BL_ReadBuf(uint8_t *pstring, uint8_t len)
     LastCRC_16.word = 0;
     uint8_t  LastACK = brNONE;
     do {
-        if(!suart_getc_(pstring)) goto timeout;
+        if(!suart_getc_(pstring, START_BIT_TIMEOUT_US)) goto timeout;
         ByteCrc(pstring);
         pstring++;
         len--;
@@ -163,14 +169,14 @@ static uint8_t BL_ReadBuf(uint8_t *pstring, uint8_t len)
 
     if(isMcuConnected()) {
         //With CRC read 3 more
-        if(!suart_getc_(&LastCRC_16.bytes[0])) goto timeout;
-        if(!suart_getc_(&LastCRC_16.bytes[1])) goto timeout;
-        if(!suart_getc_(&LastACK)) goto timeout;
+        if(!suart_getc_(&LastCRC_16.bytes[0], START_BIT_TIMEOUT_US)) goto timeout;
+        if(!suart_getc_(&LastCRC_16.bytes[1], START_BIT_TIMEOUT_US)) goto timeout;
+        if(!suart_getc_(&LastACK, START_BIT_TIMEOUT_US)) goto timeout;
         if (CRC_16.word != LastCRC_16.word) {
             LastACK = brERRORCRC;
         }
     } else {
-        if(!suart_getc_(&LastACK)) goto timeout;
+        if(!suart_getc_(&LastACK, START_BIT_TIMEOUT_US)) goto timeout;
     }
 timeout:
     return (LastACK == brSUCCESS);
@@ -232,12 +238,19 @@ uint8_t BL_ConnectEx(uint8_32_u *pDeviceInfo)
 static uint8_t BL_GetACK(uint32_t Timeout)
 {
     uint8_t LastACK = brNONE;
-    while (!(suart_getc_(&LastACK)) && (Timeout)) {
+    while (!(suart_getc_(&LastACK, START_BIT_TIMEOUT_US)) && (Timeout)) {
         Timeout--;
     } ;
     return (LastACK);
 }
 
+static bool BL_NoAnswer(void)
+{
+    uint8_t LastACK = brNONE;
+    suart_getc_(&LastACK, NO_ANSWER_TIMEOUT_US);
+    return (LastACK == brNONE);
+}
+
 uint8_t BL_SendCMDKeepAlive(void)
 {
     uint8_t sCMD[] = {CMD_KEEP_ALIVE, 0};
@@ -273,7 +286,7 @@ static uint8_t BL_SendCMDSetBuffer(ioMem_t *pMem)
         sCMD[2] = 1;
     }
     BL_SendBuf(sCMD, 4);
-    if (BL_GetACK(2) != brNONE) return 0;
+    if (!BL_NoAnswer()) return 0;
     BL_SendBuf(pMem->D_PTR_I, pMem->D_NUM_BYTES);
     return (BL_GetACK(40) == brSUCCESS);
 }
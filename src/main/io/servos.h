@@ -23,6 +23,7 @@
 typedef struct servoConfig_s {
     // PWM values, in milliseconds, common range is 1000-2000 (1 to 2ms)
     uint16_t servoCenterPulse;              // This is the value for servos when they should be in the middle. e.g. 1500.
-    uint16_t servoPwmRate;                  // The update rate of servo outputs (50-498Hz)
+    uint16_t servoPwmRate;                  // The update rate of servo outputs (50-498Hz, 50-1000Hz for narrow pulses)
+    uint8_t  servoPulseMode;                // servoPulseMode_e, narrow pulses are started by the PID loop
     ioTag_t  ioTags[MAX_SUPPORTED_SERVOS];
 } servoConfig_t;
@@ -37,6 +37,7 @@
 #include "io/serial.h"
 #include "io/vtx_smartaudio.h"
 #include "io/vtx_string.h"
+#include "io/vtx_transaction.h"
 
 #include "fc/rc_controls.h"
 #include "fc/runtime_config.h"
@@ -255,6 +256,15 @@ static int saDacToPowerIndex(int dac)
     return(0);
 }
 
+// Commands in flight and queued, see vtx_transaction.h
+
+#define SA_RESPONSE_TIMEOUT_US      (100 * 1000)
+#define SA_MAX_RETRIES              2
+#define SA_MAX_RESPONSE_LEN         (SA_MAX_RCVLEN + 3)     // preamble, code, length, data and CRC
+#define SA_HEARTBEAT_US             (1000 * 1000)
+
+static vtxTransactionEngine_t saTransactions;
+
 //
 // Autobauding
 //
@@ -265,8 +275,6 @@ uint16_t sa_smartbaud = SMARTBAUD_MIN;
 static int sa_adjdir = 1; // -1=going down, 1=going up
 static int sa_baudstep = 50;
 
-#define SMARTAUDIO_CMD_TIMEOUT    120
-
 static void saAutobaud(void)
 {
     if (saStat.pktsent < 10)
@@ -300,6 +308,7 @@ static void saAutobaud(void)
     dprintf(("autobaud: %d\r\n", sa_smartbaud));
 
     smartAudioSerialPort->vTable->serialSetBaudRate(smartAudioSerialPort, sa_smartbaud);
+    vtxTransactionSetBaudRate(&saTransactions, sa_smartbaud);
 
     saStat.pktsent = 0;
     saStat.pktrcvd = 0;
@@ -307,26 +316,20 @@ static void saAutobaud(void)
 
 // Transport level variables
 
-static uint32_t sa_lastTransmission = 0;
-static uint8_t sa_outstanding = SA_CMD_NONE; // Outstanding command
-static uint8_t sa_osbuf[32]; // Outstanding comamnd frame for retransmission
-static int sa_oslen;         // And associate length
+static timeUs_t sa_lastTransmission = 0;
 
 #ifdef CMS
 void saCmsUpdate(void);
 #endif
 
-static void saProcessResponse(uint8_t *buf, int len)
+static void saProcessResponse(uint8_t *buf, int len, timeUs_t currentTimeUs)
 {
     uint8_t resp = buf[0];
 
-    if (resp == sa_outstanding) {
-        sa_outstanding = SA_CMD_NONE;
-    } else if ((resp == SA_CMD_GET_SETTINGS_V2) && (sa_outstanding == SA_CMD_GET_SETTINGS)) {
-        sa_outstanding = SA_CMD_NONE;
-    } else {
+    // Version 2 devices answer GetSettings with their own code
+    if (!vtxTransactionResponse(&saTransactions, (resp == SA_CMD_GET_SETTINGS_V2) ? SA_CMD_GET_SETTINGS : resp, currentTimeUs)) {
         saStat.ooopresp++;
-        dprintf(("processResponse: outstanding %d got %d\r\n", sa_outstanding, resp));
+        dprintf(("processResponse: got %d out of order\r\n", resp));
     }
 
     switch(resp) {
@@ -402,7 +405,7 @@ static void saProcessResponse(uint8_t *buf, int len)
 // Datalink
 //
 
-static void saReceiveFramer(uint8_t c)
+static void saReceiveFramer(uint8_t c, timeUs_t currentTimeUs)
 {
 
     static enum saFramerState_e {
@@ -466,7 +469,7 @@ static void saReceiveFramer(uint8_t c)
     case S_WAITCRC:
         if (CRC8(sa_rbuf, 2 + len) == c) {
             // Got a response
-            saProcessResponse(sa_rbuf, len + 2);
+            saProcessResponse(sa_rbuf, len + 2, currentTimeUs);
             saStat.pktrcvd++;
         } else if (sa_rbuf[0] & 1) {
             // Command echo
@@ -480,123 +483,50 @@ static void saReceiveFramer(uint8_t c)
     }
 }
 
-static void saSendFrame(uint8_t *buf, int len)
+static void saSendFrame(const vtxTransaction_t *transaction)
 {
-    int i;
-
-    serialWrite(smartAudioSerialPort, 0x00); // Generate 1st start bit
-
-    for (i = 0 ; i < len ; i++)
-        serialWrite(smartAudioSerialPort, buf[i]);
+    serialWriteBuf(smartAudioSerialPort, transaction->frame, transaction->length);
 
-    serialWrite(smartAudioSerialPort, 0x00); // XXX Probably don't need this
-
-    sa_lastTransmission = millis();
     saStat.pktsent++;
 }
 
 /*
- * Retransmission and command queuing
- *
- *   The transport level support includes retransmission on response timeout
- * and command queueing.
+ * Command pipelining
  *
- * Resend buffer:
- *   The smartaudio returns response for valid command frames in no less
- * than 60msec, which we can't wait. So there's a need for a resend buffer.
+ *   Commands are queued in the transaction engine, which sends the next one
+ * as soon as the response to the previous one has been parsed, and resends
+ * a command whose response did not arrive within the frame times plus the
+ * device's turnaround.
  *
- * Command queueing:
- *   The driver autonomously sends GetSettings command for auto-bauding,
- * asynchronous to user initiated commands; commands issued while another
- * command is outstanding must be queued for later processing.
- *   The queueing also handles the case in which multiple commands are
- * required to implement a user level command.
+ *   A newer command of the same kind replaces one that was not sent yet, so
+ * stepping through channels in the CMS only sends the last one. Setting
+ * commands are followed by a GetSettings to read back what was applied.
  */
 
-// Retransmission
-
-static void saResendCmd(void)
-{
-    saSendFrame(sa_osbuf, sa_oslen);
-}
-
-static void saSendCmd(uint8_t *buf, int len)
+// Frames are sent with a leading zero to generate the first start bit, and a trailing one
+static void saQueueCmd(const uint8_t *buf, int len, uint8_t command)
 {
-    int i;
+    uint8_t frame[VTX_TRANSACTION_MAX_FRAME];
 
-    for (i = 0 ; i < len ; i++)
-        sa_osbuf[i] = buf[i];
+    frame[0] = 0x00;
+    memcpy(&frame[1], buf, len);
+    frame[len + 1] = 0x00;
 
-    sa_oslen = len;
-    sa_outstanding = (buf[2] >> 1);
-
-    saSendFrame(sa_osbuf, sa_oslen);
-}
-
-// Command queue management
-
-typedef struct saCmdQueue_s {
-    uint8_t *buf;
-    int len;
-} saCmdQueue_t;
-
-#define SA_QSIZE 4     // 1 heartbeat (GetSettings) + 2 commands + 1 slack
-static saCmdQueue_t sa_queue[SA_QSIZE];
-static uint8_t sa_qhead = 0;
-static uint8_t sa_qtail = 0;
-
-#ifdef DPRINTF_SMARTAUDIO
-static int saQueueLength()
-{
-    if (sa_qhead >= sa_qtail) {
-        return sa_qhead - sa_qtail;
-    } else {
-        return SA_QSIZE + sa_qhead - sa_qtail;
-    }
-}
-#endif
-
-static bool saQueueEmpty()
-{
-    return sa_qhead == sa_qtail;
-}
-
-static bool saQueueFull()
-{
-    return ((sa_qhead + 1) % SA_QSIZE) == sa_qtail;
-}
-
-static void saQueueCmd(uint8_t *buf, int len)
-{
-    if (saQueueFull())
-         return;
-
-    sa_queue[sa_qhead].buf = buf;
-    sa_queue[sa_qhead].len = len;
-    sa_qhead = (sa_qhead + 1) % SA_QSIZE;
-}
-
-static void saSendQueue(void)
-{
-    if (saQueueEmpty())
-         return;
-
-    saSendCmd(sa_queue[sa_qtail].buf, sa_queue[sa_qtail].len);
-    sa_qtail = (sa_qtail + 1) % SA_QSIZE;
+    vtxTransactionQueue(&saTransactions, frame, len + 2, command, buf[2] >> 1, SA_MAX_RESPONSE_LEN, micros());
 }
 
 // Individual commands
 
 static void saGetSettings(void)
 {
-    static uint8_t bufGetSettings[5] = {0xAA, 0x55, SACMD(SA_CMD_GET_SETTINGS), 0x00, 0x9F};
+    const uint8_t bufGetSettings[5] = {0xAA, 0x55, SACMD(SA_CMD_GET_SETTINGS), 0x00, 0x9F};
 
-    saQueueCmd(bufGetSettings, 5);
+    saQueueCmd(bufGetSettings, 5, SA_CMD_GET_SETTINGS);
 }
 
 static void saSetFreq(uint16_t freq)
 {
-    static uint8_t buf[7] = { 0xAA, 0x55, SACMD(SA_CMD_SET_FREQ), 2 };
+    uint8_t buf[7] = { 0xAA, 0x55, SACMD(SA_CMD_SET_FREQ), 2 };
 
     if (freq & SA_FREQ_GETPIT) {
         dprintf(("smartAudioSetFreq: GETPIT\r\n"));
@@ -610,7 +540,13 @@ static void saSetFreq(uint16_t freq)
     buf[5] = freq & 0xff;
     buf[6] = CRC8(buf, 6);
 
-    saQueueCmd(buf, 7);
+    if (freq & (SA_FREQ_GETPIT|SA_FREQ_SETPIT)) {
+        // pit mode frequency, the response tells all there is
+        saQueueCmd(buf, 7, VTX_TRANSACTION_NO_MERGE);
+    } else {
+        saQueueCmd(buf, 7, SA_CMD_SET_FREQ);
+        saGetSettings();
+    }
 }
 
 #if 0
@@ -627,27 +563,29 @@ static void saGetPitFreq(void)
 
 void saSetBandChan(uint8_t band, uint8_t chan)
 {
-    static uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_CHAN), 1 };
+    uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_CHAN), 1 };
 
     buf[4] = band * 8 + chan;
     buf[5] = CRC8(buf, 5);
 
-    saQueueCmd(buf, 6);
+    saQueueCmd(buf, 6, SA_CMD_SET_CHAN);
+    saGetSettings();
 }
 
 static void saSetMode(int mode)
 {
-    static uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_MODE), 1 };
+    uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_MODE), 1 };
 
     buf[4] = (mode & 0x3f)|saLockMode;
     buf[5] = CRC8(buf, 5);
 
-    saQueueCmd(buf, 6);
+    saQueueCmd(buf, 6, SA_CMD_SET_MODE);
+    saGetSettings();
 }
 
 void saSetPowerByIndex(uint8_t index)
 {
-    static uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_POWER), 1 };
+    uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_POWER), 1 };
 
     dprintf(("saSetPowerByIndex: index %d\r\n", index));
 
@@ -661,7 +599,8 @@ void saSetPowerByIndex(uint8_t index)
 
     buf[4] = (saDevice.version == 1) ? saPowerTable[index].valueV1 : saPowerTable[index].valueV2;
     buf[5] = CRC8(buf, 5);
-    saQueueCmd(buf, 6);
+    saQueueCmd(buf, 6, SA_CMD_SET_POWER);
+    saGetSettings();
 }
 
 bool smartAudioInit()
@@ -685,6 +624,8 @@ bool smartAudioInit()
         return false;
     }
 
+    vtxTransactionInit(&saTransactions, 4800, SA_RESPONSE_TIMEOUT_US, 0, SA_MAX_RETRIES);
+
     vtxSmartAudio.vTable = &saVTable;
     vtxCommonRegisterDevice(&vtxSmartAudio);
 
@@ -700,7 +641,7 @@ void vtxSAProcess(uint32_t now)
 
     while (serialRxBytesWaiting(smartAudioSerialPort) > 0) {
         uint8_t c = serialRead(smartAudioSerialPort);
-        saReceiveFramer((uint16_t)c);
+        saReceiveFramer((uint16_t)c, now);
     }
 
     // Re-evaluate baudrate after each frame reception
@@ -709,26 +650,18 @@ void vtxSAProcess(uint32_t now)
     if (!initialSent) {
         saGetSettings();
         saSetFreq(SA_FREQ_GETPIT);
-        saSendQueue();
         initialSent = true;
-        return;
-    }
-
-    if ((sa_outstanding != SA_CMD_NONE)
-            && (now - sa_lastTransmission > SMARTAUDIO_CMD_TIMEOUT)) {
-        // Last command timed out
-        // dprintf(("process: resending 0x%x\r\n", sa_outstanding));
-        // XXX Todo: Resend termination and possible offline transition
-        saResendCmd();
-    } else if (!saQueueEmpty()) {
-        // Command pending. Send it.
-        // dprintf(("process: sending queue\r\n"));
-        saSendQueue();
-    } else if (now - sa_lastTransmission >= 1000) {
+    } else if (!vtxTransactionIsBusy(&saTransactions) && cmpTimeUs(now, sa_lastTransmission) >= SA_HEARTBEAT_US) {
         // Heart beat for autobauding
         //dprintf(("process: sending heartbeat\r\n"));
         saGetSettings();
-        saSendQueue();
+    }
+
+    // Next command, or a resend if the device did not answer in time
+    const vtxTransaction_t *transaction = vtxTransactionNext(&saTransactions, now);
+    if (transaction) {
+        saSendFrame(transaction);
+        sa_lastTransmission = now;
     }
 
 #ifdef SMARTAUDIO_TEST_VTX_COMMON
@@ -764,6 +697,11 @@ bool vtxSAIsReady(void)
     return !(saDevice.version == 0);
 }
 
+bool vtxSAIsBusy(void)
+{
+    return vtxTransactionIsBusy(&saTransactions);
+}
+
 void vtxSASetBandChan(uint8_t band, uint8_t chan)
 {
     if (band && chan)
@@ -835,6 +773,7 @@ static vtxVTable_t saVTable = {
     .process = vtxSAProcess,
     .getDeviceType = vtxSAGetDeviceType,
     .isReady = vtxSAIsReady,
+    .isBusy = vtxSAIsBusy,
     .setBandChan = vtxSASetBandChan,
     .setPowerByIndex = vtxSASetPowerByIndex,
     .setPitmode = vtxSASetPitmode,
@@ -37,6 +37,7 @@
 #include "drivers/vtx_common.h"
 #include "io/vtx_tramp.h"
 #include "io/vtx_string.h"
+#include "io/vtx_transaction.h"
 
 #define TRAMP_SERIAL_OPTIONS (SERIAL_BIDIR)
 
@@ -64,9 +65,16 @@ static vtxDevice_t vtxTramp = {
 
 static serialPort_t *trampSerialPort = NULL;
 
-static uint8_t trampReqBuffer[16];
 static uint8_t trampRespBuffer[16];
 
+// Queries are answered, settings are not and are read back with a 'v' query once applied
+#define TRAMP_FRAME_LEN             16
+#define TRAMP_RESPONSE_TIMEOUT_US   (100 * 1000)
+#define TRAMP_SETTLE_US             (50 * 1000)
+#define TRAMP_TRANSACTION_RETRIES   2
+
+static vtxTransactionEngine_t trampTransactions;
+
 typedef enum {
     TRAMP_STATUS_BAD_DEVICE = -1,
     TRAMP_STATUS_OFFLINE = 0,
@@ -102,10 +110,7 @@ uint8_t  trampPowerRetries = 0;
 static void trampCmsUpdateStatusString(void); // Forward
 #endif
 
-static void trampWriteBuf(uint8_t *buf)
-{
-    serialWriteBuf(trampSerialPort, buf, 16);
-}
+void trampQueryV(void); // Forward
 
 static uint8_t trampChecksum(uint8_t *trampBuf)
 {
@@ -117,18 +122,27 @@ static uint8_t trampChecksum(uint8_t *trampBuf)
     return cksum;
 }
 
-void trampCmdU16(uint8_t cmd, uint16_t param)
+static void trampQueueCmd(uint8_t cmd, uint16_t param, uint8_t response)
 {
+    uint8_t buf[TRAMP_FRAME_LEN];
+
     if (!trampSerialPort)
         return;
 
-    memset(trampReqBuffer, 0, ARRAYLEN(trampReqBuffer));
-    trampReqBuffer[0] = 15;
-    trampReqBuffer[1] = cmd;
-    trampReqBuffer[2] = param & 0xff;
-    trampReqBuffer[3] = (param >> 8) & 0xff;
-    trampReqBuffer[14] = trampChecksum(trampReqBuffer);
-    trampWriteBuf(trampReqBuffer);
+    memset(buf, 0, ARRAYLEN(buf));
+    buf[0] = 15;
+    buf[1] = cmd;
+    buf[2] = param & 0xff;
+    buf[3] = (param >> 8) & 0xff;
+    buf[14] = trampChecksum(buf);
+
+    vtxTransactionQueue(&trampTransactions, buf, TRAMP_FRAME_LEN, cmd, response,
+        (response == VTX_TRANSACTION_NO_RESPONSE) ? 0 : TRAMP_FRAME_LEN, micros());
+}
+
+void trampCmdU16(uint8_t cmd, uint16_t param)
+{
+    trampQueueCmd(cmd, param, VTX_TRANSACTION_NO_RESPONSE);
 }
 
 void trampSetFreq(uint16_t freq)
@@ -173,6 +187,7 @@ bool trampCommitChanges()
 void trampSetPitmode(uint8_t onoff)
 {
     trampCmdU16('I', onoff ? 0 : 1);
+    trampQueryV();
 }
 
 // returns completed response code
@@ -302,8 +317,7 @@ static char trampReceive(uint32_t currentTimeUs)
 
 void trampQuery(uint8_t cmd)
 {
-    trampResetReceiver();
-    trampCmdU16(cmd, 0);
+    trampQueueCmd(cmd, 0, cmd);
 }
 
 void trampQueryR(void)
@@ -335,6 +349,10 @@ void vtxTrampProcess(uint32_t currentTimeUs)
 
     char replyCode = trampReceive(currentTimeUs);
 
+    if (replyCode) {
+        vtxTransactionResponse(&trampTransactions, replyCode, currentTimeUs);
+    }
+
 #ifdef TRAMP_DEBUG
     debug[0] = trampStatus;
 #endif
@@ -392,10 +410,10 @@ void vtxTrampProcess(uint32_t currentTimeUs)
             }
 
             if(!done) {
+                // read back as soon as the device had time to apply it
+                trampQueryV();
                 trampStatus = TRAMP_STATUS_CHECK_FREQ_PW;
-
-                // delay next status query by 300ms
-                lastQueryTimeUs = currentTimeUs + 300 * 1000;
+                lastQueryTimeUs = currentTimeUs;
             }
             else {
                 // everything has been done, let's return to original state
@@ -409,9 +427,9 @@ void vtxTrampProcess(uint32_t currentTimeUs)
         break;
 
     case TRAMP_STATUS_CHECK_FREQ_PW:
-        if (cmp32(currentTimeUs, lastQueryTimeUs) > 200 * 1000) {
-            trampQueryV();
-            lastQueryTimeUs = currentTimeUs;
+        // the read back got no answer after all retries, decide again on what we know
+        if (!vtxTransactionIsQueued(&trampTransactions, 'v')) {
+            trampStatus = TRAMP_STATUS_SET_FREQ_PW;
         }
         break;
 
@@ -419,6 +437,13 @@ void vtxTrampProcess(uint32_t currentTimeUs)
         break;
     }
 
+    const vtxTransaction_t *transaction = vtxTransactionNext(&trampTransactions, currentTimeUs);
+    if (transaction) {
+        // anything half received belongs to a response we gave up on
+        trampResetReceiver();
+        serialWriteBuf(trampSerialPort, transaction->frame, transaction->length);
+    }
+
 #ifdef TRAMP_DEBUG
     debug[1] = debugFreqReqCounter;
     debug[2] = debugPowReqCounter;
@@ -634,6 +659,11 @@ vtxDevType_e vtxTrampGetDeviceType(void)
     return VTXDEV_TRAMP;
 }
 
+bool vtxTrampIsBusy(void)
+{
+    return vtxTransactionIsBusy(&trampTransactions);
+}
+
 bool vtxTrampIsReady(void)
 {
     return trampStatus > TRAMP_STATUS_OFFLINE;
@@ -700,6 +730,7 @@ static vtxVTable_t trampVTable = {
     .process = vtxTrampProcess,
     .getDeviceType = vtxTrampGetDeviceType,
     .isReady = vtxTrampIsReady,
+    .isBusy = vtxTrampIsBusy,
     .setBandChan = vtxTrampSetBandChan,
     .setPowerByIndex = vtxTrampSetPowerByIndex,
     .setPitmode = vtxTrampSetPitmode,
@@ -722,6 +753,8 @@ bool trampInit()
         return false;
     }
 
+    vtxTransactionInit(&trampTransactions, 9600, TRAMP_RESPONSE_TIMEOUT_US, TRAMP_SETTLE_US, TRAMP_TRANSACTION_RETRIES);
+
 #if defined(VTX_COMMON)
     vtxTramp.vTable = &trampVTable;
     vtxCommonRegisterDevice(&vtxTramp);
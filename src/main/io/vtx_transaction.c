@@ -0,0 +1,195 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "io/vtx_transaction.h"
+
+// the device releases the line after the last byte of its response, give it this many byte times
+#define VTX_TRANSACTION_TURNAROUND_BYTES    2
+
+// whatever was initialised last is reported, like the device registered last with vtx_common
+static const vtxTransactionEngine_t *activeEngine = NULL;
+
+static vtxTransaction_t *vtxTransactionAt(vtxTransactionEngine_t *engine, int index)
+{
+    return &engine->queue[(engine->head + index) % VTX_TRANSACTION_QUEUE_SIZE];
+}
+
+static void vtxTransactionRemove(vtxTransactionEngine_t *engine, int index)
+{
+    for (int i = index; i < engine->count - 1; i++) {
+        *vtxTransactionAt(engine, i) = *vtxTransactionAt(engine, i + 1);
+    }
+    engine->count--;
+}
+
+static void vtxTransactionPop(vtxTransactionEngine_t *engine)
+{
+    engine->head = (engine->head + 1) % VTX_TRANSACTION_QUEUE_SIZE;
+    engine->count--;
+    engine->inFlight = false;
+}
+
+void vtxTransactionInit(vtxTransactionEngine_t *engine, uint32_t baudRate, uint32_t responseTimeoutUs, uint32_t settleUs, uint8_t maxRetries)
+{
+    memset(engine, 0, sizeof(*engine));
+    engine->responseTimeoutUs = responseTimeoutUs;
+    engine->settleUs = settleUs;
+    engine->maxRetries = maxRetries;
+    vtxTransactionSetBaudRate(engine, baudRate);
+
+    activeEngine = engine;
+}
+
+void vtxTransactionSetBaudRate(vtxTransactionEngine_t *engine, uint32_t baudRate)
+{
+    // start bit, 8 data bits and a stop bit
+    engine->usPerByte = (10 * 1000000 + baudRate - 1) / baudRate;
+}
+
+bool vtxTransactionQueue(vtxTransactionEngine_t *engine, const uint8_t *frame, uint8_t length, uint8_t command, uint8_t response, uint8_t responseLength, timeUs_t currentTimeUs)
+{
+    timeUs_t queuedUs = currentTimeUs;
+
+    if (length > VTX_TRANSACTION_MAX_FRAME) {
+        return false;
+    }
+
+    // a newer setting replaces one that was not sent yet, it goes last so it follows whatever was queued meanwhile
+    if (command != VTX_TRANSACTION_NO_MERGE) {
+        for (int i = engine->inFlight ? 1 : 0; i < engine->count; i++) {
+            if (vtxTransactionAt(engine, i)->command == command) {
+                queuedUs = vtxTransactionAt(engine, i)->queuedUs;
+                vtxTransactionRemove(engine, i);
+                break;
+            }
+        }
+    }
+
+    if (engine->count == VTX_TRANSACTION_QUEUE_SIZE) {
+        return false;
+    }
+
+    vtxTransaction_t *transaction = vtxTransactionAt(engine, engine->count);
+    memcpy(transaction->frame, frame, length);
+    transaction->length = length;
+    transaction->command = command;
+    transaction->response = response;
+    transaction->responseLength = responseLength;
+    transaction->queuedUs = queuedUs;
+    engine->count++;
+
+    return true;
+}
+
+static const vtxTransaction_t *vtxTransactionSend(vtxTransactionEngine_t *engine, timeUs_t currentTimeUs)
+{
+    const vtxTransaction_t *transaction = vtxTransactionAt(engine, 0);
+    const uint32_t frameUs = transaction->length * engine->usPerByte;
+
+    if (transaction->response == VTX_TRANSACTION_NO_RESPONSE) {
+        engine->lineFreeUs = currentTimeUs + frameUs + engine->settleUs;
+        engine->stats.completed++;
+        vtxTransactionPop(engine);
+        return transaction;
+    }
+
+    engine->inFlight = true;
+    engine->deadlineUs = currentTimeUs + frameUs + engine->responseTimeoutUs + transaction->responseLength * engine->usPerByte;
+    engine->lineFreeUs = engine->deadlineUs;
+
+    return transaction;
+}
+
+// The frame to write now, or NULL. Valid until the next call that queues.
+const vtxTransaction_t *vtxTransactionNext(vtxTransactionEngine_t *engine, timeUs_t currentTimeUs)
+{
+    if (engine->inFlight) {
+        if (cmpTimeUs(currentTimeUs, engine->deadlineUs) < 0) {
+            return NULL;
+        }
+
+        if (engine->retriesLeft > 0) {
+            engine->retriesLeft--;
+            engine->stats.retries++;
+            return vtxTransactionSend(engine, currentTimeUs);
+        }
+
+        // no answer, carry on with the rest
+        engine->stats.failed++;
+        vtxTransactionPop(engine);
+    }
+
+    if (engine->count == 0 || cmpTimeUs(currentTimeUs, engine->lineFreeUs) < 0) {
+        return NULL;
+    }
+
+    engine->retriesLeft = engine->maxRetries;
+    return vtxTransactionSend(engine, currentTimeUs);
+}
+
+// Returns false when the response does not belong to the command in flight
+bool vtxTransactionResponse(vtxTransactionEngine_t *engine, uint8_t response, timeUs_t currentTimeUs)
+{
+    if (!engine->inFlight || vtxTransactionAt(engine, 0)->response != response) {
+        engine->stats.outOfOrder++;
+        return false;
+    }
+
+    const uint32_t latencyUs = currentTimeUs - vtxTransactionAt(engine, 0)->queuedUs;
+
+    engine->stats.lastLatencyUs = latencyUs;
+    if (engine->stats.completed == 0) {
+        engine->stats.averageLatencyUs = latencyUs;
+    } else {
+        engine->stats.averageLatencyUs += ((int32_t)latencyUs - (int32_t)engine->stats.averageLatencyUs) / 8;
+    }
+    if (latencyUs > engine->stats.maxLatencyUs) {
+        engine->stats.maxLatencyUs = latencyUs;
+    }
+    engine->stats.completed++;
+
+    vtxTransactionPop(engine);
+    engine->lineFreeUs = currentTimeUs + VTX_TRANSACTION_TURNAROUND_BYTES * engine->usPerByte;
+
+    return true;
+}
+
+bool vtxTransactionIsBusy(const vtxTransactionEngine_t *engine)
+{
+    return engine->count > 0;
+}
+
+bool vtxTransactionIsQueued(const vtxTransactionEngine_t *engine, uint8_t command)
+{
+    for (int i = 0; i < engine->count; i++) {
+        if (engine->queue[(engine->head + i) % VTX_TRANSACTION_QUEUE_SIZE].command == command) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const vtxTransactionStats_t *vtxTransactionGetStats(void)
+{
+    return activeEngine ? &activeEngine->stats : NULL;
+}
@@ -0,0 +1,79 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/time.h"
+
+#define VTX_TRANSACTION_QUEUE_SIZE      6
+#define VTX_TRANSACTION_MAX_FRAME       16
+
+#define VTX_TRANSACTION_NO_RESPONSE     0       // complete once sent, the device does not answer
+#define VTX_TRANSACTION_NO_MERGE        0       // command key that is never merged with a queued one
+
+typedef struct vtxTransaction_s {
+    uint8_t frame[VTX_TRANSACTION_MAX_FRAME];   // bytes on the wire
+    uint8_t length;
+    uint8_t command;            // a newer command with the same key replaces a queued one
+    uint8_t response;           // response code that completes it
+    uint8_t responseLength;     // bytes the device answers with
+    timeUs_t queuedUs;
+} vtxTransaction_t;
+
+typedef struct vtxTransactionStats_s {
+    uint16_t completed;
+    uint16_t retries;
+    uint16_t failed;            // dropped after the last retry timed out
+    uint16_t outOfOrder;        // responses that did not match the command in flight
+    uint32_t lastLatencyUs;     // from queueing to the response being parsed
+    uint32_t averageLatencyUs;
+    uint32_t maxLatencyUs;
+} vtxTransactionStats_t;
+
+/*
+ * Half-duplex command/response sequencing for VTX control protocols.
+ *
+ * The next command goes out as soon as the response to the previous one has been parsed and the line
+ * has turned around. Timeouts are computed from the frame times at the current baud rate rather than
+ * fixed, so a lost response is retried after the time the device had to answer.
+ */
+typedef struct vtxTransactionEngine_s {
+    vtxTransaction_t queue[VTX_TRANSACTION_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+    bool inFlight;              // queue[head] was sent and waits for its response
+    uint8_t retriesLeft;
+    uint8_t maxRetries;
+    uint32_t usPerByte;
+    uint32_t responseTimeoutUs; // device turnaround, from the end of our frame to its first response byte
+    uint32_t settleUs;          // line idle time after a command without response
+    timeUs_t deadlineUs;
+    timeUs_t lineFreeUs;        // earliest time the next frame may start
+    vtxTransactionStats_t stats;
+} vtxTransactionEngine_t;
+
+void vtxTransactionInit(vtxTransactionEngine_t *engine, uint32_t baudRate, uint32_t responseTimeoutUs, uint32_t settleUs, uint8_t maxRetries);
+void vtxTransactionSetBaudRate(vtxTransactionEngine_t *engine, uint32_t baudRate);
+
+bool vtxTransactionQueue(vtxTransactionEngine_t *engine, const uint8_t *frame, uint8_t length, uint8_t command, uint8_t response, uint8_t responseLength, timeUs_t currentTimeUs);
+const vtxTransaction_t *vtxTransactionNext(vtxTransactionEngine_t *engine, timeUs_t currentTimeUs);
+bool vtxTransactionResponse(vtxTransactionEngine_t *engine, uint8_t response, timeUs_t currentTimeUs);
+
+bool vtxTransactionIsBusy(const vtxTransactionEngine_t *engine);
+bool vtxTransactionIsQueued(const vtxTransactionEngine_t *engine, uint8_t command);
+
+const vtxTransactionStats_t *vtxTransactionGetStats(void);
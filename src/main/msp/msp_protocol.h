@@ -290,6 +290,12 @@
 #define MSP_UID                  160    //out message         Unique device ID
 #define MSP_GPSSVINFO            164    //out message         get Signal Strength (only U-Blox)
 #define MSP_GPSSTATISTICS        166    //out message         get GPS debugging data
+#define MSP_TELEMETRY_STATS      167    //out message         per protocol link budget, target and achieved frame rates
+#define MSP_VTX_STATS            168    //out message         VTX control command counts and response latencies
+#define MSP_TAIL_ID              169    //out message         identified tail servo rate and lag, motor spool and yaw torque gain with confidence
+#define MSP_RAM_USAGE            170    //out message         .data, .bss, fast RAM, stack size and high-water mark, free RAM, peak stack per task
+#define MSP_BOOT_TIMES           171    //out message         boot phase timestamps, deferred init item states and finish times
+#define MSP_FAILSAFE_LATENCY     172    //out message         rx link loss detections, deadline and time from last valid frame to detection
 #define MSP_ACC_TRIM             240    //out message         get acc angle trim values
 #define MSP_SET_ACC_TRIM         239    //in message          set acc angle trim values
 #define MSP_SERVO_MIX_RULES      241    //out message         Returns servo mixer configuration
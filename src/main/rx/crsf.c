@@ -46,6 +46,7 @@
 #define CRSF_DIGITAL_CHANNEL_MAX 1811
 
 STATIC_UNIT_TESTED bool crsfFrameDone = false;
+static timeUs_t crsfFrameDoneAt = 0;
 STATIC_UNIT_TESTED crsfFrame_t crsfFrame;
 
 STATIC_UNIT_TESTED uint32_t crsfChannelData[CRSF_MAX_CHANNEL];
@@ -127,11 +128,15 @@ STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c)
     }
     // assume frame is 5 bytes long until we have received the frame length
     // full frame length includes the length of the address and framelength fields
-    const int fullFrameLength = crsfFramePosition < 3 ? 5 : crsfFrame.frame.frameLength + CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH;
+    // a corrupt frame length must not run past the end of the frame buffer
+    const int fullFrameLength = crsfFramePosition < 3 ? 5 : MIN(crsfFrame.frame.frameLength + CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH, CRSF_FRAME_SIZE_MAX);
 
     if (crsfFramePosition < fullFrameLength) {
         crsfFrame.bytes[crsfFramePosition++] = (uint8_t)c;
         crsfFrameDone = crsfFramePosition < fullFrameLength ? false : true;
+        if (crsfFrameDone) {
+            crsfFrameDoneAt = now;
+        }
     }
 }
 
@@ -139,12 +144,18 @@ STATIC_UNIT_TESTED uint8_t crsfFrameCRC(void)
 {
     // CRC includes type and payload
     uint8_t crc = crc8_dvb_s2(0, crsfFrame.frame.type);
-    for (int ii = 0; ii < crsfFrame.frame.frameLength - CRSF_FRAME_LENGTH_TYPE_CRC; ++ii) {
+    const int payloadLength = MIN(crsfFrame.frame.frameLength - CRSF_FRAME_LENGTH_TYPE_CRC, CRSF_PAYLOAD_SIZE_MAX);
+    for (int ii = 0; ii < payloadLength; ++ii) {
         crc = crc8_dvb_s2(crc, crsfFrame.frame.payload[ii]);
     }
     return crc;
 }
 
+static timeUs_t crsfFrameTimeUs(void)
+{
+    return crsfFrameDoneAt;
+}
+
 STATIC_UNIT_TESTED uint8_t crsfFrameStatus(void)
 {
     if (crsfFrameDone) {
@@ -230,6 +241,7 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     rxRuntimeConfig->rcReadRawFn = crsfReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = crsfFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = crsfFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
@@ -59,6 +59,7 @@ static uint8_t ibusChannelOffset;
 static uint16_t ibusChecksum;
 
 static bool ibusFrameDone = false;
+static timeUs_t ibusFrameDoneAt = 0;
 static uint32_t ibusChannelData[IBUS_MAX_CHANNEL];
 
 static uint8_t ibus[IBUS_BUFFSIZE] = { 0, };
@@ -103,11 +104,19 @@ static void ibusDataReceive(uint16_t c)
 
     if (ibusFramePosition == ibusFrameSize - 1) {
         ibusFrameDone = true;
+        ibusFrameDoneAt = ibusTime;
+        // a frame straight after this one must not overwrite its last byte
+        ibusFramePosition = 0;
     } else {
         ibusFramePosition++;
     }
 }
 
+static timeUs_t ibusFrameTimeUs(void)
+{
+    return ibusFrameDoneAt;
+}
+
 static uint8_t ibusFrameStatus(void)
 {
     uint8_t i, offset;
@@ -155,6 +164,7 @@ bool ibusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     rxRuntimeConfig->rcReadRawFn = ibusReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = ibusFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = ibusFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
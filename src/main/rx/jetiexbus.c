@@ -203,6 +203,7 @@ static uint8_t jetiExBusFramePosition;
 static uint8_t jetiExBusFrameLength;
 
 static uint8_t jetiExBusFrameState = EXBUS_STATE_ZERO;
+static timeUs_t jetiExBusFrameDoneAt = 0;
 static uint8_t jetiExBusRequestState = EXBUS_STATE_ZERO;
 
 // Use max values for ram areas
@@ -362,8 +363,10 @@ static void jetiExBusDataReceive(uint16_t c)
 
     // Done?
     if (jetiExBusFrameLength == jetiExBusFramePosition) {
-        if (jetiExBusFrameState == EXBUS_STATE_IN_PROGRESS)
+        if (jetiExBusFrameState == EXBUS_STATE_IN_PROGRESS) {
             jetiExBusFrameState = EXBUS_STATE_RECEIVED;
+            jetiExBusFrameDoneAt = now;
+        }
         if (jetiExBusRequestState == EXBUS_STATE_IN_PROGRESS) {
             jetiExBusRequestState = EXBUS_STATE_RECEIVED;
             jetiTimeStampRequest = micros();
@@ -375,6 +378,11 @@ static void jetiExBusDataReceive(uint16_t c)
 
 
 // Check if it is time to read a frame from the data...
+static timeUs_t jetiExBusFrameTimeUs(void)
+{
+    return jetiExBusFrameDoneAt;
+}
+
 static uint8_t jetiExBusFrameStatus()
 {
     if (jetiExBusFrameState != EXBUS_STATE_RECEIVED)
@@ -595,6 +603,7 @@ bool jetiExBusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfi
 
     rxRuntimeConfig->rcReadRawFn = jetiExBusReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = jetiExBusFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = jetiExBusFrameTimeUs;
 
     jetiExBusFrameReset();
 
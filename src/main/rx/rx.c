@@ -71,6 +71,7 @@ static bool rxIsInFailsafeMode = true;
 static bool rxIsInFailsafeModeNotDataDriven = true;
 
 static uint32_t rxUpdateAt = 0;
+static timeUs_t rxFrameTimeUs = 0;      // arrival of the newest frame, as stamped by the driver when it can
 static uint32_t needRxSignalBefore = 0;
 static uint32_t needRxSignalMaxDelayUs;
 static uint32_t suspendRxSignalUntil = 0;
@@ -209,6 +210,7 @@ void rxInit(const rxConfig_t *rxConfig, const modeActivationCondition_t *modeAct
     useRxConfig(rxConfig);
     rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
     rxRuntimeConfig.rcFrameStatusFn = nullFrameStatus;
+    rxRuntimeConfig.rcFrameTimeUsFn = NULL;
     rcSampleIndex = 0;
     needRxSignalMaxDelayUs = DELAY_10_HZ;
 
@@ -242,6 +244,7 @@ void rxInit(const rxConfig_t *rxConfig, const modeActivationCondition_t *modeAct
             featureClear(FEATURE_RX_SERIAL);
             rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
             rxRuntimeConfig.rcFrameStatusFn = nullFrameStatus;
+            rxRuntimeConfig.rcFrameTimeUsFn = NULL;
         }
     }
 #endif
@@ -260,6 +263,7 @@ void rxInit(const rxConfig_t *rxConfig, const modeActivationCondition_t *modeAct
             featureClear(FEATURE_RX_SPI);
             rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
             rxRuntimeConfig.rcFrameStatusFn = nullFrameStatus;
+            rxRuntimeConfig.rcFrameTimeUsFn = NULL;
         }
     }
 #endif
@@ -324,6 +328,7 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
         if (isPPMDataBeingReceived()) {
             rxSignalReceivedNotDataDriven = true;
             rxIsInFailsafeModeNotDataDriven = false;
+            rxFrameTimeUs = currentTimeUs;
             needRxSignalBefore = currentTimeUs + needRxSignalMaxDelayUs;
             resetPPMDataReceivedState();
         }
@@ -331,6 +336,7 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
         if (isPWMDataBeingReceived()) {
             rxSignalReceivedNotDataDriven = true;
             rxIsInFailsafeModeNotDataDriven = false;
+            rxFrameTimeUs = currentTimeUs;
             needRxSignalBefore = currentTimeUs + needRxSignalMaxDelayUs;
         }
     } else
@@ -339,10 +345,12 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
         rxDataReceived = false;
         const uint8_t frameStatus = rxRuntimeConfig.rcFrameStatusFn();
         if (frameStatus & RX_FRAME_COMPLETE) {
+            // the task may run a while after the frame came in, timeouts run from its arrival
+            rxFrameTimeUs = rxRuntimeConfig.rcFrameTimeUsFn ? rxRuntimeConfig.rcFrameTimeUsFn() : currentTimeUs;
             rxDataReceived = true;
             rxIsInFailsafeMode = (frameStatus & RX_FRAME_FAILSAFE) != 0;
             rxSignalReceived = !rxIsInFailsafeMode;
-            needRxSignalBefore = currentTimeUs + needRxSignalMaxDelayUs;
+            needRxSignalBefore = rxFrameTimeUs + needRxSignalMaxDelayUs;
         }
     }
     return rxDataReceived || (currentTimeUs >= rxUpdateAt); // data driven or 50Hz
@@ -500,6 +508,10 @@ static void detectAndApplySignalLossBehaviour(timeUs_t currentTimeUs)
     rxFlightChannelsValid = rxHaveValidFlightChannels();
 
     if ((rxFlightChannelsValid) && !IS_RC_MODE_ACTIVE(BOXFAILSAFE)) {
+        if (useValueFromRx) {
+            // channels held over a loss do not count, the failsafe deadline runs from the last frame received
+            failsafeOnValidRxFrame(rxFrameTimeUs);
+        }
         failsafeOnValidDataReceived();
     } else {
         rxIsInFailsafeMode = rxIsInFailsafeModeNotDataDriven = true;
@@ -76,6 +76,7 @@ static uint16_t sbusStateFlags = 0;
 #define SBUS_DIGITAL_CHANNEL_MAX 1812
 
 static bool sbusFrameDone = false;
+static timeUs_t sbusFrameDoneAt = 0;
 
 static uint32_t sbusChannelData[SBUS_MAX_CHANNEL];
 
@@ -147,6 +148,7 @@ static void sbusDataReceive(uint16_t c)
             sbusFrameDone = false;
         } else {
             sbusFrameDone = true;
+            sbusFrameDoneAt = now;
 #ifdef DEBUG_SBUS_PACKETS
         debug[2] = sbusFrameTime;
 #endif
@@ -154,6 +156,11 @@ static void sbusDataReceive(uint16_t c)
     }
 }
 
+static timeUs_t sbusFrameTimeUs(void)
+{
+    return sbusFrameDoneAt;
+}
+
 static uint8_t sbusFrameStatus(void)
 {
     if (!sbusFrameDone) {
@@ -236,6 +243,7 @@ bool sbusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     rxRuntimeConfig->rcReadRawFn = sbusReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = sbusFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = sbusFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
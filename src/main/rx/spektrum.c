@@ -61,6 +61,7 @@
 static uint8_t spek_chan_shift;
 static uint8_t spek_chan_mask;
 static bool rcFrameComplete = false;
+static timeUs_t spekFrameDoneAt = 0;
 static bool spekHiRes = false;
 static bool srxlEnabled = false;
 
@@ -109,6 +110,7 @@ static void spektrumDataReceive(uint16_t c)
             rcFrameComplete = false;
         } else {
             rcFrameComplete = true;
+            spekFrameDoneAt = spekTime;
         }
     }
 }
@@ -116,6 +118,11 @@ static void spektrumDataReceive(uint16_t c)
 static uint32_t spekChannelData[SPEKTRUM_MAX_SUPPORTED_CHANNEL_COUNT];
 static dispatchEntry_t srxlTelemetryDispatch = { .dispatch = srxlRxSendTelemetryDataDispatch};
 
+static timeUs_t spektrumFrameTimeUs(void)
+{
+    return spekFrameDoneAt;
+}
+
 static uint8_t spektrumFrameStatus(void)
 {
     if (!rcFrameComplete) {
@@ -297,6 +304,7 @@ bool spektrumInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig
 
     rxRuntimeConfig->rcReadRawFn = spektrumReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = spektrumFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = spektrumFrameTimeUs;
 
     serialPort = openSerialPort(portConfig->identifier,
         FUNCTION_RX_SERIAL,
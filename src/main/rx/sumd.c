@@ -47,6 +47,7 @@
 #define SUMD_BAUDRATE 115200
 
 static bool sumdFrameDone = false;
+static timeUs_t sumdFrameDoneAt = 0;
 static uint16_t sumdChannels[SUMD_MAX_CHANNEL];
 static uint16_t crc;
 
@@ -90,8 +91,14 @@ static void sumdDataReceive(uint16_t c)
             crc = 0;
         }
     }
-    if (sumdIndex == 2)
+    if (sumdIndex == 2) {
+        if (c > SUMD_MAX_CHANNEL) {
+            // corrupt header, the CRC would be read from beyond the buffer
+            sumdIndex = 0;
+            return;
+        }
         sumdChannelCount = (uint8_t)c;
+    }
     if (sumdIndex < SUMD_BUFFSIZE)
         sumd[sumdIndex] = (uint8_t)c;
     sumdIndex++;
@@ -101,6 +108,7 @@ static void sumdDataReceive(uint16_t c)
         if (sumdIndex == sumdChannelCount * 2 + 5) {
             sumdIndex = 0;
             sumdFrameDone = true;
+            sumdFrameDoneAt = sumdTime;
         }
 }
 
@@ -112,6 +120,11 @@ static void sumdDataReceive(uint16_t c)
 #define SUMD_FRAME_STATE_OK 0x01
 #define SUMD_FRAME_STATE_FAILSAFE 0x81
 
+static timeUs_t sumdFrameTimeUs(void)
+{
+    return sumdFrameDoneAt;
+}
+
 static uint8_t sumdFrameStatus(void)
 {
     uint8_t channelIndex;
@@ -167,6 +180,7 @@ bool sumdInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     rxRuntimeConfig->rcReadRawFn = sumdReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = sumdFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = sumdFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
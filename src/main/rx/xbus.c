@@ -77,6 +77,7 @@
 #define XBUS_CONVERT_TO_USEC(V) (800 + ((V * 1400) >> 12))
 
 static bool xBusFrameReceived = false;
+static timeUs_t xBusFrameDoneAt = 0;
 static bool xBusDataIncoming = false;
 static uint8_t xBusFramePosition;
 static uint8_t xBusFrameLength;
@@ -246,11 +247,14 @@ static void xBusDataReceive(uint16_t c)
 
     // Done?
     if (xBusFramePosition == xBusFrameLength) {
+        xBusFrameDoneAt = now;
         switch (xBusProvider) {
         case SERIALRX_XBUS_MODE_B:
             xBusUnpackModeBFrame(0);
+            break;
         case SERIALRX_XBUS_MODE_B_RJ01:
             xBusUnpackRJ01Frame();
+            break;
         }
         xBusDataIncoming = false;
         xBusFramePosition = 0;
@@ -258,6 +262,11 @@ static void xBusDataReceive(uint16_t c)
 }
 
 // Indicate time to read a frame from the data...
+static timeUs_t xBusFrameTimeUs(void)
+{
+    return xBusFrameDoneAt;
+}
+
 static uint8_t xBusFrameStatus(void)
 {
     if (!xBusFrameReceived) {
@@ -317,6 +326,7 @@ bool xBusInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     rxRuntimeConfig->rcReadRawFn = xBusReadRawRC;
     rxRuntimeConfig->rcFrameStatusFn = xBusFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = xBusFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
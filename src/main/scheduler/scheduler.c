@@ -31,6 +31,7 @@
 #include "common/time.h"
 #include "common/utils.h"
 
+#include "drivers/stack_check.h"
 #include "drivers/system.h"
 
 // DEBUG_SCHEDULER, timings for:
@@ -152,6 +153,11 @@ void getTaskInfo(cfTaskId_e taskId, cfTaskInfo_t * taskInfo)
     taskInfo->totalExecutionTime = cfTasks[taskId].totalExecutionTime;
     taskInfo->averageExecutionTime = cfTasks[taskId].movingSumExecutionTime / MOVING_SUM_COUNT;
     taskInfo->latestDeltaTime = cfTasks[taskId].taskLatestDeltaTime;
+#ifdef STACK_CHECK_TASKS
+    taskInfo->maxStackUsed = cfTasks[taskId].maxStackUsed;
+#else
+    taskInfo->maxStackUsed = 0;
+#endif
 }
 #endif
 
@@ -307,6 +313,10 @@ void scheduler(void)
         selectedTask->lastExecutedAt = currentTimeUs;
         selectedTask->dynamicPriority = 0;
 
+#ifdef STACK_CHECK_TASKS
+        const bool sampleStack = stackSampleBegin(selectedTask - cfTasks);
+#endif
+
         // Execute task
 #ifdef SKIP_TASK_STATISTICS
         selectedTask->taskFunc(currentTimeUs);
@@ -323,6 +333,11 @@ void scheduler(void)
         }
 
 #endif
+#ifdef STACK_CHECK_TASKS
+        if (sampleStack) {
+            selectedTask->maxStackUsed = MAX(selectedTask->maxStackUsed, stackSampleEnd());
+        }
+#endif
 #if defined(SCHEDULER_DEBUG)
         DEBUG_SET(DEBUG_SCHEDULER, 2, micros() - currentTimeUs - taskExecutionTime); // time spent in scheduler
     } else {
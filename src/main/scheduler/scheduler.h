@@ -45,6 +45,7 @@ typedef struct {
     timeUs_t     totalExecutionTime;
     timeUs_t     averageExecutionTime;
     timeUs_t     latestDeltaTime;
+    uint16_t     maxStackUsed;
 } cfTaskInfo_t;
 
 typedef enum {
@@ -57,6 +58,7 @@ typedef enum {
     TASK_SERIAL,
     TASK_DISPATCH,
     TASK_BATTERY,
+    TASK_DEFERRED_INIT,
 #ifdef BEEPER
     TASK_BEEPER,
 #endif
@@ -105,6 +107,9 @@ typedef enum {
 #ifdef VTX_CONTROL
     TASK_VTXCTRL,
 #endif
+#ifdef USE_TAIL_IDENTIFICATION
+    TASK_TAIL_ID,
+#endif
 
     /* Count of real tasks */
     TASK_COUNT,
@@ -136,6 +141,9 @@ typedef struct {
     timeUs_t maxExecutionTime;
     timeUs_t totalExecutionTime;    // total time consumed by task since boot
 #endif
+#ifdef STACK_CHECK_TASKS
+    uint16_t maxStackUsed;          // bytes from the top of the stack, sampled
+#endif
 } cfTask_t;
 
 extern cfTask_t cfTasks[TASK_COUNT];
@@ -199,10 +199,17 @@ bool isBaroReady(void) {
 uint32_t baroUpdate(void)
 {
     static barometerState_e state = BAROMETER_NEEDS_SAMPLES;
+    static bool haveSamples = false;
 
     switch (state) {
         default:
         case BAROMETER_NEEDS_SAMPLES:
+            // the reads may complete in the background, so the samples fetched
+            // in the previous step are only used now
+            if (haveSamples) {
+                baro.dev.calculate(&baroPressure, &baroTemperature);
+                baroPressureSum = recalculateBarometerTotal(barometerConfig->baro_sample_count, baroPressureSum, baroPressure);
+            }
             baro.dev.get_ut();
             baro.dev.start_up();
             state = BAROMETER_NEEDS_CALCULATION;
@@ -212,8 +219,7 @@ uint32_t baroUpdate(void)
         case BAROMETER_NEEDS_CALCULATION:
             baro.dev.get_up();
             baro.dev.start_ut();
-            baro.dev.calculate(&baroPressure, &baroTemperature);
-            baroPressureSum = recalculateBarometerTotal(barometerConfig->baro_sample_count, baroPressureSum, baroPressure);
+            haveSamples = true;
             state = BAROMETER_NEEDS_SAMPLES;
             return baro.dev.ut_delay;
         break;
@@ -27,6 +27,11 @@ typedef enum {
     BARO_BMP280 = 4
 } baroSensor_e;
 
+typedef enum {
+    ALT_ESTIMATOR_CF = 0,
+    ALT_ESTIMATOR_3STATE = 1
+} altEstimator_e;
+
 #define BARO_SAMPLE_COUNT_MAX   48
 
 typedef struct barometerConfig_s {
@@ -35,6 +40,8 @@ typedef struct barometerConfig_s {
     float baro_noise_lpf;                   // additional LPF to reduce baro noise
     float baro_cf_vel;                      // apply Complimentary Filter to keep the calculated velocity based on baro velocity (i.e. near real velocity)
     float baro_cf_alt;                      // apply CF to use ACC for height estimation
+    uint8_t baro_estimator;                 // altitude estimator, see altEstimator_e
+    uint8_t baro_est_tau;                   // time constant of the 3 state estimator in 0.1s
 } barometerConfig_t;
 
 typedef struct baro_s {
@@ -49,6 +49,7 @@
 #include "drivers/io.h"
 #include "drivers/system.h"
 
+#include "fc/config.h"
 #include "fc/runtime_config.h"
 
 #include "io/beeper.h"
@@ -59,28 +60,78 @@
 #include "sensors/sensors.h"
 #include "sensors/boardalignment.h"
 #include "sensors/gyro.h"
+#include "sensors/gyro_fusion.h"
 
 #ifdef USE_HARDWARE_REVISION_DETECTION
 #include "hardware_revision.h"
 #endif
 
+#ifdef USE_DUAL_GYRO
+#define GYRO_COUNT 2
+#else
+#define GYRO_COUNT 1
+#endif
+
 gyro_t gyro;                      // gyro access functions
 
-static int32_t gyroADC[XYZ_AXIS_COUNT];
+// The first is gyro.dev, with a second gyro their rates are fused
+static gyroDev_t *gyroSensor[GYRO_COUNT];
+static uint8_t gyroCount;
+#ifdef USE_DUAL_GYRO
+static gyroDev_t gyroDev2;
+static FAST_RAM_ZERO_INIT gyroFusion_t gyroFusion;
+#endif
+
+static FAST_RAM_ZERO_INIT int32_t gyroADC[GYRO_COUNT][XYZ_AXIS_COUNT];
 
-static int32_t gyroZero[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+static float gyroZero[GYRO_COUNT][XYZ_AXIS_COUNT];
 static const gyroConfig_t *gyroConfig;
 static uint16_t calibratingG = 0;
+static gyroBiasCache_t *gyroBiasCache;
+static int8_t gyroCalibrationTemperature = GYRO_BIAS_TEMPERATURE_NONE;
+static uint8_t gyroCalibrationRestarts;
+static bool gyroBiasCacheDirty;
+
+// Sums over a window while disarmed, to follow the bias as the gyro warms up
+typedef struct gyroDrift_s {
+    float sum[XYZ_AXIS_COUNT];
+    float sumSq[XYZ_AXIS_COUNT];
+    uint16_t count;
+} gyroDrift_t;
+
+static gyroDrift_t gyroDrift[GYRO_COUNT];
+
+#ifdef USE_FIXED_POINT_PID
+// Without an FPU the gyro is scaled and filtered in fixed point, gyroADCf is converted from the result
+typedef fix16_t gyroRate_t;
+typedef filterApplyFixFnPtr gyroFilterApplyFnPtr;
+
+// the zero and scale only change while disarmed, they are converted then
+static FAST_RAM_ZERO_INIT fix16_t gyroZeroFix[XYZ_AXIS_COUNT];
+static FAST_RAM_ZERO_INIT q30_t gyroScaleQ30;
+#else
+typedef float gyroRate_t;
+typedef filterApplyFnPtr gyroFilterApplyFnPtr;
+#endif
 
-static filterApplyFnPtr softLpfFilterApplyFn;
-static void *softLpfFilter[3];
-static filterApplyFnPtr notchFilter1ApplyFn;
-static void *notchFilter1[3];
-static filterApplyFnPtr notchFilter2ApplyFn;
-static void *notchFilter2[3];
+static gyroFilterApplyFnPtr softLpfFilterApplyFn;
+static FAST_RAM_ZERO_INIT void *softLpfFilter[3];
+static gyroFilterApplyFnPtr notchFilter1ApplyFn;
+static FAST_RAM_ZERO_INIT void *notchFilter1[3];
+static gyroFilterApplyFnPtr notchFilter2ApplyFn;
+static FAST_RAM_ZERO_INIT void *notchFilter2[3];
 
 #define DEBUG_GYRO_CALIBRATION 3
 
+#define GYRO_CALIBRATION_CHECK_INTERVAL     64      // samples between checks whether the statistics have settled
+#define GYRO_CALIBRATION_MEAN_ERROR         0.25f   // standard error of the mean in raw counts that is good enough
+#define GYRO_CALIBRATION_MOTION_FACTOR      3       // times moron_threshold off the mean so far, the model is moving
+#define GYRO_CALIBRATION_RESTARTS_CACHED    5       // restarts before the cached bias is taken instead
+#define GYRO_BIAS_CACHE_TEMPERATURE_RANGE   3       // degrees C either way the cached bias is good for
+#define GYRO_BIAS_CACHE_MATCH               8       // raw counts off the cached bias the measured one agrees with it
+#define GYRO_DRIFT_MAX_DPS                  1.0f    // mean rate over a window that is still drift and not a slow turn
+#define GYRO_DRIFT_GAIN                     0.1f    // of the difference taken each window
+
 static const extiConfig_t *selectMPUIntExtiConfig(void)
 {
 #if defined(MPU_INT_EXTI)
@@ -93,10 +144,8 @@ static const extiConfig_t *selectMPUIntExtiConfig(void)
 #endif
 }
 
-static bool gyroDetect(gyroDev_t *dev)
+static gyroSensor_e gyroDetect(gyroDev_t *dev, gyroSensor_e gyroHardware)
 {
-    gyroSensor_e gyroHardware = GYRO_DEFAULT;
-
     dev->gyroAlign = ALIGN_DEFAULT;
 
     switch(gyroHardware) {
@@ -221,15 +270,37 @@ static bool gyroDetect(gyroDev_t *dev)
         gyroHardware = GYRO_NONE;
     }
 
-    if (gyroHardware == GYRO_NONE) {
-        return false;
+    return gyroHardware;
+}
+
+#ifdef USE_DUAL_GYRO
+// The drivers keep the bus state of a single chip, so the second gyro has to be of another type than the first.
+// It is not put through mpuDetect(), the MPU drivers detect as the first one. The fake driver has two instances.
+static void gyroInitSecondary(gyroSensor_e primaryHardware)
+{
+    gyroDev_t *dev = &gyroDev2;
+
+    memset(dev, 0, sizeof(*dev));
+    const gyroSensor_e gyroHardware = gyroDetect(dev, GYRO_2_HARDWARE);
+    if (gyroHardware == GYRO_NONE || (gyroHardware == primaryHardware && gyroHardware != GYRO_FAKE)) {
+        return;
+    }
+#ifdef GYRO_2_ALIGN
+    dev->gyroAlign = GYRO_2_ALIGN;
+#endif
+    if (gyroConfig->gyro_2_align != ALIGN_DEFAULT) {
+        dev->gyroAlign = gyroConfig->gyro_2_align;
     }
 
-    detectedSensors[SENSOR_INDEX_GYRO] = gyroHardware;
-    sensorsSet(SENSOR_GYRO);
+    gyroSetSampleRate(dev, gyroConfig->gyro_lpf, gyroConfig->gyro_sync_denom, gyroConfig->gyro_use_32khz);
+    dev->lpf = gyroConfig->gyro_lpf;
+    dev->init(dev);
+    gyroSensor[gyroCount++] = dev;
 
-    return true;
+    const uint8_t weights[GYRO_COUNT] = { 100 - gyroConfig->gyro_2_weight, gyroConfig->gyro_2_weight };
+    gyroFusionInit(&gyroFusion, gyroCount, gyroConfig->gyro_fusion_mode, weights);
 }
+#endif
 
 bool gyroInit(const gyroConfig_t *gyroConfigToUse)
 {
@@ -241,11 +312,16 @@ bool gyroInit(const gyroConfig_t *gyroConfigToUse)
     mpuReset = gyro.dev.mpuConfiguration.reset;
 #endif
 
-    if (!gyroDetect(&gyro.dev)) {
+    const gyroSensor_e gyroHardware = gyroDetect(&gyro.dev, GYRO_DEFAULT);
+    if (gyroHardware == GYRO_NONE) {
         return false;
     }
+    detectedSensors[SENSOR_INDEX_GYRO] = gyroHardware;
+    sensorsSet(SENSOR_GYRO);
+    gyroSensor[0] = &gyro.dev;
+    gyroCount = 1;
 
-    switch (detectedSensors[SENSOR_INDEX_GYRO]) {
+    switch (gyroHardware) {
     default:
         // gyro does not support 32kHz
         // cast away constness, legitimate as this is cross-validation
@@ -264,17 +340,86 @@ bool gyroInit(const gyroConfig_t *gyroConfigToUse)
     gyro.targetLooptime = gyroSetSampleRate(&gyro.dev, gyroConfig->gyro_lpf, gyroConfig->gyro_sync_denom, gyroConfig->gyro_use_32khz);
     gyro.dev.lpf = gyroConfig->gyro_lpf;
     gyro.dev.init(&gyro.dev);
+#ifdef USE_DUAL_GYRO
+    gyroInitSecondary(gyroHardware);
+#endif
     gyroInitFilters();
     return true;
 }
 
+uint8_t gyroSensorsUsed(void)
+{
+#ifdef USE_DUAL_GYRO
+    if (gyroCount > 1) {
+        return gyroFusion.usedMask;
+    }
+#endif
+    return gyroCount ? 1 : 0;
+}
+
+#ifdef USE_FIXED_POINT_PID
 void gyroInitFilters(void)
 {
-    static biquadFilter_t gyroFilterLPF[XYZ_AXIS_COUNT];
-    static pt1Filter_t gyroFilterPt1[XYZ_AXIS_COUNT];
+    static FAST_RAM_ZERO_INIT biquadFilterFix_t gyroFilterLPF[XYZ_AXIS_COUNT];
+    static FAST_RAM_ZERO_INIT pt1FilterFix_t gyroFilterPt1[XYZ_AXIS_COUNT];
+    static firFilterDenoiseFix_t gyroDenoiseState[XYZ_AXIS_COUNT];
+    static FAST_RAM_ZERO_INIT biquadFilterFix_t gyroFilterNotch_1[XYZ_AXIS_COUNT];
+    static FAST_RAM_ZERO_INIT biquadFilterFix_t gyroFilterNotch_2[XYZ_AXIS_COUNT];
+
+    softLpfFilterApplyFn = nullFilterApplyFix;
+    notchFilter1ApplyFn = nullFilterApplyFix;
+    notchFilter2ApplyFn = nullFilterApplyFix;
+
+    uint32_t gyroFrequencyNyquist = (1.0f / (gyro.targetLooptime * 0.000001f)) / 2; // No rounding needed
+
+    if (gyroConfig->gyro_soft_lpf_hz && gyroConfig->gyro_soft_lpf_hz <= gyroFrequencyNyquist) {  // Initialisation needs to happen once samplingrate is known
+        if (gyroConfig->gyro_soft_lpf_type == FILTER_BIQUAD) {
+            softLpfFilterApplyFn = (filterApplyFixFnPtr)biquadFilterApplyFix;
+            for (int axis = 0; axis < 3; axis++) {
+                softLpfFilter[axis] = &gyroFilterLPF[axis];
+                biquadFilterInitLPFFix(softLpfFilter[axis], gyroConfig->gyro_soft_lpf_hz, gyro.targetLooptime);
+            }
+        } else if (gyroConfig->gyro_soft_lpf_type == FILTER_PT1) {
+            softLpfFilterApplyFn = (filterApplyFixFnPtr)pt1FilterApplyFix;
+            const float gyroDt = (float) gyro.targetLooptime * 0.000001f;
+            for (int axis = 0; axis < 3; axis++) {
+                softLpfFilter[axis] = &gyroFilterPt1[axis];
+                pt1FilterInitFix(softLpfFilter[axis], gyroConfig->gyro_soft_lpf_hz, gyroDt);
+            }
+        } else {
+            softLpfFilterApplyFn = (filterApplyFixFnPtr)firFilterDenoiseUpdateFix;
+            for (int axis = 0; axis < 3; axis++) {
+                softLpfFilter[axis] = &gyroDenoiseState[axis];
+                firFilterDenoiseInitFix(softLpfFilter[axis], gyroConfig->gyro_soft_lpf_hz, gyro.targetLooptime);
+            }
+        }
+    }
+
+    if (gyroConfig->gyro_soft_notch_hz_1 && gyroConfig->gyro_soft_notch_hz_1 <= gyroFrequencyNyquist) {
+        notchFilter1ApplyFn = (filterApplyFixFnPtr)biquadFilterApplyFix;
+        const float gyroSoftNotchQ1 = filterGetNotchQ(gyroConfig->gyro_soft_notch_hz_1, gyroConfig->gyro_soft_notch_cutoff_1);
+        for (int axis = 0; axis < 3; axis++) {
+            notchFilter1[axis] = &gyroFilterNotch_1[axis];
+            biquadFilterInitFix(notchFilter1[axis], gyroConfig->gyro_soft_notch_hz_1, gyro.targetLooptime, gyroSoftNotchQ1, FILTER_NOTCH);
+        }
+    }
+    if (gyroConfig->gyro_soft_notch_hz_2 && gyroConfig->gyro_soft_notch_hz_2 <= gyroFrequencyNyquist) {
+        notchFilter2ApplyFn = (filterApplyFixFnPtr)biquadFilterApplyFix;
+        const float gyroSoftNotchQ2 = filterGetNotchQ(gyroConfig->gyro_soft_notch_hz_2, gyroConfig->gyro_soft_notch_cutoff_2);
+        for (int axis = 0; axis < 3; axis++) {
+            notchFilter2[axis] = &gyroFilterNotch_2[axis];
+            biquadFilterInitFix(notchFilter2[axis], gyroConfig->gyro_soft_notch_hz_2, gyro.targetLooptime, gyroSoftNotchQ2, FILTER_NOTCH);
+        }
+    }
+}
+#else
+void gyroInitFilters(void)
+{
+    static FAST_RAM_ZERO_INIT biquadFilter_t gyroFilterLPF[XYZ_AXIS_COUNT];
+    static FAST_RAM_ZERO_INIT pt1Filter_t gyroFilterPt1[XYZ_AXIS_COUNT];
     static firFilterDenoise_t gyroDenoiseState[XYZ_AXIS_COUNT];
-    static biquadFilter_t gyroFilterNotch_1[XYZ_AXIS_COUNT];
-    static biquadFilter_t gyroFilterNotch_2[XYZ_AXIS_COUNT];
+    static FAST_RAM_ZERO_INIT biquadFilter_t gyroFilterNotch_1[XYZ_AXIS_COUNT];
+    static FAST_RAM_ZERO_INIT biquadFilter_t gyroFilterNotch_2[XYZ_AXIS_COUNT];
 
     softLpfFilterApplyFn = nullFilterApply;
     notchFilter1ApplyFn = nullFilterApply;
@@ -322,17 +467,13 @@ void gyroInitFilters(void)
         }
     }
 }
+#endif
 
 bool isGyroCalibrationComplete(void)
 {
     return calibratingG == 0;
 }
 
-static bool isOnFinalGyroCalibrationCycle(void)
-{
-    return calibratingG == 1;
-}
-
 static uint16_t gyroCalculateCalibratingCycles(void)
 {
     return (CALIBRATING_GYRO_CYCLES / gyro.targetLooptime) * CALIBRATING_GYRO_CYCLES;
@@ -348,47 +489,252 @@ void gyroSetCalibrationCycles(void)
     calibratingG = gyroCalculateCalibratingCycles();
 }
 
-static void performGyroCalibration(uint8_t gyroMovementCalibrationThreshold)
+void setGyroBiasCache(gyroBiasCache_t *gyroBiasCacheToUse)
 {
-    static int32_t g[3];
-    static stdev_t var[3];
+    gyroBiasCache = gyroBiasCacheToUse;
+}
+
+static int8_t gyroReadTemperature(void)
+{
+    int16_t temperature;
+
+    if (!gyro.dev.temperature || !gyro.dev.temperature(&gyro.dev, &temperature)) {
+        return GYRO_BIAS_TEMPERATURE_NONE;
+    }
+    return constrain(temperature, GYRO_BIAS_TEMPERATURE_NONE + 1, INT8_MAX);
+}
 
-    for (int axis = 0; axis < 3; axis++) {
+// The cache holds the bias of the first gyro, from a calibration at about the same temperature
+static bool gyroBiasCacheUsable(void)
+{
+    return gyroBiasCache && gyroCount == 1
+        && gyroBiasCache->temperature != GYRO_BIAS_TEMPERATURE_NONE
+        && gyroCalibrationTemperature != GYRO_BIAS_TEMPERATURE_NONE
+        && ABS(gyroCalibrationTemperature - gyroBiasCache->temperature) <= GYRO_BIAS_CACHE_TEMPERATURE_RANGE;
+}
 
-        // Reset g[axis] at start of calibration
-        if (isOnFirstGyroCalibrationCycle()) {
-            g[axis] = 0;
-            devClear(&var[axis]);
+static bool gyroBiasCacheMatches(const float *bias)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (fabsf(bias[axis] - gyroBiasCache->bias[axis]) > GYRO_BIAS_CACHE_MATCH) {
+            return false;
         }
+    }
+    return true;
+}
+
+static void gyroBiasCacheUpdate(void)
+{
+    if (!gyroBiasCache || gyroCalibrationTemperature == GYRO_BIAS_TEMPERATURE_NONE) {
+        return;
+    }
+    // only saved when it is news, not on every boot
+    if (gyroBiasCacheUsable() && gyroBiasCacheMatches(gyroZero[0])) {
+        return;
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        gyroBiasCache->bias[axis] = lrintf(gyroZero[0][axis]);
+    }
+    gyroBiasCache->temperature = gyroCalibrationTemperature;
+    // writing flash stalls the loop, so it is left to a low priority task
+    gyroBiasCacheDirty = true;
+}
+
+bool gyroBiasCacheSavePending(void)
+{
+    return gyroBiasCacheDirty;
+}
+
+void gyroBiasCacheSaved(void)
+{
+    gyroBiasCacheDirty = false;
+}
 
-        // Sum up CALIBRATING_GYRO_CYCLES readings
-        g[axis] += gyroADC[axis];
-        devPush(&var[axis], gyroADC[axis]);
+static void gyroCalibrationFinished(void)
+{
+    schedulerResetTaskStatistics(TASK_SELF); // so calibration cycles do not pollute tasks statistics
+    beeper(BEEPER_GYRO_CALIBRATED);
+    calibratingG = 0;
+    gyroCalibrationRestarts = 0;
+    memset(gyroDrift, 0, sizeof(gyroDrift));
+}
 
-        // Reset global variables to prevent other code from using un-calibrated data
-        gyroADC[axis] = 0;
-        gyroZero[axis] = 0;
+static void gyroCalibrationRestart(void)
+{
+    if (++gyroCalibrationRestarts >= GYRO_CALIBRATION_RESTARTS_CACHED && gyroBiasCacheUsable()) {
+        // on a rocking boat the bias from an earlier calibration at this temperature is the best there is
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroZero[0][axis] = gyroBiasCache->bias[axis];
+        }
+        gyroCalibrationFinished();
+        return;
+    }
+    gyroSetCalibrationCycles();
+}
 
-        if (isOnFinalGyroCalibrationCycle()) {
-            float dev = devStandardDeviation(&var[axis]);
+// A sensor that fails its health checks does not hold up the calibration of the others
+static bool gyroSensorHealthy(uint8_t index)
+{
+#ifdef USE_DUAL_GYRO
+    return gyroCount == 1 || gyroFusion.sensor[index].health == GYRO_HEALTH_OK;
+#else
+    UNUSED(index);
+    return true;
+#endif
+}
+
+// Finishes once the mean of each axis is known well enough, at the latest after the full CALIBRATING_GYRO_CYCLES.
+// A model that is moved starts it over straight away, not at the end.
+static void performGyroCalibration(uint8_t gyroMovementCalibrationThreshold)
+{
+    static stdev_t var[GYRO_COUNT][XYZ_AXIS_COUNT];
+
+    if (isOnFirstGyroCalibrationCycle()) {
+        for (int sensor = 0; sensor < gyroCount; sensor++) {
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                devClear(&var[sensor][axis]);
+            }
+        }
+        gyroCalibrationTemperature = gyroReadTemperature();
+    }
+
+    bool moved = false;
+    for (int sensor = 0; sensor < gyroCount; sensor++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            stdev_t *axisVar = &var[sensor][axis];
+            const float sample = gyroADC[sensor][axis];
+
+            if (gyroMovementCalibrationThreshold && axisVar->m_n >= GYRO_CALIBRATION_CHECK_INTERVAL && gyroSensorHealthy(sensor)
+                    && fabsf(sample - axisVar->m_newM) > GYRO_CALIBRATION_MOTION_FACTOR * gyroMovementCalibrationThreshold) {
+                moved = true;
+            }
+            devPush(axisVar, sample);
+
+            // Reset global variables to prevent other code from using un-calibrated data
+            gyroADC[sensor][axis] = 0;
+            gyroZero[sensor][axis] = 0;
+        }
+    }
+    if (moved) {
+        gyroCalibrationRestart();
+        return;
+    }
+
+    calibratingG--;
+    const int samples = var[0][X].m_n;
+    if (calibratingG > 0 && samples % GYRO_CALIBRATION_CHECK_INTERVAL) {
+        return;
+    }
+
+    float mean[GYRO_COUNT][XYZ_AXIS_COUNT];
+    bool settled = true;
+    for (int sensor = 0; sensor < gyroCount; sensor++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            const float dev = devStandardDeviation(&var[sensor][axis]);
 
             DEBUG_SET(DEBUG_GYRO, DEBUG_GYRO_CALIBRATION, lrintf(dev));
 
+            if (!gyroSensorHealthy(sensor)) {
+                mean[sensor][axis] = var[sensor][axis].m_newM;
+                continue;
+            }
             // check deviation and startover in case the model was moved
             if (gyroMovementCalibrationThreshold && dev > gyroMovementCalibrationThreshold) {
-                gyroSetCalibrationCycles();
+                gyroCalibrationRestart();
                 return;
             }
-            gyroZero[axis] = (g[axis] + (gyroCalculateCalibratingCycles() / 2)) / gyroCalculateCalibratingCycles();
+            settled = settled && dev <= GYRO_CALIBRATION_MEAN_ERROR * sqrtf(samples);
+            mean[sensor][axis] = var[sensor][axis].m_newM;
         }
     }
 
-    if (isOnFinalGyroCalibrationCycle()) {
-        schedulerResetTaskStatistics(TASK_SELF); // so calibration cycles do not pollute tasks statistics
-        beeper(BEEPER_GYRO_CALIBRATED);
+    // a quarter of the full time at least, an eighth when it agrees with the bias cached at this temperature
+    const uint16_t fullSamples = gyroCalculateCalibratingCycles();
+    const bool cached = gyroBiasCacheUsable() && gyroBiasCacheMatches(mean[0]);
+    if (samples < (cached ? fullSamples / 8 : fullSamples / 4)) {
+        settled = false;
     }
-    calibratingG--;
+    if (!settled && calibratingG > 0) {
+        return;
+    }
+
+    memcpy(gyroZero, mean, sizeof(mean));
+    gyroBiasCacheUpdate();
+    gyroCalibrationFinished();
+}
+
+// Moves the zero of a sensor towards the mean of a window in which the model was kept still
+static void gyroTrackDrift(uint8_t index, uint8_t gyroMovementCalibrationThreshold)
+{
+    gyroDrift_t *drift = &gyroDrift[index];
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float offset = gyroADC[index][axis] - gyroZero[index][axis];
+        drift->sum[axis] += offset;
+        drift->sumSq[axis] += offset * offset;
+    }
+    if (++drift->count < gyroCalculateCalibratingCycles() / 4) {
+        return;
+    }
+
+    bool still = true;
+    float mean[XYZ_AXIS_COUNT];
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        mean[axis] = drift->sum[axis] / drift->count;
+        const float variance = drift->sumSq[axis] / drift->count - mean[axis] * mean[axis];
+        still = still && fabsf(mean[axis]) * gyroSensor[index]->scale <= GYRO_DRIFT_MAX_DPS
+            && variance <= gyroMovementCalibrationThreshold * gyroMovementCalibrationThreshold;
+    }
+    if (still) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroZero[index][axis] += mean[axis] * GYRO_DRIFT_GAIN;
+        }
+    }
+    memset(drift, 0, sizeof(*drift));
+}
+
+// Rates of the first gyro in degrees per second, with its zero taken off
+static FAST_CODE void gyroRateFromADC(gyroRate_t *rate)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+#ifdef USE_FIXED_POINT_PID
+        rate[axis] = fix16Saturate((((int64_t)gyroADC[0][axis] * Q16 - gyroZeroFix[axis]) * gyroScaleQ30 + (Q30 / 2)) >> 30);
+#else
+        rate[axis] = (gyroADC[0][axis] - gyroZero[0][axis]) * gyro.dev.scale;
+#endif
+    }
+}
+
+static FAST_CODE void gyroApplyFilters(const gyroRate_t *rate)
+{
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+#ifdef USE_FIXED_POINT_PID
+        fix16_t gyroADCFix = rate[axis];
+
+        // Apply LPF
+        DEBUG_SET(DEBUG_GYRO, axis, (gyroADCFix + Q16 / 2) >> 16);
+        gyroADCFix = softLpfFilterApplyFn(softLpfFilter[axis], gyroADCFix);
+
+        // Apply Notch filtering
+        DEBUG_SET(DEBUG_NOTCH, axis, (gyroADCFix + Q16 / 2) >> 16);
+        gyroADCFix = notchFilter1ApplyFn(notchFilter1[axis], gyroADCFix);
+        gyroADCFix = notchFilter2ApplyFn(notchFilter2[axis], gyroADCFix);
+        gyro.gyroADCFix[axis] = gyroADCFix;
+        gyro.gyroADCf[axis] = fix16ToFloat(gyroADCFix);
+#else
+        float gyroADCf = rate[axis];
+
+        // Apply LPF
+        DEBUG_SET(DEBUG_GYRO, axis, lrintf(gyroADCf));
+        gyroADCf = softLpfFilterApplyFn(softLpfFilter[axis], gyroADCf);
 
+        // Apply Notch filtering
+        DEBUG_SET(DEBUG_NOTCH, axis, lrintf(gyroADCf));
+        gyroADCf = notchFilter1ApplyFn(notchFilter1[axis], gyroADCf);
+        gyroADCf = notchFilter2ApplyFn(notchFilter2[axis], gyroADCf);
+        gyro.gyroADCf[axis] = gyroADCf;
+#endif
+    }
 }
 
 #if defined(GYRO_USES_SPI) && defined(USE_MPU_DATA_READY_SIGNAL)
@@ -402,48 +748,64 @@ static bool gyroUpdateISR(gyroDev_t* gyroDev)
 #endif
     gyroDev->dataReady = false;
     // move gyro data into 32-bit variables to avoid overflows in calculations
-    gyroADC[X] = gyroDev->gyroADCRaw[X];
-    gyroADC[Y] = gyroDev->gyroADCRaw[Y];
-    gyroADC[Z] = gyroDev->gyroADCRaw[Z];
+    gyroADC[0][X] = gyroDev->gyroADCRaw[X];
+    gyroADC[0][Y] = gyroDev->gyroADCRaw[Y];
+    gyroADC[0][Z] = gyroDev->gyroADCRaw[Z];
 
-    alignSensors(gyroADC, gyroDev->gyroAlign);
+    alignSensors(gyroADC[0], gyroDev->gyroAlign);
 
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        gyroADC[axis] -= gyroZero[axis];
-        // scale gyro output to degrees per second
-        float gyroADCf = (float)gyroADC[axis] * gyroDev->scale;
-        gyroADCf = softLpfFilterApplyFn(softLpfFilter[axis], gyroADCf);
-        gyroADCf = notchFilter1ApplyFn(notchFilter1[axis], gyroADCf);
-        gyroADCf = notchFilter2ApplyFn(notchFilter2[axis], gyroADCf);
-        gyro.gyroADCf[axis] = gyroADCf;
-    }
+    gyroRate_t rate[XYZ_AXIS_COUNT];
+    gyroRateFromADC(rate);
+    gyroApplyFilters(rate);
     return true;
 }
 #endif
 
-void gyroUpdate(void)
+// Reads one sensor into gyroADC[], aligned, the zero is not taken off yet
+static FAST_CODE bool gyroReadSensor(uint8_t index)
+{
+    gyroDev_t *dev = gyroSensor[index];
+
+    const bool readOk = dev->read(dev);
+#ifdef USE_DUAL_GYRO
+    if (gyroCount > 1) {
+        const int16_t raw[XYZ_AXIS_COUNT] = { dev->gyroADCRaw[X], dev->gyroADCRaw[Y], dev->gyroADCRaw[Z] };
+        gyroFusionCheckSample(&gyroFusion, index, readOk, raw);
+    }
+#endif
+    if (!readOk) {
+        return false;
+    }
+    dev->dataReady = false;
+    // move gyro data into 32-bit variables to avoid overflows in calculations
+    gyroADC[index][X] = dev->gyroADCRaw[X];
+    gyroADC[index][Y] = dev->gyroADCRaw[Y];
+    gyroADC[index][Z] = dev->gyroADCRaw[Z];
+
+    alignSensors(gyroADC[index], dev->gyroAlign);
+    return true;
+}
+
+FAST_CODE void gyroUpdate(void)
 {
     // range: +/- 8192; +/- 2000 deg/sec
     if (gyro.dev.update) {
         // if the gyro update function is set then return, since the gyro is read in gyroUpdateISR
         return;
     }
-    if (!gyro.dev.read(&gyro.dev)) {
+    bool anyRead = false;
+    for (int i = 0; i < gyroCount; i++) {
+        anyRead |= gyroReadSensor(i);
+    }
+    if (!anyRead) {
         return;
     }
-    gyro.dev.dataReady = false;
-    // move gyro data into 32-bit variables to avoid overflows in calculations
-    gyroADC[X] = gyro.dev.gyroADCRaw[X];
-    gyroADC[Y] = gyro.dev.gyroADCRaw[Y];
-    gyroADC[Z] = gyro.dev.gyroADCRaw[Z];
-
-    alignSensors(gyroADC, gyro.dev.gyroAlign);
 
     const bool calibrationComplete = isGyroCalibrationComplete();
     if (calibrationComplete) {
 #if defined(GYRO_USES_SPI) && defined(USE_MPU_DATA_READY_SIGNAL)
-        // SPI-based gyro so can read and update in ISR
-        if (gyroConfig->gyro_isr_update) {
+        // SPI-based gyro so can read and update in ISR, only one gyro is read there
+        if (gyroConfig->gyro_isr_update && gyroCount == 1) {
             mpuGyroSetIsrUpdate(&gyro.dev, gyroUpdateISR);
             return;
         }
@@ -451,29 +813,57 @@ void gyroUpdate(void)
 #ifdef DEBUG_MPU_DATA_READY_INTERRUPT
         debug[3] = (uint16_t)(micros() & 0xffff);
 #endif
+        if (!ARMING_FLAG(ARMED)) {
+            if (gyroConfig->gyroMovementCalibrationThreshold) {
+                for (int i = 0; i < gyroCount; i++) {
+                    if (gyroSensorHealthy(i)) {
+                        gyroTrackDrift(i, gyroConfig->gyroMovementCalibrationThreshold);
+                    }
+                }
+            }
+        } else if (gyroDrift[0].count) {
+            memset(gyroDrift, 0, sizeof(gyroDrift));
+        }
     } else {
         performGyroCalibration(gyroConfig->gyroMovementCalibrationThreshold);
     }
 
-    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-        gyroADC[axis] -= gyroZero[axis];
-        // scale gyro output to degrees per second
-        float gyroADCf = (float)gyroADC[axis] * gyro.dev.scale;
-
-        // Apply LPF
-        DEBUG_SET(DEBUG_GYRO, axis, lrintf(gyroADCf));
-        gyroADCf = softLpfFilterApplyFn(softLpfFilter[axis], gyroADCf);
-
-        // Apply Notch filtering
-        DEBUG_SET(DEBUG_NOTCH, axis, lrintf(gyroADCf));
-        gyroADCf = notchFilter1ApplyFn(notchFilter1[axis], gyroADCf);
-        gyroADCf = notchFilter2ApplyFn(notchFilter2[axis], gyroADCf);
-        gyro.gyroADCf[axis] = gyroADCf;
+#ifdef USE_FIXED_POINT_PID
+    if (!ARMING_FLAG(ARMED)) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroZeroFix[axis] = fix16FromFloat(gyroZero[0][axis]);
+        }
+        gyroScaleQ30 = q30FromFloat(gyro.dev.scale);
     }
+#endif
 
-    if (!calibrationComplete) {
-        gyroADC[X] = lrintf(gyro.gyroADCf[X] / gyro.dev.scale);
-        gyroADC[Y] = lrintf(gyro.gyroADCf[Y] / gyro.dev.scale);
-        gyroADC[Z] = lrintf(gyro.gyroADCf[Z] / gyro.dev.scale);
+    gyroRate_t rate[XYZ_AXIS_COUNT];
+#ifdef USE_DUAL_GYRO
+    if (gyroCount > 1) {
+        float rates[GYRO_COUNT][XYZ_AXIS_COUNT];
+        for (int i = 0; i < gyroCount; i++) {
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                rates[i][axis] = (gyroADC[i][axis] - gyroZero[i][axis]) * gyroSensor[i]->scale;
+            }
+        }
+        float fused[XYZ_AXIS_COUNT];
+        if (!gyroFusionApply(&gyroFusion, rates, fused)) {
+            // none to trust, keep the last rates
+            return;
+        }
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+#ifdef USE_FIXED_POINT_PID
+            rate[axis] = fix16FromFloat(fused[axis]);
+#else
+            rate[axis] = fused[axis];
+#endif
+        }
+    } else
+#endif
+    {
+        // scale gyro output to degrees per second
+        gyroRateFromADC(rate);
     }
+
+    gyroApplyFilters(rate);
 }
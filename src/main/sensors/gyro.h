@@ -19,6 +19,7 @@
 
 #include "drivers/accgyro.h"
 #include "common/axis.h"
+#include "common/maths.h"
 
 typedef enum {
     GYRO_NONE = 0,
@@ -40,10 +41,20 @@ typedef struct gyro_s {
     gyroDev_t dev;
     uint32_t targetLooptime;
     float gyroADCf[XYZ_AXIS_COUNT];
+#ifdef USE_FIXED_POINT_PID
+    fix16_t gyroADCFix[XYZ_AXIS_COUNT];     // the same rates, what the fixed point PID loop takes
+#endif
 } gyro_t;
 
 extern gyro_t gyro;
 
+#define GYRO_BIAS_TEMPERATURE_NONE  INT8_MIN
+
+typedef struct gyroBiasCache_s {
+    int16_t bias[XYZ_AXIS_COUNT];           // raw and aligned, of the first gyro
+    int8_t temperature;                     // degrees C it was measured at
+} gyroBiasCache_t;
+
 typedef struct gyroConfig_s {
     sensor_align_e gyro_align;              // gyro alignment
     uint8_t  gyroMovementCalibrationThreshold; // people keep forgetting that moving model while init results in wrong gyro offsets. and then they never reset gyro. so this is now on by default.
@@ -57,10 +68,18 @@ typedef struct gyroConfig_s {
     uint16_t gyro_soft_notch_cutoff_1;
     uint16_t gyro_soft_notch_hz_2;
     uint16_t gyro_soft_notch_cutoff_2;
+    uint8_t  gyro_fusion_mode;                 // how the rates of two gyros are fused, gyroFusionMode_e
+    uint8_t  gyro_2_weight;                    // percent of the fused rate from the second gyro
+    sensor_align_e gyro_2_align;
+    gyroBiasCache_t gyro_bias_cache;
 } gyroConfig_t;
 
 void gyroSetCalibrationCycles(void);
+void setGyroBiasCache(gyroBiasCache_t *gyroBiasCacheToUse);
+bool gyroBiasCacheSavePending(void);
+void gyroBiasCacheSaved(void);
 bool gyroInit(const gyroConfig_t *gyroConfigToUse);
 void gyroInitFilters(void);
 void gyroUpdate(void);
 bool isGyroCalibrationComplete(void);
+uint8_t gyroSensorsUsed(void);
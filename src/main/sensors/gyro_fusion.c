@@ -0,0 +1,214 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/axis.h"
+#include "common/maths.h"
+
+#include "sensors/gyro_fusion.h"
+
+void gyroFusionInit(gyroFusion_t *fusion, uint8_t sensorCount, gyroFusionMode_e mode, const uint8_t *weights)
+{
+    memset(fusion, 0, sizeof(*fusion));
+    fusion->sensorCount = MIN(sensorCount, GYRO_FUSION_SENSOR_COUNT_MAX);
+    fusion->mode = mode;
+    for (int i = 0; i < fusion->sensorCount; i++) {
+        fusion->sensor[i].weight = weights ? weights[i] : 1.0f;
+    }
+}
+
+static void sensorFault(gyroFusionSensor_t *sensor, gyroHealth_e fault, uint16_t recoverSamples)
+{
+    if (sensor->health == GYRO_HEALTH_OK) {
+        sensor->faultCount++;
+    }
+    sensor->health = fault;
+    sensor->lastFault = fault;
+    sensor->recoverCount = recoverSamples;
+}
+
+// Checks a raw sample as read from the sensor, before alignment and calibration
+gyroHealth_e gyroFusionCheckSample(gyroFusion_t *fusion, uint8_t index, bool readOk, const int16_t *raw)
+{
+    gyroFusionSensor_t *sensor = &fusion->sensor[index];
+
+    if (!readOk) {
+        // nothing new to use this time, no need to wait for more once it reads again
+        sensorFault(sensor, GYRO_HEALTH_NO_DATA, 0);
+        return sensor->health;
+    }
+
+    bool unchanged = true;
+    bool saturated = false;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        unchanged = unchanged && raw[axis] == sensor->lastRaw[axis];
+        saturated = saturated || ABS(raw[axis]) >= GYRO_SATURATION_RAW;
+        sensor->lastRaw[axis] = raw[axis];
+    }
+
+    if (unchanged) {
+        if (sensor->unchangedCount < GYRO_STUCK_SAMPLES) {
+            sensor->unchangedCount++;
+        }
+    } else {
+        sensor->unchangedCount = 0;
+    }
+
+    if (sensor->unchangedCount >= GYRO_STUCK_SAMPLES) {
+        sensorFault(sensor, GYRO_HEALTH_STUCK, GYRO_RECOVER_SAMPLES);
+    } else if (saturated) {
+        sensorFault(sensor, GYRO_HEALTH_SATURATED, GYRO_RECOVER_SAMPLES);
+    } else if (sensor->recoverCount > 0) {
+        sensor->recoverCount--;
+    } else {
+        sensor->health = GYRO_HEALTH_OK;
+    }
+    return sensor->health;
+}
+
+static int sensorsInMask(uint8_t mask)
+{
+    int count = 0;
+    for (; mask; mask >>= 1) {
+        count += mask & 1;
+    }
+    return count;
+}
+
+static float medianOf(const float *values, int count)
+{
+    float v[GYRO_FUSION_SENSOR_COUNT_MAX];
+
+    switch (count) {
+    case 1:
+        return values[0];
+    case 2:
+        return (values[0] + values[1]) * 0.5f;
+    default:
+        memcpy(v, values, sizeof(v));
+        return quickMedianFilter3f(v);
+    }
+}
+
+// Three or more sensors vote, one away from the median on any axis for a while is dropped
+static uint8_t outvote(gyroFusion_t *fusion, float rates[][XYZ_AXIS_COUNT], uint8_t mask)
+{
+    float median[XYZ_AXIS_COUNT];
+    float values[GYRO_FUSION_SENSOR_COUNT_MAX];
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        int count = 0;
+        for (int i = 0; i < fusion->sensorCount; i++) {
+            if (mask & (1 << i)) {
+                values[count++] = rates[i][axis];
+            }
+        }
+        median[axis] = medianOf(values, count);
+    }
+
+    uint8_t agreed = mask;
+    for (int i = 0; i < fusion->sensorCount; i++) {
+        if (!(mask & (1 << i))) {
+            continue;
+        }
+        gyroFusionSensor_t *sensor = &fusion->sensor[i];
+        bool away = false;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            away = away || fabsf(rates[i][axis] - median[axis]) > GYRO_OUTVOTE_DPS;
+        }
+        if (!away) {
+            sensor->outvotedCount = 0;
+            continue;
+        }
+        agreed &= ~(1 << i);
+        if (++sensor->outvotedCount >= GYRO_OUTVOTE_SAMPLES) {
+            sensor->outvotedCount = 0;
+            sensorFault(sensor, GYRO_HEALTH_OUTVOTED, GYRO_RECOVER_SAMPLES);
+        }
+    }
+    return agreed;
+}
+
+// Fuses the calibrated rates, in deg/s, of the healthy sensors. Returns false when there is none to use.
+bool gyroFusionApply(gyroFusion_t *fusion, float rates[][XYZ_AXIS_COUNT], float *fused)
+{
+    uint8_t mask = 0;
+    uint8_t saturatedMask = 0;
+
+    for (int i = 0; i < fusion->sensorCount; i++) {
+        if (fusion->sensor[i].health == GYRO_HEALTH_OK) {
+            mask |= 1 << i;
+        } else if (fusion->sensor[i].health == GYRO_HEALTH_SATURATED) {
+            saturatedMask |= 1 << i;
+        }
+    }
+    if (!mask) {
+        // all clipping in a hard manoeuvre, that is still the best there is
+        mask = saturatedMask;
+    }
+    if (sensorsInMask(mask) >= 3) {
+        mask = outvote(fusion, rates, mask);
+    }
+
+    fusion->usedMask = mask;
+    if (!mask) {
+        return false;
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        if (fusion->mode == GYRO_FUSION_MEDIAN) {
+            float values[GYRO_FUSION_SENSOR_COUNT_MAX];
+            int count = 0;
+            for (int i = 0; i < fusion->sensorCount; i++) {
+                if (mask & (1 << i)) {
+                    values[count++] = rates[i][axis];
+                }
+            }
+            fused[axis] = medianOf(values, count);
+        } else {
+            float sum = 0.0f;
+            float weightSum = 0.0f;
+            int count = 0;
+            for (int i = 0; i < fusion->sensorCount; i++) {
+                if (mask & (1 << i)) {
+                    sum += rates[i][axis] * fusion->sensor[i].weight;
+                    weightSum += fusion->sensor[i].weight;
+                    count++;
+                }
+            }
+            if (weightSum > 0.0f) {
+                fused[axis] = sum / weightSum;
+            } else {
+                // only sensors weighted out are left
+                sum = 0.0f;
+                for (int i = 0; i < fusion->sensorCount; i++) {
+                    if (mask & (1 << i)) {
+                        sum += rates[i][axis];
+                    }
+                }
+                fused[axis] = sum / count;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/axis.h"
+
+// Health checks on the raw samples of each gyro and fusion of the calibrated rates of those that pass.
+
+#define GYRO_FUSION_SENSOR_COUNT_MAX    3
+
+#define GYRO_STUCK_SAMPLES              64      // the same raw sample on every axis this many times in a row
+#define GYRO_SATURATION_RAW             32000   // close enough to full scale to be clipping
+#define GYRO_RECOVER_SAMPLES            1024    // clean samples before a faulty sensor is used again
+#define GYRO_OUTVOTE_DPS                100.0f  // away from the median of three or more sensors
+#define GYRO_OUTVOTE_SAMPLES            16
+
+typedef enum {
+    GYRO_FUSION_AVERAGE = 0,    // weighted average
+    GYRO_FUSION_MEDIAN
+} gyroFusionMode_e;
+
+typedef enum {
+    GYRO_HEALTH_OK = 0,
+    GYRO_HEALTH_NO_DATA,        // read failed
+    GYRO_HEALTH_STUCK,
+    GYRO_HEALTH_SATURATED,
+    GYRO_HEALTH_OUTVOTED
+} gyroHealth_e;
+
+typedef struct gyroFusionSensor_s {
+    int16_t lastRaw[XYZ_AXIS_COUNT];
+    uint16_t unchangedCount;
+    uint16_t outvotedCount;
+    uint16_t recoverCount;      // clean samples left before it is used again
+    gyroHealth_e health;
+    gyroHealth_e lastFault;
+    uint16_t faultCount;
+    float weight;
+} gyroFusionSensor_t;
+
+typedef struct gyroFusion_s {
+    uint8_t sensorCount;
+    gyroFusionMode_e mode;
+    uint8_t usedMask;           // sensors in the last fused sample
+    gyroFusionSensor_t sensor[GYRO_FUSION_SENSOR_COUNT_MAX];
+} gyroFusion_t;
+
+void gyroFusionInit(gyroFusion_t *fusion, uint8_t sensorCount, gyroFusionMode_e mode, const uint8_t *weights);
+gyroHealth_e gyroFusionCheckSample(gyroFusion_t *fusion, uint8_t index, bool readOk, const int16_t *raw);
+bool gyroFusionApply(gyroFusion_t *fusion, float rates[][XYZ_AXIS_COUNT], float *fused);
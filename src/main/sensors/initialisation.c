@@ -54,8 +54,6 @@ static bool sonarDetect(void)
 
 bool sensorsAutodetect(const gyroConfig_t *gyroConfig,
         const accelerometerConfig_t *accelerometerConfig,
-        const compassConfig_t *compassConfig,
-        const barometerConfig_t *barometerConfig,
         const sonarConfig_t *sonarConfig)
 {
     // gyro must be initialised before accelerometer
@@ -66,19 +64,6 @@ bool sensorsAutodetect(const gyroConfig_t *gyroConfig,
     accInit(accelerometerConfig, gyro.targetLooptime);
 
     mag.magneticDeclination = 0.0f; // TODO investigate if this is actually needed if there is no mag sensor or if the value stored in the config should be used.
-#ifdef MAG
-    if (compassDetect(&mag.dev, compassConfig->mag_hardware)) {
-        compassInit(compassConfig);
-    }
-#else
-    UNUSED(compassConfig);
-#endif
-
-#ifdef BARO
-    baroDetect(&baro.dev, barometerConfig->baro_hardware);
-#else
-    UNUSED(barometerConfig);
-#endif
 
 #ifdef SONAR
     if (sonarDetect()) {
@@ -94,9 +79,35 @@ bool sensorsAutodetect(const gyroConfig_t *gyroConfig,
     if (accelerometerConfig->acc_align != ALIGN_DEFAULT) {
         acc.dev.accAlign = accelerometerConfig->acc_align;
     }
+
+    return true;
+}
+
+// Compass and baro are not needed to fly, they are detected after the scheduler has started
+bool sensorsAutodetectCompass(const compassConfig_t *compassConfig)
+{
+#ifdef MAG
+    if (!compassDetect(&mag.dev, compassConfig->mag_hardware)) {
+        return false;
+    }
+    compassInit(compassConfig);
+
     if (compassConfig->mag_align != ALIGN_DEFAULT) {
         mag.dev.magAlign = compassConfig->mag_align;
     }
-
     return true;
+#else
+    UNUSED(compassConfig);
+    return false;
+#endif
+}
+
+bool sensorsAutodetectBaro(const barometerConfig_t *barometerConfig)
+{
+#ifdef BARO
+    return baroDetect(&baro.dev, barometerConfig->baro_hardware);
+#else
+    UNUSED(barometerConfig);
+    return false;
+#endif
 }
@@ -19,6 +19,6 @@
 
 bool sensorsAutodetect(const gyroConfig_t *gyroConfig,
         const accelerometerConfig_t *accConfig,
-        const compassConfig_t *compassConfig,
-        const barometerConfig_t *baroConfig,
         const sonarConfig_t *sonarConfig);
+bool sensorsAutodetectCompass(const compassConfig_t *compassConfig);
+bool sensorsAutodetectBaro(const barometerConfig_t *baroConfig);
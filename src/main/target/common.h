@@ -34,6 +34,8 @@
 #define I2C3_OVERCLOCK true
 #define I2C4_OVERCLOCK true
 #define TELEMETRY_IBUS
+#define USE_FAST_RAM            // DTCM
+#define USE_FAST_CODE           // ITCM
 #endif
 
 /****************************
@@ -43,12 +45,15 @@
 #define USE_DSHOT
 #define I2C3_OVERCLOCK true
 #define TELEMETRY_IBUS
+#define USE_FAST_RAM            // CCM on F405, F411 has none and keeps it in RAM
 #endif
 
 #ifdef STM32F3
 #define USE_DSHOT
+#define USE_SOFTSERIAL_DMA
 #undef GPS
 #define MINIMAL_CLI
+#define USE_FAST_RAM            // CCM, shared with the stack, code stays in flash to leave it the room
 #endif
 
 #ifdef STM32F1
@@ -57,6 +62,7 @@
 #define USE_UART1_TX_DMA
 
 #define MINIMAL_CLI
+#define USE_FIXED_POINT_PID     // no FPU, PID terms, D term filters and tail lookups in fixed point
 #endif
 
 #define SERIAL_RX
@@ -70,6 +76,11 @@
 #define USE_CLI
 #define USE_PWM
 #define USE_PPM
+#define STACK_CHECK             // high-water mark, see drivers/stack_check.c
+
+#if defined(STM32F3) || defined(STM32F4) || defined(STM32F7)
+#define STACK_CHECK_TASKS       // per task peaks as well, sampled by the scheduler
+#endif
 
 #if defined(STM32F4) || defined(STM32F7)
 #define TASK_GYROPID_DESIRED_PERIOD     125
@@ -95,6 +106,7 @@
 #define TELEMETRY_SMARTPORT
 #define USE_SERVOS
 #define USE_RESOURCE_MGMT
+#define USE_TRI_MIXER_FAST_PATH // straight-line mixTable() for MIXER_TRI
 #endif
 
 #if (FLASH_SIZE > 128)
@@ -112,6 +124,7 @@
 #define VTX_SMARTAUDIO
 #define VTX_TRAMP
 #define USE_SENSOR_NAMES
+#define USE_TAIL_IDENTIFICATION // in-flight estimates of the tail servo and motor
 #endif
 
 #if (FLASH_SIZE > 256)
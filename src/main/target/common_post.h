@@ -26,3 +26,18 @@
 # undef VTX_SMARTAUDIO
 # undef VTX_TRAMP
 #endif
+
+// Capture/DMA engine behind the soft serial ports
+#if defined(USE_SOFTSERIAL_DMA) && !defined(USE_SOFTSERIAL1) && !defined(USE_SOFTSERIAL2)
+# undef USE_SOFTSERIAL_DMA
+#endif
+
+// Quad only builds have no tricopter mixer to specialise
+#if defined(USE_TRI_MIXER_FAST_PATH) && defined(USE_QUAD_MIXER_ONLY)
+# undef USE_TRI_MIXER_FAST_PATH
+#endif
+#if defined(USE_TAIL_IDENTIFICATION) && defined(USE_QUAD_MIXER_ONLY)
+# undef USE_TAIL_IDENTIFICATION
+#endif
+
+#include "build/fast_memory.h"
@@ -40,6 +40,8 @@
 #include "common/maths.h"
 #include "common/axis.h"
 #include "common/color.h"
+#include "common/time.h"
+#include "common/utils.h"
 
 #include "drivers/system.h"
 #include "drivers/sensor.h"
@@ -73,10 +75,10 @@
 
 #include "telemetry/telemetry.h"
 #include "telemetry/ltm.h"
+#include "telemetry/telemetry_scheduler.h"
 
 
 #define TELEMETRY_LTM_INITIAL_PORT_MODE MODE_TX
-#define LTM_CYCLETIME   100
 
 static serialPort_t *ltmPort;
 static serialPortConfig_t *portConfig;
@@ -84,6 +86,7 @@ static telemetryConfig_t *telemetryConfig;
 static bool ltmEnabled;
 static portSharing_e ltmPortSharing;
 static uint8_t ltm_crc;
+static telemetryScheduler_t ltmScheduler;
 
 static void ltm_initialise_packet(uint8_t ltm_id)
 {
@@ -122,14 +125,14 @@ static void ltm_finalise(void)
  * GPS G-frame 5Hhz at > 2400 baud
  * LAT LON SPD ALT SAT/FIX
  */
-static void ltm_gframe(void)
+static bool ltm_gframe(void)
 {
 #if defined(GPS)
     uint8_t gps_fix_type = 0;
     int32_t ltm_alt;
 
     if (!sensors(SENSOR_GPS))
-        return;
+        return false;
 
     if (!STATE(GPS_FIX))
         gps_fix_type = 1;
@@ -151,6 +154,9 @@ static void ltm_gframe(void)
     ltm_serialise_32(ltm_alt);
     ltm_serialise_8((GPS_numSat << 2) | gps_fix_type);
     ltm_finalise();
+    return true;
+#else
+    return false;
 #endif
 }
 
@@ -165,7 +171,7 @@ static void ltm_gframe(void)
  *     15: LAND, 16:FlybyWireA, 17: FlybywireB, 18: Cruise, 19: Unknown
  */
 
-static void ltm_sframe(void)
+static bool ltm_sframe(void)
 {
     uint8_t lt_flightmode;
     uint8_t lt_statemode;
@@ -196,19 +202,21 @@ static void ltm_sframe(void)
     ltm_serialise_8(0);              // no airspeed
     ltm_serialise_8((lt_flightmode << 2) | lt_statemode);
     ltm_finalise();
+    return true;
 }
 
 /*
  * Attitude A-frame - 10 Hz at > 2400 baud
  *  PITCH ROLL HEADING
  */
-static void ltm_aframe()
+static bool ltm_aframe(void)
 {
     ltm_initialise_packet('A');
     ltm_serialise_16(DECIDEGREES_TO_DEGREES(attitude.values.pitch));
     ltm_serialise_16(DECIDEGREES_TO_DEGREES(attitude.values.roll));
     ltm_serialise_16(DECIDEGREES_TO_DEGREES(attitude.values.yaw));
     ltm_finalise();
+    return true;
 }
 
 /*
@@ -216,7 +224,7 @@ static void ltm_aframe()
  *  This frame will be ignored by Ghettostation, but processed by GhettOSD if it is used as standalone onboard OSD
  *  home pos, home alt, direction to home
  */
-static void ltm_oframe()
+static bool ltm_oframe(void)
 {
     ltm_initialise_packet('O');
 #if defined(GPS)
@@ -230,37 +238,48 @@ static void ltm_oframe()
     ltm_serialise_8(1);                 // OSD always ON
     ltm_serialise_8(STATE(GPS_FIX_HOME) ? 1 : 0);
     ltm_finalise();
+    return true;
 }
 
-static void process_ltm(void)
+/*
+ * Frame sizes include the "$T" header, frame id and checksum. The rates need 263 bytes/s,
+ * at 2400 baud the scheduler stretches all of them to fit.
+ */
+static const telemetryFrame_t ltmFrames[] = {
+    { 'A', 10, 10 },
+    { 'S', 11, 5 },
+    { 'G', 18, 5 },
+    { 'O', 18, 1 },
+};
+
+static bool (* const ltmFrameFunctions[])(void) = {
+    ltm_aframe,
+    ltm_sframe,
+    ltm_gframe,
+    ltm_oframe,
+};
+
+void handleLtmTelemetry(timeUs_t currentTimeUs)
 {
-    static uint8_t ltm_scheduler;
-    ltm_aframe();
-    if (ltm_scheduler & 1)
-        ltm_gframe();
-    else
-        ltm_sframe();
-    if (ltm_scheduler == 0)
-        ltm_oframe();
-    ltm_scheduler++;
-    ltm_scheduler %= 10;
-}
+    int frameIndex;
 
-void handleLtmTelemetry(void)
-{
-    static uint32_t ltm_lastCycleTime;
-    uint32_t now;
     if (!ltmEnabled)
         return;
     if (!ltmPort)
         return;
-    now = millis();
-    if ((now - ltm_lastCycleTime) >= LTM_CYCLETIME) {
-        process_ltm();
-        ltm_lastCycleTime = now;
+
+    while ((frameIndex = telemetrySchedulerNext(&ltmScheduler, currentTimeUs)) >= 0) {
+        if (ltmFrameFunctions[frameIndex]()) {
+            telemetrySchedulerFrameSent(&ltmScheduler, frameIndex, currentTimeUs);
+        }
     }
 }
 
+static void ltmSchedulerInit(uint32_t baudRate)
+{
+    telemetrySchedulerInit(&ltmScheduler, FUNCTION_TELEMETRY_LTM, ltmFrames, ARRAYLEN(ltmFrames), baudRate, 100, micros());
+}
+
 void freeLtmTelemetryPort(void)
 {
     closeSerialPort(ltmPort);
@@ -287,6 +306,7 @@ void configureLtmTelemetryPort(void)
     ltmPort = openSerialPort(portConfig->identifier, FUNCTION_TELEMETRY_LTM, NULL, baudRates[baudRateIndex], TELEMETRY_LTM_INITIAL_PORT_MODE, SERIAL_NOT_INVERTED);
     if (!ltmPort)
         return;
+    ltmSchedulerInit(baudRates[baudRateIndex]);
     ltmEnabled = true;
 }
 
@@ -295,6 +315,7 @@ void checkLtmTelemetryState(void)
     if (portConfig && telemetryCheckRxPortShared(portConfig)) {
         if (!ltmEnabled && telemetrySharedPort != NULL) {
             ltmPort = telemetrySharedPort;
+            ltmSchedulerInit(serialGetBaudRate(ltmPort));
             ltmEnabled = true;
         }
     } else {
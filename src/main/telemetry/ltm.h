@@ -19,9 +19,11 @@
 
 #pragma once
 
+#include "common/time.h"
+
 struct telemetryConfig_s;
 void initLtmTelemetry(struct telemetryConfig_s *initialTelemetryConfig);
-void handleLtmTelemetry(void);
+void handleLtmTelemetry(timeUs_t currentTimeUs);
 void checkLtmTelemetryState(void);
 
 void freeLtmTelemetryPort(void);
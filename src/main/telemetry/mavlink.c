@@ -31,6 +31,8 @@
 #include "common/maths.h"
 #include "common/axis.h"
 #include "common/color.h"
+#include "common/time.h"
+#include "common/utils.h"
 
 #include "drivers/system.h"
 #include "drivers/sensor.h"
@@ -54,6 +56,7 @@
 #include "rx/rx.h"
 
 #include "flight/mixer.h"
+#include "flight/servos.h"
 #include "flight/pid.h"
 #include "flight/imu.h"
 #include "flight/failsafe.h"
@@ -62,6 +65,8 @@
 
 #include "telemetry/telemetry.h"
 #include "telemetry/mavlink.h"
+#include "telemetry/telemetry_scheduler.h"
+#include "telemetry/mavlink_highrate.h"
 
 #include "fc/config.h"
 #include "config/config_profile.h"
@@ -78,8 +83,7 @@
 #pragma GCC diagnostic pop
 
 #define TELEMETRY_MAVLINK_INITIAL_PORT_MODE MODE_TX
-#define TELEMETRY_MAVLINK_MAXRATE 50
-#define TELEMETRY_MAVLINK_DELAY ((1000 * 1000) / TELEMETRY_MAVLINK_MAXRATE)
+#define TELEMETRY_MAVLINK_GRAVITY_MSS 9.80665f
 
 extern uint16_t rssi; // FIXME dependency on mw.c
 
@@ -89,49 +93,69 @@ static serialPortConfig_t *portConfig;
 static bool mavlinkTelemetryEnabled =  false;
 static portSharing_e mavlinkPortSharing;
 
-/* MAVLink datastream rates in Hz */
-static const uint8_t mavRates[] = {
-    [MAV_DATA_STREAM_EXTENDED_STATUS] = 2, //2Hz
-    [MAV_DATA_STREAM_RC_CHANNELS] = 5, //5Hz
-    [MAV_DATA_STREAM_POSITION] = 2, //2Hz
-    [MAV_DATA_STREAM_EXTRA1] = 10, //10Hz
-    [MAV_DATA_STREAM_EXTRA2] = 10 //2Hz
+/*
+ * MAVLink datastreams with their target rates in Hz, sizes are the MAVLink v1 messages sent per stream
+ * including the 8 bytes of framing.
+ */
+static const telemetryFrame_t mavlinkStreamFrames[] = {
+    { MAV_DATA_STREAM_EXTENDED_STATUS, 39, 2 },     // SYS_STATUS
+    { MAV_DATA_STREAM_RC_CHANNELS, 30, 5 },         // RC_CHANNELS_RAW
+#if defined(GPS)
+    { MAV_DATA_STREAM_POSITION, 94, 2 },            // GPS_RAW_INT, GLOBAL_POSITION_INT, GPS_GLOBAL_ORIGIN
+#endif
+    { MAV_DATA_STREAM_EXTRA1, 36, 10 },             // ATTITUDE
+    { MAV_DATA_STREAM_EXTRA2, 45, 10 },             // VFR_HUD, HEARTBEAT
 };
 
-#define MAXSTREAMS (sizeof(mavRates) / sizeof(mavRates[0]))
+// the streams above followed by the high rate messages when mavlink_highrate_hz is set
+static telemetryFrame_t mavlinkFrames[TELEMETRY_SCHEDULER_MAX_FRAMES];
+static uint8_t mavlinkFrameCount;
+static uint8_t mavlinkMaxFrameSize;
 
-static uint8_t mavTicks[MAXSTREAMS];
+static telemetryScheduler_t mavlinkScheduler;
 static mavlink_message_t mavMsg;
-static uint8_t mavBuffer[MAVLINK_MAX_PACKET_LEN];
-static uint32_t lastMavlinkMessage = 0;
 
-static int mavlinkStreamTrigger(enum MAV_DATA_STREAM streamNum)
-{
-    uint8_t rate = (uint8_t) mavRates[streamNum];
-    if (rate == 0) {
-        return 0;
-    }
+// messages are serialised back to back and handed to the serial port in one write
+static uint8_t mavBatch[MAVLINK_MAX_PACKET_LEN];
+static uint16_t mavBatchLength;
 
-    if (mavTicks[streamNum] == 0) {
-        // we're triggering now, setup the next trigger point
-        if (rate > TELEMETRY_MAVLINK_MAXRATE) {
-            rate = TELEMETRY_MAVLINK_MAXRATE;
-        }
+static mavlinkHighRateSample_t mavHighRateSample;
 
-        mavTicks[streamNum] = (TELEMETRY_MAVLINK_MAXRATE / rate);
-        return 1;
+static void mavlinkFlush(void)
+{
+    if (mavBatchLength) {
+        serialWriteBuf(mavlinkPort, mavBatch, mavBatchLength);
+        mavBatchLength = 0;
     }
+}
 
-    // count down at TASK_RATE_HZ
-    mavTicks[streamNum]--;
-    return 0;
+static uint8_t *mavlinkReserve(uint16_t length)
+{
+    if (mavBatchLength + length > sizeof(mavBatch)) {
+        mavlinkFlush();
+    }
+    return &mavBatch[mavBatchLength];
 }
 
+static void mavlinkQueueMessage(void)
+{
+    uint8_t *dst = mavlinkReserve(MAVLINK_NUM_NON_PAYLOAD_BYTES + mavMsg.len);
+    mavBatchLength += mavlink_msg_to_send_buffer(dst, &mavMsg);
+}
 
-static void mavlinkSerialWrite(uint8_t * buf, uint16_t length)
+static void mavlinkInitFrames(void)
 {
-    for (int i = 0; i < length; i++)
-        serialWrite(mavlinkPort, buf[i]);
+    memcpy(mavlinkFrames, mavlinkStreamFrames, sizeof(mavlinkStreamFrames));
+    mavlinkFrameCount = ARRAYLEN(mavlinkStreamFrames);
+
+    if (telemetryConfig()->mavlink_highrate_hz) {
+        mavlinkFrameCount += mavlinkHighRateInitFrames(&mavlinkFrames[mavlinkFrameCount], MIN(telemetryConfig()->mavlink_highrate_hz, MAVLINK_HIGHRATE_MAX_HZ));
+    }
+
+    mavlinkMaxFrameSize = 0;
+    for (int i = 0; i < mavlinkFrameCount; i++) {
+        mavlinkMaxFrameSize = MAX(mavlinkMaxFrameSize, mavlinkFrames[i].size);
+    }
 }
 
 void freeMAVLinkTelemetryPort(void)
@@ -143,6 +167,7 @@ void freeMAVLinkTelemetryPort(void)
 
 void initMAVLinkTelemetry(void)
 {
+    mavlinkInitFrames();
     portConfig = findSerialPortConfig(FUNCTION_TELEMETRY_MAVLINK);
     mavlinkPortSharing = determinePortSharing(portConfig, FUNCTION_TELEMETRY_MAVLINK);
 }
@@ -165,6 +190,7 @@ void configureMAVLinkTelemetryPort(void)
         return;
     }
 
+    telemetrySchedulerInit(&mavlinkScheduler, FUNCTION_TELEMETRY_MAVLINK, mavlinkFrames, mavlinkFrameCount, baudRates[baudRateIndex], 100, micros());
     mavlinkTelemetryEnabled = true;
 }
 
@@ -173,6 +199,7 @@ void checkMAVLinkTelemetryState(void)
     if (portConfig && telemetryCheckRxPortShared(portConfig)) {
         if (!mavlinkTelemetryEnabled && telemetrySharedPort != NULL) {
             mavlinkPort = telemetrySharedPort;
+            telemetrySchedulerInit(&mavlinkScheduler, FUNCTION_TELEMETRY_MAVLINK, mavlinkFrames, mavlinkFrameCount, serialGetBaudRate(mavlinkPort), 100, micros());
             mavlinkTelemetryEnabled = true;
         }
     } else {
@@ -191,7 +218,6 @@ void checkMAVLinkTelemetryState(void)
 
 void mavlinkSendSystemStatus(void)
 {
-    uint16_t msgLength;
 
     uint32_t onboardControlAndSensors = 35843;
 
@@ -240,13 +266,11 @@ void mavlinkSendSystemStatus(void)
         0,
         // errors_count4 Autopilot-specific errors
         0);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkQueueMessage();
 }
 
 void mavlinkSendRCChannelsAndRSSI(void)
 {
-    uint16_t msgLength;
     mavlink_msg_rc_channels_raw_pack(0, 200, &mavMsg,
         // time_boot_ms Timestamp (milliseconds since system boot)
         millis(),
@@ -270,14 +294,12 @@ void mavlinkSendRCChannelsAndRSSI(void)
         (rxRuntimeConfig.channelCount >= 8) ? rcData[7] : 0,
         // rssi Receive signal strength indicator, 0: 0%, 255: 100%
         scaleRange(rssi, 0, 1023, 0, 255));
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkQueueMessage();
 }
 
 #if defined(GPS)
 void mavlinkSendPosition(void)
 {
-    uint16_t msgLength;
     uint8_t gpsFixType = 0;
 
     if (!sensors(SENSOR_GPS))
@@ -316,8 +338,7 @@ void mavlinkSendPosition(void)
         GPS_ground_course * 10,
         // satellites_visible Number of satellites visible. If unknown, set to 255
         GPS_numSat);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkQueueMessage();
 
     // Global position
     mavlink_msg_global_position_int_pack(0, 200, &mavMsg,
@@ -344,8 +365,7 @@ void mavlinkSendPosition(void)
         // heading Current heading in degrees, in compass units (0..360, 0=north)
         DECIDEGREES_TO_DEGREES(attitude.values.yaw)
     );
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkQueueMessage();
 
     mavlink_msg_gps_global_origin_pack(0, 200, &mavMsg,
         // latitude Latitude (WGS84), expressed as * 1E7
@@ -354,14 +374,12 @@ void mavlinkSendPosition(void)
         GPS_home[LON],
         // altitude Altitude(WGS84), expressed as * 1000
         0);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkQueueMessage();
 }
 #endif
 
 void mavlinkSendAttitude(void)
 {
-    uint16_t msgLength;
     mavlink_msg_attitude_pack(0, 200, &mavMsg,
         // time_boot_ms Timestamp (milliseconds since system boot)
         millis(),
@@ -377,13 +395,11 @@ void mavlinkSendAttitude(void)
         0,
         // yawspeed Yaw angular speed (rad/s)
         0);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkQueueMessage();
 }
 
 void mavlinkSendHUDAndHeartbeat(void)
 {
-    uint16_t msgLength;
     float mavAltitude = 0;
     float mavGroundSpeed = 0;
     float mavAirSpeed = 0;
@@ -428,8 +444,7 @@ void mavlinkSendHUDAndHeartbeat(void)
         mavAltitude,
         // climb Current climb rate in meters/second
         mavClimbRate);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkQueueMessage();
 
 
     uint8_t mavModes = MAV_MODE_FLAG_MANUAL_INPUT_ENABLED;
@@ -510,37 +525,124 @@ void mavlinkSendHUDAndHeartbeat(void)
         mavCustomMode,
         // system_status System status flag, see MAV_STATE ENUM
         mavSystemState);
-    msgLength = mavlink_msg_to_send_buffer(mavBuffer, &mavMsg);
-    mavlinkSerialWrite(mavBuffer, msgLength);
+    mavlinkQueueMessage();
 }
 
-void processMAVLinkTelemetry(void)
+/*
+ * Companion computer stream, in MAVLink's forward-right-down body and north-east-down earth frames.
+ * Ours are forward-left-up, which is the same rotation seen from the other side of the X axis, so Y and Z
+ * change sign. The quaternion does not include the magnetic declination that ATTITUDE adds to the yaw.
+ */
+static void mavlinkUpdateHighRateSample(timeUs_t currentTimeUs)
 {
-    // is executed @ TELEMETRY_MAVLINK_MAXRATE rate
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTENDED_STATUS)) {
-        mavlinkSendSystemStatus();
+    float quaternion[4];
+
+    imuGetQuaternion(quaternion);
+
+    mavHighRateSample.timeUs = currentTimeUs;
+    mavHighRateSample.quaternion[0] = quaternion[0];
+    mavHighRateSample.quaternion[1] = quaternion[1];
+    mavHighRateSample.quaternion[2] = -quaternion[2];
+    mavHighRateSample.quaternion[3] = -quaternion[3];
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float sign = axis == X ? 1.0f : -1.0f;
+        mavHighRateSample.gyro[axis] = sign * DEGREES_TO_RADIANS(gyro.gyroADCf[axis]);
+        mavHighRateSample.acc[axis] = sign * acc.accSmooth[axis] * TELEMETRY_MAVLINK_GRAVITY_MSS / acc.dev.acc_1G;
     }
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_RC_CHANNELS)) {
-        mavlinkSendRCChannelsAndRSSI();
+    for (int i = 0; i < MAVLINK_HIGHRATE_SERVO_COUNT; i++) {
+#ifdef USE_SERVOS
+        // includes the tricopter tail servo
+        mavHighRateSample.servo[i] = i < MAX_SUPPORTED_SERVOS ? servo[i] : 0;
+#else
+        mavHighRateSample.servo[i] = 0;
+#endif
     }
+}
+
+static bool mavlinkSendHighRate(uint8_t msgId, timeUs_t currentTimeUs, bool *sampled)
+{
+    mavlink_status_t *status = mavlink_get_channel_status(MAVLINK_COMM_0);
+    uint8_t *dst = mavlinkReserve(MAVLINK_HIGHRATE_HIGHRES_IMU_SIZE);
+
+    // all high rate messages sent in one telemetry task run describe the same instant
+    if (!*sampled) {
+        mavlinkUpdateHighRateSample(currentTimeUs);
+        *sampled = true;
+    }
+
+    switch (msgId) {
+    case MAVLINK_MSG_ID_HIGHRATE_ATTITUDE_QUATERNION:
+        mavBatchLength += mavlinkPackAttitudeQuaternion(dst, status->current_tx_seq++, &mavHighRateSample);
+        return true;
+
+    case MAVLINK_MSG_ID_HIGHRATE_HIGHRES_IMU:
+        mavBatchLength += mavlinkPackHighresImu(dst, status->current_tx_seq++, &mavHighRateSample);
+        return true;
+
+    case MAVLINK_MSG_ID_HIGHRATE_SERVO_OUTPUT_RAW:
+        mavBatchLength += mavlinkPackServoOutputRaw(dst, status->current_tx_seq++, &mavHighRateSample);
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+static bool mavlinkSendStream(uint8_t streamNum)
+{
+    switch (streamNum) {
+    case MAV_DATA_STREAM_EXTENDED_STATUS:
+        mavlinkSendSystemStatus();
+        return true;
+
+    case MAV_DATA_STREAM_RC_CHANNELS:
+        mavlinkSendRCChannelsAndRSSI();
+        return true;
 
 #ifdef GPS
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_POSITION)) {
+    case MAV_DATA_STREAM_POSITION:
+        if (!sensors(SENSOR_GPS)) {
+            return false;
+        }
         mavlinkSendPosition();
-    }
+        return true;
 #endif
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA1)) {
+    case MAV_DATA_STREAM_EXTRA1:
         mavlinkSendAttitude();
-    }
+        return true;
 
-    if (mavlinkStreamTrigger(MAV_DATA_STREAM_EXTRA2)) {
+    case MAV_DATA_STREAM_EXTRA2:
         mavlinkSendHUDAndHeartbeat();
+        return true;
+
+    default:
+        return false;
     }
 }
 
-void handleMAVLinkTelemetry(void)
+static void processMAVLinkTelemetry(timeUs_t currentTimeUs)
+{
+    bool sampled = false;
+    int frameIndex;
+
+    // stop while the largest frame might not fit into the TX buffer, a due frame then waits for the next run
+    while (serialTxBytesFree(mavlinkPort) >= mavBatchLength + mavlinkMaxFrameSize
+            && (frameIndex = telemetrySchedulerNext(&mavlinkScheduler, currentTimeUs)) >= 0) {
+        const uint8_t id = mavlinkFrames[frameIndex].id;
+        const bool sent = frameIndex >= (int)ARRAYLEN(mavlinkStreamFrames) ? mavlinkSendHighRate(id, currentTimeUs, &sampled) : mavlinkSendStream(id);
+
+        if (sent) {
+            telemetrySchedulerFrameSent(&mavlinkScheduler, frameIndex, currentTimeUs);
+        }
+    }
+
+    mavlinkFlush();
+}
+
+void handleMAVLinkTelemetry(timeUs_t currentTimeUs)
 {
     if (!mavlinkTelemetryEnabled) {
         return;
@@ -550,11 +652,7 @@ void handleMAVLinkTelemetry(void)
         return;
     }
 
-    uint32_t now = micros();
-    if ((now - lastMavlinkMessage) >= TELEMETRY_MAVLINK_DELAY) {
-        processMAVLinkTelemetry();
-        lastMavlinkMessage = now;
-    }
+    processMAVLinkTelemetry(currentTimeUs);
 }
 
 #endif
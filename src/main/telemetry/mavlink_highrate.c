@@ -0,0 +1,155 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "telemetry/mavlink_highrate.h"
+
+/*
+ * Serialises the high rate companion computer messages straight into the caller's transmit buffer.
+ *
+ * The MAVLink library packs into a mavlink_message_t, checksums it there and then copies the frame
+ * out again with mavlink_msg_to_send_buffer(). These write each field once at its wire position and
+ * checksum the finished frame, the output is byte for byte what the library sends.
+ */
+
+#define MAVLINK_STX                 0xFE
+#define MAVLINK_SYSTEM_ID           0
+#define MAVLINK_COMPONENT_ID        200     // same as the telemetry streams in mavlink.c
+
+// CRC_EXTRA seeds from the message definitions
+#define MAVLINK_ATTITUDE_QUATERNION_CRC_EXTRA   246
+#define MAVLINK_HIGHRES_IMU_CRC_EXTRA           93
+#define MAVLINK_SERVO_OUTPUT_RAW_CRC_EXTRA      222
+
+// HIGHRES_IMU fields_updated, accelerometer and gyro
+#define MAVLINK_HIGHRES_IMU_UPDATED_ACC_GYRO    0x003F
+
+uint8_t mavlinkHighRateInitFrames(telemetryFrame_t *frames, uint16_t rateHz)
+{
+    const telemetryFrame_t highRateFrames[MAVLINK_HIGHRATE_FRAME_COUNT] = {
+        { MAVLINK_MSG_ID_HIGHRATE_ATTITUDE_QUATERNION, MAVLINK_HIGHRATE_ATTITUDE_QUATERNION_SIZE, rateHz },
+        { MAVLINK_MSG_ID_HIGHRATE_HIGHRES_IMU, MAVLINK_HIGHRATE_HIGHRES_IMU_SIZE, rateHz },
+        { MAVLINK_MSG_ID_HIGHRATE_SERVO_OUTPUT_RAW, MAVLINK_HIGHRATE_SERVO_OUTPUT_RAW_SIZE, rateHz },
+    };
+
+    memcpy(frames, highRateFrames, sizeof(highRateFrames));
+    return MAVLINK_HIGHRATE_FRAME_COUNT;
+}
+
+static inline uint8_t *mavlinkPutU16(uint8_t *dst, uint16_t value)
+{
+    dst[0] = value;
+    dst[1] = value >> 8;
+    return dst + 2;
+}
+
+static inline uint8_t *mavlinkPutU32(uint8_t *dst, uint32_t value)
+{
+    dst[0] = value;
+    dst[1] = value >> 8;
+    dst[2] = value >> 16;
+    dst[3] = value >> 24;
+    return dst + 4;
+}
+
+static inline uint8_t *mavlinkPutFloat(uint8_t *dst, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return mavlinkPutU32(dst, bits);
+}
+
+static uint8_t *mavlinkBeginFrame(uint8_t *dst, uint8_t sequence, uint8_t msgId, uint8_t payloadLength)
+{
+    dst[0] = MAVLINK_STX;
+    dst[1] = payloadLength;
+    dst[2] = sequence;
+    dst[3] = MAVLINK_SYSTEM_ID;
+    dst[4] = MAVLINK_COMPONENT_ID;
+    dst[5] = msgId;
+    return dst + MAVLINK_HIGHRATE_HEADER_LEN;
+}
+
+// X.25 CRC over everything after STX, seeded with the message's CRC_EXTRA at the end
+static uint8_t mavlinkFinishFrame(uint8_t *dst, uint8_t crcExtra)
+{
+    const uint8_t length = MAVLINK_HIGHRATE_HEADER_LEN + dst[1];
+    uint16_t crc = 0xFFFF;
+
+    for (int i = 1; i <= length; i++) {
+        uint8_t tmp = (i < length ? dst[i] : crcExtra) ^ (uint8_t)crc;
+        tmp ^= tmp << 4;
+        crc = (crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4);
+    }
+
+    mavlinkPutU16(dst + length, crc);
+    return length + 2;
+}
+
+uint8_t mavlinkPackAttitudeQuaternion(uint8_t *dst, uint8_t sequence, const mavlinkHighRateSample_t *sample)
+{
+    uint8_t *p = mavlinkBeginFrame(dst, sequence, MAVLINK_MSG_ID_HIGHRATE_ATTITUDE_QUATERNION, MAVLINK_HIGHRATE_ATTITUDE_QUATERNION_SIZE - MAVLINK_HIGHRATE_FRAMING_LEN);
+
+    p = mavlinkPutU32(p, sample->timeUs / 1000);
+    for (int i = 0; i < 4; i++) {
+        p = mavlinkPutFloat(p, sample->quaternion[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        p = mavlinkPutFloat(p, sample->gyro[i]);
+    }
+
+    return mavlinkFinishFrame(dst, MAVLINK_ATTITUDE_QUATERNION_CRC_EXTRA);
+}
+
+uint8_t mavlinkPackHighresImu(uint8_t *dst, uint8_t sequence, const mavlinkHighRateSample_t *sample)
+{
+    uint8_t *p = mavlinkBeginFrame(dst, sequence, MAVLINK_MSG_ID_HIGHRATE_HIGHRES_IMU, MAVLINK_HIGHRATE_HIGHRES_IMU_SIZE - MAVLINK_HIGHRATE_FRAMING_LEN);
+
+    // time_usec is 64 bits on the wire
+    p = mavlinkPutU32(p, sample->timeUs);
+    p = mavlinkPutU32(p, 0);
+    for (int i = 0; i < 3; i++) {
+        p = mavlinkPutFloat(p, sample->acc[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        p = mavlinkPutFloat(p, sample->gyro[i]);
+    }
+    // magnetometer, pressures, pressure altitude and temperature are not sent at this rate
+    memset(p, 0, 7 * sizeof(float));
+    p += 7 * sizeof(float);
+    mavlinkPutU16(p, MAVLINK_HIGHRES_IMU_UPDATED_ACC_GYRO);
+
+    return mavlinkFinishFrame(dst, MAVLINK_HIGHRES_IMU_CRC_EXTRA);
+}
+
+uint8_t mavlinkPackServoOutputRaw(uint8_t *dst, uint8_t sequence, const mavlinkHighRateSample_t *sample)
+{
+    uint8_t *p = mavlinkBeginFrame(dst, sequence, MAVLINK_MSG_ID_HIGHRATE_SERVO_OUTPUT_RAW, MAVLINK_HIGHRATE_SERVO_OUTPUT_RAW_SIZE - MAVLINK_HIGHRATE_FRAMING_LEN);
+
+    p = mavlinkPutU32(p, sample->timeUs);
+    for (int i = 0; i < MAVLINK_HIGHRATE_SERVO_COUNT; i++) {
+        p = mavlinkPutU16(p, sample->servo[i]);
+    }
+    *p = 0;     // port, servos 1 to 8
+
+    return mavlinkFinishFrame(dst, MAVLINK_SERVO_OUTPUT_RAW_CRC_EXTRA);
+}
@@ -0,0 +1,53 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "telemetry/telemetry_scheduler.h"
+
+#define MAVLINK_HIGHRATE_MAX_HZ             500
+
+#define MAVLINK_MSG_ID_HIGHRATE_ATTITUDE_QUATERNION 31
+#define MAVLINK_MSG_ID_HIGHRATE_SERVO_OUTPUT_RAW    36
+#define MAVLINK_MSG_ID_HIGHRATE_HIGHRES_IMU         105
+
+#define MAVLINK_HIGHRATE_FRAME_COUNT        3
+#define MAVLINK_HIGHRATE_SERVO_COUNT        8
+
+// MAVLink v1 framing, STX, length, sequence, system, component and message id ahead of the payload, CRC after it
+#define MAVLINK_HIGHRATE_HEADER_LEN         6
+#define MAVLINK_HIGHRATE_FRAMING_LEN        8
+
+#define MAVLINK_HIGHRATE_ATTITUDE_QUATERNION_SIZE   (MAVLINK_HIGHRATE_FRAMING_LEN + 32)
+#define MAVLINK_HIGHRATE_HIGHRES_IMU_SIZE           (MAVLINK_HIGHRATE_FRAMING_LEN + 62)
+#define MAVLINK_HIGHRATE_SERVO_OUTPUT_RAW_SIZE      (MAVLINK_HIGHRATE_FRAMING_LEN + 21)
+
+// Attitude and sensors in MAVLink conventions, body frame forward-right-down, earth frame north-east-down
+typedef struct mavlinkHighRateSample_s {
+    uint32_t timeUs;
+    float quaternion[4];            // w x y z, body to earth
+    float gyro[3];                  // rad/s
+    float acc[3];                   // m/s/s
+    uint16_t servo[MAVLINK_HIGHRATE_SERVO_COUNT];   // us
+} mavlinkHighRateSample_t;
+
+uint8_t mavlinkHighRateInitFrames(telemetryFrame_t *frames, uint16_t rateHz);
+
+// Each writes one complete frame to dst and returns its length
+uint8_t mavlinkPackAttitudeQuaternion(uint8_t *dst, uint8_t sequence, const mavlinkHighRateSample_t *sample);
+uint8_t mavlinkPackHighresImu(uint8_t *dst, uint8_t sequence, const mavlinkHighRateSample_t *sample);
+uint8_t mavlinkPackServoOutputRaw(uint8_t *dst, uint8_t sequence, const mavlinkHighRateSample_t *sample);
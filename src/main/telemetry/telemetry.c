@@ -52,6 +52,30 @@
 
 static telemetryConfig_t *telemetryConfig;
 
+typedef enum {
+    TELEMETRY_PROTOCOL_FRSKY     = (1 << 0),
+    TELEMETRY_PROTOCOL_HOTT      = (1 << 1),
+    TELEMETRY_PROTOCOL_SMARTPORT = (1 << 2),
+    TELEMETRY_PROTOCOL_LTM       = (1 << 3),
+    TELEMETRY_PROTOCOL_JETIEXBUS = (1 << 4),
+    TELEMETRY_PROTOCOL_MAVLINK   = (1 << 5),
+    TELEMETRY_PROTOCOL_CRSF      = (1 << 6),
+    TELEMETRY_PROTOCOL_SRXL      = (1 << 7),
+    TELEMETRY_PROTOCOL_IBUS      = (1 << 8)
+} telemetryProtocol_e;
+
+// Protocols that have a serial port or receiver to talk to, serial port configuration only changes with a reboot
+static uint16_t telemetryConfiguredProtocols;
+
+#define TELEMETRY_PROTOCOL_CONFIGURED(protocol) (telemetryConfiguredProtocols & (protocol))
+
+static void telemetrySetProtocolConfigured(telemetryProtocol_e protocol, bool configured)
+{
+    if (configured) {
+        telemetryConfiguredProtocols |= protocol;
+    }
+}
+
 void telemetryUseConfig(telemetryConfig_t *telemetryConfigToUse)
 {
     telemetryConfig = telemetryConfigToUse;
@@ -59,32 +83,43 @@ void telemetryUseConfig(telemetryConfig_t *telemetryConfigToUse)
 
 void telemetryInit(void)
 {
+    telemetryConfiguredProtocols = 0;
+
 #ifdef TELEMETRY_FRSKY
     initFrSkyTelemetry(telemetryConfig);
+    telemetrySetProtocolConfigured(TELEMETRY_PROTOCOL_FRSKY, findSerialPortConfig(FUNCTION_TELEMETRY_FRSKY) != NULL);
 #endif
 #ifdef TELEMETRY_HOTT
     initHoTTTelemetry(telemetryConfig);
+    telemetrySetProtocolConfigured(TELEMETRY_PROTOCOL_HOTT, findSerialPortConfig(FUNCTION_TELEMETRY_HOTT) != NULL);
 #endif
 #ifdef TELEMETRY_SMARTPORT
     initSmartPortTelemetry(telemetryConfig);
+    telemetrySetProtocolConfigured(TELEMETRY_PROTOCOL_SMARTPORT, findSerialPortConfig(FUNCTION_TELEMETRY_SMARTPORT) != NULL);
 #endif
 #ifdef TELEMETRY_LTM
     initLtmTelemetry(telemetryConfig);
+    telemetrySetProtocolConfigured(TELEMETRY_PROTOCOL_LTM, findSerialPortConfig(FUNCTION_TELEMETRY_LTM) != NULL);
 #endif
 #ifdef TELEMETRY_JETIEXBUS
     initJetiExBusTelemetry(telemetryConfig);
+    telemetrySetProtocolConfigured(TELEMETRY_PROTOCOL_JETIEXBUS, true);
 #endif
 #ifdef TELEMETRY_MAVLINK
     initMAVLinkTelemetry();
+    telemetrySetProtocolConfigured(TELEMETRY_PROTOCOL_MAVLINK, findSerialPortConfig(FUNCTION_TELEMETRY_MAVLINK) != NULL);
 #endif
 #ifdef TELEMETRY_CRSF
     initCrsfTelemetry();
+    telemetrySetProtocolConfigured(TELEMETRY_PROTOCOL_CRSF, checkCrsfTelemetryState());
 #endif
 #ifdef TELEMETRY_SRXL
     initSrxlTelemetry();
+    telemetrySetProtocolConfigured(TELEMETRY_PROTOCOL_SRXL, checkSrxlTelemetryState());
 #endif
 #ifdef TELEMETRY_IBUS
     initIbusTelemetry();
+    telemetrySetProtocolConfigured(TELEMETRY_PROTOCOL_IBUS, findSerialPortConfig(FUNCTION_TELEMETRY_IBUS) != NULL);
 #endif
 
     telemetryCheckState();
@@ -114,67 +149,102 @@ serialPort_t *telemetrySharedPort = NULL;
 void telemetryCheckState(void)
 {
 #ifdef TELEMETRY_FRSKY
-    checkFrSkyTelemetryState();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_FRSKY)) {
+        checkFrSkyTelemetryState();
+    }
 #endif
 #ifdef TELEMETRY_HOTT
-    checkHoTTTelemetryState();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_HOTT)) {
+        checkHoTTTelemetryState();
+    }
 #endif
 #ifdef TELEMETRY_SMARTPORT
-    checkSmartPortTelemetryState();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_SMARTPORT)) {
+        checkSmartPortTelemetryState();
+    }
 #endif
 #ifdef TELEMETRY_LTM
-    checkLtmTelemetryState();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_LTM)) {
+        checkLtmTelemetryState();
+    }
 #endif
 #ifdef TELEMETRY_JETIEXBUS
-    checkJetiExBusTelemetryState();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_JETIEXBUS)) {
+        checkJetiExBusTelemetryState();
+    }
 #endif
 #ifdef TELEMETRY_MAVLINK
-    checkMAVLinkTelemetryState();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_MAVLINK)) {
+        checkMAVLinkTelemetryState();
+    }
 #endif
 #ifdef TELEMETRY_CRSF
-    checkCrsfTelemetryState();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_CRSF)) {
+        checkCrsfTelemetryState();
+    }
 #endif
 #ifdef TELEMETRY_SRXL
-    checkSrxlTelemetryState();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_SRXL)) {
+        checkSrxlTelemetryState();
+    }
 #endif
 #ifdef TELEMETRY_IBUS
-    checkIbusTelemetryState();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_IBUS)) {
+        checkIbusTelemetryState();
+    }
 #endif
 }
 
 void telemetryProcess(uint32_t currentTime, rxConfig_t *rxConfig, uint16_t deadband3d_throttle)
 {
-#ifdef TELEMETRY_FRSKY
-    handleFrSkyTelemetry(rxConfig, deadband3d_throttle);
-#else
     UNUSED(rxConfig);
     UNUSED(deadband3d_throttle);
+    UNUSED(currentTime);
+
+#ifdef TELEMETRY_FRSKY
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_FRSKY)) {
+        handleFrSkyTelemetry(rxConfig, deadband3d_throttle);
+    }
 #endif
 #ifdef TELEMETRY_HOTT
-    handleHoTTTelemetry(currentTime);
-#else
-    UNUSED(currentTime);
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_HOTT)) {
+        handleHoTTTelemetry(currentTime);
+    }
 #endif
 #ifdef TELEMETRY_SMARTPORT
-    handleSmartPortTelemetry();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_SMARTPORT)) {
+        handleSmartPortTelemetry();
+    }
 #endif
 #ifdef TELEMETRY_LTM
-    handleLtmTelemetry();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_LTM)) {
+        handleLtmTelemetry(currentTime);
+    }
 #endif
 #ifdef TELEMETRY_JETIEXBUS
-    handleJetiExBusTelemetry();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_JETIEXBUS)) {
+        handleJetiExBusTelemetry();
+    }
 #endif
 #ifdef TELEMETRY_MAVLINK
-    handleMAVLinkTelemetry();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_MAVLINK)) {
+        handleMAVLinkTelemetry(currentTime);
+    }
 #endif
 #ifdef TELEMETRY_CRSF
-    handleCrsfTelemetry(currentTime);
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_CRSF)) {
+        handleCrsfTelemetry(currentTime);
+    }
 #endif
 #ifdef TELEMETRY_SRXL
-    handleSrxlTelemetry(currentTime);
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_SRXL)) {
+        handleSrxlTelemetry(currentTime);
+    }
 #endif
 #ifdef TELEMETRY_IBUS
-    handleIbusTelemetry();
+    if (TELEMETRY_PROTOCOL_CONFIGURED(TELEMETRY_PROTOCOL_IBUS)) {
+        handleIbusTelemetry();
+    }
 #endif
 }
 
@@ -47,6 +47,7 @@ typedef struct telemetryConfig_s {
     uint8_t hottAlarmSoundInterval;
     uint8_t pidValuesAsTelemetry;
     uint8_t report_cell_voltage;
+    uint16_t mavlink_highrate_hz;           // attitude, IMU and servo stream for a companion computer, 0 disables it
 } telemetryConfig_t;
 
 void telemetryInit(void);
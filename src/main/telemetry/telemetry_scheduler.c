@@ -0,0 +1,169 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+#include "common/time.h"
+
+#include "telemetry/telemetry_scheduler.h"
+
+/*
+ * Bandwidth budgeted frame scheduler for telemetry protocols that push frames on their own timing.
+ *
+ * Each protocol declares its frame types with their size on the wire and target rate. When the sum
+ * of size * rate does not fit into the byte rate of the link all target periods are stretched by the
+ * same factor, so every frame type keeps its share instead of the first ones in the list taking it
+ * all. Frames are then picked earliest deadline first and only while the bytes already written can
+ * leave the UART within TELEMETRY_SCHEDULER_MAX_BACKLOG_US.
+ */
+
+// serial bits per byte, 8N1
+#define TELEMETRY_SCHEDULER_BITS_PER_BYTE   10
+// lets a few frames queue back to back between two telemetry task runs without filling the TX buffer
+#define TELEMETRY_SCHEDULER_MAX_BACKLOG_US  10000
+
+static const telemetryScheduler_t *telemetrySchedulers[TELEMETRY_SCHEDULER_COUNT];
+
+static void telemetrySchedulerRegister(const telemetryScheduler_t *scheduler)
+{
+    for (int i = 0; i < TELEMETRY_SCHEDULER_COUNT; i++) {
+        if (telemetrySchedulers[i] == scheduler) {
+            return;
+        }
+    }
+    for (int i = 0; i < TELEMETRY_SCHEDULER_COUNT; i++) {
+        if (!telemetrySchedulers[i]) {
+            telemetrySchedulers[i] = scheduler;
+            return;
+        }
+    }
+}
+
+const telemetryScheduler_t *telemetrySchedulerGet(int index)
+{
+    if (index < 0 || index >= TELEMETRY_SCHEDULER_COUNT) {
+        return NULL;
+    }
+    return telemetrySchedulers[index];
+}
+
+void telemetrySchedulerReset(void)
+{
+    memset(telemetrySchedulers, 0, sizeof(telemetrySchedulers));
+}
+
+void telemetrySchedulerInit(telemetryScheduler_t *scheduler, uint16_t function, const telemetryFrame_t *frames, uint8_t frameCount, uint32_t baudRate, uint8_t txSharePercent, timeUs_t currentTimeUs)
+{
+    memset(scheduler, 0, sizeof(*scheduler));
+
+    scheduler->frames = frames;
+    scheduler->frameCount = MIN(frameCount, TELEMETRY_SCHEDULER_MAX_FRAMES);
+    scheduler->function = function;
+
+    scheduler->bytesPerSecond = MAX(baudRate / TELEMETRY_SCHEDULER_BITS_PER_BYTE * txSharePercent / 100, 1);
+    scheduler->usPerByte = (1000000 + scheduler->bytesPerSecond - 1) / scheduler->bytesPerSecond;
+
+    uint32_t demand = 0;
+    for (int i = 0; i < scheduler->frameCount; i++) {
+        demand += frames[i].size * frames[i].rateHz;
+    }
+
+    scheduler->rateScale = 1000;
+    if (demand > scheduler->bytesPerSecond) {
+        scheduler->rateScale = MAX(scheduler->bytesPerSecond * 1000 / demand, 1);
+    }
+
+    for (int i = 0; i < scheduler->frameCount; i++) {
+        telemetryFrameState_t *state = &scheduler->state[i];
+
+        state->periodUs = (1000000 / MAX(frames[i].rateHz, 1)) * 1000 / scheduler->rateScale;
+        state->nextDueUs = currentTimeUs;
+    }
+
+    scheduler->linkFreeUs = currentTimeUs;
+    scheduler->windowStartUs = currentTimeUs;
+
+    telemetrySchedulerRegister(scheduler);
+}
+
+static void telemetrySchedulerUpdateRates(telemetryScheduler_t *scheduler, timeUs_t currentTimeUs)
+{
+    const timeDelta_t windowUs = cmpTimeUs(currentTimeUs, scheduler->windowStartUs);
+    if (windowUs < TELEMETRY_SCHEDULER_RATE_WINDOW_US) {
+        return;
+    }
+
+    for (int i = 0; i < scheduler->frameCount; i++) {
+        telemetryFrameState_t *state = &scheduler->state[i];
+
+        state->achievedRate = (uint32_t)state->sentCount * 100000 / (windowUs / 1000);
+        state->sentCount = 0;
+    }
+    scheduler->windowStartUs = currentTimeUs;
+}
+
+// Returns the index of the frame to send now or -1, the caller reports frames it actually wrote with telemetrySchedulerFrameSent()
+int telemetrySchedulerNext(telemetryScheduler_t *scheduler, timeUs_t currentTimeUs)
+{
+    telemetrySchedulerUpdateRates(scheduler, currentTimeUs);
+
+    if (cmpTimeUs(scheduler->linkFreeUs, currentTimeUs) > TELEMETRY_SCHEDULER_MAX_BACKLOG_US) {
+        return -1;
+    }
+
+    int selected = -1;
+    for (int i = 0; i < scheduler->frameCount; i++) {
+        const timeUs_t nextDueUs = scheduler->state[i].nextDueUs;
+
+        if (cmpTimeUs(currentTimeUs, nextDueUs) < 0) {
+            continue;
+        }
+        if (selected < 0 || cmpTimeUs(nextDueUs, scheduler->state[selected].nextDueUs) < 0) {
+            selected = i;
+        }
+    }
+
+    if (selected >= 0) {
+        telemetryFrameState_t *state = &scheduler->state[selected];
+
+        state->nextDueUs += state->periodUs;
+        // a frame that fell more than a period behind skips the missed slots instead of bursting
+        if (cmpTimeUs(currentTimeUs, state->nextDueUs) > (timeDelta_t)state->periodUs) {
+            state->nextDueUs = currentTimeUs + state->periodUs;
+        }
+    }
+
+    return selected;
+}
+
+void telemetrySchedulerFrameSent(telemetryScheduler_t *scheduler, int frameIndex, timeUs_t currentTimeUs)
+{
+    if (frameIndex < 0 || frameIndex >= scheduler->frameCount) {
+        return;
+    }
+
+    if (cmpTimeUs(scheduler->linkFreeUs, currentTimeUs) < 0) {
+        scheduler->linkFreeUs = currentTimeUs;
+    }
+    scheduler->linkFreeUs += scheduler->frames[frameIndex].size * scheduler->usPerByte;
+    scheduler->state[frameIndex].sentCount++;
+}
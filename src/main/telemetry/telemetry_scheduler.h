@@ -0,0 +1,57 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/time.h"
+
+#define TELEMETRY_SCHEDULER_MAX_FRAMES      8
+#define TELEMETRY_SCHEDULER_COUNT           2       // schedulers reported over MSP
+#define TELEMETRY_SCHEDULER_RATE_WINDOW_US  5000000 // longer than the stretched period of a 1Hz frame at 2400 baud
+
+// Frame type as declared by a protocol, the id is the protocol's own message or frame identifier
+typedef struct telemetryFrame_s {
+    uint8_t id;
+    uint8_t size;                   // bytes on the wire including framing and checksum
+    uint16_t rateHz;                // target rate
+} telemetryFrame_t;
+
+typedef struct telemetryFrameState_s {
+    timeUs_t nextDueUs;
+    uint32_t periodUs;              // target period, stretched when the link cannot carry all target rates
+    uint16_t sentCount;             // frames sent in the current rate window
+    uint16_t achievedRate;          // Hz * 100 over the last rate window
+} telemetryFrameState_t;
+
+typedef struct telemetryScheduler_s {
+    const telemetryFrame_t *frames;
+    uint8_t frameCount;
+    uint16_t function;              // serialPortFunction_e of the protocol, identifies it over MSP
+    uint32_t usPerByte;             // time one byte occupies our share of the link
+    uint32_t bytesPerSecond;
+    uint16_t rateScale;             // per mille of the target rates that fit into the link
+    timeUs_t linkFreeUs;            // when the frames already written have left the UART
+    timeUs_t windowStartUs;
+    telemetryFrameState_t state[TELEMETRY_SCHEDULER_MAX_FRAMES];
+} telemetryScheduler_t;
+
+void telemetrySchedulerInit(telemetryScheduler_t *scheduler, uint16_t function, const telemetryFrame_t *frames, uint8_t frameCount, uint32_t baudRate, uint8_t txSharePercent, timeUs_t currentTimeUs);
+int telemetrySchedulerNext(telemetryScheduler_t *scheduler, timeUs_t currentTimeUs);
+void telemetrySchedulerFrameSent(telemetryScheduler_t *scheduler, int frameIndex, timeUs_t currentTimeUs);
+
+const telemetryScheduler_t *telemetrySchedulerGet(int index);
+void telemetrySchedulerReset(void);
@@ -0,0 +1,180 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/adc.h"
+    #include "drivers/adc_impl.h"
+
+    const adcTagMap_t adcTagMap[ADC_TAG_MAP_COUNT] = { };
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define SCAN_LENGTH 2
+#define BUFFER_LENGTH (SCAN_LENGTH * ADC_SCAN_BUFFER_DEPTH)
+
+static uint32_t fakeMicros;
+static volatile uint32_t dmaRemaining;
+static uint16_t dmaWritten;     // conversions the fake DMA has made since the test started
+
+// battery is converted first in every scan, then the servo feedback on RSSI
+static void setupScanBuffer(void)
+{
+    memset(adcOperatingConfig, 0, sizeof(adcOperatingConfig));
+    memset((void *)adcValues, 0, sizeof(adcValues));
+
+    adcOperatingConfig[ADC_BATTERY].enabled = true;
+    adcOperatingConfig[ADC_BATTERY].dmaIndex = 0;
+    adcOperatingConfig[ADC_RSSI].enabled = true;
+    adcOperatingConfig[ADC_RSSI].dmaIndex = 1;
+
+    fakeMicros = 5000;
+    dmaRemaining = BUFFER_LENGTH;
+    dmaWritten = 0;
+    adcScanBufferInit(SCAN_LENGTH, &dmaRemaining);
+}
+
+// Runs the fake DMA for the given number of scans, the feedback reads from the given function of the scan number
+static void convertScans(int scans, uint16_t battery, uint16_t (*feedback)(int scan))
+{
+    for (int i = 0; i < scans; i++) {
+        const int scan = dmaWritten / SCAN_LENGTH;
+        const uint16_t position = dmaWritten % BUFFER_LENGTH;
+        adcValues[position] = battery;
+        adcValues[position + 1] = feedback(scan);
+        dmaWritten += SCAN_LENGTH;
+        dmaRemaining = BUFFER_LENGTH - (dmaWritten % BUFFER_LENGTH);
+    }
+}
+
+static uint16_t steadyFeedback(int scan)
+{
+    UNUSED(scan);
+    return 2000;
+}
+
+static uint16_t noisyFeedback(int scan)
+{
+    return (scan & 1) ? 2010 : 1990;
+}
+
+static uint16_t rampFeedback(int scan)
+{
+    return 1000 + scan;
+}
+
+TEST(AdcTest, LatestConversionFollowsDma)
+{
+    setupScanBuffer();
+
+    convertScans(3, 1500, rampFeedback);
+    EXPECT_EQ(1500, adcGetChannel(ADC_BATTERY));
+    EXPECT_EQ(1002, adcGetChannel(ADC_RSSI));
+
+    // battery of the next scan converted, the feedback not yet
+    adcValues[6] = 1600;
+    dmaRemaining = BUFFER_LENGTH - 7;
+    EXPECT_EQ(1600, adcGetChannel(ADC_BATTERY));
+    EXPECT_EQ(1002, adcGetChannel(ADC_RSSI));
+}
+
+TEST(AdcTest, OversampledAverageCoversScansSinceLastRead)
+{
+    setupScanBuffer();
+    adcOversample_t result;
+
+    convertScans(4, 1500, rampFeedback);
+    EXPECT_TRUE(adcGetOversampledChannel(ADC_RSSI, &result));
+    EXPECT_EQ(4, result.count);
+    EXPECT_FLOAT_EQ(1001.5f, result.average);
+    EXPECT_EQ(fakeMicros, result.readTimeUs);
+
+    // nothing converted since the previous read
+    EXPECT_FALSE(adcGetOversampledChannel(ADC_RSSI, &result));
+
+    convertScans(3, 1500, rampFeedback);
+    fakeMicros += 125;
+    EXPECT_TRUE(adcGetOversampledChannel(ADC_RSSI, &result));
+    EXPECT_EQ(3, result.count);
+    EXPECT_FLOAT_EQ(1005.0f, result.average);
+    EXPECT_EQ(5125, result.readTimeUs);
+
+    // channels are read independently
+    EXPECT_TRUE(adcGetOversampledChannel(ADC_BATTERY, &result));
+    EXPECT_EQ(7, result.count);
+    EXPECT_FLOAT_EQ(1500.0f, result.average);
+    EXPECT_FLOAT_EQ(0.0f, result.noise);
+
+    EXPECT_FALSE(adcGetOversampledChannel(ADC_CURRENT, &result));
+}
+
+TEST(AdcTest, OversampledAverageAcrossBufferWrap)
+{
+    setupScanBuffer();
+    adcOversample_t result;
+
+    convertScans(ADC_SCAN_BUFFER_DEPTH - 2, 1500, rampFeedback);
+    adcGetOversampledChannel(ADC_RSSI, &result);
+
+    convertScans(5, 1500, rampFeedback);
+    EXPECT_TRUE(adcGetOversampledChannel(ADC_RSSI, &result));
+    EXPECT_EQ(5, result.count);
+    EXPECT_FLOAT_EQ(1000.0f + ADC_SCAN_BUFFER_DEPTH, result.average);
+}
+
+TEST(AdcTest, OversampledReadLimitedToBuffer)
+{
+    setupScanBuffer();
+    adcOversample_t result;
+
+    convertScans(2, 1500, steadyFeedback);
+    adcGetOversampledChannel(ADC_RSSI, &result);
+
+    // the DMA is about to overwrite the oldest scan, which is left out
+    convertScans(ADC_SCAN_BUFFER_DEPTH - 1, 1500, steadyFeedback);
+    EXPECT_TRUE(adcGetOversampledChannel(ADC_RSSI, &result));
+    EXPECT_EQ(ADC_SCAN_BUFFER_DEPTH - 1, result.count);
+    EXPECT_FLOAT_EQ(2000.0f, result.average);
+}
+
+TEST(AdcTest, NoiseMeasured)
+{
+    setupScanBuffer();
+    adcOversample_t result;
+
+    convertScans(8, 1500, noisyFeedback);
+    EXPECT_TRUE(adcGetOversampledChannel(ADC_RSSI, &result));
+    EXPECT_EQ(8, result.count);
+    EXPECT_FLOAT_EQ(2000.0f, result.average);
+    EXPECT_NEAR(10.0f, result.noise, 0.01f);
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t micros(void)
+{
+    return fakeMicros;
+}
+
+}
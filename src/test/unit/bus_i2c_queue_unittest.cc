@@ -0,0 +1,214 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/bus_i2c.h"
+    #include "drivers/bus_i2c_impl.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static uint32_t fakeMicros;
+static i2cJob_t *startedJob;
+static int callbackCount;
+static i2cJob_t *lastCallbackJob;
+
+static void countCallback(i2cJob_t *job)
+{
+    callbackCount++;
+    lastCallbackJob = job;
+}
+
+static i2cJob_t newJob(i2cJobCallbackPtr callback)
+{
+    i2cJob_t job;
+    memset(&job, 0, sizeof(job));
+    job.state = I2C_JOB_IDLE;
+    job.callback = callback;
+    return job;
+}
+
+static void resetQueue(void)
+{
+    i2cQueueAbort(I2CDEV_1);
+    fakeMicros = 1000;
+    startedJob = NULL;
+    callbackCount = 0;
+    lastCallbackJob = NULL;
+}
+
+// plays the part of the bus interrupt handler finishing the job on the bus
+static void completeActiveJob(bool success)
+{
+    startedJob = i2cQueueFinish(I2CDEV_1, success);
+}
+
+TEST(BusI2cQueueTest, JobsRunInSubmissionOrder)
+{
+    resetQueue();
+
+    uint8_t baroData[6];
+    uint8_t magData[6];
+    i2cJob_t baroJob = newJob(countCallback);
+    i2cJob_t magJob = newJob(countCallback);
+
+    EXPECT_TRUE(i2cReadAsync(I2CDEV_1, &baroJob, 0x76, 0xF7, sizeof(baroData), baroData));
+    EXPECT_EQ(&baroJob, startedJob);
+    EXPECT_EQ(I2C_JOB_ACTIVE, baroJob.state);
+
+    EXPECT_TRUE(i2cReadAsync(I2CDEV_1, &magJob, 0x1E, 0x03, sizeof(magData), magData));
+    EXPECT_EQ(&baroJob, startedJob);
+    EXPECT_EQ(I2C_JOB_QUEUED, magJob.state);
+    EXPECT_TRUE(i2cJobBusy(&magJob));
+
+    completeActiveJob(true);
+    EXPECT_EQ(I2C_JOB_DONE, baroJob.state);
+    EXPECT_EQ(1, callbackCount);
+    EXPECT_EQ(&baroJob, lastCallbackJob);
+    EXPECT_EQ(&magJob, startedJob);
+    EXPECT_EQ(I2C_JOB_ACTIVE, magJob.state);
+
+    completeActiveJob(true);
+    EXPECT_EQ(I2C_JOB_DONE, magJob.state);
+    EXPECT_EQ(2, callbackCount);
+    EXPECT_EQ(NULL, startedJob);
+    EXPECT_EQ(NULL, i2cQueueHead(I2CDEV_1));
+}
+
+TEST(BusI2cQueueTest, BusyJobRejected)
+{
+    resetQueue();
+
+    uint8_t data = 0x01;
+    i2cJob_t job = newJob(NULL);
+
+    EXPECT_TRUE(i2cWriteAsync(I2CDEV_1, &job, 0x77, 0x48, 1, &data));
+    EXPECT_FALSE(i2cWriteAsync(I2CDEV_1, &job, 0x77, 0x48, 1, &data));
+    EXPECT_FALSE(i2cWriteAsync(I2CINVALID, &job, 0x77, 0x48, 1, &data));
+
+    completeActiveJob(false);
+    EXPECT_EQ(I2C_JOB_FAILED, job.state);
+    EXPECT_FALSE(i2cJobBusy(&job));
+
+    // a finished job can be submitted again
+    EXPECT_TRUE(i2cWriteAsync(I2CDEV_1, &job, 0x77, 0x48, 1, &data));
+    completeActiveJob(true);
+    EXPECT_EQ(I2C_JOB_DONE, job.state);
+}
+
+TEST(BusI2cQueueTest, StalledBusAbortsQueuedJobs)
+{
+    resetQueue();
+
+    uint8_t data[2];
+    i2cJob_t first = newJob(countCallback);
+    i2cJob_t second = newJob(countCallback);
+
+    i2cReadAsync(I2CDEV_1, &first, 0x68, 0x3B, sizeof(data), data);
+    i2cReadAsync(I2CDEV_1, &second, 0x68, 0x43, sizeof(data), data);
+
+    fakeMicros += I2C_JOB_TIMEOUT_US;
+    EXPECT_FALSE(i2cQueueStalled(I2CDEV_1));
+    fakeMicros += 1;
+    EXPECT_TRUE(i2cQueueStalled(I2CDEV_1));
+
+    i2cQueueAbort(I2CDEV_1);
+    EXPECT_EQ(I2C_JOB_FAILED, first.state);
+    EXPECT_EQ(I2C_JOB_FAILED, second.state);
+    EXPECT_EQ(2, callbackCount);
+    EXPECT_FALSE(i2cQueueStalled(I2CDEV_1));
+    EXPECT_EQ(NULL, i2cQueueHead(I2CDEV_1));
+}
+
+TEST(BusI2cQueueTest, FailureInInterruptLeavesResetToTask)
+{
+    resetQueue();
+
+    uint8_t data[2];
+    i2cJob_t first = newJob(countCallback);
+    i2cJob_t second = newJob(countCallback);
+
+    i2cReadAsync(I2CDEV_1, &first, 0x68, 0x3B, sizeof(data), data);
+    i2cReadAsync(I2CDEV_1, &second, 0x68, 0x43, sizeof(data), data);
+    EXPECT_FALSE(i2cQueueResetPending(I2CDEV_1));
+
+    // the handler gives up, the jobs fail at once
+    i2cQueueFail(I2CDEV_1);
+    EXPECT_EQ(I2C_JOB_FAILED, first.state);
+    EXPECT_EQ(I2C_JOB_FAILED, second.state);
+    EXPECT_EQ(2, callbackCount);
+    EXPECT_EQ(NULL, i2cQueueHead(I2CDEV_1));
+    EXPECT_TRUE(i2cQueueResetPending(I2CDEV_1));
+    EXPECT_FALSE(i2cQueueResetPending(I2CDEV_2));
+
+    // until the driver has reset the bus from task context
+    i2cQueueAbort(I2CDEV_1);
+    EXPECT_FALSE(i2cQueueResetPending(I2CDEV_1));
+}
+
+TEST(BusI2cQueueTest, BusStatsAccounted)
+{
+    resetQueue();
+
+    const i2cBusStats_t *stats = i2cGetBusStats(I2CDEV_1);
+    const uint32_t transactions = stats->transactionCount;
+    const uint32_t busyTimeUs = stats->busyTimeUs;
+
+    uint8_t data[3];
+    i2cJob_t job = newJob(NULL);
+
+    i2cReadAsync(I2CDEV_1, &job, 0x77, 0x00, sizeof(data), data);
+    fakeMicros += 150;
+    i2cQueueCountError(I2CDEV_1);
+    completeActiveJob(false);
+
+    i2cReadAsync(I2CDEV_1, &job, 0x77, 0x00, sizeof(data), data);
+    fakeMicros += 90;
+    completeActiveJob(true);
+
+    EXPECT_EQ(transactions + 2, stats->transactionCount);
+    EXPECT_EQ(busyTimeUs + 240, stats->busyTimeUs);
+    EXPECT_EQ(1, stats->errorCount);
+
+    EXPECT_EQ(0, i2cGetBusStats(I2CDEV_2)->transactionCount);
+    EXPECT_EQ(NULL, i2cGetBusStats(I2CINVALID));
+}
+
+// STUBS
+
+extern "C" {
+
+bool i2cSubmit(I2CDevice device, i2cJob_t *job)
+{
+    if (i2cQueueAppend(device, job)) {
+        startedJob = job;
+    }
+    return true;
+}
+
+uint32_t micros(void)
+{
+    return fakeMicros;
+}
+
+}
@@ -0,0 +1,226 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/bus_spi.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static SPI_TypeDef testSpi1;
+static SPI_TypeDef testSpi2;
+
+static uint16_t appliedDivisor[2];
+static bool csLow[2];
+static uint32_t fakeMicros;
+static uint32_t fakeMicrosStep;     // the clock moves on by this much every time it is read
+
+static int gyroCs = 0;
+static int osdCs = 1;
+
+static spiBusDevice_t gyroDevice;
+static spiBusDevice_t osdDevice;
+static int osdAbortCount;
+static bool osdCsLowOnAbort;
+
+static void osdAbort(void)
+{
+    osdAbortCount++;
+    osdCsLowOnAbort = csLow[osdCs];
+}
+
+static void resetBus(void)
+{
+    appliedDivisor[0] = appliedDivisor[1] = 0;
+    csLow[0] = csLow[1] = false;
+    fakeMicros = 1000;
+    fakeMicrosStep = 0;
+    osdAbortCount = 0;
+    osdCsLowOnAbort = false;
+    spiBusResetStats(SPIDEV_1);
+
+    spiBusDeviceInit(&gyroDevice, &testSpi1, &gyroCs, SPI_CLOCK_FAST);
+    spiBusDeviceInit(&osdDevice, &testSpi1, &osdCs, SPI_CLOCK_STANDARD);
+}
+
+TEST(BusSpiSharedTest, DeviceCountedOnce)
+{
+    resetBus();
+    resetBus();
+
+    EXPECT_EQ(2, spiBusDeviceCount(&testSpi1));
+    EXPECT_EQ(0, spiBusDeviceCount(&testSpi2));
+}
+
+TEST(BusSpiSharedTest, EachDeviceUsesItsOwnDivisor)
+{
+    resetBus();
+
+    spiBusTransactionBegin(&osdDevice);
+    EXPECT_EQ(SPI_CLOCK_STANDARD, appliedDivisor[SPIDEV_1]);
+    EXPECT_TRUE(csLow[osdCs]);
+    spiBusTransactionEnd(&osdDevice);
+    EXPECT_FALSE(csLow[osdCs]);
+
+    spiBusTransactionBegin(&gyroDevice);
+    EXPECT_EQ(SPI_CLOCK_FAST, appliedDivisor[SPIDEV_1]);
+    spiBusTransactionEnd(&gyroDevice);
+
+    // a divisor change applies from the next transaction
+    spiBusSetDivisor(&gyroDevice, SPI_CLOCK_INITIALIZATON);
+    EXPECT_EQ(SPI_CLOCK_FAST, appliedDivisor[SPIDEV_1]);
+    spiBusTransactionBegin(&gyroDevice);
+    EXPECT_EQ(SPI_CLOCK_INITIALIZATON, appliedDivisor[SPIDEV_1]);
+    spiBusTransactionEnd(&gyroDevice);
+}
+
+TEST(BusSpiSharedTest, TryBeginRejectedWhileBusHeld)
+{
+    resetBus();
+
+    // OSD starts a DMA transfer, the bus stays held until its completion interrupt
+    spiBusTransactionBegin(&osdDevice);
+    EXPECT_TRUE(spiBusIsLocked(&testSpi1));
+
+    EXPECT_FALSE(spiBusTransactionTryBegin(&gyroDevice));
+    EXPECT_FALSE(csLow[gyroCs]);
+    EXPECT_EQ(SPI_CLOCK_STANDARD, appliedDivisor[SPIDEV_1]);
+    EXPECT_EQ(1, spiBusGetStats(SPIDEV_1)->rejectCount);
+
+    spiBusTransactionEnd(&osdDevice);
+    EXPECT_FALSE(spiBusIsLocked(&testSpi1));
+
+    EXPECT_TRUE(spiBusTransactionTryBegin(&gyroDevice));
+    EXPECT_TRUE(csLow[gyroCs]);
+    spiBusTransactionEnd(&gyroDevice);
+}
+
+TEST(BusSpiSharedTest, BusyTimeAccounted)
+{
+    resetBus();
+
+    spiBusTransactionBegin(&osdDevice);
+    fakeMicros += 120;
+    spiBusTransactionEnd(&osdDevice);
+
+    spiBusTransactionBegin(&gyroDevice);
+    fakeMicros += 15;
+    spiBusTransactionEnd(&gyroDevice);
+
+    const spiBusStats_t *stats = spiBusGetStats(SPIDEV_1);
+    EXPECT_EQ(2, stats->transactionCount);
+    EXPECT_EQ(135, stats->busyTimeUs);
+    EXPECT_EQ(0, stats->waitTimeUs);
+
+    EXPECT_EQ(0, spiBusGetStats(SPIDEV_2)->transactionCount);
+    EXPECT_EQ(NULL, spiBusGetStats(SPIINVALID));
+}
+
+TEST(BusSpiSharedTest, LostDmaCompletionTimesOut)
+{
+    resetBus();
+    spiBusSetAbort(&osdDevice, osdAbort);
+
+    // the OSD DMA completion interrupt never comes
+    spiBusTransactionBegin(&osdDevice);
+    fakeMicrosStep = 10;
+
+    // the OSD transfer is stopped while it still has the chip selected, then the bus changes hands
+    EXPECT_TRUE(spiBusTransactionBegin(&gyroDevice));
+    EXPECT_EQ(1, osdAbortCount);
+    EXPECT_TRUE(osdCsLowOnAbort);
+    EXPECT_TRUE(csLow[gyroCs]);
+    EXPECT_FALSE(csLow[osdCs]);
+    EXPECT_EQ(SPI_CLOCK_FAST, appliedDivisor[SPIDEV_1]);
+
+    const spiBusStats_t *stats = spiBusGetStats(SPIDEV_1);
+    EXPECT_EQ(1, stats->timeoutCount);
+    EXPECT_GE(stats->maxWaitUs, (uint32_t)SPI_BUS_LOCK_TIMEOUT_US);
+    EXPECT_LT(stats->maxWaitUs, (uint32_t)SPI_BUS_LOCK_TIMEOUT_US + 3 * 10);
+
+    // a late completion for the OSD leaves the gyro transaction alone
+    spiBusTransactionEnd(&osdDevice);
+    EXPECT_TRUE(spiBusIsLocked(&testSpi1));
+    EXPECT_TRUE(csLow[gyroCs]);
+
+    spiBusTransactionEnd(&gyroDevice);
+    EXPECT_FALSE(spiBusIsLocked(&testSpi1));
+    EXPECT_EQ(1, stats->transactionCount);
+}
+
+TEST(BusSpiSharedTest, LostDmaCompletionWithoutAbortFails)
+{
+    resetBus();
+
+    spiBusTransactionBegin(&osdDevice);
+    fakeMicrosStep = 10;
+
+    // nothing can stop the OSD transfer, so it keeps the bus
+    EXPECT_FALSE(spiBusTransactionBegin(&gyroDevice));
+    EXPECT_FALSE(csLow[gyroCs]);
+    EXPECT_TRUE(csLow[osdCs]);
+    EXPECT_EQ(SPI_CLOCK_STANDARD, appliedDivisor[SPIDEV_1]);
+    EXPECT_EQ(1, spiBusGetStats(SPIDEV_1)->timeoutCount);
+
+    spiBusTransactionEnd(&osdDevice);
+    EXPECT_FALSE(spiBusIsLocked(&testSpi1));
+    EXPECT_TRUE(spiBusTransactionBegin(&gyroDevice));
+    spiBusTransactionEnd(&gyroDevice);
+}
+
+// STUBS
+
+extern "C" {
+
+SPIDevice spiDeviceByInstance(SPI_TypeDef *instance)
+{
+    if (instance == &testSpi1) {
+        return SPIDEV_1;
+    }
+    if (instance == &testSpi2) {
+        return SPIDEV_2;
+    }
+    return SPIINVALID;
+}
+
+void spiSetDivisor(SPI_TypeDef *instance, uint16_t divisor)
+{
+    appliedDivisor[spiDeviceByInstance(instance)] = divisor;
+}
+
+void IOLo(IO_t io)
+{
+    csLow[*(int *)io] = true;
+}
+
+void IOHi(IO_t io)
+{
+    csLow[*(int *)io] = false;
+}
+
+uint32_t micros(void)
+{
+    fakeMicros += fakeMicrosStep;
+    return fakeMicros;
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Built with USE_FAST_RAM and USE_FAST_CODE, the host linker places the sections and provides their bounds
+extern "C" {
+#include "build/fast_memory.h"
+
+extern uint8_t __start_fastram_bss[], __stop_fastram_bss[];
+extern uint8_t __start_fastram_data[], __stop_fastram_data[];
+extern uint8_t __start_fastcode[], __stop_fastcode[];
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static FAST_RAM_ZERO_INIT float filterState[3];
+static FAST_RAM_ZERO_INIT uint8_t zeroInitByte;
+static FAST_RAM float gain[3] = { 1.5f, 2.5f, 3.5f };
+static FAST_RAM uint8_t dataByte = 42;
+static float ordinaryState[3];
+
+static FAST_CODE int32_t fastSum(int32_t a, int32_t b)
+{
+    return a + b;
+}
+
+static FAST_CODE float *localFilterState(void)
+{
+    static FAST_RAM_ZERO_INIT float localState[2];
+    return localState;
+}
+
+static bool within(const void *address, const uint8_t *start, const uint8_t *stop)
+{
+    const uint8_t *p = (const uint8_t *)address;
+    return p >= start && p < stop;
+}
+
+TEST(FastMemoryTest, ZeroInitInBssSection)
+{
+    EXPECT_TRUE(within(filterState, __start_fastram_bss, __stop_fastram_bss));
+    EXPECT_TRUE(within(&filterState[2], __start_fastram_bss, __stop_fastram_bss));
+    EXPECT_TRUE(within(&zeroInitByte, __start_fastram_bss, __stop_fastram_bss));
+    EXPECT_TRUE(within(localFilterState(), __start_fastram_bss, __stop_fastram_bss));
+
+    EXPECT_FALSE(within(filterState, __start_fastram_data, __stop_fastram_data));
+}
+
+TEST(FastMemoryTest, ZeroInitStartsAtZero)
+{
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(0.0f, filterState[i]);
+    }
+    EXPECT_EQ(0, zeroInitByte);
+    EXPECT_EQ(0.0f, localFilterState()[0]);
+    EXPECT_EQ(0.0f, localFilterState()[1]);
+}
+
+TEST(FastMemoryTest, InitialisedInDataSection)
+{
+    EXPECT_TRUE(within(gain, __start_fastram_data, __stop_fastram_data));
+    EXPECT_TRUE(within(&dataByte, __start_fastram_data, __stop_fastram_data));
+
+    EXPECT_FLOAT_EQ(1.5f, gain[0]);
+    EXPECT_FLOAT_EQ(2.5f, gain[1]);
+    EXPECT_FLOAT_EQ(3.5f, gain[2]);
+    EXPECT_EQ(42, dataByte);
+}
+
+TEST(FastMemoryTest, CodeInCodeSection)
+{
+    EXPECT_TRUE(within((const void *)&fastSum, __start_fastcode, __stop_fastcode));
+    EXPECT_TRUE(within((const void *)&localFilterState, __start_fastcode, __stop_fastcode));
+    EXPECT_EQ(7, fastSum(3, 4));
+}
+
+TEST(FastMemoryTest, OrdinaryDataStaysOut)
+{
+    EXPECT_FALSE(within(ordinaryState, __start_fastram_bss, __stop_fastram_bss));
+    EXPECT_FALSE(within(ordinaryState, __start_fastram_data, __stop_fastram_data));
+    EXPECT_FALSE(within((const void *)&within, __start_fastcode, __stop_fastcode));
+}
+
+TEST(FastMemoryTest, WordAligned)
+{
+    // every variable is word aligned, single bytes too
+    EXPECT_EQ(0u, (uintptr_t)&zeroInitByte % 4);
+    EXPECT_EQ(0u, (uintptr_t)&dataByte % 4);
+    EXPECT_EQ(0u, (uintptr_t)filterState % 4);
+    EXPECT_EQ(0u, (uintptr_t)gain % 4);
+}
@@ -0,0 +1,447 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+extern "C" {
+#include "platform.h"
+
+#include "common/utils.h"
+
+#include "drivers/sensor.h"
+#include "drivers/accgyro.h"
+#include "drivers/accgyro_fake.h"
+#include "drivers/barometer.h"
+#include "drivers/barometer_fake.h"
+#include "drivers/compass.h"
+#include "drivers/compass_fake.h"
+
+#include "fc/fc_boot.h"
+#include "fc/fc_boot_items.h"
+
+#include "scheduler/scheduler.h"
+
+#include "config/config_master.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// STUBS
+
+extern "C" {
+static timeUs_t currentTimeUs;
+
+uint32_t micros(void) { return currentTimeUs; }
+uint32_t millis(void) { return currentTimeUs / 1000; }
+
+master_t masterConfig;
+static int compassDetects;
+static int baroDetects;
+
+bool sensorsAutodetectCompass(const compassConfig_t *) { compassDetects++; return true; }
+bool sensorsAutodetectBaro(const barometerConfig_t *) { baroDetects++; return true; }
+void baroSetCalibrationCycles(uint16_t) {}
+void setTaskEnabled(cfTaskId_e, bool) {}
+uint32_t getBeeperOffMask(void) { return 0; }
+}
+
+// A boot the way init() and TASK_DEFERRED_INIT do it, on the fake sensors
+
+enum {
+    ITEM_COMPASS = 0,
+    ITEM_BARO,
+    ITEM_LOG_DEVICE,
+    ITEM_LOG,
+    ITEM_SLOW,
+    ITEM_COUNT
+};
+
+static gyroDev_t gyroDev;
+static magDev_t magDev;
+static baroDev_t baroDev;
+
+static int callOrder[64];
+static int callCount;
+static int logDevicePolls;
+static bool compassSawGyro;
+static bool baroSawGyro;
+static bootInitResult_e logDeviceResult;
+
+static void called(int item)
+{
+    if (callCount < (int)ARRAYLEN(callOrder)) {
+        callOrder[callCount] = item;
+    }
+    callCount++;
+}
+
+static int firstCall(int item)
+{
+    for (int i = 0; i < callCount && i < (int)ARRAYLEN(callOrder); i++) {
+        if (callOrder[i] == item) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int calls(int item)
+{
+    int count = 0;
+    for (int i = 0; i < callCount && i < (int)ARRAYLEN(callOrder); i++) {
+        count += callOrder[i] == item;
+    }
+    return count;
+}
+
+static bootInitResult_e initCompass(timeUs_t)
+{
+    called(ITEM_COMPASS);
+    compassSawGyro = gyroDev.read != NULL;
+    if (!fakeMagDetect(&magDev) || !magDev.init()) {
+        return BOOT_INIT_FAILED;
+    }
+    return BOOT_INIT_DONE;
+}
+
+static bootInitResult_e initBaro(timeUs_t)
+{
+    called(ITEM_BARO);
+    baroSawGyro = gyroDev.read != NULL;
+    return fakeBaroDetect(&baroDev) ? BOOT_INIT_DONE : BOOT_INIT_FAILED;
+}
+
+// polls its device three times before it is up
+static bootInitResult_e initLogDevice(timeUs_t)
+{
+    called(ITEM_LOG_DEVICE);
+    if (++logDevicePolls < 3) {
+        return BOOT_INIT_PENDING;
+    }
+    return logDeviceResult;
+}
+
+static bootInitResult_e initLog(timeUs_t)
+{
+    called(ITEM_LOG);
+    return BOOT_INIT_DONE;
+}
+
+static bootInitResult_e initSlow(timeUs_t)
+{
+    called(ITEM_SLOW);
+    return BOOT_INIT_PENDING;
+}
+
+static const bootItem_t items[ITEM_COUNT] = {
+    [ITEM_COMPASS]    = { "COMPASS",    initCompass,   0,                          1000, true },
+    [ITEM_BARO]       = { "BARO",       initBaro,      0,                          1000, true },
+    [ITEM_LOG_DEVICE] = { "LOG_DEVICE", initLogDevice, 0,                          1000, false },
+    [ITEM_LOG]        = { "LOG",        initLog,       BOOT_ITEM(ITEM_LOG_DEVICE), 100,  false },
+    [ITEM_SLOW]       = { "SLOW",       initSlow,      0,                          50,   false },
+};
+
+static void resetBoot(void)
+{
+    memset(&gyroDev, 0, sizeof(gyroDev));
+    memset(&magDev, 0, sizeof(magDev));
+    memset(&baroDev, 0, sizeof(baroDev));
+    callCount = 0;
+    logDevicePolls = 0;
+    compassSawGyro = false;
+    baroSawGyro = false;
+    logDeviceResult = BOOT_INIT_DONE;
+    currentTimeUs = 1000;
+    bootPhaseMark(BOOT_PHASE_START);
+    bootDeferredInit(items, ITEM_COUNT);
+}
+
+static void criticalInit(void)
+{
+    currentTimeUs += 500;
+    bootPhaseMark(BOOT_PHASE_CONFIG);
+    currentTimeUs += 500;
+    bootPhaseMark(BOOT_PHASE_OUTPUTS);
+    currentTimeUs += 500;
+    fakeGyroDetect(&gyroDev);
+    gyroDev.init(&gyroDev);
+    bootPhaseMark(BOOT_PHASE_GYRO);
+    currentTimeUs += 500;
+    bootPhaseMark(BOOT_PHASE_RX);
+    currentTimeUs += 500;
+    bootPhaseMark(BOOT_PHASE_READY);
+}
+
+// TASK_DEFERRED_INIT at 100Hz
+static int runDeferred(int runs, bool armed)
+{
+    for (int i = 0; i < runs; i++) {
+        currentTimeUs += 10000;
+        if (bootDeferredUpdate(currentTimeUs, armed)) {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+TEST(BootTest, DeferredWaitForCriticalInit)
+{
+    resetBoot();
+
+    // the scheduler is not running yet
+    EXPECT_FALSE(bootDeferredUpdate(currentTimeUs, false));
+    EXPECT_EQ(0, callCount);
+
+    criticalInit();
+    EXPECT_GT(runDeferred(100, false), 0);
+
+    EXPECT_TRUE(compassSawGyro);
+    EXPECT_TRUE(baroSawGyro);
+    EXPECT_TRUE(magDev.read != NULL);
+    EXPECT_TRUE(baroDev.calculate != NULL);
+}
+
+TEST(BootTest, OneItemPerRun)
+{
+    resetBoot();
+    criticalInit();
+
+    runDeferred(1, false);
+    EXPECT_EQ(1, callCount);
+    runDeferred(1, false);
+    EXPECT_EQ(2, callCount);
+}
+
+TEST(BootTest, DependencyFinishesFirst)
+{
+    resetBoot();
+    criticalInit();
+    runDeferred(100, false);
+
+    ASSERT_GE(firstCall(ITEM_LOG), 0);
+    EXPECT_EQ(3, calls(ITEM_LOG_DEVICE));
+    EXPECT_EQ(1, calls(ITEM_LOG));
+
+    // the last poll of the device came before the log
+    int lastDevicePoll = -1;
+    for (int i = 0; i < callCount; i++) {
+        if (callOrder[i] == ITEM_LOG_DEVICE) {
+            lastDevicePoll = i;
+        }
+    }
+    EXPECT_LT(lastDevicePoll, firstCall(ITEM_LOG));
+    EXPECT_EQ(BOOT_ITEM_DONE, bootDeferredState(ITEM_LOG_DEVICE));
+    EXPECT_LE(bootDeferredTime(ITEM_LOG_DEVICE), bootDeferredTime(ITEM_LOG));
+}
+
+TEST(BootTest, DependencyFailedStillFinishes)
+{
+    resetBoot();
+    logDeviceResult = BOOT_INIT_FAILED;
+    criticalInit();
+    runDeferred(100, false);
+
+    // the log item checks the device itself, it runs whatever the result
+    EXPECT_EQ(BOOT_ITEM_FAILED, bootDeferredState(ITEM_LOG_DEVICE));
+    EXPECT_EQ(BOOT_ITEM_DONE, bootDeferredState(ITEM_LOG));
+}
+
+TEST(BootTest, PendingItemsTakeTurns)
+{
+    resetBoot();
+    criticalInit();
+    // the log waits for its device
+    runDeferred(ITEM_COUNT - 1, false);
+
+    // each had its turn before any got a second one
+    for (int item = 0; item < ITEM_COUNT; item++) {
+        if (item != ITEM_LOG) {
+            EXPECT_EQ(1, calls(item));
+        }
+    }
+}
+
+TEST(BootTest, PendingItemTimesOut)
+{
+    resetBoot();
+    criticalInit();
+    runDeferred(ITEM_COUNT - 1, false);
+
+    EXPECT_EQ(BOOT_ITEM_RUNNING, bootDeferredState(ITEM_SLOW));
+    EXPECT_GT(runDeferred(100, false), 0);
+    EXPECT_EQ(BOOT_ITEM_TIMED_OUT, bootDeferredState(ITEM_SLOW));
+
+    // not called again once timed out
+    const int slowCalls = calls(ITEM_SLOW);
+    EXPECT_TRUE(bootDeferredUpdate(currentTimeUs + 10000, false));
+    EXPECT_EQ(slowCalls, calls(ITEM_SLOW));
+}
+
+TEST(BootTest, PendingItemWithoutTimeoutKeepsPolling)
+{
+    bootItem_t untimed[ITEM_COUNT];
+    memcpy(untimed, items, sizeof(untimed));
+    untimed[ITEM_SLOW].timeoutMs = 0;
+
+    resetBoot();
+    bootDeferredInit(untimed, ITEM_COUNT);
+    criticalInit();
+
+    EXPECT_EQ(-1, runDeferred(100, false));
+    EXPECT_EQ(BOOT_ITEM_RUNNING, bootDeferredState(ITEM_SLOW));
+    EXPECT_GT(calls(ITEM_SLOW), 50);
+}
+
+TEST(BootTest, HeldWhileArmed)
+{
+    resetBoot();
+    criticalInit();
+
+    // armed straight after a brown-out
+    EXPECT_EQ(-1, runDeferred(100, true));
+    EXPECT_EQ(0, calls(ITEM_COMPASS));
+    EXPECT_EQ(0, calls(ITEM_BARO));
+    EXPECT_EQ(BOOT_ITEM_WAITING, bootDeferredState(ITEM_COMPASS));
+    EXPECT_EQ(BOOT_ITEM_WAITING, bootDeferredState(ITEM_BARO));
+
+    // the others do not wait
+    EXPECT_EQ(BOOT_ITEM_DONE, bootDeferredState(ITEM_LOG));
+    EXPECT_EQ(BOOT_ITEM_TIMED_OUT, bootDeferredState(ITEM_SLOW));
+
+    // disarmed
+    EXPECT_GT(runDeferred(100, false), 0);
+    EXPECT_EQ(BOOT_ITEM_DONE, bootDeferredState(ITEM_COMPASS));
+    EXPECT_EQ(BOOT_ITEM_DONE, bootDeferredState(ITEM_BARO));
+}
+
+TEST(BootTest, TimestampsInOrder)
+{
+    resetBoot();
+    criticalInit();
+    ASSERT_GT(runDeferred(100, false), 0);
+
+    for (int phase = BOOT_PHASE_START; phase < BOOT_PHASE_COUNT; phase++) {
+        EXPECT_TRUE(bootPhaseReached((bootPhase_e)phase));
+        if (phase > BOOT_PHASE_START) {
+            EXPECT_LT(bootPhaseTime((bootPhase_e)(phase - 1)), bootPhaseTime((bootPhase_e)phase));
+        }
+    }
+
+    for (int item = 0; item < ITEM_COUNT; item++) {
+        EXPECT_GT(bootDeferredTime(item), bootPhaseTime(BOOT_PHASE_READY));
+        EXPECT_LE(bootDeferredTime(item), bootPhaseTime(BOOT_PHASE_DEFERRED_DONE));
+    }
+    EXPECT_EQ(ITEM_COUNT, bootDeferredCount());
+    EXPECT_STREQ("LOG_DEVICE", bootDeferredItem(ITEM_LOG_DEVICE)->name);
+}
+
+// The items init() really hands over, see fc_boot_items.c
+
+static bootItem_t trackedItems[DEFERRED_COUNT];
+static int sdcardPolls;
+
+// the real item's scheduling with a recorded call in place of the device, the card takes a few polls
+template <int item>
+static bootInitResult_e trackedInit(timeUs_t)
+{
+    called(item);
+    if (item == DEFERRED_SDCARD && ++sdcardPolls < 4) {
+        return BOOT_INIT_PENDING;
+    }
+    return BOOT_INIT_DONE;
+}
+
+static void resetTrackedBoot(void)
+{
+    static bootInitFn * const inits[DEFERRED_COUNT] = {
+        trackedInit<0>, trackedInit<1>, trackedInit<2>, trackedInit<3>,
+        trackedInit<4>, trackedInit<5>, trackedInit<6>,
+    };
+    static_assert(DEFERRED_COUNT == ARRAYLEN(inits), "one tracked init per deferred item");
+
+    resetBoot();
+    sdcardPolls = 0;
+    for (int i = 0; i < DEFERRED_COUNT; i++) {
+        trackedItems[i] = deferredItems[i];
+        trackedItems[i].init = inits[i];
+    }
+    bootDeferredInit(trackedItems, DEFERRED_COUNT);
+}
+
+static int lastCall(int item)
+{
+    int last = -1;
+    for (int i = 0; i < callCount && i < (int)ARRAYLEN(callOrder); i++) {
+        if (callOrder[i] == item) {
+            last = i;
+        }
+    }
+    return last;
+}
+
+TEST(BootTest, RealItemsFinish)
+{
+    resetBoot();
+    compassDetects = baroDetects = 0;
+    memset(&masterConfig, 0, sizeof(masterConfig));
+    masterConfig.compassConfig.mag_hardware = MAG_DEFAULT;
+    masterConfig.barometerConfig.baro_hardware = BARO_DEFAULT;
+    bootDeferredInit(deferredItems, DEFERRED_COUNT);
+    criticalInit();
+
+    // the startup flash alone steps for half a second
+    ASSERT_GT(runDeferred(200, false), 50);
+    for (int item = 0; item < DEFERRED_COUNT; item++) {
+        EXPECT_EQ(BOOT_ITEM_DONE, bootDeferredState(item)) << bootDeferredItem(item)->name;
+    }
+    EXPECT_EQ(1, compassDetects);
+    EXPECT_EQ(1, baroDetects);
+}
+
+TEST(BootTest, RealBlackboxWaitsForItsDevices)
+{
+    resetTrackedBoot();
+    criticalInit();
+    ASSERT_GT(runDeferred(100, false), 0);
+
+    ASSERT_GE(firstCall(DEFERRED_BLACKBOX), 0);
+    EXPECT_EQ(4, calls(DEFERRED_SDCARD));
+    EXPECT_LT(lastCall(DEFERRED_FLASH), firstCall(DEFERRED_BLACKBOX));
+    EXPECT_LT(lastCall(DEFERRED_SDCARD), firstCall(DEFERRED_BLACKBOX));
+}
+
+TEST(BootTest, RealBusItemsHeldWhileArmed)
+{
+    resetTrackedBoot();
+    criticalInit();
+
+    EXPECT_EQ(-1, runDeferred(100, true));
+    EXPECT_EQ(0, calls(DEFERRED_COMPASS));
+    EXPECT_EQ(0, calls(DEFERRED_BARO));
+    EXPECT_EQ(0, calls(DEFERRED_FLASH));
+    EXPECT_EQ(0, calls(DEFERRED_OSD));
+    // the log needs the flash, which may not start in flight
+    EXPECT_EQ(0, calls(DEFERRED_BLACKBOX));
+    EXPECT_EQ(BOOT_ITEM_DONE, bootDeferredState(DEFERRED_STARTUP_FLASH));
+    EXPECT_EQ(BOOT_ITEM_DONE, bootDeferredState(DEFERRED_SDCARD));
+
+    EXPECT_GT(runDeferred(100, false), 0);
+    EXPECT_EQ(BOOT_ITEM_DONE, bootDeferredState(DEFERRED_BLACKBOX));
+}
@@ -0,0 +1,409 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "io/gps_ubx.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_BUFFER_SIZE 344
+#define NAV_PVT_LENGTH 92
+
+static uint8_t framerBuffer[TEST_BUFFER_SIZE];
+static ubxFramer_t framer;
+
+static int frameCount;
+static int okCount;
+static int skippedCount;
+static int errorCount;
+static ubxFrame_t lastFrame;
+static uint8_t lastPayload[TEST_BUFFER_SIZE];
+static ubxNavPvt_t lastPvt;
+
+static void testFrameHandler(const ubxFrame_t *frame)
+{
+    frameCount++;
+    lastFrame = *frame;
+
+    switch (frame->status) {
+    case UBX_FRAME_OK:
+        okCount++;
+        memcpy(lastPayload, frame->payload, frame->length);
+        ubxDecodeNavPvt(frame, &lastPvt);
+        break;
+    case UBX_FRAME_SKIPPED:
+        skippedCount++;
+        break;
+    case UBX_FRAME_CHECKSUM_ERROR:
+        errorCount++;
+        break;
+    }
+}
+
+static void resetFramer(void)
+{
+    ubxFramerInit(&framer, framerBuffer, sizeof(framerBuffer), testFrameHandler);
+    frameCount = okCount = skippedCount = errorCount = 0;
+    memset(&lastFrame, 0, sizeof(lastFrame));
+    memset(&lastPvt, 0, sizeof(lastPvt));
+}
+
+static void appendU32(std::vector<uint8_t> &v, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        v.push_back(value >> (8 * i));
+    }
+}
+
+static void appendFrame(std::vector<uint8_t> &stream, uint8_t msgClass, uint8_t msgId, const std::vector<uint8_t> &payload)
+{
+    std::vector<uint8_t> body = { msgClass, msgId, (uint8_t)payload.size(), (uint8_t)(payload.size() >> 8) };
+    body.insert(body.end(), payload.begin(), payload.end());
+
+    uint8_t ckA = 0, ckB = 0;
+    for (uint8_t b : body) {
+        ckA += b;
+        ckB += ckA;
+    }
+
+    stream.push_back(UBX_PREAMBLE1);
+    stream.push_back(UBX_PREAMBLE2);
+    stream.insert(stream.end(), body.begin(), body.end());
+    stream.push_back(ckA);
+    stream.push_back(ckB);
+}
+
+static std::vector<uint8_t> navPvtPayload(uint32_t iTOW)
+{
+    std::vector<uint8_t> p;
+    appendU32(p, iTOW);
+    p.resize(20, 0);                    // UTC time fields
+    p.push_back(3);                     // fixType 3D
+    p.push_back(UBX_NAV_PVT_FLAGS_FIX_OK);
+    p.push_back(0);
+    p.push_back(11);                    // numSV
+    appendU32(p, (uint32_t)-1234567);   // lon
+    appendU32(p, 515012345);            // lat
+    appendU32(p, 98765);                // height
+    appendU32(p, 54321);                // hMSL
+    appendU32(p, 1200);                 // hAcc
+    appendU32(p, 2400);                 // vAcc
+    appendU32(p, 1500);                 // velN
+    appendU32(p, (uint32_t)-250);       // velE
+    appendU32(p, 30);                   // velD
+    appendU32(p, 1520);                 // gSpeed
+    appendU32(p, 35012345);             // headMot
+    appendU32(p, 80);                   // sAcc
+    appendU32(p, 500000);               // headAcc
+    p.push_back(0x9a);                  // pDOP 154
+    p.push_back(0x00);
+    p.resize(NAV_PVT_LENGTH, 0);
+    return p;
+}
+
+static void expectDecodedPvt(uint32_t iTOW)
+{
+    EXPECT_EQ(iTOW, lastPvt.iTOW);
+    EXPECT_EQ(3, lastPvt.fixType);
+    EXPECT_EQ(UBX_NAV_PVT_FLAGS_FIX_OK, lastPvt.flags);
+    EXPECT_EQ(11, lastPvt.numSV);
+    EXPECT_EQ(-1234567, lastPvt.lon);
+    EXPECT_EQ(515012345, lastPvt.lat);
+    EXPECT_EQ(98765, lastPvt.height);
+    EXPECT_EQ(54321, lastPvt.hMSL);
+    EXPECT_EQ(1200, lastPvt.hAcc);
+    EXPECT_EQ(2400, lastPvt.vAcc);
+    EXPECT_EQ(1500, lastPvt.velN);
+    EXPECT_EQ(-250, lastPvt.velE);
+    EXPECT_EQ(30, lastPvt.velD);
+    EXPECT_EQ(1520, lastPvt.gSpeed);
+    EXPECT_EQ(35012345, lastPvt.headMot);
+    EXPECT_EQ(80, lastPvt.sAcc);
+    EXPECT_EQ(154, lastPvt.pDOP);
+}
+
+TEST(GpsUbxTest, WholeFrameDispatchedInPlace)
+{
+    resetFramer();
+
+    std::vector<uint8_t> stream;
+    appendFrame(stream, UBX_CLASS_NAV, UBX_MSG_NAV_PVT, navPvtPayload(1000));
+
+    ubxFramerFeed(&framer, stream.data(), stream.size());
+
+    EXPECT_EQ(1, okCount);
+    EXPECT_EQ(UBX_CLASS_NAV, lastFrame.msgClass);
+    EXPECT_EQ(UBX_MSG_NAV_PVT, lastFrame.msgId);
+    EXPECT_EQ(NAV_PVT_LENGTH, lastFrame.length);
+    // payload handed over straight from the receive chunk
+    EXPECT_EQ(stream.data() + 6, lastFrame.payload);
+    expectDecodedPvt(1000);
+}
+
+TEST(GpsUbxTest, SplitFrameAssembled)
+{
+    std::vector<uint8_t> stream;
+    appendFrame(stream, UBX_CLASS_NAV, UBX_MSG_NAV_PVT, navPvtPayload(2000));
+
+    // every split point, including in the header and the checksum
+    for (size_t split = 1; split < stream.size(); split++) {
+        resetFramer();
+        ubxFramerFeed(&framer, stream.data(), split);
+        ubxFramerFeed(&framer, stream.data() + split, stream.size() - split);
+
+        EXPECT_EQ(1, okCount);
+        expectDecodedPvt(2000);
+    }
+
+    // a byte at a time, the way the serial port used to be drained
+    resetFramer();
+    for (uint8_t b : stream) {
+        ubxFramerFeed(&framer, &b, 1);
+    }
+    EXPECT_EQ(1, okCount);
+    EXPECT_EQ(framerBuffer, lastFrame.payload);
+    expectDecodedPvt(2000);
+}
+
+TEST(GpsUbxTest, ResyncAfterNoiseAndBadChecksum)
+{
+    resetFramer();
+
+    std::vector<uint8_t> stream = { 0x00, 0x24, UBX_PREAMBLE1, 0x47, UBX_PREAMBLE1, UBX_PREAMBLE1 };
+    appendFrame(stream, UBX_CLASS_NAV, UBX_MSG_NAV_PVT, navPvtPayload(3000));
+    const size_t corrupt = stream.size() + 20;
+    appendFrame(stream, UBX_CLASS_NAV, UBX_MSG_NAV_PVT, navPvtPayload(4000));
+    stream[corrupt] ^= 0x01;
+    appendFrame(stream, UBX_CLASS_NAV, 0x02, std::vector<uint8_t>(28, 0x55));
+    appendFrame(stream, 0x05, 0x01, std::vector<uint8_t>());
+
+    ubxFramerFeed(&framer, stream.data(), stream.size());
+
+    EXPECT_EQ(4, frameCount);
+    EXPECT_EQ(3, okCount);
+    EXPECT_EQ(1, errorCount);
+    EXPECT_EQ(0x05, lastFrame.msgClass);
+    EXPECT_EQ(0, lastFrame.length);
+    expectDecodedPvt(3000);
+}
+
+TEST(GpsUbxTest, OversizedFrameSkipped)
+{
+    resetFramer();
+
+    std::vector<uint8_t> stream;
+    appendFrame(stream, 0x03, 0x10, std::vector<uint8_t>(TEST_BUFFER_SIZE + 8, 0x11));
+    appendFrame(stream, UBX_CLASS_NAV, UBX_MSG_NAV_PVT, navPvtPayload(5000));
+
+    for (size_t i = 0; i < stream.size(); i += 64) {
+        ubxFramerFeed(&framer, stream.data() + i, std::min((size_t)64, stream.size() - i));
+    }
+
+    EXPECT_EQ(1, skippedCount);
+    EXPECT_EQ(1, okCount);
+    expectDecodedPvt(5000);
+}
+
+TEST(GpsUbxTest, ShortNavPvtNotDecoded)
+{
+    std::vector<uint8_t> payload = navPvtPayload(6000);
+    payload.resize(UBX_NAV_PVT_MIN_LENGTH - 1);
+    std::vector<uint8_t> stream;
+    appendFrame(stream, UBX_CLASS_NAV, UBX_MSG_NAV_PVT, payload);
+
+    resetFramer();
+    ubxFramerFeed(&framer, stream.data(), stream.size());
+
+    ubxNavPvt_t pvt;
+    EXPECT_EQ(1, okCount);
+    EXPECT_FALSE(ubxDecodeNavPvt(&lastFrame, &pvt));
+}
+
+TEST(GpsUbxTest, NavDopDecodesHorizontalDop)
+{
+    std::vector<uint8_t> payload;
+    appendU32(payload, 7000);
+    const uint16_t dops[] = { 210, 154, 120, 133, 92, 70, 61 };     // g, p, t, v, h, n, e
+    for (uint16_t dop : dops) {
+        payload.push_back(dop);
+        payload.push_back(dop >> 8);
+    }
+    std::vector<uint8_t> stream;
+    appendFrame(stream, UBX_CLASS_NAV, UBX_MSG_NAV_DOP, payload);
+
+    resetFramer();
+    ubxFramerFeed(&framer, stream.data(), stream.size());
+
+    ubxNavDop_t dop;
+    EXPECT_EQ(1, okCount);
+    ASSERT_TRUE(ubxDecodeNavDop(&lastFrame, &dop));
+    EXPECT_EQ(7000, dop.iTOW);
+    EXPECT_EQ(154, dop.pDOP);
+    EXPECT_EQ(133, dop.vDOP);
+    EXPECT_EQ(92, dop.hDOP);
+
+    // NAV-PVT is not mistaken for NAV-DOP
+    stream.clear();
+    appendFrame(stream, UBX_CLASS_NAV, UBX_MSG_NAV_PVT, navPvtPayload(8000));
+    ubxFramerFeed(&framer, stream.data(), stream.size());
+    EXPECT_FALSE(ubxDecodeNavDop(&lastFrame, &dop));
+}
+
+/*
+ * The byte at a time UBX state machine gps.c ran before the chunked framer, kept here as the
+ * reference the replay benchmark is measured against.
+ */
+static struct {
+    uint8_t step;
+    uint8_t ckA, ckB;
+    uint8_t msgId;
+    uint16_t length, counter;
+    bool skip;
+    uint8_t buffer[TEST_BUFFER_SIZE];
+    int frames;
+    int errors;
+} legacy;
+
+static void legacyParse(uint8_t data)
+{
+    switch (legacy.step) {
+    case 0:
+        if (data == UBX_PREAMBLE1) {
+            legacy.skip = false;
+            legacy.step++;
+        }
+        break;
+    case 1:
+        legacy.step = (data == UBX_PREAMBLE2) ? 2 : 0;
+        break;
+    case 2:
+        legacy.step++;
+        legacy.ckB = legacy.ckA = data;
+        break;
+    case 3:
+        legacy.step++;
+        legacy.ckB += (legacy.ckA += data);
+        legacy.msgId = data;
+        break;
+    case 4:
+        legacy.step++;
+        legacy.ckB += (legacy.ckA += data);
+        legacy.length = data;
+        break;
+    case 5:
+        legacy.step++;
+        legacy.ckB += (legacy.ckA += data);
+        legacy.length += (uint16_t)(data << 8);
+        if (legacy.length > TEST_BUFFER_SIZE) {
+            legacy.skip = true;
+        }
+        legacy.counter = 0;
+        if (legacy.length == 0) {
+            legacy.step = 7;
+        }
+        break;
+    case 6:
+        legacy.ckB += (legacy.ckA += data);
+        if (legacy.counter < TEST_BUFFER_SIZE) {
+            legacy.buffer[legacy.counter] = data;
+        }
+        if (++legacy.counter >= legacy.length) {
+            legacy.step++;
+        }
+        break;
+    case 7:
+        legacy.step++;
+        if (legacy.ckA != data) {
+            legacy.skip = true;
+            legacy.errors++;
+        }
+        break;
+    case 8:
+        legacy.step = 0;
+        if (legacy.ckB != data) {
+            legacy.errors++;
+            break;
+        }
+        if (!legacy.skip) {
+            legacy.frames++;
+        }
+    }
+}
+
+// one second of a receiver at 5Hz sending NAV-PVT alongside the u-blox 6 messages, NAV-SVINFO every cycle
+static std::vector<uint8_t> recordedStream(void)
+{
+    std::vector<uint8_t> stream;
+    for (int cycle = 0; cycle < 5; cycle++) {
+        const uint32_t iTOW = 100000 + cycle * 200;
+        appendFrame(stream, UBX_CLASS_NAV, 0x03, std::vector<uint8_t>(16, cycle));
+        appendFrame(stream, UBX_CLASS_NAV, 0x02, std::vector<uint8_t>(28, cycle));
+        appendFrame(stream, UBX_CLASS_NAV, 0x06, std::vector<uint8_t>(52, cycle));
+        appendFrame(stream, UBX_CLASS_NAV, 0x12, std::vector<uint8_t>(36, cycle));
+        appendFrame(stream, UBX_CLASS_NAV, UBX_MSG_NAV_PVT, navPvtPayload(iTOW));
+        appendFrame(stream, UBX_CLASS_NAV, 0x30, std::vector<uint8_t>(8 + 12 * 16, cycle));
+    }
+    return stream;
+}
+
+TEST(GpsUbxTest, ReplayBenchmark)
+{
+    const std::vector<uint8_t> stream = recordedStream();
+    const int repeats = 2000;
+    const double bytes = (double)stream.size() * repeats;
+    const size_t chunkSize = 64;
+
+    memset(&legacy, 0, sizeof(legacy));
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (uint8_t b : stream) {
+            legacyParse(b);
+        }
+    }
+    const double legacyUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    resetFramer();
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        for (size_t i = 0; i < stream.size(); i += chunkSize) {
+            ubxFramerFeed(&framer, stream.data() + i, std::min(chunkSize, stream.size() - i));
+        }
+    }
+    const double chunkedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    printf("[ BENCH    ] UBX replay %zu bytes x %d: byte parser %.1f bytes/us, %zu byte chunks %.1f bytes/us\n",
+        stream.size(), repeats, bytes / legacyUs, chunkSize, bytes / chunkedUs);
+
+    // both see the same frames
+    EXPECT_EQ(legacy.frames, okCount);
+    EXPECT_EQ(30 * repeats, okCount);
+    EXPECT_EQ(0, legacy.errors);
+    EXPECT_EQ(0, errorCount);
+    EXPECT_EQ(100800u, lastPvt.iTOW);
+}
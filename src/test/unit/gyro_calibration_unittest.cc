@@ -0,0 +1,406 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/filter.h"
+    #include "common/maths.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/accgyro_fake.h"
+
+    #include "fc/runtime_config.h"
+
+    #include "io/beeper.h"
+
+    #include "scheduler/scheduler.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/gyro.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+#define GYRO_SCALE          (1.0f / 16.4f)  // deg/s per raw count, as the MPU drivers
+#define GYRO_NOISE          4.0f            // raw counts rms
+#define FULL_SAMPLES        8000            // CALIBRATING_GYRO_CYCLES at 8kHz
+#define TEMPERATURE         25
+
+static const float gyroBias[XYZ_AXIS_COUNT] = { 12.4f, -7.2f, 30.6f };
+
+// STUBS
+
+extern "C" {
+    uint8_t detectedSensors[SENSOR_INDEX_COUNT];
+    int16_t debug[DEBUG16_VALUE_COUNT];
+    uint8_t debugMode;
+    uint8_t armingFlags;
+
+    static int gyroCalibratedBeeps;
+
+    void beeper(beeperMode_e mode)
+    {
+        if (mode == BEEPER_GYRO_CALIBRATED) {
+            gyroCalibratedBeeps++;
+        }
+    }
+    void schedulerResetTaskStatistics(cfTaskId_e) {}
+    void sensorsSet(uint32_t) {}
+}
+
+static gyroConfig_t testGyroConfig;
+static float biasDrift;     // raw counts added to the bias on every axis
+
+static void initGyro(int8_t cachedTemperature, const float *cachedBias)
+{
+    memset(&testGyroConfig, 0, sizeof(testGyroConfig));
+    testGyroConfig.gyro_lpf = GYRO_LPF_256HZ;
+    testGyroConfig.gyro_sync_denom = 1;
+    testGyroConfig.gyroMovementCalibrationThreshold = 48;
+    testGyroConfig.gyro_bias_cache.temperature = cachedTemperature;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        testGyroConfig.gyro_bias_cache.bias[axis] = cachedBias ? lrintf(cachedBias[axis]) : 0;
+    }
+
+    lcgState = 42;
+    biasDrift = 0;
+    armingFlags = 0;
+    gyroCalibratedBeeps = 0;
+    gyroBiasCacheSaved();
+    fakeGyroSetTemperature(TEMPERATURE);
+    fakeGyroSet(0, 0, 0);
+    ASSERT_TRUE(gyroInit(&testGyroConfig));
+    gyro.dev.scale = GYRO_SCALE;
+    setGyroBiasCache(&testGyroConfig.gyro_bias_cache);
+}
+
+// one sample of a model turning at rate, in deg/s, with the bias and noise on top
+static void sample(const float *rate)
+{
+    int16_t raw[XYZ_AXIS_COUNT];
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        raw[axis] = lrintf(rate[axis] / GYRO_SCALE + gyroBias[axis] + biasDrift + GYRO_NOISE * lcgGaussian());
+    }
+    fakeGyroSet(raw[X], raw[Y], raw[Z]);
+    gyroUpdate();
+}
+
+static void sampleStill(void)
+{
+    static const float still[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+    sample(still);
+}
+
+// rocked by gusts of gustSamples every periodSamples, 5Hz at amplitudeDps
+static void sampleGusty(int n, int periodSamples, int gustSamples, float amplitudeDps)
+{
+    float rate[XYZ_AXIS_COUNT] = { 0, 0, 0 };
+    if (n % periodSamples < gustSamples) {
+        const float rocking = amplitudeDps * sinf(2.0f * M_PIf * 5.0f * n / 8000.0f);
+        rate[X] = rocking;
+        rate[Y] = -0.5f * rocking;
+    }
+    sample(rate);
+}
+
+static int calibrateStill(int maxSamples)
+{
+    gyroSetCalibrationCycles();
+    for (int n = 0; n < maxSamples; n++) {
+        if (isGyroCalibrationComplete()) {
+            return n;
+        }
+        sampleStill();
+    }
+    return -1;
+}
+
+// mean of what gyroUpdate() gives for a model kept still, in deg/s, the error of the calibrated bias
+static float stillOutput(int axis)
+{
+    float sum = 0;
+    const int samples = 8000;
+    for (int n = 0; n < samples; n++) {
+        sampleStill();
+        sum += gyro.gyroADCf[axis];
+    }
+    return sum / samples;
+}
+
+TEST(GyroCalibrationTest, StillFinishesEarly)
+{
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+
+    const int samples = calibrateStill(2 * FULL_SAMPLES);
+    ASSERT_GT(samples, 0);
+    EXPECT_LE(samples, FULL_SAMPLES / 4 + 64);
+    EXPECT_EQ(1, gyroCalibratedBeeps);
+
+    // well inside a count
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(0.0f, stillOutput(axis), 0.5f * GYRO_SCALE);
+    }
+}
+
+TEST(GyroCalibrationTest, NoisyGyroTakesLonger)
+{
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+
+    // 10 counts rms more, well below moron_threshold, needs more samples for the same mean error
+    int samples = -1;
+    gyroSetCalibrationCycles();
+    for (int n = 0; n < 2 * FULL_SAMPLES && samples < 0; n++) {
+        const float vibration[XYZ_AXIS_COUNT] = { 10 * GYRO_SCALE * lcgGaussian(), 0, 0 };
+        sample(vibration);
+        if (isGyroCalibrationComplete()) {
+            samples = n + 1;
+        }
+    }
+    EXPECT_GT(samples, FULL_SAMPLES / 4);
+    EXPECT_LE(samples, FULL_SAMPLES);
+}
+
+TEST(GyroCalibrationTest, WindyField)
+{
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+
+    // a gust of 0.1s every 0.375s, no second is ever still the whole way through
+    int samples = -1;
+    gyroSetCalibrationCycles();
+    for (int n = 0; n < 10 * FULL_SAMPLES; n++) {
+        sampleGusty(n, 3000, 800, 20.0f);
+        if (isGyroCalibrationComplete()) {
+            samples = n + 1;
+            break;
+        }
+    }
+    ASSERT_GT(samples, 0);
+    EXPECT_LT(samples, 2 * FULL_SAMPLES);
+    printf("[ BENCH    ] calibration windy field %d samples, %.2f s at 8kHz\n", samples, samples / 8000.0f);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(0.0f, stillOutput(axis), 1.0f * GYRO_SCALE);
+    }
+}
+
+TEST(GyroCalibrationTest, MovedDuringCalibrationStartsOver)
+{
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+
+    gyroSetCalibrationCycles();
+    for (int n = 0; n < 1000; n++) {
+        sampleStill();
+    }
+    // picked up
+    const float turn[XYZ_AXIS_COUNT] = { 0, 0, 30 };
+    for (int n = 0; n < 500; n++) {
+        sample(turn);
+    }
+    EXPECT_FALSE(isGyroCalibrationComplete());
+
+    // put down again, the turn is not in the bias
+    EXPECT_GT(calibrateStill(2 * FULL_SAMPLES), 0);
+    EXPECT_NEAR(0.0f, stillOutput(Z), 0.5f * GYRO_SCALE);
+}
+
+TEST(GyroCalibrationTest, CachedBiasShortensCalibration)
+{
+    initGyro(TEMPERATURE + 2, gyroBias);
+
+    const int samples = calibrateStill(2 * FULL_SAMPLES);
+    ASSERT_GT(samples, 0);
+    EXPECT_LE(samples, FULL_SAMPLES / 8 + 64);
+
+    // it agreed, so nothing is written
+    EXPECT_FALSE(gyroBiasCacheSavePending());
+    EXPECT_EQ(TEMPERATURE + 2, testGyroConfig.gyro_bias_cache.temperature);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(0.0f, stillOutput(axis), 1.0f * GYRO_SCALE);
+    }
+}
+
+TEST(GyroCalibrationTest, CacheFromOtherTemperatureNotUsed)
+{
+    const float oldBias[XYZ_AXIS_COUNT] = { 40, 40, 40 };
+    initGyro(TEMPERATURE + 15, oldBias);
+
+    const int samples = calibrateStill(2 * FULL_SAMPLES);
+    EXPECT_GT(samples, FULL_SAMPLES / 8 + 64);
+
+    // replaced by this one
+    EXPECT_TRUE(gyroBiasCacheSavePending());
+    EXPECT_EQ(TEMPERATURE, testGyroConfig.gyro_bias_cache.temperature);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(gyroBias[axis], testGyroConfig.gyro_bias_cache.bias[axis], 1);
+    }
+}
+
+TEST(GyroCalibrationTest, CacheFilledOnFirstCalibration)
+{
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+
+    EXPECT_GT(calibrateStill(2 * FULL_SAMPLES), 0);
+    EXPECT_TRUE(gyroBiasCacheSavePending());
+    EXPECT_EQ(TEMPERATURE, testGyroConfig.gyro_bias_cache.temperature);
+    gyroBiasCacheSaved();
+
+    // the next boot at the same temperature is quicker
+    EXPECT_LE(calibrateStill(2 * FULL_SAMPLES), FULL_SAMPLES / 8 + 64);
+    EXPECT_FALSE(gyroBiasCacheSavePending());
+}
+
+TEST(GyroCalibrationTest, RockingBoatTakesCachedBias)
+{
+    initGyro(TEMPERATURE, gyroBias);
+
+    // rocking all the time
+    gyroSetCalibrationCycles();
+    int n;
+    for (n = 0; n < 20 * FULL_SAMPLES && !isGyroCalibrationComplete(); n++) {
+        sampleGusty(n, 1, 1, 30.0f);
+    }
+    EXPECT_TRUE(isGyroCalibrationComplete());
+    EXPECT_LT(n, 2 * FULL_SAMPLES);
+    EXPECT_FALSE(gyroBiasCacheSavePending());
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(0.0f, stillOutput(axis), 1.0f * GYRO_SCALE);
+    }
+
+    // without one it waits for the boat to settle
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+    gyroSetCalibrationCycles();
+    for (n = 0; n < 20 * FULL_SAMPLES; n++) {
+        sampleGusty(n, 1, 1, 30.0f);
+    }
+    EXPECT_FALSE(isGyroCalibrationComplete());
+}
+
+TEST(GyroCalibrationTest, DriftTrackedWhileDisarmed)
+{
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+    ASSERT_GT(calibrateStill(2 * FULL_SAMPLES), 0);
+
+    // warming up on the bench, 20 counts over 30s
+    const int samples = 30 * 8000;
+    for (int n = 0; n < samples; n++) {
+        biasDrift = 20.0f * n / samples;
+        sampleStill();
+    }
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_NEAR(0.0f, stillOutput(axis), 3.0f * GYRO_SCALE);
+    }
+}
+
+TEST(GyroCalibrationTest, DriftNotTrackedWhenArmed)
+{
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+    ASSERT_GT(calibrateStill(2 * FULL_SAMPLES), 0);
+
+    ENABLE_ARMING_FLAG(ARMED);
+    biasDrift = 20.0f;
+    for (int n = 0; n < 5 * 8000; n++) {
+        sampleStill();
+    }
+    EXPECT_NEAR(20.0f * GYRO_SCALE, stillOutput(X), 1.0f * GYRO_SCALE);
+}
+
+TEST(GyroCalibrationTest, SlowTurnIsNotDrift)
+{
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+    ASSERT_GT(calibrateStill(2 * FULL_SAMPLES), 0);
+
+    // carried around slowly while disarmed
+    const float turn[XYZ_AXIS_COUNT] = { 0, 0, 5 };
+    for (int n = 0; n < 10 * 8000; n++) {
+        sample(turn);
+    }
+    EXPECT_NEAR(0.0f, stillOutput(Z), 0.5f * GYRO_SCALE);
+}
+
+#ifdef USE_FIXED_POINT_PID
+// Built again with USE_FIXED_POINT_PID, the filters then run in fixed point and should follow the float ones
+TEST(GyroCalibrationTest, FixedPointFiltersMatchFloat)
+{
+    initGyro(GYRO_BIAS_TEMPERATURE_NONE, NULL);
+    testGyroConfig.gyro_soft_lpf_type = FILTER_BIQUAD;
+    testGyroConfig.gyro_soft_lpf_hz = 90;
+    testGyroConfig.gyro_soft_notch_hz_1 = 400;
+    testGyroConfig.gyro_soft_notch_cutoff_1 = 300;
+    testGyroConfig.gyro_soft_notch_hz_2 = 200;
+    testGyroConfig.gyro_soft_notch_cutoff_2 = 100;
+    gyroInitFilters();
+
+    biquadFilter_t lpf[XYZ_AXIS_COUNT];
+    biquadFilter_t notch1[XYZ_AXIS_COUNT];
+    biquadFilter_t notch2[XYZ_AXIS_COUNT];
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilterInitLPF(&lpf[axis], 90, gyro.targetLooptime);
+        biquadFilterInit(&notch1[axis], 400, gyro.targetLooptime, filterGetNotchQ(400, 300), FILTER_NOTCH);
+        biquadFilterInit(&notch2[axis], 200, gyro.targetLooptime, filterGetNotchQ(200, 100), FILTER_NOTCH);
+    }
+
+    // a whole count of bias and no noise, so the zero is exact. The notch coefficients are Q2.30, a few
+    // hundredths of a deg/s of difference against 300 deg/s swings is all that is expected
+    int16_t bias[XYZ_AXIS_COUNT];
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        bias[axis] = lrintf(gyroBias[axis]);
+    }
+    gyroSetCalibrationCycles();
+    for (int n = 0; n < 2 * FULL_SAMPLES && !isGyroCalibrationComplete(); n++) {
+        fakeGyroSet(bias[X], bias[Y], bias[Z]);
+        gyroUpdate();
+    }
+    ASSERT_TRUE(isGyroCalibrationComplete());
+    ENABLE_ARMING_FLAG(ARMED);
+
+    float maxError = 0;
+    for (int n = 0; n < 8000; n++) {
+        int16_t raw[XYZ_AXIS_COUNT];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            const float rate = 300.0f * sinf(2.0f * M_PIf * (3.0f + axis) * n / 8000.0f)
+                + 40.0f * sinf(2.0f * M_PIf * 200.0f * n / 8000.0f) + 20.0f * sinf(2.0f * M_PIf * 400.0f * n / 8000.0f);
+            raw[axis] = bias[axis] + lrintf(rate / GYRO_SCALE);
+        }
+        fakeGyroSet(raw[X], raw[Y], raw[Z]);
+        gyroUpdate();
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            float expected = (raw[axis] - bias[axis]) * GYRO_SCALE;
+            expected = biquadFilterApply(&lpf[axis], expected);
+            expected = biquadFilterApply(&notch1[axis], expected);
+            expected = biquadFilterApply(&notch2[axis], expected);
+            maxError = MAX(maxError, fabsf(expected - gyro.gyroADCf[axis]));
+        }
+    }
+    printf("[ BENCH    ] gyro filters fixed point, largest difference to float %.4f dps\n", maxError);
+    EXPECT_LT(maxError, 0.1f);
+}
+#endif
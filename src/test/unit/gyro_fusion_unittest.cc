@@ -0,0 +1,371 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+
+    #include "drivers/sensor.h"
+    #include "drivers/accgyro.h"
+    #include "drivers/accgyro_fake.h"
+
+    #include "fc/runtime_config.h"
+
+    #include "io/beeper.h"
+
+    #include "scheduler/scheduler.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/gyro.h"
+    #include "sensors/gyro_fusion.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+#define GYRO_BIAS_0     10
+#define GYRO_BIAS_1     -20
+#define GYRO_NOISE      3       // raw counts either way, the fake gyro scale is 1 deg/s per count
+
+// STUBS
+
+extern "C" {
+    uint8_t detectedSensors[SENSOR_INDEX_COUNT];
+    int16_t debug[DEBUG16_VALUE_COUNT];
+    uint8_t debugMode;
+
+    static int gyroCalibratedBeeps;
+
+    void beeper(beeperMode_e mode)
+    {
+        if (mode == BEEPER_GYRO_CALIBRATED) {
+            gyroCalibratedBeeps++;
+        }
+    }
+    void schedulerResetTaskStatistics(cfTaskId_e) {}
+    void sensorsSet(uint32_t) {}
+    void saveConfigAndNotify(void) {}
+    uint8_t armingFlags;
+}
+
+// deterministic noise so every run gives the same numbers
+static int16_t noise(void)
+{
+    return (int16_t)((lcgNext() >> 8) % (2 * GYRO_NOISE + 1)) - GYRO_NOISE;
+}
+
+// Fusion on its own
+
+static const uint8_t equalWeights[GYRO_FUSION_SENSOR_COUNT_MAX] = { 50, 50, 50 };
+
+static void checkClean(gyroFusion_t *fusion, int samples)
+{
+    for (int n = 0; n < samples; n++) {
+        for (int i = 0; i < fusion->sensorCount; i++) {
+            const int16_t raw[XYZ_AXIS_COUNT] = { noise(), noise(), noise() };
+            gyroFusionCheckSample(fusion, i, true, raw);
+        }
+    }
+}
+
+TEST(GyroFusionTest, WeightedAverage)
+{
+    gyroFusion_t fusion;
+    const uint8_t weights[] = { 75, 25 };
+    gyroFusionInit(&fusion, 2, GYRO_FUSION_AVERAGE, weights);
+
+    float rates[2][XYZ_AXIS_COUNT] = { { 100, 0, -40 }, { 200, 40, 0 } };
+    float fused[XYZ_AXIS_COUNT];
+    EXPECT_TRUE(gyroFusionApply(&fusion, rates, fused));
+    EXPECT_FLOAT_EQ(125, fused[X]);
+    EXPECT_FLOAT_EQ(10, fused[Y]);
+    EXPECT_FLOAT_EQ(-30, fused[Z]);
+    EXPECT_EQ(0x3, fusion.usedMask);
+
+    // both weighted out, a plain mean
+    const uint8_t noWeights[] = { 0, 0 };
+    gyroFusionInit(&fusion, 2, GYRO_FUSION_AVERAGE, noWeights);
+    EXPECT_TRUE(gyroFusionApply(&fusion, rates, fused));
+    EXPECT_FLOAT_EQ(150, fused[X]);
+}
+
+TEST(GyroFusionTest, MedianOfThree)
+{
+    gyroFusion_t fusion;
+    gyroFusionInit(&fusion, 3, GYRO_FUSION_MEDIAN, equalWeights);
+
+    float rates[3][XYZ_AXIS_COUNT] = { { 10, 0, 5 }, { 20, 2, 6 }, { 15, 1, 70 } };
+    float fused[XYZ_AXIS_COUNT];
+    EXPECT_TRUE(gyroFusionApply(&fusion, rates, fused));
+    EXPECT_FLOAT_EQ(15, fused[X]);
+    EXPECT_FLOAT_EQ(1, fused[Y]);
+    EXPECT_FLOAT_EQ(6, fused[Z]);
+    EXPECT_EQ(0x7, fusion.usedMask);
+}
+
+TEST(GyroFusionTest, StuckSensorDroppedAndRecovers)
+{
+    gyroFusion_t fusion;
+    gyroFusionInit(&fusion, 2, GYRO_FUSION_AVERAGE, equalWeights);
+    lcgState = 1;
+
+    // the first sample is a change from nothing
+    const int16_t frozen[XYZ_AXIS_COUNT] = { 12, -3, 7 };
+    for (int n = 0; n <= GYRO_STUCK_SAMPLES; n++) {
+        const int16_t raw[XYZ_AXIS_COUNT] = { noise(), noise(), noise() };
+        EXPECT_EQ(GYRO_HEALTH_OK, gyroFusionCheckSample(&fusion, 0, true, raw));
+        gyroFusionCheckSample(&fusion, 1, true, frozen);
+    }
+    EXPECT_EQ(GYRO_HEALTH_STUCK, fusion.sensor[1].health);
+    EXPECT_EQ(1, fusion.sensor[1].faultCount);
+
+    float rates[2][XYZ_AXIS_COUNT] = { { 30, 30, 30 }, { 12, -3, 7 } };
+    float fused[XYZ_AXIS_COUNT];
+    EXPECT_TRUE(gyroFusionApply(&fusion, rates, fused));
+    EXPECT_EQ(0x1, fusion.usedMask);
+    EXPECT_FLOAT_EQ(30, fused[X]);
+
+    // moving again, it has to stay clean for a while before it is used
+    checkClean(&fusion, GYRO_RECOVER_SAMPLES);
+    EXPECT_EQ(GYRO_HEALTH_STUCK, fusion.sensor[1].health);
+    checkClean(&fusion, 1);
+    EXPECT_EQ(GYRO_HEALTH_OK, fusion.sensor[1].health);
+    EXPECT_TRUE(gyroFusionApply(&fusion, rates, fused));
+    EXPECT_EQ(0x3, fusion.usedMask);
+    EXPECT_EQ(GYRO_HEALTH_STUCK, fusion.sensor[1].lastFault);
+}
+
+TEST(GyroFusionTest, SaturatedOnlyWhenNothingElse)
+{
+    gyroFusion_t fusion;
+    gyroFusionInit(&fusion, 2, GYRO_FUSION_AVERAGE, equalWeights);
+
+    const int16_t clipped[XYZ_AXIS_COUNT] = { 32767, 0, 0 };
+    const int16_t fine[XYZ_AXIS_COUNT] = { 1000, 0, 0 };
+    EXPECT_EQ(GYRO_HEALTH_SATURATED, gyroFusionCheckSample(&fusion, 0, true, clipped));
+    EXPECT_EQ(GYRO_HEALTH_OK, gyroFusionCheckSample(&fusion, 1, true, fine));
+
+    float rates[2][XYZ_AXIS_COUNT] = { { 2000, 0, 0 }, { 1000, 0, 0 } };
+    float fused[XYZ_AXIS_COUNT];
+    EXPECT_TRUE(gyroFusionApply(&fusion, rates, fused));
+    EXPECT_EQ(0x2, fusion.usedMask);
+    EXPECT_FLOAT_EQ(1000, fused[X]);
+
+    // both clipping in a hard flip, still better than nothing
+    const int16_t clippedNegative[XYZ_AXIS_COUNT] = { -32768, 0, 0 };
+    EXPECT_EQ(GYRO_HEALTH_SATURATED, gyroFusionCheckSample(&fusion, 1, true, clippedNegative));
+    EXPECT_TRUE(gyroFusionApply(&fusion, rates, fused));
+    EXPECT_EQ(0x3, fusion.usedMask);
+}
+
+TEST(GyroFusionTest, NoData)
+{
+    gyroFusion_t fusion;
+    gyroFusionInit(&fusion, 2, GYRO_FUSION_AVERAGE, equalWeights);
+
+    const int16_t raw[XYZ_AXIS_COUNT] = { 5, 6, 7 };
+    EXPECT_EQ(GYRO_HEALTH_NO_DATA, gyroFusionCheckSample(&fusion, 0, false, raw));
+    EXPECT_EQ(GYRO_HEALTH_NO_DATA, gyroFusionCheckSample(&fusion, 1, false, raw));
+
+    float rates[2][XYZ_AXIS_COUNT] = { { 0, 0, 0 }, { 0, 0, 0 } };
+    float fused[XYZ_AXIS_COUNT];
+    EXPECT_FALSE(gyroFusionApply(&fusion, rates, fused));
+    EXPECT_EQ(0, fusion.usedMask);
+
+    // a missed read needs no recovery time
+    EXPECT_EQ(GYRO_HEALTH_OK, gyroFusionCheckSample(&fusion, 0, true, raw));
+}
+
+TEST(GyroFusionTest, OutvotedByTwo)
+{
+    gyroFusion_t fusion;
+    gyroFusionInit(&fusion, 3, GYRO_FUSION_AVERAGE, equalWeights);
+
+    float rates[3][XYZ_AXIS_COUNT] = { { 100, 0, 0 }, { 102, 0, 0 }, { 100, 0, 400 } };
+    float fused[XYZ_AXIS_COUNT];
+
+    // dropped from the sample straight away, marked faulty once it keeps disagreeing
+    EXPECT_TRUE(gyroFusionApply(&fusion, rates, fused));
+    EXPECT_EQ(0x3, fusion.usedMask);
+    EXPECT_FLOAT_EQ(101, fused[X]);
+    EXPECT_FLOAT_EQ(0, fused[Z]);
+    EXPECT_EQ(GYRO_HEALTH_OK, fusion.sensor[2].health);
+
+    for (int n = 1; n < GYRO_OUTVOTE_SAMPLES; n++) {
+        gyroFusionApply(&fusion, rates, fused);
+    }
+    EXPECT_EQ(GYRO_HEALTH_OUTVOTED, fusion.sensor[2].health);
+    EXPECT_EQ(1, fusion.sensor[2].faultCount);
+}
+
+// gyroUpdate() on two fake gyros
+
+static gyroConfig_t testGyroConfig;
+
+static void initGyros(sensor_align_e gyro2Align)
+{
+    memset(&testGyroConfig, 0, sizeof(testGyroConfig));
+    testGyroConfig.gyro_lpf = GYRO_LPF_256HZ;
+    testGyroConfig.gyro_sync_denom = 1;
+    testGyroConfig.gyroMovementCalibrationThreshold = 48;
+    testGyroConfig.gyro_fusion_mode = GYRO_FUSION_AVERAGE;
+    testGyroConfig.gyro_2_weight = 50;
+    testGyroConfig.gyro_2_align = gyro2Align;
+
+    lcgState = 12345;
+    gyroCalibratedBeeps = 0;
+    fakeGyroSet(0, 0, 0);
+    ASSERT_TRUE(gyroInit(&testGyroConfig));
+}
+
+// sensor 1 is mounted turned half around on a CW180_DEG board
+static void setGyros(int16_t roll, int16_t pitch, int16_t yaw, bool secondTurned)
+{
+    fakeGyroSetInstance(0, roll + GYRO_BIAS_0 + noise(), pitch + GYRO_BIAS_0 + noise(), yaw + GYRO_BIAS_0 + noise());
+    const int16_t sign = secondTurned ? -1 : 1;
+    fakeGyroSetInstance(1, sign * roll + GYRO_BIAS_1 + noise(), sign * pitch + GYRO_BIAS_1 + noise(), yaw + GYRO_BIAS_1 + noise());
+}
+
+static void calibrate(bool secondTurned)
+{
+    gyroSetCalibrationCycles();
+    for (int n = 0; n < 100000 && !isGyroCalibrationComplete(); n++) {
+        setGyros(0, 0, 0, secondTurned);
+        gyroUpdate();
+    }
+    ASSERT_TRUE(isGyroCalibrationComplete());
+}
+
+TEST(GyroFusionTest, TwoGyrosCalibratedAndAligned)
+{
+    initGyros(CW180_DEG);
+    EXPECT_EQ(125U, gyro.targetLooptime);
+    calibrate(true);
+    EXPECT_EQ(1, gyroCalibratedBeeps);
+
+    for (int n = 0; n < 100; n++) {
+        setGyros(200, -50, 30, true);
+        gyroUpdate();
+        EXPECT_NEAR(200, gyro.gyroADCf[X], GYRO_NOISE + 1);
+        EXPECT_NEAR(-50, gyro.gyroADCf[Y], GYRO_NOISE + 1);
+        EXPECT_NEAR(30, gyro.gyroADCf[Z], GYRO_NOISE + 1);
+    }
+    EXPECT_EQ(0x3, gyroSensorsUsed());
+}
+
+TEST(GyroFusionTest, StuckSecondGyroFallsBackToFirst)
+{
+    initGyros(ALIGN_DEFAULT);
+    calibrate(false);
+
+    // the second freezes at the last sample, the first carries on
+    for (int n = 0; n < 2 * GYRO_STUCK_SAMPLES; n++) {
+        fakeGyroSetInstance(0, 300 + GYRO_BIAS_0 + noise(), GYRO_BIAS_0 + noise(), GYRO_BIAS_0 + noise());
+        gyroUpdate();
+    }
+    EXPECT_EQ(0x1, gyroSensorsUsed());
+    EXPECT_NEAR(300, gyro.gyroADCf[X], GYRO_NOISE + 1);
+
+    // back, but only after it has been clean for a while
+    for (int n = 0; n < GYRO_RECOVER_SAMPLES + GYRO_STUCK_SAMPLES; n++) {
+        setGyros(300, 0, 0, false);
+        gyroUpdate();
+    }
+    EXPECT_EQ(0x3, gyroSensorsUsed());
+}
+
+TEST(GyroFusionTest, ClippingGyroLeftOut)
+{
+    initGyros(ALIGN_DEFAULT);
+    calibrate(false);
+
+    // the first clips on roll, the second has the range to read it
+    for (int n = 0; n < 10; n++) {
+        fakeGyroSetInstance(0, 32767, GYRO_BIAS_0 + noise(), GYRO_BIAS_0 + noise());
+        fakeGyroSetInstance(1, 31000 + GYRO_BIAS_1 + noise(), GYRO_BIAS_1 + noise(), GYRO_BIAS_1 + noise());
+        gyroUpdate();
+    }
+    EXPECT_EQ(0x2, gyroSensorsUsed());
+    EXPECT_NEAR(31000, gyro.gyroADCf[X], GYRO_NOISE + 1);
+}
+
+TEST(GyroFusionTest, FaultyGyroDoesNotHoldUpCalibration)
+{
+    initGyros(ALIGN_DEFAULT);
+
+    // the second swings from one end of its range to the other, far above moron_threshold
+    gyroSetCalibrationCycles();
+    for (int n = 0; n < 100000 && !isGyroCalibrationComplete(); n++) {
+        fakeGyroSetInstance(0, GYRO_BIAS_0 + noise(), GYRO_BIAS_0 + noise(), GYRO_BIAS_0 + noise());
+        fakeGyroSetInstance(1, (n & 1) ? 32767 : -32768, 0, 0);
+        gyroUpdate();
+    }
+    EXPECT_TRUE(isGyroCalibrationComplete());
+    EXPECT_EQ(1, gyroCalibratedBeeps);
+
+    fakeGyroSetInstance(0, 100 + GYRO_BIAS_0, GYRO_BIAS_0, GYRO_BIAS_0);
+    fakeGyroSetInstance(1, 32767, 0, 0);
+    gyroUpdate();
+    EXPECT_EQ(0x1, gyroSensorsUsed());
+    EXPECT_NEAR(100, gyro.gyroADCf[X], GYRO_NOISE + 1);
+}
+
+TEST(GyroFusionTest, Benchmark)
+{
+    initGyros(ALIGN_DEFAULT);
+    calibrate(false);
+
+    const int iterations = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (int n = 0; n < iterations; n++) {
+        setGyros(n & 0xff, 0, 0, false);
+        gyroUpdate();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    const double updateNs = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+
+    // what the second gyro adds over one: a health check per sensor and the fusion
+    gyroFusion_t fusion;
+    gyroFusionInit(&fusion, 2, GYRO_FUSION_AVERAGE, equalWeights);
+    float rates[2][XYZ_AXIS_COUNT] = { { 0, 0, 0 }, { 0, 0, 0 } };
+    float fused[XYZ_AXIS_COUNT];
+    start = std::chrono::steady_clock::now();
+    for (int n = 0; n < iterations; n++) {
+        const int16_t raw[XYZ_AXIS_COUNT] = { (int16_t)(n & 0xff), 0, 0 };
+        gyroFusionCheckSample(&fusion, 0, true, raw);
+        gyroFusionCheckSample(&fusion, 1, true, raw);
+        rates[0][X] = rates[1][X] = raw[X];
+        gyroFusionApply(&fusion, rates, fused);
+    }
+    stop = std::chrono::steady_clock::now();
+    const double fusionNs = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+
+    // host timing is a report only, against the 125us of an 8kHz gyro loop
+    printf("[ BENCH    ] gyroUpdate two gyros %.1f ns/call, of which checks and fusion %.1f ns/call, 8kHz budget 125000 ns\n", updateNs, fusionNs);
+    EXPECT_GT(fused[X], -1.0f);
+}
@@ -0,0 +1,372 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "fc/runtime_config.h"
+
+    #include "flight/pid.h"
+    #include "flight/imu.h"
+    #include "flight/imu_quaternion.h"
+
+    #include "io/gps.h"
+
+    #include "sensors/sensors.h"
+    #include "sensors/acceleration.h"
+    #include "sensors/compass.h"
+    #include "sensors/gyro.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+#define GYRO_RATE_HZ        1000
+#define ATTITUDE_RATE_HZ    100         // TASK_ATTITUDE
+#define TRUTH_SUBSTEPS      16
+#define ACC_1G              4096
+
+#define GYRO_BIAS_DPS       0.2f        // left over after calibration
+#define GYRO_NOISE_DPS      0.5f
+#define ACC_NOISE_G         0.02f
+#define VIBRATION_G         0.05f       // left in accSmooth after the accelerometer low pass
+
+extern "C" {
+    extern float q0, q1, q2, q3;
+
+    gyro_t gyro;
+    acc_t acc;
+    mag_t mag;
+
+    uint8_t armingFlags;
+    uint8_t stateFlags;
+    uint16_t flightModeFlags;
+
+    uint16_t GPS_speed;
+    uint16_t GPS_ground_course;
+    uint8_t GPS_numSat;
+}
+
+typedef struct motionSample_s {
+    double q[4];                // true attitude after the sample
+    float gyro[3];              // deg/s, as gyro.gyroADCf
+    int32_t acc[3];             // as acc.accSmooth
+} motionSample_t;
+
+typedef void rateFn_t(double t, double rate[3]);
+
+// exact rotation of q by rate * dt, body frame
+static void rotateTruth(double q[4], const double rate[3], double dt)
+{
+    const double angle = sqrt(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2]) * dt;
+    if (angle < 1e-12) {
+        return;
+    }
+    const double s = sin(angle / 2) / (angle / dt);
+    const double r[4] = { cos(angle / 2), rate[0] * s, rate[1] * s, rate[2] * s };
+    const double p[4] = { q[0], q[1], q[2], q[3] };
+
+    q[0] = p[0] * r[0] - p[1] * r[1] - p[2] * r[2] - p[3] * r[3];
+    q[1] = p[0] * r[1] + p[1] * r[0] + p[2] * r[3] - p[3] * r[2];
+    q[2] = p[0] * r[2] - p[1] * r[3] + p[2] * r[0] + p[3] * r[1];
+    q[3] = p[0] * r[3] + p[1] * r[2] - p[2] * r[1] + p[3] * r[0];
+}
+
+// earth Z axis in the sensor frame, the bottom row of the rotation matrix in imu.c
+template <typename T>
+static void earthZ(const T q[4], double z[3])
+{
+    z[0] = 2.0 * (q[1] * q[3] - q[0] * q[2]);
+    z[1] = 2.0 * (q[2] * q[3] + q[0] * q[1]);
+    z[2] = 1.0 - 2.0 * (q[1] * q[1] + q[2] * q[2]);
+}
+
+static std::vector<motionSample_t> recordMotion(rateFn_t *rateFn, float seconds, float vibration)
+{
+    std::vector<motionSample_t> trace;
+    double q[4] = { 1, 0, 0, 0 };
+    const double dt = 1.0 / GYRO_RATE_HZ;
+
+    lcgState = 12345;
+
+    for (int i = 0; i < seconds * GYRO_RATE_HZ; i++) {
+        motionSample_t sample;
+        double rate[3];
+
+        // the gyro reports the average rate over its sample
+        double averageRate[3] = { 0, 0, 0 };
+        for (int step = 0; step < TRUTH_SUBSTEPS; step++) {
+            rateFn((i + (step + 0.5) / TRUTH_SUBSTEPS) * dt, rate);
+            rotateTruth(q, rate, dt / TRUTH_SUBSTEPS);
+            for (int axis = 0; axis < 3; axis++) {
+                averageRate[axis] += rate[axis] / TRUTH_SUBSTEPS;
+            }
+        }
+
+        double z[3];
+        earthZ(q, z);
+        for (int axis = 0; axis < 3; axis++) {
+            sample.q[axis] = q[axis];
+            sample.gyro[axis] = averageRate[axis] / RAD + GYRO_BIAS_DPS + GYRO_NOISE_DPS * lcgGaussian();
+            sample.acc[axis] = lrintf((z[axis] + ACC_NOISE_G * lcgGaussian() + vibration * sinf(2 * M_PI * 3 * i * dt + axis)) * ACC_1G);
+        }
+        sample.q[3] = q[3];
+        trace.push_back(sample);
+    }
+
+    return trace;
+}
+
+// rolls, pitches and yaws at up to 400 deg/s
+static void sineRates(double t, double rate[3])
+{
+    rate[0] = 400 * RAD * sin(2 * M_PI * 2.0 * t);
+    rate[1] = 300 * RAD * sin(2 * M_PI * 1.3 * t + 1);
+    rate[2] = 200 * RAD * sin(2 * M_PI * 0.7 * t + 2);
+}
+
+// level flight with stick inputs, a double flip at 800 deg/s, a yaw spin and a split-S
+static void acroRates(double t, double rate[3])
+{
+    const double phase = fmod(t, 10.0);
+
+    rate[0] = 60 * RAD * sin(2 * M_PI * 0.5 * t);
+    rate[1] = 40 * RAD * sin(2 * M_PI * 0.3 * t);
+    rate[2] = 30 * RAD * sin(2 * M_PI * 0.2 * t);
+
+    if (phase > 2.0 && phase < 2.9) {
+        rate[0] = 800 * RAD;
+    } else if (phase > 5.0 && phase < 6.0) {
+        rate[2] = 720 * RAD;
+    } else if (phase > 7.0 && phase < 7.5) {
+        rate[0] = 360 * RAD;
+    } else if (phase > 7.5 && phase < 8.0) {
+        rate[1] = -360 * RAD;
+    }
+}
+
+typedef struct estimatorResult_s {
+    float tiltRms;              // degrees, against the true attitude after every gyro sample
+    float tiltMax;
+    float nsPerGyroSample;      // imuIntegrateGyro()
+    float nsPerAttitudeUpdate;  // imuUpdateAttitude()
+} estimatorResult_t;
+
+static timeUs_t simulationTimeUs;
+
+// cost of reading the clock around an empty call, taken off every measurement
+static double timerOverheadNs(void)
+{
+    double ns = 0;
+    for (int i = 0; i < 10000; i++) {
+        auto start = std::chrono::steady_clock::now();
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    return ns / 10000;
+}
+
+static void configureEstimator(uint8_t estimator)
+{
+    static imuConfig_t imuConfig;
+    static pidProfile_t pidProfile;
+
+    memset(&imuConfig, 0, sizeof(imuConfig));
+    imuConfig.dcm_kp = 2500;
+    imuConfig.small_angle = 25;
+    imuConfig.estimator = estimator;
+
+    acc.dev.acc_1G = ACC_1G;
+    acc.isAccelUpdatedAtLeastOnce = true;
+
+    q0 = 1.0f;
+    q1 = q2 = q3 = 0.0f;
+    imuConfigure(&imuConfig, &pidProfile, 800);
+    imuInit();
+}
+
+static estimatorResult_t replay(const std::vector<motionSample_t> &trace, uint8_t estimator)
+{
+    double tiltSq = 0;
+    double tiltMax = 0;
+    double gyroNs = 0;
+    double attitudeNs = 0;
+    int attitudeUpdates = 0;
+
+    configureEstimator(estimator);
+    ENABLE_ARMING_FLAG(ARMED);
+
+    for (size_t i = 0; i < trace.size(); i++) {
+        const motionSample_t &sample = trace[i];
+
+        simulationTimeUs += 1000000 / GYRO_RATE_HZ;
+        for (int axis = 0; axis < 3; axis++) {
+            gyro.gyroADCf[axis] = sample.gyro[axis];
+            acc.accSmooth[axis] = sample.acc[axis];
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        imuIntegrateGyro();
+        gyroNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        if (i % (GYRO_RATE_HZ / ATTITUDE_RATE_HZ) == 0) {
+            start = std::chrono::steady_clock::now();
+            imuUpdateAttitude(simulationTimeUs);
+            attitudeNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            attitudeUpdates++;
+        }
+
+        // what a consumer of imuGetQuaternion() sees after every gyro sample
+        float q[4];
+        double estimated[3];
+        double truth[3];
+        imuGetQuaternion(q);
+        earthZ(q, estimated);
+        earthZ(sample.q, truth);
+
+        const double dot = estimated[0] * truth[0] + estimated[1] * truth[1] + estimated[2] * truth[2];
+        const double tilt = acos(std::min(1.0, dot / sqrt(estimated[0] * estimated[0] + estimated[1] * estimated[1] + estimated[2] * estimated[2]))) / RAD;
+        tiltSq += tilt * tilt;
+        tiltMax = std::max(tiltMax, tilt);
+    }
+
+    DISABLE_ARMING_FLAG(ARMED);
+
+    const double overheadNs = timerOverheadNs();
+    estimatorResult_t result = {
+        (float)sqrt(tiltSq / trace.size()),
+        (float)tiltMax,
+        (float)std::max(0.0, gyroNs / trace.size() - overheadNs),
+        (float)std::max(0.0, attitudeNs / attitudeUpdates - overheadNs),
+    };
+    return result;
+}
+
+static void printResult(const char *name, const estimatorResult_t &result)
+{
+    printf("[ IMU      ] %-10s tilt rms %6.3f max %6.3f deg, %5.1f ns per gyro sample, %6.1f ns per attitude update, %6.1f us per second\n",
+        name, result.tiltRms, result.tiltMax, result.nsPerGyroSample, result.nsPerAttitudeUpdate,
+        (result.nsPerGyroSample * GYRO_RATE_HZ + result.nsPerAttitudeUpdate * ATTITUDE_RATE_HZ) / 1000);
+}
+
+TEST(ImuQuaternionTest, IntegratesRotationExactlyAtSmallSteps)
+{
+    imuQuaternionEstimator_t estimator;
+    imuQuaternionReset(&estimator);
+
+    // 90 degrees of roll in 1000 steps
+    for (int i = 0; i < 1000; i++) {
+        imuQuaternionIntegrate(&estimator, M_PIf / 2, 0, 0, 0.001f);
+    }
+
+    EXPECT_NEAR(cosf(M_PIf / 4), estimator.q[0], 1e-4f);
+    EXPECT_NEAR(sinf(M_PIf / 4), estimator.q[1], 1e-4f);
+    EXPECT_NEAR(0.0f, estimator.q[2], 1e-6f);
+    EXPECT_NEAR(0.0f, estimator.q[3], 1e-6f);
+    EXPECT_NEAR(1.0f, sq(estimator.q[0]) + sq(estimator.q[1]) + sq(estimator.q[2]) + sq(estimator.q[3]), 1e-5f);
+}
+
+TEST(ImuQuaternionTest, IntegralFeedbackRemovesGyroBias)
+{
+    imuQuaternionEstimator_t estimator;
+    imuQuaternionReset(&estimator);
+
+    // level and still, the gyro reads 1 deg/s on roll and pitch
+    for (int i = 0; i < 60 * GYRO_RATE_HZ; i++) {
+        imuQuaternionIntegrate(&estimator, 1.0f * RAD, -1.0f * RAD, 0, 1.0f / GYRO_RATE_HZ);
+        if (i % (GYRO_RATE_HZ / ATTITUDE_RATE_HZ) == 0) {
+            imuQuaternionCorrect(&estimator, 1.0f / ATTITUDE_RATE_HZ, 0.25f, 0.03f, true, 0, 0, ACC_1G, false, 0, 0, 0, false, 0);
+        }
+    }
+
+    EXPECT_NEAR(-1.0f * RAD, estimator.integralFB[0], 0.05f * RAD);
+    EXPECT_NEAR(1.0f * RAD, estimator.integralFB[1], 0.05f * RAD);
+    EXPECT_NEAR(1.0f, estimator.q[0], 1e-4f);
+}
+
+TEST(ImuQuaternionTest, EulerAnglesFromAttitudeTask)
+{
+    configureEstimator(IMU_ESTIMATOR_QUATERNION);
+    gyro.targetLooptime = 1000000 / GYRO_RATE_HZ;
+
+    // roll right by 30 degrees in 0.3s, the accelerometer agrees
+    gyro.gyroADCf[X] = 100;
+    for (int i = 0; i < 300; i++) {
+        imuIntegrateGyro();
+    }
+    gyro.gyroADCf[X] = 0;
+    acc.accSmooth[X] = 0;
+    acc.accSmooth[Y] = lrintf(sinf(30 * RAD) * ACC_1G);
+    acc.accSmooth[Z] = lrintf(cosf(30 * RAD) * ACC_1G);
+
+    // angles are only derived when the attitude task runs
+    EXPECT_EQ(0, attitude.values.roll);
+    simulationTimeUs += 10000;
+    imuUpdateAttitude(simulationTimeUs);
+
+    EXPECT_NEAR(300, attitude.values.roll, 2);
+    EXPECT_NEAR(0, attitude.values.pitch, 2);
+    EXPECT_NEAR(300 * RAD / 10, acosf(getCosTiltAngle()), 0.01f);
+}
+
+TEST(ImuQuaternionTest, BenchmarkAgainstMahony)
+{
+    gyro.targetLooptime = 1000000 / GYRO_RATE_HZ;
+
+    const std::vector<motionSample_t> sine = recordMotion(sineRates, 30, 0);
+    const std::vector<motionSample_t> acro = recordMotion(acroRates, 60, VIBRATION_G);
+
+    const estimatorResult_t sineMahony = replay(sine, IMU_ESTIMATOR_MAHONY);
+    const estimatorResult_t sineQuaternion = replay(sine, IMU_ESTIMATOR_QUATERNION);
+    const estimatorResult_t acroMahony = replay(acro, IMU_ESTIMATOR_MAHONY);
+    const estimatorResult_t acroQuaternion = replay(acro, IMU_ESTIMATOR_QUATERNION);
+
+    printf("[ IMU      ] synthetic sine rates, %dHz gyro, %dHz attitude task\n", GYRO_RATE_HZ, ATTITUDE_RATE_HZ);
+    printResult("mahony", sineMahony);
+    printResult("quaternion", sineQuaternion);
+    printf("[ IMU      ] acro manoeuvres with motor vibration\n");
+    printResult("mahony", acroMahony);
+    printResult("quaternion", acroQuaternion);
+
+    // integrating every sample follows fast rotations the 100Hz integration misses
+    EXPECT_LT(sineQuaternion.tiltRms, sineMahony.tiltRms);
+    EXPECT_LT(acroQuaternion.tiltRms, acroMahony.tiltRms);
+    EXPECT_LT(sineQuaternion.tiltMax, sineMahony.tiltMax);
+    EXPECT_LT(acroQuaternion.tiltMax, acroMahony.tiltMax);
+    EXPECT_LT(sineQuaternion.tiltRms, 1.0f);
+    EXPECT_LT(acroQuaternion.tiltRms, 2.0f);
+}
+
+// STUBS
+
+extern "C" {
+uint32_t millis(void) { return 100000; }
+bool sensors(uint32_t mask) { return mask == SENSOR_ACC; }
+void altitudeEstimatorPredict(float accZ, float dt) { UNUSED(accZ); UNUSED(dt); }
+}
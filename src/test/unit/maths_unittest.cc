@@ -199,3 +199,15 @@ TEST(MathsUnittest, TestFastTrigonometryACos)
     EXPECT_LE(error, 1e-4);
 }
 #endif
+
+TEST(MathsUnittest, TestFastInvSqrt)
+{
+    double error = 0;
+    for (float x = 1e-3f; x < 1e4f; x *= 1.01f) {
+        double approxResult = fastInvSqrt(x);
+        double libmResult = 1.0 / sqrt(x);
+        error = MAX(error, fabs(approxResult - libmResult) / libmResult);
+    }
+    printf("fastInvSqrt maximum relative error = %e\n", error);
+    EXPECT_LE(error, 2e-3);
+}
@@ -0,0 +1,350 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/utils.h"
+
+    #include "telemetry/telemetry_scheduler.h"
+    #include "telemetry/mavlink_highrate.h"
+
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wpedantic"
+    #include "common/mavlink.h"
+    #pragma GCC diagnostic pop
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+#define BENCHMARK_MESSAGES  100000
+#define SIMULATION_US       10000000
+#define TX_BUFFER_SIZE      256
+
+// same stream declarations as telemetry/mavlink.c
+static const telemetryFrame_t streamFrames[] = {
+    { MAV_DATA_STREAM_EXTENDED_STATUS, 39, 2 },
+    { MAV_DATA_STREAM_RC_CHANNELS, 30, 5 },
+    { MAV_DATA_STREAM_POSITION, 94, 2 },
+    { MAV_DATA_STREAM_EXTRA1, 36, 10 },
+    { MAV_DATA_STREAM_EXTRA2, 45, 10 },
+};
+
+static mavlinkHighRateSample_t testSample(uint32_t timeUs)
+{
+    mavlinkHighRateSample_t sample;
+
+    sample.timeUs = timeUs;
+    sample.quaternion[0] = 0.9238795f;
+    sample.quaternion[1] = 0.1f;
+    sample.quaternion[2] = -0.2f;
+    sample.quaternion[3] = 0.3826834f;
+    sample.gyro[0] = 1.5f;
+    sample.gyro[1] = -0.25f;
+    sample.gyro[2] = 3.0f;
+    sample.acc[0] = 0.5f;
+    sample.acc[1] = -1.0f;
+    sample.acc[2] = -9.80665f;
+    for (int i = 0; i < MAVLINK_HIGHRATE_SERVO_COUNT; i++) {
+        sample.servo[i] = 1000 + 100 * i;
+    }
+
+    return sample;
+}
+
+// what telemetry/mavlink.c did for every message before, through the library and one serialWrite() per byte
+static uint8_t txBuffer[TX_BUFFER_SIZE];
+static uint32_t txBufferHead;
+static uint32_t txWriteCalls;
+
+static void fakeSerialWrite(uint8_t ch)
+{
+    txWriteCalls++;
+    txBuffer[txBufferHead] = ch;
+    txBufferHead = (txBufferHead + 1) % TX_BUFFER_SIZE;
+}
+
+static void fakeSerialWriteBuf(const uint8_t *data, uint32_t count)
+{
+    txWriteCalls++;
+    while (count > 0) {
+        const uint32_t run = std::min(count, TX_BUFFER_SIZE - txBufferHead);
+        memcpy(&txBuffer[txBufferHead], data, run);
+        txBufferHead = (txBufferHead + run) % TX_BUFFER_SIZE;
+        data += run;
+        count -= run;
+    }
+}
+
+static uint16_t libraryPack(uint8_t *dst, uint8_t msgId, const mavlinkHighRateSample_t *sample)
+{
+    mavlink_message_t msg;
+
+    switch (msgId) {
+    case MAVLINK_MSG_ID_ATTITUDE_QUATERNION:
+        mavlink_msg_attitude_quaternion_pack(0, 200, &msg, sample->timeUs / 1000,
+            sample->quaternion[0], sample->quaternion[1], sample->quaternion[2], sample->quaternion[3],
+            sample->gyro[0], sample->gyro[1], sample->gyro[2]);
+        break;
+    case MAVLINK_MSG_ID_HIGHRES_IMU:
+        mavlink_msg_highres_imu_pack(0, 200, &msg, sample->timeUs,
+            sample->acc[0], sample->acc[1], sample->acc[2],
+            sample->gyro[0], sample->gyro[1], sample->gyro[2],
+            0, 0, 0, 0, 0, 0, 0, 0x003F);
+        break;
+    case MAVLINK_MSG_ID_SERVO_OUTPUT_RAW:
+        mavlink_msg_servo_output_raw_pack(0, 200, &msg, sample->timeUs, 0,
+            sample->servo[0], sample->servo[1], sample->servo[2], sample->servo[3],
+            sample->servo[4], sample->servo[5], sample->servo[6], sample->servo[7]);
+        break;
+    }
+
+    return mavlink_msg_to_send_buffer(dst, &msg);
+}
+
+static uint8_t directPack(uint8_t *dst, uint8_t msgId, uint8_t sequence, const mavlinkHighRateSample_t *sample)
+{
+    switch (msgId) {
+    case MAVLINK_MSG_ID_ATTITUDE_QUATERNION:
+        return mavlinkPackAttitudeQuaternion(dst, sequence, sample);
+    case MAVLINK_MSG_ID_HIGHRES_IMU:
+        return mavlinkPackHighresImu(dst, sequence, sample);
+    default:
+        return mavlinkPackServoOutputRaw(dst, sequence, sample);
+    }
+}
+
+static const uint8_t highRateMessages[] = {
+    MAVLINK_MSG_ID_ATTITUDE_QUATERNION,
+    MAVLINK_MSG_ID_HIGHRES_IMU,
+    MAVLINK_MSG_ID_SERVO_OUTPUT_RAW,
+};
+
+TEST(MavlinkHighRateUnittest, TestFramesMatchLibrary)
+{
+    const mavlinkHighRateSample_t sample = testSample(123456789);
+    telemetryFrame_t frames[MAVLINK_HIGHRATE_FRAME_COUNT];
+
+    EXPECT_EQ(MAVLINK_HIGHRATE_FRAME_COUNT, mavlinkHighRateInitFrames(frames, 200));
+
+    for (unsigned i = 0; i < ARRAYLEN(highRateMessages); i++) {
+        uint8_t expected[MAVLINK_MAX_PACKET_LEN];
+        uint8_t actual[MAVLINK_MAX_PACKET_LEN];
+
+        // the library takes its sequence from the channel status, pack ours with the same number
+        const uint8_t sequence = mavlink_get_channel_status(MAVLINK_COMM_0)->current_tx_seq;
+        const uint16_t expectedLength = libraryPack(expected, highRateMessages[i], &sample);
+        const uint8_t actualLength = directPack(actual, highRateMessages[i], sequence, &sample);
+
+        EXPECT_EQ(expectedLength, actualLength) << "message " << (int)highRateMessages[i];
+        EXPECT_EQ(0, memcmp(expected, actual, expectedLength)) << "message " << (int)highRateMessages[i];
+
+        // and the scheduler budgets the size that goes on the wire
+        EXPECT_EQ(highRateMessages[i], frames[i].id);
+        EXPECT_EQ(actualLength, frames[i].size);
+        EXPECT_EQ(200, frames[i].rateHz);
+    }
+}
+
+TEST(MavlinkHighRateUnittest, TestCpuCostPerMessage)
+{
+    uint8_t frame[MAVLINK_MAX_PACKET_LEN];
+    mavlinkHighRateSample_t sample = testSample(0);
+    uint32_t checksum = 0;
+
+    txWriteCalls = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_MESSAGES; i++) {
+        sample.timeUs = i * 2000;
+        const uint16_t length = libraryPack(frame, highRateMessages[i % 3], &sample);
+        for (int j = 0; j < length; j++) {
+            fakeSerialWrite(frame[j]);
+        }
+        checksum += txBuffer[(txBufferHead + TX_BUFFER_SIZE - 1) % TX_BUFFER_SIZE];
+    }
+    const double libraryNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_MESSAGES;
+    const uint32_t libraryWriteCalls = txWriteCalls;
+
+    // packed back to back into a batch that goes to the TX buffer in one copy, as mavlink.c does
+    uint8_t batch[MAVLINK_MAX_PACKET_LEN];
+    txWriteCalls = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_MESSAGES; i += 3) {
+        uint16_t batchLength = 0;
+        sample.timeUs = i * 2000;
+        for (int j = 0; j < 3; j++) {
+            batchLength += directPack(&batch[batchLength], highRateMessages[j], i + j, &sample);
+        }
+        fakeSerialWriteBuf(batch, batchLength);
+        checksum += txBuffer[(txBufferHead + TX_BUFFER_SIZE - 1) % TX_BUFFER_SIZE];
+    }
+    const double directNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BENCHMARK_MESSAGES;
+
+    const uint32_t directWriteCalls = txWriteCalls;
+
+    // host timing is only a report, the calls into the serial driver are what the flight controller saves
+    printf("[ MAVLINK  ] library + serialWrite: %.0f ns/message, %.2f serial calls/message\n",
+        libraryNs, (double)libraryWriteCalls / BENCHMARK_MESSAGES);
+    printf("[ MAVLINK  ] direct batch:          %.0f ns/message, %.2f serial calls/message (%u)\n",
+        directNs, (double)directWriteCalls / BENCHMARK_MESSAGES, checksum & 1);
+
+    EXPECT_EQ((uint32_t)(BENCHMARK_MESSAGES + 2) / 3, directWriteCalls);
+    EXPECT_GT(libraryWriteCalls, 30 * directWriteCalls);
+}
+
+TEST(MavlinkHighRateUnittest, TestBatchMatchesPerByteWrite)
+{
+    mavlinkHighRateSample_t sample = testSample(0);
+    txBufferHead = 0;
+
+    // enough batches to wrap around the TX buffer
+    for (int i = 0; i < 100; i++) {
+        uint8_t expected[3 * MAVLINK_MAX_PACKET_LEN];
+        uint16_t expectedLength = 0;
+        uint8_t batch[MAVLINK_MAX_PACKET_LEN];
+        uint16_t batchLength = 0;
+
+        sample.timeUs = i * 2000;
+        for (unsigned j = 0; j < ARRAYLEN(highRateMessages); j++) {
+            const uint8_t sequence = mavlink_get_channel_status(MAVLINK_COMM_0)->current_tx_seq;
+            expectedLength += libraryPack(&expected[expectedLength], highRateMessages[j], &sample);
+            batchLength += directPack(&batch[batchLength], highRateMessages[j], sequence, &sample);
+        }
+        ASSERT_EQ(expectedLength, batchLength);
+        ASSERT_LE(batchLength, MAVLINK_MAX_PACKET_LEN);
+
+        const uint32_t start = txBufferHead;
+        fakeSerialWriteBuf(batch, batchLength);
+        for (int j = 0; j < batchLength; j++) {
+            EXPECT_EQ(expected[j], txBuffer[(start + j) % TX_BUFFER_SIZE]) << "batch " << i << " byte " << j;
+        }
+    }
+}
+
+typedef struct jitterResult_s {
+    uint32_t sent[TELEMETRY_SCHEDULER_MAX_FRAMES];
+    int32_t maxJitterUs;
+} jitterResult_t;
+
+// runs the telemetry task at taskRateHz with up to maxLatenessUs of scheduling delay, jitter is measured against the ideal high rate grid
+static void simulateStream(telemetryScheduler_t *scheduler, uint32_t taskRateHz, uint32_t maxLatenessUs, jitterResult_t *result)
+{
+    const uint32_t taskPeriodUs = 1000000 / taskRateHz;
+    const int firstHighRate = ARRAYLEN(streamFrames);
+    lcgState = 12345;
+
+    memset(result, 0, sizeof(*result));
+
+    for (uint32_t slot = 0; slot * taskPeriodUs < SIMULATION_US; slot++) {
+        const timeUs_t now = slot * taskPeriodUs + lcgNext() % (maxLatenessUs + 1);
+
+        int frameIndex;
+        while ((frameIndex = telemetrySchedulerNext(scheduler, now)) >= 0) {
+            telemetrySchedulerFrameSent(scheduler, frameIndex, now);
+            result->sent[frameIndex]++;
+
+            if (frameIndex >= firstHighRate) {
+                const uint32_t periodUs = scheduler->state[frameIndex].periodUs;
+                const int32_t jitterUs = now - (result->sent[frameIndex] - 1) * periodUs;
+                result->maxJitterUs = std::max(result->maxJitterUs, std::abs(jitterUs));
+            }
+        }
+    }
+}
+
+static void initScheduler(telemetryScheduler_t *scheduler, telemetryFrame_t *frames, uint32_t baudRate, uint16_t highRateHz)
+{
+    memcpy(frames, streamFrames, sizeof(streamFrames));
+    const uint8_t count = ARRAYLEN(streamFrames) + mavlinkHighRateInitFrames(&frames[ARRAYLEN(streamFrames)], highRateHz);
+
+    telemetrySchedulerReset();
+    telemetrySchedulerInit(scheduler, 512, frames, count, baudRate, 100, 0);
+}
+
+TEST(MavlinkHighRateUnittest, TestStreamTimingAt500Hz)
+{
+    telemetryFrame_t frames[TELEMETRY_SCHEDULER_MAX_FRAMES];
+    telemetryScheduler_t scheduler;
+    jitterResult_t result;
+
+    // 500Hz of all three messages plus the regular streams need 71kB/s, 921600 baud carries 92kB/s
+    initScheduler(&scheduler, frames, 921600, 500);
+    EXPECT_EQ(1000, scheduler.rateScale);
+
+    // telemetry task at twice the stream rate as set up by fcTasksInit(), late by up to 250us
+    simulateStream(&scheduler, 1000, 250, &result);
+
+    for (int i = 0; i < scheduler.frameCount; i++) {
+        EXPECT_NEAR(frames[i].rateHz * (SIMULATION_US / 1000000), result.sent[i], 2) << "frame " << i;
+    }
+    // every message leaves within one task period plus the lateness of its slot
+    EXPECT_LE(result.maxJitterUs, 1000 + 250);
+
+    printf("[ MAVLINK  ] 500Hz at 921600 baud, max jitter %dus\n", result.maxJitterUs);
+}
+
+TEST(MavlinkHighRateUnittest, TestStreamAt100HzFits230400)
+{
+    telemetryFrame_t frames[TELEMETRY_SCHEDULER_MAX_FRAMES];
+    telemetryScheduler_t scheduler;
+    jitterResult_t result;
+
+    initScheduler(&scheduler, frames, 230400, 100);
+    EXPECT_EQ(1000, scheduler.rateScale);
+
+    simulateStream(&scheduler, 500, 250, &result);
+
+    for (int i = 0; i < scheduler.frameCount; i++) {
+        EXPECT_NEAR(frames[i].rateHz * (SIMULATION_US / 1000000), result.sent[i], 2) << "frame " << i;
+    }
+    // at this baud rate a message can also queue behind one of each of the other frames on the link
+    uint32_t burstBytes = 0;
+    for (int i = 0; i < scheduler.frameCount; i++) {
+        burstBytes += frames[i].size;
+    }
+    EXPECT_LE((uint32_t)result.maxJitterUs, 2000 + 250 + burstBytes * scheduler.usPerByte);
+
+    printf("[ MAVLINK  ] 100Hz at 230400 baud, max jitter %dus\n", result.maxJitterUs);
+}
+
+TEST(MavlinkHighRateUnittest, TestStreamStretchedAt115200)
+{
+    telemetryFrame_t frames[TELEMETRY_SCHEDULER_MAX_FRAMES];
+    telemetryScheduler_t scheduler;
+    jitterResult_t result;
+
+    // the link carries a sixth of what 500Hz asks for, every stream keeps its share
+    initScheduler(&scheduler, frames, 115200, 500);
+    EXPECT_LT(scheduler.rateScale, 200);
+
+    simulateStream(&scheduler, 1000, 250, &result);
+
+    for (int i = 0; i < scheduler.frameCount; i++) {
+        const float expected = frames[i].rateHz * scheduler.rateScale / 1000.0f * (SIMULATION_US / 1000000);
+        EXPECT_GE(result.sent[i], expected * 0.9f) << "frame " << i;
+        EXPECT_LE(result.sent[i], expected * 1.1f + 1) << "frame " << i;
+    }
+}
@@ -0,0 +1,342 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <chrono>
+
+extern "C" {
+#include "platform.h"
+
+#include "common/axis.h"
+
+#include "config/feature.h"
+
+#include "drivers/pwm_output.h"
+
+#include "fc/config.h"
+#include "fc/rc_controls.h"
+#include "fc/runtime_config.h"
+
+#include "flight/mixer.h"
+#include "flight/mixer_tricopter.h"
+#include "flight/pid.h"
+
+#include "io/motors.h"
+
+#include "rx/rx.h"
+
+#include "sensors/battery.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+// The firmware is built with USE_TRI_MIXER_FAST_PATH for this test. MIXER_TRI takes the straight-line path,
+// MIXER_CUSTOM_TRI loaded with the same rules takes the generic one, so both are compared through mixTable().
+
+extern "C" {
+    uint32_t testFeatures;
+    bool testAirmode;
+    bool testFailsafe;
+    float testVbatCompensation;
+    int16_t testTailCorrection;
+    int testCorrectionCalls;
+}
+
+static mixerConfig_t testMixerConfig;
+static flight3DConfig_t testFlight3DConfig;
+static motorConfig_t testMotorConfig;
+static airplaneConfig_t testAirplaneConfig;
+static rxConfig_t testRxConfig;
+static pidProfile_t testPidProfile;
+static motorMixer_t testCustomMixers[MAX_SUPPORTED_MOTORS];
+static batteryConfig_t testBatteryConfig;
+
+typedef struct mixResult_s {
+    int16_t motor[TRI_MOTOR_COUNT];
+    float motorMixRange;
+    int correctionCalls;
+} mixResult_t;
+
+static void configureMixer(mixerMode_e mode)
+{
+    testMixerConfig.mixerMode = mode;
+    mixerUseConfigs(&testFlight3DConfig, &testMotorConfig, &testMixerConfig, &testAirplaneConfig, &testRxConfig);
+    memset(testCustomMixers, 0, sizeof(testCustomMixers));
+    mixerLoadMix(MIXER_TRI - 1, testCustomMixers);
+    mixerInit(mode, testCustomMixers);
+    mixerConfigureOutput();
+}
+
+static mixResult_t runMixer(mixerMode_e mode)
+{
+    mixResult_t result;
+
+    configureMixer(mode);
+    testCorrectionCalls = 0;
+    mixTable(&testPidProfile);
+
+    memcpy(result.motor, motor, sizeof(result.motor));
+    result.motorMixRange = getMotorMixRange();
+    result.correctionCalls = testCorrectionCalls;
+    return result;
+}
+
+static void resetInputs(void)
+{
+    testMixerConfig.yaw_motor_direction = 1;
+
+    testFlight3DConfig.deadband3d_low = 1406;
+    testFlight3DConfig.deadband3d_high = 1514;
+    testFlight3DConfig.neutral3d = 1460;
+    testFlight3DConfig.deadband3d_throttle = 50;
+
+    testMotorConfig.minthrottle = 1070;
+    testMotorConfig.maxthrottle = 2000;
+    testMotorConfig.mincommand = 1000;
+    testMotorConfig.motorPwmProtocol = PWM_TYPE_ONESHOT125;
+
+    testRxConfig.midrc = 1500;
+    testRxConfig.mincheck = 1100;
+
+    testPidProfile.pidSumLimit = 0.5f;
+    testPidProfile.pidSumLimitYaw = 0.4f;
+    testPidProfile.vbatPidCompensation = 0;
+    batteryConfig = &testBatteryConfig;
+
+    testFeatures = 0;
+    testAirmode = false;
+    testFailsafe = false;
+    testVbatCompensation = 1.0f;
+    testTailCorrection = 0;
+    armingFlags = ARMED;
+    rcCommand[THROTTLE] = 1500;
+    rcData[THROTTLE] = 1500;
+
+    for (int axis = 0; axis < 3; axis++) {
+        axisPID_P[axis] = 0;
+        axisPID_I[axis] = 0;
+        axisPID_D[axis] = 0;
+    }
+}
+
+static void randomizeInputs(void)
+{
+    testMixerConfig.yaw_motor_direction = (lcgNext() & 1) ? 1 : -1;
+    testFeatures = ((lcgNext() & 3) == 0 ? FEATURE_3D : 0) | ((lcgNext() & 3) == 0 ? FEATURE_MOTOR_STOP : 0);
+    testAirmode = lcgNext() & 1;
+    testFailsafe = (lcgNext() & 7) == 0;
+    armingFlags = (lcgNext() & 7) == 0 ? 0 : ARMED;
+    testPidProfile.vbatPidCompensation = lcgNext() & 1;
+    testVbatCompensation = lcgRange(1.0f, 1.3f);
+    testTailCorrection = (int16_t)lcgRange(-60, 60);
+    rcCommand[THROTTLE] = (int16_t)lcgRange(1000, 2000);
+    rcData[THROTTLE] = (lcgNext() & 3) == 0 ? 1050 : rcCommand[THROTTLE];
+
+    for (int axis = 0; axis < 3; axis++) {
+        // large sums push the mix range over 1 to cover the rescaling branch
+        axisPID_P[axis] = lcgRange(-600, 600);
+        axisPID_I[axis] = lcgRange(-200, 200);
+        axisPID_D[axis] = lcgRange(-300, 300);
+    }
+}
+
+static void expectSameResult(const mixResult_t *fast, const mixResult_t *generic, int iteration)
+{
+    for (int i = 0; i < TRI_MOTOR_COUNT; i++) {
+        EXPECT_EQ(generic->motor[i], fast->motor[i]) << "motor " << i << " iteration " << iteration;
+    }
+    // bit-exact, not just equal within a tolerance
+    EXPECT_EQ(0, memcmp(&generic->motorMixRange, &fast->motorMixRange, sizeof(float))) << "iteration " << iteration;
+}
+
+TEST(MixerTriFastPathTest, SameRulesAsGenericTricopter)
+{
+    resetInputs();
+
+    configureMixer(MIXER_TRI);
+    EXPECT_EQ(TRI_MOTOR_COUNT, mixers[MIXER_TRI].motorCount);
+    EXPECT_EQ(testMotorConfig.mincommand, motor_disarmed[0]);
+
+    axisPID_P[FD_YAW] = 100;
+    const mixResult_t fast = runMixer(MIXER_TRI);
+    const mixResult_t generic = runMixer(MIXER_CUSTOM_TRI);
+    expectSameResult(&fast, &generic, 0);
+
+    // the fast path only asks for the tail motor correction
+    EXPECT_EQ(1, fast.correctionCalls);
+    EXPECT_EQ(TRI_MOTOR_COUNT, generic.correctionCalls);
+}
+
+TEST(MixerTriFastPathTest, BitExactOverRandomInputs)
+{
+    resetInputs();
+    lcgState = 0x1234567;
+
+    const int iterations = 20000;
+    int rescaled = 0;
+    int threeD = 0;
+    for (int iteration = 0; iteration < iterations; iteration++) {
+        randomizeInputs();
+
+        const mixResult_t fast = runMixer(MIXER_TRI);
+        const mixResult_t generic = runMixer(MIXER_CUSTOM_TRI);
+        expectSameResult(&fast, &generic, iteration);
+        if (::testing::Test::HasFailure()) {
+            break;
+        }
+
+        rescaled += generic.motorMixRange > 1.0f;
+        threeD += (testFeatures & FEATURE_3D) != 0;
+    }
+
+    // make sure the interesting branches were covered
+    EXPECT_GT(rescaled, iterations / 10);
+    EXPECT_GT(threeD, iterations / 10);
+    printf("[ COVERAGE ] %d iterations, %d rescaled, %d in 3D\n", iterations, rescaled, threeD);
+}
+
+TEST(MixerTriFastPathTest, TailCorrectionOnlyOnTailMotor)
+{
+    resetInputs();
+    rcCommand[THROTTLE] = 1600;
+
+    const mixResult_t plain = runMixer(MIXER_TRI);
+    testTailCorrection = 40;
+    const mixResult_t corrected = runMixer(MIXER_TRI);
+
+    EXPECT_EQ(plain.motor[TRI_TAIL_MOTOR_INDEX] + 40, corrected.motor[TRI_TAIL_MOTOR_INDEX]);
+    for (int i = 0; i < TRI_MOTOR_COUNT; i++) {
+        if (i != TRI_TAIL_MOTOR_INDEX) {
+            EXPECT_EQ(plain.motor[i], corrected.motor[i]);
+        }
+    }
+}
+
+static double benchmarkMixTable(mixerMode_e mode, int iterations)
+{
+    configureMixer(mode);
+    lcgState = 0x89abcdef;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        axisPID_P[FD_ROLL] = (float)(lcgNext() & 0x1ff) - 256;
+        axisPID_P[FD_YAW] = (float)(lcgNext() & 0x1ff) - 256;
+        mixTable(&testPidProfile);
+    }
+    const auto stop = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+}
+
+TEST(MixerTriFastPathTest, Benchmark)
+{
+    resetInputs();
+    testAirmode = true;
+    testPidProfile.vbatPidCompensation = 1;
+    testVbatCompensation = 1.1f;
+
+    const int iterations = 1000000;
+    const double genericNs = benchmarkMixTable(MIXER_CUSTOM_TRI, iterations);
+    const double fastNs = benchmarkMixTable(MIXER_TRI, iterations);
+
+    // host timing only says which path does less work, the flight controller numbers come from the task stats
+    printf("[ BENCH    ] mixTable generic %.1f ns/call, tricopter fast path %.1f ns/call\n", genericNs, fastNs);
+    EXPECT_GT(genericNs, 0);
+    EXPECT_GT(fastNs, 0);
+}
+
+// STUBS
+
+extern "C" {
+uint8_t armingFlags;
+int16_t rcCommand[4];
+int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+float axisPID_P[3], axisPID_I[3], axisPID_D[3];
+
+bool feature(uint32_t mask)
+{
+    return (testFeatures & mask) != 0;
+}
+
+bool isAirmodeActive(void)
+{
+    return testAirmode;
+}
+
+bool failsafeIsActive(void)
+{
+    return testFailsafe;
+}
+
+float calculateVbatPidCompensation(void)
+{
+    return testVbatCompensation;
+}
+
+int16_t triGetMotorCorrection(uint8_t motorIndex)
+{
+    testCorrectionCalls++;
+    return motorIndex == TRI_TAIL_MOTOR_INDEX ? testTailCorrection : 0;
+}
+
+bool triMixerInUse(void)
+{
+    return true;
+}
+
+bool triIsServoSaturated(float rateError)
+{
+    UNUSED(rateError);
+    return false;
+}
+
+bool pwmAreMotorsEnabled(void)
+{
+    return true;
+}
+
+void pwmWriteMotor(uint8_t index, uint16_t value)
+{
+    UNUSED(index);
+    UNUSED(value);
+}
+
+void pwmCompleteMotorUpdate(uint8_t motorCount)
+{
+    UNUSED(motorCount);
+}
+
+void pwmShutdownPulsesForAllMotors(uint8_t motorCount)
+{
+    UNUSED(motorCount);
+}
+
+void delay(uint32_t ms)
+{
+    UNUSED(ms);
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    UNUSED(us);
+}
+}
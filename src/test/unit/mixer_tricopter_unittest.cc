@@ -34,6 +34,8 @@ extern "C" {
 
 #include "sensors/gyro.h"
 
+#include "drivers/servo_timing.h"
+
 #include "flight/mixer.h"
 #define MIXER_TRICOPTER_INTERNALS
 #include "flight/mixer_tricopter.h"
@@ -57,13 +59,21 @@ int16_t test_motorRange;
 void tailTuneModeThrustTorque(thrustTorque_t *pTT, const bool isThrottleHigh);
 uint16_t getLinearServoValue(servoParam_t *servoConf, float scaledPIDOutput, float pidSumLimit);
 float getAngleForYawOutput(float yawOutput);
+float getPitchCorrectionAtTailAngle(float angle, float thrustFactor);
+#ifdef USE_FIXED_POINT_PID
+float getAngleForYawOutputFix(float yawOutput);
+fix16_t getPitchCorrectionAtTailAngleFix(fix16_t angle);
+#endif
 float binarySearchOutput(float yawOutput, float gain);
 uint16_t getServoValueAtAngle(servoParam_t *servoConf, float angle);
 float getServoAngle(servoParam_t *servoConf, uint16_t servoValue);
+float virtualServoStepPhased(float currentAngle, int16_t servoSpeed, float dT, servoParam_t *servoConf,
+        const servoPulse_t *pulse);
 }
 extern tailServo_t tailServo;
 extern tailMotor_t tailMotor;
 #include "unittest_macros.h"
+#include "unittest_random.h"
 #include "gtest/gtest.h"
 
 class ThrustFactorCalculationTest: public ::testing::Test {
@@ -249,6 +259,32 @@ TEST_F(LinearOutputTest, getAngleForYawOutput_accuracy) {
     EXPECT_NEAR(0.01, fabsf(secondAngle - angle), 0.005);
 }
 
+#ifdef USE_FIXED_POINT_PID
+// Built with USE_FIXED_POINT_PID, the tests above go through the fixed point lookups
+// from getLinearServoValue() as well. These compare them with the float ones over random inputs.
+TEST_F(LinearOutputTest, getAngleForYawOutputFix_matchesFloat) {
+    float maxError = 0;
+    for (int i = 0; i < 20000; i++) {
+        tailMotor.virtualFeedBack = lcgRange(test_motorLow, test_motorHigh);
+        tailMotor.lastCorrection = lcgRange(0, 300);
+        const float output = tailServo.maxYawOutput * lcgRange(-1.1f, 1.1f);
+        maxError = MAX(maxError, fabsf(getAngleForYawOutput(output) - getAngleForYawOutputFix(output)));
+    }
+    EXPECT_LT(maxError, 0.01f);
+}
+
+TEST_F(LinearOutputTest, getPitchCorrectionAtTailAngleFix_matchesFloat) {
+    float maxError = 0;
+    for (int i = 0; i < 20000; i++) {
+        const float angle = lcgRange(tailServo.angleAtMin, tailServo.angleAtMax);
+        const float correction = getPitchCorrectionAtTailAngle(DEGREES_TO_RADIANS(angle), tailServo.thrustFactor);
+        maxError = MAX(maxError, fabsf(correction - fix16ToFloat(getPitchCorrectionAtTailAngleFix(fix16FromFloat(angle)))));
+    }
+    // linear between whole degrees, well below one step of motor output
+    EXPECT_LT(maxError, 0.5f);
+}
+#endif
+
 TEST_F(LinearOutputTest, getServoValueAtAngle_min) {
     uint16_t angle = tailServo.angleAtMin;
     EXPECT_EQ(servoConf.min, getServoValueAtAngle(&servoConf, angle));
@@ -338,9 +374,43 @@ TEST_F(LinearOutputTest, getLinearServoValue_accuracy) {
     EXPECT_EQ(1, newServoValue - servoValue);
 }
 
+TEST_F(LinearOutputTest, virtualServoStepPhased_oldPulse) {
+    // the servo has had the new command for longer than the loop, it moved at full speed all the time
+    const servoPulse_t pulse = { .value = DEFAULT_SERVO_MAX, .previousValue = DEFAULT_SERVO_MIDDLE, .ageUs = 2000 };
+    const float angle = virtualServoStepPhased(TRI_TAIL_SERVO_ANGLE_MID, 300, 0.001f, &servoConf, &pulse);
+    EXPECT_NEAR(TRI_TAIL_SERVO_ANGLE_MID + 0.3f, angle, 0.0001f);
+}
+
+TEST_F(LinearOutputTest, virtualServoStepPhased_pulseEndedDuringLoop) {
+    // held the middle until the pulse ended 400us ago, then moved towards the new command
+    const servoPulse_t pulse = { .value = DEFAULT_SERVO_MAX, .previousValue = DEFAULT_SERVO_MIDDLE, .ageUs = 400 };
+    const float angle = virtualServoStepPhased(TRI_TAIL_SERVO_ANGLE_MID, 300, 0.001f, &servoConf, &pulse);
+    EXPECT_NEAR(TRI_TAIL_SERVO_ANGLE_MID + 0.12f, angle, 0.0001f);
+}
+
+TEST_F(LinearOutputTest, virtualServoStepPhased_previousCommandReversed) {
+    // moving down for 700us, then up for 300us
+    const servoPulse_t pulse = { .value = DEFAULT_SERVO_MAX, .previousValue = DEFAULT_SERVO_MIN, .ageUs = 300 };
+    const float angle = virtualServoStepPhased(TRI_TAIL_SERVO_ANGLE_MID, 300, 0.001f, &servoConf, &pulse);
+    EXPECT_NEAR(TRI_TAIL_SERVO_ANGLE_MID - 0.21f + 0.09f, angle, 0.0001f);
+}
+
+TEST_F(LinearOutputTest, virtualServoStepPhased_noPreviousPulse) {
+    // a servo that was not driven before only ever had the new command
+    const servoPulse_t pulse = { .value = DEFAULT_SERVO_MAX, .previousValue = 0, .ageUs = 100 };
+    const float angle = virtualServoStepPhased(TRI_TAIL_SERVO_ANGLE_MID, 300, 0.001f, &servoConf, &pulse);
+    EXPECT_NEAR(TRI_TAIL_SERVO_ANGLE_MID + 0.3f, angle, 0.0001f);
+}
+
 //STUBS
 extern "C" {
 
+bool pwmGetServoPulse(uint8_t index, servoPulse_t *pulse) {
+    UNUSED(index);
+    UNUSED(pulse);
+    return false;
+}
+
 //typedef struct master_s {
 //} master_t;
 
@@ -400,6 +470,12 @@ uint16_t adcGetChannel(uint8_t channel) {
     return 0;
 }
 
+bool adcGetOversampledChannel(uint8_t channel, adcOversample_t *result) {
+    UNUSED(channel);
+    UNUSED(result);
+    return false;
+}
+
 float pt1FilterApply(pt1Filter_t *filter, float input) {
     UNUSED(filter);
     UNUSED(input);
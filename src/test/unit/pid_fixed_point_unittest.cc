@@ -0,0 +1,326 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+extern "C" {
+#include "platform.h"
+
+#include "build/debug.h"
+
+#include "common/axis.h"
+#include "common/maths.h"
+#include "common/filter.h"
+
+#include "fc/fc_rc.h"
+#include "fc/runtime_config.h"
+
+#include "flight/imu.h"
+#include "flight/mixer.h"
+#include "flight/mixer_tricopter.h"
+#include "flight/navigation.h"
+#include "flight/pid.h"
+
+#include "sensors/acceleration.h"
+#include "sensors/gyro.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+// pid.c is built with USE_FIXED_POINT_PID for this test, so pidController() and pidControllerFixed()
+// can be run side by side on the same inputs.
+
+#define LOOPTIME_US     125
+#define LOOPS           16000
+
+extern "C" {
+    float testSetpoint[XYZ_AXIS_COUNT];
+    float testTpa;
+    float testMotorMixRange;
+    bool testSaturated;
+    bool testTriMixer;
+}
+
+static pidProfile_t testPidProfile;
+static rollAndPitchTrims_t testTrims;
+
+TEST(FixedPointTest, Fix16Conversions)
+{
+    EXPECT_EQ(Q16, fix16FromFloat(1.0f));
+    EXPECT_EQ(-Q16 / 2, fix16FromFloat(-0.5f));
+    EXPECT_FLOAT_EQ(1234.5f, fix16ToFloat(fix16FromFloat(1234.5f)));
+    EXPECT_EQ(Q30 / 4, q30FromFloat(0.25f));
+
+    // out of range clamps rather than wraps
+    EXPECT_GT(fix16FromFloat(40000.0f), 0);
+    EXPECT_LT(fix16FromFloat(-40000.0f), 0);
+}
+
+TEST(FixedPointTest, Fix16ArithmeticSaturates)
+{
+    EXPECT_EQ(fix16FromFloat(6.0f), fix16Mul(fix16FromFloat(2.0f), fix16FromFloat(3.0f)));
+    EXPECT_EQ(fix16FromFloat(-1.5f), fix16MulQ30(fix16FromFloat(3.0f), q30FromFloat(-0.5f)));
+    EXPECT_EQ(INT32_MAX, fix16Mul(fix16FromFloat(30000.0f), fix16FromFloat(30000.0f)));
+    EXPECT_EQ(INT32_MIN, fix16Mul(fix16FromFloat(-30000.0f), fix16FromFloat(30000.0f)));
+    EXPECT_EQ(INT32_MAX, fix16Add(INT32_MAX, 1));
+    EXPECT_EQ(INT32_MIN, fix16Add(INT32_MIN, -1));
+}
+
+TEST(FixedPointTest, Pt1MatchesFloat)
+{
+    lcgState = 1;
+    for (int cutoff = 10; cutoff <= 250; cutoff += 60) {
+        pt1Filter_t pt1;
+        pt1FilterFix_t pt1Fix;
+        memset(&pt1, 0, sizeof(pt1));
+        pt1FilterInit(&pt1, cutoff, LOOPTIME_US * 1e-6f);
+        pt1FilterInitFix(&pt1Fix, cutoff, LOOPTIME_US * 1e-6f);
+
+        float maxError = 0.0f;
+        for (int i = 0; i < LOOPS; i++) {
+            const float input = lcgRange(-1000.0f, 1000.0f);
+            const float expected = pt1FilterApply(&pt1, input);
+            const float actual = fix16ToFloat(pt1FilterApplyFix(&pt1Fix, fix16FromFloat(input)));
+            maxError = MAX(maxError, fabsf(expected - actual));
+        }
+        EXPECT_LT(maxError, 0.01f) << "cutoff " << cutoff;
+    }
+}
+
+TEST(FixedPointTest, BiquadMatchesFloat)
+{
+    lcgState = 2;
+    for (int cutoff = 20; cutoff <= 320; cutoff += 100) {
+        biquadFilter_t lpf, notch;
+        biquadFilterFix_t lpfFix, notchFix;
+        const float notchQ = filterGetNotchQ(cutoff + 100, cutoff);
+        biquadFilterInitLPF(&lpf, cutoff, LOOPTIME_US);
+        biquadFilterInitLPFFix(&lpfFix, cutoff, LOOPTIME_US);
+        biquadFilterInit(&notch, cutoff + 100, LOOPTIME_US, notchQ, FILTER_NOTCH);
+        biquadFilterInitFix(&notchFix, cutoff + 100, LOOPTIME_US, notchQ, FILTER_NOTCH);
+
+        float maxLpfError = 0.0f;
+        float maxNotchError = 0.0f;
+        for (int i = 0; i < LOOPS; i++) {
+            const float input = lcgRange(-1000.0f, 1000.0f);
+            const fix16_t inputFix = fix16FromFloat(input);
+            maxLpfError = MAX(maxLpfError, fabsf(biquadFilterApply(&lpf, input) - fix16ToFloat(biquadFilterApplyFix(&lpfFix, inputFix))));
+            maxNotchError = MAX(maxNotchError, fabsf(biquadFilterApply(&notch, input) - fix16ToFloat(biquadFilterApplyFix(&notchFix, inputFix))));
+        }
+        EXPECT_LT(maxLpfError, 0.01f) << "cutoff " << cutoff;
+        EXPECT_LT(maxNotchError, 0.01f) << "notch " << cutoff + 100;
+    }
+}
+
+class PidFixedPointTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        memset(&testPidProfile, 0, sizeof(testPidProfile));
+        testPidProfile.P8[PIDROLL] = 45;
+        testPidProfile.I8[PIDROLL] = 40;
+        testPidProfile.D8[PIDROLL] = 20;
+        testPidProfile.P8[PIDPITCH] = 50;
+        testPidProfile.I8[PIDPITCH] = 45;
+        testPidProfile.D8[PIDPITCH] = 25;
+        testPidProfile.P8[PIDYAW] = 70;
+        testPidProfile.I8[PIDYAW] = 45;
+        testPidProfile.D8[PIDYAW] = 20;
+        testPidProfile.P8[PIDLEVEL] = 50;
+        testPidProfile.I8[PIDLEVEL] = 50;
+        testPidProfile.D8[PIDLEVEL] = 100;
+        testPidProfile.dterm_filter_type = FILTER_BIQUAD;
+        testPidProfile.dterm_lpf_hz = 100;
+        testPidProfile.yaw_lpf_hz = 80;
+        testPidProfile.dterm_notch_hz = 260;
+        testPidProfile.dterm_notch_cutoff = 160;
+        testPidProfile.itermWindupPointPercent = 50;
+        testPidProfile.setpointRelaxRatio = 30;
+        testPidProfile.dtermSetpointWeight = 60;
+
+        memset(&gyro, 0, sizeof(gyro));
+        memset(testSetpoint, 0, sizeof(testSetpoint));
+        testTpa = 1.0f;
+        testMotorMixRange = 0.0f;
+        testSaturated = false;
+        testTriMixer = true;
+        flightModeFlags = 0;
+        lcgState = 3;
+    }
+
+    void init(void) {
+        pidSetTargetLooptime(LOOPTIME_US);
+        pidInitConfig(&testPidProfile);
+        pidInitFilters(&testPidProfile);
+        pidStabilisationState(PID_STABILISATION_ON);
+        pidResetErrorGyroState();
+    }
+
+    // Sticks and gyro following them with some lag, plus vibration on the gyro
+    void step(int i) {
+        const float t = i * LOOPTIME_US * 1e-6f;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            const float target = 400.0f * sinf(2 * M_PIf * (0.7f + axis * 0.3f) * t);
+            testSetpoint[axis] = target;
+            gyro.gyroADCf[axis] += (target - gyro.gyroADCf[axis]) * 0.02f + lcgRange(-2.0f, 2.0f);
+            gyro.gyroADCFix[axis] = fix16FromFloat(gyro.gyroADCf[axis]);
+            attitude.raw[axis] = lrintf(gyro.gyroADCf[axis]);     // decidegrees, only the level modes use it
+        }
+        testTpa = 1.0f - 0.3f * (i % 4000) / 4000.0f;
+        testMotorMixRange = 0.9f * ((i + 1000) % 6000) / 6000.0f;
+        testSaturated = (i % 3000) > 2700;
+    }
+
+    // Runs both controllers over the same inputs and returns the largest difference seen per term
+    void compare(float *maxError) {
+        init();
+        // pt1FilterInit() keeps the state of the float filters from the test before, let it settle
+        for (int i = 0; i < 2000; i++) {
+            pidController(&testPidProfile, &testTrims);
+            pidControllerFixed(&testPidProfile, &testTrims);
+        }
+        pidResetErrorGyroState();
+
+        for (int i = 0; i < 3; i++) {
+            maxError[i] = 0.0f;
+        }
+        for (int i = 0; i < LOOPS; i++) {
+            step(i);
+
+            pidController(&testPidProfile, &testTrims);
+            pidControllerFixed(&testPidProfile, &testTrims);
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                maxError[0] = MAX(maxError[0], fabsf(axisPID_P[axis] - fix16ToFloat(axisPIDFix_P[axis])));
+                maxError[1] = MAX(maxError[1], fabsf(axisPID_I[axis] - fix16ToFloat(axisPIDFix_I[axis])));
+                maxError[2] = MAX(maxError[2], fabsf(axisPID_D[axis] - fix16ToFloat(axisPIDFix_D[axis])));
+            }
+        }
+    }
+};
+
+// I terms peak around 45 here, they may differ by an increment when a saturated
+// step is kept by one controller and dropped by the other around zero.
+TEST_F(PidFixedPointTest, BiquadDtermMatchesFloat)
+{
+    float maxError[3];
+    compare(maxError);
+
+    EXPECT_LT(maxError[0], 0.01f);
+    EXPECT_LT(maxError[1], 0.05f);
+    EXPECT_LT(maxError[2], 0.05f);
+}
+
+TEST_F(PidFixedPointTest, Pt1DtermMatchesFloat)
+{
+    testPidProfile.dterm_filter_type = FILTER_PT1;
+    testPidProfile.dterm_notch_hz = 0;
+    testTriMixer = false;
+
+    float maxError[3];
+    compare(maxError);
+
+    EXPECT_LT(maxError[0], 0.01f);
+    EXPECT_LT(maxError[1], 0.05f);
+    EXPECT_LT(maxError[2], 0.05f);
+}
+
+TEST_F(PidFixedPointTest, FirDtermMatchesFloat)
+{
+    testPidProfile.dterm_filter_type = FILTER_FIR;
+    testPidProfile.yaw_lpf_hz = 0;
+
+    float maxError[3];
+    compare(maxError);
+
+    EXPECT_LT(maxError[0], 0.01f);
+    EXPECT_LT(maxError[1], 0.05f);
+    EXPECT_LT(maxError[2], 0.05f);
+}
+
+TEST_F(PidFixedPointTest, LevelModesAndAccelerationLimitMatchFloat)
+{
+    testPidProfile.levelSensitivity = 55;
+    testPidProfile.levelAngleLimit = 55;
+    testPidProfile.rateAccelLimit = 3.0f;
+    testPidProfile.yawRateAccelLimit = 2.0f;
+
+    const uint16_t modes[] = { ANGLE_MODE, HORIZON_MODE };
+    for (unsigned i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+        flightModeFlags = modes[i];
+
+        float maxError[3];
+        compare(maxError);
+
+        // the stick deflection is scaled by levelSensitivity before the level gain, so P is off a little more
+        EXPECT_LT(maxError[0], 0.05f) << "mode " << modes[i];
+        EXPECT_LT(maxError[1], 0.05f) << "mode " << modes[i];
+        EXPECT_LT(maxError[2], 0.05f) << "mode " << modes[i];
+    }
+}
+
+TEST_F(PidFixedPointTest, StabilisationOffClearsTerms)
+{
+    init();
+    for (int i = 0; i < 100; i++) {
+        step(i);
+        pidControllerFixed(&testPidProfile, &testTrims);
+    }
+    EXPECT_NE(0, axisPIDFix_I[FD_ROLL]);
+
+    pidStabilisationState(PID_STABILISATION_OFF);
+    pidControllerFixed(&testPidProfile, &testTrims);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        EXPECT_EQ(0, axisPIDFix_P[axis]);
+        EXPECT_EQ(0, axisPIDFix_I[axis]);
+        EXPECT_EQ(0, axisPIDFix_D[axis]);
+    }
+
+    // the I term starts again from zero
+    pidStabilisationState(PID_STABILISATION_ON);
+    memset(testSetpoint, 0, sizeof(testSetpoint));
+    memset(&gyro, 0, sizeof(gyro));
+    pidControllerFixed(&testPidProfile, &testTrims);
+    EXPECT_EQ(0, axisPIDFix_I[FD_ROLL]);
+}
+
+// STUBS
+
+extern "C" {
+    gyro_t gyro;
+    attitudeEulerAngles_t attitude;
+    int16_t GPS_angle[ANGLE_INDEX_COUNT];
+    uint16_t flightModeFlags;
+    int16_t debug[DEBUG16_VALUE_COUNT];
+    uint8_t debugMode;
+
+    float getSetpointRate(int axis) { return testSetpoint[axis]; }
+    float getRcDeflection(int axis) { return testSetpoint[axis] / 500.0f; }
+    float getRcDeflectionAbs(int axis) { return fabsf(testSetpoint[axis]) / 500.0f; }
+    float getThrottlePIDAttenuation(void) { return testTpa; }
+    fix16_t getSetpointRateFix(int axis) { return fix16FromFloat(getSetpointRate(axis)); }
+    fix16_t getRcDeflectionFix(int axis) { return fix16FromFloat(getRcDeflection(axis)); }
+    fix16_t getRcDeflectionAbsFix(int axis) { return fix16FromFloat(getRcDeflectionAbs(axis)); }
+    fix16_t getThrottlePIDAttenuationFix(void) { return fix16FromFloat(testTpa); }
+    float getMotorMixRange() { return testMotorMixRange; }
+    bool mixerIsOutputSaturated(int, float) { return testSaturated; }
+    bool mixerIsOutputSaturatedFix(int, fix16_t) { return testSaturated; }
+    bool triMixerInUse(void) { return testTriMixer; }
+}
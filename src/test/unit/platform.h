@@ -39,6 +39,7 @@ typedef enum
 } GPIO_Mode;
 
 typedef enum {RESET = 0, SET = !RESET} FlagStatus, ITStatus;
+typedef enum {Bit_RESET = 0, Bit_SET} BitAction;
 typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
 typedef enum {TEST_IRQ = 0 } IRQn_Type;
 typedef enum {
@@ -57,6 +58,11 @@ typedef struct
     void* test;
 } TIM_TypeDef;
 
+typedef struct
+{
+    void* test;
+} TIM_OCInitTypeDef;
+
 typedef struct {
     void* test;
 } DMA_Channel_TypeDef;
@@ -70,7 +76,24 @@ typedef struct
     void* test;
 } USART_TypeDef;
 
+typedef struct
+{
+    void* test;
+} SPI_TypeDef;
+
+typedef struct
+{
+    void* test;
+} I2C_TypeDef;
+
+typedef struct
+{
+    void* test;
+} ADC_TypeDef;
+
 #define WS2811_DMA_TC_FLAG (void *)1
 #define WS2811_DMA_HANDLER_IDENTIFER 0
 
 #include "target.h"
+
+#include "build/fast_memory.h"
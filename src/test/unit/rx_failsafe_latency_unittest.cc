@@ -0,0 +1,343 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "build/debug.h"
+
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/feature.h"
+
+    #include "fc/rc_controls.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/failsafe.h"
+
+    #include "io/beeper.h"
+
+    #include "rx/rx.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Runs rx.c and failsafe.c together on a simulated clock. A stand-in serial receiver delivers frames
+// at a fixed interval, stamped the way the drivers stamp them from the rx interrupt, the PID loop runs
+// every 125us and the rx task runs whenever rxUpdateCheck() asks for it. Each dropout is scripted at a
+// different phase against the loop, and the time from the last frame to the failsafe taking over is
+// compared against the configured deadline.
+
+#define PID_LOOP_US                 125     // 8kHz
+#define RX_FRAME_INTERVAL_US        9000    // SBUS
+#define RX_CHANNEL_COUNT            8
+#define LINK_GOOD_BEFORE_DROP_US    (2 * 1000 * 1000)
+#define DROPOUT_US                  (3 * 1000 * 1000)
+#define DROPOUT_PHASES              36      // last frame spread over the loop period and the frame interval
+
+static uint32_t simTimeUs;
+
+static bool linkOn;
+static timeUs_t nextFrameAt;
+static bool frameDone;
+static timeUs_t frameDoneAt;
+
+static rxConfig_t rxConfig;
+static failsafeConfig_t failsafeConfig;
+static modeActivationCondition_t modeActivationConditions[MAX_MODE_ACTIVATION_CONDITION_COUNT];
+
+static uint16_t fakeReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t channel)
+{
+    UNUSED(rxRuntimeConfig);
+    return channel == THROTTLE ? 1600 : 1500;
+}
+
+static uint8_t fakeFrameStatus(void)
+{
+    if (!frameDone) {
+        return RX_FRAME_PENDING;
+    }
+    frameDone = false;
+    return RX_FRAME_COMPLETE;
+}
+
+static timeUs_t fakeFrameTimeUs(void)
+{
+    return frameDoneAt;
+}
+
+static void configure(void)
+{
+    memset(&rxConfig, 0, sizeof(rxConfig));
+    rxConfig.midrc = 1500;
+    rxConfig.mincheck = 1100;
+    rxConfig.maxcheck = 1900;
+    rxConfig.rx_min_usec = 885;
+    rxConfig.rx_max_usec = 2115;
+    rxConfig.max_aux_channel = RX_CHANNEL_COUNT - NON_AUX_CHANNEL_COUNT;
+    for (int i = 0; i < MAX_MAPPABLE_RX_INPUTS; i++) {
+        rxConfig.rcmap[i] = i;
+    }
+    resetAllRxChannelRangeConfigurations(rxConfig.channelRanges);
+
+    memset(&failsafeConfig, 0, sizeof(failsafeConfig));
+    failsafeConfig.failsafe_delay = 4;      // 0.4s, the default
+    failsafeConfig.failsafe_off_delay = 10;
+    failsafeConfig.failsafe_throttle = 1000;
+    failsafeConfig.failsafe_procedure = FAILSAFE_PROCEDURE_AUTO_LANDING;
+
+    memset(modeActivationConditions, 0, sizeof(modeActivationConditions));
+
+    failsafeInit(&rxConfig, 0);
+}
+
+static void start(uint32_t firstFrameInUs)
+{
+    useFailsafeConfig(&failsafeConfig);
+
+    rxInit(&rxConfig, modeActivationConditions);
+    rxRuntimeConfig.channelCount = RX_CHANNEL_COUNT;
+    rxRuntimeConfig.rxRefreshRate = RX_FRAME_INTERVAL_US;
+    rxRuntimeConfig.rcReadRawFn = fakeReadRawRC;
+    rxRuntimeConfig.rcFrameStatusFn = fakeFrameStatus;
+    rxRuntimeConfig.rcFrameTimeUsFn = fakeFrameTimeUs;
+
+    failsafeStartMonitoring();
+    ENABLE_ARMING_FLAG(ARMED);
+
+    linkOn = true;
+    frameDone = false;
+    nextFrameAt = simTimeUs + firstFrameInUs;
+}
+
+// one pass of the PID loop, with the rx task after it when the scheduler would run it
+static void loop(bool checkDeadline)
+{
+    const uint32_t loopStartUs = simTimeUs;
+    simTimeUs += PID_LOOP_US;
+
+    // frames finish arriving in between, the driver stamps each in its interrupt
+    while (cmpTimeUs(simTimeUs, nextFrameAt) >= 0) {
+        if (linkOn && cmpTimeUs(nextFrameAt, loopStartUs) > 0) {
+            frameDone = true;
+            frameDoneAt = nextFrameAt;
+        }
+        nextFrameAt += RX_FRAME_INTERVAL_US;
+    }
+
+    if (checkDeadline) {
+        failsafeCheckRxDeadline(simTimeUs);
+    }
+
+    if (rxUpdateCheck(simTimeUs, PID_LOOP_US)) {
+        calculateRxChannelsAndUpdateFailsafe(simTimeUs);
+        failsafeUpdateState();
+    }
+}
+
+typedef struct dropoutResult_s {
+    uint32_t linkDownUs;        // last frame to the link being declared down
+    uint32_t failsafeUs;        // last frame to the failsafe procedure starting
+} dropoutResult_t;
+
+static dropoutResult_t runDropout(uint32_t phaseUs, bool checkDeadline)
+{
+    dropoutResult_t result = { 0, 0 };
+
+    start(phaseUs);
+    const uint32_t dropAtUs = simTimeUs + LINK_GOOD_BEFORE_DROP_US + phaseUs;
+    while (cmpTimeUs(simTimeUs, dropAtUs) < 0) {
+        loop(checkDeadline);
+    }
+    EXPECT_TRUE(failsafeIsReceivingRxData());
+    EXPECT_EQ(FAILSAFE_IDLE, failsafePhase());
+
+    linkOn = false;
+    const timeUs_t lastFrameAt = frameDoneAt;
+    const uint32_t dropoutEndUs = simTimeUs + DROPOUT_US;
+    while (cmpTimeUs(simTimeUs, dropoutEndUs) < 0) {
+        loop(checkDeadline);
+        if (!result.linkDownUs && !failsafeIsReceivingRxData()) {
+            result.linkDownUs = simTimeUs - lastFrameAt;
+        }
+        if (!result.failsafeUs && failsafePhase() != FAILSAFE_IDLE) {
+            result.failsafeUs = simTimeUs - lastFrameAt;
+        }
+    }
+
+    DISABLE_ARMING_FLAG(ARMED);
+    return result;
+}
+
+static uint32_t deadlineUs(void)
+{
+    return (PERIOD_RXDATA_FAILURE + failsafeConfig.failsafe_delay * MILLIS_PER_TENTH_SECOND) * 1000;
+}
+
+TEST(RxFailsafeLatencyTest, DropoutsCaughtWithinOnePidLoopOfDeadline)
+{
+    configure();
+    simTimeUs = 10 * 1000 * 1000;
+
+    uint32_t worstUs = 0;
+    for (int n = 0; n < DROPOUT_PHASES; n++) {
+        SCOPED_TRACE(n);
+        const dropoutResult_t result = runDropout(n * (RX_FRAME_INTERVAL_US + PID_LOOP_US) / DROPOUT_PHASES, true);
+
+        ASSERT_GT(result.linkDownUs, 0u);
+        EXPECT_GT(result.linkDownUs, deadlineUs());
+        EXPECT_LE(result.linkDownUs, deadlineUs() + PID_LOOP_US);
+        // the procedure starts in the same loop the link goes down in
+        EXPECT_EQ(result.linkDownUs, result.failsafeUs);
+        worstUs = MAX(worstUs, result.failsafeUs);
+    }
+
+    const failsafeLatency_t *latency = failsafeGetLatency();
+    EXPECT_EQ(DROPOUT_PHASES, latency->detections);
+    EXPECT_EQ(deadlineUs(), latency->deadlineUs);
+    EXPECT_EQ(worstUs, latency->maxUs);
+    EXPECT_GT(latency->minUs, deadlineUs());
+    EXPECT_LE(latency->maxUs, deadlineUs() + PID_LOOP_US);
+
+    printf("[ BENCH    ] deadline %u us, reaction min %u us max %u us over %d dropouts\n",
+        latency->deadlineUs, latency->minUs, latency->maxUs, latency->detections);
+}
+
+TEST(RxFailsafeLatencyTest, DeadlineEarlierThanRxTask)
+{
+    configure();
+    simTimeUs = 10 * 1000 * 1000;
+
+    // without the check in the PID loop the rx task holds the channels first and only notices at 50Hz
+    uint32_t rxTaskBestUs = UINT32_MAX;
+    uint32_t rxTaskWorstUs = 0;
+    for (int n = 0; n < DROPOUT_PHASES; n++) {
+        SCOPED_TRACE(n);
+        const dropoutResult_t result = runDropout(n * (RX_FRAME_INTERVAL_US + PID_LOOP_US) / DROPOUT_PHASES, false);
+        ASSERT_GT(result.failsafeUs, 0u);
+        rxTaskBestUs = MIN(rxTaskBestUs, result.failsafeUs);
+        rxTaskWorstUs = MAX(rxTaskWorstUs, result.failsafeUs);
+    }
+    EXPECT_EQ(0, failsafeGetLatency()->detections);
+
+    EXPECT_GT(rxTaskBestUs, deadlineUs() + PID_LOOP_US);
+
+    printf("[ BENCH    ] rx task only, reaction min %u us max %u us\n", rxTaskBestUs, rxTaskWorstUs);
+}
+
+TEST(RxFailsafeLatencyTest, HeldChannelsDoNotRecoverLink)
+{
+    configure();
+    failsafeConfig.failsafe_delay = 0;      // a deadline inside the channel hold time
+    simTimeUs = 10 * 1000 * 1000;
+
+    start(0);
+    for (int i = 0; i < LINK_GOOD_BEFORE_DROP_US / PID_LOOP_US; i++) {
+        loop(true);
+    }
+    EXPECT_TRUE(failsafeIsReceivingRxData());
+
+    // the rx task keeps reporting the held channels as valid for a while after the link is gone
+    linkOn = false;
+    const uint32_t dropAtUs = simTimeUs;
+    while (simTimeUs - dropAtUs < deadlineUs() + 50 * 1000) {
+        loop(true);
+    }
+    EXPECT_FALSE(failsafeIsReceivingRxData());
+    EXPECT_TRUE(rxAreFlightChannelsValid());
+
+    // frames come back, the link is only up again once they have been good for the recovery period
+    linkOn = true;
+    const uint32_t backAtUs = simTimeUs;
+    while (!failsafeIsReceivingRxData()) {
+        loop(true);
+        ASSERT_LT(simTimeUs - backAtUs, 1000u * 1000);
+    }
+    EXPECT_GE(simTimeUs - backAtUs, PERIOD_RXDATA_RECOVERY * 1000u);
+}
+
+TEST(RxFailsafeLatencyTest, SuspendExtendsDeadline)
+{
+    configure();
+    simTimeUs = 10 * 1000 * 1000;
+
+    start(0);
+    for (int i = 0; i < LINK_GOOD_BEFORE_DROP_US / PID_LOOP_US; i++) {
+        loop(true);
+    }
+
+    // eeprom writes and the like stop the rx, the gap is not a link loss
+    linkOn = false;
+    suspendRxSignal();
+    const uint32_t suspendedAtUs = simTimeUs;
+    while (simTimeUs - suspendedAtUs < deadlineUs() + 100 * 1000) {
+        loop(true);
+    }
+    EXPECT_TRUE(failsafeIsReceivingRxData());
+    EXPECT_EQ(0, failsafeGetLatency()->detections);
+}
+
+// STUBS
+
+extern "C" {
+uint8_t armingFlags;
+uint16_t flightModeFlags;
+uint32_t rcModeActivationMask;
+int16_t debug[DEBUG16_VALUE_COUNT];
+uint8_t debugMode;
+
+uint32_t micros(void) { return simTimeUs; }
+uint32_t millis(void) { return simTimeUs / 1000; }
+
+bool feature(uint32_t) { return false; }
+void featureClear(uint32_t) {}
+
+// the serial drivers are not linked in, feature() keeps rxInit() from opening any of them
+bool sbusInit(const rxConfig_t *, rxRuntimeConfig_t *) { return false; }
+bool spektrumInit(const rxConfig_t *, rxRuntimeConfig_t *) { return false; }
+bool sumdInit(const rxConfig_t *, rxRuntimeConfig_t *) { return false; }
+bool sumhInit(const rxConfig_t *, rxRuntimeConfig_t *) { return false; }
+bool xBusInit(const rxConfig_t *, rxRuntimeConfig_t *) { return false; }
+bool ibusInit(const rxConfig_t *, rxRuntimeConfig_t *) { return false; }
+bool jetiExBusInit(const rxConfig_t *, rxRuntimeConfig_t *) { return false; }
+bool crsfRxInit(const rxConfig_t *, rxRuntimeConfig_t *) { return false; }
+void rxMspInit(const rxConfig_t *, rxRuntimeConfig_t *) {}
+
+throttleStatus_e calculateThrottleStatus(rxConfig_t *, uint16_t) { return THROTTLE_HIGH; }
+bool isUsingSticksForArming(void) { return false; }
+void mwDisarm(void) { DISABLE_ARMING_FLAG(ARMED); }
+void beeper(beeperMode_e) {}
+
+uint16_t enableFlightMode(flightModeFlags_e mask)
+{
+    flightModeFlags |= (mask);
+    return flightModeFlags;
+}
+
+uint16_t disableFlightMode(flightModeFlags_e mask)
+{
+    flightModeFlags &= ~(mask);
+    return flightModeFlags;
+}
+}
@@ -0,0 +1,584 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+
+extern "C" {
+    #include <platform.h>
+
+    #include "build/debug.h"
+
+    #include "common/maths.h"
+    #include "common/utils.h"
+
+    #include "config/feature.h"
+
+    #include "fc/fc_dispatch.h"
+
+    #include "io/serial.h"
+
+    #include "rx/rx.h"
+    #include "rx/sbus.h"
+    #include "rx/crsf.h"
+    #include "rx/ibus.h"
+    #include "rx/spektrum.h"
+    #include "rx/sumd.h"
+    #include "rx/xbus.h"
+
+    #include "telemetry/telemetry.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Drives each serial rx decoder through a stand-in serial port on a simulated clock. Bytes arrive at
+// the baud rate and framing the decoder opens its port with, and the frame status is polled at the
+// cadence rxUpdateCheck() is called at, so the latency figures are exact and repeatable. Only the
+// ns per byte and ns per frame figures are host wall clock timings.
+
+#define RX_UPDATE_CHECK_INTERVAL_US 125     // the rx task is checked every pass of an 8kHz loop
+#define RX_IDLE_RESET_US            20000   // longer than any decoder's inter frame timeout
+#define RX_FRAME_SIZE_MAX           64
+#define RX_TEST_FRAMES              1000
+#define RX_BENCH_FRAMES             20000
+#define RX_BYTE_JITTER_MAX_NS       5000    // extra idle between bytes, uart fifo and tx scheduling
+
+static uint64_t simTimeNs;
+
+static serialReceiveCallbackPtr portCallback;
+static uint32_t portBaudRate;
+static portOptions_t portOptions;
+static serialPort_t port;
+static serialPortConfig_t portConfig;
+
+static uint32_t fuzzSeed;
+
+static uint32_t fuzzRandom(void)
+{
+    // xorshift32, the same sequence on every run
+    fuzzSeed ^= fuzzSeed << 13;
+    fuzzSeed ^= fuzzSeed >> 17;
+    fuzzSeed ^= fuzzSeed << 5;
+    return fuzzSeed;
+}
+
+static void putU16BigEndian(uint8_t *buf, uint16_t value)
+{
+    buf[0] = value >> 8;
+    buf[1] = value & 0xff;
+}
+
+static void putU16LittleEndian(uint8_t *buf, uint16_t value)
+{
+    buf[0] = value & 0xff;
+    buf[1] = value >> 8;
+}
+
+// 11 bit channels, least significant bit first, as SBUS and CRSF carry them
+static void pack11(uint8_t *buf, const uint16_t *values, int count)
+{
+    memset(buf, 0, (count * 11 + 7) / 8);
+    for (int i = 0; i < count; i++) {
+        for (int bit = 0; bit < 11; bit++) {
+            if (values[i] & (1 << bit)) {
+                const int n = i * 11 + bit;
+                buf[n / 8] |= 1 << (n % 8);
+            }
+        }
+    }
+}
+
+static uint16_t crc16Ccitt(const uint8_t *buf, int len)
+{
+    uint16_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= buf[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static int encodeSbus(uint8_t *frame, const uint16_t *us)
+{
+    uint16_t raw[16];
+    for (int i = 0; i < 16; i++) {
+        raw[i] = (us[i] - 880) * 8 / 5;
+    }
+    frame[0] = 0x0F;
+    pack11(&frame[1], raw, 16);
+    frame[23] = 0;  // flags
+    frame[24] = 0;
+    return 25;
+}
+
+static int encodeCrsf(uint8_t *frame, const uint16_t *us)
+{
+    uint16_t raw[CRSF_MAX_CHANNEL];
+    for (int i = 0; i < CRSF_MAX_CHANNEL; i++) {
+        raw[i] = (us[i] - 881) / 0.62477120195241f + 0.5f;
+    }
+    frame[0] = CRSF_ADDRESS_COLIBRI_RACE_FC;
+    frame[1] = CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC;
+    frame[2] = CRSF_FRAMETYPE_RC_CHANNELS_PACKED;
+    pack11(&frame[3], raw, CRSF_MAX_CHANNEL);
+    uint8_t crc = 0;
+    for (int i = 2; i < 3 + CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE; i++) {
+        crc = crc8_dvb_s2(crc, frame[i]);
+    }
+    frame[3 + CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE] = crc;
+    return 4 + CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE;
+}
+
+static int encodeIbus(uint8_t *frame, const uint16_t *us)
+{
+    // IA6B
+    frame[0] = 0x20;
+    frame[1] = 0x40;
+    for (int i = 0; i < 14; i++) {
+        putU16LittleEndian(&frame[2 + i * 2], us[i]);
+    }
+    uint16_t checksum = 0xFFFF;
+    for (int i = 0; i < 30; i++) {
+        checksum -= frame[i];
+    }
+    putU16LittleEndian(&frame[30], checksum);
+    return 32;
+}
+
+static int encodeSpektrum(uint8_t *frame, const uint16_t *us)
+{
+    // 2048 mode, seven channels a frame
+    frame[0] = 0;   // fades
+    frame[1] = 0;
+    for (int i = 0; i < 7; i++) {
+        putU16BigEndian(&frame[2 + i * 2], (i << 11) | ((us[i] - 988) * 2));
+    }
+    return SPEK_FRAME_SIZE;
+}
+
+static int encodeSumd(uint8_t *frame, const uint16_t *us)
+{
+    frame[0] = 0xA8;
+    frame[1] = 0x01;
+    frame[2] = 16;
+    for (int i = 0; i < 16; i++) {
+        putU16BigEndian(&frame[3 + i * 2], us[i] * 8);
+    }
+    putU16BigEndian(&frame[35], crc16Ccitt(frame, 35));
+    return 37;
+}
+
+static int encodeXBus(uint8_t *frame, const uint16_t *us)
+{
+    // mode B, 12 channels
+    frame[0] = 0xA1;
+    for (int i = 0; i < 12; i++) {
+        putU16BigEndian(&frame[1 + i * 2], ((us[i] - 800) * 4096 + 1399) / 1400);
+    }
+    putU16BigEndian(&frame[25], crc16Ccitt(frame, 25));
+    return 27;
+}
+
+typedef struct rxProtocol_s {
+    const char *name;
+    SerialRXType provider;
+    bool (*init)(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig);
+    int (*encode)(uint8_t *frame, const uint16_t *us);
+    uint8_t channelCount;       // channels each frame carries
+    bool checked;               // frames carry a CRC or checksum
+    uint32_t frameIntervalUs;
+} rxProtocol_t;
+
+static const rxProtocol_t protocols[] = {
+    { "SBUS",     SERIALRX_SBUS,         sbusInit,     encodeSbus,     16, false, 9000 },
+    { "CRSF",     SERIALRX_CRSF,         crsfRxInit,   encodeCrsf,     16, true,  4000 },
+    { "IBUS",     SERIALRX_IBUS,         ibusInit,     encodeIbus,     14, true,  7000 },
+    { "SPEKTRUM", SERIALRX_SPEKTRUM2048, spektrumInit, encodeSpektrum, 7,  false, 11000 },
+    { "SUMD",     SERIALRX_SUMD,         sumdInit,     encodeSumd,     16, true,  10000 },
+    { "XBUS",     SERIALRX_XBUS_MODE_B,  xBusInit,     encodeXBus,     12, true,  14000 },
+};
+
+typedef enum {
+    FUZZ_NONE = 0,
+    FUZZ_TRUNCATE,      // every other frame cut short
+    FUZZ_CORRUPT,       // one bit flipped in every other frame
+    FUZZ_BACK_TO_BACK,  // bursts of four frames without idle between them
+    FUZZ_BACK_TO_BACK_CORRUPT
+} fuzz_e;
+
+typedef struct rxRunStats_s {
+    int framesSent;
+    int cleanSent;          // neither cut nor flipped, and after an idle gap
+    int cleanDecoded;
+    int decoded;            // reported complete with the channels sent
+    int wrong;              // reported complete with channels that were never sent
+    uint32_t latencyMinUs;  // last byte to the rxUpdateCheck() that sees the frame
+    uint32_t latencyMaxUs;
+    uint32_t frameTimeErrorMaxUs;   // rcFrameTimeUsFn() against the arrival of the last byte
+    uint32_t airtimeUs;
+} rxRunStats_t;
+
+typedef struct rxRun_s {
+    const rxProtocol_t *protocol;
+    rxRuntimeConfig_t runtimeConfig;
+    uint32_t byteTimeNs;
+    uint64_t nextCheckNs;
+    // the last frame fed in full, until it is reported
+    bool pending;
+    bool pendingClean;
+    uint64_t pendingAtNs;
+    uint16_t pendingUs[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    rxRunStats_t stats;
+} rxRun_t;
+
+static void rxUpdateCheckAt(rxRun_t *run)
+{
+    simTimeNs = run->nextCheckNs;
+    run->nextCheckNs += RX_UPDATE_CHECK_INTERVAL_US * 1000;
+
+    const uint8_t frameStatus = run->runtimeConfig.rcFrameStatusFn();
+    if (!(frameStatus & RX_FRAME_COMPLETE)) {
+        return;
+    }
+
+    bool match = run->pending;
+    for (int i = 0; match && i < run->protocol->channelCount; i++) {
+        const int us = run->runtimeConfig.rcReadRawFn(&run->runtimeConfig, i);
+        match = ABS(us - run->pendingUs[i]) <= 1;
+    }
+    if (!match) {
+        run->stats.wrong++;
+        return;
+    }
+
+    run->stats.decoded++;
+    if (run->pendingClean) {
+        run->stats.cleanDecoded++;
+    }
+    const uint32_t latencyUs = (simTimeNs - run->pendingAtNs) / 1000;
+    const uint32_t frameTimeErrorUs = ABS((int32_t)(run->runtimeConfig.rcFrameTimeUsFn() - (uint32_t)(run->pendingAtNs / 1000)));
+    run->stats.frameTimeErrorMaxUs = MAX(run->stats.frameTimeErrorMaxUs, frameTimeErrorUs);
+    run->stats.latencyMinUs = MIN(run->stats.latencyMinUs, latencyUs);
+    run->stats.latencyMaxUs = MAX(run->stats.latencyMaxUs, latencyUs);
+    run->pending = false;
+}
+
+// lets the clock run to the given time, checking for frames on the way
+static void idleUntil(rxRun_t *run, uint64_t timeNs)
+{
+    while (run->nextCheckNs <= timeNs) {
+        rxUpdateCheckAt(run);
+    }
+    simTimeNs = timeNs;
+}
+
+static void receiveByte(rxRun_t *run, uint8_t c, uint32_t jitterNs)
+{
+    // the callback runs from the rx interrupt once the stop bit is in
+    idleUntil(run, simTimeNs + run->byteTimeNs + jitterNs);
+    portCallback(c);
+}
+
+static void rxRunInit(rxRun_t *run, const rxProtocol_t *protocol)
+{
+    memset(run, 0, sizeof(*run));
+    run->protocol = protocol;
+
+    rxConfig_t rxConfig;
+    memset(&rxConfig, 0, sizeof(rxConfig));
+    rxConfig.serialrx_provider = protocol->provider;
+    rxConfig.midrc = 1500;
+
+    portCallback = NULL;
+    EXPECT_TRUE(protocol->init(&rxConfig, &run->runtimeConfig));
+    EXPECT_TRUE(portCallback != NULL);
+
+    const int bits = 1 + 8 + ((portOptions & SERIAL_PARITY_EVEN) ? 1 : 0) + ((portOptions & SERIAL_STOPBITS_2) ? 2 : 1);
+    run->byteTimeNs = bits * 1000000000ULL / portBaudRate;
+
+    // let every decoder time out whatever the last run left behind
+    simTimeNs += RX_IDLE_RESET_US * 1000;
+    run->nextCheckNs = simTimeNs;
+
+    run->stats.latencyMinUs = UINT32_MAX;
+}
+
+static void rxRunFrames(rxRun_t *run, fuzz_e fuzz, int frameCount, bool jitter)
+{
+    uint8_t frame[RX_FRAME_SIZE_MAX];
+    uint16_t us[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    const rxProtocol_t *protocol = run->protocol;
+    const bool backToBack = fuzz == FUZZ_BACK_TO_BACK || fuzz == FUZZ_BACK_TO_BACK_CORRUPT;
+
+    uint64_t frameStartNs = simTimeNs;
+    for (int n = 0; n < frameCount; n++) {
+        const bool afterGap = !backToBack || (n % 4) == 0;
+        if (afterGap) {
+            idleUntil(run, frameStartNs);
+        }
+
+        for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+            us[i] = 1000 + fuzzRandom() % 1001;
+        }
+        int length = protocol->encode(frame, us);
+        run->stats.airtimeUs = length * run->byteTimeNs / 1000;
+
+        bool truncated = false;
+        bool corrupted = false;
+        if (fuzz == FUZZ_TRUNCATE && (n & 1)) {
+            length = 1 + fuzzRandom() % (length - 1);
+            truncated = true;
+        } else if ((fuzz == FUZZ_CORRUPT && (n & 1)) || (fuzz == FUZZ_BACK_TO_BACK_CORRUPT && (fuzzRandom() % 4) == 0)) {
+            const int bit = fuzzRandom() % (length * 8);
+            frame[bit / 8] ^= 1 << (bit % 8);
+            corrupted = true;
+        }
+
+        for (int i = 0; i < length; i++) {
+            receiveByte(run, frame[i], jitter ? fuzzRandom() % RX_BYTE_JITTER_MAX_NS : 0);
+        }
+
+        run->stats.framesSent++;
+        if (!truncated) {
+            run->pending = true;
+            run->pendingClean = !corrupted && afterGap;
+            run->pendingAtNs = simTimeNs;
+            memcpy(run->pendingUs, us, sizeof(us));
+            if (run->pendingClean) {
+                run->stats.cleanSent++;
+            }
+        }
+        frameStartNs += protocol->frameIntervalUs * 1000ULL;
+    }
+    idleUntil(run, frameStartNs);
+}
+
+static rxRunStats_t rxRun(const rxProtocol_t *protocol, fuzz_e fuzz, int frameCount, bool jitter)
+{
+    rxRun_t run;
+    fuzzSeed = 0x12345678;
+    rxRunInit(&run, protocol);
+    rxRunFrames(&run, fuzz, frameCount, jitter);
+    return run.stats;
+}
+
+TEST(RxSerialTest, CleanFramesAllDecoded)
+{
+    for (const rxProtocol_t &protocol : protocols) {
+        SCOPED_TRACE(protocol.name);
+        const rxRunStats_t stats = rxRun(&protocol, FUZZ_NONE, RX_TEST_FRAMES, false);
+        EXPECT_EQ(RX_TEST_FRAMES, stats.cleanDecoded);
+        EXPECT_EQ(0, stats.wrong);
+        // a frame is picked up by the first check after its last byte
+        EXPECT_LE(stats.latencyMaxUs, (uint32_t)RX_UPDATE_CHECK_INTERVAL_US);
+        // and stamped with the arrival of that byte, not the time of the check
+        EXPECT_EQ(0u, stats.frameTimeErrorMaxUs);
+    }
+}
+
+TEST(RxSerialTest, ByteJitterTolerated)
+{
+    for (const rxProtocol_t &protocol : protocols) {
+        SCOPED_TRACE(protocol.name);
+        const rxRunStats_t stats = rxRun(&protocol, FUZZ_NONE, RX_TEST_FRAMES, true);
+        EXPECT_EQ(RX_TEST_FRAMES, stats.cleanDecoded);
+        EXPECT_EQ(0, stats.wrong);
+    }
+}
+
+TEST(RxSerialTest, TruncatedFramesDropped)
+{
+    for (const rxProtocol_t &protocol : protocols) {
+        SCOPED_TRACE(protocol.name);
+        const rxRunStats_t stats = rxRun(&protocol, FUZZ_TRUNCATE, RX_TEST_FRAMES, false);
+        // the frame after a short one decodes, the short one is never reported
+        EXPECT_EQ(RX_TEST_FRAMES / 2, stats.cleanSent);
+        EXPECT_EQ(stats.cleanSent, stats.cleanDecoded);
+        EXPECT_EQ(0, stats.wrong);
+    }
+}
+
+TEST(RxSerialTest, CorruptedFramesRejected)
+{
+    for (const rxProtocol_t &protocol : protocols) {
+        SCOPED_TRACE(protocol.name);
+        const rxRunStats_t stats = rxRun(&protocol, FUZZ_CORRUPT, RX_TEST_FRAMES, false);
+        EXPECT_EQ(RX_TEST_FRAMES / 2, stats.cleanSent);
+        EXPECT_EQ(stats.cleanSent, stats.cleanDecoded);
+        if (protocol.checked) {
+            // a single bit error never gets past a CRC or checksum
+            EXPECT_EQ(0, stats.wrong);
+        } else {
+            // nothing to catch it with, but the decoder is back in step for the next frame
+            EXPECT_GT(stats.wrong, 0);
+        }
+    }
+}
+
+TEST(RxSerialTest, BackToBackFramesResync)
+{
+    for (const rxProtocol_t &protocol : protocols) {
+        SCOPED_TRACE(protocol.name);
+        rxRunStats_t stats = rxRun(&protocol, FUZZ_BACK_TO_BACK, RX_TEST_FRAMES, false);
+        // the first of every burst after idle decodes
+        EXPECT_EQ(RX_TEST_FRAMES / 4, stats.cleanSent);
+        EXPECT_EQ(stats.cleanSent, stats.cleanDecoded);
+        if (protocol.checked) {
+            EXPECT_EQ(0, stats.wrong);
+        }
+
+        // corrupt lengths and channel counts in a continuous stream stay inside the frame buffers
+        stats = rxRun(&protocol, FUZZ_BACK_TO_BACK_CORRUPT, RX_TEST_FRAMES, false);
+        EXPECT_EQ(stats.cleanSent, stats.cleanDecoded);
+        if (protocol.checked) {
+            EXPECT_EQ(0, stats.wrong);
+        }
+    }
+}
+
+TEST(RxSerialTest, CrsfCorruptLengthBounded)
+{
+    rxRun_t run;
+    fuzzSeed = 0x12345678;
+    rxRunInit(&run, &protocols[1]);
+
+    // a length byte far beyond the frame buffer followed by a stream of bytes inside the frame time
+    receiveByte(&run, CRSF_ADDRESS_COLIBRI_RACE_FC, 0);
+    receiveByte(&run, 0xF0, 0);
+    receiveByte(&run, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, 0);
+    for (int i = 0; i < CRSF_FRAME_SIZE_MAX; i++) {
+        receiveByte(&run, 0x55, 0);
+    }
+    idleUntil(&run, simTimeNs + RX_IDLE_RESET_US * 1000);
+    EXPECT_EQ(0, run.stats.wrong);
+
+    rxRunFrames(&run, FUZZ_NONE, 10, false);
+    EXPECT_EQ(10, run.stats.cleanDecoded);
+}
+
+TEST(RxSerialTest, SumdCorruptChannelCountDropped)
+{
+    rxRun_t run;
+    fuzzSeed = 0x12345678;
+    rxRunInit(&run, &protocols[4]);
+
+    // more channels than the buffer holds, with the next frame straight after
+    uint8_t frame[RX_FRAME_SIZE_MAX];
+    uint16_t us[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+        us[i] = 1500;
+    }
+    const int length = encodeSumd(frame, us);
+    frame[2] = 17;
+    for (int i = 0; i < length; i++) {
+        receiveByte(&run, frame[i], 0);
+    }
+    idleUntil(&run, simTimeNs + run.byteTimeNs * 4);
+    EXPECT_EQ(0, run.stats.wrong);
+
+    rxRunFrames(&run, FUZZ_NONE, 10, false);
+    EXPECT_EQ(10, run.stats.cleanDecoded);
+}
+
+// Host timing only, the regression table to compare before and after a decoder change
+TEST(RxSerialTest, Benchmark)
+{
+    printf("[ BENCH    ] %-8s %6s %5s %6s %8s %9s %11s %9s %14s %13s\n",
+        "protocol", "baud", "bytes", "air us", "ns/byte", "ns/frame", "latency us", "truncated", "corrupt ok/bad", "b2b ok/bad");
+
+    for (const rxProtocol_t &protocol : protocols) {
+        rxRun_t run;
+        fuzzSeed = 0x12345678;
+        rxRunInit(&run, &protocol);
+
+        // a recorded stream of back to back frames
+        uint8_t frame[RX_FRAME_SIZE_MAX];
+        uint16_t us[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+        for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+            us[i] = 1000 + fuzzRandom() % 1001;
+        }
+        const int length = protocol.encode(frame, us);
+
+        double byteNs = 0;
+        double frameNs = 0;
+        for (int n = 0; n < RX_BENCH_FRAMES; n++) {
+            simTimeNs += protocol.frameIntervalUs * 1000ULL;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < length; i++) {
+                portCallback(frame[i]);
+            }
+            auto stop = std::chrono::steady_clock::now();
+            byteNs += std::chrono::duration<double, std::nano>(stop - start).count();
+
+            start = std::chrono::steady_clock::now();
+            run.runtimeConfig.rcFrameStatusFn();
+            for (int i = 0; i < run.runtimeConfig.channelCount; i++) {
+                run.runtimeConfig.rcReadRawFn(&run.runtimeConfig, i);
+            }
+            stop = std::chrono::steady_clock::now();
+            frameNs += std::chrono::duration<double, std::nano>(stop - start).count();
+        }
+
+        const rxRunStats_t clean = rxRun(&protocol, FUZZ_NONE, RX_TEST_FRAMES, true);
+        const rxRunStats_t truncated = rxRun(&protocol, FUZZ_TRUNCATE, RX_TEST_FRAMES, false);
+        const rxRunStats_t corrupt = rxRun(&protocol, FUZZ_CORRUPT, RX_TEST_FRAMES, false);
+        const rxRunStats_t backToBack = rxRun(&protocol, FUZZ_BACK_TO_BACK, RX_TEST_FRAMES, false);
+
+        char latency[16];
+        char corruptResult[16];
+        char backToBackResult[16];
+        snprintf(latency, sizeof(latency), "%u-%u", (unsigned)clean.latencyMinUs, (unsigned)clean.latencyMaxUs);
+        snprintf(corruptResult, sizeof(corruptResult), "%d/%d", corrupt.decoded, corrupt.wrong);
+        snprintf(backToBackResult, sizeof(backToBackResult), "%d/%d", backToBack.decoded, backToBack.wrong);
+        printf("[ BENCH    ] %-8s %6u %5d %6u %8.1f %9.1f %11s %4d/%-4d %14s %13s\n",
+            protocol.name, (unsigned)portBaudRate, length, (unsigned)clean.airtimeUs,
+            byteNs / (RX_BENCH_FRAMES * length), frameNs / RX_BENCH_FRAMES, latency,
+            truncated.cleanDecoded, truncated.cleanSent, corruptResult, backToBackResult);
+    }
+}
+
+// STUBS
+
+extern "C" {
+
+int16_t debug[DEBUG16_VALUE_COUNT];
+
+uint32_t micros(void) {return simTimeNs / 1000;}
+
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr callback, uint32_t baudRate, portMode_t, portOptions_t options)
+{
+    portCallback = callback;
+    portBaudRate = baudRate;
+    portOptions = options;
+    return &port;
+}
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) {return &portConfig;}
+void serialWriteBuf(serialPort_t *, const uint8_t *, int) {}
+bool telemetryCheckRxPortShared(const serialPortConfig_t *) {return false;}
+serialPort_t *telemetrySharedPort = NULL;
+bool feature(uint32_t) {return false;}
+void dispatchEnable(void) {}
+void dispatchAdd(dispatchEntry_t *, int) {}
+}
@@ -0,0 +1,636 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/utils.h"
+
+    #include "drivers/io.h"
+    #include "drivers/pwm_output.h"
+    #include "drivers/serial.h"
+
+    #include "io/serial_4way.h"
+
+    uint16_t _crc_xmodem_update(uint16_t crc, uint8_t data);
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+/*
+ * The interface runs against a simulated BLHeli SiLabs bootloader on the one-wire line, bit by bit.
+ * micros() advances with every call, so the busy waits of the bit-banged UART take simulated time.
+ * The host link is a USB-UART at 115200 baud as found on F1 boards, with the latency of its driver
+ * between a response and the next command.
+ */
+
+#define ESC_BIT_US          (1000000.0 / 19200)
+#define ESC_TURNAROUND_US   100         // from the stop bit of a command to the start bit of the answer
+#define ESC_ERASE_US        20000       // per 512 byte page
+#define ESC_PROGRAM_BYTE_US 30
+#define ESC_PAGE_SIZE       512
+
+#define HOST_BYTE_US        87          // 115200 8N1
+#define HOST_TURNAROUND_US  1000
+
+#define IMAGE_SIZE          (16 * 1024)
+#define BLOCK_SIZE          256
+
+#define CMD_INTERFACE_EXIT  0x34
+#define CMD_DEVICE_INIT     0x37
+#define CMD_PAGE_ERASE      0x39
+#define CMD_DEVICE_READ     0x3A
+#define CMD_DEVICE_WRITE    0x3B
+#define CMD_VERIFY_CRC      0x41
+
+#define ACK_OK              0x00
+#define ACK_I_VERIFY_ERROR  0x04
+
+#define brSUCCESS           0x30
+#define brERRORCOMMAND      0xC1
+#define brERRORCRC          0xC2
+
+static uint32_t simUs;
+static bool escOutput;
+static bool escDriveLevel = true;
+
+static uint16_t bootloaderCrc(const uint8_t *data, int length)
+{
+    uint16_t crc = 0;
+    for (int i = 0; i < length; i++) {
+        uint8_t xb = data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            if ((xb ^ crc) & 0x01) {
+                crc = (crc >> 1) ^ 0xA001;
+            } else {
+                crc >>= 1;
+            }
+            xb >>= 1;
+        }
+    }
+    return crc;
+}
+
+class SimBootloader {
+public:
+    uint8_t flash[IMAGE_SIZE];
+    bool connected = false;
+    int framingErrors = 0;
+    int crcErrors = 0;
+    int bytesReceived = 0;
+    int bytesSent = 0;
+    double longestBurstUs = 0;  // longest transmission of the interface, from its first start bit to the last stop bit
+
+    void reset(void)
+    {
+        memset(flash, 0xFF, sizeof(flash));
+        connected = false;
+        framingErrors = crcErrors = bytesReceived = bytesSent = 0;
+        longestBurstUs = 0;
+        expectBuffer = 0;
+        answer.clear();
+        edges.clear();
+    }
+
+    void beginBurst(void)
+    {
+        edges.clear();
+    }
+
+    void drive(bool level)
+    {
+        edges.push_back(std::make_pair((double)simUs, level));
+    }
+
+    // the interface released the line, decode what it sent
+    void endBurst(void)
+    {
+        std::vector<uint8_t> bytes;
+        double burstEndUs = 0;
+        double firstStartUs = -1;
+        double searchFromUs = 0;
+
+        cursor = 0;
+        for (;;) {
+            const double startUs = nextFallingEdge(searchFromUs);
+            if (startUs < 0) {
+                break;
+            }
+            if (firstStartUs < 0) {
+                firstStartUs = startUs;
+            }
+            uint16_t frame = 0;
+            for (int bit = 0; bit < 10; bit++) {
+                if (levelAt(startUs + (bit + 0.5) * ESC_BIT_US)) {
+                    frame |= 1 << bit;
+                }
+            }
+            if ((frame & 0x001) || !(frame & 0x200)) {
+                if (connected) {
+                    framingErrors++;
+                }
+            }
+            bytes.push_back((frame >> 1) & 0xFF);
+            burstEndUs = startUs + 10 * ESC_BIT_US;
+            searchFromUs = startUs + 9.5 * ESC_BIT_US;
+        }
+        edges.clear();
+
+        if (bytes.empty()) {
+            return;
+        }
+        longestBurstUs = std::max(longestBurstUs, burstEndUs - firstStartUs);
+        bytesReceived += bytes.size();
+        handle(bytes, burstEndUs);
+    }
+
+    bool lineLevel(void) const
+    {
+        const double t = simUs;
+        if (answer.empty() || t < answerStartUs) {
+            return true;
+        }
+        const int index = (int)((t - answerStartUs) / (10 * ESC_BIT_US));
+        if (index >= (int)answer.size()) {
+            return true;
+        }
+        const int bit = (int)((t - answerStartUs - index * 10 * ESC_BIT_US) / ESC_BIT_US);
+        if (bit == 0) {
+            return false;
+        }
+        if (bit == 9) {
+            return true;
+        }
+        return (answer[index] >> (bit - 1)) & 1;
+    }
+
+private:
+    std::vector<std::pair<double, bool>> edges;
+    std::vector<uint8_t> answer;
+    double answerStartUs = 0;
+    int expectBuffer = 0;
+    uint16_t address = 0;
+    std::vector<uint8_t> buffer;
+
+    size_t cursor;              // edges are decoded in time order
+
+    bool levelAt(double t)
+    {
+        while (cursor + 1 < edges.size() && edges[cursor + 1].first <= t) {
+            cursor++;
+        }
+        return edges[cursor].first <= t ? edges[cursor].second : true;
+    }
+
+    double nextFallingEdge(double fromUs)
+    {
+        for (; cursor + 1 < edges.size(); cursor++) {
+            if (edges[cursor + 1].first >= fromUs && edges[cursor].second && !edges[cursor + 1].second) {
+                cursor++;
+                return edges[cursor].first;
+            }
+        }
+        return -1;
+    }
+
+    void respond(const std::vector<uint8_t> &bytes, double startUs)
+    {
+        answer = bytes;
+        answerStartUs = startUs;
+        bytesSent += bytes.size();
+    }
+
+    void respond(uint8_t result, double startUs)
+    {
+        respond(std::vector<uint8_t>(1, result), startUs);
+    }
+
+    bool crcMatches(const std::vector<uint8_t> &bytes)
+    {
+        const int length = bytes.size() - 2;
+        const uint16_t crc = bytes[length] | (bytes[length + 1] << 8);
+        if (length < 1 || bootloaderCrc(bytes.data(), length) != crc) {
+            crcErrors++;
+            return false;
+        }
+        return true;
+    }
+
+    void handle(const std::vector<uint8_t> &bytes, double endUs)
+    {
+        const double replyUs = endUs + ESC_TURNAROUND_US;
+
+        static const uint8_t signature[] = { 'B', 'L', 'H', 'e', 'l', 'i' };
+        if (bytes.size() >= sizeof(signature) + 2
+            && memcmp(&bytes[bytes.size() - sizeof(signature) - 2], signature, sizeof(signature)) == 0) {
+            // "471c", EFM8BB21 signature, bootloader version, pages
+            respond({ '4', '7', '1', 'c', 0xE8, 0xB2, 0x06, 0x20, brSUCCESS }, replyUs);
+            connected = true;
+            expectBuffer = 0;
+            return;
+        }
+        if (!connected) {
+            return;
+        }
+
+        if (bytes.size() < 3 || !crcMatches(bytes)) {
+            expectBuffer = 0;
+            respond(brERRORCRC, replyUs);
+            return;
+        }
+
+        if (expectBuffer) {
+            const bool complete = ((int)bytes.size() - 2 == expectBuffer);
+            buffer.assign(bytes.begin(), bytes.end() - 2);
+            expectBuffer = 0;
+            respond(complete ? brSUCCESS : brERRORCRC, replyUs);
+            return;
+        }
+
+        switch (bytes[0]) {
+        case 0xFF:
+            address = (bytes[2] << 8) | bytes[3];
+            respond(brSUCCESS, replyUs);
+            break;
+        case 0xFE:
+            // no answer, the buffer follows
+            expectBuffer = (bytes[2] << 8) | bytes[3];
+            break;
+        case 0x01:
+            for (size_t i = 0; i < buffer.size() && address + i < sizeof(flash); i++) {
+                flash[address + i] &= buffer[i];
+            }
+            respond(brSUCCESS, replyUs + ESC_PROGRAM_BYTE_US * buffer.size());
+            break;
+        case 0x02:
+            memset(&flash[address & ~(ESC_PAGE_SIZE - 1)], 0xFF, ESC_PAGE_SIZE);
+            respond(brSUCCESS, replyUs + ESC_ERASE_US);
+            break;
+        case 0x03: {
+            const int length = bytes[1] ? bytes[1] : 256;
+            std::vector<uint8_t> data(&flash[address], &flash[address + length]);
+            const uint16_t crc = bootloaderCrc(data.data(), length);
+            data.push_back(crc & 0xFF);
+            data.push_back(crc >> 8);
+            data.push_back(brSUCCESS);
+            respond(data, replyUs);
+            break;
+        }
+        case 0x00:
+            connected = false;
+            break;
+        default:
+            respond(brERRORCOMMAND, replyUs);
+            break;
+        }
+    }
+};
+
+static SimBootloader bootloader;
+
+static std::deque<uint8_t> hostToFc;
+static std::vector<uint8_t> fcToHost;
+static bool responseSent;
+static uint32_t hostLinkUs;
+
+static void hostCommand(uint8_t command, uint16_t address, const uint8_t *params, int length)
+{
+    std::vector<uint8_t> frame = { 0x2F, command, (uint8_t)(address >> 8), (uint8_t)(address & 0xFF), (uint8_t)length };
+    frame.insert(frame.end(), params, params + (length ? length : 256));
+
+    uint16_t crc = 0;
+    for (uint8_t b : frame) {
+        crc = _crc_xmodem_update(crc, b);
+    }
+    frame.push_back(crc >> 8);
+    frame.push_back(crc & 0xFF);
+    hostToFc.insert(hostToFc.end(), frame.begin(), frame.end());
+}
+
+static void hostCommand(uint8_t command, uint16_t address, uint8_t param)
+{
+    hostCommand(command, address, &param, 1);
+}
+
+typedef struct hostResponse_s {
+    uint8_t command;
+    std::vector<uint8_t> params;
+    uint8_t ack;
+} hostResponse_t;
+
+static std::vector<hostResponse_t> hostResponses(void)
+{
+    std::vector<hostResponse_t> responses;
+    size_t i = 0;
+    while (i + 8 <= fcToHost.size()) {
+        EXPECT_EQ(0x2E, fcToHost[i]);
+        const int length = fcToHost[i + 4] ? fcToHost[i + 4] : 256;
+        hostResponse_t response;
+        response.command = fcToHost[i + 1];
+        response.params.assign(&fcToHost[i + 5], &fcToHost[i + 5 + length]);
+        response.ack = fcToHost[i + 5 + length];
+
+        uint16_t crc = 0;
+        for (int j = 0; j < 6 + length; j++) {
+            crc = _crc_xmodem_update(crc, fcToHost[i + j]);
+        }
+        EXPECT_EQ(crc, (fcToHost[i + 6 + length] << 8) | fcToHost[i + 7 + length]);
+
+        responses.push_back(response);
+        i += 8 + length;
+    }
+    return responses;
+}
+
+static void makeImage(uint8_t *image)
+{
+    lcgState = 12345;
+    for (int i = 0; i < IMAGE_SIZE; i++) {
+        image[i] = lcgNext() >> 16;
+    }
+}
+
+static void queueFlashImage(const uint8_t *image)
+{
+    hostCommand(CMD_DEVICE_INIT, 0, 0);
+    for (int page = 0; page < IMAGE_SIZE / ESC_PAGE_SIZE; page++) {
+        hostCommand(CMD_PAGE_ERASE, 0, page);
+    }
+    for (int address = 0; address < IMAGE_SIZE; address += BLOCK_SIZE) {
+        hostCommand(CMD_DEVICE_WRITE, address, &image[address], BLOCK_SIZE & 0xFF);
+    }
+}
+
+static void queueVerifyCrc(const uint8_t *image, int length)
+{
+    uint16_t crc = 0;
+    for (int i = 0; i < length; i++) {
+        crc = _crc_xmodem_update(crc, image[i]);
+    }
+    const uint8_t params[] = { (uint8_t)(length >> 8), (uint8_t)(length & 0xFF), (uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF) };
+    hostCommand(CMD_VERIFY_CRC, 0, params, sizeof(params));
+}
+
+static uint32_t runSession(void)
+{
+    static serialPort_t hostPort;
+
+    hostCommand(CMD_INTERFACE_EXIT, 0, 0);
+    fcToHost.clear();
+    responseSent = false;
+    hostLinkUs = 0;
+
+    const uint32_t startUs = simUs;
+    esc4wayInit();
+    esc4wayProcess(&hostPort);
+    EXPECT_TRUE(hostToFc.empty());
+
+    return simUs - startUs;
+}
+
+TEST(Serial4wayTest, verifyByCrc)
+{
+    static uint8_t image[IMAGE_SIZE];
+    makeImage(image);
+    bootloader.reset();
+
+    // given an image that was flashed
+    queueFlashImage(image);
+    queueVerifyCrc(image, IMAGE_SIZE);
+
+    // and a range verified with the wrong CRC
+    queueVerifyCrc(image + 1, 1024);
+
+    // when
+    runSession();
+
+    // then
+    std::vector<hostResponse_t> responses = hostResponses();
+    ASSERT_EQ(1 + IMAGE_SIZE / ESC_PAGE_SIZE + IMAGE_SIZE / BLOCK_SIZE + 3, (int)responses.size());
+    for (size_t i = 0; i + 2 < responses.size(); i++) {
+        EXPECT_EQ(ACK_OK, responses[i].ack) << "command " << (int)responses[i].command;
+    }
+    EXPECT_EQ(0, memcmp(image, bootloader.flash, IMAGE_SIZE));
+    EXPECT_EQ(0, bootloader.framingErrors);
+    EXPECT_EQ(0, bootloader.crcErrors);
+
+    const hostResponse_t &mismatch = responses[responses.size() - 2];
+    EXPECT_EQ(CMD_VERIFY_CRC, mismatch.command);
+    EXPECT_EQ(ACK_I_VERIFY_ERROR, mismatch.ack);
+    uint16_t crc = 0;
+    for (int i = 0; i < 1024; i++) {
+        crc = _crc_xmodem_update(crc, image[i]);
+    }
+    EXPECT_EQ(crc, (mismatch.params[0] << 8) | mismatch.params[1]);
+}
+
+TEST(Serial4wayTest, flashFailureIsFoundByCrc)
+{
+    static uint8_t image[IMAGE_SIZE];
+    makeImage(image);
+    bootloader.reset();
+
+    queueFlashImage(image);
+    runSession();
+
+    // a bit that did not program
+    bootloader.flash[5000] ^= 0x10;
+
+    hostCommand(CMD_DEVICE_INIT, 0, 0);
+    queueVerifyCrc(image, IMAGE_SIZE);
+    runSession();
+
+    std::vector<hostResponse_t> responses = hostResponses();
+    ASSERT_EQ(3u, responses.size());
+    EXPECT_EQ(ACK_OK, responses[0].ack);
+    EXPECT_EQ(ACK_I_VERIFY_ERROR, responses[1].ack);
+}
+
+TEST(Serial4wayTest, bytesAreSentBackToBack)
+{
+    static uint8_t image[IMAGE_SIZE];
+    makeImage(image);
+    bootloader.reset();
+
+    hostCommand(CMD_DEVICE_INIT, 0, 0);
+    hostCommand(CMD_DEVICE_WRITE, 0, image, BLOCK_SIZE & 0xFF);
+    runSession();
+
+    // the 256 data bytes and their CRC, one start and one stop bit each
+    const double expectedUs = (BLOCK_SIZE + 2) * 10 * 52;
+    EXPECT_NEAR(expectedUs, bootloader.longestBurstUs, expectedUs * 0.005);
+    EXPECT_EQ(0, bootloader.framingErrors);
+}
+
+TEST(Serial4wayTest, benchmarkFlash16k)
+{
+    static uint8_t image[IMAGE_SIZE];
+    makeImage(image);
+
+    // verified by reading every block back to the host
+    bootloader.reset();
+    queueFlashImage(image);
+    for (int address = 0; address < IMAGE_SIZE; address += BLOCK_SIZE) {
+        hostCommand(CMD_DEVICE_READ, address, BLOCK_SIZE & 0xFF);
+    }
+    const uint32_t readbackUs = runSession();
+    const uint32_t readbackHostUs = hostLinkUs;
+    const int readbackEscBytes = bootloader.bytesReceived + bootloader.bytesSent;
+
+    std::vector<hostResponse_t> responses = hostResponses();
+    for (int block = 0; block < IMAGE_SIZE / BLOCK_SIZE; block++) {
+        const hostResponse_t &read = responses[responses.size() - 1 - IMAGE_SIZE / BLOCK_SIZE + block];
+        EXPECT_EQ(ACK_OK, read.ack);
+        EXPECT_EQ(0, memcmp(&image[block * BLOCK_SIZE], read.params.data(), BLOCK_SIZE));
+    }
+
+    // verified against a CRC by the interface
+    bootloader.reset();
+    queueFlashImage(image);
+    queueVerifyCrc(image, IMAGE_SIZE);
+    const uint32_t crcUs = runSession();
+    const uint32_t crcHostUs = hostLinkUs;
+    const int crcEscBytes = bootloader.bytesReceived + bootloader.bytesSent;
+
+    responses = hostResponses();
+    EXPECT_EQ(ACK_OK, responses[responses.size() - 2].ack);
+
+    // what the one-wire line and the flash itself need at least
+    const double escWireUs = crcEscBytes * 10 * ESC_BIT_US;
+    const double flashUs = (IMAGE_SIZE / ESC_PAGE_SIZE) * ESC_ERASE_US + IMAGE_SIZE * ESC_PROGRAM_BYTE_US;
+
+    printf("[ 4WAY     ] 16KiB erase, write and verify: readback %.2fs (host link %.2fs, %d ESC bytes), crc %.2fs (host link %.2fs, %d ESC bytes)\n",
+        readbackUs / 1e6, readbackHostUs / 1e6, readbackEscBytes, crcUs / 1e6, crcHostUs / 1e6, crcEscBytes);
+    printf("[ 4WAY     ] one-wire line busy %.2fs and flash %.2fs of %.2fs, the rest is host link and turnaround\n",
+        escWireUs / 1e6, flashUs / 1e6, crcUs / 1e6);
+
+    EXPECT_LT(crcUs, readbackUs);
+    EXPECT_LT(crcHostUs, readbackHostUs * 0.6);
+    // no more than the host link and a few percent on top of the line and flash time
+    EXPECT_LT(crcUs, (escWireUs + flashUs) * 1.05 + crcHostUs);
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t micros(void) { return simUs++; }
+uint32_t millis(void) { return simUs++ / 1000; }
+void delayMicroseconds(uint32_t us) { simUs += us; }
+
+static pwmOutputPort_t motors[MAX_SUPPORTED_MOTORS];
+
+pwmOutputPort_t *pwmGetMotors(void)
+{
+    motors[0].enabled = true;
+    motors[0].io = (IO_t)&motors[0];
+    return motors;
+}
+void pwmDisableMotors(void) {}
+void pwmEnableMotors(void) {}
+
+void IOConfigGPIO(IO_t io, ioConfig_t cfg)
+{
+    UNUSED(io);
+    if (cfg == IOCFG_OUT_PP) {
+        escOutput = true;
+        bootloader.beginBurst();
+        bootloader.drive(escDriveLevel);
+    } else if (escOutput) {
+        escOutput = false;
+        bootloader.endBurst();
+    }
+}
+
+void IOHi(IO_t io)
+{
+    UNUSED(io);
+    escDriveLevel = true;
+    if (escOutput) {
+        bootloader.drive(true);
+    }
+}
+
+void IOLo(IO_t io)
+{
+    UNUSED(io);
+    escDriveLevel = false;
+    if (escOutput) {
+        bootloader.drive(false);
+    }
+}
+
+bool IORead(IO_t io)
+{
+    UNUSED(io);
+    return escOutput ? escDriveLevel : bootloader.lineLevel();
+}
+
+uint32_t serialRxBytesWaiting(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return hostToFc.size();
+}
+
+uint8_t serialRead(serialPort_t *instance)
+{
+    UNUSED(instance);
+    if (responseSent) {
+        simUs += HOST_TURNAROUND_US;
+        hostLinkUs += HOST_TURNAROUND_US;
+        responseSent = false;
+    }
+    simUs += HOST_BYTE_US;
+    hostLinkUs += HOST_BYTE_US;
+    const uint8_t b = hostToFc.front();
+    hostToFc.pop_front();
+    return b;
+}
+
+void serialWrite(serialPort_t *instance, uint8_t ch)
+{
+    UNUSED(instance);
+    simUs += HOST_BYTE_US;
+    hostLinkUs += HOST_BYTE_US;
+    fcToHost.push_back(ch);
+}
+
+uint32_t serialTxBytesFree(const serialPort_t *instance)
+{
+    UNUSED(instance);
+    return 1;
+}
+
+void serialBeginWrite(serialPort_t *instance) { UNUSED(instance); }
+
+void serialEndWrite(serialPort_t *instance)
+{
+    UNUSED(instance);
+    responseSent = true;
+}
+
+}
@@ -0,0 +1,534 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/serial.h"
+    #include "drivers/serial_softserial.h"
+    #include "drivers/serial_softserial_dma.h"
+    #include "drivers/system.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+#define TEST_BAUD           57600
+#define TEST_TIMER_HZ       (TEST_BAUD * 16)        // what the F3 layer picks at 57600
+#define TEST_BIT_TICKS      16.0
+
+#define TX_HIGH_WORD        0x00000020              // BSRR words of a pin 5
+#define TX_LOW_WORD         0x00200000
+
+typedef struct wire_s {
+    std::vector<uint16_t> edges;
+    uint32_t endTick;
+} wire_t;
+
+// Edges of bytes sent back to back from startTick by a transmitter running at bitTicks per bit of the receiver clock
+static wire_t wireForBytes(const std::vector<uint8_t> &bytes, uint32_t startTick, double bitTicks, int jitterTicks)
+{
+    wire_t wire;
+    bool level = true;
+    double t = startTick;
+
+    for (uint8_t value : bytes) {
+        const uint16_t frame = (1 << 9) | (value << 1);
+        for (int bit = 0; bit < 10; bit++) {
+            const bool bitLevel = frame & (1 << bit);
+            if (bitLevel != level) {
+                const int jitter = jitterTicks ? (int)(lcgNext() % (2 * jitterTicks + 1)) - jitterTicks : 0;
+                wire.edges.push_back((uint16_t)((uint32_t)(t + 0.5) + jitter));
+                level = bitLevel;
+            }
+            t += bitTicks;
+        }
+    }
+    wire.endTick = (uint32_t)t;
+    return wire;
+}
+
+static std::vector<uint8_t> decodeWire(softSerialDmaDecoder_t *decoder, const wire_t &wire, uint32_t idleTicks)
+{
+    std::vector<uint8_t> bytes;
+    uint8_t value;
+
+    for (uint16_t edge : wire.edges) {
+        if (softSerialDmaDecodeEdge(decoder, edge, &value)) {
+            bytes.push_back(value);
+        }
+    }
+    if (softSerialDmaDecodeIdle(decoder, (uint16_t)(wire.endTick + idleTicks), &value)) {
+        bytes.push_back(value);
+    }
+    return bytes;
+}
+
+static std::vector<uint8_t> randomBytes(int count)
+{
+    std::vector<uint8_t> bytes;
+    for (int i = 0; i < count; i++) {
+        bytes.push_back(lcgNext() & 0xFF);
+    }
+    return bytes;
+}
+
+TEST(SoftSerialDmaDecoderTest, DecodesEveryByteValue)
+{
+    softSerialDmaDecoder_t decoder;
+    softSerialDmaDecoderInit(&decoder, TEST_TIMER_HZ, TEST_BAUD);
+
+    std::vector<uint8_t> bytes;
+    for (int i = 0; i < 256; i++) {
+        bytes.push_back(i);
+    }
+
+    const wire_t wire = wireForBytes(bytes, 1000, TEST_BIT_TICKS, 0);
+    EXPECT_EQ(bytes, decodeWire(&decoder, wire, 0));
+    EXPECT_EQ(0, decoder.framingErrors);
+}
+
+TEST(SoftSerialDmaDecoderTest, LastByteWaitsForStopBit)
+{
+    softSerialDmaDecoder_t decoder;
+    softSerialDmaDecoderInit(&decoder, TEST_TIMER_HZ, TEST_BAUD);
+    uint8_t value;
+
+    // 0xFF has its only edge at the start bit, nothing else ends the frame
+    const wire_t wire = wireForBytes({ 0xFF }, 100, TEST_BIT_TICKS, 0);
+    for (uint16_t edge : wire.edges) {
+        EXPECT_FALSE(softSerialDmaDecodeEdge(&decoder, edge, &value));
+    }
+
+    EXPECT_FALSE(softSerialDmaDecodeIdle(&decoder, 100 + 9 * 16, &value));
+    EXPECT_TRUE(softSerialDmaDecodeIdle(&decoder, 100 + 9 * 16 + 8, &value));
+    EXPECT_EQ(0xFF, value);
+    EXPECT_FALSE(softSerialDmaDecodeIdle(&decoder, 100 + 20 * 16, &value));
+}
+
+TEST(SoftSerialDmaDecoderTest, ToleratesBaudRateMismatch)
+{
+    lcgState = 1;
+    const std::vector<uint8_t> bytes = randomBytes(200);
+
+    for (double error : { -0.04, -0.02, 0.02, 0.04 }) {
+        softSerialDmaDecoder_t decoder;
+        softSerialDmaDecoderInit(&decoder, TEST_TIMER_HZ, TEST_BAUD);
+
+        const wire_t wire = wireForBytes(bytes, 0, TEST_BIT_TICKS * (1.0 + error), 0);
+        EXPECT_EQ(bytes, decodeWire(&decoder, wire, 16)) << "baud error " << error;
+        EXPECT_EQ(0, decoder.framingErrors);
+    }
+}
+
+TEST(SoftSerialDmaDecoderTest, ToleratesEdgeJitter)
+{
+    lcgState = 2;
+    const std::vector<uint8_t> bytes = randomBytes(500);
+
+    softSerialDmaDecoder_t decoder;
+    softSerialDmaDecoderInit(&decoder, TEST_TIMER_HZ, TEST_BAUD);
+
+    // +-3 ticks is about a fifth of a bit
+    const wire_t wire = wireForBytes(bytes, 0, TEST_BIT_TICKS, 3);
+    EXPECT_EQ(bytes, decodeWire(&decoder, wire, 16));
+}
+
+TEST(SoftSerialDmaDecoderTest, CaptureCounterWraps)
+{
+    lcgState = 3;
+    const std::vector<uint8_t> bytes = randomBytes(50);
+
+    softSerialDmaDecoder_t decoder;
+    softSerialDmaDecoderInit(&decoder, TEST_TIMER_HZ, TEST_BAUD);
+
+    // the 16 bit counter wraps inside the first frames
+    const wire_t wire = wireForBytes(bytes, 0xFFF0, TEST_BIT_TICKS, 0);
+    EXPECT_EQ(bytes, decodeWire(&decoder, wire, 16));
+}
+
+TEST(SoftSerialDmaDecoderTest, IdleGapsBetweenBytes)
+{
+    lcgState = 4;
+    softSerialDmaDecoder_t decoder;
+    softSerialDmaDecoderInit(&decoder, TEST_TIMER_HZ, TEST_BAUD);
+
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> decoded;
+    uint32_t tick = 0;
+
+    for (int i = 0; i < 100; i++) {
+        const std::vector<uint8_t> bytes = randomBytes(1 + lcgNext() % 4);
+        const wire_t wire = wireForBytes(bytes, tick, TEST_BIT_TICKS, 0);
+        const std::vector<uint8_t> part = decodeWire(&decoder, wire, lcgNext() % 200);
+
+        expected.insert(expected.end(), bytes.begin(), bytes.end());
+        decoded.insert(decoded.end(), part.begin(), part.end());
+        tick = wire.endTick + 16 + lcgNext() % 300;
+    }
+
+    EXPECT_EQ(expected, decoded);
+}
+
+TEST(SoftSerialDmaDecoderTest, FramingErrors)
+{
+    softSerialDmaDecoder_t decoder;
+    softSerialDmaDecoderInit(&decoder, TEST_TIMER_HZ, TEST_BAUD);
+    uint8_t value;
+
+    // a break, the line stays low past the stop bit
+    EXPECT_FALSE(softSerialDmaDecodeEdge(&decoder, 0, &value));
+    EXPECT_FALSE(softSerialDmaDecodeIdle(&decoder, 15 * 16, &value));
+    EXPECT_EQ(1, decoder.framingErrors);
+
+    // released later, then a good byte follows
+    EXPECT_FALSE(softSerialDmaDecodeEdge(&decoder, 40 * 16, &value));
+    const wire_t wire = wireForBytes({ 0x5A }, 50 * 16, TEST_BIT_TICKS, 0);
+    EXPECT_EQ(std::vector<uint8_t>({ 0x5A }), decodeWire(&decoder, wire, 16));
+    EXPECT_EQ(1, decoder.framingErrors);
+}
+
+TEST(SoftSerialDmaDecoderTest, WaveformRoundTrip)
+{
+    uint32_t waveform[SOFTSERIAL_DMA_TX_WORDS];
+    uint8_t data[SOFTSERIAL_DMA_TX_BYTES];
+
+    softSerialDmaDecoder_t decoder;
+    softSerialDmaDecoderInit(&decoder, TEST_TIMER_HZ, TEST_BAUD);
+
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> decoded;
+    uint8_t value;
+    bool level = true;
+    uint32_t tick = 0;
+
+    for (int chunk = 0; chunk < 256 / SOFTSERIAL_DMA_TX_BYTES; chunk++) {
+        for (int i = 0; i < SOFTSERIAL_DMA_TX_BYTES; i++) {
+            data[i] = chunk * SOFTSERIAL_DMA_TX_BYTES + i;
+            expected.push_back(data[i]);
+        }
+
+        const uint16_t words = softSerialDmaBuildFrames(waveform, data, SOFTSERIAL_DMA_TX_BYTES, TX_HIGH_WORD, TX_LOW_WORD);
+        EXPECT_EQ(SOFTSERIAL_DMA_TX_BYTES * SOFTSERIAL_DMA_FRAME_BITS, words);
+
+        // one word per bit time, an edge wherever the pin changes
+        for (int i = 0; i < words; i++) {
+            const bool wordLevel = waveform[i] == TX_HIGH_WORD;
+            EXPECT_TRUE(waveform[i] == TX_HIGH_WORD || waveform[i] == TX_LOW_WORD);
+            if (wordLevel != level) {
+                if (softSerialDmaDecodeEdge(&decoder, tick, &value)) {
+                    decoded.push_back(value);
+                }
+                level = wordLevel;
+            }
+            tick += 16;
+        }
+    }
+    if (softSerialDmaDecodeIdle(&decoder, tick + 16, &value)) {
+        decoded.push_back(value);
+    }
+
+    EXPECT_EQ(expected, decoded);
+}
+
+/*
+ * Ports on a simulated capture timer and DMA
+ */
+
+typedef struct simPort_s {
+    softSerialDma_t *softSerial;
+    uint32_t written;               // captures the DMA stored
+    uint16_t now;
+    int txStarts;
+    std::vector<uint32_t> transfer; // waveform handed to the DMA last
+} simPort_t;
+
+static simPort_t simPorts[MAX_SOFTSERIAL_PORTS];
+
+static simPort_t *simPortFor(const softSerialDma_t *softSerial)
+{
+    for (int i = 0; i < MAX_SOFTSERIAL_PORTS; i++) {
+        if (simPorts[i].softSerial == softSerial) {
+            return &simPorts[i];
+        }
+    }
+    return NULL;
+}
+
+static softSerialDma_t *dmaPort(serialPort_t *port)
+{
+    return (softSerialDma_t *)port;
+}
+
+static void simResetPorts(void)
+{
+    for (int i = 0; i < MAX_SOFTSERIAL_PORTS; i++) {
+        simPorts[i] = simPort_t();
+    }
+}
+
+// the capture DMA, with its half and full transfer interrupts
+static void simCapture(simPort_t *sim, uint16_t capture)
+{
+    sim->softSerial->rxCaptures[sim->written % SOFTSERIAL_DMA_RX_EDGES] = capture;
+    sim->written++;
+    sim->now = capture;
+    if (sim->written % (SOFTSERIAL_DMA_RX_EDGES / 2) == 0) {
+        softSerialDmaRxHalfTransfer(sim->softSerial);
+    }
+}
+
+static void simPoll(serialPort_t *port, std::vector<uint8_t> *received)
+{
+    while (serialRxBytesWaiting(port)) {
+        received->push_back(serialRead(port));
+    }
+}
+
+// Plays the waveform the TX DMA writes, one word per bit, into the capture of the receiving port
+static void simTransmit(simPort_t *tx, simPort_t *rx, uint32_t *tick, std::vector<uint8_t> *received)
+{
+    bool level = true;
+
+    while (tx->softSerial->txActive) {
+        for (uint32_t word : tx->transfer) {
+            const bool wordLevel = word == TX_HIGH_WORD;
+            if (wordLevel != level) {
+                simCapture(rx, *tick);
+                level = wordLevel;
+            }
+            *tick += 16;
+            rx->now = *tick;
+
+            // the receiving port is polled once per 1ms scheduler cycle
+            if ((*tick / 16) % (TEST_BAUD / 1000) == 0) {
+                simPoll(&rx->softSerial->port, received);
+            }
+        }
+        softSerialDmaTxTransferComplete(tx->softSerial);
+    }
+    rx->now = *tick + 16;
+    simPoll(&rx->softSerial->port, received);
+}
+
+TEST(SoftSerialDmaPortTest, LoopbackBetweenTwoPorts)
+{
+    simResetPorts();
+    lcgState = 5;
+
+    serialPort_t *port1 = openSoftSerialDma(SOFTSERIAL1, NULL, NULL, NULL, NULL, TEST_BAUD, MODE_RXTX, SERIAL_NOT_INVERTED);
+    serialPort_t *port2 = openSoftSerialDma(SOFTSERIAL2, NULL, NULL, NULL, NULL, TEST_BAUD, MODE_RXTX, SERIAL_NOT_INVERTED);
+    ASSERT_NE(nullptr, port1);
+    ASSERT_NE(nullptr, port2);
+
+    simPort_t *sim1 = simPortFor(dmaPort(port1));
+    simPort_t *sim2 = simPortFor(dmaPort(port2));
+
+    uint32_t tick1 = 0;
+    uint32_t tick2 = 0;
+    std::vector<uint8_t> sent1, sent2, received1, received2;
+
+    for (int burst = 0; burst < 100; burst++) {
+        const std::vector<uint8_t> bytes1 = randomBytes(1 + lcgNext() % 60);
+        const std::vector<uint8_t> bytes2 = randomBytes(1 + lcgNext() % 60);
+
+        serialWriteBuf(port1, bytes1.data(), bytes1.size());
+        serialWriteBuf(port2, bytes2.data(), bytes2.size());
+        sent1.insert(sent1.end(), bytes1.begin(), bytes1.end());
+        sent2.insert(sent2.end(), bytes2.begin(), bytes2.end());
+
+        simTransmit(sim1, sim2, &tick1, &received2);
+        simTransmit(sim2, sim1, &tick2, &received1);
+    }
+
+    EXPECT_EQ(sent1, received2);
+    EXPECT_EQ(sent2, received1);
+
+    softSerialStats_t stats1, stats2;
+    EXPECT_TRUE(softSerialDmaGetStats(SOFTSERIAL1, &stats1));
+    EXPECT_TRUE(softSerialDmaGetStats(SOFTSERIAL2, &stats2));
+    EXPECT_TRUE(stats1.dma);
+    EXPECT_EQ(TEST_BAUD, stats1.baudRate);
+    EXPECT_EQ(sent1.size(), stats1.txBytes);
+    EXPECT_EQ(sent2.size(), stats1.rxBytes);
+    EXPECT_EQ(0, stats1.rxErrors + stats2.rxErrors);
+
+    // the per bit driver takes a timer interrupt every bit time on both ports and one per received edge
+    const uint32_t bitTimes = (tick1 + tick2) / 16;
+    const uint32_t perBitInterrupts = 2 * bitTimes + sim1->written + sim2->written;
+    const uint32_t dmaInterrupts = stats1.interrupts + stats2.interrupts;
+    const double seconds = (double)bitTimes / TEST_BAUD;
+
+    printf("[ ISR      ] 2 ports at %d baud, %u bytes: per bit driver %u (%.0f/s), capture/DMA %u (%.0f/s)\n",
+        TEST_BAUD, stats1.txBytes + stats2.txBytes, perBitInterrupts, perBitInterrupts / seconds, dmaInterrupts, dmaInterrupts / seconds);
+
+    EXPECT_LT(dmaInterrupts * 20, perBitInterrupts);
+}
+
+TEST(SoftSerialDmaPortTest, TransfersHoldEightBytes)
+{
+    simResetPorts();
+
+    serialPort_t *port = openSoftSerialDma(SOFTSERIAL1, NULL, NULL, NULL, NULL, TEST_BAUD, MODE_TX, SERIAL_NOT_INVERTED);
+    ASSERT_NE(nullptr, port);
+    simPort_t *sim = simPortFor(dmaPort(port));
+
+    uint8_t data[20];
+    memset(data, 0x55, sizeof(data));
+    serialWriteBuf(port, data, sizeof(data));
+
+    EXPECT_EQ(1, sim->txStarts);
+    EXPECT_EQ(80u, sim->transfer.size());
+    softSerialDmaTxTransferComplete(dmaPort(port));
+    EXPECT_EQ(80u, sim->transfer.size());
+    softSerialDmaTxTransferComplete(dmaPort(port));
+
+    // the last transfer keeps the line idle for a bit after the final stop bit
+    EXPECT_EQ(41u, sim->transfer.size());
+    EXPECT_EQ((uint32_t)TX_HIGH_WORD, sim->transfer.back());
+    softSerialDmaTxTransferComplete(dmaPort(port));
+
+    EXPECT_FALSE(dmaPort(port)->txActive);
+    EXPECT_EQ(3u, dmaPort(port)->stats.interrupts);
+    EXPECT_TRUE(isSerialTransmitBufferEmpty(port));
+}
+
+TEST(SoftSerialDmaPortTest, CaptureOverrunResynchronises)
+{
+    simResetPorts();
+    lcgState = 6;
+
+    serialPort_t *port = openSoftSerialDma(SOFTSERIAL1, NULL, NULL, NULL, NULL, TEST_BAUD, MODE_RX, SERIAL_NOT_INVERTED);
+    ASSERT_NE(nullptr, port);
+    simPort_t *sim = simPortFor(dmaPort(port));
+
+    // far more edges than the capture buffer holds before the port is polled
+    const wire_t lost = wireForBytes(randomBytes(300), 0, TEST_BIT_TICKS, 0);
+    ASSERT_GT(lost.edges.size(), 2u * SOFTSERIAL_DMA_RX_EDGES);
+    for (uint16_t edge : lost.edges) {
+        simCapture(sim, edge);
+    }
+    sim->now = lost.endTick + 32;
+    serialRxBytesWaiting(port);
+
+    softSerialStats_t stats;
+    softSerialDmaGetStats(SOFTSERIAL1, &stats);
+    EXPECT_EQ(1, stats.rxErrors);
+
+    while (serialRxBytesWaiting(port)) {
+        serialRead(port);
+    }
+
+    const std::vector<uint8_t> bytes = randomBytes(20);
+    const wire_t wire = wireForBytes(bytes, lost.endTick + 100, TEST_BIT_TICKS, 0);
+    for (uint16_t edge : wire.edges) {
+        simCapture(sim, edge);
+    }
+    sim->now = wire.endTick + 32;
+
+    std::vector<uint8_t> received;
+    while (serialRxBytesWaiting(port)) {
+        received.push_back(serialRead(port));
+    }
+    EXPECT_EQ(bytes, received);
+}
+
+TEST(SoftSerialDmaPortTest, HalfDuplexTurnsAround)
+{
+    simResetPorts();
+
+    serialPort_t *port = openSoftSerialDma(SOFTSERIAL2, NULL, NULL, NULL, NULL, TEST_BAUD, MODE_RXTX, SERIAL_BIDIR);
+    ASSERT_NE(nullptr, port);
+    simPort_t *sim = simPortFor(dmaPort(port));
+    EXPECT_TRUE(dmaPort(port)->rxActive);
+
+    serialWrite(port, 0xAA);
+    EXPECT_FALSE(dmaPort(port)->rxActive);
+    EXPECT_EQ(11u, sim->transfer.size());
+
+    softSerialDmaTxTransferComplete(dmaPort(port));
+    EXPECT_TRUE(dmaPort(port)->rxActive);
+
+    sim->written = 0;
+    const wire_t wire = wireForBytes({ 0x12, 0x34 }, 500, TEST_BIT_TICKS, 0);
+    for (uint16_t edge : wire.edges) {
+        simCapture(sim, edge);
+    }
+    sim->now = wire.endTick + 16;
+
+    ASSERT_EQ(2u, serialRxBytesWaiting(port));
+    EXPECT_EQ(0x12, serialRead(port));
+    EXPECT_EQ(0x34, serialRead(port));
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t millis(void) { return 0; }
+
+bool softSerialDmaHardwareInit(softSerialDma_t *softSerial, softSerialPortIndex_e portIndex)
+{
+    simPorts[portIndex].softSerial = softSerial;
+    softSerial->rxTimerHz = TEST_TIMER_HZ;
+    softSerial->txHighWord = TX_HIGH_WORD;
+    softSerial->txLowWord = TX_LOW_WORD;
+    return true;
+}
+
+void softSerialDmaHardwareSetBaudRate(softSerialDma_t *) {}
+
+void softSerialDmaHardwareStartRx(softSerialDma_t *softSerial)
+{
+    simPortFor(softSerial)->written = 0;
+}
+
+void softSerialDmaHardwareStopRx(softSerialDma_t *) {}
+
+uint16_t softSerialDmaHardwareRxIndex(const softSerialDma_t *softSerial)
+{
+    return simPortFor(softSerial)->written % SOFTSERIAL_DMA_RX_EDGES;
+}
+
+uint16_t softSerialDmaHardwareRxNow(const softSerialDma_t *softSerial)
+{
+    return simPortFor(softSerial)->now;
+}
+
+void softSerialDmaHardwareStartTx(softSerialDma_t *softSerial, uint16_t words, bool first)
+{
+    simPort_t *sim = simPortFor(softSerial);
+
+    if (first) {
+        sim->txStarts++;
+    }
+    sim->transfer.assign(softSerial->txWaveform, softSerial->txWaveform + words);
+}
+
+void softSerialDmaHardwareStopTx(softSerialDma_t *softSerial)
+{
+    simPortFor(softSerial)->transfer.clear();
+}
+
+}
@@ -0,0 +1,141 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "drivers/serial.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TEST_TX_BUFFER_SIZE 256
+
+static uint8_t txBuffer[TEST_TX_BUFFER_SIZE];
+static serialPort_t port;
+static std::vector<uint8_t> wire;
+
+// same accounting as the UART driver, one slot is kept free to tell a full ring from an empty one
+static uint32_t testTxBytesFree(const serialPort_t *instance)
+{
+    const uint32_t used = (instance->txBufferHead - instance->txBufferTail + instance->txBufferSize) % instance->txBufferSize;
+    return instance->txBufferSize - 1 - used;
+}
+
+// the transmitter, sends up to count queued bytes
+static void testTransmit(uint32_t count)
+{
+    while (count-- && port.txBufferTail != port.txBufferHead) {
+        wire.push_back(txBuffer[port.txBufferTail]);
+        port.txBufferTail = (port.txBufferTail + 1) % port.txBufferSize;
+    }
+}
+
+static const struct serialPortVTable testVTable = {
+    .serialWrite = NULL,
+    .serialTotalRxWaiting = NULL,
+    .serialTotalTxFree = testTxBytesFree,
+    .serialRead = NULL,
+    .serialSetBaudRate = NULL,
+    .isSerialTransmitBufferEmpty = NULL,
+    .setMode = NULL,
+    .writeBuf = NULL,
+    .readBuf = NULL,
+    .beginWrite = NULL,
+    .endWrite = NULL
+};
+
+static void resetPort(uint32_t head)
+{
+    memset(&port, 0, sizeof(port));
+    memset(txBuffer, 0, sizeof(txBuffer));
+    port.vTable = &testVTable;
+    port.txBuffer = txBuffer;
+    port.txBufferSize = TEST_TX_BUFFER_SIZE;
+    port.txBufferHead = port.txBufferTail = head;
+    wire.clear();
+}
+
+static std::vector<uint8_t> pattern(uint32_t count)
+{
+    std::vector<uint8_t> data(count);
+    for (uint32_t i = 0; i < count; i++) {
+        data[i] = i * 7 + 3;
+    }
+    return data;
+}
+
+TEST(SerialTest, TxBufferWriteWrapsAroundTheRing)
+{
+    resetPort(TEST_TX_BUFFER_SIZE - 10);
+    const std::vector<uint8_t> data = pattern(100);
+
+    EXPECT_EQ(100, serialTxBufferWrite(&port, data.data(), data.size()));
+    EXPECT_EQ(90, port.txBufferHead);
+
+    testTransmit(TEST_TX_BUFFER_SIZE);
+    EXPECT_EQ(data, wire);
+}
+
+TEST(SerialTest, TxBufferWriteStopsAtFreeSpace)
+{
+    resetPort(40);
+    const std::vector<uint8_t> queued = pattern(200);
+    ASSERT_EQ(200, serialTxBufferWrite(&port, queued.data(), queued.size()));
+
+    // 55 bytes free, the unsent bytes must not be overwritten
+    const std::vector<uint8_t> more(100, 0xAA);
+    EXPECT_EQ(55, serialTxBufferWrite(&port, more.data(), more.size()));
+    EXPECT_EQ(0, testTxBytesFree(&port));
+    EXPECT_EQ(0, serialTxBufferWrite(&port, more.data(), more.size()));
+
+    testTransmit(TEST_TX_BUFFER_SIZE);
+    ASSERT_EQ(255, wire.size());
+    EXPECT_TRUE(std::equal(queued.begin(), queued.end(), wire.begin()));
+    for (size_t i = queued.size(); i < wire.size(); i++) {
+        EXPECT_EQ(0xAA, wire[i]);
+    }
+}
+
+TEST(SerialTest, WriteLargerThanTheRingArrivesInOrder)
+{
+    // what uartWriteBuf() does, queue what fits and let the transmitter make room for the rest
+    resetPort(100);
+    const std::vector<uint8_t> data = pattern(1000);
+
+    const uint8_t *src = data.data();
+    uint32_t count = data.size();
+    int passes = 0;
+    while (count > 0) {
+        const uint32_t copied = serialTxBufferWrite(&port, src, count);
+        EXPECT_LE(copied, TEST_TX_BUFFER_SIZE - 1);
+        src += copied;
+        count -= copied;
+        testTransmit(32);
+        passes++;
+    }
+    testTransmit(TEST_TX_BUFFER_SIZE);
+
+    EXPECT_EQ(data, wire);
+    EXPECT_GT(passes, 1);
+}
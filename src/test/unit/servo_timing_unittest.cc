@@ -0,0 +1,226 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+#include "drivers/servo_timing.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+TEST(ServoTimingTest, StandardMatchesFreeRunningPwm)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_STANDARD, 300);
+
+    EXPECT_FALSE(timing.synced);
+    EXPECT_EQ(1, timing.timerMhz);
+    EXPECT_EQ(1000000 / 300, timing.periodTicks);
+    EXPECT_EQ(timing.periodTicks, timing.timerPeriodTicks);
+    // pulses are not touched, as before
+    EXPECT_EQ(1500, servoTimingPulseTicks(&timing, 1500));
+    EXPECT_EQ(2000, servoTimingPulseTicks(&timing, 2000));
+}
+
+TEST(ServoTimingTest, StandardRateIsLimited)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_STANDARD, 1000);
+    EXPECT_EQ(1000000 / SERVO_PWM_RATE_MAX_STANDARD, timing.periodTicks);
+
+    servoTimingInit(&timing, SERVO_PULSE_STANDARD, 10);
+    EXPECT_EQ(1000000 / SERVO_PWM_RATE_MIN, timing.periodTicks);
+}
+
+TEST(ServoTimingTest, NarrowPulseIsHalfWidth)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_NARROW, 560);
+
+    EXPECT_TRUE(timing.synced);
+    EXPECT_EQ(2, timing.timerMhz);
+    // 1520 is the middle of a 760us servo, one tick per servo unit at 2MHz
+    EXPECT_EQ(1520, servoTimingPulseTicks(&timing, 1520));
+    EXPECT_FLOAT_EQ(760.0f, servoTimingPulseTicks(&timing, 1520) / (float)timing.timerMhz);
+    EXPECT_EQ(2000000 / 560, timing.periodTicks);
+    // the keep alive period only runs out when the loop is slower than the servo
+    EXPECT_GT(timing.timerPeriodTicks, timing.periodTicks);
+    // and the loop never starts pulses faster than the servo rate
+    EXPECT_EQ(timing.periodTicks, timing.triggerTicks);
+}
+
+TEST(ServoTimingTest, NarrowPulseLeavesGapAt1kHz)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_NARROW, 1000);
+
+    EXPECT_EQ(2000, timing.periodTicks);
+    EXPECT_EQ(1960, timing.maxPulseTicks);
+    EXPECT_EQ(1960, servoTimingPulseTicks(&timing, 2100));
+    EXPECT_EQ(1800, servoTimingPulseTicks(&timing, 1800));
+
+    servoTimingInit(&timing, SERVO_PULSE_NARROW, 2000);
+    EXPECT_EQ(2000000 / SERVO_PWM_RATE_MAX_NARROW, timing.periodTicks);
+}
+
+TEST(ServoTimingTest, FreeRunningNarrow)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_NARROW, 760);
+    servoTimingSetFreeRunning(&timing);
+
+    servoPulseTracker_t tracker;
+    servoPulseTrackerInit(&tracker);
+    servoPulseTrackerWrite(&tracker, 1520, 0);
+    servoPulseTrackerWrite(&tracker, 1520, 1000);
+
+    EXPECT_FALSE(timing.synced);
+    EXPECT_EQ(timing.periodTicks, timing.timerPeriodTicks);
+    EXPECT_FALSE(servoPulseTrackerCanTrigger(&tracker, &timing, 0xFFFF));
+}
+
+TEST(ServoTimingTest, TriggerWaitsForPeriodAndPulse)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_NARROW, 1000);
+
+    servoPulseTracker_t tracker;
+    servoPulseTrackerInit(&tracker);
+    servoPulseTrackerWrite(&tracker, 1500, 0);
+    servoPulseTrackerWrite(&tracker, 1600, 1000);
+
+    // a loop running at the servo rate arrives a little early or late, early ones leave the pulse to the timer
+    EXPECT_FALSE(servoPulseTrackerCanTrigger(&tracker, &timing, 1000));
+    EXPECT_FALSE(servoPulseTrackerCanTrigger(&tracker, &timing, 1990));
+    EXPECT_FALSE(servoPulseTrackerCanTrigger(&tracker, &timing, timing.triggerTicks - 1));
+    EXPECT_TRUE(servoPulseTrackerCanTrigger(&tracker, &timing, 2000));
+    EXPECT_TRUE(servoPulseTrackerCanTrigger(&tracker, &timing, 2100));
+
+    // at a lower rate the widest pulse plus the gap ends long before the period does
+    servoTimingInit(&timing, SERVO_PULSE_NARROW, 500);
+    servoPulseTrackerWrite(&tracker, 1950, 2000);
+    servoPulseTrackerWrite(&tracker, 1600, 3000);
+    EXPECT_EQ(4000, timing.triggerTicks);
+    EXPECT_FALSE(servoPulseTrackerCanTrigger(&tracker, &timing, 3999));
+    EXPECT_TRUE(servoPulseTrackerCanTrigger(&tracker, &timing, 4000));
+}
+
+TEST(ServoTimingTest, SyncedPulseStartsWithWrite)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_NARROW, 1000);
+
+    servoPulseTracker_t tracker;
+    servoPulseTrackerInit(&tracker);
+    servoPulse_t pulse;
+
+    // loop at 1kHz: write, start the pulse, the next loop looks back at it
+    servoPulseTrackerWrite(&tracker, 1500, 10000);
+    servoPulseTrackerUpdate(&tracker, &timing, 2000, 11000, &pulse);
+    servoPulseTrackerWrite(&tracker, 1700, 11002);
+    // pulse forced at 11005, next loop at 12000
+    servoPulseTrackerUpdate(&tracker, &timing, 2 * 995, 12000, &pulse);
+
+    EXPECT_EQ(1700, pulse.value);
+    EXPECT_EQ(1500, pulse.previousValue);
+    // 1700 ticks is 850us at 2MHz, the servo had it for the remaining 145us
+    EXPECT_EQ(12000u - 11005 - 850, pulse.ageUs);
+
+    // called again in the same loop, nothing changes
+    servoPulseTrackerUpdate(&tracker, &timing, 2 * 995 + 1, 12000, &pulse);
+    EXPECT_EQ(1700, pulse.value);
+    EXPECT_EQ(145u, pulse.ageUs);
+}
+
+TEST(ServoTimingTest, ServoStillMeasuringPulse)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_STANDARD, 300);
+
+    servoPulseTracker_t tracker;
+    servoPulseTrackerInit(&tracker);
+    servoPulse_t pulse;
+
+    servoPulseTrackerWrite(&tracker, 1500, 1000);
+    servoPulseTrackerUpdate(&tracker, &timing, 100, 2000, &pulse);
+    servoPulseTrackerWrite(&tracker, 1800, 2100);
+
+    // the pulse with 1800 started 1000us ago and is 1800us wide
+    servoPulseTrackerUpdate(&tracker, &timing, 1000, 5000, &pulse);
+    EXPECT_EQ(1500, pulse.value);
+    EXPECT_EQ(1500, pulse.previousValue);
+    EXPECT_EQ(UINT32_MAX, pulse.ageUs);
+
+    // and a loop later it has ended
+    servoPulseTrackerUpdate(&tracker, &timing, 2000, 6000, &pulse);
+    EXPECT_EQ(1800, pulse.value);
+    EXPECT_EQ(1500, pulse.previousValue);
+    EXPECT_EQ(200u, pulse.ageUs);
+}
+
+TEST(ServoTimingTest, FreeRunningPhase)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_STANDARD, 300);   // 3333us period
+
+    servoPulseTracker_t tracker;
+    servoPulseTrackerInit(&tracker);
+    servoPulse_t pulse;
+
+    // pulses start at 1000, 4333, 7666 and 10999us
+    servoPulseTrackerWrite(&tracker, 1500, 500);
+    servoPulseTrackerUpdate(&tracker, &timing, 2000, 3000, &pulse);
+    EXPECT_EQ(1500, pulse.value);
+    EXPECT_EQ(500u, pulse.ageUs);
+
+    // both written after the pulse at 4333, the one at 7666 carries the newer
+    servoPulseTrackerWrite(&tracker, 1600, 5000);
+    servoPulseTrackerWrite(&tracker, 1700, 6000);
+
+    // at 8000 that pulse is still running
+    servoPulseTrackerUpdate(&tracker, &timing, 8000 - 7666, 8000, &pulse);
+    EXPECT_EQ(1500, pulse.value);
+    EXPECT_EQ(UINT32_MAX, pulse.ageUs);
+
+    servoPulseTrackerUpdate(&tracker, &timing, 10000 - 7666, 10000, &pulse);
+    EXPECT_EQ(1700, pulse.value);
+    EXPECT_EQ(1500, pulse.previousValue);
+    EXPECT_EQ(10000u - 7666 - 1700, pulse.ageUs);
+}
+
+TEST(ServoTimingTest, SlowLoopFindsFirstPulseWithValue)
+{
+    servoTiming_t timing;
+    servoTimingInit(&timing, SERVO_PULSE_STANDARD, 400);   // 2500us period
+
+    servoPulseTracker_t tracker;
+    servoPulseTrackerInit(&tracker);
+    servoPulse_t pulse;
+
+    servoPulseTrackerWrite(&tracker, 1500, 0);
+    servoPulseTrackerUpdate(&tracker, &timing, 100, 2600, &pulse);
+    servoPulseTrackerWrite(&tracker, 1200, 2700);
+
+    // pulses at 5000, 7500 and 10000 all carry 1200, the servo took it at the end of the first one
+    servoPulseTrackerUpdate(&tracker, &timing, 1500, 11500, &pulse);
+    EXPECT_EQ(1200, pulse.value);
+    EXPECT_EQ(1500, pulse.previousValue);
+    EXPECT_EQ(11500u - 5000 - 1200, pulse.ageUs);
+}
@@ -0,0 +1,143 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+
+extern "C" {
+    #include "common/maths.h"
+    #include "common/sorted_index.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// every name in the CLI valueTable, extracted from fc/cli.c by the test Makefile
+static const char * const cliValueNames[] = {
+#include "cli_value_names.inc"
+};
+#define CLI_VALUE_NAME_COUNT (sizeof(cliValueNames) / sizeof(cliValueNames[0]))
+
+static const char *cliValueNameForTableIndex(uint16_t tableIndex)
+{
+    return cliValueNames[tableIndex];
+}
+
+static uint32_t nameLookups;
+
+// counts the names a lookup has to compare against
+static const char *countedNameForTableIndex(uint16_t tableIndex)
+{
+    nameLookups++;
+    return cliValueNames[tableIndex];
+}
+
+static const char * const smallNames[] = { "yaw_rate", "Pitch", "roll", "p_yaw", "p_roll", "p_pitch", "pid_process_denom" };
+#define SMALL_NAME_COUNT (sizeof(smallNames) / sizeof(smallNames[0]))
+
+static const char *smallNameForTableIndex(uint16_t tableIndex)
+{
+    return smallNames[tableIndex];
+}
+
+// the lookup the CLI used before, kept here as the reference, it compares against every name up to the one found
+static int linearFind(const char *name, uint16_t nameLength)
+{
+    for (uint32_t i = 0; i < CLI_VALUE_NAME_COUNT; i++) {
+        if (strncasecmp(name, cliValueNames[i], strlen(cliValueNames[i])) == 0 && nameLength == strlen(cliValueNames[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+TEST(SortedIndexTest, IndexIsSortedCaseInsensitive)
+{
+    // given
+    uint16_t index[SMALL_NAME_COUNT];
+
+    // when
+    sortedIndexBuild(index, SMALL_NAME_COUNT, smallNameForTableIndex);
+
+    // then
+    for (uint32_t i = 1; i < SMALL_NAME_COUNT; i++) {
+        EXPECT_LT(strcasecmp(smallNames[index[i - 1]], smallNames[index[i]]), 0);
+    }
+}
+
+TEST(SortedIndexTest, FindRequiresExactLength)
+{
+    // given
+    uint16_t index[SMALL_NAME_COUNT];
+    sortedIndexBuild(index, SMALL_NAME_COUNT, smallNameForTableIndex);
+
+    // expect
+    EXPECT_EQ(1, sortedIndexFind(index, SMALL_NAME_COUNT, smallNameForTableIndex, "pitch", 5));
+    EXPECT_EQ(0, sortedIndexFind(index, SMALL_NAME_COUNT, smallNameForTableIndex, "YAW_RATE = 10", 8));
+    EXPECT_EQ(-1, sortedIndexFind(index, SMALL_NAME_COUNT, smallNameForTableIndex, "p_pit", 5));
+    EXPECT_EQ(-1, sortedIndexFind(index, SMALL_NAME_COUNT, smallNameForTableIndex, "p_pitch_", 8));
+    EXPECT_EQ(-1, sortedIndexFind(index, SMALL_NAME_COUNT, smallNameForTableIndex, "a", 1));
+    EXPECT_EQ(-1, sortedIndexFind(index, SMALL_NAME_COUNT, smallNameForTableIndex, "zzz", 3));
+    EXPECT_EQ(-1, sortedIndexFind(index, 0, smallNameForTableIndex, "roll", 4));
+}
+
+TEST(SortedIndexTest, FindsEveryCliValue)
+{
+    // given
+    static uint16_t index[CLI_VALUE_NAME_COUNT];
+    EXPECT_GT(CLI_VALUE_NAME_COUNT, 100u);
+
+    // when
+    sortedIndexBuild(index, CLI_VALUE_NAME_COUNT, cliValueNameForTableIndex);
+
+    // then
+    for (uint32_t i = 0; i < CLI_VALUE_NAME_COUNT; i++) {
+        const int found = sortedIndexFind(index, CLI_VALUE_NAME_COUNT, cliValueNameForTableIndex, cliValueNames[i], strlen(cliValueNames[i]));
+        ASSERT_GE(found, 0);
+        EXPECT_STREQ(cliValueNames[i], cliValueNames[found]);
+        EXPECT_EQ(linearFind(cliValueNames[i], strlen(cliValueNames[i])), linearFind(cliValueNames[found], strlen(cliValueNames[found])));
+    }
+}
+
+TEST(SortedIndexTest, FewerComparisonsThanLinearScan)
+{
+    // given
+    static uint16_t index[CLI_VALUE_NAME_COUNT];
+    sortedIndexBuild(index, CLI_VALUE_NAME_COUNT, cliValueNameForTableIndex);
+
+    // when
+    uint32_t linearComparisons = 0;
+    uint32_t sortedComparisons = 0;
+    uint32_t sortedComparisonsMax = 0;
+    for (uint32_t i = 0; i < CLI_VALUE_NAME_COUNT; i++) {
+        linearComparisons += linearFind(cliValueNames[i], strlen(cliValueNames[i])) + 1;
+
+        nameLookups = 0;
+        sortedIndexFind(index, CLI_VALUE_NAME_COUNT, countedNameForTableIndex, cliValueNames[i], strlen(cliValueNames[i]));
+        sortedComparisons += nameLookups;
+        sortedComparisonsMax = MAX(sortedComparisonsMax, nameLookups);
+    }
+
+    // then
+    // a binary search never needs more than log2(n) + 1 comparisons
+    uint32_t log2Count = 0;
+    while ((1u << log2Count) < CLI_VALUE_NAME_COUNT) {
+        log2Count++;
+    }
+    EXPECT_LE(sortedComparisonsMax, log2Count + 1);
+    EXPECT_LT(sortedComparisons * 10, linearComparisons);
+}
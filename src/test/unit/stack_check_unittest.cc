@@ -0,0 +1,163 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+extern "C" {
+#include "build/debug.h"
+#include "drivers/stack_check.h"
+
+#define STACK_WORDS 256
+
+static uint32_t stack[STACK_WORDS];
+
+uint32_t *unitTestStackTop = &stack[STACK_WORDS];
+uint32_t unitTestStackSize = sizeof(stack);
+uint32_t *unitTestStackPointer;
+
+int16_t debug[DEBUG16_VALUE_COUNT];
+uint8_t debugMode;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+static void use(int from, int to)
+{
+    for (int i = from; i < to; i++) {
+        stack[i] = i;
+    }
+}
+
+// The startup code paints it all, the frames above the stack pointer are in use
+static void bootStack(int stackPointer)
+{
+    stackPaint(stack, &stack[STACK_WORDS]);
+    unitTestStackPointer = &stack[stackPointer];
+    use(stackPointer, STACK_WORDS);
+}
+
+static uint32_t depth(int word)
+{
+    return (STACK_WORDS - word) * sizeof(uint32_t);
+}
+
+// taskStackCheck() arms the next sample, twice in a row starts the turn from the first task
+static void armFromFirstTask(void)
+{
+    taskStackCheck(0);
+    taskStackCheck(0);
+}
+
+TEST(StackCheckTest, PaintAndFindLowestUsed)
+{
+    uint32_t buffer[64];
+    stackPaint(buffer, &buffer[64]);
+    EXPECT_EQ(&buffer[64], stackLowestUsed(buffer, &buffer[64]));
+
+    buffer[40] = 0;
+    buffer[50] = 0;
+    EXPECT_EQ(&buffer[40], stackLowestUsed(buffer, &buffer[64]));
+    EXPECT_EQ(&buffer[50], stackLowestUsed(&buffer[41], &buffer[64]));
+    // only up to the top given
+    EXPECT_EQ(&buffer[30], stackLowestUsed(buffer, &buffer[30]));
+}
+
+TEST(StackCheckTest, HighWaterMark)
+{
+    bootStack(200);
+    // something went deeper earlier, with an untouched array in between
+    use(150, 152);
+    taskStackCheck(0);
+
+    EXPECT_EQ(depth(150), stackUsedSize());
+    EXPECT_EQ(sizeof(stack), stackTotalSize());
+}
+
+TEST(StackCheckTest, HighWaterMarkOnlyGrows)
+{
+    bootStack(200);
+    use(120, 122);
+    taskStackCheck(0);
+    EXPECT_EQ(depth(120), stackUsedSize());
+
+    stackPaint(stack, &stack[200]);
+    taskStackCheck(0);
+    EXPECT_EQ(depth(120), stackUsedSize());
+}
+
+TEST(StackCheckTest, TaskSampleMeasuresTaskDepth)
+{
+    bootStack(200);
+    // an earlier task went down to 170
+    use(170, 200);
+    armFromFirstTask();
+
+    ASSERT_TRUE(stackSampleBegin(1));
+    // painted again up to the guard below the scheduler
+    EXPECT_EQ(&stack[200 - STACK_SAMPLE_GUARD / 4], stackLowestUsed(&stack[170], &stack[STACK_WORDS]));
+
+    // the task goes deeper than any before
+    use(110, 200);
+    EXPECT_EQ(depth(110), stackSampleEnd());
+    EXPECT_GE(stackUsedSize(), depth(110));
+
+    // nothing more to report until the next sample
+    EXPECT_EQ(0u, stackSampleEnd());
+}
+
+TEST(StackCheckTest, ShallowTaskSample)
+{
+    bootStack(200);
+    use(150, 200);
+    armFromFirstTask();
+
+    ASSERT_TRUE(stackSampleBegin(2));
+    use(196, 200);
+    const uint32_t used = stackSampleEnd();
+
+    // the guard below the scheduler is not painted, at most that much is counted on top
+    EXPECT_GE(used, depth(196));
+    EXPECT_LE(used, depth(196) + STACK_SAMPLE_GUARD);
+    EXPECT_LT(used, depth(150));
+}
+
+TEST(StackCheckTest, TasksAreSampledInTurn)
+{
+    bootStack(200);
+
+    armFromFirstTask();
+    ASSERT_TRUE(stackSampleBegin(3));
+    stackSampleEnd();
+    // one sample for each run of the check
+    EXPECT_FALSE(stackSampleBegin(5));
+
+    // from the task after the last one up
+    taskStackCheck(0);
+    EXPECT_FALSE(stackSampleBegin(2));
+    EXPECT_FALSE(stackSampleBegin(3));
+    ASSERT_TRUE(stackSampleBegin(4));
+    stackSampleEnd();
+
+    // no task above the last one ran, the turn starts over
+    taskStackCheck(0);
+    EXPECT_FALSE(stackSampleBegin(1));
+    taskStackCheck(0);
+    EXPECT_TRUE(stackSampleBegin(1));
+    stackSampleEnd();
+}
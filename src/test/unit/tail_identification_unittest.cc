@@ -0,0 +1,293 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+extern "C" {
+#include "common/maths.h"
+
+#include "flight/tail_identification.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+#define LOOP_TIME_US        1000
+#define SUBSTEPS            10      // the plants run at 10kHz between PID loops
+
+// roughly normal, unit standard deviation
+static float lcgNoise(void)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < 12; i++) {
+        sum += (lcgNext() & 0xffff) / 65535.0f;
+    }
+    return sum - 6.0f;
+}
+
+// Tail servo slewing at rateDps and following as a first order lag near the set-point,
+// tail motor spooling as a first order lag, yaw from the tail thrust across the frame.
+typedef struct tailPlant_s {
+    float servoRateDps;
+    float servoLagS;
+    float motorSpoolS;
+    float yawTorqueGain;
+    float yawBias;
+
+    float servoAngle;
+    float motorSpeed;
+    float yawRate;
+} tailPlant_t;
+
+static void plantStep(tailPlant_t *plant, float servoCommand, float motorCommand, float dT)
+{
+    const float maxStep = plant->servoRateDps * dT;
+    const float servoStep = (servoCommand - plant->servoAngle) * (1.0f - expf(-dT / plant->servoLagS));
+    plant->servoAngle += constrainf(servoStep, -maxStep, maxStep);
+
+    plant->motorSpeed += (motorCommand - plant->motorSpeed) * (1.0f - expf(-dT / plant->motorSpoolS));
+
+    const float yawAccel = plant->yawTorqueGain * plant->motorSpeed * sinf(plant->servoAngle * RAD) + plant->yawBias;
+    plant->yawRate += yawAccel * dT;
+}
+
+typedef struct flightProfile_s {
+    float feedbackNoiseDeg;
+    float gyroNoiseDps;
+    bool servoFeedback;
+} flightProfile_t;
+
+// Servo set-point jumps now and then, the yaw loop holds the rate and the throttle wanders
+static void fly(tailId_t *id, tailPlant_t *plant, const flightProfile_t *profile, int loops)
+{
+    const float dT = LOOP_TIME_US * 1e-6f;
+    float excitation = 0.0f;
+    float motorCommand = 0.5f;
+
+    for (int loop = 0; loop < loops; loop++) {
+        if (loop % 150 == 0) {
+            excitation = (lcgNext() & 3) == 0 ? lcgRange(-3.0f, 3.0f) : lcgRange(-35.0f, 35.0f);
+        }
+        if (loop % 80 == 0) {
+            motorCommand = lcgRange(0.25f, 0.75f);
+        }
+        const float servoCommand = constrainf(excitation - 0.05f * plant->yawRate, -40.0f, 40.0f);
+
+        for (int i = 0; i < SUBSTEPS; i++) {
+            plantStep(plant, servoCommand, motorCommand, dT / SUBSTEPS);
+        }
+
+        tailIdSample_t sample;
+        sample.servoCommand = servoCommand;
+        sample.servoAngle = plant->servoAngle + profile->feedbackNoiseDeg * lcgNoise();
+        sample.motor = motorCommand;
+        sample.yawRate = plant->yawRate + profile->gyroNoiseDps * lcgNoise();
+        sample.restart = false;
+        tailIdPush(id, &sample);
+
+        // task at 100Hz
+        if (loop % 10 == 9) {
+            tailIdProcess(id);
+        }
+    }
+}
+
+static void initPlant(tailPlant_t *plant)
+{
+    plant->servoRateDps = 450.0f;
+    plant->servoLagS = 0.015f;
+    plant->motorSpoolS = 0.040f;
+    plant->yawTorqueGain = 6000.0f;
+    plant->yawBias = 150.0f;
+    plant->servoAngle = 0.0f;
+    plant->motorSpeed = 0.5f;
+    plant->yawRate = 0.0f;
+}
+
+TEST(TailIdentificationTest, RlsFindsLinearModel)
+{
+    tailIdRls_t rls;
+    tailIdRlsInit(&rls, 3, 1.0f, 1000.0f);
+    lcgState = 1;
+
+    for (int i = 0; i < 200; i++) {
+        const float phi[3] = { lcgRange(-1.0f, 1.0f), lcgRange(-10.0f, 10.0f), 1.0f };
+        tailIdRlsUpdate(&rls, phi, 0.5f * phi[0] - 2.0f * phi[1] + 3.0f);
+    }
+
+    EXPECT_NEAR(0.5f, rls.theta[0], 1e-3f);
+    EXPECT_NEAR(-2.0f, rls.theta[1], 1e-3f);
+    EXPECT_NEAR(3.0f, rls.theta[2], 1e-3f);
+    EXPECT_EQ(200u, rls.updates);
+}
+
+TEST(TailIdentificationTest, CovarianceDoesNotWindUp)
+{
+    tailIdRls_t rls;
+    tailIdRlsInit(&rls, 2, 0.99f, 100.0f);
+
+    // a constant input only tells the sum of the parameters, the other direction must not grow without end
+    const float phi[2] = { 1.0f, 1.0f };
+    for (int i = 0; i < 100000; i++) {
+        tailIdRlsUpdate(&rls, phi, 2.0f);
+    }
+
+    EXPECT_NEAR(2.0f, rls.theta[0] + rls.theta[1], 1e-3f);
+    EXPECT_LE(rls.P[0][0] + rls.P[1][1], rls.maxTrace / 0.99f);
+}
+
+TEST(TailIdentificationTest, SamplesAreAveragedToSamplePeriod)
+{
+    tailId_t id;
+    tailIdInit(&id, 125, true);
+
+    EXPECT_EQ(16, id.decimation);
+    EXPECT_FLOAT_EQ(0.002f, id.samplePeriodS);
+
+    tailIdSample_t sample = { 0.0f, 0.0f, 0.0f, 0.0f, false };
+    for (int i = 0; i < 16; i++) {
+        sample.yawRate = i;
+        sample.servoAngle = 2 * i;
+        tailIdPush(&id, &sample);
+    }
+
+    EXPECT_EQ(1, id.queueHead);
+    EXPECT_FLOAT_EQ(7.5f, id.queue[0].yawRate);
+    EXPECT_FLOAT_EQ(15.0f, id.queue[0].servoAngle);
+    // nothing to difference the first one against
+    EXPECT_TRUE(id.queue[0].restart);
+}
+
+TEST(TailIdentificationTest, OverflowAndBreakRestart)
+{
+    tailId_t id;
+    tailIdInit(&id, 2000, true);
+
+    const tailIdSample_t sample = { 0.0f, 0.0f, 0.5f, 0.0f, false };
+    for (int i = 0; i < TAIL_ID_QUEUE_SIZE + 2; i++) {
+        tailIdPush(&id, &sample);
+    }
+    EXPECT_EQ(3, id.droppedSamples);
+
+    tailIdProcess(&id);
+    EXPECT_EQ(id.queueHead, id.queueTail);
+
+    tailIdPush(&id, &sample);
+    EXPECT_TRUE(id.queue[(id.queueHead + TAIL_ID_QUEUE_SIZE - 1) % TAIL_ID_QUEUE_SIZE].restart);
+    tailIdPush(&id, &sample);
+    EXPECT_FALSE(id.queue[(id.queueHead + TAIL_ID_QUEUE_SIZE - 1) % TAIL_ID_QUEUE_SIZE].restart);
+
+    tailIdBreak(&id);
+    tailIdPush(&id, &sample);
+    EXPECT_TRUE(id.queue[(id.queueHead + TAIL_ID_QUEUE_SIZE - 1) % TAIL_ID_QUEUE_SIZE].restart);
+}
+
+TEST(TailIdentificationTest, NoConfidenceBeforeData)
+{
+    tailId_t id;
+    tailIdInit(&id, LOOP_TIME_US, true);
+
+    tailIdEstimate_t estimate;
+    tailIdGetEstimate(&id, &estimate);
+    EXPECT_EQ(0, estimate.servoRateConfidence);
+    EXPECT_EQ(0, estimate.servoLagConfidence);
+    EXPECT_EQ(0, estimate.motorSpoolConfidence);
+    EXPECT_EQ(0, estimate.yawTorqueConfidence);
+}
+
+static void expectEstimate(float expected, float estimated, uint8_t confidence, float tolerance, const char *name)
+{
+    printf("[ ESTIMATE ] %-16s true %8.2f estimated %8.2f confidence %3d%%\n", name, expected, estimated, confidence);
+    EXPECT_NEAR(expected, estimated, expected * tolerance) << name;
+    EXPECT_GE(confidence, 50) << name;
+}
+
+TEST(TailIdentificationTest, IdentifiesSyntheticPlant)
+{
+    tailPlant_t plant;
+    initPlant(&plant);
+    const flightProfile_t profile = { 0.05f, 0.2f, true };
+
+    tailId_t id;
+    tailIdInit(&id, LOOP_TIME_US, profile.servoFeedback);
+    lcgState = 0x2468ace;
+
+    fly(&id, &plant, &profile, 20000);
+
+    tailIdEstimate_t estimate;
+    tailIdGetEstimate(&id, &estimate);
+
+    expectEstimate(plant.servoRateDps, estimate.servoRateDps, estimate.servoRateConfidence, 0.05f, "servo rate dps");
+    expectEstimate(plant.servoLagS * 1000, estimate.servoLagMs, estimate.servoLagConfidence, 0.10f, "servo lag ms");
+    expectEstimate(plant.motorSpoolS * 1000, estimate.motorSpoolMs, estimate.motorSpoolConfidence, 0.10f, "motor spool ms");
+    expectEstimate(plant.yawTorqueGain, estimate.yawTorqueGain, estimate.yawTorqueConfidence, 0.05f, "yaw torque gain");
+    EXPECT_EQ(0, id.droppedSamples);
+}
+
+TEST(TailIdentificationTest, TracksChangedPlant)
+{
+    tailPlant_t plant;
+    initPlant(&plant);
+    const flightProfile_t profile = { 0.05f, 0.2f, true };
+
+    tailId_t id;
+    tailIdInit(&id, LOOP_TIME_US, profile.servoFeedback);
+    lcgState = 0x13579b;
+
+    fly(&id, &plant, &profile, 10000);
+
+    // slower servo and a bigger prop, the forgetting factor lets the estimates follow
+    plant.servoRateDps = 300.0f;
+    plant.servoLagS = 0.025f;
+    plant.motorSpoolS = 0.060f;
+    plant.yawTorqueGain = 9000.0f;
+    fly(&id, &plant, &profile, 20000);
+
+    tailIdEstimate_t estimate;
+    tailIdGetEstimate(&id, &estimate);
+
+    expectEstimate(plant.servoRateDps, estimate.servoRateDps, estimate.servoRateConfidence, 0.05f, "servo rate dps");
+    expectEstimate(plant.servoLagS * 1000, estimate.servoLagMs, estimate.servoLagConfidence, 0.10f, "servo lag ms");
+    expectEstimate(plant.motorSpoolS * 1000, estimate.motorSpoolMs, estimate.motorSpoolConfidence, 0.10f, "motor spool ms");
+    expectEstimate(plant.yawTorqueGain, estimate.yawTorqueGain, estimate.yawTorqueConfidence, 0.05f, "yaw torque gain");
+}
+
+TEST(TailIdentificationTest, VirtualServoLearnsOnlyMotorAndYaw)
+{
+    tailPlant_t plant;
+    initPlant(&plant);
+    const flightProfile_t profile = { 0.0f, 0.2f, false };
+
+    tailId_t id;
+    tailIdInit(&id, LOOP_TIME_US, profile.servoFeedback);
+    lcgState = 0xfeed;
+
+    fly(&id, &plant, &profile, 20000);
+
+    tailIdEstimate_t estimate;
+    tailIdGetEstimate(&id, &estimate);
+
+    EXPECT_EQ(0.0f, estimate.servoRateDps);
+    EXPECT_EQ(0.0f, estimate.servoLagMs);
+    EXPECT_EQ(0, estimate.servoRateConfidence);
+    EXPECT_EQ(0, estimate.servoLagConfidence);
+    expectEstimate(plant.motorSpoolS * 1000, estimate.motorSpoolMs, estimate.motorSpoolConfidence, 0.10f, "motor spool ms");
+    expectEstimate(plant.yawTorqueGain, estimate.yawTorqueGain, estimate.yawTorqueConfidence, 0.05f, "yaw torque gain");
+}
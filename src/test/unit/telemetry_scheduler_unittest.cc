@@ -0,0 +1,223 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <algorithm>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/utils.h"
+
+    #include "telemetry/telemetry_scheduler.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TASK_PERIOD_US      4000        // telemetry task runs at 250Hz
+#define SIMULATION_US       20000000
+#define TEST_FUNCTION       16          // FUNCTION_TELEMETRY_LTM
+
+// same declarations as telemetry/ltm.c and telemetry/mavlink.c
+static const telemetryFrame_t ltmFrames[] = {
+    { 'A', 10, 10 },
+    { 'S', 11, 5 },
+    { 'G', 18, 5 },
+    { 'O', 18, 1 },
+};
+
+static const telemetryFrame_t mavlinkFrames[] = {
+    { 1, 39, 2 },
+    { 3, 30, 5 },
+    { 6, 94, 2 },
+    { 10, 36, 10 },
+    { 11, 45, 10 },
+};
+
+typedef struct simulationResult_s {
+    uint32_t sent[TELEMETRY_SCHEDULER_MAX_FRAMES];
+    uint32_t maxGapUs[TELEMETRY_SCHEDULER_MAX_FRAMES];
+    uint32_t bytes;
+} simulationResult_t;
+
+// runs the telemetry task for SIMULATION_US, frames with a bit set in skipMask have nothing to send
+static void simulate(telemetryScheduler_t *scheduler, uint32_t skipMask, simulationResult_t *result)
+{
+    uint32_t lastSentUs[TELEMETRY_SCHEDULER_MAX_FRAMES];
+
+    memset(result, 0, sizeof(*result));
+    for (int i = 0; i < TELEMETRY_SCHEDULER_MAX_FRAMES; i++) {
+        lastSentUs[i] = 0;
+    }
+
+    for (timeUs_t now = 0; now < SIMULATION_US; now += TASK_PERIOD_US) {
+        int frameIndex;
+        while ((frameIndex = telemetrySchedulerNext(scheduler, now)) >= 0) {
+            if (skipMask & (1 << frameIndex)) {
+                continue;
+            }
+            telemetrySchedulerFrameSent(scheduler, frameIndex, now);
+
+            result->sent[frameIndex]++;
+            result->bytes += scheduler->frames[frameIndex].size;
+            result->maxGapUs[frameIndex] = std::max(result->maxGapUs[frameIndex], now - lastSentUs[frameIndex]);
+            lastSentUs[frameIndex] = now;
+        }
+    }
+
+    for (int i = 0; i < scheduler->frameCount; i++) {
+        result->maxGapUs[i] = std::max<uint32_t>(result->maxGapUs[i], SIMULATION_US - lastSentUs[i]);
+    }
+}
+
+static float targetRate(const telemetryScheduler_t *scheduler, int frameIndex)
+{
+    return scheduler->frames[frameIndex].rateHz * scheduler->rateScale / 1000.0f;
+}
+
+static void expectNoStarvation(const telemetryScheduler_t *scheduler, const simulationResult_t *result)
+{
+    const float seconds = SIMULATION_US / 1e6f;
+    uint32_t maxFrameSize = 0;
+
+    for (int i = 0; i < scheduler->frameCount; i++) {
+        maxFrameSize = std::max<uint32_t>(maxFrameSize, scheduler->frames[i].size);
+    }
+
+    // all frames were sent, at least at 80% of the rate their share of the link allows, and none waited
+    // much longer than two of its periods plus the longest frame ahead of it
+    for (int i = 0; i < scheduler->frameCount; i++) {
+        const float achieved = result->sent[i] / seconds;
+        EXPECT_GE(achieved, targetRate(scheduler, i) * 0.8f) << "frame " << i;
+        EXPECT_LE(result->maxGapUs[i], 2 * scheduler->state[i].periodUs + maxFrameSize * scheduler->usPerByte + TASK_PERIOD_US) << "frame " << i;
+        EXPECT_GT(scheduler->state[i].achievedRate, 0) << "frame " << i;
+    }
+
+    // and the link was never asked to carry more than its baud rate, the last frame may still be in the TX buffer
+    EXPECT_LE(result->bytes, scheduler->bytesPerSecond * seconds + maxFrameSize);
+}
+
+TEST(TelemetrySchedulerUnittest, TestAllTargetRatesFitAtHighBaud)
+{
+    telemetryScheduler_t scheduler;
+    simulationResult_t result;
+
+    telemetrySchedulerReset();
+    telemetrySchedulerInit(&scheduler, TEST_FUNCTION, ltmFrames, ARRAYLEN(ltmFrames), 19200, 100, 0);
+    EXPECT_EQ(1000, scheduler.rateScale);
+    EXPECT_EQ(1920u, scheduler.bytesPerSecond);
+
+    simulate(&scheduler, 0, &result);
+
+    for (unsigned i = 0; i < ARRAYLEN(ltmFrames); i++) {
+        EXPECT_NEAR(ltmFrames[i].rateHz, result.sent[i] / (SIMULATION_US / 1e6f), ltmFrames[i].rateHz * 0.05f) << "frame " << i;
+        EXPECT_NEAR(ltmFrames[i].rateHz * 100, scheduler.state[i].achievedRate, ltmFrames[i].rateHz * 5) << "frame " << i;
+    }
+    expectNoStarvation(&scheduler, &result);
+}
+
+TEST(TelemetrySchedulerUnittest, TestLtmDoesNotStarveAtLowBaud)
+{
+    static const uint32_t baudRates[] = { 1200, 2400, 4800 };
+
+    for (unsigned b = 0; b < ARRAYLEN(baudRates); b++) {
+        telemetryScheduler_t scheduler;
+        simulationResult_t result;
+
+        telemetrySchedulerReset();
+        telemetrySchedulerInit(&scheduler, TEST_FUNCTION, ltmFrames, ARRAYLEN(ltmFrames), baudRates[b], 100, 0);
+        simulate(&scheduler, 0, &result);
+
+        SCOPED_TRACE(baudRates[b]);
+        expectNoStarvation(&scheduler, &result);
+    }
+}
+
+TEST(TelemetrySchedulerUnittest, TestMavlinkDoesNotStarveAtLowBaud)
+{
+    static const uint32_t baudRates[] = { 2400, 4800, 9600 };
+
+    for (unsigned b = 0; b < ARRAYLEN(baudRates); b++) {
+        telemetryScheduler_t scheduler;
+        simulationResult_t result;
+
+        telemetrySchedulerReset();
+        telemetrySchedulerInit(&scheduler, TEST_FUNCTION, mavlinkFrames, ARRAYLEN(mavlinkFrames), baudRates[b], 100, 0);
+        EXPECT_LT(scheduler.rateScale, 1000);
+        simulate(&scheduler, 0, &result);
+
+        SCOPED_TRACE(baudRates[b]);
+        expectNoStarvation(&scheduler, &result);
+    }
+}
+
+TEST(TelemetrySchedulerUnittest, TestHalfDuplexShare)
+{
+    telemetryScheduler_t scheduler;
+    simulationResult_t result;
+
+    telemetrySchedulerReset();
+    telemetrySchedulerInit(&scheduler, TEST_FUNCTION, ltmFrames, ARRAYLEN(ltmFrames), 4800, 50, 0);
+    EXPECT_EQ(240u, scheduler.bytesPerSecond);
+    EXPECT_LT(scheduler.rateScale, 1000);
+
+    simulate(&scheduler, 0, &result);
+    expectNoStarvation(&scheduler, &result);
+}
+
+TEST(TelemetrySchedulerUnittest, TestUnsentFrameLeavesBudgetToOthers)
+{
+    telemetryScheduler_t scheduler;
+    simulationResult_t result;
+
+    // no GPS, the G-frame never has anything to send
+    telemetrySchedulerReset();
+    telemetrySchedulerInit(&scheduler, TEST_FUNCTION, ltmFrames, ARRAYLEN(ltmFrames), 2400, 100, 0);
+    simulate(&scheduler, 1 << 2, &result);
+
+    EXPECT_EQ(0u, result.sent[2]);
+    EXPECT_EQ(0, scheduler.state[2].achievedRate);
+    for (int i = 0; i < 4; i++) {
+        if (i != 2) {
+            EXPECT_GE(result.sent[i] / (SIMULATION_US / 1e6f), targetRate(&scheduler, i) * 0.8f) << "frame " << i;
+        }
+    }
+}
+
+TEST(TelemetrySchedulerUnittest, TestRegistry)
+{
+    telemetryScheduler_t first;
+    telemetryScheduler_t second;
+    telemetryScheduler_t third;
+
+    telemetrySchedulerReset();
+    EXPECT_EQ(NULL, telemetrySchedulerGet(0));
+
+    telemetrySchedulerInit(&first, TEST_FUNCTION, ltmFrames, ARRAYLEN(ltmFrames), 2400, 100, 0);
+    // ports shared with MSP reconfigure their scheduler on every arm
+    telemetrySchedulerInit(&first, TEST_FUNCTION, ltmFrames, ARRAYLEN(ltmFrames), 2400, 100, 0);
+    telemetrySchedulerInit(&second, TEST_FUNCTION, mavlinkFrames, ARRAYLEN(mavlinkFrames), 57600, 100, 0);
+    telemetrySchedulerInit(&third, TEST_FUNCTION, mavlinkFrames, ARRAYLEN(mavlinkFrames), 57600, 100, 0);
+
+    EXPECT_EQ(&first, telemetrySchedulerGet(0));
+    EXPECT_EQ(&second, telemetrySchedulerGet(1));
+    EXPECT_EQ(NULL, telemetrySchedulerGet(TELEMETRY_SCHEDULER_COUNT));
+    EXPECT_EQ(1000, second.rateScale);
+}
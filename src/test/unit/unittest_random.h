@@ -0,0 +1,44 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+// Deterministic pseudo random numbers, so every run of a test sees the same inputs.
+// Seed by assigning lcgState.
+static uint32_t lcgState = 1;
+
+static inline uint32_t lcgNext(void)
+{
+    lcgState = lcgState * 1664525 + 1013904223;
+    return lcgState >> 8;
+}
+
+static inline float lcgRange(float min, float max)
+{
+    return min + (max - min) * (lcgNext() & 0xffff) / 65535.0f;
+}
+
+// Box-Muller, unit variance
+static inline float lcgGaussian(void)
+{
+    const float u1 = (lcgNext() + 1) / 16777217.0f;
+    const float u2 = lcgNext() / 16777216.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * M_PI * u2);
+}
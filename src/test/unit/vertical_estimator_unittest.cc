@@ -0,0 +1,303 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <chrono>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+
+    #include "flight/vertical_estimator.h"
+}
+
+#include "unittest_macros.h"
+#include "unittest_random.h"
+#include "gtest/gtest.h"
+
+#define ACC_1G              512
+#define ACC_RATE_HZ         500
+#define BARO_RATE_HZ        40
+#define GPS_RATE_HZ         5
+#define GRAVITY_CMSS        980.665f
+
+#define ACC_BIAS_CMSS       25.0f
+#define ACC_NOISE_CMSS      40.0f
+#define BARO_NOISE_CM       35.0f
+#define GPS_NOISE_CM        150.0f
+#define GPS_MSL_CM          12345.0f
+#define BARO_DRIFT_CMS      2.0f        // weather drift of the baro reference
+
+#define TIME_CONSTANT       2.0f
+#define GPS_TIME_CONSTANT   (TIME_CONSTANT * 10.0f)
+
+typedef struct traceSample_s {
+    float trueAlt;              // cm
+    float trueVel;              // cm/s
+    float accZ;                 // earth frame, gravity removed, as the accelerometer reports it, cm/s/s
+    bool baroValid;
+    float baroAlt;              // cm
+    bool gpsValid;
+    float gpsAlt;               // cm MSL
+} traceSample_t;
+
+// Take off, climb at 1.5m/s, hover, a fast 3m/s descent and a stop, sampled at the accelerometer rate
+static std::vector<traceSample_t> recordTrace(float seconds)
+{
+    std::vector<traceSample_t> trace;
+    const float dt = 1.0f / ACC_RATE_HZ;
+    float alt = 0.0f;
+    float vel = 0.0f;
+
+    lcgState = 12345;
+
+    for (int i = 0; i < seconds * ACC_RATE_HZ; i++) {
+        const float t = i * dt;
+        float targetVel = 0.0f;
+        if (t > 5.0f && t < 15.0f) {
+            targetVel = 150.0f;
+        } else if (t > 25.0f && t < 29.0f) {
+            targetVel = -300.0f;
+        }
+        const float acc = constrainf((targetVel - vel) * 4.0f, -400.0f, 400.0f);
+
+        alt += (vel + acc * 0.5f * dt) * dt;
+        vel += acc * dt;
+
+        traceSample_t sample;
+        sample.trueAlt = alt;
+        sample.trueVel = vel;
+        sample.accZ = acc + ACC_BIAS_CMSS + ACC_NOISE_CMSS * lcgGaussian();
+        sample.baroValid = (i % (ACC_RATE_HZ / BARO_RATE_HZ)) == 0;
+        sample.baroAlt = alt + BARO_DRIFT_CMS * t + BARO_NOISE_CM * lcgGaussian();
+        sample.gpsValid = (i % (ACC_RATE_HZ / GPS_RATE_HZ)) == 0;
+        sample.gpsAlt = GPS_MSL_CM + alt + GPS_NOISE_CM * lcgGaussian();
+        trace.push_back(sample);
+    }
+
+    return trace;
+}
+
+typedef struct replayResult_s {
+    float altRms;
+    float velRms;
+    float nsPerUpdate;
+} replayResult_t;
+
+static void accumulateError(double *altSq, double *velSq, int *count, const traceSample_t &sample, float alt, float vel)
+{
+    *altSq += (alt - sample.trueAlt) * (alt - sample.trueAlt);
+    *velSq += (vel - sample.trueVel) * (vel - sample.trueVel);
+    (*count)++;
+}
+
+// errors are taken after this, once both estimators have settled
+#define SETTLE_SAMPLES (3 * ACC_RATE_HZ)
+
+static replayResult_t replayThreeState(const std::vector<traceSample_t> &trace, bool useGps)
+{
+    verticalEstimator_t estimator;
+    verticalEstimatorGains_t baroGains;
+    verticalEstimatorGainsInit(&baroGains, TIME_CONSTANT);
+    verticalEstimatorReset(&estimator, trace[0].baroAlt);
+
+    const float dt = 1.0f / ACC_RATE_HZ;
+    bool haveGpsOffset = false;
+    float gpsOffset = 0;
+    double altSq = 0, velSq = 0;
+    int count = 0;
+    int updates = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < trace.size(); i++) {
+        const traceSample_t &sample = trace[i];
+
+        // the 5Hz accZ low pass the IMU applies before handing the acceleration over
+        static float accSmooth;
+        const float rc = 0.5f / (M_PI * 5.0f);
+        accSmooth = i ? accSmooth + (dt / (rc + dt)) * (sample.accZ - accSmooth) : sample.accZ;
+
+        verticalEstimatorPredict(&estimator, accSmooth, dt);
+        updates++;
+
+        if (sample.baroValid) {
+            verticalEstimatorCorrect(&estimator, &baroGains, sample.baroAlt, 1.0f / BARO_RATE_HZ);
+        }
+        if (useGps && sample.gpsValid) {
+            if (!haveGpsOffset) {
+                gpsOffset = sample.gpsAlt - estimator.position;
+                haveGpsOffset = true;
+            } else {
+                verticalEstimatorCorrectReference(&estimator, sample.gpsAlt - gpsOffset, GPS_TIME_CONSTANT, 1.0f / GPS_RATE_HZ);
+            }
+        }
+        if (sample.baroValid && i >= SETTLE_SAMPLES) {
+            accumulateError(&altSq, &velSq, &count, sample, estimator.position, estimator.velocity);
+        }
+    }
+    const double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    replayResult_t result = { (float)sqrt(altSq / count), (float)sqrt(velSq / count), (float)(elapsedNs / updates) };
+    return result;
+}
+
+/*
+ * The complementary filter calculateEstimatedAltitude() runs when baro_estimator is CF, with the default
+ * baro_cf_alt/baro_cf_vel and accz_deadband, fed the same way from the accumulated acceleration.
+ */
+static replayResult_t replayLegacy(const std::vector<traceSample_t> &trace)
+{
+    const float cfAlt = 0.965f;
+    const float cfVel = 0.985f;
+    const int accDeadband = 40;
+    const float accVelScale = 9.80665f / ACC_1G / 10000.0f;
+    const uint32_t accDeltaUs = 1000000 / ACC_RATE_HZ;
+    const float dt = 1.0f / ACC_RATE_HZ;
+
+    float accAlt = trace[0].baroAlt;
+    float vel = 0;
+    int32_t lastBaroAlt = lrintf(trace[0].baroAlt);
+    int32_t accSum = 0;
+    int accSumCount = 0;
+    uint32_t accTimeSum = 0;
+    float accSmooth = 0;
+    double altSq = 0, velSq = 0;
+    int count = 0;
+    int updates = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < trace.size(); i++) {
+        const traceSample_t &sample = trace[i];
+
+        const float accLsb = sample.accZ * ACC_1G / GRAVITY_CMSS;
+        const float rc = 0.5f / (M_PI * 5.0f);
+        accSmooth = i ? accSmooth + (dt / (rc + dt)) * (accLsb - accSmooth) : accLsb;
+        const int32_t acc = lrintf(accSmooth);
+        accSum += (abs(acc) < accDeadband) ? 0 : (acc >= 0 ? acc - accDeadband : acc + accDeadband);
+        accSumCount++;
+        accTimeSum += accDeltaUs;
+        updates++;
+
+        if (!sample.baroValid) {
+            continue;
+        }
+
+        const int32_t baroAlt = lrintf(sample.baroAlt);
+        const float accDt = accTimeSum * 1e-6f;
+        const float accZ = (float)accSum / accSumCount;
+        const float velAcc = accZ * accVelScale * (float)accTimeSum;
+
+        accAlt += (velAcc * 0.5f) * accDt + vel * accDt;
+        accAlt = accAlt * cfAlt + (float)baroAlt * (1.0f - cfAlt);
+        vel += velAcc;
+
+        accSum = accSumCount = accTimeSum = 0;
+
+        int32_t baroVel = (baroAlt - lastBaroAlt) * BARO_RATE_HZ;
+        lastBaroAlt = baroAlt;
+        baroVel = constrain(baroVel, -1500, 1500);
+        baroVel = (abs(baroVel) < 10) ? 0 : (baroVel >= 0 ? baroVel - 10 : baroVel + 10);
+        vel = vel * cfVel + baroVel * (1.0f - cfVel);
+
+        if (i >= SETTLE_SAMPLES) {
+            accumulateError(&altSq, &velSq, &count, sample, accAlt, vel);
+        }
+    }
+    const double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    replayResult_t result = { (float)sqrt(altSq / count), (float)sqrt(velSq / count), (float)(elapsedNs / updates) };
+    return result;
+}
+
+TEST(VerticalEstimatorTest, SettlesOnConstantMeasurement)
+{
+    verticalEstimator_t estimator;
+    verticalEstimatorGains_t gains;
+    verticalEstimatorGainsInit(&gains, TIME_CONSTANT);
+    verticalEstimatorReset(&estimator, 0.0f);
+
+    for (int i = 0; i < 30 * BARO_RATE_HZ; i++) {
+        for (int j = 0; j < ACC_RATE_HZ / BARO_RATE_HZ; j++) {
+            verticalEstimatorPredict(&estimator, 0.0f, 1.0f / ACC_RATE_HZ);
+        }
+        verticalEstimatorCorrect(&estimator, &gains, 500.0f, 1.0f / BARO_RATE_HZ);
+    }
+
+    EXPECT_NEAR(500.0f, estimator.position, 1.0f);
+    EXPECT_NEAR(0.0f, estimator.velocity, 0.5f);
+    EXPECT_NEAR(0.0f, estimator.accBias, 0.5f);
+}
+
+TEST(VerticalEstimatorTest, AccelerometerBiasLearnt)
+{
+    verticalEstimator_t estimator;
+    verticalEstimatorGains_t gains;
+    verticalEstimatorGainsInit(&gains, TIME_CONSTANT);
+    verticalEstimatorReset(&estimator, 100.0f);
+
+    // stationary with a biased accelerometer
+    for (int i = 0; i < 40 * BARO_RATE_HZ; i++) {
+        for (int j = 0; j < ACC_RATE_HZ / BARO_RATE_HZ; j++) {
+            verticalEstimatorPredict(&estimator, ACC_BIAS_CMSS, 1.0f / ACC_RATE_HZ);
+        }
+        verticalEstimatorCorrect(&estimator, &gains, 100.0f, 1.0f / BARO_RATE_HZ);
+    }
+
+    EXPECT_NEAR(ACC_BIAS_CMSS, estimator.accBias, 0.5f);
+    EXPECT_NEAR(0.0f, estimator.velocity, 0.5f);
+    EXPECT_NEAR(100.0f, estimator.position, 1.0f);
+}
+
+TEST(VerticalEstimatorTest, LongCorrectionIntervalLimited)
+{
+    verticalEstimator_t estimator;
+    verticalEstimatorGains_t gains;
+    verticalEstimatorGainsInit(&gains, 0.0f);
+    verticalEstimatorReset(&estimator, 0.0f);
+
+    // a ten second gap and a tiny time constant must not overshoot the measurement
+    verticalEstimatorCorrect(&estimator, &gains, 1000.0f, 10.0f);
+    EXPECT_GT(estimator.position, 0.0f);
+    EXPECT_LE(estimator.position, 1000.0f);
+}
+
+TEST(VerticalEstimatorTest, ReplayAgainstComplementaryFilter)
+{
+    const std::vector<traceSample_t> trace = recordTrace(40.0f);
+
+    const replayResult_t legacy = replayLegacy(trace);
+    const replayResult_t threeState = replayThreeState(trace, false);
+    const replayResult_t threeStateGps = replayThreeState(trace, true);
+
+    printf("[ REPLAY   ] CF:             alt rms %6.1fcm vel rms %6.1fcm/s %6.1fns/acc update\n", legacy.altRms, legacy.velRms, legacy.nsPerUpdate);
+    printf("[ REPLAY   ] 3 state:        alt rms %6.1fcm vel rms %6.1fcm/s %6.1fns/acc update\n", threeState.altRms, threeState.velRms, threeState.nsPerUpdate);
+    printf("[ REPLAY   ] 3 state + GPS:  alt rms %6.1fcm vel rms %6.1fcm/s %6.1fns/acc update\n", threeStateGps.altRms, threeStateGps.velRms, threeStateGps.nsPerUpdate);
+
+    // the bias state takes out what the accelerometer offset does to the velocity
+    EXPECT_LT(threeState.velRms, legacy.velRms);
+    EXPECT_LT(threeState.velRms, 20.0f);
+    EXPECT_LT(threeState.altRms, 60.0f);
+
+    // GPS takes out the slow baro drift
+    EXPECT_LT(threeStateGps.altRms, threeState.altRms);
+}
@@ -0,0 +1,598 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/utils.h"
+
+    #include "cms/cms.h"
+
+    #include "drivers/serial.h"
+    #include "drivers/system.h"
+    #include "drivers/vtx_common.h"
+
+    #include "io/serial.h"
+    #include "io/vtx_smartaudio.h"
+    #include "io/vtx_tramp.h"
+    #include "io/vtx_string.h"
+    #include "io/vtx_transaction.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TASK_IDLE_PERIOD_US     (1000000 / 5)       // TASK_VTXCTRL
+#define TASK_BUSY_PERIOD_US     (1000000 / 200)
+
+#define SA_DEVICE_DELAY_US      (60 * 1000)         // SmartAudio answers a command after about 60ms
+#define TRAMP_DEVICE_DELAY_US   (20 * 1000)
+
+static timeUs_t simulationTimeUs;
+
+typedef struct wireByte_s {
+    timeUs_t atUs;
+    uint8_t value;
+} wireByte_t;
+
+/*
+ * Stand-in for a VTX on a half-duplex single wire UART. Everything the flight controller writes is
+ * echoed back to it, and the device answers a complete command after its turnaround delay once the
+ * line is free.
+ */
+class StandInVtx {
+public:
+    StandInVtx(uint32_t baudRate, uint32_t responseDelayUs) :
+        usPerByte(10 * 1000000 / baudRate), responseDelayUs(responseDelayUs), lineBusyUs(0), framesToPass(0), framesToIgnore(0), framesReceived(0) {}
+    virtual ~StandInVtx() {}
+
+    void write(const uint8_t *data, int count)
+    {
+        timeUs_t atUs = std::max(simulationTimeUs, lineBusyUs);
+        for (int i = 0; i < count; i++) {
+            atUs += usPerByte;
+            toFlightController(atUs, data[i]);
+            received.push_back(data[i]);
+        }
+        lineBusyUs = atUs;
+        parse(atUs);
+    }
+
+    uint32_t bytesWaiting(void) const
+    {
+        uint32_t count = 0;
+        while (count < rx.size() && rx[count].atUs <= simulationTimeUs) {
+            count++;
+        }
+        return count;
+    }
+
+    uint8_t read(void)
+    {
+        const uint8_t value = rx.front().value;
+        rx.pop_front();
+        return value;
+    }
+
+    const uint32_t usPerByte;
+    const uint32_t responseDelayUs;
+    timeUs_t lineBusyUs;
+    int framesToPass;           // then framesToIgnore are lost on the wire
+    int framesToIgnore;
+    int framesReceived;
+
+protected:
+    virtual void parse(timeUs_t frameEndUs) = 0;
+
+    void respond(const uint8_t *data, int count, timeUs_t frameEndUs)
+    {
+        timeUs_t atUs = std::max(frameEndUs + responseDelayUs, lineBusyUs);
+        for (int i = 0; i < count; i++) {
+            atUs += usPerByte;
+            toFlightController(atUs, data[i]);
+        }
+        lineBusyUs = atUs;
+    }
+
+    bool ignoreFrame(void)
+    {
+        framesReceived++;
+        if (framesToPass > 0) {
+            framesToPass--;
+            return false;
+        }
+        if (framesToIgnore > 0) {
+            framesToIgnore--;
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<uint8_t> received;
+
+private:
+    void toFlightController(timeUs_t atUs, uint8_t value)
+    {
+        wireByte_t byte = { atUs, value };
+        auto it = rx.end();
+        while (it != rx.begin() && (it - 1)->atUs > atUs) {
+            --it;
+        }
+        rx.insert(it, byte);
+    }
+
+    std::deque<wireByte_t> rx;
+};
+
+static uint8_t smartAudioCrc8(const uint8_t *data, int len)
+{
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0xd5) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// SmartAudio V2, 0xAA 0x55 command length payload CRC
+class StandInSmartAudio : public StandInVtx {
+public:
+    StandInSmartAudio() : StandInVtx(4800, SA_DEVICE_DELAY_US), chan(0), power(1), mode(0), freq(5865) {}
+
+    uint8_t chan;
+    uint8_t power;
+    uint8_t mode;
+    uint16_t freq;
+
+protected:
+    void parse(timeUs_t frameEndUs) override
+    {
+        while (!received.empty() && received[0] != 0xAA) {
+            received.erase(received.begin());
+        }
+        if (received.size() < 5 || received.size() < (size_t)received[3] + 5) {
+            return;
+        }
+
+        const int length = received[3] + 5;
+        const std::vector<uint8_t> frame(received.begin(), received.begin() + length);
+        received.erase(received.begin(), received.begin() + length);
+
+        if (frame[1] != 0x55 || smartAudioCrc8(frame.data(), length - 1) != frame[length - 1] || ignoreFrame()) {
+            return;
+        }
+
+        const uint8_t command = frame[2] >> 1;
+        uint8_t payload[8];
+        int payloadLength = 0;
+        uint8_t code = command;
+
+        switch (command) {
+        case 0x01:  // get settings, answered as version 2
+            code = 0x09;
+            payload[payloadLength++] = chan;
+            payload[payloadLength++] = power;
+            payload[payloadLength++] = mode;
+            payload[payloadLength++] = freq >> 8;
+            payload[payloadLength++] = freq & 0xff;
+            break;
+        case 0x02:
+            power = frame[4];
+            payload[payloadLength++] = power;
+            payload[payloadLength++] = 0x01;
+            break;
+        case 0x03:
+            chan = frame[4];
+            freq = vtx58FreqTable[chan / 8][chan % 8];
+            payload[payloadLength++] = chan;
+            payload[payloadLength++] = 0x01;
+            break;
+        case 0x04:
+            if (!(frame[4] & 0xc0)) {
+                freq = (frame[4] << 8) | frame[5];
+            }
+            payload[payloadLength++] = frame[4];
+            payload[payloadLength++] = frame[5];
+            payload[payloadLength++] = 0x01;
+            break;
+        case 0x05:
+            payload[payloadLength++] = frame[4];
+            payload[payloadLength++] = 0x01;
+            break;
+        default:
+            return;
+        }
+
+        uint8_t response[16] = { 0xAA, 0x55, code, (uint8_t)payloadLength };
+        memcpy(&response[4], payload, payloadLength);
+        response[4 + payloadLength] = smartAudioCrc8(&response[2], payloadLength + 2);
+        respond(response, payloadLength + 5, frameEndUs);
+    }
+};
+
+// Tramp, 16 byte frames starting with 0x0F, checksum over bytes 1 to 13
+class StandInTramp : public StandInVtx {
+public:
+    StandInTramp() : StandInVtx(9600, TRAMP_DEVICE_DELAY_US), freq(5865), power(25), pitmode(0) {}
+
+    uint16_t freq;
+    uint16_t power;
+    uint8_t pitmode;
+
+protected:
+    void parse(timeUs_t frameEndUs) override
+    {
+        while (!received.empty() && received[0] != 0x0F) {
+            received.erase(received.begin());
+        }
+        if (received.size() < 16) {
+            return;
+        }
+
+        uint8_t frame[16];
+        std::copy(received.begin(), received.begin() + 16, frame);
+        received.erase(received.begin(), received.begin() + 16);
+
+        uint8_t checksum = 0;
+        for (int i = 1; i < 14; i++) {
+            checksum += frame[i];
+        }
+        if (frame[14] != checksum || ignoreFrame()) {
+            return;
+        }
+
+        const uint16_t param = frame[2] | (frame[3] << 8);
+        uint8_t response[16] = { 0x0F, frame[1] };
+
+        switch (frame[1]) {
+        case 'F':
+            freq = param;
+            return;
+        case 'P':
+            power = param;
+            return;
+        case 'I':
+            pitmode = !param;
+            return;
+        case 'r':
+            response[2] = 5600 & 0xff; response[3] = 5600 >> 8;
+            response[4] = 5950 & 0xff; response[5] = 5950 >> 8;
+            response[6] = 600 & 0xff; response[7] = 600 >> 8;
+            break;
+        case 'v':
+            response[2] = freq & 0xff; response[3] = freq >> 8;
+            response[4] = power & 0xff; response[5] = power >> 8;
+            response[7] = pitmode;
+            response[8] = power & 0xff; response[9] = power >> 8;
+            break;
+        case 's':
+            response[6] = 35;
+            break;
+        default:
+            return;
+        }
+
+        checksum = 0;
+        for (int i = 1; i < 14; i++) {
+            checksum += response[i];
+        }
+        response[14] = checksum;
+        respond(response, 16, frameEndUs);
+    }
+};
+
+static StandInSmartAudio *smartAudioVtx;
+static StandInTramp *trampVtx;
+static serialPort_t smartAudioPort;
+static serialPort_t trampPort;
+static vtxDevice_t *registeredDevice;
+
+static StandInVtx *vtxOnPort(const serialPort_t *port)
+{
+    if (port == &smartAudioPort) {
+        return smartAudioVtx;
+    }
+    return trampVtx;
+}
+
+// What the scheduler does with TASK_VTXCTRL, until done() or the timeout. Returns the time taken.
+static uint32_t runVtxTask(std::function<bool(void)> done, bool followBusy, uint32_t timeoutUs)
+{
+    const timeUs_t startUs = simulationTimeUs;
+
+    while (simulationTimeUs - startUs < timeoutUs) {
+        registeredDevice->vTable->process(simulationTimeUs);
+        if (done()) {
+            return simulationTimeUs - startUs;
+        }
+        simulationTimeUs += (followBusy && registeredDevice->vTable->isBusy()) ? TASK_BUSY_PERIOD_US : TASK_IDLE_PERIOD_US;
+    }
+    return timeoutUs;
+}
+
+static bool reportsBandChan(uint8_t band, uint8_t chan)
+{
+    uint8_t reportedBand = 0;
+    uint8_t reportedChan = 0;
+    return registeredDevice->vTable->getBandChan(&reportedBand, &reportedChan) && reportedBand == band && reportedChan == chan;
+}
+
+TEST(VtxTransactionTest, NextCommandFollowsResponse)
+{
+    vtxTransactionEngine_t engine;
+    const uint8_t frame[6] = { 1, 2, 3, 4, 5, 6 };
+
+    // 9600 baud, 1042us per byte
+    vtxTransactionInit(&engine, 9600, 10000, 0, 1);
+    EXPECT_EQ(1042u, engine.usPerByte);
+
+    EXPECT_TRUE(vtxTransactionQueue(&engine, frame, 6, 'a', 'a', 8, 0));
+    EXPECT_TRUE(vtxTransactionQueue(&engine, frame, 4, 'b', 'b', 8, 0));
+    EXPECT_TRUE(vtxTransactionIsBusy(&engine));
+
+    const vtxTransaction_t *transaction = vtxTransactionNext(&engine, 1000);
+    ASSERT_NE(nullptr, transaction);
+    EXPECT_EQ('a', transaction->command);
+    EXPECT_EQ(6, transaction->length);
+
+    // nothing else goes out while waiting for the response
+    EXPECT_EQ(nullptr, vtxTransactionNext(&engine, 5000));
+
+    // a response to something else does not complete it
+    EXPECT_FALSE(vtxTransactionResponse(&engine, 'b', 20000));
+    EXPECT_EQ(1, engine.stats.outOfOrder);
+
+    EXPECT_TRUE(vtxTransactionResponse(&engine, 'a', 20000));
+    EXPECT_EQ(1, engine.stats.completed);
+    EXPECT_EQ(20000u, engine.stats.lastLatencyUs);
+
+    // the next one after the line turned around, two byte times
+    EXPECT_EQ(nullptr, vtxTransactionNext(&engine, 21000));
+    transaction = vtxTransactionNext(&engine, 22084);
+    ASSERT_NE(nullptr, transaction);
+    EXPECT_EQ('b', transaction->command);
+
+    EXPECT_TRUE(vtxTransactionResponse(&engine, 'b', 40000));
+    EXPECT_FALSE(vtxTransactionIsBusy(&engine));
+    EXPECT_EQ(40000u, engine.stats.maxLatencyUs);
+}
+
+TEST(VtxTransactionTest, TimeoutFromFrameTimes)
+{
+    vtxTransactionEngine_t engine;
+    const uint8_t frame[5] = { 0 };
+
+    vtxTransactionInit(&engine, 9600, 10000, 0, 1);
+    vtxTransactionQueue(&engine, frame, 5, 'a', 'a', 10, 0);
+    vtxTransactionQueue(&engine, frame, 5, 'b', 'b', 10, 0);
+
+    ASSERT_NE(nullptr, vtxTransactionNext(&engine, 0));
+
+    // sent 5 bytes, the device answers within 10ms with 10 bytes
+    const timeUs_t deadlineUs = 5 * 1042 + 10000 + 10 * 1042;
+    EXPECT_EQ(nullptr, vtxTransactionNext(&engine, deadlineUs - 1));
+
+    const vtxTransaction_t *transaction = vtxTransactionNext(&engine, deadlineUs);
+    ASSERT_NE(nullptr, transaction);
+    EXPECT_EQ('a', transaction->command);
+    EXPECT_EQ(1, engine.stats.retries);
+
+    // out of retries, given up and the next one goes out straight away
+    transaction = vtxTransactionNext(&engine, 2 * deadlineUs);
+    ASSERT_NE(nullptr, transaction);
+    EXPECT_EQ('b', transaction->command);
+    EXPECT_EQ(1, engine.stats.failed);
+}
+
+TEST(VtxTransactionTest, NewerCommandReplacesQueuedOne)
+{
+    vtxTransactionEngine_t engine;
+    uint8_t frame[1];
+
+    vtxTransactionInit(&engine, 9600, 10000, 0, 1);
+
+    frame[0] = 1;
+    vtxTransactionQueue(&engine, frame, 1, 'c', 'c', 4, 100);
+    frame[0] = 2;
+    vtxTransactionQueue(&engine, frame, 1, 'c', 'c', 4, 200);
+    vtxTransactionQueue(&engine, frame, 1, 'p', 'p', 4, 300);
+    frame[0] = 3;
+    vtxTransactionQueue(&engine, frame, 1, 'c', 'c', 4, 400);
+    vtxTransactionQueue(&engine, frame, 1, VTX_TRANSACTION_NO_MERGE, 'g', 4, 500);
+    vtxTransactionQueue(&engine, frame, 1, VTX_TRANSACTION_NO_MERGE, 'g', 4, 600);
+    EXPECT_EQ(4, engine.count);
+
+    // the last value, queued after what came meanwhile, waiting since the first one
+    const vtxTransaction_t *transaction = vtxTransactionNext(&engine, 1000);
+    EXPECT_EQ('p', transaction->command);
+    vtxTransactionResponse(&engine, 'p', 2000);
+
+    transaction = vtxTransactionNext(&engine, 10000);
+    EXPECT_EQ('c', transaction->command);
+    EXPECT_EQ(3, transaction->frame[0]);
+    EXPECT_EQ(100u, transaction->queuedUs);
+
+    // the command in flight is not replaced
+    frame[0] = 4;
+    vtxTransactionQueue(&engine, frame, 1, 'c', 'c', 4, 11000);
+    EXPECT_EQ(4, engine.count);
+    EXPECT_TRUE(vtxTransactionIsQueued(&engine, 'c'));
+}
+
+TEST(VtxTransactionTest, CommandWithoutResponseSettles)
+{
+    vtxTransactionEngine_t engine;
+    const uint8_t frame[16] = { 0 };
+
+    vtxTransactionInit(&engine, 9600, 10000, 50000, 1);
+    vtxTransactionQueue(&engine, frame, 16, 'F', VTX_TRANSACTION_NO_RESPONSE, 0, 0);
+    vtxTransactionQueue(&engine, frame, 16, 'v', 'v', 16, 0);
+
+    ASSERT_NE(nullptr, vtxTransactionNext(&engine, 0));
+    EXPECT_EQ(1, engine.stats.completed);
+    EXPECT_FALSE(vtxTransactionIsQueued(&engine, 'F'));
+
+    // the device applies it while the line stays idle
+    EXPECT_EQ(nullptr, vtxTransactionNext(&engine, 16 * 1042 + 50000 - 1));
+    EXPECT_NE(nullptr, vtxTransactionNext(&engine, 16 * 1042 + 50000));
+}
+
+TEST(VtxTransactionTest, SmartAudioLoopback)
+{
+    StandInSmartAudio vtx;
+    smartAudioVtx = &vtx;
+    simulationTimeUs = 1000000;
+
+    ASSERT_TRUE(smartAudioInit());
+    ASSERT_EQ(VTXDEV_SMARTAUDIO, registeredDevice->vTable->getDeviceType());
+
+    // the device is found with the first GetSettings
+    runVtxTask([]() { return registeredDevice->vTable->isReady(); }, true, 1000000);
+    ASSERT_TRUE(registeredDevice->vTable->isReady());
+    runVtxTask([]() { return !registeredDevice->vTable->isBusy(); }, true, 1000000);
+
+    // band/channel change, read back by the following GetSettings
+    registeredDevice->vTable->setBandChan(5, 3);
+    const uint32_t latencyUs = runVtxTask([]() { return reportsBandChan(5, 3); }, true, 2000000);
+    EXPECT_EQ(4 * 8 + 2, vtx.chan);
+
+    // the same over the task polled at its idle rate only
+    runVtxTask([]() { return !registeredDevice->vTable->isBusy(); }, true, 1000000);
+    registeredDevice->vTable->setBandChan(1, 1);
+    const uint32_t polledLatencyUs = runVtxTask([]() { return reportsBandChan(1, 1); }, false, 4000000);
+
+    // stepping through channels in the menu only sends the last one
+    runVtxTask([]() { return !registeredDevice->vTable->isBusy(); }, true, 1000000);
+    const int framesBefore = vtx.framesReceived;
+    for (int chan = 1; chan <= 8; chan++) {
+        registeredDevice->vTable->setBandChan(2, chan);
+    }
+    runVtxTask([]() { return reportsBandChan(2, 8); }, true, 2000000);
+    EXPECT_LE(vtx.framesReceived - framesBefore, 3);
+
+    // a lost command is sent again after the frame times and the device turnaround
+    runVtxTask([]() { return !registeredDevice->vTable->isBusy(); }, true, 1000000);
+    const vtxTransactionStats_t statsBefore = *vtxTransactionGetStats();
+    vtx.framesToIgnore = 1;
+    registeredDevice->vTable->setPowerByIndex(3);
+    const uint32_t lostLatencyUs = runVtxTask([]() { uint8_t index = 0; return registeredDevice->vTable->getPowerIndex(&index) && index == 3; }, true, 2000000);
+    EXPECT_EQ(2, vtx.power);
+    EXPECT_EQ(statsBefore.retries + 1, vtxTransactionGetStats()->retries);
+
+    const vtxTransactionStats_t *stats = vtxTransactionGetStats();
+    printf("[ VTX      ] SmartAudio 4800 baud, %dms device turnaround: band/channel %ums, polled at 5Hz %ums, with a lost command %ums\n",
+        SA_DEVICE_DELAY_US / 1000, latencyUs / 1000, polledLatencyUs / 1000, lostLatencyUs / 1000);
+    printf("[ VTX      ] %u commands, %u retries, %u failed, latency average %uus max %uus\n",
+        stats->completed, stats->retries, stats->failed, stats->averageLatencyUs, stats->maxLatencyUs);
+
+    // a command, its response, GetSettings and its response
+    const uint32_t frameTimesUs = (8 + 14 + 7 + 14) * vtx.usPerByte + 2 * SA_DEVICE_DELAY_US;
+    EXPECT_LT(latencyUs, frameTimesUs + 2 * TASK_BUSY_PERIOD_US + 4 * vtx.usPerByte);
+    EXPECT_LT(latencyUs, polledLatencyUs / 2);
+    EXPECT_EQ(0, stats->failed);
+}
+
+TEST(VtxTransactionTest, TrampLoopback)
+{
+    StandInTramp vtx;
+    trampVtx = &vtx;
+    simulationTimeUs = 10000000;
+
+    ASSERT_TRUE(trampInit());
+    ASSERT_EQ(VTXDEV_TRAMP, registeredDevice->vTable->getDeviceType());
+
+    // online once the 'r' query is answered, then the current settings with 'v'
+    runVtxTask([]() { return registeredDevice->vTable->isReady(); }, true, 3000000);
+    ASSERT_TRUE(registeredDevice->vTable->isReady());
+    runVtxTask([]() { return reportsBandChan(4, 4); }, true, 3000000);     // 5865 is F4
+
+    // set and read back straight after
+    registeredDevice->vTable->setBandChan(5, 3);
+    const uint32_t latencyUs = runVtxTask([]() { return reportsBandChan(5, 3); }, true, 3000000);
+    EXPECT_EQ(vtx58FreqTable[4][2], vtx.freq);
+
+    // the same over the task polled at its idle rate only
+    runVtxTask([]() { return !registeredDevice->vTable->isBusy(); }, true, 1000000);
+    registeredDevice->vTable->setBandChan(1, 1);
+    const uint32_t polledLatencyUs = runVtxTask([]() { return reportsBandChan(1, 1); }, false, 4000000);
+
+    // power, with the read back lost once
+    runVtxTask([]() { return !registeredDevice->vTable->isBusy(); }, true, 1000000);
+    vtx.framesToPass = 1;       // the setting arrives, the 'v' query after it is lost
+    vtx.framesToIgnore = 1;
+    registeredDevice->vTable->setPowerByIndex(3);
+    runVtxTask([]() { uint8_t index = 0; return registeredDevice->vTable->getPowerIndex(&index) && index == 3; }, true, 3000000);
+    EXPECT_EQ(200, vtx.power);
+
+    printf("[ VTX      ] Tramp 9600 baud, %dms device turnaround: band/channel %ums, polled at 5Hz %ums\n",
+        TRAMP_DEVICE_DELAY_US / 1000, latencyUs / 1000, polledLatencyUs / 1000);
+
+    // setting, settle time, query and its response, the fixed 300ms + 200ms wait is gone
+    EXPECT_LT(latencyUs, 3 * 16 * vtx.usPerByte + 50000 + TRAMP_DEVICE_DELAY_US + 2 * TASK_BUSY_PERIOD_US);
+    EXPECT_LT(latencyUs, polledLatencyUs);
+}
+
+// STUBS
+
+extern "C" {
+uint32_t micros(void) { return simulationTimeUs; }
+uint32_t millis(void) { return simulationTimeUs / 1000; }
+
+static void fakeSetBaudRate(serialPort_t *instance, uint32_t baudRate) { UNUSED(instance); UNUSED(baudRate); }
+static const struct serialPortVTable fakeVTable = {
+    .serialWrite = NULL,
+    .serialTotalRxWaiting = NULL,
+    .serialTotalTxFree = NULL,
+    .serialRead = NULL,
+    .serialSetBaudRate = fakeSetBaudRate,
+    .isSerialTransmitBufferEmpty = NULL,
+    .setMode = NULL,
+    .writeBuf = NULL,
+    .readBuf = NULL,
+    .beginWrite = NULL,
+    .endWrite = NULL
+};
+static serialPortConfig_t portConfig;
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function) { UNUSED(function); return &portConfig; }
+serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e function, serialReceiveCallbackPtr rxCallback, uint32_t baudrate, portMode_t mode, portOptions_t options)
+{
+    UNUSED(identifier); UNUSED(rxCallback); UNUSED(baudrate); UNUSED(mode); UNUSED(options);
+    serialPort_t *port = (function == FUNCTION_VTX_SMARTAUDIO) ? &smartAudioPort : &trampPort;
+    port->vTable = &fakeVTable;
+    return port;
+}
+void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count) { vtxOnPort(instance)->write(data, count); }
+uint32_t serialRxBytesWaiting(const serialPort_t *instance) { return vtxOnPort(instance)->bytesWaiting(); }
+uint8_t serialRead(serialPort_t *instance) { return vtxOnPort(instance)->read(); }
+
+void vtxCommonRegisterDevice(vtxDevice_t *pDevice) { registeredDevice = pDevice; }
+
+int tfp_sprintf(char *s, const char *fmt, ...) { UNUSED(s); UNUSED(fmt); return 0; }
+long cmsMenuChange(displayPort_t *pDisplay, const void *ptr) { UNUSED(pDisplay); UNUSED(ptr); return 0; }
+}
@@ -0,0 +1,282 @@
+/*
+ * This file is part of Cleanflight.
+ *
+ * Cleanflight is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Cleanflight is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/build_config.h"
+
+    #include "common/color.h"
+    #include "common/colorconversion.h"
+    #include "common/utils.h"
+
+    #include "drivers/io_types.h"
+    #include "drivers/light_ws2811strip.h"
+
+    #include "config/feature.h"
+
+    #include "fc/config.h"
+    #include "fc/rc_controls.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/failsafe.h"
+
+    #include "io/ledstrip.h"
+
+    #include "rx/rx.h"
+
+    #include "sensors/battery.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LEDSTRIP_TASK_PERIOD_US     10000       // TASK_LEDSTRIP runs at 100Hz
+#define BENCHMARK_US                60000000
+
+extern "C" {
+    STATIC_UNIT_TESTED void updateLEDDMABuffer(uint16_t ledIndex, const rgbColor24bpp_t *color);
+
+    uint8_t armingFlags;
+    uint8_t stateFlags;
+    uint16_t flightModeFlags;
+    uint32_t rcModeActivationMask;
+    int16_t rcData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    int16_t rcCommand[4];
+    uint16_t rssi;
+    uint8_t GPS_numSat;
+
+    static int dmaTransferCount;
+    static batteryState_e batteryState = BATTERY_OK;
+}
+
+static void expectCompareValues(uint16_t offset, uint8_t value)
+{
+    for (int bit = 0; bit < 8; bit++) {
+        const uint8_t expected = (value & (0x80 >> bit)) ? BIT_COMPARE_1 : BIT_COMPARE_0;
+        EXPECT_EQ(expected, ledStripDMABuffer[offset + bit]) << "value " << (int)value << " bit " << bit;
+    }
+}
+
+static void completeTransfer(void)
+{
+    ws2811LedDataTransferInProgress = 0;
+}
+
+TEST(WS2812, updateDMABuffer)
+{
+    // given
+    rgbColor24bpp_t color1 = { .raw = {0xFF,0xAA,0x55} };
+
+    // when
+    updateLEDDMABuffer(1, &color1);
+
+    // then, sent in GRB order after the first LED
+    expectCompareValues(WS2811_BITS_PER_LED + 0, 0xAA);
+    expectCompareValues(WS2811_BITS_PER_LED + 8, 0xFF);
+    expectCompareValues(WS2811_BITS_PER_LED + 16, 0x55);
+}
+
+TEST(WS2812, lookupTableCoversEveryByte)
+{
+    for (int value = 0; value < 256; value++) {
+        rgbColor24bpp_t color = { .raw = {(uint8_t)value, (uint8_t)~value, (uint8_t)(value * 7)} };
+
+        updateLEDDMABuffer(0, &color);
+
+        expectCompareValues(0, color.rgb.g);
+        expectCompareValues(8, color.rgb.r);
+        expectCompareValues(16, color.rgb.b);
+    }
+}
+
+TEST(WS2812, onlyChangedLedsAreSent)
+{
+    // given
+    const hsvColor_t red = { 0, 0, 255 };
+    const hsvColor_t blue = { 240, 0, 255 };
+
+    dmaTransferCount = 0;
+    ws2811LedStripInit(0);
+    EXPECT_EQ(1, dmaTransferCount);
+    completeTransfer();
+
+    // the trailing reset period stays low
+    for (int i = WS2811_DATA_BUFFER_SIZE; i < WS2811_DMA_BUFFER_SIZE; i++) {
+        EXPECT_EQ(0u, ledStripDMABuffer[i]);
+    }
+
+    // when nothing was written
+    ws2811UpdateStrip();
+
+    // then
+    EXPECT_EQ(1, dmaTransferCount);
+
+    // when an LED is written with the color it already shows
+    const hsvColor_t white = { 0, 255, 255 };
+    setLedHsv(3, &white);
+    ws2811UpdateStrip();
+
+    // then
+    EXPECT_EQ(1, dmaTransferCount);
+
+    // when one LED changes, and another one changes and back again
+    uint32_t before[WS2811_DMA_BUFFER_SIZE];
+    for (int i = 0; i < WS2811_DMA_BUFFER_SIZE; i++) {
+        before[i] = ledStripDMABuffer[i];
+    }
+    setLedHsv(5, &red);
+    setLedHsv(6, &blue);
+    setLedHsv(6, &white);
+    ws2811UpdateStrip();
+
+    // then only the first one is in the new transfer
+    EXPECT_EQ(2, dmaTransferCount);
+    for (int i = 0; i < WS2811_DMA_BUFFER_SIZE; i++) {
+        if (i < 5 * WS2811_BITS_PER_LED || i >= 6 * WS2811_BITS_PER_LED) {
+            EXPECT_EQ(before[i], ledStripDMABuffer[i]) << "index " << i;
+        }
+    }
+    expectCompareValues(5 * WS2811_BITS_PER_LED + 8, 255);
+
+    // when written while the previous transfer is still running
+    setLedHsv(7, &blue);
+    ws2811UpdateStrip();
+
+    // then it waits for the next update
+    EXPECT_EQ(2, dmaTransferCount);
+    completeTransfer();
+    ws2811UpdateStrip();
+    EXPECT_EQ(3, dmaTransferCount);
+    completeTransfer();
+}
+
+// the previous implementation, every LED converted one bit per iteration on every update
+static void fullUpdateLEDDMABuffer(void)
+{
+    uint16_t dmaBufferOffset = 0;
+
+    for (int ledIndex = 0; ledIndex < WS2811_LED_STRIP_LENGTH; ledIndex++) {
+        hsvColor_t hsvColor;
+        getLedHsv(ledIndex, &hsvColor);
+        const rgbColor24bpp_t *color = hsvToRgb24(&hsvColor);
+        const uint32_t grb = (color->rgb.g << 16) | (color->rgb.r << 8) | (color->rgb.b);
+
+        for (int8_t index = 23; index >= 0; index--) {
+            ledStripDMABuffer[dmaBufferOffset++] = (grb & (1 << index)) ? BIT_COMPARE_1 : BIT_COMPARE_0;
+        }
+    }
+}
+
+TEST(WS2812, benchmarkLedStripFrame)
+{
+    static ledStripConfig_t ledStripConfig;
+
+    // 32 LEDs, flight mode and arm state LEDs with warnings, blinking colored LEDs and a thrust ring
+    memset(&ledStripConfig, 0, sizeof(ledStripConfig));
+    for (int i = 0; i < 8; i++) {
+        ledStripConfig.ledConfigs[i] = DEFINE_LED(i, 0, 0, LD(NORTH), LF(FLIGHT_MODE), LO(WARNING), 0);
+        ledStripConfig.ledConfigs[i + 8] = DEFINE_LED(i, 15, 2, LD(SOUTH), LF(COLOR), LO(BLINK), 0);
+    }
+    for (int i = 16; i < 28; i++) {
+        ledStripConfig.ledConfigs[i] = DEFINE_LED(i - 16, 7, 10, 0, LF(THRUST_RING), 0, 0);
+    }
+    for (int i = 28; i < 32; i++) {
+        ledStripConfig.ledConfigs[i] = DEFINE_LED(15, i - 28, 0, LD(EAST), LF(ARM_STATE), LO(WARNING), 0);
+    }
+    applyDefaultColors(ledStripConfig.colors);
+    applyDefaultModeColors(ledStripConfig.modeColors);
+    applyDefaultSpecialColors(&ledStripConfig.specialColors);
+
+    // armed at half throttle with a low battery warning
+    ENABLE_ARMING_FLAG(ARMED);
+    ENABLE_ARMING_FLAG(OK_TO_ARM);
+    batteryState = BATTERY_WARNING;
+    for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+        rcData[i] = 1500;
+    }
+
+    ledStripInit(&ledStripConfig);
+    ledStripEnable();
+    completeTransfer();
+
+    dmaTransferCount = 0;
+    int frames = 0;
+    double updateNs = 0;
+    double fullNs = 0;
+
+    for (timeUs_t now = 0; now < BENCHMARK_US; now += LEDSTRIP_TASK_PERIOD_US) {
+        const int transfersBefore = dmaTransferCount;
+
+        auto start = std::chrono::steady_clock::now();
+        ledStripUpdate(now);
+        updateNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        // what rebuilding the whole strip would have cost for every transfer
+        if (dmaTransferCount != transfersBefore) {
+            start = std::chrono::steady_clock::now();
+            fullUpdateLEDDMABuffer();
+            fullNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            frames++;
+        }
+        completeTransfer();
+    }
+
+    const int updates = BENCHMARK_US / LEDSTRIP_TASK_PERIOD_US;
+    printf("[ LEDSTRIP ] %d updates, %d transfers, %.2fus per update including layers, full rebuild %.2fus per transfer\n",
+        updates, dmaTransferCount, updateNs / updates / 1000, fullNs / std::max(frames, 1) / 1000);
+
+    // the thrust ring rotates at 27.5Hz, warnings and blinks at 10Hz, some of their steps change nothing
+    EXPECT_GT(dmaTransferCount, 0);
+    EXPECT_LT(dmaTransferCount, updates);
+
+    // the strip ends up showing what the layers drew
+    for (int ledIndex = 0; ledIndex < WS2811_LED_STRIP_LENGTH; ledIndex++) {
+        hsvColor_t hsvColor;
+        getLedHsv(ledIndex, &hsvColor);
+        const rgbColor24bpp_t *color = hsvToRgb24(&hsvColor);
+        expectCompareValues(ledIndex * WS2811_BITS_PER_LED, color->rgb.g);
+        expectCompareValues(ledIndex * WS2811_BITS_PER_LED + 8, color->rgb.r);
+        expectCompareValues(ledIndex * WS2811_BITS_PER_LED + 16, color->rgb.b);
+    }
+
+    DISABLE_ARMING_FLAG(ARMED);
+    batteryState = BATTERY_OK;
+}
+
+// STUBS
+
+extern "C" {
+void ws2811LedStripHardwareInit(ioTag_t ioTag) { UNUSED(ioTag); }
+void ws2811LedStripDMAEnable(void) { dmaTransferCount++; }
+
+bool feature(uint32_t mask) { return mask == FEATURE_VBAT; }
+bool failsafeIsActive(void) { return false; }
+batteryState_e getBatteryState(void) { return batteryState; }
+uint8_t calculateBatteryPercentage(void) { return 50; }
+bool rxIsReceivingSignal(void) { return true; }
+bool isBeeperOn(void) { return false; }
+bool sensors(uint32_t mask) { UNUSED(mask); return false; }
+int tfp_sprintf(char *s, const char *fmt, ...) { UNUSED(s); UNUSED(fmt); return 0; }
+}
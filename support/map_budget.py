@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+#
+# This file is part of Cleanflight.
+#
+# Cleanflight is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Cleanflight is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Reports how much of each memory region a GNU ld map file uses and checks it against budgets.
+#
+#   map_budget.py <file.map> [REGION=size ...]      e.g. CCM=7K RAM=95%
+#
+# Sizes are bytes, K suffixed, or a percentage of the region. Sections count against the region
+# their address is in, and against a second region when they are loaded from there, e.g.
+# initialised data from FLASH.
+# Exits with 1 when a region is over its budget.
+
+from __future__ import print_function
+
+import re
+import sys
+
+SECTION_RE = re.compile(r'^(\.\S+|[A-Za-z_]\w*)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?\s*$')
+REGION_RE = re.compile(r'^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)')
+# Not allocated on the target, some of them are at address 0 where the F7 ITCM is
+NOT_ALLOCATED_RE = re.compile(r'^\.(debug|comment|stab|ARM\.attributes|gnu\.attributes|gnu_debug)')
+# ld gives these a load address as well, but there is nothing to load
+NOT_LOADED_RE = re.compile(r'bss|heap|stack|noinit')
+
+
+def parse_size(text, length):
+    text = text.strip()
+    if text[-1:] == '%':
+        return int(length * float(text[:-1]) / 100)
+    if text[-1:] in ('K', 'k'):
+        return int(text[:-1], 0) * 1024
+    return int(text, 0)
+
+
+def parse_map(lines):
+    regions = []
+    sections = []
+    state = None
+    pending = None
+
+    for line in lines:
+        line = line.rstrip('\n')
+
+        if line.startswith('Memory Configuration'):
+            state = 'memory'
+            continue
+        if line.startswith('Linker script and memory map'):
+            state = 'map'
+            continue
+
+        if state == 'memory':
+            match = REGION_RE.match(line)
+            if match and match.group(1) not in ('Name', '*default*'):
+                regions.append((match.group(1), int(match.group(2), 16), int(match.group(3), 16)))
+        elif state == 'map':
+            # Output sections start in the first column, a long name puts the address on the next line
+            if line.startswith('.') and ' ' not in line.strip():
+                pending = line.strip()
+                continue
+            match = SECTION_RE.match(line)
+            name = None
+            if match and match.group(1) and line.startswith('.'):
+                name = match.group(1)
+            elif match and pending and not match.group(1):
+                name = pending
+            pending = None
+            if name is None or NOT_ALLOCATED_RE.match(name):
+                continue
+            load = int(match.group(4), 16) if match.group(4) else None
+            sections.append((name, int(match.group(2), 16), int(match.group(3), 16), load))
+
+    return regions, sections
+
+
+def region_of(regions, address):
+    for name, origin, length in regions:
+        if origin <= address < origin + length:
+            return name
+    return None
+
+
+def region_usage(regions, sections):
+    used = dict((name, 0) for name, _, _ in regions)
+    for name, address, size, load in sections:
+        if size == 0:
+            continue
+        region = region_of(regions, address)
+        if region is not None:
+            used[region] += size
+        if load is not None and load != address and not NOT_LOADED_RE.search(name):
+            load_region = region_of(regions, load)
+            if load_region is not None and load_region != region:
+                used[load_region] += size
+    return used
+
+
+def main(argv):
+    if len(argv) < 2:
+        print('usage: %s <file.map> [REGION=size ...]' % argv[0], file=sys.stderr)
+        return 2
+
+    with open(argv[1]) as mapfile:
+        regions, sections = parse_map(mapfile)
+    used = region_usage(regions, sections)
+    lengths = dict((name, length) for name, _, length in regions)
+
+    budgets = {}
+    for arg in argv[2:]:
+        region, _, size = arg.partition('=')
+        budgets[region] = parse_size(size, lengths.get(region, 0))
+
+    print('%-14s %10s %10s %7s %10s' % ('Region', 'Used', 'Size', 'Use%', 'Budget'))
+    over = []
+    for name, _, length in regions:
+        if length == 0:
+            continue
+        budget = budgets.get(name)
+        print('%-14s %10d %10d %6.1f%% %10s' % (name, used[name], length, 100.0 * used[name] / length,
+                                                 budget if budget is not None else '-'))
+        if budget is not None and used[name] > budget:
+            over.append((name, used[name], budget))
+
+    for name in sorted(set(budgets) - set(used)):
+        print('map_budget: no region %s in %s' % (name, argv[1]), file=sys.stderr)
+        over.append((name, 0, budgets[name]))
+
+    for name, size, budget in over:
+        if size:
+            print('map_budget: %s uses %d bytes, over its budget of %d by %d' % (name, size, budget, size - budget), file=sys.stderr)
+
+    return 1 if over else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))